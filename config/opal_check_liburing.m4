@@ -0,0 +1,67 @@
+# -*- shell-script -*-
+#
+# $COPYRIGHT$
+#
+# Additional copyrights may follow
+#
+# $HEADER$
+#
+
+# OPAL_CHECK_LIBURING(prefix, [action-if-found], [action-if-not-found])
+# --------------------------------------------------------
+# check if liburing (Linux io_uring) support can be found.  sets
+# prefix_{CPPFLAGS, LDFLAGS, LIBS} as needed and runs action-if-found
+# if there is support, otherwise executes action-if-not-found
+AC_DEFUN([OPAL_CHECK_LIBURING],[
+    OPAL_VAR_SCOPE_PUSH([opal_check_liburing_dir opal_check_liburing_libdir opal_check_liburing_save_CPPFLAGS])
+
+    AS_IF([test -z "$opal_check_liburing_happy"],
+          [AC_ARG_WITH([liburing],
+                       [AC_HELP_STRING([--with-liburing(=DIR)],
+                                       [Build Linux io_uring support, searching for headers in DIR/include (default: autodetect)])])
+           OPAL_CHECK_WITHDIR([liburing], [$with_liburing], [include/liburing.h])
+           AC_ARG_WITH([liburing-libdir],
+                       [AC_HELP_STRING([--with-liburing-libdir=DIR],
+                                       [Search for liburing libraries in DIR])])
+           OPAL_CHECK_WITHDIR([liburing-libdir], [$with_liburing_libdir], [liburing.*])
+
+           opal_check_liburing_happy="no"
+           AS_IF([test "$with_liburing" != "no"],
+                 [AS_IF([test -n "$with_liburing" && test "$with_liburing" != "yes"],
+                        [opal_check_liburing_dir="$with_liburing"])
+                  AS_IF([test -n "$with_liburing_libdir" && test "$with_liburing_libdir" != "yes"],
+                        [opal_check_liburing_libdir="$with_liburing_libdir"])
+
+                  OPAL_CHECK_PACKAGE([opal_check_liburing],
+                                     [liburing.h],
+                                     [uring],
+                                     [io_uring_queue_init],
+                                     [],
+                                     [$opal_check_liburing_dir],
+                                     [$opal_check_liburing_libdir],
+                                     [opal_check_liburing_happy="yes"],
+                                     [opal_check_liburing_happy="no"])])
+
+           # zero-copy sends need liburing 2.3 and are detected at run time
+           # on the kernel side
+           AS_IF([test "$opal_check_liburing_happy" = "yes"],
+                 [opal_check_liburing_save_CPPFLAGS="$CPPFLAGS"
+                  CPPFLAGS="$CPPFLAGS $opal_check_liburing_CPPFLAGS"
+                  AC_CHECK_DECLS([io_uring_prep_sendmsg_zc], [], [],
+                                 [#include <liburing.h>])
+                  CPPFLAGS="$opal_check_liburing_save_CPPFLAGS"])
+
+           OPAL_SUMMARY_ADD([[Transports]],[[Linux io_uring]],[$1],[$opal_check_liburing_happy])])
+
+    AS_IF([test "$opal_check_liburing_happy" = "yes"],
+          [$1_CPPFLAGS="[$]$1_CPPFLAGS $opal_check_liburing_CPPFLAGS"
+           $1_LDFLAGS="[$]$1_LDFLAGS $opal_check_liburing_LDFLAGS"
+           $1_LIBS="[$]$1_LIBS $opal_check_liburing_LIBS"
+           $2],
+          [AS_IF([test -n "$with_liburing" && test "$with_liburing" != "no"],
+                 [AC_MSG_WARN([liburing support requested but not found.  Aborting])
+                  AC_MSG_ERROR([Cannot continue])])
+           $3])
+
+    OPAL_VAR_SCOPE_POP
+])dnl
@@ -52,11 +52,13 @@
 #include "ompi/communicator/communicator.h"
 #include "ompi/mca/pml/pml.h"
 #include "ompi/request/request.h"
+#include "ompi/runtime/params.h"
 
 /*
 ** sort-function for MPI_Comm_split
 */
 static int rankkeycompare(const void *, const void *);
+static int colorrankkeycompare(const void *, const void *);
 
 /**
  * to fill the rest of the stuff for the communicator
@@ -398,6 +400,220 @@ int ompi_comm_create ( ompi_communicator_t *comm, ompi_group_t *group,
 }
 
 
+/*
+ * Distributed variant of the first step of ompi_comm_split for large
+ * intra-communicators. Instead of allgathering the (color, key) pairs of
+ * all processes and sorting them everywhere, every process sends its pair
+ * to the process owning its color (chosen by hashing the color). The
+ * owners learn that all pairs arrived through a nonblocking barrier,
+ * sort the members of each of their colors and send the sorted list to
+ * the first member, from which it is broadcast along a binomial tree
+ * over the new ranks. Each process only ever holds the members of its
+ * own new communicator.
+ *
+ * This relies on MPI_ANY_SOURCE receives on the parent communicator
+ * and must not be used if the communicator asserts mpi_assert_no_any_source.
+ */
+static int ompi_comm_split_distributed (ompi_communicator_t *comm, int color, int key,
+                                        int *my_size, int **ranks_out)
+{
+    int size = ompi_comm_size (comm), rank = ompi_comm_rank (comm);
+    int myinfo[2] = {color, key}, pair[2], owner, flag, n, v, i, j, lowbit, mask;
+    int *owned = NULL, owned_count = 0, owned_max = 0, *lists = NULL, *lranks = NULL;
+    ompi_request_t *send_req = MPI_REQUEST_NULL, *barrier_req = MPI_REQUEST_NULL;
+    ompi_request_t **reqs = NULL;
+    int nreqs = 0, max_reqs;
+    ompi_status_public_t status;
+    int rc = OMPI_SUCCESS;
+
+    /* Step 1: send (color, key) to the owner of the color, and receive the
+     * pairs of the colors this process owns until everybody's pair was
+     * received (nonblocking consensus: the synchronous sends complete
+     * once matched, the barrier completes once all sends did). */
+    if (MPI_UNDEFINED != color) {
+        owner = (int) (((uint32_t) color * 2654435761U) % (uint32_t) size);
+        rc = MCA_PML_CALL(isend (myinfo, 2, MPI_INT, owner, OMPI_COMM_SPLIT_TAG,
+                                 MCA_PML_BASE_SEND_SYNCHRONOUS, comm, &send_req));
+        if (OMPI_SUCCESS != rc) {
+            goto exit;
+        }
+    }
+
+    for (;;) {
+        rc = MCA_PML_CALL(iprobe (MPI_ANY_SOURCE, OMPI_COMM_SPLIT_TAG, comm, &flag, &status));
+        if (OMPI_SUCCESS != rc) {
+            goto exit;
+        }
+        if (flag) {
+            if (owned_count == owned_max) {
+                int *tmp;
+
+                owned_max = owned_max ? 2 * owned_max : 16;
+                tmp = (int *) realloc (owned, 3 * owned_max * sizeof (int));
+                if (NULL == tmp) {
+                    rc = OMPI_ERR_OUT_OF_RESOURCE;
+                    goto exit;
+                }
+                owned = tmp;
+            }
+            rc = MCA_PML_CALL(recv (pair, 2, MPI_INT, status.MPI_SOURCE, OMPI_COMM_SPLIT_TAG,
+                                    comm, MPI_STATUS_IGNORE));
+            if (OMPI_SUCCESS != rc) {
+                goto exit;
+            }
+            owned[3 * owned_count + 0] = status.MPI_SOURCE;  /* org rank */
+            owned[3 * owned_count + 1] = pair[1];            /* key */
+            owned[3 * owned_count + 2] = pair[0];            /* color */
+            owned_count++;
+            continue;
+        }
+
+        if (MPI_REQUEST_NULL == barrier_req) {
+            if (MPI_REQUEST_NULL != send_req) {
+                rc = ompi_request_test (&send_req, &flag, MPI_STATUS_IGNORE);
+                if (OMPI_SUCCESS != rc) {
+                    goto exit;
+                }
+                if (!flag) {
+                    continue;
+                }
+            }
+            rc = comm->c_coll->coll_ibarrier (comm, &barrier_req, comm->c_coll->coll_ibarrier_module);
+            if (OMPI_SUCCESS != rc) {
+                goto exit;
+            }
+        }
+
+        rc = ompi_request_test (&barrier_req, &flag, MPI_STATUS_IGNORE);
+        if (OMPI_SUCCESS != rc) {
+            goto exit;
+        }
+        if (flag) {
+            break;
+        }
+    }
+
+    /* Step 2: sort the owned pairs by color, key and rank, and send the list
+     * of members of each color to its first member. Members may be on this
+     * process, so the sends are only completed at the end. Room is left for
+     * one send per color and one per child in the tree. */
+    max_reqs = 8 * sizeof (int);
+    if (owned_count > 0) {
+        qsort (owned, owned_count, 3 * sizeof (int), colorrankkeycompare);
+
+        lists = (int *) malloc (owned_count * sizeof (int));
+        if (NULL == lists) {
+            rc = OMPI_ERR_OUT_OF_RESOURCE;
+            goto exit;
+        }
+        for (i = 0; i < owned_count; i++) {
+            lists[i] = owned[3 * i];
+            if (0 == i || owned[3 * i + 2] != owned[3 * (i - 1) + 2]) {
+                max_reqs++;
+            }
+        }
+    }
+
+    reqs = (ompi_request_t **) malloc (max_reqs * sizeof (ompi_request_t *));
+    if (NULL == reqs) {
+        rc = OMPI_ERR_OUT_OF_RESOURCE;
+        goto exit;
+    }
+
+    for (i = 0; i < owned_count; i = j) {
+        for (j = i + 1; j < owned_count && owned[3 * j + 2] == owned[3 * i + 2]; j++);
+        rc = MCA_PML_CALL(isend (lists + i, j - i, MPI_INT, lists[i], OMPI_COMM_SPLIT_BCAST_TAG,
+                                 MCA_PML_BASE_SEND_STANDARD, comm, reqs + nreqs));
+        if (OMPI_SUCCESS != rc) {
+            goto exit;
+        }
+        nreqs++;
+    }
+
+    /* Step 3: receive the list of my color from the owner or from my parent
+     * in the binomial tree, and forward it to my children */
+    if (MPI_UNDEFINED == color) {
+        /* this process is not part of any new communicator */
+        lranks = (int *) malloc (sizeof (int));
+        if (NULL == lranks) {
+            rc = OMPI_ERR_OUT_OF_RESOURCE;
+            goto exit;
+        }
+        lranks[0] = rank;
+        n = 1;
+    } else {
+        rc = MCA_PML_CALL(probe (MPI_ANY_SOURCE, OMPI_COMM_SPLIT_BCAST_TAG, comm, &status));
+        if (OMPI_SUCCESS != rc) {
+            goto exit;
+        }
+        n = (int) (status._ucount / sizeof (int));
+        lranks = (int *) malloc (n * sizeof (int));
+        if (NULL == lranks) {
+            rc = OMPI_ERR_OUT_OF_RESOURCE;
+            goto exit;
+        }
+        rc = MCA_PML_CALL(recv (lranks, n, MPI_INT, status.MPI_SOURCE, OMPI_COMM_SPLIT_BCAST_TAG,
+                                comm, MPI_STATUS_IGNORE));
+        if (OMPI_SUCCESS != rc) {
+            goto exit;
+        }
+
+        for (v = 0; v < n && lranks[v] != rank; v++);
+        if (v == n) {
+            rc = OMPI_ERR_BAD_PARAM;
+            goto exit;
+        }
+
+        /* larger subtrees first */
+        lowbit = (0 == v) ? opal_next_poweroftwo_inclusive (n) : (v & -v);
+        for (mask = lowbit >> 1; mask > 0; mask >>= 1) {
+            if (v + mask < n) {
+                rc = MCA_PML_CALL(isend (lranks, n, MPI_INT, lranks[v + mask], OMPI_COMM_SPLIT_BCAST_TAG,
+                                         MCA_PML_BASE_SEND_STANDARD, comm, reqs + nreqs));
+                if (OMPI_SUCCESS != rc) {
+                    goto exit;
+                }
+                nreqs++;
+            }
+        }
+    }
+
+    rc = ompi_request_wait_all (nreqs, reqs, MPI_STATUSES_IGNORE);
+    nreqs = 0;
+    if (OMPI_SUCCESS != rc) {
+        goto exit;
+    }
+
+    *my_size = n;
+    *ranks_out = lranks;
+    lranks = NULL;
+
+ exit:
+    /* both are only left over on the error paths of step 1 */
+    if (MPI_REQUEST_NULL != send_req) {
+        /* the owner may never match it now. the request is released once
+         * it is cancelled or matched */
+        (void) ompi_request_cancel (send_req);
+        (void) ompi_request_free (&send_req);
+    }
+    if (MPI_REQUEST_NULL != barrier_req) {
+        /* collective requests cannot be freed while active */
+        (void) ompi_request_wait (&barrier_req, MPI_STATUS_IGNORE);
+        if (MPI_REQUEST_NULL != barrier_req) {
+            (void) ompi_request_free (&barrier_req);
+        }
+    }
+    if (nreqs > 0) {
+        (void) ompi_request_wait_all (nreqs, reqs, MPI_STATUSES_IGNORE);
+    }
+    free (reqs);
+    free (lists);
+    free (owned);
+    free (lranks);
+
+    return rc;
+}
+
 /**********************************************************************/
 /**********************************************************************/
 /**********************************************************************/
@@ -432,6 +648,20 @@ int ompi_comm_split( ompi_communicator_t* comm, int color, int key,
 
     size     = ompi_comm_size ( comm );
     inter    = OMPI_COMM_IS_INTER(comm);
+
+    /* large intra-communicators avoid the allgather and the sort of the whole table */
+    if ( !inter && 0 < ompi_mpi_comm_split_threshold &&
+         size >= (int) ompi_mpi_comm_split_threshold &&
+         !OMPI_COMM_CHECK_ASSERT_NO_ANY_SOURCE(comm) ) {
+        rc = ompi_comm_split_distributed ( comm, color, key, &my_size, &lranks );
+        if ( OMPI_SUCCESS != rc ) {
+            goto exit;
+        }
+        rranks = NULL;
+        mode   = OMPI_COMM_CID_INTRA;
+        goto create;
+    }
+
     if ( inter ) {
         allgatherfct = (ompi_comm_allgatherfct *)ompi_comm_allgather_emulate_intra;
     } else {
@@ -566,7 +796,7 @@ int ompi_comm_split( ompi_communicator_t* comm, int color, int key,
     /* Step 3: set up the communicator                           */
     /* --------------------------------------------------------- */
     /* Create the communicator finally */
-
+ create:
     rc = ompi_comm_set ( &newcomp,           /* new comm */
                          comm,               /* old comm */
                          my_size,            /* local_size */
@@ -1867,6 +2097,17 @@ static int rankkeycompare (const void *p, const void *q)
     return ( 0 );
 }
 
+/* same as rankkeycompare, on (rank, key, color) triples sorted by color first */
+static int colorrankkeycompare (const void *p, const void *q)
+{
+    const int *a = (const int *) p, *b = (const int *) q;
+
+    if (a[2] != b[2]) {
+        return (a[2] < b[2]) ? -1 : 1;
+    }
+    return rankkeycompare (p, q);
+}
+
 
 /***********************************************************************
  * Counterpart of MPI_Cart/Graph_create. This will be called from the
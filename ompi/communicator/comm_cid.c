@@ -47,6 +47,7 @@
 #include "ompi/mca/coll/base/base.h"
 #include "ompi/request/request.h"
 #include "ompi/runtime/mpiruntime.h"
+#include "ompi/runtime/params.h"
 
 struct ompi_comm_cid_context_t;
 
@@ -68,6 +69,9 @@ struct ompi_comm_cid_context_t {
     int nextcid;
     int nextlocal_cid;
     int start;
+    /** number of consecutive cids to agree on. the first one goes to
+     * newcomm, the others are kept in reserve on comm */
+    int block;
     int flag, rflag;
     int local_leader;
     int remote_leader;
@@ -164,6 +168,82 @@ int ompi_comm_cid_init (void)
     return OMPI_SUCCESS;
 }
 
+static void ompi_comm_cid_release (unsigned int first, int count)
+{
+    for (int i = 0 ; i < count ; ++i) {
+        opal_pointer_array_set_item (&ompi_mpi_communicators, first + i, NULL);
+    }
+}
+
+/* reserve count consecutive cids starting at first. returns the number of cids
+ * that were free: if it is less than count nothing is reserved and the cid at
+ * first plus the return value is in use */
+static int ompi_comm_cid_reserve (unsigned int first, int count, ompi_communicator_t *comm)
+{
+    int i;
+
+    for (i = 0 ; i < count ; ++i) {
+        if (!opal_pointer_array_test_and_set_item (&ompi_mpi_communicators, first + i, comm)) {
+            ompi_comm_cid_release (first, i);
+            break;
+        }
+    }
+
+    return i;
+}
+
+/* hand out the next cid of the block reserved on comm, if there is one left.
+ * all processes of comm reserved the same block and consume it in the order
+ * the communicators are created, so no communication is needed. */
+static bool ompi_comm_nextcid_from_block (ompi_communicator_t *newcomm, ompi_communicator_t *comm,
+                                          int mode)
+{
+    bool found = false;
+
+    if (OMPI_COMM_CID_INTRA != mode || OMPI_COMM_IS_INTER(comm) ||
+        ompi_mpi_comm_cid_block_size < 2 || MPI_UNDEFINED == comm->c_id_available) {
+        return false;
+    }
+
+    OPAL_THREAD_LOCK(&ompi_cid_lock);
+    if ((uint32_t) comm->c_id_available < (uint32_t) comm->c_id_start_index + ompi_mpi_comm_cid_block_size) {
+        newcomm->c_contextid = comm->c_id_available++;
+        opal_pointer_array_set_item (&ompi_mpi_communicators, newcomm->c_contextid, newcomm);
+        found = true;
+    }
+    OPAL_THREAD_UNLOCK(&ompi_cid_lock);
+
+    return found;
+}
+
+/* give back the unused part of the block of comm. must be called with
+ * ompi_cid_lock held */
+static void ompi_comm_cid_release_block_locked (ompi_communicator_t *comm)
+{
+    if (MPI_UNDEFINED == comm->c_id_available) {
+        return;
+    }
+
+    for (uint32_t i = comm->c_id_available ; i < (uint32_t) comm->c_id_start_index + ompi_mpi_comm_cid_block_size ; ++i) {
+        if (comm == opal_pointer_array_get_item (&ompi_mpi_communicators, i)) {
+            opal_pointer_array_set_item (&ompi_mpi_communicators, i, NULL);
+        }
+    }
+    comm->c_id_available = MPI_UNDEFINED;
+    comm->c_id_start_index = MPI_UNDEFINED;
+}
+
+void ompi_comm_cid_release_block (ompi_communicator_t *comm)
+{
+    if (MPI_UNDEFINED == comm->c_id_available) {
+        return;
+    }
+
+    OPAL_THREAD_LOCK(&ompi_cid_lock);
+    ompi_comm_cid_release_block_locked (comm);
+    OPAL_THREAD_UNLOCK(&ompi_cid_lock);
+}
+
 static ompi_comm_cid_context_t *mca_comm_cid_context_alloc (ompi_communicator_t *newcomm, ompi_communicator_t *comm,
                                                             ompi_communicator_t *bridgecomm, const void *arg0,
                                                             const void *arg1, const char *pmix_tag, bool send_first,
@@ -248,9 +328,15 @@ static int ompi_comm_nextcid_check_flag (ompi_comm_request_t *request);
 
 static volatile int64_t ompi_comm_cid_lowest_id = INT64_MAX;
 
-int ompi_comm_nextcid_nb (ompi_communicator_t *newcomm, ompi_communicator_t *comm,
-                          ompi_communicator_t *bridgecomm, const void *arg0, const void *arg1,
-                          bool send_first, int mode, ompi_request_t **req)
+/* start the agreement on the cid of newcomm. only the blocking version
+ * reserves and consumes blocks: the block of comm is then changed at
+ * points every process reaches in the same order. a non-blocking
+ * agreement completes at a different time on each process, so a later
+ * creation on comm could not tell consistently whether its block is
+ * already in place. */
+static int ompi_comm_nextcid_start (ompi_communicator_t *newcomm, ompi_communicator_t *comm,
+                                    ompi_communicator_t *bridgecomm, const void *arg0, const void *arg1,
+                                    bool send_first, int mode, bool use_block, ompi_request_t **req)
 {
     ompi_comm_cid_context_t *context;
     ompi_comm_request_t *request;
@@ -262,6 +348,12 @@ int ompi_comm_nextcid_nb (ompi_communicator_t *newcomm, ompi_communicator_t *com
     }
 
     context->start = ompi_mpi_communicators.lowest_free;
+    context->block = 1;
+    if (use_block && OMPI_COMM_CID_INTRA == mode && !OMPI_COMM_IS_INTER(comm) &&
+        ompi_mpi_comm_cid_block_size > 1) {
+        /* the block of comm is used up (or was never reserved), agree on a new one */
+        context->block = ompi_mpi_comm_cid_block_size;
+    }
 
     request = ompi_comm_request_get ();
     if (NULL == request) {
@@ -280,6 +372,14 @@ int ompi_comm_nextcid_nb (ompi_communicator_t *newcomm, ompi_communicator_t *com
     return OMPI_SUCCESS;
 }
 
+int ompi_comm_nextcid_nb (ompi_communicator_t *newcomm, ompi_communicator_t *comm,
+                          ompi_communicator_t *bridgecomm, const void *arg0, const void *arg1,
+                          bool send_first, int mode, ompi_request_t **req)
+{
+    return ompi_comm_nextcid_start (newcomm, comm, bridgecomm, arg0, arg1, send_first,
+                                    mode, false, req);
+}
+
 int ompi_comm_nextcid (ompi_communicator_t *newcomm, ompi_communicator_t *comm,
                        ompi_communicator_t *bridgecomm, const void *arg0, const void *arg1,
                        bool send_first, int mode)
@@ -287,7 +387,12 @@ int ompi_comm_nextcid (ompi_communicator_t *newcomm, ompi_communicator_t *comm,
     ompi_request_t *req;
     int rc;
 
-    rc = ompi_comm_nextcid_nb (newcomm, comm, bridgecomm, arg0, arg1, send_first, mode, &req);
+    if (ompi_comm_nextcid_from_block (newcomm, comm, mode)) {
+        return OMPI_SUCCESS;
+    }
+
+    rc = ompi_comm_nextcid_start (newcomm, comm, bridgecomm, arg0, arg1, send_first,
+                                  mode, true, &req);
     if (OMPI_SUCCESS != rc) {
         return rc;
     }
@@ -306,7 +411,10 @@ static int ompi_comm_allreduce_getnextcid (ompi_comm_request_t *request)
     ompi_request_t *subreq;
     bool flag = false;
     int ret = OMPI_SUCCESS;
-    int participate = (context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED);
+    /* a block is reserved by all processes of comm, whether they are part of
+     * newcomm or not, as later communicators created from comm may include them */
+    int participate = (context->block > 1 ||
+                       context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED);
 
     if (OPAL_THREAD_TRYLOCK(&ompi_cid_lock)) {
         return ompi_comm_request_schedule_append (request, ompi_comm_allreduce_getnextcid, NULL, 0);
@@ -325,13 +433,15 @@ static int ompi_comm_allreduce_getnextcid (ompi_comm_request_t *request)
     if( participate ){
         flag = false;
         context->nextlocal_cid = mca_pml.pml_max_contextid;
-        for (unsigned int i = context->start ; i < mca_pml.pml_max_contextid ; ++i) {
-            flag = opal_pointer_array_test_and_set_item (&ompi_mpi_communicators, i,
-                                                         context->comm);
-            if (true == flag) {
+        for (unsigned int i = context->start ; i + context->block <= mca_pml.pml_max_contextid ; ++i) {
+            int reserved = ompi_comm_cid_reserve (i, context->block, context->comm);
+            if (reserved == context->block) {
+                flag = true;
                 context->nextlocal_cid = i;
                 break;
             }
+            /* no block can start before the cid found in use */
+            i += reserved;
         }
     } else {
         context->nextlocal_cid = 0;
@@ -346,8 +456,9 @@ static int ompi_comm_allreduce_getnextcid (ompi_comm_request_t *request)
         goto err_exit;
     }
 
-    if ( ((unsigned int) context->nextlocal_cid == mca_pml.pml_max_contextid) ) {
-        /* Our local CID space is out, others already aware (allreduce above) */
+    if ( 1 == context->block && ((unsigned int) context->nextlocal_cid == mca_pml.pml_max_contextid) ) {
+        /* Our local CID space is out, others already aware (allreduce above).
+         * When looking for a block ompi_comm_checkcid falls back to a single cid. */
         ret = OMPI_ERR_OUT_OF_RESOURCE;
         goto err_exit;
     }
@@ -357,7 +468,7 @@ static int ompi_comm_allreduce_getnextcid (ompi_comm_request_t *request)
     return ompi_comm_request_schedule_append (request, ompi_comm_checkcid, &subreq, 1);
 err_exit:
     if (participate && flag) {
-        opal_pointer_array_test_and_set_item(&ompi_mpi_communicators, context->nextlocal_cid, NULL);
+        ompi_comm_cid_release (context->nextlocal_cid, context->block);
     }
     ompi_comm_cid_lowest_id = INT64_MAX;
     OPAL_THREAD_UNLOCK(&ompi_cid_lock);
@@ -370,11 +481,14 @@ static int ompi_comm_checkcid (ompi_comm_request_t *request)
     ompi_comm_cid_context_t *context = (ompi_comm_cid_context_t *) request->context;
     ompi_request_t *subreq;
     int ret;
-    int participate = (context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED);
+    int participate = (context->block > 1 ||
+                       context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED);
+    /* whether this process found room for the cids it proposed */
+    bool reserved = ((unsigned int) context->nextlocal_cid + context->block <= mca_pml.pml_max_contextid);
 
     if (OMPI_SUCCESS != request->super.req_status.MPI_ERROR) {
-        if (participate) {
-            opal_pointer_array_set_item(&ompi_mpi_communicators, context->nextlocal_cid, NULL);
+        if (participate && reserved) {
+            ompi_comm_cid_release (context->nextlocal_cid, context->block);
         }
         return request->super.req_status.MPI_ERROR;
     }
@@ -383,15 +497,28 @@ static int ompi_comm_checkcid (ompi_comm_request_t *request)
         return ompi_comm_request_schedule_append (request, ompi_comm_checkcid, NULL, 0);
     }
 
+    if (context->block > 1 &&
+        (unsigned int) context->nextcid + context->block > mca_pml.pml_max_contextid) {
+        /* some process has no room left for a block. everybody sees the same
+         * result, so all of them go back to agreeing on a single cid */
+        if (reserved) {
+            ompi_comm_cid_release (context->nextlocal_cid, context->block);
+        }
+        context->block = 1;
+        OPAL_THREAD_UNLOCK(&ompi_cid_lock);
+
+        return ompi_comm_allreduce_getnextcid (request);
+    }
+
     if( !participate ){
         context->flag = 1;
     } else {
         context->flag = (context->nextcid == context->nextlocal_cid);
         if ( participate && !context->flag) {
-            opal_pointer_array_set_item(&ompi_mpi_communicators, context->nextlocal_cid, NULL);
+            ompi_comm_cid_release (context->nextlocal_cid, context->block);
 
-            context->flag = opal_pointer_array_test_and_set_item (&ompi_mpi_communicators,
-                                                                  context->nextcid, context->comm);
+            context->flag = (context->block == ompi_comm_cid_reserve (context->nextcid, context->block,
+                                                                      context->comm));
         }
     }
 
@@ -402,7 +529,7 @@ static int ompi_comm_checkcid (ompi_comm_request_t *request)
         ompi_comm_request_schedule_append (request, ompi_comm_nextcid_check_flag, &subreq, 1);
     } else {
         if (participate && context->flag ) {
-            opal_pointer_array_test_and_set_item(&ompi_mpi_communicators, context->nextlocal_cid, NULL);
+            ompi_comm_cid_release (context->nextcid, context->block);
         }
         ompi_comm_cid_lowest_id = INT64_MAX;
     }
@@ -414,11 +541,12 @@ static int ompi_comm_checkcid (ompi_comm_request_t *request)
 static int ompi_comm_nextcid_check_flag (ompi_comm_request_t *request)
 {
     ompi_comm_cid_context_t *context = (ompi_comm_cid_context_t *) request->context;
-    int participate = (context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED);
+    int participate = (context->block > 1 ||
+                       context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED);
 
     if (OMPI_SUCCESS != request->super.req_status.MPI_ERROR) {
-        if (participate) {
-            opal_pointer_array_set_item(&ompi_mpi_communicators, context->nextcid, NULL);
+        if (participate && context->flag) {
+            ompi_comm_cid_release (context->nextcid, context->block);
         }
         return request->super.req_status.MPI_ERROR;
     }
@@ -446,6 +574,16 @@ static int ompi_comm_nextcid_check_flag (ompi_comm_request_t *request)
             context->nextcid = context->nextlocal_cid;
         }
 
+        if (context->block > 1) {
+            /* the first cid of the block goes to newcomm, the rest stays
+             * reserved for the next communicators created from comm. a new
+             * block is only requested once the previous one is used up, so
+             * there is normally nothing left to give back here */
+            ompi_comm_cid_release_block_locked (context->comm);
+            context->comm->c_id_start_index = context->nextcid;
+            context->comm->c_id_available = context->nextcid + 1;
+        }
+
         /* set the according values to the newcomm */
         context->newcomm->c_contextid = context->nextcid;
         opal_pointer_array_set_item (&ompi_mpi_communicators, context->nextcid, context->newcomm);
@@ -460,7 +598,7 @@ static int ompi_comm_nextcid_check_flag (ompi_comm_request_t *request)
 
     if (participate && (0 != context->flag)) {
         /* we could use this cid, but other don't agree */
-        opal_pointer_array_set_item (&ompi_mpi_communicators, context->nextcid, NULL);
+        ompi_comm_cid_release (context->nextcid, context->block);
         context->start = context->nextcid + 1; /* that's where we can start the next round */
     }
 
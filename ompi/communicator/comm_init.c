@@ -42,6 +42,7 @@
 #include "ompi/mca/coll/base/base.h"
 #include "ompi/mca/topo/base/base.h"
 #include "ompi/runtime/params.h"
+#include "ompi/runtime/ompi_spc.h"
 #include "ompi/communicator/communicator.h"
 #include "ompi/attribute/attribute.h"
 #include "ompi/dpm/dpm.h"
@@ -128,8 +129,8 @@ int ompi_comm_init(void)
     ompi_set_group_rank(group, ompi_proc_local());
 
     ompi_mpi_comm_world.comm.c_contextid    = 0;
-    ompi_mpi_comm_world.comm.c_id_start_index = 4;
-    ompi_mpi_comm_world.comm.c_id_available = 4;
+    ompi_mpi_comm_world.comm.c_id_start_index = MPI_UNDEFINED;
+    ompi_mpi_comm_world.comm.c_id_available = MPI_UNDEFINED;
     ompi_mpi_comm_world.comm.c_my_rank      = group->grp_my_rank;
     ompi_mpi_comm_world.comm.c_local_group  = group;
     ompi_mpi_comm_world.comm.c_remote_group = group;
@@ -182,8 +183,8 @@ int ompi_comm_init(void)
     OMPI_GROUP_SET_DENSE (group);
 
     ompi_mpi_comm_self.comm.c_contextid    = 1;
-    ompi_mpi_comm_self.comm.c_id_start_index = 20;
-    ompi_mpi_comm_self.comm.c_id_available = 20;
+    ompi_mpi_comm_self.comm.c_id_start_index = MPI_UNDEFINED;
+    ompi_mpi_comm_self.comm.c_id_available = MPI_UNDEFINED;
     ompi_mpi_comm_self.comm.c_my_rank      = group->grp_my_rank;
     ompi_mpi_comm_self.comm.c_local_group  = group;
     ompi_mpi_comm_self.comm.c_remote_group = group;
@@ -321,7 +322,8 @@ int ompi_comm_finalize(void)
     max = opal_pointer_array_get_size(&ompi_mpi_communicators);
     for ( i=3; i<max; i++ ) {
         comm = (ompi_communicator_t *)opal_pointer_array_get_item(&ompi_mpi_communicators, i);
-        if ( NULL != comm ) {
+        /* skip the cids a communicator keeps in reserve for its children */
+        if ( NULL != comm && i == (int) comm->c_contextid ) {
             /* Communicator has not been freed before finalize */
             OBJ_RELEASE(comm);
             comm=(ompi_communicator_t *)opal_pointer_array_get_item(&ompi_mpi_communicators, i);
@@ -386,6 +388,9 @@ static void ompi_comm_construct(ompi_communicator_t* comm)
     comm->errhandler_type  = OMPI_ERRHANDLER_TYPE_COMM;
 #ifdef OMPI_WANT_PERUSE
     comm->c_peruse_handles = NULL;
+#endif
+#if SPC_ENABLE == 1
+    comm->c_spc = NULL;
 #endif
     OBJ_CONSTRUCT(&comm->c_lock, opal_mutex_t);
 }
@@ -450,6 +455,11 @@ static void ompi_comm_destruct(ompi_communicator_t* comm)
         comm->error_handler = NULL;
     }
 
+    SPC_COMM_RELEASE(comm);
+
+    /* give back the cids reserved for children of this communicator */
+    ompi_comm_cid_release_block (comm);
+
     /* mark this cid as available */
     if ( MPI_UNDEFINED != (int)comm->c_contextid &&
          NULL != opal_pointer_array_get_item(&ompi_mpi_communicators,
@@ -92,6 +92,8 @@ OMPI_DECLSPEC OBJ_CLASS_DECLARATION(ompi_communicator_t);
 #define OMPI_COMM_ALLGATHER_TAG -31078
 #define OMPI_COMM_BARRIER_TAG   -31079
 #define OMPI_COMM_ALLREDUCE_TAG -31080
+#define OMPI_COMM_SPLIT_TAG     -31081
+#define OMPI_COMM_SPLIT_BCAST_TAG -31082
 
 #define OMPI_COMM_ASSERT_NO_ANY_TAG     0x00000001
 #define OMPI_COMM_ASSERT_NO_ANY_SOURCE  0x00000002
@@ -143,9 +145,10 @@ struct ompi_communicator_t {
     uint32_t                  c_assertions; /* info assertions */
 
     int c_id_available; /* the currently available Cid for allocation
-               to a child*/
+               to a child, MPI_UNDEFINED if there is no block */
     int c_id_start_index; /* the starting index of the block of cids
-                 allocated to this communicator*/
+                 reserved by this communicator for its children
+                 (see mpi_comm_cid_block_size) */
 
     ompi_group_t        *c_local_group;
     ompi_group_t       *c_remote_group;
@@ -187,6 +190,12 @@ struct ompi_communicator_t {
 
     /* Collectives module interface and data */
     mca_coll_base_comm_coll_t *c_coll;
+
+#if SPC_ENABLE == 1
+    /* Communicator bound software performance counters, one block
+       per counter shard (see ompi/runtime/ompi_spc.h) */
+    opal_atomic_size_t *c_spc;
+#endif
 };
 typedef struct ompi_communicator_t ompi_communicator_t;
 
@@ -575,6 +584,8 @@ OMPI_DECLSPEC int ompi_comm_nextcid (ompi_communicator_t *newcomm, ompi_communic
  * @param mode: combination of input
  *              OMPI_COMM_CID_INTRA:        intra-comm
  *              OMPI_COMM_CID_INTER:        inter-comm
+ * Always agrees on a single cid, the block reserved on oldcomm (see
+ * ompi_mpi_comm_cid_block_size) is only used by ompi_comm_nextcid.
  * This routine has to be thread safe in the final version.
  */
 OMPI_DECLSPEC int ompi_comm_nextcid_nb (ompi_communicator_t *newcomm, ompi_communicator_t *comm,
@@ -712,6 +723,12 @@ extern int ompi_comm_num_dyncomm;
 */
 OMPI_DECLSPEC int ompi_comm_cid_init ( void );
 
+/**
+ * Release the unused cids of the block reserved on a communicator
+ * (see mpi_comm_cid_block_size).
+ */
+void ompi_comm_cid_release_block (ompi_communicator_t *comm);
+
 
 void ompi_comm_assert_subscribe (ompi_communicator_t *comm, int32_t assert_flag);
 
@@ -30,8 +30,16 @@
 #include "ompi/constants.h"
 #include "ompi/proc/proc.h"
 #include "ompi/runtime/params.h"
+#include "opal/class/opal_hash_table.h"
 #include "mpi.h"
 
+/* longest chain of sparse groups searched for a common ancestor */
+#define OMPI_GROUP_MAX_DEPTH 16
+
+/* number of ranks from which ompi_group_translate_ranks() indexes the
+ * processes of the second group of two unrelated groups */
+#define OMPI_GROUP_TRANSLATE_HASH_MIN 8
+
 int ompi_group_free ( ompi_group_t **group )
 {
     ompi_group_t *l_group;
@@ -43,6 +51,58 @@ int ompi_group_free ( ompi_group_t **group )
     return OMPI_SUCCESS;
 }
 
+#if OMPI_GROUP_SPARSE
+/*
+ * Translate ranks through the closest group both groups are derived
+ * from: up the parent chain of group1 and down the one of group2, one
+ * sparse translation per level.  Returns OMPI_ERR_NOT_FOUND if the
+ * groups have no common ancestor.
+ */
+static int ompi_group_translate_ranks_common (ompi_group_t *group1,
+                                              int n_ranks, const int *ranks1,
+                                              ompi_group_t *group2,
+                                              int *ranks2)
+{
+    ompi_group_t *ancestor, *group, *path[OMPI_GROUP_MAX_DEPTH];
+    int depth;
+
+    for (ancestor = group1 ; NULL != ancestor ; ancestor = ancestor->grp_parent_group_ptr) {
+        /* record the chain from group2 up to ancestor */
+        for (depth = 0, group = group2 ; NULL != group && group != ancestor &&
+                 depth < OMPI_GROUP_MAX_DEPTH ; group = group->grp_parent_group_ptr) {
+            path[depth++] = group;
+        }
+        if (group == ancestor) {
+            break;
+        }
+    }
+
+    if (NULL == ancestor || (ancestor == group1 && 1 == depth)) {
+        /* unrelated groups, or a direct parent handled by the caller */
+        return OMPI_ERR_NOT_FOUND;
+    }
+
+    for (int proc = 0 ; proc < n_ranks ; ++proc) {
+        int rank = ranks1[proc], tmp;
+
+        for (group = group1 ; group != ancestor && MPI_PROC_NULL != rank ;
+             group = group->grp_parent_group_ptr) {
+            ompi_group_translate_ranks (group, 1, &rank, group->grp_parent_group_ptr, &tmp);
+            rank = tmp;
+        }
+
+        for (int i = depth - 1 ; i >= 0 && MPI_PROC_NULL != rank && MPI_UNDEFINED != rank ; --i) {
+            ompi_group_translate_ranks (path[i]->grp_parent_group_ptr, 1, &rank, path[i], &tmp);
+            rank = tmp;
+        }
+
+        ranks2[proc] = rank;
+    }
+
+    return OMPI_SUCCESS;
+}
+#endif
+
 int ompi_group_translate_ranks ( ompi_group_t *group1,
                                  int n_ranks, const int *ranks1,
                                  ompi_group_t *group2,
@@ -76,6 +136,10 @@ int ompi_group_translate_ranks ( ompi_group_t *group1,
             return ompi_group_translate_ranks_bmap_reverse
                 (group1,n_ranks,ranks1,group2,ranks2);
         }
+        else if(OMPI_GROUP_IS_RANGES(group1)) {
+            return ompi_group_translate_ranks_ranges_reverse
+                (group1,n_ranks,ranks1,group2,ranks2);
+        }
 
         /* unknown sparse group type */
         assert (0);
@@ -94,12 +158,55 @@ int ompi_group_translate_ranks ( ompi_group_t *group1,
             return ompi_group_translate_ranks_bmap
                 (group1,n_ranks,ranks1,group2,ranks2);
         }
+        else if(OMPI_GROUP_IS_RANGES(group2)) {
+            return ompi_group_translate_ranks_ranges
+                (group1,n_ranks,ranks1,group2,ranks2);
+        }
 
         /* unknown sparse group type */
         assert (0);
     }
+
+    /* groups derived from the same group, e.g. the groups of two
+     * communicators split from the same parent */
+    if (OMPI_SUCCESS == ompi_group_translate_ranks_common (group1, n_ranks, ranks1,
+                                                           group2, ranks2)) {
+        return MPI_SUCCESS;
+    }
 #endif
 
+    /* translating more than a few ranks: index the processes of group2
+     * once instead of searching group2 for every rank */
+    if (n_ranks >= OMPI_GROUP_TRANSLATE_HASH_MIN) {
+        opal_hash_table_t procs2;
+        void *value;
+
+        OBJ_CONSTRUCT(&procs2, opal_hash_table_t);
+        if (OPAL_SUCCESS == opal_hash_table_init(&procs2, group2->grp_proc_count)) {
+            for (int proc2 = 0; proc2 < group2->grp_proc_count; ++proc2) {
+                (void) opal_hash_table_set_value_uint64(&procs2, (uint64_t) (uintptr_t)
+                                                        ompi_group_get_proc_ptr_raw (group2, proc2),
+                                                        (void *) (intptr_t) proc2);
+            }
+
+            for (int proc = 0; proc < n_ranks; ++proc) {
+                if ( MPI_PROC_NULL == ranks1[proc]) {
+                    ranks2[proc] = MPI_PROC_NULL;
+                } else if (OPAL_SUCCESS == opal_hash_table_get_value_uint64(&procs2, (uint64_t) (uintptr_t)
+                                                                            ompi_group_get_proc_ptr_raw (group1, ranks1[proc]),
+                                                                            &value)) {
+                    ranks2[proc] = (int) (intptr_t) value;
+                } else {
+                    ranks2[proc] = MPI_UNDEFINED;
+                }
+            }
+
+            OBJ_DESTRUCT(&procs2);
+            return MPI_SUCCESS;
+        }
+        OBJ_DESTRUCT(&procs2);
+    }
+
     /* loop over all ranks */
     for (int proc = 0; proc < n_ranks; ++proc) {
         struct ompi_proc_t *proc1_pointer, *proc2_pointer;
@@ -168,6 +275,21 @@ int ompi_group_dump (ompi_group_t* group)
             printf("%d\t",group->sparse_data.grp_bitmap.grp_bitmap_array[i]);
         }
     }
+    else if (OMPI_GROUP_IS_RANGES(group)) {
+        ompi_group_translate_ranks( group,1,&group->grp_my_rank,
+                                    group->grp_parent_group_ptr,
+                                    &new_rank);
+        printf("Rank in the parent group: %d\n",new_rank);
+        printf("The Range List Length: %d\n",
+               group->sparse_data.grp_ranges.grp_ranges_len);
+        printf("Rank First       Stride       Length\n");
+        for(i=0 ; i<group->sparse_data.grp_ranges.grp_ranges_len ; i++) {
+            printf("%d               %d            %d\n",
+                   group->sparse_data.grp_ranges.grp_ranges[i].rank_first,
+                   group->sparse_data.grp_ranges.grp_ranges[i].stride,
+                   group->sparse_data.grp_ranges.grp_ranges[i].length);
+        }
+    }
     printf("*********************************************************\n");
     return OMPI_SUCCESS;
 }
@@ -196,9 +318,13 @@ int ompi_group_incl(ompi_group_t* group, int n, const int *ranks, ompi_group_t *
     if (ompi_use_sparse_group_storage) {
         int len [4];
 
+        /* the range list stores everything a sporadic list does and
+         * translates ranks with a binary search instead of a walk over
+         * the list, so it takes the place of the sporadic list here.
+         * without --enable-sparse-groups every group is dense */
         len[0] = ompi_group_calc_plist    ( n ,ranks );
         len[1] = ompi_group_calc_strided  ( n ,ranks );
-        len[2] = ompi_group_calc_sporadic ( n ,ranks );
+        len[2] = ompi_group_calc_ranges   ( n ,ranks );
         len[3] = ompi_group_calc_bmap     ( n , group->grp_proc_count ,ranks );
 
         /* determin minimum length */
@@ -215,7 +341,7 @@ int ompi_group_incl(ompi_group_t* group, int n, const int *ranks, ompi_group_t *
             result = ompi_group_incl_strided(group, n, ranks, new_group);
             break;
         case 2:
-            result = ompi_group_incl_spor(group, n, ranks, new_group);
+            result = ompi_group_incl_ranges(group, n, ranks, new_group);
             break;
         default:
             result = ompi_group_incl_bmap(group, n, ranks, new_group);
@@ -491,7 +617,7 @@ int ompi_group_compare(ompi_group_t *group1,
                        int *result)
 {
     int return_value = OMPI_SUCCESS;
-    int proc1, proc2, match;
+    int proc1, proc2;
     bool similar, identical;
     ompi_group_t *group1_pointer, *group2_pointer;
     ompi_proc_t *proc1_pointer, *proc2_pointer;
@@ -519,30 +645,47 @@ int ompi_group_compare(ompi_group_t *group1,
         return return_value;
     }
 
-    /* check for similarity */
-    /* loop over group1 processes */
+    /* check for identity: same processes in the same order */
     similar=true;
     identical=true;
     for(proc1=0 ; proc1 < group1_pointer->grp_proc_count ; proc1++ ) {
-        proc1_pointer= ompi_group_peer_lookup(group1_pointer,proc1);
-        /* loop over group2 processes to find "match" */
-        match=-1;
+        if (ompi_group_peer_lookup(group1_pointer,proc1) !=
+            ompi_group_peer_lookup(group2_pointer,proc1)) {
+            identical=false;
+            break;
+        }
+    }
+
+    /* check for similarity: look the remaining processes of group1 up
+     * in a table of the processes of group2 */
+    if (!identical) {
+        opal_hash_table_t procs2;
+        void *value;
+
+        OBJ_CONSTRUCT(&procs2, opal_hash_table_t);
+        return_value = opal_hash_table_init(&procs2, group2_pointer->grp_proc_count);
+        if (OPAL_SUCCESS != return_value) {
+            OBJ_DESTRUCT(&procs2);
+            return return_value;
+        }
+
         for(proc2=0 ; proc2 < group2_pointer->grp_proc_count ; proc2++ ) {
             proc2_pointer=ompi_group_peer_lookup(group2_pointer,proc2);
-            if( proc1_pointer == proc2_pointer ) {
-                if(proc1 != proc2 ) {
-                    identical=false;
-                }
-                match=proc2;
+            (void) opal_hash_table_set_value_uint64(&procs2, (uint64_t) (uintptr_t) proc2_pointer,
+                                                    proc2_pointer);
+        }
+
+        for( ; proc1 < group1_pointer->grp_proc_count ; proc1++ ) {
+            proc1_pointer= ompi_group_peer_lookup(group1_pointer,proc1);
+            if (OPAL_SUCCESS != opal_hash_table_get_value_uint64(&procs2, (uint64_t) (uintptr_t) proc1_pointer,
+                                                                 &value)) {
+                similar=false;
                 break;
             }
-        } /* end proc2 loop */
-        if( match== -1 ) {
-            similar=false;
-            identical=false;
-            break;
         }
-    } /* end proc1 loop */
+
+        OBJ_DESTRUCT(&procs2);
+    }
 
     /* set comparison result */
     if( identical ) {
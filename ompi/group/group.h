@@ -66,6 +66,19 @@ struct ompi_group_bitmap_data_t
     unsigned char *grp_bitmap_array;     /* the bit map array for sparse groups of type BMAP */
     int            grp_bitmap_array_len; /* length of the bit array */
 };
+struct ompi_group_range_t
+{
+    int rank_first;   /** rank in the parent group of the first process of the run */
+    int stride;       /** distance between consecutive parent ranks (may be negative) */
+    int length;       /** number of processes in the run */
+    int offset;       /** rank in the group of the first process of the run */
+};
+struct ompi_group_ranges_data_t
+{
+    struct ompi_group_range_t *grp_ranges;  /** runs in group rank order */
+    int *grp_ranges_order;  /** runs by lowest parent rank, NULL if that is the same order */
+    int  grp_ranges_len;    /** number of runs */
+};
 
 /**
  * Group structure
@@ -79,6 +92,8 @@ struct ompi_group_bitmap_data_t
  * Bitmap: a sparse format that maintains a bitmap of the included processes from the
  *         parent group. For each process that is included from the parent group
  *         its corresponding rank is set in the bitmap array.
+ * Ranges: a sparse format that stores the ranks taken from the parent group as a list
+ *         of strided runs. Translating a rank in either direction is a binary search.
  */
 struct ompi_group_t {
     opal_object_t super;    /**< base class */
@@ -96,6 +111,7 @@ struct ompi_group_t {
         struct ompi_group_sporadic_data_t grp_sporadic;
         struct ompi_group_strided_data_t  grp_strided;
         struct ompi_group_bitmap_data_t   grp_bitmap;
+        struct ompi_group_ranges_data_t   grp_ranges;
     } sparse_data;
 };
 
@@ -128,12 +144,14 @@ typedef struct ompi_predefined_group_t ompi_predefined_group_t;
 #define OMPI_GROUP_IS_SPORADIC(_group) ((_group)->grp_flags & OMPI_GROUP_SPORADIC)
 #define OMPI_GROUP_IS_STRIDED(_group) ((_group)->grp_flags & OMPI_GROUP_STRIDED)
 #define OMPI_GROUP_IS_BITMAP(_group) ((_group)->grp_flags & OMPI_GROUP_BITMAP)
+#define OMPI_GROUP_IS_RANGES(_group) ((_group)->grp_flags & OMPI_GROUP_RANGES)
 
 #define OMPI_GROUP_SET_INTRINSIC(_group) ( (_group)->grp_flags |= OMPI_GROUP_INTRINSIC)
 #define OMPI_GROUP_SET_DENSE(_group) ( (_group)->grp_flags |= OMPI_GROUP_DENSE)
 #define OMPI_GROUP_SET_SPORADIC(_group) ( (_group)->grp_flags |= OMPI_GROUP_SPORADIC)
 #define OMPI_GROUP_SET_STRIDED(_group) ( (_group)->grp_flags |= OMPI_GROUP_STRIDED)
 #define OMPI_GROUP_SET_BITMAP(_group) ( (_group)->grp_flags |= OMPI_GROUP_BITMAP)
+#define OMPI_GROUP_SET_RANGES(_group) ( (_group)->grp_flags |= OMPI_GROUP_RANGES)
 
 /**
  * Table for Fortran <-> C group handle conversion
@@ -159,6 +177,7 @@ ompi_group_t *ompi_group_allocate_plist_w_procs (ompi_proc_t **procs, int group_
 ompi_group_t *ompi_group_allocate_sporadic(int group_size);
 ompi_group_t *ompi_group_allocate_strided(void);
 ompi_group_t *ompi_group_allocate_bmap(int orig_group_size, int group_size);
+ompi_group_t *ompi_group_allocate_ranges(int n_ranges);
 
 /**
  * Increment the reference count of the proc structures.
@@ -279,6 +298,14 @@ int ompi_group_translate_ranks_bmap_reverse ( ompi_group_t *group1,
                                  int n_ranks, const int *ranks1,
                                  ompi_group_t *group2,
                                  int *ranks2);
+int ompi_group_translate_ranks_ranges ( ompi_group_t *group1,
+                                 int n_ranks, const int *ranks1,
+                                 ompi_group_t *group2,
+                                 int *ranks2);
+int ompi_group_translate_ranks_ranges_reverse ( ompi_group_t *group1,
+                                 int n_ranks, const int *ranks1,
+                                 ompi_group_t *group2,
+                                 int *ranks2);
 
 /**
  *  Prototypes for the group back-end functions. Argument lists
@@ -311,6 +338,8 @@ int ompi_group_incl_strided(ompi_group_t* group, int n, const int *ranks,
                             ompi_group_t **new_group);
 int ompi_group_incl_bmap(ompi_group_t* group, int n, const int *ranks,
                          ompi_group_t **new_group);
+int ompi_group_incl_ranges(ompi_group_t* group, int n, const int *ranks,
+                           ompi_group_t **new_group);
 
 /**
  *  Functions to calculate storage spaces
@@ -319,6 +348,7 @@ int ompi_group_calc_plist ( int n, const int *ranks );
 int ompi_group_calc_strided ( int n, const int *ranks );
 int ompi_group_calc_sporadic ( int n, const int *ranks );
 int ompi_group_calc_bmap ( int n, int orig_size , const int *ranks );
+int ompi_group_calc_ranges ( int n, const int *ranks );
 
 /**
  * Function to return the minimum value in an array
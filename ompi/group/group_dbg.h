@@ -25,5 +25,6 @@
 #define OMPI_GROUP_SPORADIC  0x00000008
 #define OMPI_GROUP_STRIDED   0x00000010
 #define OMPI_GROUP_BITMAP    0x00000020
+#define OMPI_GROUP_RANGES    0x00000040
 
 #endif /* OMPI_GROUP_DBG_H */
@@ -214,6 +214,44 @@ ompi_group_t *ompi_group_allocate_bmap(int orig_group_size , int group_size)
     return new_group;
 }
 
+ompi_group_t *ompi_group_allocate_ranges(int n_ranges)
+{
+    ompi_group_t *new_group = NULL;
+
+    assert (n_ranges > 0);
+
+    /* create new group group element */
+    new_group = OBJ_NEW(ompi_group_t);
+    if( NULL == new_group) {
+        goto error_exit;
+    }
+    if (0 > new_group->grp_f_to_c_index) {
+        OBJ_RELEASE(new_group);
+        new_group = NULL;
+        goto error_exit;
+    }
+    /* initialize our rank to MPI_UNDEFINED */
+    new_group->grp_my_rank       = MPI_UNDEFINED;
+    new_group->grp_proc_pointers = NULL;
+    new_group->grp_proc_count    = 0;
+    OMPI_GROUP_SET_RANGES(new_group);
+
+    /* the order is released again by the caller if it is not needed */
+    new_group->sparse_data.grp_ranges.grp_ranges = (struct ompi_group_range_t *)
+        malloc (sizeof (struct ompi_group_range_t) * n_ranges);
+    new_group->sparse_data.grp_ranges.grp_ranges_order = (int *) malloc (sizeof (int) * n_ranges);
+    new_group->sparse_data.grp_ranges.grp_ranges_len = n_ranges;
+    if (NULL == new_group->sparse_data.grp_ranges.grp_ranges ||
+        NULL == new_group->sparse_data.grp_ranges.grp_ranges_order) {
+        OBJ_RELEASE(new_group);
+        new_group = NULL;
+        goto error_exit;
+    }
+
+ error_exit:
+    return new_group;
+}
+
 /*
  * increment the reference count of the proc structures
  */
@@ -298,6 +336,11 @@ static void ompi_group_destruct(ompi_group_t *group)
         }
     }
 
+    if (OMPI_GROUP_IS_RANGES(group)) {
+        free(group->sparse_data.grp_ranges.grp_ranges);
+        free(group->sparse_data.grp_ranges.grp_ranges_order);
+    }
+
     if (NULL != group->grp_parent_group_ptr){
         OBJ_RELEASE(group->grp_parent_group_ptr);
     }
@@ -0,0 +1,318 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Range list storage: the ranks of the parent group that make up the
+ * child are stored as a list of strided runs in child order.  Child
+ * ranks are translated to parent ranks with a binary search on the
+ * first child rank of every run.  To translate the other way the runs
+ * must not overlap in the parent: they are then searched by their
+ * lowest parent rank, through a permutation when they are not already
+ * in that order.  If strided runs overlap, only runs of adjacent
+ * ranks are used, which never overlap.
+ *
+ * Like the other sparse formats, the range list is only considered by
+ * ompi_group_incl() (and thus for communicators created by split or from
+ * a group) on builds configured with --enable-sparse-groups, when
+ * mpi_use_sparse_group_storage is set.
+ */
+
+#include "ompi_config.h"
+#include "ompi/group/group.h"
+#include "ompi/constants.h"
+#include "mpi.h"
+
+#include <stdlib.h>
+
+/*
+ * Walk the runs of ranks.  Returns the length of the run that starts at
+ * ranks[0] and stores its stride.  Two ranks only make a run if they are
+ * adjacent in the parent or the stride goes on after them, otherwise a
+ * shuffled list of ranks would be cut into pairs whose spans in the
+ * parent overlap.  With unit set, only adjacent ranks make runs: such
+ * runs never overlap.
+ */
+static int ompi_group_ranges_next (int n, const int *ranks, bool unit, int *stride)
+{
+    int length = 1;
+
+    *stride = 1;
+    if (n > 1) {
+        *stride = ranks[1] - ranks[0];
+        if (unit && 1 != abs (*stride)) {
+            *stride = 1;
+            return 1;
+        }
+        for (length = 2 ; length < n && ranks[length] - ranks[length - 1] == *stride ; ++length);
+        if (2 == length && 1 != abs (*stride)) {
+            *stride = 1;
+            length = 1;
+        }
+    }
+
+    return length;
+}
+
+static inline int ompi_group_range_low (const struct ompi_group_range_t *range)
+{
+    return range->stride > 0 ? range->rank_first :
+        range->rank_first + range->stride * (range->length - 1);
+}
+
+static inline int ompi_group_range_high (const struct ompi_group_range_t *range)
+{
+    return range->stride > 0 ? range->rank_first + range->stride * (range->length - 1) :
+        range->rank_first;
+}
+
+struct ompi_group_ranges_key_t {
+    int low;
+    int index;
+};
+
+static int ompi_group_ranges_cmp (const void *a, const void *b)
+{
+    int low_a = ((const struct ompi_group_ranges_key_t *) a)->low;
+    int low_b = ((const struct ompi_group_ranges_key_t *) b)->low;
+
+    return (low_a > low_b) - (low_a < low_b);
+}
+
+/*
+ * Set up the permutation that orders the runs by their lowest parent
+ * rank.  Returns 0 if the runs are already in that order (order is left
+ * untouched), 1 if the permutation is needed, OMPI_ERR_NOT_SUPPORTED if
+ * two runs overlap in the parent group.
+ */
+static int ompi_group_ranges_order (const struct ompi_group_range_t *ranges, int len, int *order)
+{
+    struct ompi_group_ranges_key_t *keys;
+    int i, ret = 1;
+
+    for (i = 1 ; i < len ; ++i) {
+        if (ompi_group_range_low (ranges + i) <= ompi_group_range_high (ranges + i - 1)) {
+            break;
+        }
+    }
+
+    if (i == len) {
+        return 0;
+    }
+
+    keys = (struct ompi_group_ranges_key_t *) malloc (len * sizeof (*keys));
+    if (NULL == keys) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    for (i = 0 ; i < len ; ++i) {
+        keys[i].low = ompi_group_range_low (ranges + i);
+        keys[i].index = i;
+    }
+
+    qsort (keys, len, sizeof (*keys), ompi_group_ranges_cmp);
+
+    for (i = 0 ; i < len ; ++i) {
+        if (i > 0 && keys[i].low <= ompi_group_range_high (ranges + keys[i - 1].index)) {
+            ret = OMPI_ERR_NOT_SUPPORTED;
+            break;
+        }
+        order[i] = keys[i].index;
+    }
+
+    free (keys);
+
+    return ret;
+}
+
+static int ompi_group_ranges_build (int n, const int *ranks, bool unit, struct ompi_group_range_t *ranges)
+{
+    int i, len, stride, length;
+
+    for (i = 0, len = 0 ; i < n ; i += length, ++len) {
+        length = ompi_group_ranges_next (n - i, ranks + i, unit, &stride);
+        if (NULL != ranges) {
+            ranges[len].rank_first = ranks[i];
+            ranges[len].stride = stride;
+            ranges[len].length = length;
+            ranges[len].offset = i;
+        }
+    }
+
+    return len;
+}
+
+int ompi_group_calc_ranges ( int n, const int *ranks )
+{
+    struct ompi_group_range_t *ranges;
+    int len, size, *order, ret;
+    bool unit = false;
+
+    if (0 == n) {
+        return 0;
+    }
+
+    for (;;) {
+        len = ompi_group_ranges_build (n, ranks, unit, NULL);
+        ranges = (struct ompi_group_range_t *) malloc (len * sizeof (*ranges));
+        order = (int *) malloc (len * sizeof (int));
+        if (NULL == ranges || NULL == order) {
+            free (ranges);
+            free (order);
+            return -1;
+        }
+
+        (void) ompi_group_ranges_build (n, ranks, unit, ranges);
+        ret = ompi_group_ranges_order (ranges, len, order);
+        size = len * sizeof (*ranges);
+        if (1 == ret) {
+            size += len * sizeof (int);
+        }
+
+        free (ranges);
+        free (order);
+
+        /* overlapping runs cannot be searched from the parent, runs of
+         * adjacent ranks can */
+        if (OMPI_ERR_NOT_SUPPORTED != ret || unit) {
+            break;
+        }
+        unit = true;
+    }
+
+    return (0 > ret) ? -1 : size;
+}
+
+/* from parent group to child group */
+int ompi_group_translate_ranks_ranges ( ompi_group_t *parent_group,
+                                        int n_ranks, const int *ranks1,
+                                        ompi_group_t *child_group,
+                                        int *ranks2)
+{
+    const struct ompi_group_range_t *ranges = child_group->sparse_data.grp_ranges.grp_ranges;
+    const int *order = child_group->sparse_data.grp_ranges.grp_ranges_order;
+    int len = child_group->sparse_data.grp_ranges.grp_ranges_len;
+
+    for (int j = 0 ; j < n_ranks ; ++j) {
+        const struct ompi_group_range_t *range;
+        int rank = ranks1[j], low = 0, high = len - 1, mid, diff;
+
+        if (MPI_PROC_NULL == rank) {
+            ranks2[j] = MPI_PROC_NULL;
+            continue;
+        }
+
+        /* find the last run that starts at or below rank */
+        while (low < high) {
+            mid = (low + high + 1) / 2;
+            if (ompi_group_range_low (ranges + (order ? order[mid] : mid)) <= rank) {
+                low = mid;
+            } else {
+                high = mid - 1;
+            }
+        }
+
+        range = ranges + (order ? order[low] : low);
+        diff = rank - range->rank_first;
+        if (rank < ompi_group_range_low (range) || rank > ompi_group_range_high (range) ||
+            0 != diff % range->stride) {
+            ranks2[j] = MPI_UNDEFINED;
+        } else {
+            ranks2[j] = range->offset + diff / range->stride;
+        }
+    }
+
+    return OMPI_SUCCESS;
+}
+
+/* from child group to parent group */
+int ompi_group_translate_ranks_ranges_reverse ( ompi_group_t *child_group,
+                                                int n_ranks, const int *ranks1,
+                                                ompi_group_t *parent_group,
+                                                int *ranks2)
+{
+    const struct ompi_group_range_t *ranges = child_group->sparse_data.grp_ranges.grp_ranges;
+    int len = child_group->sparse_data.grp_ranges.grp_ranges_len;
+
+    for (int j = 0 ; j < n_ranks ; ++j) {
+        int rank = ranks1[j], low = 0, high = len - 1, mid;
+
+        if (MPI_PROC_NULL == rank) {
+            ranks2[j] = MPI_PROC_NULL;
+            continue;
+        }
+
+        /* runs are stored in child order */
+        while (low < high) {
+            mid = (low + high + 1) / 2;
+            if (ranges[mid].offset <= rank) {
+                low = mid;
+            } else {
+                high = mid - 1;
+            }
+        }
+
+        ranks2[j] = ranges[low].rank_first + ranges[low].stride * (rank - ranges[low].offset);
+    }
+
+    return OMPI_SUCCESS;
+}
+
+int ompi_group_incl_ranges(ompi_group_t* group, int n, const int *ranks,
+                           ompi_group_t **new_group)
+{
+    ompi_group_t *new_group_pointer;
+    int len, ret, my_group_rank;
+    bool unit = false;
+
+    if (0 == n) {
+        *new_group = MPI_GROUP_EMPTY;
+        OBJ_RETAIN(MPI_GROUP_EMPTY);
+        return OMPI_SUCCESS;
+    }
+
+    for (;;) {
+        len = ompi_group_ranges_build (n, ranks, unit, NULL);
+        new_group_pointer = ompi_group_allocate_ranges (len);
+        if (NULL == new_group_pointer) {
+            return MPI_ERR_GROUP;
+        }
+
+        (void) ompi_group_ranges_build (n, ranks, unit, new_group_pointer->sparse_data.grp_ranges.grp_ranges);
+        ret = ompi_group_ranges_order (new_group_pointer->sparse_data.grp_ranges.grp_ranges, len,
+                                       new_group_pointer->sparse_data.grp_ranges.grp_ranges_order);
+        if (0 <= ret) {
+            break;
+        }
+        OBJ_RELEASE(new_group_pointer);
+        if (OMPI_ERR_NOT_SUPPORTED != ret || unit) {
+            return (OMPI_ERR_OUT_OF_RESOURCE == ret) ? MPI_ERR_NO_MEM : MPI_ERR_GROUP;
+        }
+        /* strided runs overlap, fall back to runs of adjacent ranks */
+        unit = true;
+    }
+    if (0 == ret) {
+        free (new_group_pointer->sparse_data.grp_ranges.grp_ranges_order);
+        new_group_pointer->sparse_data.grp_ranges.grp_ranges_order = NULL;
+    }
+
+    new_group_pointer->grp_proc_count = n;
+    new_group_pointer->grp_parent_group_ptr = group;
+
+    OBJ_RETAIN(new_group_pointer->grp_parent_group_ptr);
+    ompi_group_increment_proc_count(new_group_pointer->grp_parent_group_ptr);
+
+    ompi_group_increment_proc_count(new_group_pointer);
+    my_group_rank = group->grp_my_rank;
+    ompi_group_translate_ranks (group, 1, &my_group_rank,
+                                new_group_pointer, &new_group_pointer->grp_my_rank);
+
+    *new_group = (MPI_Group) new_group_pointer;
+
+    return OMPI_SUCCESS;
+}
@@ -181,8 +181,14 @@ static void mca_bml_r2_register_progress (mca_btl_base_module_t *btl, bool hp)
 
         if (found == false || hp) {
             if (found == false) {
+                char name[MCA_BASE_MAX_COMPONENT_NAME_LEN + 5];
+
                 mca_bml_r2.btl_progress[mca_bml_r2.num_btl_progress++] =
                     btl->btl_component->btl_progress;
+
+                /* label the callback in the progress engine statistics */
+                snprintf (name, sizeof (name), "btl_%s", btl->btl_component->btl_version.mca_component_name);
+                (void) opal_progress_set_name (btl->btl_component->btl_progress, name);
             }
 
             if (hp) {
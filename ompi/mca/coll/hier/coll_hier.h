@@ -0,0 +1,165 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/** @file
+ *
+ * Node-aware hierarchical collectives.
+ *
+ * The communicator is split once into a node-local communicator
+ * (MPI_COMM_TYPE_SHARED) and a communicator of the node leaders (local
+ * rank 0 on each node).  The collectives are then implemented as an
+ * intra-node phase, an inter-node phase among the leaders and another
+ * intra-node phase, each of them delegated to whatever module was
+ * selected on the sub-communicator (e.g., sm or tuned on the node,
+ * tuned on the leaders).
+ *
+ * The sub-communicators are created lazily, by the first hierarchical
+ * collective called on the communicator, using the collectives of the
+ * modules this one overrides.  If the communicator turns out to live
+ * on a single node, or to have a single process per node, the module
+ * simply forwards everything to those modules.
+ */
+
+#ifndef MCA_COLL_HIER_EXPORT_H
+#define MCA_COLL_HIER_EXPORT_H
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+
+#include "opal/class/opal_object.h"
+#include "opal/mca/mca.h"
+#include "opal/mca/threads/thread_usage.h"
+
+#include "ompi/constants.h"
+#include "ompi/mca/coll/coll.h"
+#include "ompi/mca/coll/base/base.h"
+#include "ompi/communicator/communicator.h"
+
+BEGIN_C_DECLS
+
+/* API functions */
+
+int mca_coll_hier_init_query(bool enable_progress_threads,
+                             bool enable_mpi_threads);
+mca_coll_base_module_t *
+mca_coll_hier_comm_query(struct ompi_communicator_t *comm,
+                         int *priority);
+
+int mca_coll_hier_module_enable(mca_coll_base_module_t *module,
+                                struct ompi_communicator_t *comm);
+
+int mca_coll_hier_allgather_intra(const void *sbuf, int scount,
+                                  struct ompi_datatype_t *sdtype,
+                                  void *rbuf, int rcount,
+                                  struct ompi_datatype_t *rdtype,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module);
+
+int mca_coll_hier_allreduce_intra(const void *sbuf, void *rbuf, int count,
+                                  struct ompi_datatype_t *dtype,
+                                  struct ompi_op_t *op,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module);
+
+int mca_coll_hier_barrier_intra(struct ompi_communicator_t *comm,
+                                mca_coll_base_module_t *module);
+
+int mca_coll_hier_bcast_intra(void *buff, int count,
+                              struct ompi_datatype_t *datatype,
+                              int root,
+                              struct ompi_communicator_t *comm,
+                              mca_coll_base_module_t *module);
+
+int mca_coll_hier_reduce_intra(const void *sbuf, void *rbuf, int count,
+                               struct ompi_datatype_t *dtype,
+                               struct ompi_op_t *op,
+                               int root,
+                               struct ompi_communicator_t *comm,
+                               mca_coll_base_module_t *module);
+
+int mca_coll_hier_ft_event(int status);
+
+/* Types */
+/* Module */
+
+typedef struct mca_coll_hier_module_t {
+    mca_coll_base_module_t super;
+
+    /* Pointers to the collective functions we override, used for the
+       fallback cases and to create the sub-communicators */
+    mca_coll_base_comm_coll_t c_coll;
+
+    /* Whether the sub-communicators have been set up */
+    bool enabled;
+    /* Whether the hierarchical algorithms are used at all (false if
+       the communicator has a single node or one process per node) */
+    bool use_hier;
+
+    /* Processes of this node */
+    struct ompi_communicator_t *local_comm;
+    /* Local rank 0 of every node (MPI_COMM_NULL on the others); the
+       rank of a leader in this communicator is its node index */
+    struct ompi_communicator_t *leader_comm;
+
+    int num_nodes;
+    /* Node index and local rank of every rank of the communicator */
+    int *node_of;
+    int *local_rank_of;
+    /* Ranks of the communicator, ordered by node and local rank, and
+       the index of the first rank of each node in that list */
+    int *node_ranks;
+    int *node_offset;
+    /* Whether node_ranks is the identity, i.e., the processes of each
+       node have consecutive ranks */
+    bool contiguous;
+} mca_coll_hier_module_t;
+
+OBJ_CLASS_DECLARATION(mca_coll_hier_module_t);
+
+/* Component */
+
+typedef struct mca_coll_hier_component_t {
+    mca_coll_base_component_2_0_0_t super;
+
+    /* Priority of this component */
+    int priority;
+} mca_coll_hier_component_t;
+
+/* Globally exported variables */
+
+OMPI_MODULE_DECLSPEC extern mca_coll_hier_component_t mca_coll_hier_component;
+
+/**
+ * Set up the sub-communicators (collective over the communicator).
+ * Called by the first hierarchical collective.
+ */
+int mca_coll_hier_lazy_enable(mca_coll_hier_module_t *module,
+                              struct ompi_communicator_t *comm);
+
+/* Macro used at the top of all the collectives: set up the module
+   if needed, and bail out to the overridden function if the
+   communicator does not benefit from the hierarchy */
+#define COLL_HIER_ENABLE_OR_FALLBACK(m, comm, func, ...)                 \
+    do {                                                                \
+        if (OPAL_UNLIKELY(!(m)->enabled)) {                             \
+            int ret = mca_coll_hier_lazy_enable((m), (comm));           \
+            if (OMPI_SUCCESS != ret) {                                  \
+                return ret;                                             \
+            }                                                           \
+        }                                                               \
+        if (!(m)->use_hier) {                                           \
+            return (m)->c_coll.coll_ ## func(__VA_ARGS__, (comm),       \
+                                             (m)->c_coll.coll_ ## func ## _module); \
+        }                                                               \
+    } while (0)
+
+END_C_DECLS
+
+#endif /* MCA_COLL_HIER_EXPORT_H */
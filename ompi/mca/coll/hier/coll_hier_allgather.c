@@ -0,0 +1,133 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "opal/datatype/opal_datatype.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "coll_hier.h"
+
+
+/*
+ *	allgather
+ *
+ *	Function:	- allgather
+ *	Accepts:	- same arguments as MPI_Allgather()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ *	Each node gathers its blocks on its leader, the leaders exchange
+ *	the blocks of their nodes, and each leader broadcasts the whole
+ *	result on its node.  The leaders work on the blocks ordered by
+ *	node; unless the processes of each node have consecutive ranks,
+ *	this needs a temporary buffer and a final reordering.
+ */
+int mca_coll_hier_allgather_intra(const void *sbuf, int scount,
+                                  struct ompi_datatype_t *sdtype,
+                                  void *rbuf, int rcount,
+                                  struct ompi_datatype_t *rdtype,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *h = (mca_coll_hier_module_t*) module;
+    ompi_communicator_t *local_comm, *leader_comm;
+    int err, i, rank, size, my_node, *counts = NULL, *displs = NULL;
+    char *ordered = (char *) rbuf, *tmp_free = NULL;
+    ptrdiff_t lb, extent, block, span, gap;
+    bool is_leader;
+
+    COLL_HIER_ENABLE_OR_FALLBACK(h, comm, allgather, sbuf, scount, sdtype,
+                                 rbuf, rcount, rdtype);
+
+    local_comm = h->local_comm;
+    leader_comm = h->leader_comm;
+    is_leader = (MPI_COMM_NULL != leader_comm);
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+    my_node = h->node_of[rank];
+    ompi_datatype_get_extent(rdtype, &lb, &extent);
+    block = extent * (ptrdiff_t) rcount;
+
+    if (is_leader && !h->contiguous) {
+        span = opal_datatype_span(&rdtype->super, (size_t) size * rcount, &gap);
+        tmp_free = (char *) malloc(span);
+        if (NULL == tmp_free) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        ordered = tmp_free - gap;
+    }
+
+    /* Phase 1: gather the blocks of the node on the leader, in local
+       rank order, i.e., in the order of node_ranks */
+    if (MPI_IN_PLACE == sbuf) {
+        if (is_leader && h->contiguous) {
+            /* already where the gather would put it */
+            err = local_comm->c_coll->coll_gather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+                                                  ordered + h->node_offset[my_node] * block,
+                                                  rcount, rdtype, 0, local_comm,
+                                                  local_comm->c_coll->coll_gather_module);
+        } else {
+            err = local_comm->c_coll->coll_gather((char *) rbuf + rank * block, rcount, rdtype,
+                                                  ordered + h->node_offset[my_node] * block,
+                                                  rcount, rdtype, 0, local_comm,
+                                                  local_comm->c_coll->coll_gather_module);
+        }
+    } else {
+        err = local_comm->c_coll->coll_gather(sbuf, scount, sdtype,
+                                              ordered + h->node_offset[my_node] * block,
+                                              rcount, rdtype, 0, local_comm,
+                                              local_comm->c_coll->coll_gather_module);
+    }
+    if (MPI_SUCCESS != err) {
+        goto exit;
+    }
+
+    /* Phase 2: exchange the blocks of the nodes among the leaders */
+    if (is_leader) {
+        counts = (int *) malloc(2 * h->num_nodes * sizeof(int));
+        if (NULL == counts) {
+            err = OMPI_ERR_OUT_OF_RESOURCE;
+            goto exit;
+        }
+        displs = counts + h->num_nodes;
+        for (i = 0; i < h->num_nodes; ++i) {
+            counts[i] = (h->node_offset[i + 1] - h->node_offset[i]) * rcount;
+            displs[i] = h->node_offset[i] * rcount;
+        }
+        err = leader_comm->c_coll->coll_allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+                                                   ordered, counts, displs, rdtype,
+                                                   leader_comm,
+                                                   leader_comm->c_coll->coll_allgatherv_module);
+        if (MPI_SUCCESS != err) {
+            goto exit;
+        }
+
+        if (!h->contiguous) {
+            for (i = 0; i < size; ++i) {
+                err = ompi_datatype_copy_content_same_ddt(rdtype, rcount,
+                                                          (char *) rbuf + h->node_ranks[i] * block,
+                                                          ordered + i * block);
+                if (MPI_SUCCESS != err) {
+                    goto exit;
+                }
+            }
+        }
+    }
+
+    /* Phase 3: broadcast the result on each node */
+    err = local_comm->c_coll->coll_bcast(rbuf, size * rcount, rdtype, 0, local_comm,
+                                         local_comm->c_coll->coll_bcast_module);
+
+ exit:
+    free(counts);
+    free(tmp_free);
+    return err;
+}
@@ -0,0 +1,73 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+#include "ompi/op/op.h"
+#include "coll_hier.h"
+
+
+/*
+ *	allreduce
+ *
+ *	Function:	- allreduce
+ *	Accepts:	- same arguments as MPI_Allreduce()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ *	Each node reduces to its leader, the leaders allreduce among
+ *	themselves, and each leader broadcasts the result on its node.
+ *	As this changes the order in which the contributions are
+ *	combined, it is only used for commutative operations.
+ */
+int mca_coll_hier_allreduce_intra(const void *sbuf, void *rbuf, int count,
+                                  struct ompi_datatype_t *dtype,
+                                  struct ompi_op_t *op,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *h = (mca_coll_hier_module_t*) module;
+    ompi_communicator_t *local_comm, *leader_comm;
+    const void *local_sbuf;
+    int err;
+
+    COLL_HIER_ENABLE_OR_FALLBACK(h, comm, allreduce, sbuf, rbuf, count, dtype, op);
+    if (!ompi_op_is_commute(op)) {
+        return h->c_coll.coll_allreduce(sbuf, rbuf, count, dtype, op, comm,
+                                        h->c_coll.coll_allreduce_module);
+    }
+
+    local_comm = h->local_comm;
+    leader_comm = h->leader_comm;
+
+    /* The leaders reduce straight into their receive buffer */
+    if (MPI_IN_PLACE == sbuf) {
+        local_sbuf = (MPI_COMM_NULL != leader_comm) ? MPI_IN_PLACE : rbuf;
+    } else {
+        local_sbuf = sbuf;
+    }
+    err = local_comm->c_coll->coll_reduce(local_sbuf, rbuf, count, dtype, op, 0,
+                                          local_comm,
+                                          local_comm->c_coll->coll_reduce_module);
+    if (MPI_SUCCESS != err) {
+        return err;
+    }
+
+    if (MPI_COMM_NULL != leader_comm) {
+        err = leader_comm->c_coll->coll_allreduce(MPI_IN_PLACE, rbuf, count, dtype, op,
+                                                  leader_comm,
+                                                  leader_comm->c_coll->coll_allreduce_module);
+        if (MPI_SUCCESS != err) {
+            return err;
+        }
+    }
+
+    return local_comm->c_coll->coll_bcast(rbuf, count, dtype, 0, local_comm,
+                                          local_comm->c_coll->coll_bcast_module);
+}
@@ -0,0 +1,61 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+#include "coll_hier.h"
+
+
+/*
+ *	barrier
+ *
+ *	Function:	- barrier
+ *	Accepts:	- same arguments as MPI_Barrier()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ *	A leader enters the barrier of the leaders only once all the
+ *	processes of its node have arrived, and the processes of a node
+ *	leave only once their leader has left the barrier of the leaders.
+ */
+int mca_coll_hier_barrier_intra(struct ompi_communicator_t *comm,
+                                mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *h = (mca_coll_hier_module_t*) module;
+    ompi_communicator_t *local_comm, *leader_comm;
+    int err;
+
+    if (OPAL_UNLIKELY(!h->enabled)) {
+        err = mca_coll_hier_lazy_enable(h, comm);
+        if (OMPI_SUCCESS != err) {
+            return err;
+        }
+    }
+    if (!h->use_hier) {
+        return h->c_coll.coll_barrier(comm, h->c_coll.coll_barrier_module);
+    }
+
+    local_comm = h->local_comm;
+    leader_comm = h->leader_comm;
+
+    err = local_comm->c_coll->coll_barrier(local_comm,
+                                           local_comm->c_coll->coll_barrier_module);
+    if (MPI_SUCCESS != err) {
+        return err;
+    }
+    if (MPI_COMM_NULL != leader_comm) {
+        err = leader_comm->c_coll->coll_barrier(leader_comm,
+                                                leader_comm->c_coll->coll_barrier_module);
+        if (MPI_SUCCESS != err) {
+            return err;
+        }
+    }
+    return local_comm->c_coll->coll_barrier(local_comm,
+                                            local_comm->c_coll->coll_barrier_module);
+}
@@ -0,0 +1,64 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+#include "coll_hier.h"
+
+
+/*
+ *	bcast
+ *
+ *	Function:	- broadcast
+ *	Accepts:	- same arguments as MPI_Bcast()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ *	The node of the root broadcasts locally (which gives the data to
+ *	its leader), the leaders broadcast among themselves, and the
+ *	other nodes broadcast locally from their leader.
+ */
+int mca_coll_hier_bcast_intra(void *buff, int count,
+                              struct ompi_datatype_t *datatype, int root,
+                              struct ompi_communicator_t *comm,
+                              mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *h = (mca_coll_hier_module_t*) module;
+    ompi_communicator_t *local_comm, *leader_comm;
+    int err = MPI_SUCCESS, root_node, my_node;
+
+    COLL_HIER_ENABLE_OR_FALLBACK(h, comm, bcast, buff, count, datatype, root);
+
+    local_comm = h->local_comm;
+    leader_comm = h->leader_comm;
+    root_node = h->node_of[root];
+    my_node = h->node_of[ompi_comm_rank(comm)];
+
+    if (my_node == root_node) {
+        err = local_comm->c_coll->coll_bcast(buff, count, datatype,
+                                             h->local_rank_of[root], local_comm,
+                                             local_comm->c_coll->coll_bcast_module);
+        if (MPI_SUCCESS != err) {
+            return err;
+        }
+    }
+    if (MPI_COMM_NULL != leader_comm) {
+        err = leader_comm->c_coll->coll_bcast(buff, count, datatype, root_node,
+                                              leader_comm,
+                                              leader_comm->c_coll->coll_bcast_module);
+        if (MPI_SUCCESS != err) {
+            return err;
+        }
+    }
+    if (my_node != root_node) {
+        err = local_comm->c_coll->coll_bcast(buff, count, datatype, 0, local_comm,
+                                             local_comm->c_coll->coll_bcast_module);
+    }
+    return err;
+}
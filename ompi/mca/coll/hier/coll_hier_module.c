@@ -0,0 +1,303 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/group/group.h"
+#include "ompi/mca/coll/coll.h"
+#include "ompi/mca/coll/base/base.h"
+#include "coll_hier.h"
+
+/*
+ * Set while this thread creates the sub-communicators of a module, so
+ * that they do not get a hier module themselves.  It has to be per
+ * thread: another thread may create an unrelated communicator at the
+ * same time, and all its processes must make the same decision.
+ */
+#if OPAL_HAVE_THREAD_LOCAL
+static opal_thread_local bool hier_creating_subcomms = false;
+#else
+static bool hier_creating_subcomms = false;
+#endif
+
+static void mca_coll_hier_module_construct(mca_coll_hier_module_t *module)
+{
+    memset(&(module->c_coll), 0, sizeof(module->c_coll));
+    module->enabled = false;
+    module->use_hier = false;
+    module->local_comm = MPI_COMM_NULL;
+    module->leader_comm = MPI_COMM_NULL;
+    module->num_nodes = 0;
+    module->node_of = NULL;
+    module->local_rank_of = NULL;
+    module->node_ranks = NULL;
+    module->node_offset = NULL;
+    module->contiguous = false;
+}
+
+static void mca_coll_hier_module_destruct(mca_coll_hier_module_t *module)
+{
+    if (MPI_COMM_NULL != module->leader_comm) {
+        ompi_comm_free(&module->leader_comm);
+    }
+    if (MPI_COMM_NULL != module->local_comm) {
+        ompi_comm_free(&module->local_comm);
+    }
+    free(module->node_of);
+    free(module->local_rank_of);
+    free(module->node_ranks);
+    free(module->node_offset);
+
+    if (NULL != module->c_coll.coll_allgather_module) {
+        OBJ_RELEASE(module->c_coll.coll_allgather_module);
+        OBJ_RELEASE(module->c_coll.coll_allreduce_module);
+        OBJ_RELEASE(module->c_coll.coll_barrier_module);
+        OBJ_RELEASE(module->c_coll.coll_bcast_module);
+        OBJ_RELEASE(module->c_coll.coll_reduce_module);
+    }
+}
+
+OBJ_CLASS_INSTANCE(mca_coll_hier_module_t, mca_coll_base_module_t,
+                   mca_coll_hier_module_construct,
+                   mca_coll_hier_module_destruct);
+
+
+/*
+ * Initial query function that is invoked during MPI_INIT, allowing
+ * this component to disqualify itself if it doesn't support the
+ * required level of thread support.
+ */
+int mca_coll_hier_init_query(bool enable_progress_threads,
+                             bool enable_mpi_threads)
+{
+#if !OPAL_HAVE_THREAD_LOCAL
+    /* See hier_creating_subcomms */
+    if (enable_mpi_threads) {
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+#endif
+    return OMPI_SUCCESS;
+}
+
+
+/*
+ * Invoked when there's a new communicator that has been created.
+ * Look at the communicator and decide which set of functions and
+ * priority we want to return.
+ */
+mca_coll_base_module_t *
+mca_coll_hier_comm_query(struct ompi_communicator_t *comm,
+                         int *priority)
+{
+    mca_coll_hier_module_t *hier_module;
+
+    /* The decision must be the same on all the processes, so it can
+       only depend on information they all share.  A communicator
+       without remote peers lives on a single node for everybody. */
+    if (OMPI_COMM_IS_INTER(comm) || ompi_comm_size(comm) < 3 ||
+        hier_creating_subcomms || mca_coll_hier_component.priority <= 0 ||
+        !ompi_group_have_remote_peers(comm->c_local_group)) {
+        return NULL;
+    }
+
+    hier_module = OBJ_NEW(mca_coll_hier_module_t);
+    if (NULL == hier_module) {
+        return NULL;
+    }
+
+    *priority = mca_coll_hier_component.priority;
+
+    hier_module->super.coll_module_enable = mca_coll_hier_module_enable;
+    hier_module->super.ft_event = mca_coll_hier_ft_event;
+
+    hier_module->super.coll_allgather  = mca_coll_hier_allgather_intra;
+    hier_module->super.coll_allgatherv = NULL;
+    hier_module->super.coll_allreduce  = mca_coll_hier_allreduce_intra;
+    hier_module->super.coll_alltoall   = NULL;
+    hier_module->super.coll_alltoallv  = NULL;
+    hier_module->super.coll_alltoallw  = NULL;
+    hier_module->super.coll_barrier    = mca_coll_hier_barrier_intra;
+    hier_module->super.coll_bcast      = mca_coll_hier_bcast_intra;
+    hier_module->super.coll_exscan     = NULL;
+    hier_module->super.coll_gather     = NULL;
+    hier_module->super.coll_gatherv    = NULL;
+    hier_module->super.coll_reduce     = mca_coll_hier_reduce_intra;
+    hier_module->super.coll_reduce_scatter = NULL;
+    hier_module->super.coll_scan       = NULL;
+    hier_module->super.coll_scatter    = NULL;
+    hier_module->super.coll_scatterv   = NULL;
+
+    return &(hier_module->super);
+}
+
+
+/*
+ * Init module on the communicator
+ */
+int mca_coll_hier_module_enable(mca_coll_base_module_t *module,
+                                struct ompi_communicator_t *comm)
+{
+    mca_coll_hier_module_t *h = (mca_coll_hier_module_t*) module;
+
+    /* Save the prior layer of coll functions */
+    h->c_coll = *comm->c_coll;
+
+    if (NULL == h->c_coll.coll_allgather_module ||
+        NULL == h->c_coll.coll_allreduce_module ||
+        NULL == h->c_coll.coll_barrier_module ||
+        NULL == h->c_coll.coll_bcast_module ||
+        NULL == h->c_coll.coll_reduce_module) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:hier:enable (%d/%s): no underlying module for some collectives; disqualifying myself",
+                            comm->c_contextid, comm->c_name);
+        memset(&(h->c_coll), 0, sizeof(h->c_coll));
+        return OMPI_ERR_NOT_FOUND;
+    }
+    OBJ_RETAIN(h->c_coll.coll_allgather_module);
+    OBJ_RETAIN(h->c_coll.coll_allreduce_module);
+    OBJ_RETAIN(h->c_coll.coll_barrier_module);
+    OBJ_RETAIN(h->c_coll.coll_bcast_module);
+    OBJ_RETAIN(h->c_coll.coll_reduce_module);
+
+    return OMPI_SUCCESS;
+}
+
+
+/*
+ * Swap the collectives we provide on the communicator with the ones
+ * of the prior layer (and back), so that the communicator creation
+ * functions can use them.
+ */
+#define HIER_SWAP(h, comm, func)                                        \
+    do {                                                                \
+        mca_coll_base_module_ ## func ## _fn_t tmp_fn = (comm)->c_coll->coll_ ## func; \
+        mca_coll_base_module_t *tmp_module = (comm)->c_coll->coll_ ## func ## _module; \
+        (comm)->c_coll->coll_ ## func = (h)->c_coll.coll_ ## func;      \
+        (comm)->c_coll->coll_ ## func ## _module = (h)->c_coll.coll_ ## func ## _module; \
+        (h)->c_coll.coll_ ## func = tmp_fn;                             \
+        (h)->c_coll.coll_ ## func ## _module = tmp_module;              \
+    } while (0)
+
+static void hier_swap_collectives(mca_coll_hier_module_t *h,
+                                  struct ompi_communicator_t *comm)
+{
+    HIER_SWAP(h, comm, allgather);
+    HIER_SWAP(h, comm, allreduce);
+    HIER_SWAP(h, comm, barrier);
+    HIER_SWAP(h, comm, bcast);
+    HIER_SWAP(h, comm, reduce);
+}
+
+
+int mca_coll_hier_lazy_enable(mca_coll_hier_module_t *h,
+                              struct ompi_communicator_t *comm)
+{
+    int rank = ompi_comm_rank(comm), size = ompi_comm_size(comm);
+    int ret, i, node, info[2], *all = NULL;
+
+    hier_swap_collectives(h, comm);
+    hier_creating_subcomms = true;
+
+    ret = ompi_comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, NULL, &h->local_comm);
+    if (OMPI_SUCCESS != ret) {
+        goto exit;
+    }
+    info[1] = ompi_comm_rank(h->local_comm);
+    ret = ompi_comm_split(comm, (0 == info[1]) ? 0 : MPI_UNDEFINED, rank,
+                          &h->leader_comm, false);
+    if (OMPI_SUCCESS != ret) {
+        goto exit;
+    }
+
+    /* The node index is the rank of the node leader among the leaders */
+    node = (MPI_COMM_NULL != h->leader_comm) ? ompi_comm_rank(h->leader_comm) : 0;
+    ret = h->local_comm->c_coll->coll_bcast(&node, 1, MPI_INT, 0, h->local_comm,
+                                            h->local_comm->c_coll->coll_bcast_module);
+    if (OMPI_SUCCESS != ret) {
+        goto exit;
+    }
+    info[0] = node;
+
+    all = (int *) malloc(2 * size * sizeof(int));
+    h->node_of = (int *) malloc(size * sizeof(int));
+    h->local_rank_of = (int *) malloc(size * sizeof(int));
+    h->node_ranks = (int *) malloc(size * sizeof(int));
+    if (NULL == all || NULL == h->node_of || NULL == h->local_rank_of ||
+        NULL == h->node_ranks) {
+        ret = OMPI_ERR_OUT_OF_RESOURCE;
+        goto exit;
+    }
+    ret = comm->c_coll->coll_allgather(info, 2, MPI_INT, all, 2, MPI_INT, comm,
+                                       comm->c_coll->coll_allgather_module);
+    if (OMPI_SUCCESS != ret) {
+        goto exit;
+    }
+
+    h->num_nodes = 0;
+    for (i = 0; i < size; ++i) {
+        h->node_of[i] = all[2 * i];
+        h->local_rank_of[i] = all[2 * i + 1];
+        if (h->node_of[i] >= h->num_nodes) {
+            h->num_nodes = h->node_of[i] + 1;
+        }
+    }
+
+    /* Order the ranks by node, then by local rank */
+    h->node_offset = (int *) calloc(h->num_nodes + 1, sizeof(int));
+    if (NULL == h->node_offset) {
+        ret = OMPI_ERR_OUT_OF_RESOURCE;
+        goto exit;
+    }
+    for (i = 0; i < size; ++i) {
+        h->node_offset[h->node_of[i] + 1]++;
+    }
+    for (i = 0; i < h->num_nodes; ++i) {
+        h->node_offset[i + 1] += h->node_offset[i];
+    }
+    h->contiguous = true;
+    for (i = 0; i < size; ++i) {
+        int pos = h->node_offset[h->node_of[i]] + h->local_rank_of[i];
+        h->node_ranks[pos] = i;
+        h->contiguous = h->contiguous && (pos == i);
+    }
+
+ exit:
+    free(all);
+    hier_creating_subcomms = false;
+    hier_swap_collectives(h, comm);
+
+    h->enabled = true;
+    h->use_hier = (OMPI_SUCCESS == ret) && h->num_nodes > 1 && h->num_nodes < size;
+    opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                        "coll:hier:lazy_enable (%d/%s): %d nodes, %s",
+                        comm->c_contextid, comm->c_name, h->num_nodes,
+                        h->use_hier ? "using the hierarchy" : "falling back to the flat collectives");
+    if (!h->use_hier) {
+        if (MPI_COMM_NULL != h->leader_comm) {
+            ompi_comm_free(&h->leader_comm);
+        }
+        if (MPI_COMM_NULL != h->local_comm) {
+            ompi_comm_free(&h->local_comm);
+        }
+    }
+    return ret;
+}
+
+
+int mca_coll_hier_ft_event(int state)
+{
+    return OMPI_SUCCESS;
+}
@@ -0,0 +1,118 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "opal/datatype/opal_datatype.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/op/op.h"
+#include "ompi/mca/pml/pml.h"
+#include "ompi/mca/coll/base/coll_tags.h"
+#include "coll_hier.h"
+
+
+/*
+ *	reduce
+ *
+ *	Function:	- reduce
+ *	Accepts:	- same arguments as MPI_Reduce()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ *	Each node reduces to its leader, the leaders reduce to the
+ *	leader of the root's node, which hands the result over to the
+ *	root if needed.  As this changes the order in which the
+ *	contributions are combined, it is only used for commutative
+ *	operations.
+ */
+int mca_coll_hier_reduce_intra(const void *sbuf, void *rbuf, int count,
+                               struct ompi_datatype_t *dtype,
+                               struct ompi_op_t *op,
+                               int root, struct ompi_communicator_t *comm,
+                               mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *h = (mca_coll_hier_module_t*) module;
+    ompi_communicator_t *local_comm, *leader_comm;
+    int err, rank, root_node, root_local, my_node;
+    bool is_root, is_leader;
+    const void *local_sbuf;
+    char *tmp = NULL, *tmp_free = NULL;
+    ptrdiff_t span, gap;
+
+    COLL_HIER_ENABLE_OR_FALLBACK(h, comm, reduce, sbuf, rbuf, count, dtype, op, root);
+    if (!ompi_op_is_commute(op)) {
+        return h->c_coll.coll_reduce(sbuf, rbuf, count, dtype, op, root, comm,
+                                     h->c_coll.coll_reduce_module);
+    }
+
+    local_comm = h->local_comm;
+    leader_comm = h->leader_comm;
+    rank = ompi_comm_rank(comm);
+    root_node = h->node_of[root];
+    root_local = h->local_rank_of[root];
+    my_node = h->node_of[rank];
+    is_root = (rank == root);
+    is_leader = (MPI_COMM_NULL != leader_comm);
+
+    /* The leaders need a buffer for the partial result of their node,
+       unless they are the root */
+    if (is_leader && !is_root) {
+        span = opal_datatype_span(&dtype->super, count, &gap);
+        tmp_free = (char *) malloc(span);
+        if (NULL == tmp_free) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        tmp = tmp_free - gap;
+    } else if (is_root) {
+        tmp = (char *) rbuf;
+    }
+
+    /* Phase 1: reduce on each node to the leader */
+    if (is_root && MPI_IN_PLACE == sbuf) {
+        local_sbuf = is_leader ? MPI_IN_PLACE : rbuf;
+    } else {
+        local_sbuf = sbuf;
+    }
+    err = local_comm->c_coll->coll_reduce(local_sbuf, tmp, count, dtype, op, 0,
+                                          local_comm,
+                                          local_comm->c_coll->coll_reduce_module);
+    if (MPI_SUCCESS != err) {
+        goto exit;
+    }
+
+    /* Phase 2: reduce among the leaders to the leader of the root's node */
+    if (is_leader) {
+        err = leader_comm->c_coll->coll_reduce((my_node == root_node) ? MPI_IN_PLACE : tmp,
+                                               tmp, count, dtype, op, root_node,
+                                               leader_comm,
+                                               leader_comm->c_coll->coll_reduce_module);
+        if (MPI_SUCCESS != err) {
+            goto exit;
+        }
+    }
+
+    /* Phase 3: hand the result over to the root */
+    if (my_node == root_node && 0 != root_local) {
+        if (is_leader) {
+            err = MCA_PML_CALL(send(tmp, count, dtype, root_local,
+                                    MCA_COLL_BASE_TAG_REDUCE,
+                                    MCA_PML_BASE_SEND_STANDARD, local_comm));
+        } else if (is_root) {
+            err = MCA_PML_CALL(recv(rbuf, count, dtype, 0,
+                                    MCA_COLL_BASE_TAG_REDUCE, local_comm,
+                                    MPI_STATUS_IGNORE));
+        }
+    }
+
+ exit:
+    free(tmp_free);
+    return err;
+}
@@ -29,6 +29,7 @@
 
 #include "ompi/mca/coll/coll.h"
 #include "ompi/mca/coll/base/coll_base_util.h"
+#include "opal/class/opal_hash_table.h"
 #include "opal/sys/atomic.h"
 
 BEGIN_C_DECLS
@@ -38,20 +39,6 @@ BEGIN_C_DECLS
 /* the debug level */
 #define NBC_DLEVEL 0
 
-/* enable schedule caching - undef NBC_CACHE_SCHEDULE to deactivate it */
-/* TODO: this whole schedule cache stuff does not work with the tmbuf
- * :-( - first, the tmpbuf must not be freed if a schedule using it is
- * still in the cache and second, the tmpbuf used by the schedule must
- * be attached to the handle that uses this schedule !!!!
- * I.E., THIS IS EXPERIMENTAL AND MIGHT NOT WORK */
-/* It also leaks memory because the schedule is never cleaned up when
-   the communicator is destroyed, so don't use it for now */
-#ifdef NBC_CACHE_SCHEDULE
-#undef NBC_CACHE_SCHEDULE
-#endif
-#define NBC_SCHED_DICT_UPPER 1024 /* max. number of dict entries */
-#define NBC_SCHED_DICT_LOWER 512  /* nuber of dict entries after wipe, if SCHED_DICT_UPPER is reached */
-
 /********************* end of LibNBC tuning parameters ************************/
 
 /* Function return codes  */
@@ -67,7 +54,7 @@ BEGIN_C_DECLS
 #define NBC_INVALID_TOPOLOGY_COMM 8 /* invalid topology attached to communicator */
 
 /* number of implemented collective functions */
-#define NBC_NUM_COLL 17
+#define NBC_NUM_COLL 22
 
 extern bool libnbc_ibcast_skip_dt_decision;
 extern int libnbc_iallgather_algorithm;
@@ -77,6 +64,7 @@ extern int libnbc_ibcast_knomial_radix;
 extern int libnbc_iexscan_algorithm;
 extern int libnbc_ireduce_algorithm;
 extern int libnbc_iscan_algorithm;
+extern int libnbc_schedule_cache_size;
 
 struct ompi_coll_libnbc_component_t {
     mca_coll_base_component_2_0_0_t super;
@@ -95,31 +83,58 @@ struct ompi_coll_libnbc_module_t {
     opal_mutex_t mutex;
     bool comm_registered;
     int tag;
-#ifdef NBC_CACHE_SCHEDULE
-  void *NBC_Dict[NBC_NUM_COLL]; /* this should point to a struct
-                                      hb_tree, but since this is a
-                                      public header-file, this would be
-                                      an include mess :-(. So let's void
-                                      it ...*/
-  int NBC_Dict_size[NBC_NUM_COLL];
-#endif
+    /* schedules of the recent collectives on this communicator, keyed
+       by their arguments (see NBC_Sched_cache_get()) */
+    opal_hash_table_t sched_cache;
+    /* same entries, most recently used first */
+    opal_list_t sched_cache_lru;
 };
 typedef struct ompi_coll_libnbc_module_t ompi_coll_libnbc_module_t;
 OBJ_CLASS_DECLARATION(ompi_coll_libnbc_module_t);
 
 typedef ompi_coll_libnbc_module_t NBC_Comminfo;
 
+struct NBC_Sched_entry;
+
 struct NBC_Schedule {
     opal_object_t super;
     volatile int size;
     volatile int current_round_offset;
     char *data;
+    /* cache entry the schedule is about to be inserted in, or, for a
+       schedule cached along with its temporary buffer, the entry it
+       belongs to; NULL otherwise */
+    struct NBC_Sched_entry *cache_entry;
 };
 
 typedef struct NBC_Schedule NBC_Schedule;
 
 OBJ_CLASS_DECLARATION(NBC_Schedule);
 
+/* A cached schedule.  Schedules that use a temporary buffer may embed
+   its address, so the buffer is cached with them and the entry can
+   only be used by one request at a time. */
+struct NBC_Sched_entry {
+    opal_list_item_t super;
+    NBC_Schedule *schedule;
+    void *tmpbuf;
+    /* set while a request uses tmpbuf */
+    opal_atomic_int32_t in_use;
+    /* whether the entry made it into the cache */
+    bool inserted;
+    /* the key, and the user datatypes and operations it refers to, which
+       are retained so that their handles are not reused while the entry
+       exists */
+    void *key;
+    size_t keylen;
+    opal_object_t **objs;
+    int nobjs;
+};
+
+typedef struct NBC_Sched_entry NBC_Sched_entry;
+
+OBJ_CLASS_DECLARATION(NBC_Sched_entry);
+
 struct ompi_coll_libnbc_request_t {
     ompi_coll_base_nbc_request_t super;
     MPI_Comm comm;
@@ -128,9 +143,16 @@ struct ompi_coll_libnbc_request_t {
     int tag;
     volatile int req_count;
     ompi_request_t **req_array;
+    int req_size; /* allocated length of req_array, kept across rounds */
+    /* persistent PML requests for all sends and receives of the schedule,
+       in schedule order, set up once for persistent collectives */
+    ompi_request_t **preq_array;
+    int preq_count;
+    int preq_index; /* next one to start */
     NBC_Comminfo *comminfo;
     NBC_Schedule *schedule;
     void *tmpbuf; /* temporary buffer e.g. used for Reduce */
+    NBC_Sched_entry *cache_entry; /* cache entry tmpbuf belongs to, if any */
     /* TODO: we should make a handle pointer to a state later (that the user
      * can move request handles) */
 };
@@ -100,6 +100,8 @@ static mca_base_var_enum_value_t iscan_algorithms[] = {
     {0, NULL}
 };
 
+int libnbc_schedule_cache_size = 64;       /* max. number of cached schedules per communicator */
+
 static int libnbc_open(void);
 static int libnbc_close(void);
 static int libnbc_register(void);
@@ -280,6 +282,16 @@ libnbc_register(void)
                                     &libnbc_iscan_algorithm);
     OBJ_RELEASE(new_enum);
 
+    libnbc_schedule_cache_size = 64;
+    (void) mca_base_component_var_register(&mca_coll_libnbc_component.super.collm_version,
+                                           "schedule_cache_size",
+                                           "Maximum number of schedules kept per communicator for reuse by later "
+                                           "calls with the same arguments (0 = no caching)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &libnbc_schedule_cache_size);
+
     return OMPI_SUCCESS;
 }
 
@@ -480,12 +492,17 @@ libnbc_module_construct(ompi_coll_libnbc_module_t *module)
 {
     OBJ_CONSTRUCT(&module->mutex, opal_mutex_t);
     module->comm_registered = false;
+    OBJ_CONSTRUCT(&module->sched_cache, opal_hash_table_t);
+    OBJ_CONSTRUCT(&module->sched_cache_lru, opal_list_t);
 }
 
 
 static void
 libnbc_module_destruct(ompi_coll_libnbc_module_t *module)
 {
+    NBC_Sched_cache_fini(module);
+    OBJ_DESTRUCT(&module->sched_cache_lru);
+    OBJ_DESTRUCT(&module->sched_cache);
     OBJ_DESTRUCT(&module->mutex);
 
     /* if we ever were used for a collective op, do the progress cleanup. */
@@ -561,7 +578,8 @@ request_free(struct ompi_request_t **ompi_req)
         return MPI_ERR_REQUEST;
     }
 
-    OMPI_COLL_LIBNBC_REQUEST_RETURN(request);
+    /* persistent requests keep their schedule until now */
+    NBC_Return_handle(request);
     *ompi_req = MPI_REQUEST_NULL;
 
     return OMPI_SUCCESS;
@@ -576,10 +594,22 @@ request_construct(ompi_coll_libnbc_request_t *request)
     request->super.super.req_start = request_start;
     request->super.super.req_free = request_free;
     request->super.super.req_cancel = request_cancel;
+    request->req_array = NULL;
+    request->req_size = 0;
+    request->preq_array = NULL;
+    request->preq_count = 0;
+}
+
+
+static void
+request_destruct(ompi_coll_libnbc_request_t *request)
+{
+    /* req_array survives the request going back to the free list */
+    free(request->req_array);
 }
 
 
 OBJ_CLASS_INSTANCE(ompi_coll_libnbc_request_t,
                    ompi_coll_base_nbc_request_t,
                    request_construct,
-                   NULL);
+                   request_destruct);
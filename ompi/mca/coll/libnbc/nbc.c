@@ -49,9 +49,16 @@ static void nbc_schedule_constructor (NBC_Schedule *schedule) {
   schedule->size = sizeof (int);
   schedule->current_round_offset = 0;
   schedule->data = calloc (1, schedule->size);
+  schedule->cache_entry = NULL;
 }
 
 static void nbc_schedule_destructor (NBC_Schedule *schedule) {
+  /* a cached schedule is released by its entry, so only a pending
+   * entry can be left here */
+  if (NULL != schedule->cache_entry) {
+    OBJ_RELEASE(schedule->cache_entry);
+    schedule->cache_entry = NULL;
+  }
   free (schedule->data);
   schedule->data = NULL;
 }
@@ -296,6 +303,16 @@ int NBC_Sched_commit(NBC_Schedule *schedule) {
  * to be called *only* from the progress thread !!! */
 static inline void NBC_Free (NBC_Handle* handle) {
 
+  if (NULL != handle->preq_array) {
+    /* the persistent requests refer to the schedule's buffers */
+    for (int i = 0 ; i < handle->preq_count ; ++i) {
+      ompi_request_free (handle->preq_array + i);
+    }
+    free (handle->preq_array);
+    handle->preq_array = NULL;
+    handle->preq_count = 0;
+  }
+
   if (NULL != handle->schedule) {
     /* release schedule */
     OBJ_RELEASE (handle->schedule);
@@ -303,9 +320,14 @@ static inline void NBC_Free (NBC_Handle* handle) {
   }
 
   /* if the nbc_I<collective> attached some data */
-  /* problems with schedule cache here, see comment (TODO) in
-   * nbc_internal.h */
-  if (NULL != handle->tmpbuf) {
+  if (NULL != handle->cache_entry) {
+    /* the buffer belongs to a cached schedule, give it back */
+    opal_atomic_wmb();
+    handle->cache_entry->in_use = 0;
+    OBJ_RELEASE(handle->cache_entry);
+    handle->cache_entry = NULL;
+    handle->tmpbuf = NULL;
+  } else if (NULL != handle->tmpbuf) {
     free((void*)handle->tmpbuf);
     handle->tmpbuf = NULL;
   }
@@ -342,7 +364,10 @@ int NBC_Progress(NBC_Handle *handle) {
                 handle->super.super.req_status.MPI_ERROR = subreq->req_status.MPI_ERROR;
             }
             handle->req_count--;
-            ompi_request_free(&subreq);
+            /* persistent subrequests are restarted with the next round */
+            if (NULL == handle->preq_array) {
+                ompi_request_free(&subreq);
+            }
         } else {
             flag = false;
             break;
@@ -355,13 +380,7 @@ int NBC_Progress(NBC_Handle *handle) {
 
   /* a round is finished */
   if (flag) {
-    /* reset handle for next round */
-    if (NULL != handle->req_array) {
-      /* free request array */
-      free (handle->req_array);
-      handle->req_array = NULL;
-    }
-
+    /* reset handle for next round, req_array is kept for it */
     handle->req_count = 0;
 
     /* previous round had an error */
@@ -411,11 +430,29 @@ int NBC_Progress(NBC_Handle *handle) {
   return ret;
 }
 
+/* returns the next slot of req_array, growing the array if needed */
+static inline ompi_request_t **nbc_req_slot(NBC_Handle *handle) {
+  if (handle->req_count == handle->req_size) {
+    int size = handle->req_size ? 2 * handle->req_size : 8;
+    ompi_request_t **tmp;
+
+    tmp = (ompi_request_t **) realloc ((void *) handle->req_array, size * sizeof (ompi_request_t *));
+    if (NULL == tmp) {
+      return NULL;
+    }
+
+    handle->req_array = tmp;
+    handle->req_size = size;
+  }
+
+  return handle->req_array + handle->req_count++;
+}
+
 static inline int NBC_Start_round(NBC_Handle *handle) {
   int num; /* number of operations */
   int res;
   char* ptr;
-  MPI_Request *tmp;
+  ompi_request_t **slot;
   NBC_Fn_type type;
   NBC_Args_send     sendargs;
   NBC_Args_recv     recvargs;
@@ -440,31 +477,41 @@ static inline int NBC_Start_round(NBC_Handle *handle) {
         NBC_GET_BYTES(ptr,sendargs);
         NBC_DEBUG(5,"*buf: %p, count: %i, type: %p, dest: %i, tag: %i)\n", sendargs.buf,
                   sendargs.count, sendargs.datatype, sendargs.dest, handle->tag);
-        /* get an additional request */
-        handle->req_count++;
-        /* get buffer */
-        if(sendargs.tmpbuf) {
-          buf1=(char*)handle->tmpbuf+(long)sendargs.buf;
-        } else {
-          buf1=(void *)sendargs.buf;
-        }
 #ifdef NBC_TIMING
         Isend_time -= MPI_Wtime();
 #endif
-        tmp = (MPI_Request *) realloc ((void *) handle->req_array, handle->req_count * sizeof (MPI_Request));
-        if (NULL == tmp) {
+        /* get an additional request */
+        slot = nbc_req_slot(handle);
+        if (NULL == slot) {
           return OMPI_ERR_OUT_OF_RESOURCE;
         }
 
-        handle->req_array = tmp;
-
-        res = MCA_PML_CALL(isend(buf1, sendargs.count, sendargs.datatype, sendargs.dest, handle->tag,
-                                 MCA_PML_BASE_SEND_STANDARD, sendargs.local?handle->comm->c_local_comm:handle->comm,
-                                 handle->req_array+handle->req_count - 1));
-        if (OMPI_SUCCESS != res) {
-          NBC_Error ("Error in MPI_Isend(%lu, %i, %p, %i, %i, %lu) (%i)", (unsigned long)buf1, sendargs.count,
-                     sendargs.datatype, sendargs.dest, handle->tag, (unsigned long)handle->comm, res);
-          return res;
+        if (NULL != handle->preq_array) {
+          /* buffer, peer and tag were bound by nbc_persistent_setup().
+           * start through preq_array: the PML may replace a request that
+           * is still in use */
+          res = MCA_PML_CALL(start(1, handle->preq_array + handle->preq_index));
+          *slot = handle->preq_array[handle->preq_index++];
+          if (OMPI_SUCCESS != res) {
+            NBC_Error ("Error in MPI_Start of send to %i (%i)", sendargs.dest, res);
+            return res;
+          }
+        } else {
+          /* get buffer */
+          if(sendargs.tmpbuf) {
+            buf1=(char*)handle->tmpbuf+(long)sendargs.buf;
+          } else {
+            buf1=(void *)sendargs.buf;
+          }
+
+          res = MCA_PML_CALL(isend(buf1, sendargs.count, sendargs.datatype, sendargs.dest, handle->tag,
+                                   MCA_PML_BASE_SEND_STANDARD, sendargs.local?handle->comm->c_local_comm:handle->comm,
+                                   slot));
+          if (OMPI_SUCCESS != res) {
+            NBC_Error ("Error in MPI_Isend(%lu, %i, %p, %i, %i, %lu) (%i)", (unsigned long)buf1, sendargs.count,
+                       sendargs.datatype, sendargs.dest, handle->tag, (unsigned long)handle->comm, res);
+            return res;
+          }
         }
 #ifdef NBC_TIMING
         Isend_time += MPI_Wtime();
@@ -475,30 +522,37 @@ static inline int NBC_Start_round(NBC_Handle *handle) {
         NBC_GET_BYTES(ptr,recvargs);
         NBC_DEBUG(5, "*buf: %p, count: %i, type: %p, source: %i, tag: %i)\n", recvargs.buf, recvargs.count,
                   recvargs.datatype, recvargs.source, handle->tag);
-        /* get an additional request - TODO: req_count NOT thread safe */
-        handle->req_count++;
-        /* get buffer */
-        if(recvargs.tmpbuf) {
-          buf1=(char*)handle->tmpbuf+(long)recvargs.buf;
-        } else {
-          buf1=recvargs.buf;
-        }
 #ifdef NBC_TIMING
         Irecv_time -= MPI_Wtime();
 #endif
-        tmp = (MPI_Request *) realloc ((void *) handle->req_array, handle->req_count * sizeof (MPI_Request));
-        if (NULL == tmp) {
+        /* get an additional request - TODO: req_count NOT thread safe */
+        slot = nbc_req_slot(handle);
+        if (NULL == slot) {
           return OMPI_ERR_OUT_OF_RESOURCE;
         }
 
-        handle->req_array = tmp;
-
-        res = MCA_PML_CALL(irecv(buf1, recvargs.count, recvargs.datatype, recvargs.source, handle->tag, recvargs.local?handle->comm->c_local_comm:handle->comm,
-                                 handle->req_array+handle->req_count-1));
-        if (OMPI_SUCCESS != res) {
-          NBC_Error("Error in MPI_Irecv(%lu, %i, %p, %i, %i, %lu) (%i)", (unsigned long)buf1, recvargs.count,
-                    recvargs.datatype, recvargs.source, handle->tag, (unsigned long)handle->comm, res);
-          return res;
+        if (NULL != handle->preq_array) {
+          res = MCA_PML_CALL(start(1, handle->preq_array + handle->preq_index));
+          *slot = handle->preq_array[handle->preq_index++];
+          if (OMPI_SUCCESS != res) {
+            NBC_Error ("Error in MPI_Start of receive from %i (%i)", recvargs.source, res);
+            return res;
+          }
+        } else {
+          /* get buffer */
+          if(recvargs.tmpbuf) {
+            buf1=(char*)handle->tmpbuf+(long)recvargs.buf;
+          } else {
+            buf1=recvargs.buf;
+          }
+
+          res = MCA_PML_CALL(irecv(buf1, recvargs.count, recvargs.datatype, recvargs.source, handle->tag, recvargs.local?handle->comm->c_local_comm:handle->comm,
+                                   slot));
+          if (OMPI_SUCCESS != res) {
+            NBC_Error("Error in MPI_Irecv(%lu, %i, %p, %i, %i, %lu) (%i)", (unsigned long)buf1, recvargs.count,
+                      recvargs.datatype, recvargs.source, handle->tag, (unsigned long)handle->comm, res);
+            return res;
+          }
         }
 #ifdef NBC_TIMING
         Irecv_time += MPI_Wtime();
@@ -597,51 +651,11 @@ void NBC_Return_handle(ompi_coll_libnbc_request_t *request) {
 int  NBC_Init_comm(MPI_Comm comm, NBC_Comminfo *comminfo) {
   comminfo->tag= MCA_COLL_BASE_TAG_NONBLOCKING_BASE;
 
-#ifdef NBC_CACHE_SCHEDULE
-  /* initialize the NBC_ALLTOALL SchedCache tree */
-  comminfo->NBC_Dict[NBC_ALLTOALL] = hb_tree_new((dict_cmp_func)NBC_Alltoall_args_compare, NBC_SchedCache_args_delete_key_dummy, NBC_SchedCache_args_delete);
-  if(comminfo->NBC_Dict[NBC_ALLTOALL] == NULL) { printf("Error in hb_tree_new()\n"); return OMPI_ERROR;; }
-  NBC_DEBUG(1, "added tree at address %lu\n", (unsigned long)comminfo->NBC_Dict[NBC_ALLTOALL]);
-  comminfo->NBC_Dict_size[NBC_ALLTOALL] = 0;
-  /* initialize the NBC_ALLGATHER SchedCache tree */
-  comminfo->NBC_Dict[NBC_ALLGATHER] = hb_tree_new((dict_cmp_func)NBC_Allgather_args_compare, NBC_SchedCache_args_delete_key_dummy, NBC_SchedCache_args_delete);
-  if(comminfo->NBC_Dict[NBC_ALLGATHER] == NULL) { printf("Error in hb_tree_new()\n"); return OMPI_ERROR;; }
-  NBC_DEBUG(1, "added tree at address %lu\n", (unsigned long)comminfo->NBC_Dict[NBC_ALLGATHER]);
-  comminfo->NBC_Dict_size[NBC_ALLGATHER] = 0;
-  /* initialize the NBC_ALLREDUCE SchedCache tree */
-  comminfo->NBC_Dict[NBC_ALLREDUCE] = hb_tree_new((dict_cmp_func)NBC_Allreduce_args_compare, NBC_SchedCache_args_delete_key_dummy, NBC_SchedCache_args_delete);
-  if(comminfo->NBC_Dict[NBC_ALLREDUCE] == NULL) { printf("Error in hb_tree_new()\n"); return OMPI_ERROR;; }
-  NBC_DEBUG(1, "added tree at address %lu\n", (unsigned long)comminfo->NBC_Dict[NBC_ALLREDUCE]);
-  comminfo->NBC_Dict_size[NBC_ALLREDUCE] = 0;
-  /* initialize the NBC_BARRIER SchedCache tree - is not needed -
-   * schedule is hung off directly */
-  comminfo->NBC_Dict_size[NBC_BARRIER] = 0;
-  /* initialize the NBC_BCAST SchedCache tree */
-  comminfo->NBC_Dict[NBC_BCAST] = hb_tree_new((dict_cmp_func)NBC_Bcast_args_compare, NBC_SchedCache_args_delete_key_dummy, NBC_SchedCache_args_delete);
-  if(comminfo->NBC_Dict[NBC_BCAST] == NULL) { printf("Error in hb_tree_new()\n"); return OMPI_ERROR;; }
-  NBC_DEBUG(1, "added tree at address %lu\n", (unsigned long)comminfo->NBC_Dict[NBC_BCAST]);
-  comminfo->NBC_Dict_size[NBC_BCAST] = 0;
-  /* initialize the NBC_GATHER SchedCache tree */
-  comminfo->NBC_Dict[NBC_GATHER] = hb_tree_new((dict_cmp_func)NBC_Gather_args_compare, NBC_SchedCache_args_delete_key_dummy, NBC_SchedCache_args_delete);
-  if(comminfo->NBC_Dict[NBC_GATHER] == NULL) { printf("Error in hb_tree_new()\n"); return OMPI_ERROR;; }
-  NBC_DEBUG(1, "added tree at address %lu\n", (unsigned long)comminfo->NBC_Dict[NBC_GATHER]);
-  comminfo->NBC_Dict_size[NBC_GATHER] = 0;
-  /* initialize the NBC_REDUCE SchedCache tree */
-  comminfo->NBC_Dict[NBC_REDUCE] = hb_tree_new((dict_cmp_func)NBC_Reduce_args_compare, NBC_SchedCache_args_delete_key_dummy, NBC_SchedCache_args_delete);
-  if(comminfo->NBC_Dict[NBC_REDUCE] == NULL) { printf("Error in hb_tree_new()\n"); return OMPI_ERROR;; }
-  NBC_DEBUG(1, "added tree at address %lu\n", (unsigned long)comminfo->NBC_Dict[NBC_REDUCE]);
-  comminfo->NBC_Dict_size[NBC_REDUCE] = 0;
-  /* initialize the NBC_SCAN SchedCache tree */
-  comminfo->NBC_Dict[NBC_SCAN] = hb_tree_new((dict_cmp_func)NBC_Scan_args_compare, NBC_SchedCache_args_delete_key_dummy, NBC_SchedCache_args_delete);
-  if(comminfo->NBC_Dict[NBC_SCAN] == NULL) { printf("Error in hb_tree_new()\n"); return OMPI_ERROR;; }
-  NBC_DEBUG(1, "added tree at address %lu\n", (unsigned long)comminfo->NBC_Dict[NBC_SCAN]);
-  comminfo->NBC_Dict_size[NBC_SCAN] = 0;
-  /* initialize the NBC_SCATTER SchedCache tree */
-  comminfo->NBC_Dict[NBC_SCATTER] = hb_tree_new((dict_cmp_func)NBC_Scatter_args_compare, NBC_SchedCache_args_delete_key_dummy, NBC_SchedCache_args_delete);
-  if(comminfo->NBC_Dict[NBC_SCATTER] == NULL) { printf("Error in hb_tree_new()\n"); return OMPI_ERROR;; }
-  NBC_DEBUG(1, "added tree at address %lu\n", (unsigned long)comminfo->NBC_Dict[NBC_SCATTER]);
-  comminfo->NBC_Dict_size[NBC_SCATTER] = 0;
-#endif
+  if (0 < libnbc_schedule_cache_size) {
+    if (OPAL_SUCCESS != opal_hash_table_init(&comminfo->sched_cache, libnbc_schedule_cache_size)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+  }
 
   return OMPI_SUCCESS;
 }
@@ -657,6 +671,7 @@ int NBC_Start(NBC_Handle *handle) {
   /* kick off first round */
   handle->super.super.req_state = OMPI_REQUEST_ACTIVE;
   handle->super.super.req_status.MPI_ERROR = OMPI_SUCCESS;
+  handle->preq_index = 0;
   res = NBC_Start_round(handle);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
     return res;
@@ -669,6 +684,393 @@ int NBC_Start(NBC_Handle *handle) {
   return OMPI_SUCCESS;
 }
 
+/* binds every send and receive of a persistent collective to a
+ * persistent PML request, so that buffers, peers and the tag are
+ * resolved once and a restart neither allocates requests nor grows
+ * req_array */
+static int nbc_persistent_setup(NBC_Handle *handle) {
+  int num, res, count = 0, max_round = 0;
+  NBC_Fn_type type;
+  NBC_Args_send sendargs;
+  NBC_Args_recv recvargs;
+  ompi_request_t **tmp;
+  void *buf;
+  char *ptr;
+
+  /* count the sends and receives, overall and per round */
+  ptr = handle->schedule->data;
+  for (;;) {
+    int round_count = 0;
+
+    NBC_GET_BYTES(ptr,num);
+    for (int i = 0 ; i < num ; ++i) {
+      memcpy (&type, ptr, sizeof (type));
+      switch(type) {
+        case SEND:
+          ptr += sizeof (NBC_Args_send);
+          ++round_count;
+          break;
+        case RECV:
+          ptr += sizeof (NBC_Args_recv);
+          ++round_count;
+          break;
+        case OP:
+          ptr += sizeof (NBC_Args_op);
+          break;
+        case COPY:
+          ptr += sizeof (NBC_Args_copy);
+          break;
+        case UNPACK:
+          ptr += sizeof (NBC_Args_unpack);
+          break;
+        default:
+          NBC_Error ("nbc_persistent_setup: bad type %li", (long)type);
+          return OMPI_ERROR;
+      }
+    }
+
+    count += round_count;
+    if (round_count > max_round) {
+      max_round = round_count;
+    }
+
+    /* delimiter: 0 after the last round */
+    if (0 == *ptr) {
+      break;
+    }
+    ++ptr;
+  }
+
+  if (0 == count) {
+    return OMPI_SUCCESS;
+  }
+
+  if (handle->req_size < max_round) {
+    tmp = (ompi_request_t **) realloc ((void *) handle->req_array, max_round * sizeof (ompi_request_t *));
+    if (NULL == tmp) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    handle->req_array = tmp;
+    handle->req_size = max_round;
+  }
+
+  handle->preq_array = (ompi_request_t **) malloc (count * sizeof (ompi_request_t *));
+  if (NULL == handle->preq_array) {
+    return OMPI_ERR_OUT_OF_RESOURCE;
+  }
+
+  ptr = handle->schedule->data;
+  for (;;) {
+    NBC_GET_BYTES(ptr,num);
+    for (int i = 0 ; i < num ; ++i) {
+      memcpy (&type, ptr, sizeof (type));
+      switch(type) {
+        case SEND:
+          NBC_GET_BYTES(ptr,sendargs);
+          if (sendargs.tmpbuf) {
+            buf = (char *) handle->tmpbuf + (long) sendargs.buf;
+          } else {
+            buf = (void *) sendargs.buf;
+          }
+          res = MCA_PML_CALL(isend_init(buf, sendargs.count, sendargs.datatype, sendargs.dest, handle->tag,
+                                        MCA_PML_BASE_SEND_STANDARD,
+                                        sendargs.local ? handle->comm->c_local_comm : handle->comm,
+                                        handle->preq_array + handle->preq_count));
+          if (OMPI_SUCCESS != res) {
+            NBC_Error ("Error in MPI_Send_init(%lu, %i, %p, %i, %i, %lu) (%i)", (unsigned long)buf, sendargs.count,
+                       sendargs.datatype, sendargs.dest, handle->tag, (unsigned long)handle->comm, res);
+            return res;
+          }
+          handle->preq_count++;
+          break;
+        case RECV:
+          NBC_GET_BYTES(ptr,recvargs);
+          if (recvargs.tmpbuf) {
+            buf = (char *) handle->tmpbuf + (long) recvargs.buf;
+          } else {
+            buf = recvargs.buf;
+          }
+          res = MCA_PML_CALL(irecv_init(buf, recvargs.count, recvargs.datatype, recvargs.source, handle->tag,
+                                        recvargs.local ? handle->comm->c_local_comm : handle->comm,
+                                        handle->preq_array + handle->preq_count));
+          if (OMPI_SUCCESS != res) {
+            NBC_Error ("Error in MPI_Recv_init(%lu, %i, %p, %i, %i, %lu) (%i)", (unsigned long)buf, recvargs.count,
+                       recvargs.datatype, recvargs.source, handle->tag, (unsigned long)handle->comm, res);
+            return res;
+          }
+          handle->preq_count++;
+          break;
+        case OP:
+          ptr += sizeof (NBC_Args_op);
+          break;
+        case COPY:
+          ptr += sizeof (NBC_Args_copy);
+          break;
+        default:
+          ptr += sizeof (NBC_Args_unpack);
+          break;
+      }
+    }
+
+    if (0 == *ptr) {
+      break;
+    }
+    ++ptr;
+  }
+
+  return OMPI_SUCCESS;
+}
+
+/******************************* schedule cache *******************************/
+
+static void nbc_sched_entry_constructor (NBC_Sched_entry *entry) {
+  entry->schedule = NULL;
+  entry->tmpbuf = NULL;
+  entry->in_use = 0;
+  entry->inserted = false;
+  entry->key = NULL;
+  entry->keylen = 0;
+  entry->objs = NULL;
+  entry->nobjs = 0;
+}
+
+static void nbc_sched_entry_destructor (NBC_Sched_entry *entry) {
+  if (NULL != entry->schedule) {
+    entry->schedule->cache_entry = NULL;
+    OBJ_RELEASE(entry->schedule);
+  }
+  free(entry->tmpbuf);
+  if (entry->inserted) {
+    for (int i = 0 ; i < entry->nobjs ; ++i) {
+      OBJ_RELEASE(entry->objs[i]);
+    }
+  }
+  free(entry->objs);
+  free(entry->key);
+}
+
+OBJ_CLASS_INSTANCE(NBC_Sched_entry, opal_list_item_t, nbc_sched_entry_constructor,
+                   nbc_sched_entry_destructor);
+
+void NBC_Sched_key_init(NBC_Sched_key *key, int coll, bool persistent) {
+  key->data = key->inline_data;
+  key->len = 0;
+  key->size = sizeof(key->inline_data);
+  key->objs = key->inline_objs;
+  key->nobjs = 0;
+  key->objs_size = NBC_SCHED_KEY_INLINE_OBJS;
+  key->valid = (0 < libnbc_schedule_cache_size);
+
+  NBC_SCHED_KEY_ADD(key, coll);
+  NBC_SCHED_KEY_ADD(key, persistent);
+}
+
+static void nbc_sched_key_fini(NBC_Sched_key *key) {
+  if (key->data != key->inline_data) {
+    free(key->data);
+  }
+  if (key->objs != key->inline_objs) {
+    free(key->objs);
+  }
+  key->data = NULL;
+  key->objs = NULL;
+  key->valid = false;
+}
+
+int NBC_Sched_key_grow(NBC_Sched_key *key, size_t len) {
+  size_t size = key->size;
+  char *data;
+
+  if (!key->valid) {
+    return OMPI_ERR_NOT_AVAILABLE;
+  }
+  while (size < key->len + len) {
+    size *= 2;
+  }
+  if (key->data == key->inline_data) {
+    data = malloc(size);
+    if (NULL != data) {
+      memcpy(data, key->data, key->len);
+    }
+  } else {
+    data = realloc(key->data, size);
+  }
+  if (OPAL_UNLIKELY(NULL == data)) {
+    /* just don't cache this one */
+    nbc_sched_key_fini(key);
+    return OMPI_ERR_OUT_OF_RESOURCE;
+  }
+  key->data = data;
+  key->size = size;
+  return OMPI_SUCCESS;
+}
+
+void NBC_Sched_key_add_obj(NBC_Sched_key *key, opal_object_t *obj) {
+  opal_object_t **objs;
+
+  if (!key->valid) {
+    return;
+  }
+  if (key->nobjs == key->objs_size) {
+    objs = malloc(2 * key->objs_size * sizeof(opal_object_t *));
+    if (OPAL_UNLIKELY(NULL == objs)) {
+      nbc_sched_key_fini(key);
+      return;
+    }
+    memcpy(objs, key->objs, key->nobjs * sizeof(opal_object_t *));
+    if (key->objs != key->inline_objs) {
+      free(key->objs);
+    }
+    key->objs = objs;
+    key->objs_size *= 2;
+  }
+  key->objs[key->nobjs++] = obj;
+}
+
+/* Look up the schedule for the collective described by key.  On a hit,
+ * return true, with a reference on the schedule and, if it uses one,
+ * the temporary buffer that goes with it (reserved until the request
+ * is freed).  On a miss, return false with a new, empty schedule (NULL
+ * if out of resources) that will be cached once committed and passed
+ * to NBC_Schedule_request(), unless the entry already exists but its
+ * buffer is being used by another request.  The key is consumed in both
+ * cases. */
+bool NBC_Sched_cache_get(ompi_coll_libnbc_module_t *module, NBC_Sched_key *key,
+                         NBC_Schedule **schedule, void **tmpbuf) {
+  NBC_Sched_entry *entry = NULL;
+  bool found = false;
+
+  if (key->valid) {
+    OPAL_THREAD_LOCK(&module->mutex);
+    if (OPAL_SUCCESS == opal_hash_table_get_value_ptr(&module->sched_cache, key->data,
+                                                      key->len, (void **) &entry)) {
+      int32_t free_entry = 0;
+      if (NULL == entry->tmpbuf ||
+          opal_atomic_compare_exchange_strong_32(&entry->in_use, &free_entry, 1)) {
+        opal_list_remove_item(&module->sched_cache_lru, &entry->super);
+        opal_list_prepend(&module->sched_cache_lru, &entry->super);
+        OBJ_RETAIN(entry->schedule);
+        if (NULL != entry->tmpbuf) {
+          /* the reservation holds a reference on the entry */
+          OBJ_RETAIN(entry);
+        }
+        *schedule = entry->schedule;
+        if (NULL != tmpbuf) {
+          *tmpbuf = entry->tmpbuf;
+        }
+        found = true;
+      }
+    }
+    OPAL_THREAD_UNLOCK(&module->mutex);
+  }
+
+  if (found) {
+    nbc_sched_key_fini(key);
+    return true;
+  }
+
+  *schedule = OBJ_NEW(NBC_Schedule);
+  if (OPAL_LIKELY(NULL != *schedule) && key->valid && NULL == entry) {
+    entry = OBJ_NEW(NBC_Sched_entry);
+    if (OPAL_LIKELY(NULL != entry)) {
+      entry->key = malloc(key->len);
+      entry->objs = malloc(key->nobjs * sizeof(opal_object_t *));
+      if (OPAL_LIKELY(NULL != entry->key && (NULL != entry->objs || 0 == key->nobjs))) {
+        memcpy(entry->key, key->data, key->len);
+        entry->keylen = key->len;
+        memcpy(entry->objs, key->objs, key->nobjs * sizeof(opal_object_t *));
+        entry->nobjs = key->nobjs;
+        (*schedule)->cache_entry = entry;
+      } else {
+        OBJ_RELEASE(entry);
+      }
+    }
+  }
+  nbc_sched_key_fini(key);
+
+  return false;
+}
+
+static void nbc_sched_cache_evict(ompi_coll_libnbc_module_t *module, NBC_Sched_entry *entry) {
+  opal_hash_table_remove_value_ptr(&module->sched_cache, entry->key, entry->keylen);
+  opal_list_remove_item(&module->sched_cache_lru, &entry->super);
+  /* requests still using the entry hold their own reference */
+  OBJ_RELEASE(entry);
+}
+
+/* insert the pending entry of a newly built schedule in the cache;
+ * return the entry if the request has to give tmpbuf back to it */
+static NBC_Sched_entry *nbc_sched_cache_insert(ompi_coll_libnbc_module_t *module,
+                                               NBC_Schedule *schedule, void *tmpbuf) {
+  NBC_Sched_entry *entry = schedule->cache_entry, *other;
+
+  if (entry->inserted) {
+    /* a cached schedule, reserved by NBC_Sched_cache_get() */
+    return entry;
+  }
+
+  OPAL_THREAD_LOCK(&module->mutex);
+  if (OPAL_SUCCESS == opal_hash_table_get_value_ptr(&module->sched_cache, entry->key,
+                                                    entry->keylen, (void **) &other) ||
+      OPAL_SUCCESS != opal_hash_table_set_value_ptr(&module->sched_cache, entry->key,
+                                                    entry->keylen, entry)) {
+    /* another thread was faster */
+    OPAL_THREAD_UNLOCK(&module->mutex);
+    schedule->cache_entry = NULL;
+    OBJ_RELEASE(entry);
+    return NULL;
+  }
+
+  entry->inserted = true;
+  for (int i = 0 ; i < entry->nobjs ; ++i) {
+    OBJ_RETAIN(entry->objs[i]);
+  }
+  OBJ_RETAIN(schedule);
+  entry->schedule = schedule;
+  opal_list_prepend(&module->sched_cache_lru, &entry->super);
+  while ((int) opal_list_get_size(&module->sched_cache_lru) > libnbc_schedule_cache_size) {
+    nbc_sched_cache_evict(module, (NBC_Sched_entry *) opal_list_get_last(&module->sched_cache_lru));
+  }
+
+  if (NULL == tmpbuf) {
+    /* the schedule can be shared by any number of requests */
+    schedule->cache_entry = NULL;
+    OPAL_THREAD_UNLOCK(&module->mutex);
+    return NULL;
+  }
+
+  /* the entry now owns tmpbuf; the request is its first user */
+  entry->tmpbuf = tmpbuf;
+  entry->in_use = 1;
+  OBJ_RETAIN(entry);
+  OPAL_THREAD_UNLOCK(&module->mutex);
+
+  return entry;
+}
+
+/* release a schedule and its buffer that are not handed to a request */
+static void nbc_sched_cache_abort(NBC_Schedule *schedule, void *tmpbuf) {
+  NBC_Sched_entry *entry = schedule->cache_entry;
+
+  if (NULL != entry && entry->inserted) {
+    opal_atomic_wmb();
+    entry->in_use = 0;
+    OBJ_RELEASE(entry);
+  } else {
+    free(tmpbuf);
+  }
+  OBJ_RELEASE(schedule);
+}
+
+void NBC_Sched_cache_fini(ompi_coll_libnbc_module_t *module) {
+  NBC_Sched_entry *entry, *next;
+
+  OPAL_LIST_FOREACH_SAFE(entry, next, &module->sched_cache_lru, NBC_Sched_entry) {
+    nbc_sched_cache_evict(module, entry);
+  }
+}
+
 int NBC_Schedule_request(NBC_Schedule *schedule, ompi_communicator_t *comm,
                          ompi_coll_libnbc_module_t *module, bool persistent,
                          ompi_request_t **request, void *tmpbuf) {
@@ -680,6 +1082,7 @@ int NBC_Schedule_request(NBC_Schedule *schedule, ompi_communicator_t *comm,
   if (((int *)schedule->data)[0] == 0 && schedule->data[sizeof(int)] == 0) {
     ret = nbc_get_noop_request(persistent, request);
     if (OMPI_SUCCESS != ret) {
+      nbc_sched_cache_abort(schedule, tmpbuf);
       return OMPI_ERR_OUT_OF_RESOURCE;
     }
 
@@ -693,18 +1096,22 @@ int NBC_Schedule_request(NBC_Schedule *schedule, ompi_communicator_t *comm,
     }
     OPAL_THREAD_UNLOCK(&module->mutex);
 
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
+    nbc_sched_cache_abort(schedule, tmpbuf);
 
     return OMPI_SUCCESS;
   }
 
   OMPI_COLL_LIBNBC_REQUEST_ALLOC(comm, persistent, handle);
-  if (NULL == handle) return OMPI_ERR_OUT_OF_RESOURCE;
+  if (NULL == handle) {
+    nbc_sched_cache_abort(schedule, tmpbuf);
+    return OMPI_ERR_OUT_OF_RESOURCE;
+  }
 
   handle->tmpbuf = NULL;
+  handle->cache_entry = NULL;
   handle->req_count = 0;
-  handle->req_array = NULL;
+  handle->preq_array = NULL;
+  handle->preq_count = 0;
   handle->comm = comm;
   handle->schedule = NULL;
   handle->row_offset = 0;
@@ -732,6 +1139,7 @@ int NBC_Schedule_request(NBC_Schedule *schedule, ompi_communicator_t *comm,
       int32_t tmp =
           OPAL_THREAD_ADD_FETCH32(&mca_coll_libnbc_component.active_comms, 1);
       if (tmp == 1) {
+          (void) opal_progress_set_name(ompi_coll_libnbc_progress, "coll_libnbc");
           opal_progress_register(ompi_coll_libnbc_progress);
       }
   }
@@ -746,20 +1154,20 @@ int NBC_Schedule_request(NBC_Schedule *schedule, ompi_communicator_t *comm,
 
   handle->tmpbuf = tmpbuf;
   handle->schedule = schedule;
+  if (NULL != schedule->cache_entry) {
+    handle->cache_entry = nbc_sched_cache_insert(module, schedule, tmpbuf);
+  }
+
+  if (persistent) {
+    ret = nbc_persistent_setup(handle);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != ret)) {
+      NBC_Return_handle(handle);
+      return ret;
+    }
+  }
+
   *request = (ompi_request_t *) handle;
 
   return OMPI_SUCCESS;
 }
 
-#ifdef NBC_CACHE_SCHEDULE
-void NBC_SchedCache_args_delete_key_dummy(void *k) {
-    /* do nothing because the key and the data element are identical :-)
-     * both (the single one :) is freed in NBC_<COLLOP>_args_delete() */
-}
-
-void NBC_SchedCache_args_delete(void *entry) {
-  struct NBC_dummyarg *tmp = (struct NBC_dummyarg*)entry;
-  OBJ_RELEASE(tmp->schedule);
-  free(entry);
-}
-#endif
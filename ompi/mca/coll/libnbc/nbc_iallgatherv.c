@@ -22,10 +22,6 @@
  */
 #include "nbc_internal.h"
 
-/* an allgatherv schedule can not be cached easily because the contents
- * ot the recvcounts array may change, so a comparison of the address
- * would not be sufficient ... we simply do not cache it */
-
 /* simple linear MPI_Iallgatherv
  * the algorithm uses p-1 rounds
  * first round:
@@ -41,6 +37,7 @@ static int nbc_allgatherv_init(const void* sendbuf, int sendcount, MPI_Datatype
   int rank, p, res, speer, rpeer;
   MPI_Aint rcvext;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   char *rbuf, *sbuf, inplace;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -67,52 +64,60 @@ static int nbc_allgatherv_init(const void* sendbuf, int sendcount, MPI_Datatype
     }
   }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (NULL == schedule) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+  NBC_Sched_key_init(&key, NBC_ALLGATHERV, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_SCHED_KEY_ADD(&key, sendcount);
+  NBC_Sched_key_add_dtype(&key, sendtype);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_Sched_key_add(&key, recvcounts, p * sizeof(int));
+  NBC_Sched_key_add(&key, displs, p * sizeof(int));
+  NBC_Sched_key_add_dtype(&key, recvtype);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  sbuf = (char *) recvbuf + displs[rank] * rcvext;
+    sbuf = (char *) recvbuf + displs[rank] * rcvext;
 
-  if (persistent && !inplace) { /* for nonblocking, data has been copied already */
-    /* copy my data to receive buffer (= send buffer of NBC_Sched_send) */
-    res = NBC_Sched_copy ((void *)sendbuf, false, sendcount, sendtype,
-                          sbuf, false, recvcounts[rank], recvtype, schedule, true);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-      OBJ_RELEASE(schedule);
-      return res;
+    if (persistent && !inplace) { /* for nonblocking, data has been copied already */
+      /* copy my data to receive buffer (= send buffer of NBC_Sched_send) */
+      res = NBC_Sched_copy ((void *)sendbuf, false, sendcount, sendtype,
+                            sbuf, false, recvcounts[rank], recvtype, schedule, true);
+      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+        OBJ_RELEASE(schedule);
+        return res;
+      }
     }
-  }
 
-  /* do p-1 rounds */
-  for (int r = 1 ; r < p ; ++r) {
-    speer = (rank + r) % p;
-    rpeer = (rank - r + p) % p;
-    rbuf = (char *)recvbuf + displs[rpeer] * rcvext;
+    /* do p-1 rounds */
+    for (int r = 1 ; r < p ; ++r) {
+      speer = (rank + r) % p;
+      rpeer = (rank - r + p) % p;
+      rbuf = (char *)recvbuf + displs[rpeer] * rcvext;
 
-    res = NBC_Sched_recv (rbuf, false, recvcounts[rpeer], recvtype, rpeer, schedule, false);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-      OBJ_RELEASE(schedule);
-      return res;
+      res = NBC_Sched_recv (rbuf, false, recvcounts[rpeer], recvtype, rpeer, schedule, false);
+      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+        OBJ_RELEASE(schedule);
+        return res;
+      }
+
+      /* send to rank r - not from the sendbuf to optimize MPI_IN_PLACE */
+      res = NBC_Sched_send (sbuf, false, recvcounts[rank], recvtype, speer, schedule, false);
+      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+        OBJ_RELEASE(schedule);
+        return res;
+      }
     }
 
-    /* send to rank r - not from the sendbuf to optimize MPI_IN_PLACE */
-    res = NBC_Sched_send (sbuf, false, recvcounts[rank], recvtype, speer, schedule, false);
+    res = NBC_Sched_commit (schedule);
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
       OBJ_RELEASE(schedule);
       return res;
     }
   }
 
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    return res;
-  }
-
   res = NBC_Schedule_request (schedule, comm, libnbc_module, persistent, request, NULL);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
     return res;
   }
 
@@ -145,6 +150,7 @@ static int nbc_allgatherv_inter_init(const void* sendbuf, int sendcount, MPI_Dat
   int res, rsize;
   MPI_Aint rcvext;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
   rsize = ompi_comm_remote_size (comm);
@@ -155,43 +161,51 @@ static int nbc_allgatherv_inter_init(const void* sendbuf, int sendcount, MPI_Dat
     return res;
   }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (NULL == schedule) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
-
-  /* do rsize  rounds */
-  for (int r = 0 ; r < rsize ; ++r) {
-    char *rbuf = (char *) recvbuf + displs[r] * rcvext;
+  NBC_Sched_key_init(&key, NBC_ALLGATHERV, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_SCHED_KEY_ADD(&key, sendcount);
+  NBC_Sched_key_add_dtype(&key, sendtype);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_Sched_key_add(&key, recvcounts, rsize * sizeof(int));
+  NBC_Sched_key_add(&key, displs, rsize * sizeof(int));
+  NBC_Sched_key_add_dtype(&key, recvtype);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-    if (recvcounts[r]) {
-      res = NBC_Sched_recv (rbuf, false, recvcounts[r], recvtype, r, schedule, false);
-      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        return res;
+    /* do rsize  rounds */
+    for (int r = 0 ; r < rsize ; ++r) {
+      char *rbuf = (char *) recvbuf + displs[r] * rcvext;
+
+      if (recvcounts[r]) {
+        res = NBC_Sched_recv (rbuf, false, recvcounts[r], recvtype, r, schedule, false);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          return res;
+        }
       }
     }
-  }
 
-  if (sendcount) {
-    for (int r = 0 ; r < rsize ; ++r) {
-      res = NBC_Sched_send (sendbuf, false, sendcount, sendtype, r, schedule, false);
-      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        return res;
+    if (sendcount) {
+      for (int r = 0 ; r < rsize ; ++r) {
+        res = NBC_Sched_send (sendbuf, false, sendcount, sendtype, r, schedule, false);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          return res;
+        }
       }
     }
-  }
 
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    return res;
+    res = NBC_Sched_commit (schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      return res;
+    }
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
     return res;
   }
 
@@ -42,25 +42,6 @@ static inline int allred_sched_redscat_allgather(
     const void *sbuf, void *rbuf, MPI_Op op, char inplace,
     NBC_Schedule *schedule, void *tmpbuf, struct ompi_communicator_t *comm);
 
-#ifdef NBC_CACHE_SCHEDULE
-/* tree comparison function for schedule cache */
-int NBC_Allreduce_args_compare(NBC_Allreduce_args *a, NBC_Allreduce_args *b, void *param) {
-  if ((a->sendbuf == b->sendbuf) &&
-      (a->recvbuf == b->recvbuf) &&
-      (a->count == b->count) &&
-      (a->datatype == b->datatype) &&
-      (a->op == b->op)) {
-    return 0;
-  }
-
-  if( a->sendbuf < b->sendbuf ) {
-    return -1;
-  }
-
-  return 1;
-}
-#endif
-
 static int nbc_allreduce_init(const void* sendbuf, void* recvbuf, int count, MPI_Datatype datatype, MPI_Op op,
                               struct ompi_communicator_t *comm, ompi_request_t ** request,
                               struct mca_coll_base_module_2_3_0_t *module, bool persistent)
@@ -68,10 +49,8 @@ static int nbc_allreduce_init(const void* sendbuf, void* recvbuf, int count, MPI
   int rank, p, res;
   ptrdiff_t ext, lb;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   size_t size;
-#ifdef NBC_CACHE_SCHEDULE
-  NBC_Allreduce_args *args, *found, search;
-#endif
   enum { NBC_ARED_BINOMIAL, NBC_ARED_RING, NBC_ARED_REDSCAT_ALLGATHER, NBC_ARED_RDBL } alg;
   char inplace;
   void *tmpbuf = NULL;
@@ -106,12 +85,6 @@ static int nbc_allreduce_init(const void* sendbuf, void* recvbuf, int count, MPI
     return nbc_get_noop_request(persistent, request);
   }
 
-  span = opal_datatype_span(&datatype->super, count, &gap);
-  tmpbuf = malloc (span);
-  if (OPAL_UNLIKELY(NULL == tmpbuf)) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
-
   /* algorithm selection */
   int nprocs_pof2 = opal_next_poweroftwo(p) >> 1;
   if (libnbc_iallreduce_algorithm == 0) {
@@ -134,19 +107,23 @@ static int nbc_allreduce_init(const void* sendbuf, void* recvbuf, int count, MPI
     else
       alg = NBC_ARED_RING;
   }
-#ifdef NBC_CACHE_SCHEDULE
-  /* search schedule in communicator specific tree */
-  search.sendbuf = sendbuf;
-  search.recvbuf = recvbuf;
-  search.count = count;
-  search.datatype = datatype;
-  search.op = op;
-  found = (NBC_Allreduce_args *) hb_tree_search ((hb_tree *) libnbc_module->NBC_Dict[NBC_ALLREDUCE], &search);
-  if (NULL == found) {
-#endif
-    schedule = OBJ_NEW(NBC_Schedule);
-    if (NULL == schedule) {
-      free(tmpbuf);
+
+  NBC_Sched_key_init(&key, NBC_ALLREDUCE, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_SCHED_KEY_ADD(&key, count);
+  NBC_Sched_key_add_dtype(&key, datatype);
+  NBC_Sched_key_add_op(&key, op);
+  NBC_SCHED_KEY_ADD(&key, alg);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    span = opal_datatype_span(&datatype->super, count, &gap);
+    tmpbuf = malloc (span);
+    if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+      OBJ_RELEASE(schedule);
       return OMPI_ERR_OUT_OF_RESOURCE;
     }
 
@@ -182,42 +159,10 @@ static int nbc_allreduce_init(const void* sendbuf, void* recvbuf, int count, MPI
       free(tmpbuf);
       return res;
     }
-
-#ifdef NBC_CACHE_SCHEDULE
-    /* save schedule to tree */
-    args = (NBC_Allreduce_args *) malloc (sizeof(args));
-    if (NULL != args) {
-      args->sendbuf = sendbuf;
-      args->recvbuf = recvbuf;
-      args->count = count;
-      args->datatype = datatype;
-      args->op = op;
-      args->schedule = schedule;
-      res = hb_tree_insert ((hb_tree *) libnbc_module->NBC_Dict[NBC_ALLREDUCE], args, args, 0);
-      if (0 == res) {
-        OBJ_RETAIN(schedule);
-
-        /* increase number of elements for A2A */
-        if (++libnbc_module->NBC_Dict_size[NBC_ALLREDUCE] > NBC_SCHED_DICT_UPPER) {
-          NBC_SchedCache_dictwipe ((hb_tree *) libnbc_module->NBC_Dict[NBC_ALLREDUCE],
-                                   &libnbc_module->NBC_Dict_size[NBC_ALLREDUCE]);
-        }
-      } else {
-        NBC_Error("error in dict_insert() (%i)", res);
-        free (args);
-      }
-    }
-  } else {
-    /* found schedule */
-    schedule = found->schedule;
-    OBJ_RETAIN(schedule);
   }
-#endif
 
   res = NBC_Schedule_request (schedule, comm, libnbc_module, persistent, request, tmpbuf);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
     return res;
   }
 
@@ -251,6 +196,7 @@ static int nbc_allreduce_inter_init(const void* sendbuf, void* recvbuf, int coun
   size_t size;
   MPI_Aint ext;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   void *tmpbuf = NULL;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
   ptrdiff_t span, gap;
@@ -270,37 +216,42 @@ static int nbc_allreduce_inter_init(const void* sendbuf, void* recvbuf, int coun
     return res;
   }
 
-  span = opal_datatype_span(&datatype->super, count, &gap);
-  tmpbuf = malloc (span);
-  if (OPAL_UNLIKELY(NULL == tmpbuf)) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+  NBC_Sched_key_init(&key, NBC_ALLREDUCE, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_SCHED_KEY_ADD(&key, count);
+  NBC_Sched_key_add_dtype(&key, datatype);
+  NBC_Sched_key_add_op(&key, op);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    free(tmpbuf);
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+    span = opal_datatype_span(&datatype->super, count, &gap);
+    tmpbuf = malloc (span);
+    if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+      OBJ_RELEASE(schedule);
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  res = allred_sched_linear (rank, rsize, sendbuf, recvbuf, count, datatype, gap, op,
-                             ext, size, schedule, tmpbuf);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
-  }
+    res = allred_sched_linear (rank, rsize, sendbuf, recvbuf, count, datatype, gap, op,
+                               ext, size, schedule, tmpbuf);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      free(tmpbuf);
+      return res;
+    }
 
-  res = NBC_Sched_commit(schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
+    res = NBC_Sched_commit(schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      free(tmpbuf);
+      return res;
+    }
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, tmpbuf);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
     return res;
   }
 
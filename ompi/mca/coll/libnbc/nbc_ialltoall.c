@@ -33,26 +33,6 @@ static inline int a2a_sched_diss(int rank, int p, MPI_Aint sndext, MPI_Aint rcve
 static inline int a2a_sched_inplace(int rank, int p, NBC_Schedule* schedule, void* buf, int count,
                                    MPI_Datatype type, MPI_Aint ext, ptrdiff_t gap, MPI_Comm comm);
 
-#ifdef NBC_CACHE_SCHEDULE
-/* tree comparison function for schedule cache */
-int NBC_Alltoall_args_compare(NBC_Alltoall_args *a, NBC_Alltoall_args *b, void *param) {
-  if ((a->sendbuf == b->sendbuf) &&
-      (a->sendcount == b->sendcount) &&
-      (a->sendtype == b->sendtype) &&
-      (a->recvbuf == b->recvbuf) &&
-      (a->recvcount == b->recvcount) &&
-      (a->recvtype == b->recvtype)) {
-    return 0;
-  }
-
-  if( a->sendbuf < b->sendbuf ) {
-    return -1;
-  }
-
-  return 1;
-}
-#endif
-
 /* simple linear MPI_Ialltoall the (simple) algorithm just sends to all nodes */
 static int nbc_alltoall_init(const void* sendbuf, int sendcount, MPI_Datatype sendtype, void* recvbuf, int recvcount,
                              MPI_Datatype recvtype, struct ompi_communicator_t *comm, ompi_request_t ** request,
@@ -63,10 +43,8 @@ static int nbc_alltoall_init(const void* sendbuf, int sendcount, MPI_Datatype se
   size_t a2asize, sndsize;
   NBC_Schedule *schedule;
   MPI_Aint rcvext, sndext;
-#ifdef NBC_CACHE_SCHEDULE
-  NBC_Alltoall_args *args, *found, search;
-#endif
   char *rbuf, *sbuf, inplace;
+  NBC_Sched_key key;
   enum {NBC_A2A_LINEAR, NBC_A2A_PAIRWISE, NBC_A2A_DISS, NBC_A2A_INPLACE} alg;
   void *tmpbuf = NULL;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
@@ -111,91 +89,97 @@ static int nbc_alltoall_init(const void* sendbuf, int sendcount, MPI_Datatype se
   } else
     alg = NBC_A2A_LINEAR; /*NBC_A2A_PAIRWISE;*/
 
-  /* allocate temp buffer if we need one */
-  if (alg == NBC_A2A_INPLACE) {
-    span = opal_datatype_span(&recvtype->super, recvcount, &gap);
-    tmpbuf = malloc(span);
-    if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+  NBC_Sched_key_init(&key, NBC_ALLTOALL, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  if (!inplace) {
+    NBC_SCHED_KEY_ADD(&key, sendcount);
+    NBC_Sched_key_add_dtype(&key, sendtype);
+  }
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_SCHED_KEY_ADD(&key, recvcount);
+  NBC_Sched_key_add_dtype(&key, recvtype);
+  NBC_SCHED_KEY_ADD(&key, alg);
+  if (NBC_A2A_DISS == alg) {
+    /* the temporary buffer is filled here at every call */
+    key.valid = false;
+  }
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
       return OMPI_ERR_OUT_OF_RESOURCE;
     }
-  } else if (alg == NBC_A2A_DISS) {
-    /* persistent operation is not supported currently for this algorithm */
-    assert(! persistent);
 
-    if(NBC_Type_intrinsic(sendtype)) {
-      datasize = sndext * sendcount;
-    } else {
-      res = ompi_datatype_pack_external_size("external32", sendcount, sendtype, &datasize);
-      if (MPI_SUCCESS != res) {
-        NBC_Error("MPI Error in ompi_datatype_pack_external_size() (%i)", res);
-        return res;
+    /* allocate temp buffer if we need one */
+    if (alg == NBC_A2A_INPLACE) {
+      span = opal_datatype_span(&recvtype->super, recvcount, &gap);
+      tmpbuf = malloc(span);
+      if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+        OBJ_RELEASE(schedule);
+        return OMPI_ERR_OUT_OF_RESOURCE;
       }
-    }
+    } else if (alg == NBC_A2A_DISS) {
+      /* persistent operation is not supported currently for this algorithm */
+      assert(! persistent);
 
-    /* allocate temporary buffers */
-    if ((p & 1) == 0) {
-      tmpbuf = malloc (datasize * p * 2);
-    } else {
-      /* we cannot divide p by two, so alloc more to be safe ... */
-      tmpbuf = malloc (datasize * (p / 2 + 1) * 2 * 2);
-    }
+      if(NBC_Type_intrinsic(sendtype)) {
+        datasize = sndext * sendcount;
+      } else {
+        res = ompi_datatype_pack_external_size("external32", sendcount, sendtype, &datasize);
+        if (MPI_SUCCESS != res) {
+          NBC_Error("MPI Error in ompi_datatype_pack_external_size() (%i)", res);
+          OBJ_RELEASE(schedule);
+          return res;
+        }
+      }
 
-    if (OPAL_UNLIKELY(NULL == tmpbuf)) {
-      return OMPI_ERR_OUT_OF_RESOURCE;
-    }
+      /* allocate temporary buffers */
+      if ((p & 1) == 0) {
+        tmpbuf = malloc (datasize * p * 2);
+      } else {
+        /* we cannot divide p by two, so alloc more to be safe ... */
+        tmpbuf = malloc (datasize * (p / 2 + 1) * 2 * 2);
+      }
 
-    /* phase 1 - rotate n data blocks upwards into the tmpbuffer */
+      if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+        OBJ_RELEASE(schedule);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+      }
+
+      /* phase 1 - rotate n data blocks upwards into the tmpbuffer */
 #if OPAL_CUDA_SUPPORT
-    if (NBC_Type_intrinsic(sendtype) && !(opal_cuda_check_bufs((char *)sendbuf, (char *)recvbuf))) {
+      if (NBC_Type_intrinsic(sendtype) && !(opal_cuda_check_bufs((char *)sendbuf, (char *)recvbuf))) {
 #else
-    if (NBC_Type_intrinsic(sendtype)) {
+      if (NBC_Type_intrinsic(sendtype)) {
 #endif /* OPAL_CUDA_SUPPORT */
-      /* contiguous - just copy (1st copy) */
-      memcpy (tmpbuf, (char *) sendbuf + datasize * rank, datasize * (p - rank));
-      if (rank != 0) {
-        memcpy ((char *) tmpbuf + datasize * (p - rank), sendbuf, datasize * rank);
-      }
-    } else {
-      MPI_Aint pos=0;
-
-      /* non-contiguous - pack */
-      res = ompi_datatype_pack_external ("external32", (char *) sendbuf + (intptr_t)rank * (intptr_t)sendcount * sndext, (intptr_t)(p - rank) * (intptr_t)sendcount, sendtype, tmpbuf,
-                      (intptr_t)(p - rank) * datasize, &pos);
-      if (OPAL_UNLIKELY(MPI_SUCCESS != res)) {
-        NBC_Error("MPI Error in ompi_datatype_pack_external() (%i)", res);
-        free(tmpbuf);
-        return res;
-      }
+        /* contiguous - just copy (1st copy) */
+        memcpy (tmpbuf, (char *) sendbuf + datasize * rank, datasize * (p - rank));
+        if (rank != 0) {
+          memcpy ((char *) tmpbuf + datasize * (p - rank), sendbuf, datasize * rank);
+        }
+      } else {
+        MPI_Aint pos=0;
 
-      if (rank != 0) {
-        pos = 0;
-        res = ompi_datatype_pack_external("external32", sendbuf, (intptr_t)rank * (intptr_t)sendcount, sendtype, (char *) tmpbuf + datasize * (intptr_t)(p - rank),
-                       rank * datasize, &pos);
+        /* non-contiguous - pack */
+        res = ompi_datatype_pack_external ("external32", (char *) sendbuf + (intptr_t)rank * (intptr_t)sendcount * sndext, (intptr_t)(p - rank) * (intptr_t)sendcount, sendtype, tmpbuf,
+                        (intptr_t)(p - rank) * datasize, &pos);
         if (OPAL_UNLIKELY(MPI_SUCCESS != res)) {
           NBC_Error("MPI Error in ompi_datatype_pack_external() (%i)", res);
+          OBJ_RELEASE(schedule);
           free(tmpbuf);
           return res;
         }
-      }
-    }
-  }
 
-#ifdef NBC_CACHE_SCHEDULE
-  /* search schedule in communicator specific tree */
-  search.sendbuf = sendbuf;
-  search.sendcount = sendcount;
-  search.sendtype = sendtype;
-  search.recvbuf = recvbuf;
-  search.recvcount = recvcount;
-  search.recvtype = recvtype;
-  found = (NBC_Alltoall_args *) hb_tree_search ((hb_tree *) libnbc_module->NBC_Dict[NBC_ALLTOALL], &search);
-  if (NULL == found) {
-#endif
-    /* not found - generate new schedule */
-    schedule = OBJ_NEW(NBC_Schedule);
-    if (OPAL_UNLIKELY(NULL == schedule)) {
-      free(tmpbuf);
-      return OMPI_ERR_OUT_OF_RESOURCE;
+        if (rank != 0) {
+          pos = 0;
+          res = ompi_datatype_pack_external("external32", sendbuf, (intptr_t)rank * (intptr_t)sendcount, sendtype, (char *) tmpbuf + datasize * (intptr_t)(p - rank),
+                         rank * datasize, &pos);
+          if (OPAL_UNLIKELY(MPI_SUCCESS != res)) {
+            NBC_Error("MPI Error in ompi_datatype_pack_external() (%i)", res);
+            OBJ_RELEASE(schedule);
+            free(tmpbuf);
+            return res;
+          }
+        }
+      }
     }
 
     if (!inplace) {
@@ -238,43 +222,10 @@ static int nbc_alltoall_init(const void* sendbuf, int sendcount, MPI_Datatype se
       free(tmpbuf);
       return res;
     }
-
-#ifdef NBC_CACHE_SCHEDULE
-    /* save schedule to tree */
-    args = (NBC_Alltoall_args *) malloc (sizeof (args));
-    if (NULL != args) {
-      args->sendbuf = sendbuf;
-      args->sendcount = sendcount;
-      args->sendtype = sendtype;
-      args->recvbuf = recvbuf;
-      args->recvcount = recvcount;
-      args->recvtype = recvtype;
-      args->schedule = schedule;
-      res = hb_tree_insert ((hb_tree *) libnbc_module->NBC_Dict[NBC_ALLTOALL], args, args, 0);
-      if (0 == res) {
-        OBJ_RETAIN(schedule);
-
-        /* increase number of elements for A2A */
-        if (++libnbc_module->NBC_Dict_size[NBC_ALLTOALL] > NBC_SCHED_DICT_UPPER) {
-          NBC_SchedCache_dictwipe ((hb_tree *) libnbc_module->NBC_Dict[NBC_ALLTOALL],
-                                   &libnbc_module->NBC_Dict_size[NBC_ALLTOALL]);
-        }
-      } else {
-        NBC_Error("error in dict_insert() (%i)", res);
-        free (args);
-      }
-    }
-  } else {
-    /* found schedule */
-    schedule = found->schedule;
-    OBJ_RETAIN(schedule);
   }
-#endif
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, tmpbuf);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
     return res;
   }
 
@@ -307,6 +258,7 @@ static int nbc_alltoall_inter_init (const void* sendbuf, int sendcount, MPI_Data
   int res, rsize;
   MPI_Aint sndext, rcvext;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   char *rbuf, *sbuf;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -324,41 +276,48 @@ static int nbc_alltoall_inter_init (const void* sendbuf, int sendcount, MPI_Data
     return res;
   }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+  NBC_Sched_key_init(&key, NBC_ALLTOALL, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_SCHED_KEY_ADD(&key, sendcount);
+  NBC_Sched_key_add_dtype(&key, sendtype);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_SCHED_KEY_ADD(&key, recvcount);
+  NBC_Sched_key_add_dtype(&key, recvtype);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  for (int i = 0; i < rsize; i++) {
-    /* post all sends */
-    sbuf = (char *) sendbuf + i * sendcount * sndext;
-    res = NBC_Sched_send (sbuf, false, sendcount, sendtype, i, schedule, false);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-      break;
+    for (int i = 0; i < rsize; i++) {
+      /* post all sends */
+      sbuf = (char *) sendbuf + i * sendcount * sndext;
+      res = NBC_Sched_send (sbuf, false, sendcount, sendtype, i, schedule, false);
+      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+        break;
+      }
+
+      /* post all receives */
+      rbuf = (char *) recvbuf + i * recvcount * rcvext;
+      res = NBC_Sched_recv (rbuf, false, recvcount, recvtype, i, schedule, false);
+      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+        break;
+      }
     }
 
-    /* post all receives */
-    rbuf = (char *) recvbuf + i * recvcount * rcvext;
-    res = NBC_Sched_recv (rbuf, false, recvcount, recvtype, i, schedule, false);
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-      break;
+      OBJ_RELEASE(schedule);
+      return res;
     }
-  }
 
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    return res;
-  }
-
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    return res;
+    res = NBC_Sched_commit (schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      return res;
+    }
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
     return res;
   }
 
@@ -36,10 +36,6 @@ static inline int a2av_sched_inplace(int rank, int p, NBC_Schedule *schedule,
                                     void *buf, const int *counts, const int *displs,
                                     MPI_Aint ext, MPI_Datatype type, ptrdiff_t gap);
 
-/* an alltoallv schedule can not be cached easily because the contents
- * ot the recvcounts array may change, so a comparison of the address
- * would not be sufficient ... we simply do not cache it */
-
 /* simple linear Alltoallv */
 static int nbc_alltoallv_init(const void* sendbuf, const int *sendcounts, const int *sdispls,
                               MPI_Datatype sendtype, void* recvbuf, const int *recvcounts, const int *rdispls,
@@ -49,6 +45,7 @@ static int nbc_alltoallv_init(const void* sendbuf, const int *sendcounts, const
   int rank, p, res;
   MPI_Aint sndext, rcvext;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   char *rbuf, *sbuf, inplace;
   ptrdiff_t gap = 0, span;
   void * tmpbuf = NULL;
@@ -77,10 +74,6 @@ static int nbc_alltoallv_init(const void* sendbuf, const int *sendcounts, const
     if (OPAL_UNLIKELY(0 == span)) {
       return nbc_get_noop_request(persistent, request);
     }
-    tmpbuf = malloc(span);
-    if (OPAL_UNLIKELY(NULL == tmpbuf)) {
-      return OMPI_ERR_OUT_OF_RESOURCE;
-    }
     sendcounts = recvcounts;
     sdispls = rdispls;
   } else {
@@ -91,49 +84,66 @@ static int nbc_alltoallv_init(const void* sendbuf, const int *sendcounts, const
     }
   }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    free(tmpbuf);
-    return OMPI_ERR_OUT_OF_RESOURCE;
+  NBC_Sched_key_init(&key, NBC_ALLTOALLV, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  if (!inplace) {
+    NBC_Sched_key_add(&key, sendcounts, p * sizeof(int));
+    NBC_Sched_key_add(&key, sdispls, p * sizeof(int));
+    NBC_Sched_key_add_dtype(&key, sendtype);
   }
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_Sched_key_add(&key, recvcounts, p * sizeof(int));
+  NBC_Sched_key_add(&key, rdispls, p * sizeof(int));
+  NBC_Sched_key_add_dtype(&key, recvtype);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    if (inplace) {
+      tmpbuf = malloc(span);
+      if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+        OBJ_RELEASE(schedule);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+      }
+    }
 
 
-  if (!inplace && sendcounts[rank] != 0) {
-    rbuf = (char *) recvbuf + rdispls[rank] * rcvext;
-    sbuf = (char *) sendbuf + sdispls[rank] * sndext;
-    res = NBC_Sched_copy (sbuf, false, sendcounts[rank], sendtype,
-                          rbuf, false, recvcounts[rank], recvtype, schedule, false);
+    if (!inplace && sendcounts[rank] != 0) {
+      rbuf = (char *) recvbuf + rdispls[rank] * rcvext;
+      sbuf = (char *) sendbuf + sdispls[rank] * sndext;
+      res = NBC_Sched_copy (sbuf, false, sendcounts[rank], sendtype,
+                            rbuf, false, recvcounts[rank], recvtype, schedule, false);
+      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+        OBJ_RELEASE(schedule);
+        return res;
+      }
+    }
+
+    if (inplace) {
+      res = a2av_sched_inplace(rank, p, schedule, recvbuf, recvcounts,
+                                   rdispls, rcvext, recvtype, gap);
+    } else {
+      res = a2av_sched_linear(rank, p, schedule,
+                              sendbuf, sendcounts, sdispls, sndext, sendtype,
+                              recvbuf, recvcounts, rdispls, rcvext, recvtype);
+    }
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
       OBJ_RELEASE(schedule);
+      free(tmpbuf);
       return res;
     }
-  }
-
-  if (inplace) {
-    res = a2av_sched_inplace(rank, p, schedule, recvbuf, recvcounts,
-                                 rdispls, rcvext, recvtype, gap);
-  } else {
-    res = a2av_sched_linear(rank, p, schedule,
-                            sendbuf, sendcounts, sdispls, sndext, sendtype,
-                            recvbuf, recvcounts, rdispls, rcvext, recvtype);
-  }
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
-  }
 
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
+    res = NBC_Sched_commit (schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      free(tmpbuf);
+      return res;
+    }
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, tmpbuf);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
     return res;
   }
 
@@ -170,6 +180,7 @@ static int nbc_alltoallv_inter_init (const void* sendbuf, const int *sendcounts,
   int res, rsize;
   MPI_Aint sndext, rcvext;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
 
@@ -187,41 +198,50 @@ static int nbc_alltoallv_inter_init (const void* sendbuf, const int *sendcounts,
 
   rsize = ompi_comm_remote_size (comm);
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+  NBC_Sched_key_init(&key, NBC_ALLTOALLV, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_Sched_key_add(&key, sendcounts, rsize * sizeof(int));
+  NBC_Sched_key_add(&key, sdispls, rsize * sizeof(int));
+  NBC_Sched_key_add_dtype(&key, sendtype);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_Sched_key_add(&key, recvcounts, rsize * sizeof(int));
+  NBC_Sched_key_add(&key, rdispls, rsize * sizeof(int));
+  NBC_Sched_key_add_dtype(&key, recvtype);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  for (int i = 0; i < rsize; i++) {
-    /* post all sends */
-    if (sendcounts[i] != 0) {
-      char *sbuf = (char *) sendbuf + sdispls[i] * sndext;
-      res = NBC_Sched_send (sbuf, false, sendcounts[i], sendtype, i, schedule, false);
-      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        return res;
+    for (int i = 0; i < rsize; i++) {
+      /* post all sends */
+      if (sendcounts[i] != 0) {
+        char *sbuf = (char *) sendbuf + sdispls[i] * sndext;
+        res = NBC_Sched_send (sbuf, false, sendcounts[i], sendtype, i, schedule, false);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          return res;
+        }
       }
-    }
-    /* post all receives */
-    if (recvcounts[i] != 0) {
-      char *rbuf = (char *) recvbuf + rdispls[i] * rcvext;
-      res = NBC_Sched_recv (rbuf, false, recvcounts[i], recvtype, i, schedule, false);
-      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        return res;
+      /* post all receives */
+      if (recvcounts[i] != 0) {
+        char *rbuf = (char *) recvbuf + rdispls[i] * rcvext;
+        res = NBC_Sched_recv (rbuf, false, recvcounts[i], recvtype, i, schedule, false);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          return res;
+        }
       }
     }
-  }
 
-  res = NBC_Sched_commit(schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    return res;
+    res = NBC_Sched_commit(schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      return res;
+    }
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
     return res;
   }
 
@@ -36,10 +36,6 @@ static inline int a2aw_sched_inplace(int rank, int p, NBC_Schedule *schedule,
                                     void *buf, const int *counts, const int *displs,
                                     struct ompi_datatype_t * const * types);
 
-/* an alltoallw schedule can not be cached easily because the contents
- * ot the recvcounts array may change, so a comparison of the address
- * would not be sufficient ... we simply do not cache it */
-
 /* simple linear Alltoallw */
 static int nbc_alltoallw_init(const void* sendbuf, const int *sendcounts, const int *sdispls,
                               struct ompi_datatype_t * const *sendtypes, void* recvbuf, const int *recvcounts, const int *rdispls,
@@ -48,6 +44,7 @@ static int nbc_alltoallw_init(const void* sendbuf, const int *sendcounts, const
 {
   int rank, p, res;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   char *rbuf, *sbuf, inplace;
   ptrdiff_t span=0;
   void *tmpbuf = NULL;
@@ -70,56 +67,74 @@ static int nbc_alltoallw_init(const void* sendbuf, const int *sendcounts, const
     if (OPAL_UNLIKELY(0 == span)) {
       return nbc_get_noop_request(persistent, request);
     }
-    tmpbuf = malloc(span);
-    if (OPAL_UNLIKELY(NULL == tmpbuf)) {
-      return OMPI_ERR_OUT_OF_RESOURCE;
-    }
     sendcounts = recvcounts;
     sdispls = rdispls;
     sendtypes = recvtypes;
   }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    free(tmpbuf);
-    return OMPI_ERR_OUT_OF_RESOURCE;
+  NBC_Sched_key_init(&key, NBC_ALLTOALLW, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  if (!inplace) {
+    NBC_Sched_key_add(&key, sendcounts, p * sizeof(int));
+    NBC_Sched_key_add(&key, sdispls, p * sizeof(int));
+    for (int i = 0 ; i < p ; ++i) {
+      NBC_Sched_key_add_dtype(&key, sendtypes[i]);
+    }
   }
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_Sched_key_add(&key, recvcounts, p * sizeof(int));
+  NBC_Sched_key_add(&key, rdispls, p * sizeof(int));
+  for (int i = 0 ; i < p ; ++i) {
+    NBC_Sched_key_add_dtype(&key, recvtypes[i]);
+  }
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  if (!inplace && sendcounts[rank] != 0) {
-    rbuf = (char *) recvbuf + rdispls[rank];
-    sbuf = (char *) sendbuf + sdispls[rank];
-    res = NBC_Sched_copy(sbuf, false, sendcounts[rank], sendtypes[rank],
-                         rbuf, false, recvcounts[rank], recvtypes[rank], schedule, false);
+    if (inplace) {
+      tmpbuf = malloc(span);
+      if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+        OBJ_RELEASE(schedule);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+      }
+    }
+
+    if (!inplace && sendcounts[rank] != 0) {
+      rbuf = (char *) recvbuf + rdispls[rank];
+      sbuf = (char *) sendbuf + sdispls[rank];
+      res = NBC_Sched_copy(sbuf, false, sendcounts[rank], sendtypes[rank],
+                           rbuf, false, recvcounts[rank], recvtypes[rank], schedule, false);
+      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+        OBJ_RELEASE(schedule);
+        return res;
+      }
+    }
+
+    if (inplace) {
+      res = a2aw_sched_inplace(rank, p, schedule, recvbuf,
+                                   recvcounts, rdispls, recvtypes);
+    } else {
+      res = a2aw_sched_linear(rank, p, schedule,
+                              sendbuf, sendcounts, sdispls, sendtypes,
+                              recvbuf, recvcounts, rdispls, recvtypes);
+    }
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      free(tmpbuf);
       return res;
     }
-  }
-
-  if (inplace) {
-    res = a2aw_sched_inplace(rank, p, schedule, recvbuf,
-                                 recvcounts, rdispls, recvtypes);
-  } else {
-    res = a2aw_sched_linear(rank, p, schedule,
-                            sendbuf, sendcounts, sdispls, sendtypes,
-                            recvbuf, recvcounts, rdispls, recvtypes);
-  }
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
-  }
 
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
+    res = NBC_Sched_commit (schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      free(tmpbuf);
+      return res;
+    }
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, tmpbuf);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
     return res;
   }
 
@@ -155,46 +170,58 @@ static int nbc_alltoallw_inter_init (const void* sendbuf, const int *sendcounts,
 {
   int res, rsize;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   char *rbuf, *sbuf;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
   rsize = ompi_comm_remote_size (comm);
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
+  NBC_Sched_key_init(&key, NBC_ALLTOALLW, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_Sched_key_add(&key, sendcounts, rsize * sizeof(int));
+  NBC_Sched_key_add(&key, sdispls, rsize * sizeof(int));
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_Sched_key_add(&key, recvcounts, rsize * sizeof(int));
+  NBC_Sched_key_add(&key, rdispls, rsize * sizeof(int));
+  for (int i = 0 ; i < rsize ; ++i) {
+    NBC_Sched_key_add_dtype(&key, sendtypes[i]);
+    NBC_Sched_key_add_dtype(&key, recvtypes[i]);
   }
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  for (int i = 0 ; i < rsize ; ++i) {
-    /* post all sends */
-    if (sendcounts[i] != 0) {
-      sbuf = (char *) sendbuf + sdispls[i];
-      res = NBC_Sched_send (sbuf, false, sendcounts[i], sendtypes[i], i, schedule, false);
-      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        return res;
+    for (int i = 0 ; i < rsize ; ++i) {
+      /* post all sends */
+      if (sendcounts[i] != 0) {
+        sbuf = (char *) sendbuf + sdispls[i];
+        res = NBC_Sched_send (sbuf, false, sendcounts[i], sendtypes[i], i, schedule, false);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          return res;
+        }
       }
-    }
-    /* post all receives */
-    if (recvcounts[i] != 0) {
-      rbuf = (char *) recvbuf + rdispls[i];
-      res = NBC_Sched_recv (rbuf, false, recvcounts[i], recvtypes[i], i, schedule, false);
-      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        return res;
+      /* post all receives */
+      if (recvcounts[i] != 0) {
+        rbuf = (char *) recvbuf + rdispls[i];
+        res = NBC_Sched_recv (rbuf, false, recvcounts[i], recvtypes[i], i, schedule, false);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          return res;
+        }
       }
     }
-  }
 
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    return res;
+    res = NBC_Sched_commit (schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      return res;
+    }
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
     return res;
   }
 
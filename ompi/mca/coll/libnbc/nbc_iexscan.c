@@ -32,30 +32,12 @@ static inline int exscan_sched_recursivedoubling(
     int count, MPI_Datatype datatype,  MPI_Op op, char inplace,
     NBC_Schedule *schedule, void *tmpbuf1, void *tmpbuf2);
 
-#ifdef NBC_CACHE_SCHEDULE
-/* tree comparison function for schedule cache */
-int NBC_Scan_args_compare(NBC_Scan_args *a, NBC_Scan_args *b, void *param) {
-    if ((a->sendbuf == b->sendbuf) &&
-        (a->recvbuf == b->recvbuf) &&
-        (a->count == b->count) &&
-        (a->datatype == b->datatype) &&
-        (a->op == b->op) ) {
-        return 0;
-    }
-
-    if( a->sendbuf < b->sendbuf ) {
-        return -1;
-    }
-
-    return 1;
-}
-#endif
-
 static int nbc_exscan_init(const void* sendbuf, void* recvbuf, int count, MPI_Datatype datatype, MPI_Op op,
                            struct ompi_communicator_t *comm, ompi_request_t ** request,
                            struct mca_coll_base_module_2_3_0_t *module, bool persistent) {
     int rank, p, res;
     NBC_Schedule *schedule;
+    NBC_Sched_key key;
     char inplace;
     void *tmpbuf = NULL, *tmpbuf1 = NULL, *tmpbuf2 = NULL;
     enum { NBC_EXSCAN_LINEAR, NBC_EXSCAN_RDBL } alg;
@@ -71,94 +53,59 @@ static int nbc_exscan_init(const void* sendbuf, void* recvbuf, int count, MPI_Da
         return nbc_get_noop_request(persistent, request);
     }
 
-    span = opal_datatype_span(&datatype->super, count, &gap);
     if (libnbc_iexscan_algorithm == 2) {
         alg = NBC_EXSCAN_RDBL;
-        ptrdiff_t span_align = OPAL_ALIGN(span, datatype->super.align, ptrdiff_t);
-        tmpbuf = malloc(span_align + span);
-        if (NULL == tmpbuf) { return OMPI_ERR_OUT_OF_RESOURCE; }
-        tmpbuf1 = (void *)(-gap);
-        tmpbuf2 = (char *)(span_align) - gap;
     } else {
         alg = NBC_EXSCAN_LINEAR;
-        if (rank > 0) {
-            tmpbuf = malloc(span);
-            if (NULL == tmpbuf) { return OMPI_ERR_OUT_OF_RESOURCE; }
-        }
-    }
-
-#ifdef NBC_CACHE_SCHEDULE
-    NBC_Scan_args *args, *found, search;
-    /* search schedule in communicator specific tree */
-    search.sendbuf = sendbuf;
-    search.recvbuf = recvbuf;
-    search.count = count;
-    search.datatype = datatype;
-    search.op = op;
-    found = (NBC_Scan_args *) hb_tree_search ((hb_tree *) libnbc_module->NBC_Dict[NBC_EXSCAN], &search);
-    if (NULL == found) {
-#endif
-    schedule = OBJ_NEW(NBC_Schedule);
-    if (OPAL_UNLIKELY(NULL == schedule)) {
-        free(tmpbuf);
-        return OMPI_ERR_OUT_OF_RESOURCE;
     }
 
-    if (alg == NBC_EXSCAN_LINEAR) {
-        res = exscan_sched_linear(rank, p, sendbuf, recvbuf, count, datatype,
-                                  op, inplace, schedule, tmpbuf);
-    } else {
-        res = exscan_sched_recursivedoubling(rank, p, sendbuf, recvbuf, count,
-                                             datatype, op, inplace, schedule, tmpbuf1, tmpbuf2);
-    }
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        free(tmpbuf);
-        return res;
-    }
+    NBC_Sched_key_init(&key, NBC_EXSCAN, persistent);
+    NBC_SCHED_KEY_ADD(&key, sendbuf);
+    NBC_SCHED_KEY_ADD(&key, recvbuf);
+    NBC_SCHED_KEY_ADD(&key, count);
+    NBC_Sched_key_add_dtype(&key, datatype);
+    NBC_Sched_key_add_op(&key, op);
+    NBC_SCHED_KEY_ADD(&key, alg);
+    if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+        if (OPAL_UNLIKELY(NULL == schedule)) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
 
-    res = NBC_Sched_commit(schedule);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-       OBJ_RELEASE(schedule);
-       free(tmpbuf);
-       return res;
-    }
+        span = opal_datatype_span(&datatype->super, count, &gap);
+        if (alg == NBC_EXSCAN_RDBL) {
+            ptrdiff_t span_align = OPAL_ALIGN(span, datatype->super.align, ptrdiff_t);
+            tmpbuf = malloc(span_align + span);
+            if (NULL == tmpbuf) { OBJ_RELEASE(schedule); return OMPI_ERR_OUT_OF_RESOURCE; }
+            tmpbuf1 = (void *)(-gap);
+            tmpbuf2 = (char *)(span_align) - gap;
+        } else if (rank > 0) {
+            tmpbuf = malloc(span);
+            if (NULL == tmpbuf) { OBJ_RELEASE(schedule); return OMPI_ERR_OUT_OF_RESOURCE; }
+        }
 
-#ifdef NBC_CACHE_SCHEDULE
-        /* save schedule to tree */
-        args = (NBC_Scan_args *) malloc (sizeof (args));
-        if (NULL != args) {
-            args->sendbuf = sendbuf;
-            args->recvbuf = recvbuf;
-            args->count = count;
-            args->datatype = datatype;
-            args->op = op;
-            args->schedule = schedule;
-            res = hb_tree_insert ((hb_tree *) libnbc_module->NBC_Dict[NBC_EXSCAN], args, args, 0);
-            if (0 == res) {
-                OBJ_RETAIN(schedule);
+        if (alg == NBC_EXSCAN_LINEAR) {
+            res = exscan_sched_linear(rank, p, sendbuf, recvbuf, count, datatype,
+                                      op, inplace, schedule, tmpbuf);
+        } else {
+            res = exscan_sched_recursivedoubling(rank, p, sendbuf, recvbuf, count,
+                                                 datatype, op, inplace, schedule, tmpbuf1, tmpbuf2);
+        }
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+            OBJ_RELEASE(schedule);
+            free(tmpbuf);
+            return res;
+        }
 
-                /* increase number of elements for A2A */
-                if (++libnbc_module->NBC_Dict_size[NBC_EXSCAN] > NBC_SCHED_DICT_UPPER) {
-                    NBC_SchedCache_dictwipe ((hb_tree *) libnbc_module->NBC_Dict[NBC_EXSCAN],
-                                             &libnbc_module->NBC_Dict_size[NBC_EXSCAN]);
-                }
-            } else {
-                NBC_Error("error in dict_insert() (%i)", res);
-                free (args);
-            }
+        res = NBC_Sched_commit(schedule);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+            OBJ_RELEASE(schedule);
+            free(tmpbuf);
+            return res;
         }
-    } else {
-        /* found schedule */
-        schedule = found->schedule;
-        OBJ_RETAIN(schedule);
     }
-#endif
 
     res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, tmpbuf);
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        free(tmpbuf);
         return res;
     }
 
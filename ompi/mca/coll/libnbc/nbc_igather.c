@@ -23,27 +23,6 @@
  */
 #include "nbc_internal.h"
 
-#ifdef NBC_CACHE_SCHEDULE
-/* tree comparison function for schedule cache */
-int NBC_Gather_args_compare(NBC_Gather_args *a, NBC_Gather_args *b, void *param) {
-  if ((a->sendbuf == b->sendbuf) &&
-      (a->sendcount == b->sendcount) &&
-      (a->sendtype == b->sendtype) &&
-      (a->recvbuf == b->recvbuf) &&
-      (a->recvcount == b->recvcount) &&
-      (a->recvtype == b->recvtype) &&
-      (a->root == b->root)) {
-    return 0;
-  }
-
-  if( a->sendbuf < b->sendbuf ) {
-    return -1;
-  }
-
-  return 1;
-}
-#endif
-
 static int nbc_gather_init(const void* sendbuf, int sendcount, MPI_Datatype sendtype, void* recvbuf,
                            int recvcount, MPI_Datatype recvtype, int root,
                            struct ompi_communicator_t *comm, ompi_request_t ** request,
@@ -51,6 +30,7 @@ static int nbc_gather_init(const void* sendbuf, int sendcount, MPI_Datatype send
   int rank, p, res;
   MPI_Aint rcvext = 0;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   char *rbuf, inplace = 0;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -73,22 +53,19 @@ static int nbc_gather_init(const void* sendbuf, int sendcount, MPI_Datatype send
     sendtype = recvtype;
   }
 
-#ifdef NBC_CACHE_SCHEDULE
-  NBC_Gather_args *args, *found, search;
-
-  /* search schedule in communicator specific tree */
-  search.sendbuf = sendbuf;
-  search.sendcount = sendcount;
-  search.sendtype = sendtype;
-  search.recvbuf = recvbuf;
-  search.recvcount = recvcount;
-  search.recvtype = recvtype;
-  search.root = root;
-  found = (NBC_Gather_args *) hb_tree_search ((hb_tree *) libnbc_module->NBC_Dict[NBC_GATHER],
-                                              &search);
-  if (NULL == found) {
-#endif
-    schedule = OBJ_NEW(NBC_Schedule);
+  NBC_Sched_key_init(&key, NBC_GATHER, persistent);
+  NBC_SCHED_KEY_ADD(&key, root);
+  if (!inplace) {
+    NBC_SCHED_KEY_ADD(&key, sendbuf);
+    NBC_SCHED_KEY_ADD(&key, sendcount);
+    NBC_Sched_key_add_dtype(&key, sendtype);
+  }
+  if (rank == root) {
+    NBC_SCHED_KEY_ADD(&key, recvbuf);
+    NBC_SCHED_KEY_ADD(&key, recvcount);
+    NBC_Sched_key_add_dtype(&key, recvtype);
+  }
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
     if (OPAL_UNLIKELY(NULL == schedule)) {
       return OMPI_ERR_OUT_OF_RESOURCE;
     }
@@ -130,43 +107,10 @@ static int nbc_gather_init(const void* sendbuf, int sendcount, MPI_Datatype send
       OBJ_RELEASE(schedule);
       return res;
     }
-
-#ifdef NBC_CACHE_SCHEDULE
-    /* save schedule to tree */
-    args = (NBC_Gather_args *) malloc (sizeof (args));
-    if (NULL != args) {
-      args->sendbuf = sendbuf;
-      args->sendcount = sendcount;
-      args->sendtype = sendtype;
-      args->recvbuf = recvbuf;
-      args->recvcount = recvcount;
-      args->recvtype = recvtype;
-      args->root = root;
-      args->schedule = schedule;
-      res = hb_tree_insert ((hb_tree *) libnbc_module->NBC_Dict[NBC_GATHER], args, args, 0);
-      if (0 == res) {
-        OBJ_RETAIN(schedule);
-
-        /* increase number of elements for A2A */
-        if (++libnbc_module->NBC_Dict_size[NBC_GATHER] > NBC_SCHED_DICT_UPPER) {
-          NBC_SchedCache_dictwipe ((hb_tree *) libnbc_module->NBC_Dict[NBC_GATHER],
-                                   &libnbc_module->NBC_Dict_size[NBC_GATHER]);
-        }
-      } else {
-        NBC_Error("error in dict_insert() (%i)", res);
-        free (args);
-      }
-    }
-  } else {
-    /* found schedule */
-    schedule = found->schedule;
-    OBJ_RETAIN(schedule);
   }
-#endif
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
     return res;
   }
 
@@ -200,6 +144,7 @@ static int nbc_gather_inter_init (const void* sendbuf, int sendcount, MPI_Dataty
     int res, rsize;
     MPI_Aint rcvext = 0;
     NBC_Schedule *schedule;
+    NBC_Sched_key key;
     char *rbuf;
     ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -213,40 +158,52 @@ static int nbc_gather_inter_init (const void* sendbuf, int sendcount, MPI_Dataty
         }
     }
 
-    schedule = OBJ_NEW(NBC_Schedule);
-    if (OPAL_UNLIKELY(NULL == schedule)) {
-      return OMPI_ERR_OUT_OF_RESOURCE;
+    NBC_Sched_key_init(&key, NBC_GATHER, persistent);
+    NBC_SCHED_KEY_ADD(&key, root);
+    if (MPI_ROOT != root && MPI_PROC_NULL != root) {
+        NBC_SCHED_KEY_ADD(&key, sendbuf);
+        NBC_SCHED_KEY_ADD(&key, sendcount);
+        NBC_Sched_key_add_dtype(&key, sendtype);
     }
-
-    /* send to root */
-    if (root != MPI_ROOT && root != MPI_PROC_NULL) {
-        /* send msg to root */
-        res = NBC_Sched_send (sendbuf, false, sendcount, sendtype, root, schedule, false);
-        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-          OBJ_RELEASE(schedule);
-          return res;
-        }
-    } else if (MPI_ROOT == root) {
-        for (int i = 0 ; i < rsize ; ++i) {
-            rbuf = ((char *)recvbuf) + (i * recvcount * rcvext);
-            /* root receives message to the right buffer */
-            res = NBC_Sched_recv (rbuf, false, recvcount, recvtype, i, schedule, false);
-            if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-              OBJ_RELEASE(schedule);
-              return res;
-            }
-        }
+    if (MPI_ROOT == root) {
+        NBC_SCHED_KEY_ADD(&key, recvbuf);
+        NBC_SCHED_KEY_ADD(&key, recvcount);
+        NBC_Sched_key_add_dtype(&key, recvtype);
     }
+    if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
+      if (OPAL_UNLIKELY(NULL == schedule)) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+      }
 
-    res = NBC_Sched_commit (schedule);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-      OBJ_RELEASE(schedule);
-      return res;
+      /* send to root */
+      if (root != MPI_ROOT && root != MPI_PROC_NULL) {
+          /* send msg to root */
+          res = NBC_Sched_send (sendbuf, false, sendcount, sendtype, root, schedule, false);
+          if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+            OBJ_RELEASE(schedule);
+            return res;
+          }
+      } else if (MPI_ROOT == root) {
+          for (int i = 0 ; i < rsize ; ++i) {
+              rbuf = ((char *)recvbuf) + (i * recvcount * rcvext);
+              /* root receives message to the right buffer */
+              res = NBC_Sched_recv (rbuf, false, recvcount, recvtype, i, schedule, false);
+              if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+                OBJ_RELEASE(schedule);
+                return res;
+              }
+          }
+      }
+
+      res = NBC_Sched_commit (schedule);
+      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+        OBJ_RELEASE(schedule);
+        return res;
+      }
     }
 
     res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-      OBJ_RELEASE(schedule);
       return res;
     }
 
@@ -24,11 +24,6 @@
  */
 #include "nbc_internal.h"
 
-/* an gatherv schedule can not be cached easily because the contents
- * ot the recvcounts array may change, so a comparison of the address
- * would not be sufficient ... we simply do not cache it */
-
-
 static int nbc_gatherv_init(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
                             void* recvbuf, const int *recvcounts, const int *displs, MPI_Datatype recvtype,
                             int root, struct ompi_communicator_t *comm, ompi_request_t ** request,
@@ -36,6 +31,7 @@ static int nbc_gatherv_init(const void* sendbuf, int sendcount, MPI_Datatype sen
   int rank, p, res;
   MPI_Aint rcvext = 0;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   char *rbuf, inplace = 0;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -53,52 +49,65 @@ static int nbc_gatherv_init(const void* sendbuf, int sendcount, MPI_Datatype sen
     }
   }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
+  NBC_Sched_key_init(&key, NBC_GATHERV, persistent);
+  NBC_SCHED_KEY_ADD(&key, root);
+  if (!inplace) {
+    NBC_SCHED_KEY_ADD(&key, sendbuf);
+    NBC_SCHED_KEY_ADD(&key, sendcount);
+    NBC_Sched_key_add_dtype(&key, sendtype);
   }
-
-  /* send to root */
-  if (rank != root) {
-    /* send msg to root */
-    res = NBC_Sched_send (sendbuf, false, sendcount, sendtype, root, schedule, false);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-      OBJ_RELEASE(schedule);
-      return res;
+  if (rank == root) {
+    NBC_SCHED_KEY_ADD(&key, recvbuf);
+    NBC_Sched_key_add(&key, recvcounts, p * sizeof(int));
+    NBC_Sched_key_add(&key, displs, p * sizeof(int));
+    NBC_Sched_key_add_dtype(&key, recvtype);
+  }
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
     }
-  } else {
-    for (int i = 0 ; i < p ; ++i) {
-      rbuf = (char *) recvbuf + displs[i] * rcvext;
-      if (i == root) {
-        if (!inplace) {
-          /* if I am the root - just copy the message */
-          res = NBC_Sched_copy ((void *)sendbuf, false, sendcount, sendtype,
-                                rbuf, false, recvcounts[i], recvtype, schedule, false);
+
+    /* send to root */
+    if (rank != root) {
+      /* send msg to root */
+      res = NBC_Sched_send (sendbuf, false, sendcount, sendtype, root, schedule, false);
+      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+        OBJ_RELEASE(schedule);
+        return res;
+      }
+    } else {
+      for (int i = 0 ; i < p ; ++i) {
+        rbuf = (char *) recvbuf + displs[i] * rcvext;
+        if (i == root) {
+          if (!inplace) {
+            /* if I am the root - just copy the message */
+            res = NBC_Sched_copy ((void *)sendbuf, false, sendcount, sendtype,
+                                  rbuf, false, recvcounts[i], recvtype, schedule, false);
+            if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+              OBJ_RELEASE(schedule);
+              return res;
+            }
+          }
+        } else {
+          /* root receives message to the right buffer */
+          res = NBC_Sched_recv (rbuf, false, recvcounts[i], recvtype, i, schedule, false);
           if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
             OBJ_RELEASE(schedule);
             return res;
           }
         }
-      } else {
-        /* root receives message to the right buffer */
-        res = NBC_Sched_recv (rbuf, false, recvcounts[i], recvtype, i, schedule, false);
-        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-          OBJ_RELEASE(schedule);
-          return res;
-        }
       }
     }
-  }
 
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    return res;
+    res = NBC_Sched_commit (schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      return res;
+    }
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
     return res;
   }
 
@@ -132,6 +141,7 @@ static int nbc_gatherv_inter_init (const void* sendbuf, int sendcount, MPI_Datat
   int res, rsize;
   MPI_Aint rcvext;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   char *rbuf;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -145,40 +155,53 @@ static int nbc_gatherv_inter_init (const void* sendbuf, int sendcount, MPI_Datat
     }
   }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
-
-  /* send to root */
+  NBC_Sched_key_init(&key, NBC_GATHERV, persistent);
+  NBC_SCHED_KEY_ADD(&key, root);
   if (MPI_ROOT != root && MPI_PROC_NULL != root) {
-    /* send msg to root */
-    res = NBC_Sched_send (sendbuf, false, sendcount, sendtype, root, schedule, false);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-      OBJ_RELEASE(schedule);
-      return res;
+    NBC_SCHED_KEY_ADD(&key, sendbuf);
+    NBC_SCHED_KEY_ADD(&key, sendcount);
+    NBC_Sched_key_add_dtype(&key, sendtype);
+  }
+  if (MPI_ROOT == root) {
+    NBC_SCHED_KEY_ADD(&key, recvbuf);
+    NBC_Sched_key_add(&key, recvcounts, rsize * sizeof(int));
+    NBC_Sched_key_add(&key, displs, rsize * sizeof(int));
+    NBC_Sched_key_add_dtype(&key, recvtype);
+  }
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
     }
-  } else if (MPI_ROOT == root) {
-    for (int i = 0 ; i < rsize ; ++i) {
-      rbuf = (char *) recvbuf + displs[i] * rcvext;
-      /* root receives message to the right buffer */
-      res = NBC_Sched_recv (rbuf, false, recvcounts[i], recvtype, i, schedule, false);
+
+    /* send to root */
+    if (MPI_ROOT != root && MPI_PROC_NULL != root) {
+      /* send msg to root */
+      res = NBC_Sched_send (sendbuf, false, sendcount, sendtype, root, schedule, false);
       if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
         OBJ_RELEASE(schedule);
         return res;
       }
+    } else if (MPI_ROOT == root) {
+      for (int i = 0 ; i < rsize ; ++i) {
+        rbuf = (char *) recvbuf + displs[i] * rcvext;
+        /* root receives message to the right buffer */
+        res = NBC_Sched_recv (rbuf, false, recvcounts[i], recvtype, i, schedule, false);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          return res;
+        }
+      }
     }
-  }
 
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    return res;
+    res = NBC_Sched_commit (schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      return res;
+    }
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
     return res;
   }
 
@@ -20,30 +20,6 @@
  */
 #include "nbc_internal.h"
 
-/* cannot cache schedules because one cannot check locally if the pattern is the same!! */
-#undef NBC_CACHE_SCHEDULE
-
-#ifdef NBC_CACHE_SCHEDULE
-/* tree comparison function for schedule cache */
-int NBC_Ineighbor_allgather_args_compare(NBC_Ineighbor_allgather_args *a, NBC_Ineighbor_allgather_args *b, void *param) {
-  if ((a->sbuf == b->sbuf) &&
-      (a->scount == b->scount) &&
-      (a->stype == b->stype) &&
-      (a->rbuf == b->rbuf) &&
-      (a->rcount == b->rcount) &&
-      (a->rtype == b->rtype) ) {
-    return  0;
-  }
-
-  if( a->sbuf < b->sbuf ) {
-    return -1;
-  }
-
-  return 1;
-}
-#endif
-
-
 static int nbc_neighbor_allgather_init(const void *sbuf, int scount, MPI_Datatype stype, void *rbuf,
                                        int rcount, MPI_Datatype rtype, struct ompi_communicator_t *comm,
                                        ompi_request_t ** request,
@@ -52,6 +28,7 @@ static int nbc_neighbor_allgather_init(const void *sbuf, int scount, MPI_Datatyp
   MPI_Aint rcvext;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
 
   res = ompi_datatype_type_extent (rtype, &rcvext);
   if (MPI_SUCCESS != res) {
@@ -59,21 +36,14 @@ static int nbc_neighbor_allgather_init(const void *sbuf, int scount, MPI_Datatyp
     return res;
   }
 
-#ifdef NBC_CACHE_SCHEDULE
-  NBC_Ineighbor_allgather_args *args, *found, search;
-
-  /* search schedule in communicator specific tree */
-  search.sbuf = sbuf;
-  search.scount = scount;
-  search.stype = stype;
-  search.rbuf = rbuf;
-  search.rcount = rcount;
-  search.rtype = rtype;
-  found = (NBC_Ineighbor_allgather_args *) hb_tree_search ((hb_tree *) libnbc_module->NBC_Dict[NBC_NEIGHBOR_ALLGATHER],
-                                                           &search);
-  if (NULL == found) {
-#endif
-    schedule = OBJ_NEW(NBC_Schedule);
+  NBC_Sched_key_init(&key, NBC_NEIGHBOR_ALLGATHER, persistent);
+  NBC_SCHED_KEY_ADD(&key, sbuf);
+  NBC_SCHED_KEY_ADD(&key, scount);
+  NBC_Sched_key_add_dtype(&key, stype);
+  NBC_SCHED_KEY_ADD(&key, rbuf);
+  NBC_SCHED_KEY_ADD(&key, rcount);
+  NBC_Sched_key_add_dtype(&key, rtype);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
     if (OPAL_UNLIKELY(NULL == schedule)) {
       return OMPI_ERR_OUT_OF_RESOURCE;
     }
@@ -122,41 +92,10 @@ static int nbc_neighbor_allgather_init(const void *sbuf, int scount, MPI_Datatyp
       OBJ_RELEASE(schedule);
       return res;
     }
-
-#ifdef NBC_CACHE_SCHEDULE
-    /* save schedule to tree */
-    args = (NBC_Ineighbor_allgather_args *) malloc (sizeof (args));
-    if (NULL != args) {
-      args->sbuf = sbuf;
-      args->scount = scount;
-      args->stype = stype;
-      args->rbuf = rbuf;
-      args->rcount = rcount;
-      args->rtype = rtype;
-      args->schedule = schedule;
-      res = hb_tree_insert ((hb_tree *) libnbc_module->NBC_Dict[NBC_NEIGHBOR_ALLGATHER], args, args, 0);
-      if (0 == res) {
-        OBJ_RETAIN(schedule);
-
-        /* increase number of elements for A2A */
-        if (++libnbc_module->NBC_Dict_size[NBC_NEIGHBOR_ALLGATHER] > NBC_SCHED_DICT_UPPER) {
-          NBC_SchedCache_dictwipe ((hb_tree *) libnbc_module->NBC_Dict[NBC_NEIGHBOR_ALLGATHER],
-                                   &libnbc_module->NBC_Dict_size[NBC_NEIGHBOR_ALLGATHER]);
-        }
-      } else {
-        NBC_Error("error in dict_insert() (%i)", res);
-        free (args);
-      }
-  } else {
-    /* found schedule */
-    schedule = found->schedule;
-    OBJ_RETAIN(schedule);
   }
-#endif
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
     return res;
   }
 
@@ -37,6 +37,7 @@
 #include "ompi/request/request.h"
 #include "ompi/datatype/ompi_datatype.h"
 #include "ompi/communicator/communicator.h"
+#include "ompi/op/op.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -44,7 +45,6 @@
 #include <assert.h>
 #include <math.h>
 #include <string.h>
-#include "libdict/dict.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -74,6 +74,12 @@ extern "C" {
 #define NBC_SCAN 13
 #define NBC_SCATTER 14
 #define NBC_SCATTERV 15
+#define NBC_REDUCESCAT_BLOCK 16
+#define NBC_NEIGHBOR_ALLGATHER 17
+#define NBC_NEIGHBOR_ALLGATHERV 18
+#define NBC_NEIGHBOR_ALLTOALL 19
+#define NBC_NEIGHBOR_ALLTOALLV 20
+#define NBC_NEIGHBOR_ALLTOALLW 21
 /* set the number of collectives in nbc.h !!!! */
 
 /* several typedefs for NBC */
@@ -160,109 +166,67 @@ int NBC_Sched_unpack (void *inbuf, char tmpinbuf, int count, MPI_Datatype dataty
 int NBC_Sched_barrier (NBC_Schedule *schedule);
 int NBC_Sched_commit (NBC_Schedule *schedule);
 
-#ifdef NBC_CACHE_SCHEDULE
-/* this is a dummy structure which is used to get the schedule out of
- * the collop specific structure. The schedule pointer HAS to be at the
- * first position and should NOT BE REORDERED by the compiler (C
- * guarantees that */
-struct NBC_dummyarg {
-  NBC_Schedule *schedule;
-};
+/* Schedule cache: a key identifies a collective call by its arguments
+ * (and the choices made from them, such as the algorithm).  Build it
+ * with NBC_Sched_key_init() and the NBC_Sched_key_add*() functions,
+ * then get a schedule with NBC_Sched_cache_get().  On a miss, the
+ * schedule is empty and remembers the key; once committed and handed
+ * to NBC_Schedule_request() it is inserted in the cache of the
+ * communicator, along with its temporary buffer. */
+#define NBC_SCHED_KEY_INLINE 128
+#define NBC_SCHED_KEY_INLINE_OBJS 4
 
 typedef struct {
-  NBC_Schedule *schedule;
-  void *sendbuf;
-  int sendcount;
-  MPI_Datatype sendtype;
-  void* recvbuf;
-  int recvcount;
-  MPI_Datatype recvtype;
-} NBC_Alltoall_args;
-int NBC_Alltoall_args_compare(NBC_Alltoall_args *a, NBC_Alltoall_args *b, void *param);
-
-typedef struct {
-  NBC_Schedule *schedule;
-  void *sendbuf;
-  int sendcount;
-  MPI_Datatype sendtype;
-  void* recvbuf;
-  int recvcount;
-  MPI_Datatype recvtype;
-} NBC_Allgather_args;
-int NBC_Allgather_args_compare(NBC_Allgather_args *a, NBC_Allgather_args *b, void *param);
-
-typedef struct {
-  NBC_Schedule *schedule;
-  void *sendbuf;
-  void* recvbuf;
-  int count;
-  MPI_Datatype datatype;
-  MPI_Op op;
-} NBC_Allreduce_args;
-int NBC_Allreduce_args_compare(NBC_Allreduce_args *a, NBC_Allreduce_args *b, void *param);
-
-typedef struct {
-  NBC_Schedule *schedule;
-  void *buffer;
-  int count;
-  MPI_Datatype datatype;
-  int root;
-} NBC_Bcast_args;
-int NBC_Bcast_args_compare(NBC_Bcast_args *a, NBC_Bcast_args *b, void *param);
-
-typedef struct {
-  NBC_Schedule *schedule;
-  void *sendbuf;
-  int sendcount;
-  MPI_Datatype sendtype;
-  void* recvbuf;
-  int recvcount;
-  MPI_Datatype recvtype;
-  int root;
-} NBC_Gather_args;
-int NBC_Gather_args_compare(NBC_Gather_args *a, NBC_Gather_args *b, void *param);
-
-typedef struct {
-  NBC_Schedule *schedule;
-  void *sendbuf;
-  void* recvbuf;
-  int count;
-  MPI_Datatype datatype;
-  MPI_Op op;
-  int root;
-} NBC_Reduce_args;
-int NBC_Reduce_args_compare(NBC_Reduce_args *a, NBC_Reduce_args *b, void *param);
+  char *data;
+  size_t len;
+  size_t size;
+  opal_object_t **objs;
+  int nobjs;
+  int objs_size;
+  bool valid;
+  char inline_data[NBC_SCHED_KEY_INLINE];
+  opal_object_t *inline_objs[NBC_SCHED_KEY_INLINE_OBJS];
+} NBC_Sched_key;
+
+void NBC_Sched_key_init(NBC_Sched_key *key, int coll, bool persistent);
+int NBC_Sched_key_grow(NBC_Sched_key *key, size_t len);
+void NBC_Sched_key_add_obj(NBC_Sched_key *key, opal_object_t *obj);
+bool NBC_Sched_cache_get(ompi_coll_libnbc_module_t *module, NBC_Sched_key *key,
+                         NBC_Schedule **schedule, void **tmpbuf);
+void NBC_Sched_cache_fini(ompi_coll_libnbc_module_t *module);
+
+static inline void NBC_Sched_key_add(NBC_Sched_key *key, const void *data, size_t len) {
+  if (OPAL_UNLIKELY(key->len + len > key->size)) {
+    if (OMPI_SUCCESS != NBC_Sched_key_grow(key, len)) {
+      return;
+    }
+  }
+  if (key->valid) {
+    memcpy(key->data + key->len, data, len);
+    key->len += len;
+  }
+}
 
-typedef struct {
-  NBC_Schedule *schedule;
-  void *sendbuf;
-  void* recvbuf;
-  int count;
-  MPI_Datatype datatype;
-  MPI_Op op;
-} NBC_Scan_args;
-int NBC_Scan_args_compare(NBC_Scan_args *a, NBC_Scan_args *b, void *param);
+#define NBC_SCHED_KEY_ADD(key, var) NBC_Sched_key_add((key), &(var), sizeof(var))
 
-typedef struct {
-  NBC_Schedule *schedule;
-  void *sendbuf;
-  int sendcount;
-  MPI_Datatype sendtype;
-  void* recvbuf;
-  int recvcount;
-  MPI_Datatype recvtype;
-  int root;
-} NBC_Scatter_args;
-int NBC_Scatter_args_compare(NBC_Scatter_args *a, NBC_Scatter_args *b, void *param);
-
-/* Schedule cache structures/functions */
-void NBC_SchedCache_args_delete(void *entry);
-void NBC_SchedCache_args_delete_key_dummy(void *k);
+static inline void NBC_Sched_key_add_dtype(NBC_Sched_key *key, MPI_Datatype type) {
+  NBC_SCHED_KEY_ADD(key, type);
+  if (!ompi_datatype_is_predefined(type)) {
+    NBC_Sched_key_add_obj(key, &type->super.super);
+  }
+}
 
-#endif
+static inline void NBC_Sched_key_add_op(NBC_Sched_key *key, MPI_Op op) {
+  NBC_SCHED_KEY_ADD(key, op);
+  if (!ompi_op_is_intrinsic(op)) {
+    NBC_Sched_key_add_obj(key, &op->super);
+  }
+}
 
 
 int NBC_Start(NBC_Handle *handle);
+/* create the request for schedule; on failure, schedule and tmpbuf are
+   released */
 int NBC_Schedule_request(NBC_Schedule *schedule, ompi_communicator_t *comm,
                          ompi_coll_libnbc_module_t *module, bool persistent,
                          ompi_request_t **request, void *tmpbuf);
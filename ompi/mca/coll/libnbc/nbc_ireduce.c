@@ -38,26 +38,6 @@ static inline int red_sched_redscat_gather(
     char tmpredbuf, int count, MPI_Datatype datatype, MPI_Op op, char inplace,
     NBC_Schedule *schedule, void *tmp_buf, struct ompi_communicator_t *comm);
 
-#ifdef NBC_CACHE_SCHEDULE
-/* tree comparison function for schedule cache */
-int NBC_Reduce_args_compare(NBC_Reduce_args *a, NBC_Reduce_args *b, void *param) {
-  if ((a->sendbuf == b->sendbuf) &&
-      (a->recvbuf == b->recvbuf) &&
-      (a->count == b->count) &&
-      (a->datatype == b->datatype) &&
-      (a->op == b->op) &&
-      (a->root == b->root)) {
-    return 0;
-  }
-
-  if (a->sendbuf < b->sendbuf) {
-    return -1;
-  }
-
-  return 1;
-}
-#endif
-
 /* the non-blocking reduce */
 static int nbc_reduce_init(const void* sendbuf, void* recvbuf, int count, MPI_Datatype datatype,
                            MPI_Op op, int root, struct ompi_communicator_t *comm, ompi_request_t ** request,
@@ -66,8 +46,9 @@ static int nbc_reduce_init(const void* sendbuf, void* recvbuf, int count, MPI_Da
   size_t size;
   MPI_Aint ext;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   char *redbuf=NULL, inplace;
-  void *tmpbuf;
+  void *tmpbuf = NULL;
   char tmpredbuf = 0;
   enum { NBC_RED_BINOMIAL, NBC_RED_CHAIN, NBC_RED_REDSCAT_GATHER} alg;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
@@ -125,44 +106,39 @@ static int nbc_reduce_init(const void* sendbuf, void* recvbuf, int count, MPI_Da
     }
   }
 
-  /* allocate temporary buffers */
-  if (alg == NBC_RED_REDSCAT_GATHER || alg == NBC_RED_BINOMIAL) {
-    if (rank == root) {
-      /* root reduces in receive buffer */
-      tmpbuf = malloc(span);
-      redbuf = recvbuf;
-    } else {
-      /* recvbuf may not be valid on non-root nodes */
-      ptrdiff_t span_align = OPAL_ALIGN(span, datatype->super.align, ptrdiff_t);
-      tmpbuf = malloc(span_align + span);
-      redbuf = (char *)span_align - gap;
-      tmpredbuf = 1;
+  NBC_Sched_key_init(&key, NBC_REDUCE, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_SCHED_KEY_ADD(&key, count);
+  NBC_Sched_key_add_dtype(&key, datatype);
+  NBC_Sched_key_add_op(&key, op);
+  NBC_SCHED_KEY_ADD(&key, root);
+  NBC_SCHED_KEY_ADD(&key, alg);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
     }
-  } else {
-    tmpbuf = malloc (span);
-    segsize = 16384/2;
-  }
 
-  if (OPAL_UNLIKELY(NULL == tmpbuf)) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+    /* allocate temporary buffers */
+    if (alg == NBC_RED_REDSCAT_GATHER || alg == NBC_RED_BINOMIAL) {
+      if (rank == root) {
+        /* root reduces in receive buffer */
+        tmpbuf = malloc(span);
+        redbuf = recvbuf;
+      } else {
+        /* recvbuf may not be valid on non-root nodes */
+        ptrdiff_t span_align = OPAL_ALIGN(span, datatype->super.align, ptrdiff_t);
+        tmpbuf = malloc(span_align + span);
+        redbuf = (char *)span_align - gap;
+        tmpredbuf = 1;
+      }
+    } else {
+      tmpbuf = malloc (span);
+      segsize = 16384/2;
+    }
 
-#ifdef NBC_CACHE_SCHEDULE
-  NBC_Reduce_args *args, *found, search;
-
-  /* search schedule in communicator specific tree */
-  search.sendbuf = sendbuf;
-  search.recvbuf = recvbuf;
-  search.count = count;
-  search.datatype = datatype;
-  search.op = op;
-  search.root = root;
-  found = (NBC_Reduce_args *) hb_tree_search ((hb_tree *) libnbc_module->NBC_Dict[NBC_REDUCE], &search);
-  if (NULL == found) {
-#endif
-    schedule = OBJ_NEW(NBC_Schedule);
-    if (OPAL_UNLIKELY(NULL == schedule)) {
-      free(tmpbuf);
+    if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+      OBJ_RELEASE(schedule);
       return OMPI_ERR_OUT_OF_RESOURCE;
     }
 
@@ -195,42 +171,10 @@ static int nbc_reduce_init(const void* sendbuf, void* recvbuf, int count, MPI_Da
       free(tmpbuf);
       return res;
     }
-#ifdef NBC_CACHE_SCHEDULE
-    /* save schedule to tree */
-    args = (NBC_Reduce_args *) malloc (sizeof (args));
-    if (NULL != args) {
-      args->sendbuf = sendbuf;
-      args->recvbuf = recvbuf;
-      args->count = count;
-      args->datatype = datatype;
-      args->op = op;
-      args->root = root;
-      args->schedule = schedule;
-      res = hb_tree_insert ((hb_tree *) libnbc_module->NBC_Dict[NBC_REDUCE], args, args, 0);
-      if (0 == res) {
-        OBJ_RETAIN(schedule);
-
-        /* increase number of elements for Reduce */
-        if (++libnbc_module->NBC_Dict_size[NBC_REDUCE] > NBC_SCHED_DICT_UPPER) {
-          NBC_SchedCache_dictwipe ((hb_tree *) libnbc_module->NBC_Dict[NBC_REDUCE],
-                                   &libnbc_module->NBC_Dict_size[NBC_REDUCE]);
-        }
-      } else {
-        NBC_Error("error in dict_insert() (%i)", res);
-        free (args);
-      }
-    }
-  } else {
-    /* found schedule */
-    schedule = found->schedule;
-    OBJ_RETAIN(schedule);
   }
-#endif
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, tmpbuf);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
     return res;
   }
 
@@ -260,43 +204,50 @@ static int nbc_reduce_inter_init(const void* sendbuf, void* recvbuf, int count,
                                  struct mca_coll_base_module_2_3_0_t *module, bool persistent) {
   int rank, res, rsize;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
   ptrdiff_t span, gap;
-  void *tmpbuf;
+  void *tmpbuf = NULL;
 
   rank = ompi_comm_rank (comm);
   rsize = ompi_comm_remote_size (comm);
 
-  span = opal_datatype_span(&datatype->super, count, &gap);
-  tmpbuf = malloc (span);
-  if (OPAL_UNLIKELY(NULL == tmpbuf)) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+  NBC_Sched_key_init(&key, NBC_REDUCE, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_SCHED_KEY_ADD(&key, count);
+  NBC_Sched_key_add_dtype(&key, datatype);
+  NBC_Sched_key_add_op(&key, op);
+  NBC_SCHED_KEY_ADD(&key, root);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    free(tmpbuf);
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+    span = opal_datatype_span(&datatype->super, count, &gap);
+    tmpbuf = malloc (span);
+    if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+      OBJ_RELEASE(schedule);
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  res = red_sched_linear (rank, rsize, root, sendbuf, recvbuf, (void *)(-gap), count, datatype, op, schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+    res = red_sched_linear (rank, rsize, root, sendbuf, recvbuf, (void *)(-gap), count, datatype, op, schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      free(tmpbuf);
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  res = NBC_Sched_commit(schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
+    res = NBC_Sched_commit(schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      free(tmpbuf);
+      return res;
+    }
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, tmpbuf);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
     return OMPI_ERR_OUT_OF_RESOURCE;
   }
 
@@ -25,10 +25,6 @@
 
 #include "nbc_internal.h"
 
-/* an reduce_csttare schedule can not be cached easily because the contents
- * ot the recvcounts array may change, so a comparison of the address
- * would not be sufficient ... we simply do not cache it */
-
 /* binomial reduce to rank 0 followed by a linear scatter ...
  *
  * Algorithm:
@@ -50,7 +46,8 @@ static int nbc_reduce_scatter_init(const void* sendbuf, void* recvbuf, const int
   ptrdiff_t gap, span, span_align;
   char *sbuf, inplace;
   NBC_Schedule *schedule;
-  void *tmpbuf;
+  NBC_Sched_key key;
+  void *tmpbuf = NULL;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
   char *rbuf, *lbuf, *buf;
 
@@ -84,125 +81,130 @@ static int nbc_reduce_scatter_init(const void* sendbuf, void* recvbuf, const int
 
   maxr = (int) ceil ((log((double) p) / LOG2));
 
-  span = opal_datatype_span(&datatype->super, count, &gap);
-  span_align = OPAL_ALIGN(span, datatype->super.align, ptrdiff_t);
-  tmpbuf = malloc (span_align + span);
-  if (OPAL_UNLIKELY(NULL == tmpbuf)) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
-
-  rbuf = (char *)(-gap);
-  lbuf = (char *)(span_align - gap);
+  NBC_Sched_key_init(&key, NBC_REDUCESCAT, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_Sched_key_add(&key, recvcounts, p * sizeof(int));
+  NBC_Sched_key_add_dtype(&key, datatype);
+  NBC_Sched_key_add_op(&key, op);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    free(tmpbuf);
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+    span = opal_datatype_span(&datatype->super, count, &gap);
+    span_align = OPAL_ALIGN(span, datatype->super.align, ptrdiff_t);
+    tmpbuf = malloc (span_align + span);
+    if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+      OBJ_RELEASE(schedule);
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  for (int r = 1, firstred = 1 ; r <= maxr ; ++r) {
-    if ((rank % (1 << r)) == 0) {
-      /* we have to receive this round */
-      peer = rank + (1 << (r - 1));
-      if (peer < p) {
-        /* we have to wait until we have the data */
-        res = NBC_Sched_recv(rbuf, true, count, datatype, peer, schedule, true);
+    rbuf = (char *)(-gap);
+    lbuf = (char *)(span_align - gap);
+
+    for (int r = 1, firstred = 1 ; r <= maxr ; ++r) {
+      if ((rank % (1 << r)) == 0) {
+        /* we have to receive this round */
+        peer = rank + (1 << (r - 1));
+        if (peer < p) {
+          /* we have to wait until we have the data */
+          res = NBC_Sched_recv(rbuf, true, count, datatype, peer, schedule, true);
+          if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+            OBJ_RELEASE(schedule);
+            free(tmpbuf);
+            return res;
+          }
+
+          /* this cannot be done until tmpbuf is unused :-( so barrier after the op */
+          if (firstred) {
+            /* take reduce data from the sendbuf in the first round -> save copy */
+            res = NBC_Sched_op (sendbuf, false, rbuf, true, count, datatype, op, schedule, true);
+            firstred = 0;
+          } else {
+            /* perform the reduce in my local buffer */
+            res = NBC_Sched_op (lbuf, true, rbuf, true, count, datatype, op, schedule, true);
+          }
+
+          if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+            OBJ_RELEASE(schedule);
+            free(tmpbuf);
+            return res;
+          }
+          /* swap left and right buffers */
+          buf = rbuf; rbuf = lbuf ; lbuf = buf;
+        }
+      } else {
+        /* we have to send this round */
+        peer = rank - (1 << (r - 1));
+        if (firstred) {
+          /* we have to send the senbuf */
+          res = NBC_Sched_send (sendbuf, false, count, datatype, peer, schedule, false);
+        } else {
+          /* we send an already reduced value from lbuf */
+          res = NBC_Sched_send (lbuf, true, count, datatype, peer, schedule, false);
+        }
         if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
           OBJ_RELEASE(schedule);
           free(tmpbuf);
           return res;
         }
 
-        /* this cannot be done until tmpbuf is unused :-( so barrier after the op */
-        if (firstred) {
-          /* take reduce data from the sendbuf in the first round -> save copy */
-          res = NBC_Sched_op (sendbuf, false, rbuf, true, count, datatype, op, schedule, true);
-          firstred = 0;
-        } else {
-          /* perform the reduce in my local buffer */
-          res = NBC_Sched_op (lbuf, true, rbuf, true, count, datatype, op, schedule, true);
-        }
+        /* leave the game */
+        break;
+      }
+    }
+
+    res = NBC_Sched_barrier(schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      free(tmpbuf);
+      return res;
+    }
 
+    /* rank 0 is root and sends - all others receive */
+    if (rank == 0) {
+      for (long int r = 1, offset = 0 ; r < p ; ++r) {
+        offset += recvcounts[r-1];
+        sbuf = lbuf + (offset*ext);
+        /* root sends the right buffer to the right receiver */
+        res = NBC_Sched_send (sbuf, true, recvcounts[r], datatype, r, schedule,
+                              false);
         if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
           OBJ_RELEASE(schedule);
           free(tmpbuf);
           return res;
         }
-        /* swap left and right buffers */
-        buf = rbuf; rbuf = lbuf ; lbuf = buf;
       }
-    } else {
-      /* we have to send this round */
-      peer = rank - (1 << (r - 1));
-      if (firstred) {
-        /* we have to send the senbuf */
-        res = NBC_Sched_send (sendbuf, false, count, datatype, peer, schedule, false);
+
+      if (p == 1) {
+        /* single node not in_place: copy data to recvbuf */
+        res = NBC_Sched_copy ((void *)sendbuf, false, recvcounts[0], datatype,
+                              recvbuf, false, recvcounts[0], datatype, schedule, false);
       } else {
-        /* we send an already reduced value from lbuf */
-        res = NBC_Sched_send (lbuf, true, count, datatype, peer, schedule, false);
-      }
-      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        free(tmpbuf);
-        return res;
+        res = NBC_Sched_copy (lbuf, true, recvcounts[0], datatype, recvbuf, false,
+                              recvcounts[0], datatype, schedule, false);
       }
-
-      /* leave the game */
-      break;
+    } else {
+      res = NBC_Sched_recv (recvbuf, false, recvcounts[rank], datatype, 0, schedule, false);
     }
-  }
-
-  res = NBC_Sched_barrier(schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
-  }
 
-  /* rank 0 is root and sends - all others receive */
-  if (rank == 0) {
-    for (long int r = 1, offset = 0 ; r < p ; ++r) {
-      offset += recvcounts[r-1];
-      sbuf = lbuf + (offset*ext);
-      /* root sends the right buffer to the right receiver */
-      res = NBC_Sched_send (sbuf, true, recvcounts[r], datatype, r, schedule,
-                            false);
-      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        free(tmpbuf);
-        return res;
-      }
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      free(tmpbuf);
+      return res;
     }
 
-    if (p == 1) {
-      /* single node not in_place: copy data to recvbuf */
-      res = NBC_Sched_copy ((void *)sendbuf, false, recvcounts[0], datatype,
-                            recvbuf, false, recvcounts[0], datatype, schedule, false);
-    } else {
-      res = NBC_Sched_copy (lbuf, true, recvcounts[0], datatype, recvbuf, false,
-                            recvcounts[0], datatype, schedule, false);
+    res = NBC_Sched_commit (schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      free(tmpbuf);
+      return res;
     }
-  } else {
-    res = NBC_Sched_recv (recvbuf, false, recvcounts[rank], datatype, 0, schedule, false);
-  }
-
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
-  }
-
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, tmpbuf);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
     return res;
   }
 
@@ -233,6 +235,7 @@ static int nbc_reduce_scatter_inter_init (const void* sendbuf, void* recvbuf, co
   MPI_Aint ext;
   ptrdiff_t gap, span, span_align;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   void *tmpbuf = NULL;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -251,82 +254,96 @@ static int nbc_reduce_scatter_inter_init (const void* sendbuf, void* recvbuf, co
     count += recvcounts[r];
   }
 
-  span = opal_datatype_span(&datatype->super, count, &gap);
-  span_align = OPAL_ALIGN(span, datatype->super.align, ptrdiff_t);
-
-  if (count > 0) {
-    tmpbuf = malloc (span_align + span);
-    if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+  NBC_Sched_key_init(&key, NBC_REDUCESCAT, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_Sched_key_add(&key, recvcounts, lsize * sizeof(int));
+  NBC_Sched_key_add_dtype(&key, datatype);
+  NBC_Sched_key_add_op(&key, op);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
       return OMPI_ERR_OUT_OF_RESOURCE;
     }
-  }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    free(tmpbuf);
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+    span = opal_datatype_span(&datatype->super, count, &gap);
+    span_align = OPAL_ALIGN(span, datatype->super.align, ptrdiff_t);
 
-  /* send my data to the remote root */
-  res = NBC_Sched_send(sendbuf, false, count, datatype, 0, schedule, false);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
-  }
+    if (count > 0) {
+      tmpbuf = malloc (span_align + span);
+      if (OPAL_UNLIKELY(NULL == tmpbuf)) {
+        OBJ_RELEASE(schedule);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+      }
+    }
 
-  if (0 == rank) {
-    char *lbuf, *rbuf;
-    lbuf = (char *)(-gap);
-    rbuf = (char *)(span_align-gap);
-    res = NBC_Sched_recv (lbuf, true, count, datatype, 0, schedule, true);
+    /* send my data to the remote root */
+    res = NBC_Sched_send(sendbuf, false, count, datatype, 0, schedule, false);
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
       OBJ_RELEASE(schedule);
       free(tmpbuf);
       return res;
     }
 
-    for (int peer = 1 ; peer < rsize ; ++peer) {
-      char *tbuf;
-      res = NBC_Sched_recv (rbuf, true, count, datatype, peer, schedule, true);
+    if (0 == rank) {
+      char *lbuf, *rbuf;
+      lbuf = (char *)(-gap);
+      rbuf = (char *)(span_align-gap);
+      res = NBC_Sched_recv (lbuf, true, count, datatype, 0, schedule, true);
       if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
         OBJ_RELEASE(schedule);
         free(tmpbuf);
         return res;
       }
 
-      res = NBC_Sched_op (lbuf, true, rbuf, true, count, datatype,
-                          op, schedule, true);
+      for (int peer = 1 ; peer < rsize ; ++peer) {
+        char *tbuf;
+        res = NBC_Sched_recv (rbuf, true, count, datatype, peer, schedule, true);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          free(tmpbuf);
+          return res;
+        }
+
+        res = NBC_Sched_op (lbuf, true, rbuf, true, count, datatype,
+                            op, schedule, true);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          free(tmpbuf);
+          return res;
+        }
+        tbuf = lbuf; lbuf = rbuf; rbuf = tbuf;
+      }
+
+      /* do the local scatterv with the local communicator */
+      res = NBC_Sched_copy (lbuf, true, recvcounts[0], datatype, recvbuf, false,
+                            recvcounts[0], datatype, schedule, false);
       if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
         OBJ_RELEASE(schedule);
         free(tmpbuf);
         return res;
       }
-      tbuf = lbuf; lbuf = rbuf; rbuf = tbuf;
-    }
+      for (int peer = 1, offset = recvcounts[0] * ext; peer < lsize ; ++peer) {
+        res = NBC_Sched_local_send (lbuf + offset, true, recvcounts[peer], datatype, peer, schedule,
+                                    false);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          free(tmpbuf);
+          return res;
+        }
 
-    /* do the local scatterv with the local communicator */
-    res = NBC_Sched_copy (lbuf, true, recvcounts[0], datatype, recvbuf, false,
-                          recvcounts[0], datatype, schedule, false);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-      OBJ_RELEASE(schedule);
-      free(tmpbuf);
-      return res;
-    }
-    for (int peer = 1, offset = recvcounts[0] * ext; peer < lsize ; ++peer) {
-      res = NBC_Sched_local_send (lbuf + offset, true, recvcounts[peer], datatype, peer, schedule,
-                                  false);
+        offset += recvcounts[peer] * ext;
+      }
+    } else {
+      /* receive my block */
+      res = NBC_Sched_local_recv (recvbuf, false, recvcounts[rank], datatype, 0, schedule, false);
       if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
         OBJ_RELEASE(schedule);
         free(tmpbuf);
         return res;
       }
-
-      offset += recvcounts[peer] * ext;
     }
-  } else {
-    /* receive my block */
-    res = NBC_Sched_local_recv (recvbuf, false, recvcounts[rank], datatype, 0, schedule, false);
+
+    res = NBC_Sched_commit (schedule);
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
       OBJ_RELEASE(schedule);
       free(tmpbuf);
@@ -334,17 +351,8 @@ static int nbc_reduce_scatter_inter_init (const void* sendbuf, void* recvbuf, co
     }
   }
 
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
-  }
-
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, tmpbuf);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
     return res;
   }
 
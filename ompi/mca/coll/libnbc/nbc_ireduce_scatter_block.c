@@ -23,10 +23,6 @@
 
 #include "nbc_internal.h"
 
-/* an reduce_csttare schedule can not be cached easily because the contents
- * ot the recvcount value may change, so a comparison of the address
- * would not be sufficient ... we simply do not cache it */
-
 /* binomial reduce to rank 0 followed by a linear scatter ...
  *
  * Algorithm:
@@ -48,6 +44,7 @@ static int nbc_reduce_scatter_block_init(const void* sendbuf, void* recvbuf, int
   ptrdiff_t gap, span;
   char *redbuf, *sbuf, inplace;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   void *tmpbuf = NULL;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -62,62 +59,87 @@ static int nbc_reduce_scatter_block_init(const void* sendbuf, void* recvbuf, int
     return (MPI_SUCCESS == res) ? MPI_ERR_SIZE : res;
   }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (NULL == schedule) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+  NBC_Sched_key_init(&key, NBC_REDUCESCAT_BLOCK, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_SCHED_KEY_ADD(&key, recvcount);
+  NBC_Sched_key_add_dtype(&key, datatype);
+  NBC_Sched_key_add_op(&key, op);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
+    }
 
-  maxr = (int)ceil((log((double)p)/LOG2));
+    maxr = (int)ceil((log((double)p)/LOG2));
 
-  count = p * recvcount;
+    count = p * recvcount;
 
-  if (0 < count) {
-    char *rbuf, *lbuf, *buf;
-    ptrdiff_t span_align;
+    if (0 < count) {
+      char *rbuf, *lbuf, *buf;
+      ptrdiff_t span_align;
 
-    span = opal_datatype_span(&datatype->super, count, &gap);
-    span_align = OPAL_ALIGN(span, datatype->super.align, ptrdiff_t);
-    tmpbuf = malloc (span_align + span);
-    if (NULL == tmpbuf) {
-      OBJ_RELEASE(schedule);
-      return OMPI_ERR_OUT_OF_RESOURCE;
-    }
+      span = opal_datatype_span(&datatype->super, count, &gap);
+      span_align = OPAL_ALIGN(span, datatype->super.align, ptrdiff_t);
+      tmpbuf = malloc (span_align + span);
+      if (NULL == tmpbuf) {
+        OBJ_RELEASE(schedule);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+      }
 
-    rbuf = (void *)(-gap);
-    lbuf = (char *)(span_align - gap);
-    redbuf = (char *) tmpbuf + span_align - gap;
+      rbuf = (void *)(-gap);
+      lbuf = (char *)(span_align - gap);
+      redbuf = (char *) tmpbuf + span_align - gap;
 
-    /* copy data to redbuf if we only have a single node */
-    if ((p == 1) && !inplace) {
-      res = NBC_Sched_copy ((void *)sendbuf, false, count, datatype,
-                            redbuf, false, count, datatype, schedule, false);
-      if (OMPI_SUCCESS != res) {
-        OBJ_RELEASE(schedule);
-        free(tmpbuf);
-        return res;
+      /* copy data to redbuf if we only have a single node */
+      if ((p == 1) && !inplace) {
+        res = NBC_Sched_copy ((void *)sendbuf, false, count, datatype,
+                              redbuf, false, count, datatype, schedule, false);
+        if (OMPI_SUCCESS != res) {
+          OBJ_RELEASE(schedule);
+          free(tmpbuf);
+          return res;
+        }
       }
-    }
 
-    for (int r = 1, firstred = 1 ; r <= maxr; ++r) {
-      if ((rank % (1 << r)) == 0) {
-        /* we have to receive this round */
-        peer = rank + (1 << (r - 1));
-        if (peer < p) {
-          /* we have to wait until we have the data */
-          res = NBC_Sched_recv (rbuf, true, count, datatype, peer, schedule, true);
-          if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-            OBJ_RELEASE(schedule);
-            free(tmpbuf);
-            return res;
+      for (int r = 1, firstred = 1 ; r <= maxr; ++r) {
+        if ((rank % (1 << r)) == 0) {
+          /* we have to receive this round */
+          peer = rank + (1 << (r - 1));
+          if (peer < p) {
+            /* we have to wait until we have the data */
+            res = NBC_Sched_recv (rbuf, true, count, datatype, peer, schedule, true);
+            if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+              OBJ_RELEASE(schedule);
+              free(tmpbuf);
+              return res;
+            }
+
+            if (firstred) {
+              /* take reduce data from the sendbuf in the first round -> save copy */
+              res = NBC_Sched_op (sendbuf, false, rbuf, true, count, datatype, op, schedule, true);
+              firstred = 0;
+            } else {
+            /* perform the reduce in my local buffer */
+              res = NBC_Sched_op (lbuf, true, rbuf, true, count, datatype, op, schedule, true);
+            }
+
+            if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+              OBJ_RELEASE(schedule);
+              free(tmpbuf);
+              return res;
+            }
+            /* swap left and right buffers */
+            buf = rbuf; rbuf = lbuf ; lbuf = buf;
           }
-
-          if (firstred) {
-            /* take reduce data from the sendbuf in the first round -> save copy */
-            res = NBC_Sched_op (sendbuf, false, rbuf, true, count, datatype, op, schedule, true);
-            firstred = 0;
+        } else {
+          /* we have to send this round */
+          peer = rank - (1 << (r - 1));
+          if(firstred) {
+            /* we have to send the senbuf */
+            res = NBC_Sched_send (sendbuf, false, count, datatype, peer, schedule, false);
           } else {
-          /* perform the reduce in my local buffer */
-            res = NBC_Sched_op (lbuf, true, rbuf, true, count, datatype, op, schedule, true);
+            /* we send an already reduced value from redbuf */
+            res = NBC_Sched_send (lbuf, true, count, datatype, peer, schedule, false);
           }
 
           if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
@@ -125,82 +147,62 @@ static int nbc_reduce_scatter_block_init(const void* sendbuf, void* recvbuf, int
             free(tmpbuf);
             return res;
           }
-          /* swap left and right buffers */
-          buf = rbuf; rbuf = lbuf ; lbuf = buf;
-        }
-      } else {
-        /* we have to send this round */
-        peer = rank - (1 << (r - 1));
-        if(firstred) {
-          /* we have to send the senbuf */
-          res = NBC_Sched_send (sendbuf, false, count, datatype, peer, schedule, false);
-        } else {
-          /* we send an already reduced value from redbuf */
-          res = NBC_Sched_send (lbuf, true, count, datatype, peer, schedule, false);
-        }
 
-        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-          OBJ_RELEASE(schedule);
-          free(tmpbuf);
-          return res;
+          /* leave the game */
+          break;
         }
-
-        /* leave the game */
-        break;
       }
-    }
-
-    res = NBC_Sched_barrier(schedule);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-      OBJ_RELEASE(schedule);
-      free(tmpbuf);
-      return res;
-    }
 
-    /* rank 0 is root and sends - all others receive */
-    if (rank != 0) {
-      res = NBC_Sched_recv (recvbuf, false, recvcount, datatype, 0, schedule, false);
+      res = NBC_Sched_barrier(schedule);
       if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
         OBJ_RELEASE(schedule);
         free(tmpbuf);
         return res;
       }
-    } else {
-      for (int r = 1, offset = 0 ; r < p ; ++r) {
-        offset += recvcount;
-        sbuf = lbuf + (offset*ext);
-        /* root sends the right buffer to the right receiver */
-        res = NBC_Sched_send (sbuf, true, recvcount, datatype, r, schedule, false);
+
+      /* rank 0 is root and sends - all others receive */
+      if (rank != 0) {
+        res = NBC_Sched_recv (recvbuf, false, recvcount, datatype, 0, schedule, false);
         if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
           OBJ_RELEASE(schedule);
           free(tmpbuf);
           return res;
         }
-      }
+      } else {
+        for (int r = 1, offset = 0 ; r < p ; ++r) {
+          offset += recvcount;
+          sbuf = lbuf + (offset*ext);
+          /* root sends the right buffer to the right receiver */
+          res = NBC_Sched_send (sbuf, true, recvcount, datatype, r, schedule, false);
+          if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+            OBJ_RELEASE(schedule);
+            free(tmpbuf);
+            return res;
+          }
+        }
 
-      if ((p != 1) || !inplace) {
-        res = NBC_Sched_copy (lbuf, true, recvcount, datatype, recvbuf, false, recvcount,
-                              datatype, schedule, false);
-      }
-      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        free(tmpbuf);
-        return res;
+        if ((p != 1) || !inplace) {
+          res = NBC_Sched_copy (lbuf, true, recvcount, datatype, recvbuf, false, recvcount,
+                                datatype, schedule, false);
+        }
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          free(tmpbuf);
+          return res;
+        }
       }
     }
-  }
 
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
+    res = NBC_Sched_commit (schedule);
+    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+      OBJ_RELEASE(schedule);
+      free(tmpbuf);
+      return res;
+    }
   }
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, tmpbuf);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
     return res;
   }
 
@@ -232,6 +234,7 @@ static int nbc_reduce_scatter_block_inter_init(const void *sendbuf, void *recvbu
   MPI_Aint ext;
   ptrdiff_t gap, span, span_align;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   void *tmpbuf = NULL;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -247,79 +250,95 @@ static int nbc_reduce_scatter_block_inter_init(const void *sendbuf, void *recvbu
 
   count = rcount * lsize;
 
-  span = opal_datatype_span(&dtype->super, count, &gap);
-  span_align = OPAL_ALIGN(span, dtype->super.align, ptrdiff_t);
-
-  if (count > 0) {
-    tmpbuf = malloc (span_align + span);
-    if (NULL == tmpbuf) {
+  NBC_Sched_key_init(&key, NBC_REDUCESCAT_BLOCK, persistent);
+  NBC_SCHED_KEY_ADD(&key, sendbuf);
+  NBC_SCHED_KEY_ADD(&key, recvbuf);
+  NBC_SCHED_KEY_ADD(&key, rcount);
+  NBC_Sched_key_add_dtype(&key, dtype);
+  NBC_Sched_key_add_op(&key, op);
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, &tmpbuf)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
       return OMPI_ERR_OUT_OF_RESOURCE;
     }
-  }
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (NULL == schedule) {
-    free(tmpbuf);
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
+    span = opal_datatype_span(&dtype->super, count, &gap);
+    span_align = OPAL_ALIGN(span, dtype->super.align, ptrdiff_t);
 
-  /* send my data to the remote root */
-  res = NBC_Sched_send (sendbuf, false, count, dtype, 0, schedule, false);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
-  }
+    if (count > 0) {
+      tmpbuf = malloc (span_align + span);
+      if (NULL == tmpbuf) {
+        OBJ_RELEASE(schedule);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+      }
+    }
 
-  if (0 == rank) {
-    char *lbuf, *rbuf;
-    lbuf = (char *)(-gap);
-    rbuf = (char *)(span_align-gap);
-    res = NBC_Sched_recv (lbuf, true, count, dtype, 0, schedule, true);
+    /* send my data to the remote root */
+    res = NBC_Sched_send (sendbuf, false, count, dtype, 0, schedule, false);
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
       OBJ_RELEASE(schedule);
       free(tmpbuf);
       return res;
     }
 
-    for (int peer = 1 ; peer < rsize ; ++peer) {
-      char *tbuf;
-      res = NBC_Sched_recv (rbuf, true, count, dtype, peer, schedule, true);
+    if (0 == rank) {
+      char *lbuf, *rbuf;
+      lbuf = (char *)(-gap);
+      rbuf = (char *)(span_align-gap);
+      res = NBC_Sched_recv (lbuf, true, count, dtype, 0, schedule, true);
       if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
         OBJ_RELEASE(schedule);
         free(tmpbuf);
         return res;
       }
 
-      res = NBC_Sched_op (lbuf, true, rbuf, true, count, dtype,
-                          op, schedule, true);
+      for (int peer = 1 ; peer < rsize ; ++peer) {
+        char *tbuf;
+        res = NBC_Sched_recv (rbuf, true, count, dtype, peer, schedule, true);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          free(tmpbuf);
+          return res;
+        }
+
+        res = NBC_Sched_op (lbuf, true, rbuf, true, count, dtype,
+                            op, schedule, true);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          free(tmpbuf);
+          return res;
+        }
+        tbuf = lbuf; lbuf = rbuf; rbuf = tbuf;
+      }
+
+      /* do the scatter with the local communicator */
+      res = NBC_Sched_copy (lbuf, true, rcount, dtype, recvbuf, false, rcount,
+                            dtype, schedule, false);
       if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
         OBJ_RELEASE(schedule);
         free(tmpbuf);
         return res;
       }
-      tbuf = lbuf; lbuf = rbuf; rbuf = tbuf;
-    }
-
-    /* do the scatter with the local communicator */
-    res = NBC_Sched_copy (lbuf, true, rcount, dtype, recvbuf, false, rcount,
-                          dtype, schedule, false);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-      OBJ_RELEASE(schedule);
-      free(tmpbuf);
-      return res;
-    }
-    for (int peer = 1 ; peer < lsize ; ++peer) {
-      res = NBC_Sched_local_send (lbuf + ext * rcount * peer, true, rcount, dtype, peer, schedule, false);
+      for (int peer = 1 ; peer < lsize ; ++peer) {
+        res = NBC_Sched_local_send (lbuf + ext * rcount * peer, true, rcount, dtype, peer, schedule, false);
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          free(tmpbuf);
+          return res;
+        }
+      }
+    } else {
+      /* receive my block */
+      res = NBC_Sched_local_recv(recvbuf, false, rcount, dtype, 0, schedule, false);
       if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
         OBJ_RELEASE(schedule);
         free(tmpbuf);
         return res;
       }
     }
-  } else {
-    /* receive my block */
-    res = NBC_Sched_local_recv(recvbuf, false, rcount, dtype, 0, schedule, false);
+
+    /*NBC_PRINT_SCHED(*schedule);*/
+
+    res = NBC_Sched_commit(schedule);
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
       OBJ_RELEASE(schedule);
       free(tmpbuf);
@@ -327,19 +346,8 @@ static int nbc_reduce_scatter_block_inter_init(const void *sendbuf, void *recvbu
     }
   }
 
-  /*NBC_PRINT_SCHED(*schedule);*/
-
-  res = NBC_Sched_commit(schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
-    return res;
-  }
-
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, tmpbuf);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    free(tmpbuf);
     return res;
   }
 
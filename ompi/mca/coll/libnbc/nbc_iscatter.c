@@ -23,27 +23,6 @@
  */
 #include "nbc_internal.h"
 
-#ifdef NBC_CACHE_SCHEDULE
-/* tree comparison function for schedule cache */
-int NBC_Scatter_args_compare(NBC_Scatter_args *a, NBC_Scatter_args *b, void *param) {
-    if ((a->sendbuf == b->sendbuf) &&
-        (a->sendcount == b->sendcount) &&
-        (a->sendtype == b->sendtype) &&
-        (a->recvbuf == b->recvbuf) &&
-        (a->recvcount == b->recvcount) &&
-        (a->recvtype == b->recvtype) &&
-        (a->root == b->root)) {
-        return 0;
-    }
-
-    if (a->sendbuf < b->sendbuf) {
-        return -1;
-    }
-
-    return 1;
-}
-#endif
-
 /* simple linear MPI_Iscatter */
 static int nbc_scatter_init (const void* sendbuf, int sendcount, MPI_Datatype sendtype,
                              void* recvbuf, int recvcount, MPI_Datatype recvtype, int root,
@@ -52,6 +31,7 @@ static int nbc_scatter_init (const void* sendbuf, int sendcount, MPI_Datatype se
   int rank, p, res;
   MPI_Aint sndext = 0;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   char *sbuf, inplace = 0;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -70,21 +50,19 @@ static int nbc_scatter_init (const void* sendbuf, int sendcount, MPI_Datatype se
     }
   }
 
-#ifdef NBC_CACHE_SCHEDULE
-  NBC_Scatter_args *args, *found, search;
-
-  /* search schedule in communicator specific tree */
-  search.sendbuf=sendbuf;
-  search.sendcount=sendcount;
-  search.sendtype=sendtype;
-  search.recvbuf=recvbuf;
-  search.recvcount=recvcount;
-  search.recvtype=recvtype;
-  search.root=root;
-  found = (NBC_Scatter_args *) hb_tree_search ((hb_tree *) libnbc_module->NBC_Dict[NBC_SCATTER], &search);
-  if (NULL == found) {
-#endif
-    schedule = OBJ_NEW(NBC_Schedule);
+  NBC_Sched_key_init(&key, NBC_SCATTER, persistent);
+  NBC_SCHED_KEY_ADD(&key, root);
+  if (rank == root) {
+    NBC_SCHED_KEY_ADD(&key, sendbuf);
+    NBC_SCHED_KEY_ADD(&key, sendcount);
+    NBC_Sched_key_add_dtype(&key, sendtype);
+  }
+  if (!inplace) {
+    NBC_SCHED_KEY_ADD(&key, recvbuf);
+    NBC_SCHED_KEY_ADD(&key, recvcount);
+    NBC_Sched_key_add_dtype(&key, recvtype);
+  }
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
     if (OPAL_UNLIKELY(NULL == schedule)) {
       return OMPI_ERR_OUT_OF_RESOURCE;
     }
@@ -126,42 +104,10 @@ static int nbc_scatter_init (const void* sendbuf, int sendcount, MPI_Datatype se
       OBJ_RELEASE(schedule);
       return res;
     }
-#ifdef NBC_CACHE_SCHEDULE
-    /* save schedule to tree */
-    args = (NBC_Scatter_args *) malloc (sizeof (args));
-    if (NULL != args) {
-      args->sendbuf = sendbuf;
-      args->sendcount = sendcount;
-      args->sendtype = sendtype;
-      args->recvbuf = recvbuf;
-      args->recvcount = recvcount;
-      args->recvtype = recvtype;
-      args->root = root;
-      args->schedule = schedule;
-      res = hb_tree_insert ((hb_tree *) libnbc_module->NBC_Dict[NBC_SCATTER], args, args, 0);
-      if (0 == res) {
-        OBJ_RETAIN(schedule);
-
-        /* increase number of elements for A2A */
-        if (++libnbc_module->NBC_Dict_size[NBC_SCATTER] > NBC_SCHED_DICT_UPPER) {
-          NBC_SchedCache_dictwipe ((hb_tree *) libnbc_module->NBC_Dict[NBC_SCATTER],
-                                   &libnbc_module->NBC_Dict_size[NBC_SCATTER]);
-        }
-      } else {
-        NBC_Error("error in dict_insert() (%i)", res);
-        free (args);
-      }
-    }
-  } else {
-    /* found schedule */
-    schedule = found->schedule;
-    OBJ_RETAIN(schedule);
   }
-#endif
 
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
     return res;
   }
 
@@ -194,6 +140,7 @@ static int nbc_scatter_inter_init (const void* sendbuf, int sendcount, MPI_Datat
     int res, rsize;
     MPI_Aint sndext;
     NBC_Schedule *schedule;
+    NBC_Sched_key key;
     char *sbuf;
     ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -207,40 +154,52 @@ static int nbc_scatter_inter_init (const void* sendbuf, int sendcount, MPI_Datat
         }
     }
 
-    schedule = OBJ_NEW(NBC_Schedule);
-    if (OPAL_UNLIKELY(NULL == schedule)) {
-        return OMPI_ERR_OUT_OF_RESOURCE;
+    NBC_Sched_key_init(&key, NBC_SCATTER, persistent);
+    NBC_SCHED_KEY_ADD(&key, root);
+    if (MPI_ROOT == root) {
+        NBC_SCHED_KEY_ADD(&key, sendbuf);
+        NBC_SCHED_KEY_ADD(&key, sendcount);
+        NBC_Sched_key_add_dtype(&key, sendtype);
     }
-
-    /* receive from root */
     if (MPI_ROOT != root && MPI_PROC_NULL != root) {
-        /* recv msg from remote root */
-        res = NBC_Sched_recv(recvbuf, false, recvcount, recvtype, root, schedule, false);
-        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-            OBJ_RELEASE(schedule);
-            return res;
-        }
-    } else if (MPI_ROOT == root) {
-        for (int i = 0 ; i < rsize ; ++i) {
-            sbuf = ((char *)sendbuf) + (i * sendcount * sndext);
-            /* root sends the right buffer to the right receiver */
-            res = NBC_Sched_send(sbuf, false, sendcount, sendtype, i, schedule, false);
-            if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-                OBJ_RELEASE(schedule);
-                return res;
-            }
-        }
+        NBC_SCHED_KEY_ADD(&key, recvbuf);
+        NBC_SCHED_KEY_ADD(&key, recvcount);
+        NBC_Sched_key_add_dtype(&key, recvtype);
     }
+    if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
+      if (OPAL_UNLIKELY(NULL == schedule)) {
+          return OMPI_ERR_OUT_OF_RESOURCE;
+      }
 
-    res = NBC_Sched_commit(schedule);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        return res;
+      /* receive from root */
+      if (MPI_ROOT != root && MPI_PROC_NULL != root) {
+          /* recv msg from remote root */
+          res = NBC_Sched_recv(recvbuf, false, recvcount, recvtype, root, schedule, false);
+          if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+              OBJ_RELEASE(schedule);
+              return res;
+          }
+      } else if (MPI_ROOT == root) {
+          for (int i = 0 ; i < rsize ; ++i) {
+              sbuf = ((char *)sendbuf) + (i * sendcount * sndext);
+              /* root sends the right buffer to the right receiver */
+              res = NBC_Sched_send(sbuf, false, sendcount, sendtype, i, schedule, false);
+              if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+                  OBJ_RELEASE(schedule);
+                  return res;
+              }
+          }
+      }
+
+      res = NBC_Sched_commit(schedule);
+      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          return res;
+      }
     }
 
     res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
         return res;
     }
 
@@ -23,10 +23,6 @@
  */
 #include "nbc_internal.h"
 
-/* a scatterv schedule can not be cached easily because the contents
- * ot the recvcounts array may change, so a comparison of the address
- * would not be sufficient ... we simply do not cache it */
-
 /* simple linear MPI_Iscatterv */
 static int nbc_scatterv_init(const void* sendbuf, const int *sendcounts, const int *displs, MPI_Datatype sendtype,
                              void* recvbuf, int recvcount, MPI_Datatype recvtype, int root,
@@ -35,6 +31,7 @@ static int nbc_scatterv_init(const void* sendbuf, const int *sendcounts, const i
   int rank, p, res;
   MPI_Aint sndext;
   NBC_Schedule *schedule;
+  NBC_Sched_key key;
   char *sbuf, inplace = 0;
   ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
@@ -45,58 +42,71 @@ static int nbc_scatterv_init(const void* sendbuf, const int *sendcounts, const i
 
   p = ompi_comm_size (comm);
 
-  schedule = OBJ_NEW(NBC_Schedule);
-  if (OPAL_UNLIKELY(NULL == schedule)) {
-    return OMPI_ERR_OUT_OF_RESOURCE;
-  }
-
-  /* receive from root */
+  NBC_Sched_key_init(&key, NBC_SCATTERV, persistent);
+  NBC_SCHED_KEY_ADD(&key, root);
   if (rank == root) {
-    res = ompi_datatype_type_extent (sendtype, &sndext);
-    if (MPI_SUCCESS != res) {
-      NBC_Error("MPI Error in ompi_datatype_type_extent() (%i)", res);
-      OBJ_RELEASE(schedule);
-      return res;
+    NBC_SCHED_KEY_ADD(&key, sendbuf);
+    NBC_Sched_key_add(&key, sendcounts, p * sizeof(int));
+    NBC_Sched_key_add(&key, displs, p * sizeof(int));
+    NBC_Sched_key_add_dtype(&key, sendtype);
+  }
+  if (!inplace) {
+    NBC_SCHED_KEY_ADD(&key, recvbuf);
+    NBC_SCHED_KEY_ADD(&key, recvcount);
+    NBC_Sched_key_add_dtype(&key, recvtype);
+  }
+  if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
+    if (OPAL_UNLIKELY(NULL == schedule)) {
+      return OMPI_ERR_OUT_OF_RESOURCE;
     }
 
-    for (int i = 0 ; i < p ; ++i) {
-      sbuf = (char *) sendbuf + displs[i] * sndext;
-      if (i == root) {
-        if (!inplace) {
-          /* if I am the root - just copy the message */
-          res = NBC_Sched_copy (sbuf, false, sendcounts[i], sendtype,
-                                recvbuf, false, recvcount, recvtype, schedule, false);
+    /* receive from root */
+    if (rank == root) {
+      res = ompi_datatype_type_extent (sendtype, &sndext);
+      if (MPI_SUCCESS != res) {
+        NBC_Error("MPI Error in ompi_datatype_type_extent() (%i)", res);
+        OBJ_RELEASE(schedule);
+        return res;
+      }
+
+      for (int i = 0 ; i < p ; ++i) {
+        sbuf = (char *) sendbuf + displs[i] * sndext;
+        if (i == root) {
+          if (!inplace) {
+            /* if I am the root - just copy the message */
+            res = NBC_Sched_copy (sbuf, false, sendcounts[i], sendtype,
+                                  recvbuf, false, recvcount, recvtype, schedule, false);
+          } else {
+            res = OMPI_SUCCESS;
+          }
         } else {
-          res = OMPI_SUCCESS;
+          /* root sends the right buffer to the right receiver */
+          res = NBC_Sched_send (sbuf, false, sendcounts[i], sendtype, i, schedule, false);
         }
-      } else {
-        /* root sends the right buffer to the right receiver */
-        res = NBC_Sched_send (sbuf, false, sendcounts[i], sendtype, i, schedule, false);
-      }
 
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          return res;
+        }
+      }
+    } else {
+      /* recv msg from root */
+      res = NBC_Sched_recv (recvbuf, false, recvcount, recvtype, root, schedule, false);
       if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
         OBJ_RELEASE(schedule);
         return res;
       }
     }
-  } else {
-    /* recv msg from root */
-    res = NBC_Sched_recv (recvbuf, false, recvcount, recvtype, root, schedule, false);
+
+    res = NBC_Sched_commit (schedule);
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
       OBJ_RELEASE(schedule);
       return res;
     }
   }
 
-  res = NBC_Sched_commit (schedule);
-  if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
-    return res;
-  }
-
   res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
   if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-    OBJ_RELEASE(schedule);
     return res;
   }
 
@@ -129,52 +139,66 @@ static int nbc_scatterv_inter_init (const void* sendbuf, const int *sendcounts,
     int res, rsize;
     MPI_Aint sndext;
     NBC_Schedule *schedule;
+    NBC_Sched_key key;
     char *sbuf;
     ompi_coll_libnbc_module_t *libnbc_module = (ompi_coll_libnbc_module_t*) module;
 
     rsize = ompi_comm_remote_size (comm);
 
-    schedule = OBJ_NEW(NBC_Schedule);
-    if (OPAL_UNLIKELY(NULL == schedule)) {
-        return OMPI_ERR_OUT_OF_RESOURCE;
+    NBC_Sched_key_init(&key, NBC_SCATTERV, persistent);
+    NBC_SCHED_KEY_ADD(&key, root);
+    if (MPI_ROOT == root) {
+        NBC_SCHED_KEY_ADD(&key, sendbuf);
+        NBC_Sched_key_add(&key, sendcounts, rsize * sizeof(int));
+        NBC_Sched_key_add(&key, displs, rsize * sizeof(int));
+        NBC_Sched_key_add_dtype(&key, sendtype);
     }
-
-    /* receive from root */
     if (MPI_ROOT != root && MPI_PROC_NULL != root) {
-        /* recv msg from root */
-        res = NBC_Sched_recv(recvbuf, false, recvcount, recvtype, root, schedule, false);
-        if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-            OBJ_RELEASE(schedule);
-            return res;
-        }
-    } else if (MPI_ROOT == root) {
-        res = ompi_datatype_type_extent(sendtype, &sndext);
-        if (MPI_SUCCESS != res) {
-            NBC_Error("MPI Error in ompi_datatype_type_extent() (%i)", res);
-            OBJ_RELEASE(schedule);
-            return res;
-        }
-
-        for (int i = 0 ; i < rsize ; ++i) {
-            sbuf = (char *)sendbuf + displs[i] * sndext;
-            /* root sends the right buffer to the right receiver */
-            res = NBC_Sched_send (sbuf, false, sendcounts[i], sendtype, i, schedule, false);
-            if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-                OBJ_RELEASE(schedule);
-                return res;
-            }
-        }
+        NBC_SCHED_KEY_ADD(&key, recvbuf);
+        NBC_SCHED_KEY_ADD(&key, recvcount);
+        NBC_Sched_key_add_dtype(&key, recvtype);
     }
+    if (!NBC_Sched_cache_get(libnbc_module, &key, &schedule, NULL)) {
+      if (OPAL_UNLIKELY(NULL == schedule)) {
+          return OMPI_ERR_OUT_OF_RESOURCE;
+      }
 
-    res = NBC_Sched_commit(schedule);
-    if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
-        return res;
+      /* receive from root */
+      if (MPI_ROOT != root && MPI_PROC_NULL != root) {
+          /* recv msg from root */
+          res = NBC_Sched_recv(recvbuf, false, recvcount, recvtype, root, schedule, false);
+          if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+              OBJ_RELEASE(schedule);
+              return res;
+          }
+      } else if (MPI_ROOT == root) {
+          res = ompi_datatype_type_extent(sendtype, &sndext);
+          if (MPI_SUCCESS != res) {
+              NBC_Error("MPI Error in ompi_datatype_type_extent() (%i)", res);
+              OBJ_RELEASE(schedule);
+              return res;
+          }
+
+          for (int i = 0 ; i < rsize ; ++i) {
+              sbuf = (char *)sendbuf + displs[i] * sndext;
+              /* root sends the right buffer to the right receiver */
+              res = NBC_Sched_send (sbuf, false, sendcounts[i], sendtype, i, schedule, false);
+              if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+                  OBJ_RELEASE(schedule);
+                  return res;
+              }
+          }
+      }
+
+      res = NBC_Sched_commit(schedule);
+      if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
+          OBJ_RELEASE(schedule);
+          return res;
+      }
     }
 
     res = NBC_Schedule_request(schedule, comm, libnbc_module, persistent, request, NULL);
     if (OPAL_UNLIKELY(OMPI_SUCCESS != res)) {
-        OBJ_RELEASE(schedule);
         return res;
     }
 
@@ -117,6 +117,10 @@ BEGIN_C_DECLS
         opal_atomic_uint32_t mcsiuf_num_procs_using;
         /** Must match data->mcb_count */
         volatile uint32_t mcsiuf_operation_count;
+        /** Number of processes that have copied their contribution
+            into the segments (used by the operations where every
+            process contributes data, e.g., allgather) */
+        opal_atomic_uint32_t mcsiuf_num_procs_ready;
     } mca_coll_sm_in_use_flag_t;
 
     /**
@@ -270,7 +274,7 @@ BEGIN_C_DECLS
 				 struct ompi_op_t *op,
 				 struct ompi_communicator_t *comm,
 				 mca_coll_base_module_t *module);
-    int mca_coll_sm_gather_intra(void *sbuf, int scount,
+    int mca_coll_sm_gather_intra(const void *sbuf, int scount,
 				 struct ompi_datatype_t *sdtype, void *rbuf,
 				 int rcount, struct ompi_datatype_t *rdtype,
 				 int root, struct ompi_communicator_t *comm,
@@ -360,6 +364,98 @@ extern uint32_t mca_coll_sm_one;
 #define FLAG_RELEASE(flag) \
     opal_atomic_add(&(flag)->mcsiuf_num_procs_using, -1)
 
+/**
+ * Macro to claim an in-use flag for an operation where the
+ * participating processes also signal, through the flag, that their
+ * contribution has been copied in (see FLAG_SIGNAL_READY).  The
+ * operation count is written last so that the other processes cannot
+ * see the flag as theirs before it is fully set up.
+ */
+#define FLAG_RETAIN_READY(flag, num_procs, op_count) \
+    do { \
+        (flag)->mcsiuf_num_procs_ready = 0; \
+        (flag)->mcsiuf_num_procs_using = (num_procs); \
+        opal_atomic_wmb(); \
+        (flag)->mcsiuf_operation_count = (op_count); \
+    } while (0)
+
+/**
+ * Macro to tell the other processes that this process' contribution
+ * to the segments protected by the flag has been copied in
+ */
+#define FLAG_SIGNAL_READY(flag) \
+    do { \
+        opal_atomic_wmb(); \
+        opal_atomic_add(&(flag)->mcsiuf_num_procs_ready, 1); \
+    } while (0)
+
+/**
+ * Macro to wait until num_procs processes have signaled, through
+ * FLAG_SIGNAL_READY, that their contribution has been copied in
+ */
+#define FLAG_WAIT_FOR_READY(flag, num_procs, label) \
+    SPIN_CONDITION((uint32_t) (num_procs) == (flag)->mcsiuf_num_procs_ready, label); \
+    opal_atomic_rmb()
+
+/**
+ * Each process owns one fragment in every segment.  The fragments a
+ * process owns in all the segments protected by one in-use flag form
+ * its "area" for that flag: sm_segs_per_inuse_flag *
+ * sm_fragment_size bytes, which are not contiguous in memory.  This
+ * function packs into (or unpacks from) the bytes [offset, offset +
+ * len) of the area of the given rank, one fragment at a time.
+ */
+static inline void mca_coll_sm_area_copy(mca_coll_sm_comm_t *data,
+                                         int flag_num, int rank,
+                                         size_t offset, size_t len,
+                                         opal_convertor_t *convertor,
+                                         bool pack)
+{
+    size_t frag_size = (size_t) mca_coll_sm_component.sm_fragment_size;
+    int segment_num = flag_num * mca_coll_sm_component.sm_segs_per_inuse_flag +
+        (int) (offset / frag_size);
+    struct iovec iov;
+    uint32_t iov_count;
+    size_t max_data;
+
+    offset %= frag_size;
+    while (len > 0) {
+        iov.iov_base = data->mcb_data_index[segment_num].mcbmi_data +
+            (rank * frag_size) + offset;
+        iov.iov_len = frag_size - offset;
+        if (iov.iov_len > len) {
+            iov.iov_len = len;
+        }
+        max_data = iov.iov_len;
+        iov_count = 1;
+        if (pack) {
+            opal_convertor_pack(convertor, &iov, &iov_count, &max_data);
+        } else {
+            opal_convertor_unpack(convertor, &iov, &iov_count, &max_data);
+        }
+        len -= iov.iov_len;
+        offset = 0;
+        ++segment_num;
+    }
+}
+
+/**
+ * Size of the part of its area that a process reserves for each
+ * destination in alltoall (rounded down to a cache line when
+ * possible).  Zero means that the segments are too small for this
+ * communicator size.
+ */
+static inline size_t mca_coll_sm_alltoall_part_size(int comm_size)
+{
+    size_t part_size = ((size_t) mca_coll_sm_component.sm_segs_per_inuse_flag *
+                        mca_coll_sm_component.sm_fragment_size) / comm_size;
+
+    if (part_size >= 64) {
+        part_size &= ~((size_t) 63);
+    }
+    return part_size;
+}
+
 /**
  * Macro to copy a single segment in from a user buffer to a shared
  * segment
@@ -20,16 +20,32 @@
 
 #include "ompi_config.h"
 
+#include <string.h>
+
+#include "opal/datatype/opal_convertor.h"
+#include "opal/sys/atomic.h"
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/coll.h"
 #include "coll_sm.h"
 
 
-/*
- *	allgather
+/**
+ * Shared memory allgather.
  *
- *	Function:	- allgather
- *	Accepts:	- same as MPI_Allgather()
- *	Returns:	- MPI_SUCCESS or error code
+ * The data is exchanged in rounds, one round per set of segments
+ * (i.e., per in-use flag).  In each round, every process copies the
+ * next chunk of its contribution into its own area of the set (its
+ * fragment in each of the segments) and signals that it is ready.
+ * Once all processes are ready, each process copies the chunk of
+ * every other process out of their areas into its receive buffer,
+ * and then releases the flag.
+ *
+ * Rank 0 is in charge of claiming the in-use flag for each round: it
+ * waits for all the processes to be done with the previous operation
+ * that used the same set of segments.  The other processes wait for
+ * rank 0 to write the current operation number into the flag.
  */
 int mca_coll_sm_allgather_intra(const void *sbuf, int scount,
                                 struct ompi_datatype_t *sdtype, void *rbuf,
@@ -37,5 +53,112 @@ int mca_coll_sm_allgather_intra(const void *sbuf, int scount,
                                 struct ompi_communicator_t *comm,
                                 mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_comm_t *data;
+    mca_coll_sm_in_use_flag_t *flag;
+    opal_convertor_t send_convertor, recv_convertor;
+    int i, ret, rank, size, peer, flag_num;
+    uint32_t op_count;
+    size_t total_size, area_size, offset, chunk, position;
+    ptrdiff_t lb, extent, block;
+    bool in_place = (MPI_IN_PLACE == sbuf);
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!sm_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_sm_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    data = sm_module->sm_comm_data;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+
+    ompi_datatype_type_size(rdtype, &total_size);
+    total_size *= rcount;
+    if (0 == total_size) {
+        return OMPI_SUCCESS;
+    }
+    ompi_datatype_get_extent(rdtype, &lb, &extent);
+    block = extent * (ptrdiff_t) rcount;
+    area_size = (size_t) mca_coll_sm_component.sm_segs_per_inuse_flag *
+        mca_coll_sm_component.sm_fragment_size;
+
+    /* With MPI_IN_PLACE, my contribution is already in its place in
+       the receive buffer */
+    if (in_place) {
+        sbuf = (char*) rbuf + rank * block;
+        sdtype = rdtype;
+        scount = rcount;
+    }
+
+    OBJ_CONSTRUCT(&send_convertor, opal_convertor_t);
+    OBJ_CONSTRUCT(&recv_convertor, opal_convertor_t);
+    if (OMPI_SUCCESS !=
+        (ret = opal_convertor_copy_and_prepare_for_send(ompi_mpi_local_convertor,
+                                                        &(sdtype->super),
+                                                        scount, sbuf, 0,
+                                                        &send_convertor))) {
+        goto cleanup;
+    }
+
+    for (offset = 0; offset < total_size; offset += chunk) {
+        chunk = total_size - offset;
+        if (chunk > area_size) {
+            chunk = area_size;
+        }
+
+        op_count = data->mcb_operation_count++;
+        flag_num = (int) (op_count % mca_coll_sm_component.sm_comm_num_in_use_flags);
+        FLAG_SETUP(flag_num, flag, data);
+        if (0 == rank) {
+            FLAG_WAIT_FOR_IDLE(flag, allgather_idle_label);
+            FLAG_RETAIN_READY(flag, size, op_count);
+        } else {
+            FLAG_WAIT_FOR_OP(flag, op_count, allgather_op_label);
+        }
+
+        /* Copy my chunk into my area and tell everybody */
+        mca_coll_sm_area_copy(data, flag_num, rank, 0, chunk,
+                              &send_convertor, true);
+        FLAG_SIGNAL_READY(flag);
+        FLAG_WAIT_FOR_READY(flag, size, allgather_ready_label);
+
+        /* Copy everybody's chunk out.  Start with the next peer so
+           that all the processes don't read from the same area at
+           the same time. */
+        for (i = 1; i <= size; ++i) {
+            peer = (rank + i) % size;
+            if (peer == rank && in_place) {
+                continue;
+            }
+            if (OMPI_SUCCESS !=
+                (ret = opal_convertor_copy_and_prepare_for_recv(ompi_mpi_local_convertor,
+                                                                &(rdtype->super),
+                                                                rcount,
+                                                                (char*) rbuf + peer * block,
+                                                                0, &recv_convertor))) {
+                goto cleanup;
+            }
+            if (0 != offset) {
+                position = offset;
+                opal_convertor_set_position(&recv_convertor, &position);
+            }
+            mca_coll_sm_area_copy(data, flag_num, peer, 0, chunk,
+                                  &recv_convertor, false);
+            opal_convertor_cleanup(&recv_convertor);
+        }
+
+        /* Wait for all copy-out writes to complete before I say I'm
+           done with the segments */
+        opal_atomic_wmb();
+        FLAG_RELEASE(flag);
+    }
+    ret = OMPI_SUCCESS;
+
+ cleanup:
+    OBJ_DESTRUCT(&recv_convertor);
+    OBJ_DESTRUCT(&send_convertor);
+    return ret;
 }
@@ -20,22 +20,148 @@
 
 #include "ompi_config.h"
 
+#include <string.h>
+
+#include "opal/datatype/opal_convertor.h"
+#include "opal/sys/atomic.h"
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/coll.h"
 #include "coll_sm.h"
 
 
-/*
- *	alltoall_intra
+/**
+ * Shared memory alltoall.
  *
- *	Function:	- MPI_Alltoall
- *	Accepts:	- same as MPI_Alltoall()
- *	Returns:	- MPI_SUCCESS or an MPI error code
+ * Same scheme as the allgather (see coll_sm_allgather.c), except that
+ * the area of each process in a set of segments is divided in
+ * comm_size equal parts, one per destination.  In each round, every
+ * process copies the next chunk of the data for each destination into
+ * the corresponding part of its own area, signals that it is ready,
+ * waits for everybody else, and then copies its part out of the area
+ * of every other process.
+ *
+ * Because all the data of a round is copied in before any of it is
+ * copied out, the same loop also handles MPI_IN_PLACE.
  */
 int mca_coll_sm_alltoall_intra(const void *sbuf, int scount,
-                               struct ompi_datatype_t *sdtype, void *rbuf,
-                               int rcount, struct ompi_datatype_t *rdtype,
+                               struct ompi_datatype_t *sdtype,
+                               void* rbuf, int rcount,
+                               struct ompi_datatype_t *rdtype,
                                struct ompi_communicator_t *comm,
-                                mca_coll_base_module_t *module)
+                               mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_comm_t *data;
+    mca_coll_sm_in_use_flag_t *flag;
+    opal_convertor_t convertor;
+    int i, ret, rank, size, peer, flag_num;
+    uint32_t op_count;
+    size_t total_size, part_size, offset, chunk, position;
+    ptrdiff_t lb, extent, sblock, rblock;
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!sm_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_sm_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    data = sm_module->sm_comm_data;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+
+    ompi_datatype_type_size(rdtype, &total_size);
+    total_size *= rcount;
+    if (0 == total_size) {
+        return OMPI_SUCCESS;
+    }
+
+    if (MPI_IN_PLACE == sbuf) {
+        sbuf = rbuf;
+        sdtype = rdtype;
+        scount = rcount;
+    }
+    ompi_datatype_get_extent(sdtype, &lb, &extent);
+    sblock = extent * (ptrdiff_t) scount;
+    ompi_datatype_get_extent(rdtype, &lb, &extent);
+    rblock = extent * (ptrdiff_t) rcount;
+
+    /* mca_coll_sm_comm_query() only selects this function if every
+       destination gets at least one byte per round */
+    part_size = mca_coll_sm_alltoall_part_size(size);
+
+    OBJ_CONSTRUCT(&convertor, opal_convertor_t);
+    for (offset = 0; offset < total_size; offset += chunk) {
+        chunk = total_size - offset;
+        if (chunk > part_size) {
+            chunk = part_size;
+        }
+        position = offset;
+
+        op_count = data->mcb_operation_count++;
+        flag_num = (int) (op_count % mca_coll_sm_component.sm_comm_num_in_use_flags);
+        FLAG_SETUP(flag_num, flag, data);
+        if (0 == rank) {
+            FLAG_WAIT_FOR_IDLE(flag, alltoall_idle_label);
+            FLAG_RETAIN_READY(flag, size, op_count);
+        } else {
+            FLAG_WAIT_FOR_OP(flag, op_count, alltoall_op_label);
+        }
+
+        /* Copy the chunk for each destination into my area */
+        for (peer = 0; peer < size; ++peer) {
+            if (OMPI_SUCCESS !=
+                (ret = opal_convertor_copy_and_prepare_for_send(ompi_mpi_local_convertor,
+                                                                &(sdtype->super),
+                                                                scount,
+                                                                (char*) sbuf + peer * sblock,
+                                                                0, &convertor))) {
+                goto cleanup;
+            }
+            if (0 != offset) {
+                opal_convertor_set_position(&convertor, &position);
+                position = offset;
+            }
+            mca_coll_sm_area_copy(data, flag_num, rank, peer * part_size,
+                                  chunk, &convertor, true);
+            opal_convertor_cleanup(&convertor);
+        }
+        FLAG_SIGNAL_READY(flag);
+        FLAG_WAIT_FOR_READY(flag, size, alltoall_ready_label);
+
+        /* Copy my part out of everybody's area, starting with the
+           next peer so that all the processes don't read from the
+           same area at the same time */
+        for (i = 1; i <= size; ++i) {
+            peer = (rank + i) % size;
+            if (OMPI_SUCCESS !=
+                (ret = opal_convertor_copy_and_prepare_for_recv(ompi_mpi_local_convertor,
+                                                                &(rdtype->super),
+                                                                rcount,
+                                                                (char*) rbuf + peer * rblock,
+                                                                0, &convertor))) {
+                goto cleanup;
+            }
+            if (0 != offset) {
+                opal_convertor_set_position(&convertor, &position);
+                position = offset;
+            }
+            mca_coll_sm_area_copy(data, flag_num, peer, rank * part_size,
+                                  chunk, &convertor, false);
+            opal_convertor_cleanup(&convertor);
+        }
+
+        /* Wait for all copy-out writes to complete before I say I'm
+           done with the segments */
+        opal_atomic_wmb();
+        FLAG_RELEASE(flag);
+    }
+    ret = OMPI_SUCCESS;
+
+ cleanup:
+    OBJ_DESTRUCT(&convertor);
+    return ret;
 }
@@ -20,16 +20,31 @@
 
 #include "ompi_config.h"
 
+#include <string.h>
+
+#include "opal/datatype/opal_convertor.h"
+#include "opal/sys/atomic.h"
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/coll.h"
 #include "coll_sm.h"
 
 
-/*
- *      gather
+/**
+ * Shared memory gather.
  *
- *      Function:       - shared memory gather
- *      Accepts:        - same as MPI_Gather()
- *      Returns:        - MPI_SUCCESS or error code
+ * The data is gathered in rounds, one round per set of segments
+ * (i.e., per in-use flag).  For each round, the root waits for the
+ * previous operation that used the same set of segments to be done,
+ * and claims the flag.  Each non-root process waits for the flag to
+ * be claimed, copies the next chunk of its data into its own area of
+ * the set (its fragment in each of the segments) and signals that it
+ * is ready.  The root waits for all the non-root processes to be
+ * ready, copies their chunks out into its receive buffer and releases
+ * the flag.  The non-root processes never have to wait for the root
+ * to be done reading: the next round that uses the same set of
+ * segments will not start until the flag has been released.
  */
 int mca_coll_sm_gather_intra(const void *sbuf, int scount,
                              struct ompi_datatype_t *sdtype, void *rbuf,
@@ -37,5 +52,125 @@ int mca_coll_sm_gather_intra(const void *sbuf, int scount,
                              int root, struct ompi_communicator_t *comm,
                              mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_comm_t *data;
+    mca_coll_sm_in_use_flag_t *flag;
+    opal_convertor_t convertor;
+    int ret, rank, size, peer, flag_num;
+    uint32_t op_count;
+    size_t total_size, area_size, offset, chunk, position;
+    ptrdiff_t lb, extent, block;
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!sm_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_sm_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    data = sm_module->sm_comm_data;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+    area_size = (size_t) mca_coll_sm_component.sm_segs_per_inuse_flag *
+        mca_coll_sm_component.sm_fragment_size;
+
+    OBJ_CONSTRUCT(&convertor, opal_convertor_t);
+
+    /*********************************************************************
+     * Root
+     *********************************************************************/
+
+    if (root == rank) {
+        ompi_datatype_type_size(rdtype, &total_size);
+        total_size *= rcount;
+        ompi_datatype_get_extent(rdtype, &lb, &extent);
+        block = extent * (ptrdiff_t) rcount;
+
+        /* My own contribution does not go through shared memory */
+        if (MPI_IN_PLACE != sbuf) {
+            ret = ompi_datatype_sndrcv(sbuf, scount, sdtype,
+                                       (char*) rbuf + rank * block, rcount, rdtype);
+            if (OMPI_SUCCESS != ret) {
+                goto cleanup;
+            }
+        }
+
+        for (offset = 0; offset < total_size; offset += chunk) {
+            chunk = total_size - offset;
+            if (chunk > area_size) {
+                chunk = area_size;
+            }
+
+            op_count = data->mcb_operation_count++;
+            flag_num = (int) (op_count % mca_coll_sm_component.sm_comm_num_in_use_flags);
+            FLAG_SETUP(flag_num, flag, data);
+            FLAG_WAIT_FOR_IDLE(flag, gather_root_label1);
+            FLAG_RETAIN_READY(flag, 1, op_count);
+
+            FLAG_WAIT_FOR_READY(flag, size - 1, gather_root_label2);
+            for (peer = 0; peer < size; ++peer) {
+                if (peer == root) {
+                    continue;
+                }
+                if (OMPI_SUCCESS !=
+                    (ret = opal_convertor_copy_and_prepare_for_recv(ompi_mpi_local_convertor,
+                                                                    &(rdtype->super),
+                                                                    rcount,
+                                                                    (char*) rbuf + peer * block,
+                                                                    0, &convertor))) {
+                    goto cleanup;
+                }
+                if (0 != offset) {
+                    position = offset;
+                    opal_convertor_set_position(&convertor, &position);
+                }
+                mca_coll_sm_area_copy(data, flag_num, peer, 0, chunk,
+                                      &convertor, false);
+                opal_convertor_cleanup(&convertor);
+            }
+
+            /* Wait for all copy-out writes to complete before I say
+               I'm done with the segments */
+            opal_atomic_wmb();
+            FLAG_RELEASE(flag);
+        }
+    }
+
+    /*********************************************************************
+     * Non-root
+     *********************************************************************/
+
+    else {
+        ompi_datatype_type_size(sdtype, &total_size);
+        total_size *= scount;
+        if (OMPI_SUCCESS !=
+            (ret = opal_convertor_copy_and_prepare_for_send(ompi_mpi_local_convertor,
+                                                            &(sdtype->super),
+                                                            scount, sbuf, 0,
+                                                            &convertor))) {
+            goto cleanup;
+        }
+
+        for (offset = 0; offset < total_size; offset += chunk) {
+            chunk = total_size - offset;
+            if (chunk > area_size) {
+                chunk = area_size;
+            }
+
+            op_count = data->mcb_operation_count++;
+            flag_num = (int) (op_count % mca_coll_sm_component.sm_comm_num_in_use_flags);
+            FLAG_SETUP(flag_num, flag, data);
+            FLAG_WAIT_FOR_OP(flag, op_count, gather_nonroot_label);
+
+            mca_coll_sm_area_copy(data, flag_num, rank, 0, chunk,
+                                  &convertor, true);
+            FLAG_SIGNAL_READY(flag);
+        }
+    }
+    ret = OMPI_SUCCESS;
+
+ cleanup:
+    OBJ_DESTRUCT(&convertor);
+    return ret;
 }
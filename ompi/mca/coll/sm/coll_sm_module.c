@@ -196,21 +196,24 @@ mca_coll_sm_comm_query(struct ompi_communicator_t *comm, int *priority)
     /* All is good -- return a module */
     sm_module->super.coll_module_enable = sm_module_enable;
     sm_module->super.ft_event        = mca_coll_sm_ft_event;
-    sm_module->super.coll_allgather  = NULL;
+    sm_module->super.coll_allgather  = mca_coll_sm_allgather_intra;
     sm_module->super.coll_allgatherv = NULL;
     sm_module->super.coll_allreduce  = mca_coll_sm_allreduce_intra;
-    sm_module->super.coll_alltoall   = NULL;
+    /* Every peer must get a non-empty slice of the sender's area */
+    sm_module->super.coll_alltoall   =
+        (mca_coll_sm_alltoall_part_size(ompi_comm_size(comm)) > 0) ?
+        mca_coll_sm_alltoall_intra : NULL;
     sm_module->super.coll_alltoallv  = NULL;
     sm_module->super.coll_alltoallw  = NULL;
     sm_module->super.coll_barrier    = mca_coll_sm_barrier_intra;
     sm_module->super.coll_bcast      = mca_coll_sm_bcast_intra;
     sm_module->super.coll_exscan     = NULL;
-    sm_module->super.coll_gather     = NULL;
+    sm_module->super.coll_gather     = mca_coll_sm_gather_intra;
     sm_module->super.coll_gatherv    = NULL;
     sm_module->super.coll_reduce     = mca_coll_sm_reduce_intra;
     sm_module->super.coll_reduce_scatter = NULL;
     sm_module->super.coll_scan       = NULL;
-    sm_module->super.coll_scatter    = NULL;
+    sm_module->super.coll_scatter    = mca_coll_sm_scatter_intra;
     sm_module->super.coll_scatterv   = NULL;
 
     opal_output_verbose(10, ompi_coll_base_framework.framework_output,
@@ -405,14 +408,21 @@ int ompi_coll_sm_lazy_enable(mca_coll_base_module_t *module,
         maffinity[j].mbs_start_addr = base;
         maffinity[j].mbs_len = c->sm_control_size *
             c->sm_comm_num_in_use_flags;
-        /* Set the op counts to 1 (actually any nonzero value will do)
-           so that the first time children/leaf processes come
-           through, they don't see a value of 0 and think that the
-           root/parent has already set the count to their op number
-           (i.e., 0 is the first op count value). */
+        /* Set the op counts to a value that none of the first
+           operations can have, so that the first time children/leaf
+           processes come through, they don't think that the
+           root/parent has already set the count to their op number.
+           Operation counts start at 0, and the first use of flag i is
+           by operation i, so ~0 is only reached after every flag has
+           been claimed at least once.  The operations where every
+           process signals readiness through the flag depend on this:
+           a process that passed FLAG_WAIT_FOR_OP before the root
+           claimed the flag would have its ready signal reset by
+           FLAG_RETAIN_READY. */
         for (i = 0; i < mca_coll_sm_component.sm_comm_num_in_use_flags; ++i) {
-            ((mca_coll_sm_in_use_flag_t *)base)[i].mcsiuf_operation_count = 1;
+            ((mca_coll_sm_in_use_flag_t *)base)[i].mcsiuf_operation_count = UINT32_MAX;
             ((mca_coll_sm_in_use_flag_t *)base)[i].mcsiuf_num_procs_using = 0;
+            ((mca_coll_sm_in_use_flag_t *)base)[i].mcsiuf_num_procs_ready = 0;
         }
         ++j;
     }
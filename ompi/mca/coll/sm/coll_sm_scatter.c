@@ -20,16 +20,29 @@
 
 #include "ompi_config.h"
 
+#include <string.h>
+
+#include "opal/datatype/opal_convertor.h"
+#include "opal/sys/atomic.h"
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/coll.h"
 #include "coll_sm.h"
 
 
-/*
- *      scatter
+/**
+ * Shared memory scatter.
  *
- *      Function:       - shared memory reduce
- *      Accepts:        - same as MPI_Scatter()
- *      Returns:        - MPI_SUCCESS or error code
+ * The data is scattered in rounds, one round per set of segments
+ * (i.e., per in-use flag).  For each round, the root waits for the
+ * previous operation that used the same set of segments to be done,
+ * copies the next chunk of the data of each non-root process into the
+ * area of that process in the set (its fragment in each of the
+ * segments) and only then claims the flag: seeing the current
+ * operation number in the flag tells the non-root processes that
+ * their data is ready.  Each non-root process copies its chunk out
+ * into its receive buffer and releases the flag.
  */
 int mca_coll_sm_scatter_intra(const void *sbuf, int scount,
                               struct ompi_datatype_t *sdtype, void *rbuf,
@@ -37,5 +50,127 @@ int mca_coll_sm_scatter_intra(const void *sbuf, int scount,
                               int root, struct ompi_communicator_t *comm,
                               mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_comm_t *data;
+    mca_coll_sm_in_use_flag_t *flag;
+    opal_convertor_t convertor;
+    int ret, rank, size, peer, flag_num;
+    uint32_t op_count;
+    size_t total_size, area_size, offset, chunk, position;
+    ptrdiff_t lb, extent, block;
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!sm_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_sm_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    data = sm_module->sm_comm_data;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+    area_size = (size_t) mca_coll_sm_component.sm_segs_per_inuse_flag *
+        mca_coll_sm_component.sm_fragment_size;
+
+    OBJ_CONSTRUCT(&convertor, opal_convertor_t);
+
+    /*********************************************************************
+     * Root
+     *********************************************************************/
+
+    if (root == rank) {
+        ompi_datatype_type_size(sdtype, &total_size);
+        total_size *= scount;
+        ompi_datatype_get_extent(sdtype, &lb, &extent);
+        block = extent * (ptrdiff_t) scount;
+
+        /* My own data does not go through shared memory */
+        if (MPI_IN_PLACE != rbuf) {
+            ret = ompi_datatype_sndrcv((char*) sbuf + rank * block, scount, sdtype,
+                                       rbuf, rcount, rdtype);
+            if (OMPI_SUCCESS != ret) {
+                goto cleanup;
+            }
+        }
+
+        for (offset = 0; offset < total_size; offset += chunk) {
+            chunk = total_size - offset;
+            if (chunk > area_size) {
+                chunk = area_size;
+            }
+
+            op_count = data->mcb_operation_count++;
+            flag_num = (int) (op_count % mca_coll_sm_component.sm_comm_num_in_use_flags);
+            FLAG_SETUP(flag_num, flag, data);
+            FLAG_WAIT_FOR_IDLE(flag, scatter_root_label);
+
+            for (peer = 0; peer < size; ++peer) {
+                if (peer == root) {
+                    continue;
+                }
+                if (OMPI_SUCCESS !=
+                    (ret = opal_convertor_copy_and_prepare_for_send(ompi_mpi_local_convertor,
+                                                                    &(sdtype->super),
+                                                                    scount,
+                                                                    (char*) sbuf + peer * block,
+                                                                    0, &convertor))) {
+                    goto cleanup;
+                }
+                if (0 != offset) {
+                    position = offset;
+                    opal_convertor_set_position(&convertor, &position);
+                }
+                mca_coll_sm_area_copy(data, flag_num, peer, 0, chunk,
+                                      &convertor, true);
+                opal_convertor_cleanup(&convertor);
+            }
+
+            /* Publishing the operation number tells everybody that
+               the data is there */
+            FLAG_RETAIN_READY(flag, size - 1, op_count);
+        }
+    }
+
+    /*********************************************************************
+     * Non-root
+     *********************************************************************/
+
+    else {
+        ompi_datatype_type_size(rdtype, &total_size);
+        total_size *= rcount;
+        if (OMPI_SUCCESS !=
+            (ret = opal_convertor_copy_and_prepare_for_recv(ompi_mpi_local_convertor,
+                                                            &(rdtype->super),
+                                                            rcount, rbuf, 0,
+                                                            &convertor))) {
+            goto cleanup;
+        }
+
+        for (offset = 0; offset < total_size; offset += chunk) {
+            chunk = total_size - offset;
+            if (chunk > area_size) {
+                chunk = area_size;
+            }
+
+            op_count = data->mcb_operation_count++;
+            flag_num = (int) (op_count % mca_coll_sm_component.sm_comm_num_in_use_flags);
+            FLAG_SETUP(flag_num, flag, data);
+            FLAG_WAIT_FOR_OP(flag, op_count, scatter_nonroot_label);
+            opal_atomic_rmb();
+
+            mca_coll_sm_area_copy(data, flag_num, rank, 0, chunk,
+                                  &convertor, false);
+
+            /* Wait for all copy-out writes to complete before I say
+               I'm done with the segments */
+            opal_atomic_wmb();
+            FLAG_RELEASE(flag);
+        }
+    }
+    ret = OMPI_SUCCESS;
+
+ cleanup:
+    OBJ_DESTRUCT(&convertor);
+    return ret;
 }
@@ -584,8 +584,16 @@ int ompi_coll_tuned_gather_intra_dec_dynamic(const void *sbuf, int scount,
         int comsize, alg, faninout, segsize, max_requests;
         size_t dsize;
 
+        /* same block size as the fixed decision: only the root's
+           receive signature is significant on the root */
         comsize = ompi_comm_size(comm);
-        ompi_datatype_type_size (sdtype, &dsize);
+        if (ompi_comm_rank(comm) == root) {
+            ompi_datatype_type_size (rdtype, &dsize);
+            dsize *= (ptrdiff_t)rcount;
+        } else {
+            ompi_datatype_type_size (sdtype, &dsize);
+            dsize *= (ptrdiff_t)scount;
+        }
         dsize *= comsize;
 
         alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[GATHER],
@@ -633,8 +641,16 @@ int ompi_coll_tuned_scatter_intra_dec_dynamic(const void *sbuf, int scount,
         int comsize, alg, faninout, segsize, max_requests;
         size_t dsize;
 
+        /* same block size as the fixed decision: only the root's
+           send signature is significant on the root */
         comsize = ompi_comm_size(comm);
-        ompi_datatype_type_size (sdtype, &dsize);
+        if (ompi_comm_rank(comm) == root) {
+            ompi_datatype_type_size (sdtype, &dsize);
+            dsize *= (ptrdiff_t)scount;
+        } else {
+            ompi_datatype_type_size (rdtype, &dsize);
+            dsize *= (ptrdiff_t)rcount;
+        }
         dsize *= comsize;
 
         alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[SCATTER],
@@ -683,7 +699,7 @@ int ompi_coll_tuned_exscan_intra_dec_dynamic(const void *sbuf, void* rbuf, int c
 
         comsize = ompi_comm_size(comm);
         ompi_datatype_type_size (dtype, &dsize);
-        dsize *= comsize;
+        dsize *= (ptrdiff_t)comsize * (ptrdiff_t)count;
 
         alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[EXSCAN],
                                                         dsize, &faninout, &segsize, &max_requests);
@@ -726,7 +742,7 @@ int ompi_coll_tuned_scan_intra_dec_dynamic(const void *sbuf, void* rbuf, int cou
 
         comsize = ompi_comm_size(comm);
         ompi_datatype_type_size (dtype, &dsize);
-        dsize *= comsize;
+        dsize *= (ptrdiff_t)comsize * (ptrdiff_t)count;
 
         alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[SCAN],
                                                         dsize, &faninout, &segsize, &max_requests);
@@ -67,6 +67,7 @@
 #define OMPIO_LOCK_NEVER             0x00000100
 #define OMPIO_LOCK_NOT_THIS_OP       0x00000200
 #define OMPIO_DATAREP_NATIVE         0x00000400
+#define OMPIO_DIRECT_IO              0x00000800
 
 #define OMPIO_ROOT                    0
 
@@ -99,6 +100,7 @@
 
 #define OMPIO_PERM_NULL               -1
 #define OMPIO_IOVEC_INITIAL_SIZE      100
+#define OMPIO_DECODE_CACHE_SIZE         4
 
 enum ompio_fs_type
 {
@@ -128,6 +130,16 @@ typedef struct mca_common_ompio_access_array_t{
 } mca_common_ompio_access_array_t;
 
 
+/* memory datatype decoded by mca_common_ompio_decode_datatype, kept on
+   the file handle with the iovecs relative to the user buffer */
+typedef struct mca_common_ompio_decoded_type_t {
+    struct ompi_datatype_t *datatype;
+    int                     count;
+    size_t                  max_data;
+    uint32_t                iov_count;
+    struct iovec           *iov;
+} mca_common_ompio_decoded_type_t;
+
 /* forward declaration to keep the compiler happy. */
 struct ompio_file_t;
 typedef int (*mca_common_ompio_generate_current_file_view_fn_t) (struct ompio_file_t *fh,
@@ -148,6 +160,7 @@ struct mca_common_ompio_print_queue;
 struct ompio_file_t {
     /* General parameters */
     int                    fd;
+    int                    f_direct_fd; /* same file opened with O_DIRECT, -1 if none */
     struct ompi_file_t    *f_fh;     /* pointer back to the file_t structure */
     OMPI_MPI_OFFSET_TYPE   f_offset; /* byte offset of current position */
     OMPI_MPI_OFFSET_TYPE   f_disp;   /* file_view displacement */
@@ -181,6 +194,7 @@ struct ompio_file_t {
     /* File View parameters */
     struct iovec     *f_decoded_iov;
     uint32_t          f_iov_count;
+    size_t           *f_iov_offsets; /* bytes of the file view before each f_decoded_iov entry */
     ompi_datatype_t  *f_iov_type;
     size_t            f_position_in_file_view; /* in bytes */
     size_t            f_total_bytes; /* total bytes read/written within 1 Fview*/
@@ -192,6 +206,10 @@ struct ompio_file_t {
     ompi_datatype_t  *f_orig_filetype; /* the fileview passed by the user to us */
     size_t            f_etype_size;
 
+    /* recently decoded memory datatypes */
+    mca_common_ompio_decoded_type_t f_decoded_types[OMPIO_DECODE_CACHE_SIZE];
+    int               f_decoded_types_next;
+
     /* contains IO requests that needs to be read/written */
     mca_common_ompio_io_array_t *f_io_array;
     int                      f_num_of_io_entries;
@@ -19,6 +19,8 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+
 #include "opal/datatype/opal_convertor.h"
 #include "opal/datatype/opal_datatype_cuda.h"
 #include "opal/mca/common/cuda/common_cuda.h"
@@ -39,6 +41,21 @@ static int32_t  mca_common_ompio_pagesize=4096;
 static void* mca_common_ompio_buffer_alloc_seg ( void *ctx, size_t *size );
 static void mca_common_ompio_buffer_free_seg ( void *ctx, void *buf );
 
+/* Aligned buffers used for direct I/O. Allocating and touching a large
+** aligned buffer for every write costs more than the write itself, so
+** released buffers are kept and handed out again. All accesses are
+** protected by mca_common_ompio_buffer_mutex.
+*/
+#define OMPIO_ALIGNED_POOL_SIZE 8
+
+struct mca_common_ompio_aligned_buf_t {
+    void   *buf;
+    size_t  size;
+    size_t  alignment;
+    bool    in_use;
+};
+static struct mca_common_ompio_aligned_buf_t mca_common_ompio_aligned_pool[OMPIO_ALIGNED_POOL_SIZE];
+
 #if OPAL_CUDA_SUPPORT
 void mca_common_ompio_check_gpu_buf ( ompio_file_t *fh, const void *buf, int *is_gpu, 
 				      int *is_managed)
@@ -124,10 +141,21 @@ int mca_common_ompio_buffer_alloc_init ( void )
 
 int mca_common_ompio_buffer_alloc_fini ( void )
 {
+    int i;
+
     if ( NULL != mca_common_ompio_allocator ) {
         OPAL_THREAD_LOCK (&mca_common_ompio_buffer_mutex);
         mca_common_ompio_allocator->alc_finalize(mca_common_ompio_allocator);
         mca_common_ompio_allocator=NULL;
+        for ( i = 0; i < OMPIO_ALIGNED_POOL_SIZE; i++ ) {
+            /* buffers still in use are freed by their owner on release */
+            if ( NULL != mca_common_ompio_aligned_pool[i].buf &&
+                 !mca_common_ompio_aligned_pool[i].in_use ) {
+                free ( mca_common_ompio_aligned_pool[i].buf );
+            }
+            mca_common_ompio_aligned_pool[i].buf = NULL;
+            mca_common_ompio_aligned_pool[i].in_use = false;
+        }
         OPAL_THREAD_UNLOCK (&mca_common_ompio_buffer_mutex);
         OBJ_DESTRUCT (&mca_common_ompio_buffer_mutex);
     }
@@ -168,3 +196,91 @@ void mca_common_ompio_release_buf ( ompio_file_t *fh, void *buf )
     return;
 }
 
+void *mca_common_ompio_alloc_aligned_buf ( ompio_file_t *fh, size_t bufsize, size_t alignment )
+{
+    void *tmp=NULL;
+    int i, slot=-1;
+
+    if ( !mca_common_ompio_buffer_init ){
+        mca_common_ompio_buffer_alloc_init ();
+    }
+
+    /* O_DIRECT needs at least the logical block size of the device, a
+    ** page is a safe lower bound for the buffer address
+    */
+    if ( alignment < (size_t) mca_common_ompio_pagesize ) {
+        alignment = mca_common_ompio_pagesize;
+    }
+    bufsize = ((bufsize + alignment - 1) / alignment) * alignment;
+
+    OPAL_THREAD_LOCK (&mca_common_ompio_buffer_mutex);
+    /* smallest free buffer which is large enough */
+    for ( i = 0; i < OMPIO_ALIGNED_POOL_SIZE; i++ ) {
+        struct mca_common_ompio_aligned_buf_t *entry = &mca_common_ompio_aligned_pool[i];
+        if ( NULL != entry->buf && !entry->in_use && entry->size >= bufsize &&
+             0 == entry->alignment % alignment &&
+             ( -1 == slot || entry->size < mca_common_ompio_aligned_pool[slot].size )) {
+            slot = i;
+        }
+    }
+    if ( -1 != slot ) {
+        mca_common_ompio_aligned_pool[slot].in_use = true;
+        tmp = mca_common_ompio_aligned_pool[slot].buf;
+        OPAL_THREAD_UNLOCK (&mca_common_ompio_buffer_mutex);
+        return tmp;
+    }
+
+    if ( 0 != posix_memalign ( &tmp, alignment, bufsize )) {
+        OPAL_THREAD_UNLOCK (&mca_common_ompio_buffer_mutex);
+        return NULL;
+    }
+
+    /* keep the new buffer in an empty slot, or in place of the smallest
+    ** free one. If all buffers are in use, it is not pooled.
+    */
+    for ( i = 0; i < OMPIO_ALIGNED_POOL_SIZE; i++ ) {
+        struct mca_common_ompio_aligned_buf_t *entry = &mca_common_ompio_aligned_pool[i];
+        if ( NULL == entry->buf ) {
+            slot = i;
+            break;
+        }
+        if ( !entry->in_use &&
+             ( -1 == slot || entry->size < mca_common_ompio_aligned_pool[slot].size )) {
+            slot = i;
+        }
+    }
+    if ( -1 != slot ) {
+        if ( NULL != mca_common_ompio_aligned_pool[slot].buf ) {
+            free ( mca_common_ompio_aligned_pool[slot].buf );
+        }
+        mca_common_ompio_aligned_pool[slot].buf       = tmp;
+        mca_common_ompio_aligned_pool[slot].size      = bufsize;
+        mca_common_ompio_aligned_pool[slot].alignment = alignment;
+        mca_common_ompio_aligned_pool[slot].in_use    = true;
+    }
+    OPAL_THREAD_UNLOCK (&mca_common_ompio_buffer_mutex);
+
+    return tmp;
+}
+
+void mca_common_ompio_release_aligned_buf ( ompio_file_t *fh, void *buf )
+{
+    int i;
+
+    if ( NULL == buf ) {
+        return;
+    }
+
+    OPAL_THREAD_LOCK (&mca_common_ompio_buffer_mutex);
+    for ( i = 0; i < OMPIO_ALIGNED_POOL_SIZE; i++ ) {
+        if ( buf == mca_common_ompio_aligned_pool[i].buf ) {
+            mca_common_ompio_aligned_pool[i].in_use = false;
+            OPAL_THREAD_UNLOCK (&mca_common_ompio_buffer_mutex);
+            return;
+        }
+    }
+    OPAL_THREAD_UNLOCK (&mca_common_ompio_buffer_mutex);
+
+    free ( buf );
+    return;
+}
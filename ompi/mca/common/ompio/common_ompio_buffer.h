@@ -69,4 +69,8 @@ int mca_common_ompio_buffer_alloc_fini ( void );
 void* mca_common_ompio_alloc_buf ( ompio_file_t *fh, size_t bufsize);
 void mca_common_ompio_release_buf ( ompio_file_t *fh,  void *buf );
 
+/* buffers aligned for direct I/O, kept in a small pool once released */
+void* mca_common_ompio_alloc_aligned_buf ( ompio_file_t *fh, size_t bufsize, size_t alignment );
+void mca_common_ompio_release_aligned_buf ( ompio_file_t *fh, void *buf );
+
 #endif
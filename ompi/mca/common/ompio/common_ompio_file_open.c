@@ -39,12 +39,15 @@
 
 #include <unistd.h>
 #include <math.h>
+#include <string.h>
 #include "common_ompio.h"
 #include "ompi/mca/topo/topo.h"
 
 static mca_common_ompio_generate_current_file_view_fn_t generate_current_file_view_fn;
 static mca_common_ompio_get_mca_parameter_value_fn_t get_mca_parameter_value_fn;
 
+static void mca_common_ompio_decode_cache_clear (ompio_file_t *fh);
+
 int mca_common_ompio_file_open (ompi_communicator_t *comm,
                                 const char *filename,
                                 int amode,
@@ -323,6 +326,11 @@ int mca_common_ompio_file_close (ompio_file_t *ompio_fh)
         free (ompio_fh->f_decoded_iov);
         ompio_fh->f_decoded_iov = NULL;
     }
+    if (NULL != ompio_fh->f_iov_offsets) {
+        free (ompio_fh->f_iov_offsets);
+        ompio_fh->f_iov_offsets = NULL;
+    }
+    mca_common_ompio_decode_cache_clear (ompio_fh);
 
     if (NULL != ompio_fh->f_mem_convertor) {
         opal_convertor_cleanup (ompio_fh->f_mem_convertor);
@@ -433,6 +441,24 @@ int mca_common_ompio_set_file_defaults (ompio_file_t *fh)
            OMPIO_MCA_PRINT_INFO(fh, "cb_buffer_size", char_stripe, "");
        }
 
+       /* Direct I/O is only requested here, the fs component opens the
+       ** additional O_DIRECT descriptor and clears the flag if it can not.
+       */
+       fh->f_direct_fd = -1;
+       if ( 1 == OMPIO_MCA_GET(fh, direct_io) ) {
+           fh->f_flags |= OMPIO_DIRECT_IO;
+       }
+       opal_info_get (fh->f_info, "direct_write", MPI_MAX_INFO_VAL, char_stripe, &flag);
+       if ( flag ) {
+           if ( !strncmp ( char_stripe, "true", strlen("true") )) {
+               fh->f_flags |= OMPIO_DIRECT_IO;
+           }
+           else if ( !strncmp ( char_stripe, "false", strlen("false") )) {
+               fh->f_flags &= ~OMPIO_DIRECT_IO;
+           }
+           OMPIO_MCA_PRINT_INFO(fh, "direct_write", char_stripe, "");
+       }
+
        fh->f_atomicity = 0;
        fh->f_fs_block_size = 4096;
        
@@ -459,6 +485,9 @@ int mca_common_ompio_set_file_defaults (ompio_file_t *fh)
        fh->f_stripe_size = 0;
        /*Decoded iovec of the file-view*/
        fh->f_decoded_iov = NULL;
+       fh->f_iov_offsets = NULL;
+       memset (fh->f_decoded_types, 0, sizeof (fh->f_decoded_types));
+       fh->f_decoded_types_next = 0;
        fh->f_etype = MPI_DATATYPE_NULL;
        fh->f_filetype = MPI_DATATYPE_NULL;
        fh->f_orig_filetype = MPI_DATATYPE_NULL;
@@ -566,6 +595,75 @@ int mca_common_ompio_create_incomplete_file_handle (const char *filename,
     return OMPI_SUCCESS;
 }
 
+/*
+ * The memory datatypes decoded last are kept on the file handle, so
+ * applications accessing the file with the same datatype and count over
+ * and over only pay for flattening the datatype once.  The datatype is
+ * retained while it is in the cache, which keeps its address from
+ * being reused by another datatype.
+ */
+static mca_common_ompio_decoded_type_t *mca_common_ompio_decode_cache_lookup (ompio_file_t *fh,
+                                                                              ompi_datatype_t *datatype,
+                                                                              int count)
+{
+    int i;
+
+    for (i = 0 ; i < OMPIO_DECODE_CACHE_SIZE ; i++) {
+        if (datatype == fh->f_decoded_types[i].datatype && count == fh->f_decoded_types[i].count) {
+            return &fh->f_decoded_types[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void mca_common_ompio_decode_cache_insert (ompio_file_t *fh, ompi_datatype_t *datatype,
+                                                  int count, const void *buf, size_t max_data,
+                                                  const struct iovec *iov, uint32_t iov_count)
+{
+    mca_common_ompio_decoded_type_t *entry = &fh->f_decoded_types[fh->f_decoded_types_next];
+    struct iovec *cached_iov;
+    uint32_t i;
+
+    cached_iov = (struct iovec *) malloc (iov_count * sizeof(struct iovec));
+    if (NULL == cached_iov) {
+        /* the cache is an optimization only */
+        return;
+    }
+    for (i = 0 ; i < iov_count ; i++) {
+        cached_iov[i].iov_base = (IOVBASE_TYPE *)((ptrdiff_t) iov[i].iov_base - (ptrdiff_t) buf);
+        cached_iov[i].iov_len = iov[i].iov_len;
+    }
+
+    if (NULL != entry->datatype) {
+        OBJ_RELEASE(entry->datatype);
+        free (entry->iov);
+    }
+
+    OBJ_RETAIN(datatype);
+    entry->datatype = datatype;
+    entry->count = count;
+    entry->max_data = max_data;
+    entry->iov_count = iov_count;
+    entry->iov = cached_iov;
+    fh->f_decoded_types_next = (fh->f_decoded_types_next + 1) % OMPIO_DECODE_CACHE_SIZE;
+}
+
+static void mca_common_ompio_decode_cache_clear (ompio_file_t *fh)
+{
+    int i;
+
+    for (i = 0 ; i < OMPIO_DECODE_CACHE_SIZE ; i++) {
+        if (NULL != fh->f_decoded_types[i].datatype) {
+            OBJ_RELEASE(fh->f_decoded_types[i].datatype);
+            free (fh->f_decoded_types[i].iov);
+            fh->f_decoded_types[i].datatype = NULL;
+            fh->f_decoded_types[i].iov = NULL;
+        }
+    }
+    fh->f_decoded_types_next = 0;
+}
+
 int mca_common_ompio_decode_datatype (struct ompio_file_t *fh,
                                       ompi_datatype_t *datatype,
                                       int count,
@@ -584,7 +682,27 @@ int mca_common_ompio_decode_datatype (struct ompio_file_t *fh,
     uint32_t temp_count;
     struct iovec *temp_iov=NULL;
     size_t temp_data;
+    mca_common_ompio_decoded_type_t *cached = NULL;
 
+    /* only the memory side is cached, the file view is decoded once per
+       set_view anyway */
+    if ( NULL != fh && conv == fh->f_mem_convertor && 0 < datatype->super.size ) {
+        cached = mca_common_ompio_decode_cache_lookup (fh, datatype, count);
+    }
+    if ( NULL != cached ) {
+        *iov = (struct iovec *) malloc (cached->iov_count * sizeof(struct iovec));
+        if (NULL == *iov) {
+            opal_output (1, "OUT OF MEMORY\n");
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        for (i=0 ; i<cached->iov_count ; i++) {
+            (*iov)[i].iov_base = (IOVBASE_TYPE *)((ptrdiff_t) buf + (ptrdiff_t) cached->iov[i].iov_base);
+            (*iov)[i].iov_len = cached->iov[i].iov_len;
+        }
+        *iovec_count = cached->iov_count;
+        *max_data = cached->max_data;
+        return OMPI_SUCCESS;
+    }
 
     opal_convertor_clone (conv, &convertor, 0);
 
@@ -683,6 +801,11 @@ int mca_common_ompio_decode_datatype (struct ompio_file_t *fh,
 
     free (temp_iov);
     opal_convertor_cleanup (&convertor);
+
+    if ( NULL != fh && conv == fh->f_mem_convertor && 0 < *iovec_count ) {
+        mca_common_ompio_decode_cache_insert (fh, datatype, count, buf, *max_data,
+                                              *iov, *iovec_count);
+    }
     
     return OMPI_SUCCESS;
 }
@@ -554,11 +554,29 @@ int mca_common_ompio_set_explicit_offset (ompio_file_t *fh,
 
 	/* determine block id that the offset is located in and
 	   the starting offset of that block */
-	k = fh->f_decoded_iov[fh->f_index_in_file_view].iov_len;
-	while (i >= k) {
-	    fh->f_position_in_file_view = k;
-	    fh->f_index_in_file_view++;
-	    k += fh->f_decoded_iov[fh->f_index_in_file_view].iov_len;
+	if (NULL != fh->f_iov_offsets) {
+	    /* first block that ends after the offset */
+	    size_t low = 0, high = fh->f_iov_count - 1, mid;
+
+	    while (low < high) {
+	        mid = (low + high) / 2;
+	        if (fh->f_iov_offsets[mid+1] > i) {
+	            high = mid;
+	        }
+	        else {
+	            low = mid + 1;
+	        }
+	    }
+	    fh->f_index_in_file_view = (int) low;
+	    fh->f_position_in_file_view = fh->f_iov_offsets[low];
+	}
+	else {
+	    k = fh->f_decoded_iov[fh->f_index_in_file_view].iov_len;
+	    while (i >= k) {
+	        fh->f_position_in_file_view = k;
+	        fh->f_index_in_file_view++;
+	        k += fh->f_decoded_iov[fh->f_index_in_file_view].iov_len;
+	    }
 	}
     }
 
@@ -85,6 +85,10 @@ int mca_common_ompio_set_view (ompio_file_t *fh,
         free (fh->f_decoded_iov);
         fh->f_decoded_iov = NULL;
     }
+    if (NULL != fh->f_iov_offsets) {
+        free (fh->f_iov_offsets);
+        fh->f_iov_offsets = NULL;
+    }
 
     if (NULL != fh->f_datarep) {
         free (fh->f_datarep);
@@ -154,6 +158,17 @@ int mca_common_ompio_set_view (ompio_file_t *fh,
                                       &fh->f_decoded_iov,
                                       &fh->f_iov_count);
 
+    /* index of the file view, used to seek into it with a binary search */
+    fh->f_iov_offsets = (size_t *) malloc ((fh->f_iov_count + 1) * sizeof(size_t));
+    if (NULL == fh->f_iov_offsets) {
+        opal_output (1, "OUT OF MEMORY\n");
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    fh->f_iov_offsets[0] = 0;
+    for (i = 0 ; i < (int)fh->f_iov_count ; i++) {
+        fh->f_iov_offsets[i+1] = fh->f_iov_offsets[i] + fh->f_decoded_iov[i].iov_len;
+    }
+
     opal_datatype_get_extent(&newfiletype->super, &lb, &fh->f_view_extent);
     opal_datatype_type_ub   (&newfiletype->super, &ub);
     opal_datatype_type_size (&etype->super, &fh->f_etype_size);
@@ -41,6 +41,18 @@ ssize_t  mca_fbtl_posix_ipwritev (ompio_file_t *fh,
     int i=0, ret;
     off_t start_offset, end_offset, total_length;
 
+    if ( (fh->f_flags & OMPIO_DIRECT_IO) && 0 <= fh->f_direct_fd ) {
+        /* aio has no notion of the buffered head and tail pieces of
+        ** a direct write, complete the request right away instead.
+        */
+        ssize_t ret_code = mca_fbtl_posix_pwritev (fh);
+
+        req->req_ompi.req_status.MPI_ERROR = (0 > ret_code) ? MPI_ERR_IO : OMPI_SUCCESS;
+        req->req_ompi.req_status._ucount   = (0 > ret_code) ? 0 : ret_code;
+        ompi_request_complete (&req->req_ompi, false);
+        return OMPI_SUCCESS;
+    }
+
     data = (mca_fbtl_posix_request_data_t *) malloc ( sizeof (mca_fbtl_posix_request_data_t));
     if ( NULL == data ) {
         opal_output (1,"could not allocate memory\n");
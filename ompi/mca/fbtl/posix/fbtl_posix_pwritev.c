@@ -27,8 +27,14 @@
 #include <unistd.h>
 #include <sys/uio.h>
 #include <limits.h>
+#include <errno.h>
+#include <string.h>
 #include "ompi/constants.h"
 #include "ompi/mca/fbtl/fbtl.h"
+#include "ompi/mca/common/ompio/common_ompio_buffer.h"
+
+static ssize_t mca_fbtl_posix_pwritev_direct (ompio_file_t *fh, struct iovec *iov, int iov_count,
+                                              OMPI_MPI_OFFSET_TYPE iov_offset);
 
 ssize_t  mca_fbtl_posix_pwritev(ompio_file_t *fh )
 {
@@ -106,6 +112,10 @@ ssize_t  mca_fbtl_posix_pwritev(ompio_file_t *fh )
             mca_fbtl_posix_unlock ( &lock, fh );
             return OMPI_ERROR;
         }
+        if ( (fh->f_flags & OMPIO_DIRECT_IO) && 0 <= fh->f_direct_fd ) {
+            ret_code = mca_fbtl_posix_pwritev_direct (fh, iov, iov_count, iov_offset);
+        }
+        else {
 #if defined (HAVE_PWRITEV) 
 	ret_code = pwritev (fh->fd, iov, iov_count, iov_offset);
 #else
@@ -117,6 +127,7 @@ ssize_t  mca_fbtl_posix_pwritev(ompio_file_t *fh )
 	}
 	ret_code = writev (fh->fd, iov, iov_count);
 #endif
+        }
         mca_fbtl_posix_unlock ( &lock, fh );
 	if ( 0 < ret_code ) {
 	    bytes_written += ret_code;
@@ -133,3 +144,120 @@ ssize_t  mca_fbtl_posix_pwritev(ompio_file_t *fh )
 
     return bytes_written;
 }
+
+/* copy the next len bytes described by iov, starting at element *index
+** and byte *pos of that element, and advance the position
+*/
+static void mca_fbtl_posix_copy_iov (struct iovec *iov, int *index, size_t *pos,
+                                     char *dst, size_t len)
+{
+    size_t n;
+
+    while ( 0 < len ) {
+        n = iov[*index].iov_len - *pos;
+        if ( n > len ) {
+            n = len;
+        }
+        memcpy (dst, (char *) iov[*index].iov_base + *pos, n);
+        dst  += n;
+        len  -= n;
+        *pos += n;
+        if ( *pos == iov[*index].iov_len ) {
+            (*index)++;
+            *pos = 0;
+        }
+    }
+}
+
+static ssize_t mca_fbtl_posix_pwrite_all (int fd, const char *buf, size_t len, off_t offset)
+{
+    size_t done = 0;
+    ssize_t ret;
+
+    while ( done < len ) {
+        ret = pwrite (fd, buf + done, len - done, offset + done);
+        if ( -1 == ret ) {
+            if ( EINTR == errno ) {
+                continue;
+            }
+            return -1;
+        }
+        done += ret;
+    }
+    return done;
+}
+
+/*
+ * Write a file contiguous region through the O_DIRECT descriptor.
+ * O_DIRECT requires the file offset, the length and the buffer to be
+ * aligned, so the region is split into an unaligned head, the complete
+ * blocks, and an unaligned tail. Head and tail are written through the
+ * regular descriptor: writing them directly would require a read-modify-write
+ * of blocks which other processes might be writing at the same time.
+ * All pieces are staged through an aligned buffer from the buffer pool,
+ * at most f_bytes_per_agg bytes at a time.
+ */
+static ssize_t mca_fbtl_posix_pwritev_direct (ompio_file_t *fh, struct iovec *iov, int iov_count,
+                                              OMPI_MPI_OFFSET_TYPE iov_offset)
+{
+    size_t alignment = (0 < fh->f_fs_block_size) ? (size_t) fh->f_fs_block_size : 4096;
+    size_t len = 0, chunk, n, pos = 0;
+    off_t offset = (off_t) iov_offset, end, aligned_start, aligned_end;
+    int i, fd, index = 0;
+    char *buf;
+
+    for ( i = 0; i < iov_count; i++ ) {
+        len += iov[i].iov_len;
+    }
+    end = offset + len;
+
+    aligned_start = ((offset + alignment - 1) / alignment) * alignment;
+    aligned_end   = (end / alignment) * alignment;
+    if ( aligned_end <= aligned_start ) {
+        /* no complete block in this region, write it buffered */
+        aligned_start = aligned_end = end;
+    }
+
+    chunk = (0 < fh->f_bytes_per_agg) ? (size_t) fh->f_bytes_per_agg : alignment;
+    chunk = (chunk / alignment) * alignment;
+    if ( chunk < alignment ) {
+        chunk = alignment;
+    }
+    if ( chunk > ((len + alignment - 1) / alignment) * alignment ) {
+        chunk = ((len + alignment - 1) / alignment) * alignment;
+    }
+
+    buf = (char *) mca_common_ompio_alloc_aligned_buf (fh, chunk, alignment);
+    if ( NULL == buf ) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    while ( offset < end ) {
+        if ( offset < aligned_start ) {
+            n  = aligned_start - offset;
+            fd = fh->fd;
+        }
+        else if ( offset < aligned_end ) {
+            n  = aligned_end - offset;
+            fd = fh->f_direct_fd;
+        }
+        else {
+            n  = end - offset;
+            fd = fh->fd;
+        }
+        if ( n > chunk ) {
+            n = chunk;
+        }
+
+        mca_fbtl_posix_copy_iov (iov, &index, &pos, buf, n);
+        if ( -1 == mca_fbtl_posix_pwrite_all (fd, buf, n, offset) ) {
+            mca_common_ompio_release_aligned_buf (fh, buf);
+            return -1;
+        }
+        offset += n;
+    }
+
+    mca_common_ompio_release_aligned_buf (fh, buf);
+    return len;
+}
@@ -0,0 +1,483 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * All files of a process share one io_uring instance.  Every request
+ * is split into ops, one readv/writev per contiguous region of the
+ * file, and at most mca_fbtl_uring_entries ops of all requests are in
+ * flight at any time.  Completions are harvested from the ring, by
+ * whichever request happens to be progressed, and accounted to the
+ * request owning the op, so progressing a request never polls the
+ * ops of the others.
+ */
+
+#include "ompi_config.h"
+#include "mpi.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "opal/mca/threads/mutex.h"
+#include "opal/util/output.h"
+#include "ompi/mca/fbtl/fbtl.h"
+#include "ompi/mca/fbtl/base/base.h"
+#include "ompi/mca/fbtl/uring/fbtl_uring.h"
+
+#define MAX_ERRCOUNT 100
+
+static struct io_uring mca_fbtl_uring_ring;
+static int mca_fbtl_uring_ring_status = 0; /* 0 not set up, 1 ready, -1 unavailable */
+static int mca_fbtl_uring_ring_active = 0; /* ops in flight on the ring */
+static opal_mutex_t mca_fbtl_uring_mutex = OPAL_MUTEX_STATIC_INIT;
+
+/*
+ * *******************************************************************
+ * ************************ actions structure ************************
+ * *******************************************************************
+ */
+static mca_fbtl_base_module_1_0_0_t uring =  {
+    mca_fbtl_uring_module_init,     /* initalise after being selected */
+    mca_fbtl_uring_module_finalize, /* close a module on a communicator */
+    mca_fbtl_uring_preadv,          /* blocking read */
+    mca_fbtl_uring_ipreadv,         /* non-blocking read*/
+    mca_fbtl_uring_pwritev,         /* blocking write */
+    mca_fbtl_uring_ipwritev,        /* non-blocking write */
+    mca_fbtl_uring_progress,        /* module specific progress */
+    mca_fbtl_uring_request_free     /* free module specific data items on the request */
+};
+/*
+ * *******************************************************************
+ * ************************* structure ends **************************
+ * *******************************************************************
+ */
+
+int mca_fbtl_uring_component_init_query(bool enable_progress_threads,
+                                        bool enable_mpi_threads)
+{
+    /* Nothing to do, the ring is set up when the first file is opened */
+    return OMPI_SUCCESS;
+}
+
+struct mca_fbtl_base_module_1_0_0_t *
+mca_fbtl_uring_component_file_query (ompio_file_t *fh, int *priority)
+{
+    *priority = mca_fbtl_uring_priority;
+
+    /* the fbtl is selected before the fs component opens the file, so
+       only the request for direct I/O is known here. Writes through the
+       O_DIRECT descriptor are only implemented by the posix component */
+    if (fh->f_flags & OMPIO_DIRECT_IO) {
+        return NULL;
+    }
+
+    /* io_uring might be disabled or filtered by the kernel, leave the
+       file to the posix component in that case */
+    if (OMPI_SUCCESS != mca_fbtl_uring_ring_setup ()) {
+        return NULL;
+    }
+
+    if (UFS == fh->f_fstype) {
+        if (*priority < FBTL_URING_INCREASED_PRIORITY) {
+            *priority = FBTL_URING_INCREASED_PRIORITY;
+        }
+    }
+
+    return &uring;
+}
+
+int mca_fbtl_uring_component_file_unquery (ompio_file_t *file)
+{
+   /* This function might be needed for some purposes later. for now it
+    * does not have anything to do since there are no steps which need
+    * to be undone if this module is not selected */
+
+   return OMPI_SUCCESS;
+}
+
+int mca_fbtl_uring_module_init (ompio_file_t *file)
+{
+    return OMPI_SUCCESS;
+}
+
+
+int mca_fbtl_uring_module_finalize (ompio_file_t *file)
+{
+    return OMPI_SUCCESS;
+}
+
+int mca_fbtl_uring_ring_setup (void)
+{
+    int ret;
+
+    OPAL_THREAD_LOCK(&mca_fbtl_uring_mutex);
+    if (0 == mca_fbtl_uring_ring_status) {
+        if (mca_fbtl_uring_entries < 1) {
+            mca_fbtl_uring_entries = 1;
+        }
+        ret = io_uring_queue_init (mca_fbtl_uring_entries, &mca_fbtl_uring_ring, 0);
+        if (0 > ret) {
+            opal_output_verbose(10, ompi_fbtl_base_framework.framework_output,
+                                "fbtl:uring: io_uring_queue_init() failed: %s", strerror(-ret));
+            mca_fbtl_uring_ring_status = -1;
+        } else {
+            mca_fbtl_uring_ring_status = 1;
+        }
+    }
+    ret = (1 == mca_fbtl_uring_ring_status) ? OMPI_SUCCESS : OMPI_ERR_NOT_AVAILABLE;
+    OPAL_THREAD_UNLOCK(&mca_fbtl_uring_mutex);
+
+    return ret;
+}
+
+void mca_fbtl_uring_ring_cleanup (void)
+{
+    if (1 == mca_fbtl_uring_ring_status) {
+        io_uring_queue_exit (&mca_fbtl_uring_ring);
+    }
+    mca_fbtl_uring_ring_status = 0;
+    mca_fbtl_uring_ring_active = 0;
+}
+
+mca_fbtl_uring_request_data_t *mca_fbtl_uring_request_data_create (ompio_file_t *fh, int op_type)
+{
+    mca_fbtl_uring_request_data_t *data;
+    mca_fbtl_uring_op_t *op = NULL;
+    off_t offset, op_end = 0;
+    int i;
+
+    data = (mca_fbtl_uring_request_data_t *) calloc (1, sizeof (mca_fbtl_uring_request_data_t));
+    if (NULL == data) {
+        return NULL;
+    }
+
+    data->op_type = op_type;
+    data->fh = fh;
+    data->lock.l_start = -1;
+    data->lock.l_len = -1;
+    if (0 == fh->f_num_of_io_entries) {
+        return data;
+    }
+
+    /* the io array is released by the caller once the request is posted */
+    data->iovecs = (struct iovec *) malloc (fh->f_num_of_io_entries * sizeof (struct iovec));
+    data->ops = (mca_fbtl_uring_op_t *) malloc (fh->f_num_of_io_entries * sizeof (mca_fbtl_uring_op_t));
+    if (NULL == data->iovecs || NULL == data->ops) {
+        mca_fbtl_uring_request_data_free (data);
+        return NULL;
+    }
+
+    data->start = (off_t)(intptr_t) fh->f_io_array[0].offset;
+    data->end = data->start;
+    for (i = 0 ; i < fh->f_num_of_io_entries ; i++) {
+        offset = (off_t)(intptr_t) fh->f_io_array[i].offset;
+        data->iovecs[i].iov_base = fh->f_io_array[i].memory_address;
+        data->iovecs[i].iov_len = fh->f_io_array[i].length;
+
+        /* merge entries that are contiguous in the file into one op */
+        if (NULL != op && op_end == offset && op->iov_count < IOV_MAX) {
+            op->iov_count++;
+        } else {
+            op = data->ops + data->op_count++;
+            op->iov = data->iovecs + i;
+            op->iov_count = 1;
+            op->offset = offset;
+            op->data = data;
+        }
+        op_end = offset + (off_t) fh->f_io_array[i].length;
+
+        if (offset < data->start) {
+            data->start = offset;
+        }
+        if (op_end > data->end) {
+            data->end = op_end;
+        }
+    }
+
+    return data;
+}
+
+void mca_fbtl_uring_request_data_free (mca_fbtl_uring_request_data_t *data)
+{
+    mca_fbtl_uring_unlock (data);
+    free (data->ops);
+    free (data->iovecs);
+    free (data);
+}
+
+/* caller holds mca_fbtl_uring_mutex */
+static void mca_fbtl_uring_prep (struct io_uring_sqe *sqe, mca_fbtl_uring_op_t *op)
+{
+    if (FBTL_URING_READ == op->data->op_type) {
+        io_uring_prep_readv (sqe, op->data->fh->fd, op->iov, op->iov_count, op->offset);
+    } else {
+        io_uring_prep_writev (sqe, op->data->fh->fd, op->iov, op->iov_count, op->offset);
+    }
+    io_uring_sqe_set_data (sqe, op);
+}
+
+/* caller holds mca_fbtl_uring_mutex */
+static int mca_fbtl_uring_flush (void)
+{
+    int ret;
+
+    do {
+        ret = io_uring_submit (&mca_fbtl_uring_ring);
+    } while (-EINTR == ret);
+
+    /* the kernel is out of resources for now, the entries are left in
+       the submission queue and submitted with the next call */
+    if (-EAGAIN == ret || -EBUSY == ret) {
+        return 0;
+    }
+
+    return ret;
+}
+
+/* account a completion to the op it belongs to, caller holds mca_fbtl_uring_mutex */
+static void mca_fbtl_uring_complete (mca_fbtl_uring_op_t *op, int res)
+{
+    mca_fbtl_uring_request_data_t *data = op->data;
+    struct io_uring_sqe *sqe;
+    size_t left;
+
+    if (0 < res) {
+        data->total_len += res;
+        op->offset += res;
+        for (left = (size_t) res ; op->iov_count && left >= op->iov->iov_len ; op->iov++, op->iov_count--) {
+            left -= op->iov->iov_len;
+        }
+        if (op->iov_count) {
+            op->iov->iov_base = (char *) op->iov->iov_base + left;
+            op->iov->iov_len -= left;
+        }
+    } else if (0 > res && -EINTR != res && -EAGAIN != res) {
+        if (0 == data->op_error) {
+            data->op_error = -res;
+        }
+        op->iov_count = 0;
+    }
+
+    /* a short transfer is continued, reading 0 bytes means end of file */
+    if (op->iov_count && 0 != res && 0 == data->op_error) {
+        sqe = io_uring_get_sqe (&mca_fbtl_uring_ring);
+        if (NULL != sqe) {
+            mca_fbtl_uring_prep (sqe, op);
+            return;
+        }
+        data->op_error = EAGAIN;
+    }
+
+    data->op_active--;
+    mca_fbtl_uring_ring_active--;
+}
+
+int mca_fbtl_uring_submit (mca_fbtl_uring_request_data_t *data)
+{
+    struct io_uring_sqe *sqe;
+    int ret = OMPI_SUCCESS, count = 0;
+
+    OPAL_THREAD_LOCK(&mca_fbtl_uring_mutex);
+    while (data->op_next < data->op_count && 0 == data->op_error &&
+           mca_fbtl_uring_ring_active < mca_fbtl_uring_entries) {
+        sqe = io_uring_get_sqe (&mca_fbtl_uring_ring);
+        if (NULL == sqe) {
+            break;
+        }
+        mca_fbtl_uring_prep (sqe, data->ops + data->op_next);
+        data->op_next++;
+        data->op_active++;
+        mca_fbtl_uring_ring_active++;
+        count++;
+    }
+
+    if (count && 0 > mca_fbtl_uring_flush ()) {
+        /* the ring is unusable, nothing in flight will complete anymore */
+        opal_output(1, "mca_fbtl_uring_submit: error in io_uring_submit()");
+        mca_fbtl_uring_ring_status = -1;
+        ret = OMPI_ERROR;
+    }
+    OPAL_THREAD_UNLOCK(&mca_fbtl_uring_mutex);
+
+    return ret;
+}
+
+int mca_fbtl_uring_reap (bool wait)
+{
+    struct io_uring_cqe *cqe;
+    int ret, reaped = 0;
+    mca_fbtl_uring_op_t *op;
+
+    OPAL_THREAD_LOCK(&mca_fbtl_uring_mutex);
+    for (;;) {
+        ret = io_uring_peek_cqe (&mca_fbtl_uring_ring, &cqe);
+        if (-EAGAIN == ret) {
+            if (!wait || 0 < reaped || 0 == mca_fbtl_uring_ring_active) {
+                /* submit the transfers continued by mca_fbtl_uring_complete() */
+                if (io_uring_sq_ready (&mca_fbtl_uring_ring)) {
+                    ret = mca_fbtl_uring_flush ();
+                }
+                break;
+            }
+            ret = io_uring_submit_and_wait (&mca_fbtl_uring_ring, 1);
+            if (0 > ret && -EINTR != ret && -EAGAIN != ret && -EBUSY != ret) {
+                break;
+            }
+            continue;
+        }
+        if (0 > ret) {
+            break;
+        }
+
+        op = (mca_fbtl_uring_op_t *) io_uring_cqe_get_data (cqe);
+        ret = cqe->res;
+        io_uring_cqe_seen (&mca_fbtl_uring_ring, cqe);
+        mca_fbtl_uring_complete (op, ret);
+        reaped++;
+    }
+
+    if (0 > ret && -EAGAIN != ret && -EINTR != ret) {
+        opal_output(1, "mca_fbtl_uring_reap: error in io_uring_enter(): %s", strerror(-ret));
+        mca_fbtl_uring_ring_status = -1;
+        reaped = OMPI_ERROR;
+    }
+    OPAL_THREAD_UNLOCK(&mca_fbtl_uring_mutex);
+
+    return reaped;
+}
+
+bool mca_fbtl_uring_progress ( mca_ompio_request_t *req)
+{
+    mca_fbtl_uring_request_data_t *data = (mca_fbtl_uring_request_data_t *) req->req_data;
+
+    if (1 == mca_fbtl_uring_ring_status) {
+        (void) mca_fbtl_uring_reap (false);
+    }
+
+    /* refill the ring with the ops of this request that did not fit */
+    if (1 == mca_fbtl_uring_ring_status && data->op_next < data->op_count && 0 == data->op_error) {
+        (void) mca_fbtl_uring_submit (data);
+    }
+
+    if (1 == mca_fbtl_uring_ring_status) {
+        if (0 != data->op_active ||
+            (data->op_next < data->op_count && 0 == data->op_error)) {
+            return false;
+        }
+    } else if (0 == data->op_error) {
+        data->op_error = EIO;
+    }
+
+    /* all pending operations are finished for this request */
+    req->req_ompi.req_status.MPI_ERROR = (0 == data->op_error) ? OMPI_SUCCESS : OMPI_ERROR;
+    req->req_ompi.req_status._ucount = data->total_len;
+    mca_fbtl_uring_unlock (data);
+
+    return true;
+}
+
+void mca_fbtl_uring_request_free ( mca_ompio_request_t *req)
+{
+    /* Free the fbtl specific data structures */
+    mca_fbtl_uring_request_data_t *data = (mca_fbtl_uring_request_data_t *) req->req_data;
+
+    if (NULL != data) {
+        /* the kernel still references the buffers and the ops of
+           operations in flight.  If the ring broke they are leaked. */
+        while (0 < data->op_active && 1 == mca_fbtl_uring_ring_status) {
+            (void) mca_fbtl_uring_reap (true);
+        }
+        if (0 == data->op_active) {
+            mca_fbtl_uring_request_data_free (data);
+        } else {
+            mca_fbtl_uring_unlock (data);
+        }
+        req->req_data = NULL;
+    }
+}
+
+/*
+  Same locking scheme as the posix fbtl, applied to the whole range of
+  the request.  flags can be OMPIO_LOCK_ENTIRE_REGION or
+  OMPIO_LOCK_SELECTIVE, fh->f_flags are the flags set by the fs
+  component and/or user requests.
+*/
+int mca_fbtl_uring_lock (mca_fbtl_uring_request_data_t *data, int flags)
+{
+    ompio_file_t *fh = data->fh;
+    struct flock *lock = &data->lock;
+    off_t len = data->end - data->start, lmod, bmod;
+    int ret, err_count = 0;
+
+    lock->l_type   = (FBTL_URING_READ == data->op_type) ? F_RDLCK : F_WRLCK;
+    lock->l_whence = SEEK_SET;
+    lock->l_start  = -1;
+    lock->l_len    = -1;
+    if (0 == len) {
+        return 0;
+    }
+
+    if (fh->f_flags & OMPIO_LOCK_ENTIRE_FILE) {
+        lock->l_start = (off_t) 0;
+        lock->l_len   = 0;
+    } else {
+        if ((fh->f_flags & OMPIO_LOCK_NEVER) ||
+            (fh->f_flags & OMPIO_LOCK_NOT_THIS_OP)) {
+            return 0;
+        }
+        if (OMPIO_LOCK_ENTIRE_REGION == flags) {
+            lock->l_start = data->start;
+            lock->l_len   = len;
+        } else {
+            /* only the partial file system blocks at the beginning and
+               the end of the range need to be protected */
+            bmod = data->start % fh->f_fs_block_size;
+            if (bmod) {
+                lock->l_start = data->start;
+                lock->l_len   = bmod;
+            }
+            lmod = data->end % fh->f_fs_block_size;
+            if (lmod) {
+                if (!bmod) {
+                    lock->l_start = data->end - lmod;
+                    lock->l_len   = lmod;
+                } else {
+                    lock->l_len = len;
+                }
+            }
+            if (-1 == lock->l_start && -1 == lock->l_len) {
+                return 0;
+            }
+        }
+    }
+
+    do {
+        ret = fcntl (fh->fd, F_SETLKW, lock);
+        if (ret) {
+            err_count++;
+        }
+    } while (ret && ((EINTR == errno) || ((EINPROGRESS == errno) && err_count < MAX_ERRCOUNT)));
+
+    return ret;
+}
+
+void mca_fbtl_uring_unlock (mca_fbtl_uring_request_data_t *data)
+{
+    struct flock *lock = &data->lock;
+
+    if (-1 == lock->l_start && -1 == lock->l_len) {
+        return;
+    }
+
+    lock->l_type = F_UNLCK;
+    fcntl (data->fh->fd, F_SETLK, lock);
+    lock->l_start = -1;
+    lock->l_len   = -1;
+}
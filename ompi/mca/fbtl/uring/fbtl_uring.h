@@ -0,0 +1,109 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef MCA_FBTL_URING_H
+#define MCA_FBTL_URING_H
+
+#include "ompi_config.h"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <liburing.h>
+
+#include "ompi/mca/mca.h"
+#include "ompi/mca/fbtl/fbtl.h"
+#include "ompi/mca/common/ompio/common_ompio.h"
+#include "ompi/mca/common/ompio/common_ompio_request.h"
+
+extern int mca_fbtl_uring_priority;
+extern int mca_fbtl_uring_entries;
+
+#define FBTL_URING_BASE_PRIORITY      5
+#define FBTL_URING_INCREASED_PRIORITY 60
+#define FBTL_URING_ENTRIES            256
+
+BEGIN_C_DECLS
+
+int mca_fbtl_uring_component_init_query(bool enable_progress_threads,
+                                        bool enable_mpi_threads);
+struct mca_fbtl_base_module_1_0_0_t *
+mca_fbtl_uring_component_file_query (ompio_file_t *file, int *priority);
+int mca_fbtl_uring_component_file_unquery (ompio_file_t *file);
+
+int mca_fbtl_uring_module_init (ompio_file_t *file);
+int mca_fbtl_uring_module_finalize (ompio_file_t *file);
+
+OMPI_MODULE_DECLSPEC extern mca_fbtl_base_component_2_0_0_t mca_fbtl_uring_component;
+/*
+ * ******************************************************************
+ * ********* functions which are implemented in this module *********
+ * ******************************************************************
+ */
+
+ssize_t mca_fbtl_uring_preadv (ompio_file_t *file );
+ssize_t mca_fbtl_uring_pwritev (ompio_file_t *file );
+ssize_t mca_fbtl_uring_ipreadv (ompio_file_t *file,
+                                ompi_request_t *request);
+ssize_t mca_fbtl_uring_ipwritev (ompio_file_t *file,
+                                 ompi_request_t *request);
+
+bool mca_fbtl_uring_progress     (mca_ompio_request_t *req);
+void mca_fbtl_uring_request_free (mca_ompio_request_t *req);
+
+struct mca_fbtl_uring_request_data_t;
+
+/* one readv/writev submitted to the ring: a contiguous region of the file */
+struct mca_fbtl_uring_op_t {
+    struct iovec  *iov;               /* iovecs still to be transferred */
+    int            iov_count;         /* number of iovecs still to be transferred */
+    off_t          offset;            /* file offset of iov[0] */
+    struct mca_fbtl_uring_request_data_t *data; /* request the op belongs to */
+};
+typedef struct mca_fbtl_uring_op_t mca_fbtl_uring_op_t;
+
+struct mca_fbtl_uring_request_data_t {
+    int            op_type;           /* read or write */
+    int            op_count;          /* total number of ops */
+    int            op_next;           /* first op not yet submitted */
+    int            op_active;         /* ops submitted and not yet completed */
+    int            op_error;          /* first error reported for an op (errno) */
+    ssize_t        total_len;         /* total amount of data transferred */
+    off_t          start;             /* lowest file offset accessed */
+    off_t          end;               /* end of the highest region accessed */
+    mca_fbtl_uring_op_t *ops;         /* array of ops */
+    struct iovec  *iovecs;            /* iovecs copied from the file handle */
+    struct flock   lock;              /* lock used for certain file systems */
+    ompio_file_t  *fh;                /* pointer back to the file handle */
+};
+typedef struct mca_fbtl_uring_request_data_t mca_fbtl_uring_request_data_t;
+
+/* define constants for read/write operations */
+#define FBTL_URING_READ  1
+#define FBTL_URING_WRITE 2
+
+/* helpers shared by the blocking and the non-blocking operations */
+int  mca_fbtl_uring_ring_setup (void);
+void mca_fbtl_uring_ring_cleanup (void);
+
+mca_fbtl_uring_request_data_t *mca_fbtl_uring_request_data_create (ompio_file_t *fh, int op_type);
+void mca_fbtl_uring_request_data_free (mca_fbtl_uring_request_data_t *data);
+int  mca_fbtl_uring_submit (mca_fbtl_uring_request_data_t *data);
+int  mca_fbtl_uring_reap (bool wait);
+
+int  mca_fbtl_uring_lock (mca_fbtl_uring_request_data_t *data, int flags);
+void mca_fbtl_uring_unlock (mca_fbtl_uring_request_data_t *data);
+
+/*
+ * ******************************************************************
+ * ************ functions implemented in this module end ************
+ * ******************************************************************
+ */
+
+END_C_DECLS
+
+#endif /* MCA_FBTL_URING_H */
@@ -0,0 +1,85 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+#include "fbtl_uring.h"
+
+#include "mpi.h"
+#include <errno.h>
+#include <string.h>
+#include "ompi/constants.h"
+#include "ompi/mca/fbtl/fbtl.h"
+
+static ssize_t mca_fbtl_uring_blocking_op (ompio_file_t *fh, int op_type)
+{
+    mca_fbtl_uring_request_data_t *data;
+    ssize_t ret;
+
+    if (NULL == fh->f_io_array) {
+        return OMPI_ERROR;
+    }
+
+    data = mca_fbtl_uring_request_data_create (fh, op_type);
+    if (NULL == data) {
+        opal_output(1, "OUT OF MEMORY\n");
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    if (0 != mca_fbtl_uring_lock (data, OMPIO_LOCK_SELECTIVE)) {
+        opal_output(1, "mca_fbtl_uring_blocking_op: error in mca_fbtl_uring_lock(): %s",
+                    strerror(errno));
+        /* Just in case some part of the lock worked */
+        mca_fbtl_uring_request_data_free (data);
+        return OMPI_ERROR;
+    }
+
+    /* other requests might hold most of the ring, submit whatever fits
+       and wait for completions until all ops are done */
+    while (0 == data->op_error || 0 < data->op_active) {
+        if (data->op_next < data->op_count && 0 == data->op_error &&
+            OMPI_SUCCESS != mca_fbtl_uring_submit (data)) {
+            break;
+        }
+        if (0 == data->op_active && data->op_next == data->op_count) {
+            break;
+        }
+        if (0 > mca_fbtl_uring_reap (true)) {
+            break;
+        }
+    }
+
+    if (0 != data->op_active) {
+        /* the ring broke, the kernel might still reference the ops */
+        opal_output(1, "mca_fbtl_uring_blocking_op: error in io_uring");
+        mca_fbtl_uring_unlock (data);
+        return OMPI_ERROR;
+    }
+
+    if (0 != data->op_error) {
+        opal_output(1, "mca_fbtl_uring_blocking_op: error in %s: %s",
+                    (FBTL_URING_READ == op_type) ? "readv" : "writev", strerror(data->op_error));
+        ret = OMPI_ERROR;
+    } else {
+        ret = data->total_len;
+    }
+
+    mca_fbtl_uring_request_data_free (data);
+
+    return ret;
+}
+
+ssize_t mca_fbtl_uring_preadv (ompio_file_t *fh)
+{
+    return mca_fbtl_uring_blocking_op (fh, FBTL_URING_READ);
+}
+
+ssize_t mca_fbtl_uring_pwritev (ompio_file_t *fh)
+{
+    return mca_fbtl_uring_blocking_op (fh, FBTL_URING_WRITE);
+}
@@ -0,0 +1,61 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+#include "fbtl_uring.h"
+
+#include "mpi.h"
+#include <errno.h>
+#include <string.h>
+#include "ompi/constants.h"
+#include "ompi/mca/fbtl/fbtl.h"
+
+static ssize_t mca_fbtl_uring_nonblocking_op (ompio_file_t *fh,
+                                              ompi_request_t *request, int op_type)
+{
+    mca_fbtl_uring_request_data_t *data;
+    mca_ompio_request_t *req = (mca_ompio_request_t *) request;
+
+    data = mca_fbtl_uring_request_data_create (fh, op_type);
+    if (NULL == data) {
+        opal_output(1, "OUT OF MEMORY\n");
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    if (0 != mca_fbtl_uring_lock (data, OMPIO_LOCK_ENTIRE_REGION)) {
+        opal_output(1, "mca_fbtl_uring_nonblocking_op: error in mca_fbtl_uring_lock(): %s",
+                    strerror(errno));
+        /* Just in case some part of the lock worked */
+        mca_fbtl_uring_request_data_free (data);
+        return OMPI_ERROR;
+    }
+
+    /* ops that do not fit into the ring are submitted by
+       mca_fbtl_uring_progress() */
+    if (OMPI_SUCCESS != mca_fbtl_uring_submit (data) && 0 == data->op_active) {
+        mca_fbtl_uring_request_data_free (data);
+        return OMPI_ERROR;
+    }
+
+    req->req_data = data;
+    req->req_progress_fn = mca_fbtl_uring_progress;
+    req->req_free_fn     = mca_fbtl_uring_request_free;
+
+    return OMPI_SUCCESS;
+}
+
+ssize_t mca_fbtl_uring_ipreadv (ompio_file_t *fh, ompi_request_t *request)
+{
+    return mca_fbtl_uring_nonblocking_op (fh, request, FBTL_URING_READ);
+}
+
+ssize_t mca_fbtl_uring_ipwritev (ompio_file_t *fh, ompi_request_t *request)
+{
+    return mca_fbtl_uring_nonblocking_op (fh, request, FBTL_URING_WRITE);
+}
@@ -28,11 +28,13 @@
 #include "ompi/mca/fcoll/base/fcoll_base_coll_array.h"
 #include "ompi/mca/common/ompio/common_ompio.h"
 #include "ompi/mca/io/io.h"
+#include "ompi/mca/common/ompio/common_ompio_request.h"
 #include "math.h"
 #include "ompi/mca/pml/pml.h"
 #include <unistd.h>
 
 #define DEBUG_ON 0
+#define FCOLL_VULCAN_SHUFFLE_TAG   123
 
 /*Used for loading file-offsets per aggregator*/
 typedef struct mca_io_ompio_local_io_array{
@@ -41,11 +43,43 @@ typedef struct mca_io_ompio_local_io_array{
     int                  process_id;
 }mca_io_ompio_local_io_array;
 
+/* Position in the sorted global iovec, carried over from one cycle to
+   the next */
+typedef struct mca_io_ompio_read_data {
+    struct iovec *global_iov_array;
+    int *sorted, *fview_count;
+    int current_index;
+    MPI_Aint bytes_remaining, total_bytes, bytes_per_cycle;
+} mca_io_ompio_read_data;
+
+/* Buffer, io array and send datatypes of one cycle. Two of them are used
+   alternately, such that the file is read for cycle N+1 while the data
+   of cycle N is scattered to the processes */
+typedef struct mca_io_ompio_read_cycle {
+    char *global_buf;
+    int *disp_index;
+    int **blocklen_per_process;
+    MPI_Aint **displs_per_process;
+    ompi_datatype_t **sendtype;
+    mca_common_ompio_io_array_t *io_array;
+    int num_io_entries;
+    int bytes_received;
+    ompi_request_t *read_req;
+} mca_io_ompio_read_cycle;
+
 
 static int read_heap_sort (mca_io_ompio_local_io_array *io_array,
                            int num_entries,
                            int *sorted);
 
+static MPI_Aint read_cycle_size (ompio_file_t *fh);
+static int read_cycle_alloc (ompio_file_t *fh, mca_io_ompio_read_cycle *cycle,
+                             MPI_Aint bytes_per_cycle);
+static void read_cycle_free (ompio_file_t *fh, mca_io_ompio_read_cycle *cycle);
+static int read_prepare (ompio_file_t *fh, int index, int cycles, int aggregator,
+                         mca_io_ompio_read_data *data, mca_io_ompio_read_cycle *cycle);
+static int read_init (ompio_file_t *fh, mca_io_ompio_read_cycle *cycle, int read_synchType);
+
 
 
 int
@@ -57,17 +91,10 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
 {
     MPI_Aint position = 0;
     MPI_Aint total_bytes = 0;          /* total bytes to be read */
-    MPI_Aint bytes_to_read_in_cycle = 0; /* left to be read in a cycle*/
     MPI_Aint bytes_per_cycle = 0;      /* total read in each cycle by each process*/
     int index = 0, ret=OMPI_SUCCESS;
     int cycles = 0;
-    int i=0, j=0, l=0;
-    int n=0; /* current position in total_bytes_per_process array */
-    MPI_Aint bytes_remaining = 0; /* how many bytes have been read from the current
-                                     value from total_bytes_per_process */
-    int *sorted_file_offsets=NULL, entries_per_aggregator=0;
-    int bytes_received = 0;
-    int blocks = 0;
+    int i=0;
     /* iovec structure and count of the buffer passed in */
     uint32_t iov_count = 0;
     struct iovec *decoded_iov = NULL;
@@ -75,18 +102,11 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
     size_t current_position = 0;
     struct iovec *local_iov_array=NULL, *global_iov_array=NULL;
     char *receive_buf = NULL;
-    MPI_Aint *memory_displacements=NULL;
     /* global iovec at the readers that contain the iovecs created from
        file_set_view */
     uint32_t total_fview_count = 0;
     int local_count = 0;
-    int *fview_count = NULL, *disp_index=NULL, *temp_disp_index=NULL;
-    int current_index=0, temp_index=0;
-    int **blocklen_per_process=NULL;
-    MPI_Aint **displs_per_process=NULL;
-    char *global_buf = NULL;
-    MPI_Aint global_count = 0;
-    mca_io_ompio_local_io_array *file_offsets_for_agg=NULL;
+    int *fview_count = NULL;
 
     /* array that contains the sorted indices of the global_iov */
     int *sorted = NULL;
@@ -94,13 +114,14 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
     int vulcan_num_io_procs;
     size_t max_data = 0;
     MPI_Aint *total_bytes_per_process = NULL;
-    ompi_datatype_t **sendtype = NULL;
     MPI_Request *send_req=NULL, recv_req=NULL;
     int my_aggregator =-1;
     bool recvbuf_is_contiguous=false;
     size_t ftype_size;
     ptrdiff_t ftype_extent, lb;
-
+    int read_synch_type = 2;
+    mca_io_ompio_read_data read_data;
+    mca_io_ompio_read_cycle cycle[2], *cur = NULL, *next = NULL;
 
 #if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
     double read_time = 0.0, start_read_time = 0.0, end_read_time = 0.0;
@@ -109,6 +130,10 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
     mca_common_ompio_print_entry nentry;
 #endif
 
+    memset (cycle, 0, sizeof(cycle));
+    cycle[0].read_req = MPI_REQUEST_NULL;
+    cycle[1].read_req = MPI_REQUEST_NULL;
+
     /**************************************************************************
      ** 1. In case the data is not contigous in memory, decode it into an iovec
      **************************************************************************/
@@ -150,6 +175,12 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
         goto exit;
     }
 
+    if( (1 == mca_fcoll_vulcan_async_io) && (NULL == fh->f_fbtl->fbtl_ipreadv) ) {
+        opal_output (1, "vulcan_read_all: fbtl Does NOT support ipreadv() (asynchrounous read) \n");
+        ret = MPI_ERR_UNSUPPORTED_OPERATION;
+        goto exit;
+    }
+
     ret = mca_common_ompio_set_aggregator_props ((struct ompio_file_t *) fh,
                                                  vulcan_num_io_procs,
                                                  max_data);
@@ -338,36 +369,23 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
      *** 6. Determine the number of cycles required to execute this
      ***    operation
      *************************************************************/
-    bytes_per_cycle = fh->f_bytes_per_agg;
+    bytes_per_cycle = read_cycle_size (fh);
     cycles = ceil((double)total_bytes/bytes_per_cycle);
 
-    if ( my_aggregator == fh->f_rank) {
-      disp_index = (int *)malloc (fh->f_procs_per_group * sizeof (int));
-      if (NULL == disp_index) {
-            opal_output (1, "OUT OF MEMORY\n");
-            ret = OMPI_ERR_OUT_OF_RESOURCE;
-            goto exit;
-        }
-
-        blocklen_per_process = (int **)malloc (fh->f_procs_per_group * sizeof (int*));
-        if (NULL == blocklen_per_process) {
-            opal_output (1, "OUT OF MEMORY\n");
-            ret = OMPI_ERR_OUT_OF_RESOURCE;
-            goto exit;
-        }
-
-        displs_per_process = (MPI_Aint **)malloc (fh->f_procs_per_group * sizeof (MPI_Aint*));
-        if (NULL == displs_per_process){
-            opal_output (1, "OUT OF MEMORY\n");
-            ret = OMPI_ERR_OUT_OF_RESOURCE;
-            goto exit;
-        }
+    if( (1 == mca_fcoll_vulcan_async_io) ||
+        ( (0 == mca_fcoll_vulcan_async_io) && (NULL != fh->f_fbtl->fbtl_ipreadv) && (2 < cycles) ) ) {
+        read_synch_type = 1;
+    }
 
-        for (i=0;i<fh->f_procs_per_group;i++){
-            blocklen_per_process[i] = NULL;
-            displs_per_process[i] = NULL;
-        }
+    read_data.global_iov_array = global_iov_array;
+    read_data.sorted           = sorted;
+    read_data.fview_count      = fview_count;
+    read_data.current_index    = 0;
+    read_data.bytes_remaining  = 0;
+    read_data.total_bytes      = total_bytes;
+    read_data.bytes_per_cycle  = bytes_per_cycle;
 
+    if ( my_aggregator == fh->f_rank) {
 	send_req = (MPI_Request *) malloc (fh->f_procs_per_group * sizeof(MPI_Request));
 	if (NULL == send_req){
 	    opal_output ( 1, "OUT OF MEMORY\n");
@@ -375,387 +393,103 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
 	    goto exit;
 	}
 
-	global_buf = (char *) malloc (bytes_per_cycle);
-	if (NULL == global_buf){
-	    opal_output(1, "OUT OF MEMORY\n");
-	    ret = OMPI_ERR_OUT_OF_RESOURCE;
-	    goto exit;
-	}
-
-	sendtype = (ompi_datatype_t **) malloc (fh->f_procs_per_group * sizeof(ompi_datatype_t *));
-	if (NULL == sendtype) {
-            opal_output (1, "OUT OF MEMORY\n");
-	    ret = OMPI_ERR_OUT_OF_RESOURCE;
-	    goto exit;
-	}
-
-	for(l=0;l<fh->f_procs_per_group;l++){
-            sendtype[l] = MPI_DATATYPE_NULL;
-	}
+        for (i=0; i<2; i++) {
+            ret = read_cycle_alloc (fh, &cycle[i], bytes_per_cycle);
+            if (OMPI_SUCCESS != ret) {
+                goto exit;
+            }
+        }
+        if (1 == read_synch_type) {
+            /* Register progress function that should be used by ompi_request_wait */
+            mca_common_ompio_register_progress ();
+        }
     }
 
-
-
-
 #if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
     start_rexch = MPI_Wtime();
 #endif
-    n = 0;
-    bytes_remaining = 0;
-    current_index = 0;
-
-    for (index = 0; index < cycles; index++) {
-        /**********************************************************************
-         ***  7a. Getting ready for next cycle: initializing and freeing buffers
-	 **********************************************************************/
-        if (my_aggregator == fh->f_rank) {
-             if (NULL != fh->f_io_array) {
-                free (fh->f_io_array);
-                fh->f_io_array = NULL;
-            }
-            fh->f_num_of_io_entries = 0;
-
-            if (NULL != sendtype){
-                for (i =0; i< fh->f_procs_per_group; i++) {
-		    if ( MPI_DATATYPE_NULL != sendtype[i] ) {
-                        ompi_datatype_destroy(&sendtype[i]);
-                        sendtype[i] = MPI_DATATYPE_NULL;
-                    }
-		}
-            }
-
-            for(l=0;l<fh->f_procs_per_group;l++){
-                disp_index[l] =  1;
-
-                if (NULL != blocklen_per_process[l]){
-                    free(blocklen_per_process[l]);
-                    blocklen_per_process[l] = NULL;
-                }
-                if (NULL != displs_per_process[l]){
-                    free(displs_per_process[l]);
-                    displs_per_process[l] = NULL;
-                }
-                blocklen_per_process[l] = (int *) calloc (1, sizeof(int));
-                if (NULL == blocklen_per_process[l]) {
-                    opal_output (1, "OUT OF MEMORY for blocklen\n");
-                    ret = OMPI_ERR_OUT_OF_RESOURCE;
-                    goto exit;
-                }
-                displs_per_process[l] = (MPI_Aint *) calloc (1, sizeof(MPI_Aint));
-                if (NULL == displs_per_process[l]){
-                    opal_output (1, "OUT OF MEMORY for displs\n");
-                    ret = OMPI_ERR_OUT_OF_RESOURCE;
-                    goto exit;
-                }
-            }
-
-            if (NULL != sorted_file_offsets){
-                free(sorted_file_offsets);
-                sorted_file_offsets = NULL;
-            }
-
-            if(NULL != file_offsets_for_agg){
-                free(file_offsets_for_agg);
-                file_offsets_for_agg = NULL;
-            }
-            if (NULL != memory_displacements){
-                free(memory_displacements);
-                memory_displacements = NULL;
-            }
-        }  /* (my_aggregator == fh->f_rank */
-
-        /**************************************************************************
-         ***  7b. Determine the number of bytes to be actually read in this cycle
-	 **************************************************************************/
-        if (cycles-1 == index) {
-            bytes_to_read_in_cycle = total_bytes - bytes_per_cycle*index;
-        }
-        else {
-            bytes_to_read_in_cycle = bytes_per_cycle;
+    /**********************************************************************
+     *** 7. Start reading the first cycle. In every cycle, the read of the
+     ***    next cycle is started before the data of the current one is
+     ***    scattered, so that the aggregators do not sit idle during the
+     ***    exchange.
+     **********************************************************************/
+    if ( cycles > 0 ) {
+        ret = read_prepare (fh, 0, cycles, my_aggregator, &read_data, &cycle[0]);
+        if (OMPI_SUCCESS != ret) {
+            goto exit;
         }
-
-#if DEBUG_ON
         if (my_aggregator == fh->f_rank) {
-            printf ("****%d: CYCLE %d   Bytes %d**********\n",
-                    fh->f_rank,
-                    index,
-                    bytes_to_write_in_cycle);
-        }
+#if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
+            start_read_time = MPI_Wtime();
 #endif
-
-        /*****************************************************************
-         *** 7c. Calculate how much data will be contributed in this cycle
-	 ***     by each process
-         *****************************************************************/
-        bytes_received = 0;
-
-        while (bytes_to_read_in_cycle) {
-            /* This next block identifies which process is the holder
-            ** of the sorted[current_index] element;
-            */
-            blocks = fview_count[0];
-            for (j=0 ; j<fh->f_procs_per_group ; j++) {
-                if (sorted[current_index] < blocks) {
-                    n = j;
-                    break;
-                }
-                else {
-                    blocks += fview_count[j+1];
-                }
-            }
-
-            if (bytes_remaining) {
-                /* Finish up a partially used buffer from the previous  cycle */
-                if (bytes_remaining <= bytes_to_read_in_cycle) {
-                    /* Data fits completely into the block */
-                    if (my_aggregator == fh->f_rank) {
-                        blocklen_per_process[n][disp_index[n] - 1] = bytes_remaining;
-                        displs_per_process[n][disp_index[n] - 1] =
-                            (ptrdiff_t)global_iov_array[sorted[current_index]].iov_base +
-                            (global_iov_array[sorted[current_index]].iov_len - bytes_remaining);
-
-                        blocklen_per_process[n] = (int *) realloc
-                            ((void *)blocklen_per_process[n], (disp_index[n]+1)*sizeof(int));
-                        displs_per_process[n] = (MPI_Aint *) realloc
-                            ((void *)displs_per_process[n], (disp_index[n]+1)*sizeof(MPI_Aint));
-                        blocklen_per_process[n][disp_index[n]] = 0;
-                        displs_per_process[n][disp_index[n]] = 0;
-                        disp_index[n] += 1;
-                    }
-                    if (fh->f_procs_in_group[n] == fh->f_rank) {
-                        bytes_received += bytes_remaining;
-                    }
-                    current_index ++;
-                    bytes_to_read_in_cycle -= bytes_remaining;
-                    bytes_remaining = 0;
-                    continue;
-                }
-                else {
-                     /* the remaining data from the previous cycle is larger than the
-                        bytes_to_write_in_cycle, so we have to segment again */
-                    if (my_aggregator == fh->f_rank) {
-                        blocklen_per_process[n][disp_index[n] - 1] = bytes_to_read_in_cycle;
-                        displs_per_process[n][disp_index[n] - 1] =
-                            (ptrdiff_t)global_iov_array[sorted[current_index]].iov_base +
-                            (global_iov_array[sorted[current_index]].iov_len
-                             - bytes_remaining);
-                    }
-                    if (fh->f_procs_in_group[n] == fh->f_rank) {
-                        bytes_received += bytes_to_read_in_cycle;
-                    }
-                    bytes_remaining -= bytes_to_read_in_cycle;
-                    bytes_to_read_in_cycle = 0;
-                    break;
-                }
-            }
-            else {
-                /* No partially used entry available, have to start a new one */
-                if (bytes_to_read_in_cycle <
-                    (MPI_Aint) global_iov_array[sorted[current_index]].iov_len) {
-                    /* This entry has more data than we can sendin one cycle */
-                    if (my_aggregator == fh->f_rank) {
-                        blocklen_per_process[n][disp_index[n] - 1] = bytes_to_read_in_cycle;
-                        displs_per_process[n][disp_index[n] - 1] =
-                            (ptrdiff_t)global_iov_array[sorted[current_index]].iov_base ;
-                    }
-
-                    if (fh->f_procs_in_group[n] == fh->f_rank) {
-                        bytes_received += bytes_to_read_in_cycle;
-                    }
-                    bytes_remaining = global_iov_array[sorted[current_index]].iov_len -
-                        bytes_to_read_in_cycle;
-                    bytes_to_read_in_cycle = 0;
-                    break;
-                }
-                else {
-                    /* Next data entry is less than bytes_to_write_in_cycle */
-                    if (my_aggregator ==  fh->f_rank) {
-                        blocklen_per_process[n][disp_index[n] - 1] =
-                            global_iov_array[sorted[current_index]].iov_len;
-                        displs_per_process[n][disp_index[n] - 1] = (ptrdiff_t)
-                            global_iov_array[sorted[current_index]].iov_base;
-                        blocklen_per_process[n] =
-                            (int *) realloc ((void *)blocklen_per_process[n], (disp_index[n]+1)*sizeof(int));
-                        displs_per_process[n] = (MPI_Aint *)realloc
-                            ((void *)displs_per_process[n], (disp_index[n]+1)*sizeof(MPI_Aint));
-                        blocklen_per_process[n][disp_index[n]] = 0;
-                        displs_per_process[n][disp_index[n]] = 0;
-                        disp_index[n] += 1;
-                    }
-                    if (fh->f_procs_in_group[n] == fh->f_rank) {
-                        bytes_received +=
-                            global_iov_array[sorted[current_index]].iov_len;
-                    }
-                    bytes_to_read_in_cycle -=
-                        global_iov_array[sorted[current_index]].iov_len;
-                    current_index ++;
-                    continue;
-                }
-            }
-        } /* end while (bytes_to_read_in_cycle) */
-
-        /*************************************************************************
-	 *** 7d. Calculate the displacement on where to put the data and allocate
-         ***     the recieve buffer (global_buf)
-	 *************************************************************************/
-        if (my_aggregator == fh->f_rank) {
-            entries_per_aggregator=0;
-            for (i=0;i<fh->f_procs_per_group; i++){
-                for (j=0;j<disp_index[i];j++){
-                    if (blocklen_per_process[i][j] > 0)
-                        entries_per_aggregator++ ;
-                }
-            }
-            if (entries_per_aggregator > 0){
-                file_offsets_for_agg = (mca_io_ompio_local_io_array *)
-                    malloc(entries_per_aggregator*sizeof(mca_io_ompio_local_io_array));
-                if (NULL == file_offsets_for_agg) {
-                    opal_output (1, "OUT OF MEMORY\n");
-                    ret = OMPI_ERR_OUT_OF_RESOURCE;
-                    goto exit;
-                }
-                sorted_file_offsets = (int *)
-                    malloc (entries_per_aggregator*sizeof(int));
-                if (NULL == sorted_file_offsets){
-                    opal_output (1, "OUT OF MEMORY\n");
-                    ret =  OMPI_ERR_OUT_OF_RESOURCE;
-                    goto exit;
-                }
-                /*Moving file offsets to an IO array!*/
-                temp_index = 0;
-                global_count = 0;
-                for (i=0;i<fh->f_procs_per_group; i++){
-                    for(j=0;j<disp_index[i];j++){
-                        if (blocklen_per_process[i][j] > 0){
-                            file_offsets_for_agg[temp_index].length =
-                                blocklen_per_process[i][j];
-                            global_count += blocklen_per_process[i][j];
-                            file_offsets_for_agg[temp_index].process_id = i;
-                            file_offsets_for_agg[temp_index].offset =
-                                displs_per_process[i][j];
-                            temp_index++;
-                        }
-                    }
-                }
-            }
-            else{
-                continue;
-            }
-
-             /* Sort the displacements for each aggregator */
-            read_heap_sort (file_offsets_for_agg,
-                            entries_per_aggregator,
-                            sorted_file_offsets);
-
-            memory_displacements = (MPI_Aint *) malloc
-                (entries_per_aggregator * sizeof(MPI_Aint));
-            memory_displacements[sorted_file_offsets[0]] = 0;
-            for (i=1; i<entries_per_aggregator; i++){
-                memory_displacements[sorted_file_offsets[i]] =
-                    memory_displacements[sorted_file_offsets[i-1]] +
-                    file_offsets_for_agg[sorted_file_offsets[i-1]].length;
-            }
-
-             /**********************************************************
-	     *** 7e. Create the io array, and pass it to fbtl
-	     *********************************************************/
-            fh->f_io_array = (mca_common_ompio_io_array_t *) malloc
-                (entries_per_aggregator * sizeof (mca_common_ompio_io_array_t));
-            if (NULL == fh->f_io_array) {
-                opal_output(1, "OUT OF MEMORY\n");
-                ret = OMPI_ERR_OUT_OF_RESOURCE;
+            ret = read_init (fh, &cycle[0], read_synch_type);
+            if (OMPI_SUCCESS != ret) {
                 goto exit;
             }
+#if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
+            end_read_time = MPI_Wtime();
+            read_time += end_read_time - start_read_time;
+#endif
+        }
+    }
 
-            fh->f_num_of_io_entries = 0;
-            fh->f_io_array[0].offset =
-                (IOVBASE_TYPE *)(intptr_t)file_offsets_for_agg[sorted_file_offsets[0]].offset;
-            fh->f_io_array[0].length =
-                file_offsets_for_agg[sorted_file_offsets[0]].length;
-            fh->f_io_array[0].memory_address =
-                global_buf+memory_displacements[sorted_file_offsets[0]];
-            fh->f_num_of_io_entries++;
-            for (i=1;i<entries_per_aggregator;i++){
-                if (file_offsets_for_agg[sorted_file_offsets[i-1]].offset +
-                    file_offsets_for_agg[sorted_file_offsets[i-1]].length ==
-                    file_offsets_for_agg[sorted_file_offsets[i]].offset){
-                    fh->f_io_array[fh->f_num_of_io_entries - 1].length +=
-                        file_offsets_for_agg[sorted_file_offsets[i]].length;
-                }
-                else{
-                    fh->f_io_array[fh->f_num_of_io_entries].offset =
-                        (IOVBASE_TYPE *)(intptr_t)file_offsets_for_agg[sorted_file_offsets[i]].offset;
-                    fh->f_io_array[fh->f_num_of_io_entries].length =
-                        file_offsets_for_agg[sorted_file_offsets[i]].length;
-                    fh->f_io_array[fh->f_num_of_io_entries].memory_address =
-                        global_buf+memory_displacements[sorted_file_offsets[i]];
-                    fh->f_num_of_io_entries++;
-                }
-            }
-
+    for (index = 0; index < cycles; index++) {
+        cur  = &cycle[index % 2];
+        next = &cycle[(index + 1) % 2];
 
+        /**********************************************************************
+         ***  7a. Wait for the data of this cycle and start reading the next one
+         **********************************************************************/
+        if (my_aggregator == fh->f_rank) {
 #if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
             start_read_time = MPI_Wtime();
 #endif
-
-            if (fh->f_num_of_io_entries) {
-                if ( 0 >  fh->f_fbtl->fbtl_preadv (fh)) {
-                    opal_output (1, "READ FAILED\n");
-                    ret = OMPI_ERROR;
-                    goto exit;
-                }
+            ret = ompi_request_wait (&cur->read_req, MPI_STATUS_IGNORE);
+            if (OMPI_SUCCESS != ret) {
+                goto exit;
             }
-
 #if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
             end_read_time = MPI_Wtime();
             read_time += end_read_time - start_read_time;
 #endif
-            /**********************************************************
-             ******************** DONE READING ************************
-             *********************************************************/
+        }
 
-            temp_disp_index = (int *)calloc (1, fh->f_procs_per_group * sizeof (int));
-            if (NULL == temp_disp_index) {
-                opal_output (1, "OUT OF MEMORY\n");
-                ret = OMPI_ERR_OUT_OF_RESOURCE;
+        if (index + 1 < cycles) {
+            ret = read_prepare (fh, index + 1, cycles, my_aggregator, &read_data, next);
+            if (OMPI_SUCCESS != ret) {
                 goto exit;
             }
-            for (i=0; i<entries_per_aggregator; i++){
-                temp_index =
-                    file_offsets_for_agg[sorted_file_offsets[i]].process_id;
-                displs_per_process[temp_index][temp_disp_index[temp_index]] =
-                    memory_displacements[sorted_file_offsets[i]];
-                if (temp_disp_index[temp_index] < disp_index[temp_index]){
-                    temp_disp_index[temp_index] += 1;
-                }
-                else{
-                    printf("temp_disp_index[%d]: %d is greater than disp_index[%d]: %d\n",
-                           temp_index, temp_disp_index[temp_index],
-                           temp_index, disp_index[temp_index]);
+            if (my_aggregator == fh->f_rank) {
+#if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
+                start_read_time = MPI_Wtime();
+#endif
+                ret = read_init (fh, next, read_synch_type);
+                if (OMPI_SUCCESS != ret) {
+                    goto exit;
                 }
+#if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
+                end_read_time = MPI_Wtime();
+                read_time += end_read_time - start_read_time;
+#endif
             }
-            if (NULL != temp_disp_index){
-                free(temp_disp_index);
-                temp_disp_index = NULL;
-            }
+        }
 
+        /**********************************************************
+         *** 7b.  Scatter the Data from the readers
+         *********************************************************/
 #if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
-            start_rcomm_time = MPI_Wtime();
+        start_rcomm_time = MPI_Wtime();
 #endif
+        if (my_aggregator == fh->f_rank) {
             for (i=0;i<fh->f_procs_per_group;i++){
                 send_req[i] = MPI_REQUEST_NULL;
-                if ( 0 < disp_index[i] ) {
-                    ompi_datatype_create_hindexed(disp_index[i],
-                                                  blocklen_per_process[i],
-                                                  displs_per_process[i],
-                                                  MPI_BYTE,
-                                                  &sendtype[i]);
-                    ompi_datatype_commit(&sendtype[i]);
-                    ret = MCA_PML_CALL (isend(global_buf,
+                if ( MPI_DATATYPE_NULL != cur->sendtype[i] ) {
+                    ret = MCA_PML_CALL (isend(cur->global_buf,
                                               1,
-                                              sendtype[i],
+                                              cur->sendtype[i],
                                               fh->f_procs_in_group[i],
-                                              123,
+                                              FCOLL_VULCAN_SHUFFLE_TAG,
                                               MCA_PML_BASE_SEND_STANDARD,
                                               fh->f_comm,
                                               &send_req[i]));
@@ -764,23 +498,16 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
                     }
                 }
             }
-#if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
-            end_rcomm_time = MPI_Wtime();
-            rcomm_time += end_rcomm_time - start_rcomm_time;
-#endif
         }
 
-        /**********************************************************
-         *** 7f.  Scatter the Data from the readers
-         *********************************************************/
         if ( recvbuf_is_contiguous ) {
             receive_buf = &((char*)buf)[position];
         }
-        else if (bytes_received) {
+        else if (cur->bytes_received) {
             /* allocate a receive buffer and copy the data that needs
                to be received into it in case the data is non-contigous
                in memory */
-            receive_buf = malloc (bytes_received);
+            receive_buf = malloc (cur->bytes_received);
             if (NULL == receive_buf) {
                 opal_output (1, "OUT OF MEMORY\n");
                 ret = OMPI_ERR_OUT_OF_RESOURCE;
@@ -788,14 +515,11 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
             }
         }
 
-#if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
-        start_rcomm_time = MPI_Wtime();
-#endif
         ret = MCA_PML_CALL(irecv(receive_buf,
-                                 bytes_received,
+                                 cur->bytes_received,
                                  MPI_BYTE,
                                  my_aggregator,
-                                 123,
+                                 FCOLL_VULCAN_SHUFFLE_TAG,
                                  fh->f_comm,
                                  &recv_req));
         if (OMPI_SUCCESS != ret){
@@ -816,7 +540,7 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
         if (OMPI_SUCCESS != ret){
             goto exit;
         }
-        position += bytes_received;
+        position += cur->bytes_received;
 
         /* If data is not contigous in memory, copy the data from the
            receive buffer into the buffer passed in */
@@ -825,7 +549,7 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
             size_t remaining = 0;
             size_t temp_position = 0;
 
-            remaining = bytes_received;
+            remaining = cur->bytes_received;
 
             while (remaining) {
                 mem_address = (ptrdiff_t)
@@ -887,9 +611,21 @@ exit:
             receive_buf = NULL;
         }
     }
-    if (NULL != global_buf) {
-        free (global_buf);
-        global_buf = NULL;
+    if (my_aggregator == fh->f_rank) {
+        /* a read still in flight after an error must not land in a freed buffer */
+        for (i=0; i<2; i++) {
+            if (MPI_REQUEST_NULL != cycle[i].read_req) {
+                ompi_request_wait (&cycle[i].read_req, MPI_STATUS_IGNORE);
+                if (MPI_REQUEST_NULL != cycle[i].read_req) {
+                    ompi_request_free (&cycle[i].read_req);
+                }
+            }
+            read_cycle_free (fh, &cycle[i]);
+        }
+        if ( NULL != send_req ) {
+            free ( send_req );
+            send_req = NULL;
+        }
     }
     if (NULL != sorted) {
         free (sorted);
@@ -916,62 +652,458 @@ exit:
         free (displs);
         displs = NULL;
     }
-    if (my_aggregator == fh->f_rank) {
+    return ret;
+}
+
+
+/* Size of each of the two cycle buffers. Half of the aggregation buffer,
+   since two cycles are in flight at the same time, rounded down to full
+   stripes of the file system, or to the block size where the file system
+   does not report a stripe size. All processes compute the same value. */
+static MPI_Aint read_cycle_size (ompio_file_t *fh)
+{
+    MPI_Aint bytes_per_cycle = fh->f_bytes_per_agg / 2;
+    MPI_Aint stripe_size = (MPI_Aint) fh->f_stripe_size;
+
+    if (0 >= stripe_size) {
+        stripe_size = fh->f_fs_block_size;
+    }
+    if (0 < stripe_size) {
+        if (bytes_per_cycle < stripe_size) {
+            bytes_per_cycle = stripe_size;
+        }
+        else {
+            bytes_per_cycle -= bytes_per_cycle % stripe_size;
+        }
+    }
+    if (0 >= bytes_per_cycle) {
+        bytes_per_cycle = fh->f_bytes_per_agg;
+    }
+
+    return bytes_per_cycle;
+}
+
+static int read_cycle_alloc (ompio_file_t *fh, mca_io_ompio_read_cycle *cycle,
+                             MPI_Aint bytes_per_cycle)
+{
+    int l;
+
+    cycle->global_buf = (char *) malloc (bytes_per_cycle);
+    cycle->disp_index = (int *) malloc (fh->f_procs_per_group * sizeof (int));
+    cycle->blocklen_per_process = (int **) calloc (fh->f_procs_per_group, sizeof (int*));
+    cycle->displs_per_process = (MPI_Aint **) calloc (fh->f_procs_per_group, sizeof (MPI_Aint*));
+    cycle->sendtype = (ompi_datatype_t **) malloc (fh->f_procs_per_group * sizeof(ompi_datatype_t *));
+    if (NULL == cycle->global_buf || NULL == cycle->disp_index ||
+        NULL == cycle->blocklen_per_process || NULL == cycle->displs_per_process ||
+        NULL == cycle->sendtype) {
+        opal_output (1, "OUT OF MEMORY\n");
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    for(l=0;l<fh->f_procs_per_group;l++){
+        cycle->sendtype[l] = MPI_DATATYPE_NULL;
+    }
+
+    return OMPI_SUCCESS;
+}
+
+static void read_cycle_free (ompio_file_t *fh, mca_io_ompio_read_cycle *cycle)
+{
+    int l;
 
-        if (NULL != sorted_file_offsets){
-            free(sorted_file_offsets);
-            sorted_file_offsets = NULL;
+    if (NULL != cycle->sendtype){
+        for (l = 0; l < fh->f_procs_per_group; l++) {
+            if ( MPI_DATATYPE_NULL != cycle->sendtype[l] ) {
+                ompi_datatype_destroy(&cycle->sendtype[l]);
+            }
         }
-        if (NULL != file_offsets_for_agg){
-            free(file_offsets_for_agg);
-            file_offsets_for_agg = NULL;
+        free(cycle->sendtype);
+        cycle->sendtype=NULL;
+    }
+    if ( NULL != cycle->blocklen_per_process){
+        for(l=0;l<fh->f_procs_per_group;l++){
+            free(cycle->blocklen_per_process[l]);
         }
-        if (NULL != memory_displacements){
-            free(memory_displacements);
-            memory_displacements= NULL;
+        free(cycle->blocklen_per_process);
+        cycle->blocklen_per_process = NULL;
+    }
+    if (NULL != cycle->displs_per_process){
+        for (l=0; l<fh->f_procs_per_group; l++){
+            free(cycle->displs_per_process[l]);
         }
-        if (NULL != sendtype){
-            for (i = 0; i < fh->f_procs_per_group; i++) {
-                if ( MPI_DATATYPE_NULL != sendtype[i] ) {
-                    ompi_datatype_destroy(&sendtype[i]);
-                }
+        free(cycle->displs_per_process);
+        cycle->displs_per_process = NULL;
+    }
+    free (cycle->disp_index);
+    cycle->disp_index = NULL;
+    free (cycle->io_array);
+    cycle->io_array = NULL;
+    free (cycle->global_buf);
+    cycle->global_buf = NULL;
+}
+
+/* Determine the data read in cycle 'index': the number of bytes each
+   process receives, and at the aggregator the io array for the fbtl and
+   the datatypes used to scatter the data out of the cycle buffer. */
+static int read_prepare (ompio_file_t *fh, int index, int cycles, int aggregator,
+                         mca_io_ompio_read_data *data, mca_io_ompio_read_cycle *cycle)
+{
+    MPI_Aint bytes_to_read_in_cycle = 0; /* left to be read in a cycle*/
+    int i, j, l, n = 0, blocks = 0, ret = OMPI_SUCCESS;
+    int entries_per_aggregator = 0, temp_index = 0;
+    int *sorted_file_offsets = NULL, *temp_disp_index = NULL;
+    MPI_Aint *memory_displacements = NULL;
+    mca_io_ompio_local_io_array *file_offsets_for_agg = NULL;
+    struct iovec *global_iov_array = data->global_iov_array;
+    int *sorted = data->sorted, *fview_count = data->fview_count;
+    int *disp_index = cycle->disp_index;
+    int **blocklen_per_process = cycle->blocklen_per_process;
+    MPI_Aint **displs_per_process = cycle->displs_per_process;
+
+    /**********************************************************************
+     ***  7a. Getting ready for next cycle: initializing and freeing buffers
+     **********************************************************************/
+    cycle->bytes_received = 0;
+    cycle->num_io_entries = 0;
+    if (aggregator == fh->f_rank) {
+        if (NULL != cycle->io_array) {
+            free (cycle->io_array);
+            cycle->io_array = NULL;
+        }
+
+        for (i =0; i< fh->f_procs_per_group; i++) {
+            if ( MPI_DATATYPE_NULL != cycle->sendtype[i] ) {
+                ompi_datatype_destroy(&cycle->sendtype[i]);
+                cycle->sendtype[i] = MPI_DATATYPE_NULL;
             }
-            free(sendtype);
-            sendtype=NULL;
         }
 
-        if (NULL != disp_index){
-            free(disp_index);
-            disp_index = NULL;
+        for(l=0;l<fh->f_procs_per_group;l++){
+            disp_index[l] =  1;
+
+            if (NULL != blocklen_per_process[l]){
+                free(blocklen_per_process[l]);
+                blocklen_per_process[l] = NULL;
+            }
+            if (NULL != displs_per_process[l]){
+                free(displs_per_process[l]);
+                displs_per_process[l] = NULL;
+            }
+            blocklen_per_process[l] = (int *) calloc (1, sizeof(int));
+            if (NULL == blocklen_per_process[l]) {
+                opal_output (1, "OUT OF MEMORY for blocklen\n");
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
+            displs_per_process[l] = (MPI_Aint *) calloc (1, sizeof(MPI_Aint));
+            if (NULL == displs_per_process[l]){
+                opal_output (1, "OUT OF MEMORY for displs\n");
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
         }
+    }
 
-        if ( NULL != blocklen_per_process){
-            for(l=0;l<fh->f_procs_per_group;l++){
-                if (NULL != blocklen_per_process[l]){
-                    free(blocklen_per_process[l]);
-                    blocklen_per_process[l] = NULL;
-                }
+    /**************************************************************************
+     ***  7b. Determine the number of bytes to be actually read in this cycle
+     **************************************************************************/
+    if (cycles-1 == index) {
+        bytes_to_read_in_cycle = data->total_bytes - data->bytes_per_cycle*index;
+    }
+    else {
+        bytes_to_read_in_cycle = data->bytes_per_cycle;
+    }
+
+#if DEBUG_ON
+    if (aggregator == fh->f_rank) {
+        printf ("****%d: CYCLE %d   Bytes %ld**********\n",
+                fh->f_rank,
+                index,
+                bytes_to_read_in_cycle);
+    }
+#endif
+
+    /*****************************************************************
+     *** 7c. Calculate how much data will be contributed in this cycle
+     ***     by each process
+     *****************************************************************/
+    while (bytes_to_read_in_cycle) {
+        /* This next block identifies which process is the holder
+        ** of the sorted[current_index] element;
+        */
+        blocks = fview_count[0];
+        for (j=0 ; j<fh->f_procs_per_group ; j++) {
+            if (sorted[data->current_index] < blocks) {
+                n = j;
+                break;
             }
+            else {
+                blocks += fview_count[j+1];
+            }
+        }
 
-            free(blocklen_per_process);
-            blocklen_per_process = NULL;
+        if (data->bytes_remaining) {
+            /* Finish up a partially used buffer from the previous  cycle */
+            if (data->bytes_remaining <= bytes_to_read_in_cycle) {
+                /* Data fits completely into the block */
+                if (aggregator == fh->f_rank) {
+                    blocklen_per_process[n][disp_index[n] - 1] = data->bytes_remaining;
+                    displs_per_process[n][disp_index[n] - 1] =
+                        (ptrdiff_t)global_iov_array[sorted[data->current_index]].iov_base +
+                        (global_iov_array[sorted[data->current_index]].iov_len - data->bytes_remaining);
+
+                    blocklen_per_process[n] = (int *) realloc
+                        ((void *)blocklen_per_process[n], (disp_index[n]+1)*sizeof(int));
+                    displs_per_process[n] = (MPI_Aint *) realloc
+                        ((void *)displs_per_process[n], (disp_index[n]+1)*sizeof(MPI_Aint));
+                    blocklen_per_process[n][disp_index[n]] = 0;
+                    displs_per_process[n][disp_index[n]] = 0;
+                    disp_index[n] += 1;
+                }
+                if (fh->f_procs_in_group[n] == fh->f_rank) {
+                    cycle->bytes_received += data->bytes_remaining;
+                }
+                data->current_index ++;
+                bytes_to_read_in_cycle -= data->bytes_remaining;
+                data->bytes_remaining = 0;
+                continue;
+            }
+            else {
+                /* the remaining data from the previous cycle is larger than the
+                   bytes_to_read_in_cycle, so we have to segment again */
+                if (aggregator == fh->f_rank) {
+                    blocklen_per_process[n][disp_index[n] - 1] = bytes_to_read_in_cycle;
+                    displs_per_process[n][disp_index[n] - 1] =
+                        (ptrdiff_t)global_iov_array[sorted[data->current_index]].iov_base +
+                        (global_iov_array[sorted[data->current_index]].iov_len
+                         - data->bytes_remaining);
+                }
+                if (fh->f_procs_in_group[n] == fh->f_rank) {
+                    cycle->bytes_received += bytes_to_read_in_cycle;
+                }
+                data->bytes_remaining -= bytes_to_read_in_cycle;
+                bytes_to_read_in_cycle = 0;
+                break;
+            }
         }
+        else {
+            /* No partially used entry available, have to start a new one */
+            if (bytes_to_read_in_cycle <
+                (MPI_Aint) global_iov_array[sorted[data->current_index]].iov_len) {
+                /* This entry has more data than we can sendin one cycle */
+                if (aggregator == fh->f_rank) {
+                    blocklen_per_process[n][disp_index[n] - 1] = bytes_to_read_in_cycle;
+                    displs_per_process[n][disp_index[n] - 1] =
+                        (ptrdiff_t)global_iov_array[sorted[data->current_index]].iov_base ;
+                }
 
-        if (NULL != displs_per_process){
-            for (l=0; i<fh->f_procs_per_group; l++){
-                if (NULL != displs_per_process[l]){
-                    free(displs_per_process[l]);
-                    displs_per_process[l] = NULL;
+                if (fh->f_procs_in_group[n] == fh->f_rank) {
+                    cycle->bytes_received += bytes_to_read_in_cycle;
+                }
+                data->bytes_remaining = global_iov_array[sorted[data->current_index]].iov_len -
+                    bytes_to_read_in_cycle;
+                bytes_to_read_in_cycle = 0;
+                break;
+            }
+            else {
+                /* Next data entry is less than bytes_to_read_in_cycle */
+                if (aggregator ==  fh->f_rank) {
+                    blocklen_per_process[n][disp_index[n] - 1] =
+                        global_iov_array[sorted[data->current_index]].iov_len;
+                    displs_per_process[n][disp_index[n] - 1] = (ptrdiff_t)
+                        global_iov_array[sorted[data->current_index]].iov_base;
+                    blocklen_per_process[n] =
+                        (int *) realloc ((void *)blocklen_per_process[n], (disp_index[n]+1)*sizeof(int));
+                    displs_per_process[n] = (MPI_Aint *)realloc
+                        ((void *)displs_per_process[n], (disp_index[n]+1)*sizeof(MPI_Aint));
+                    blocklen_per_process[n][disp_index[n]] = 0;
+                    displs_per_process[n][disp_index[n]] = 0;
+                    disp_index[n] += 1;
                 }
+                if (fh->f_procs_in_group[n] == fh->f_rank) {
+                    cycle->bytes_received +=
+                        global_iov_array[sorted[data->current_index]].iov_len;
+                }
+                bytes_to_read_in_cycle -=
+                    global_iov_array[sorted[data->current_index]].iov_len;
+                data->current_index ++;
+                continue;
             }
-            free(displs_per_process);
-            displs_per_process = NULL;
         }
-        if ( NULL != send_req ) {
-            free ( send_req );
-            send_req = NULL;
+    } /* end while (bytes_to_read_in_cycle) */
+
+    if (aggregator != fh->f_rank) {
+        return OMPI_SUCCESS;
+    }
+
+    /*************************************************************************
+     *** 7d. Calculate the displacement on where to put the data in the cycle
+     ***     buffer (global_buf)
+     *************************************************************************/
+    for (i=0;i<fh->f_procs_per_group; i++){
+        for (j=0;j<disp_index[i];j++){
+            if (blocklen_per_process[i][j] > 0)
+                entries_per_aggregator++ ;
+        }
+    }
+    if (0 == entries_per_aggregator) {
+        return OMPI_SUCCESS;
+    }
+
+    file_offsets_for_agg = (mca_io_ompio_local_io_array *)
+        malloc(entries_per_aggregator*sizeof(mca_io_ompio_local_io_array));
+    sorted_file_offsets = (int *) malloc (entries_per_aggregator*sizeof(int));
+    memory_displacements = (MPI_Aint *) malloc (entries_per_aggregator * sizeof(MPI_Aint));
+    cycle->io_array = (mca_common_ompio_io_array_t *) malloc
+        (entries_per_aggregator * sizeof (mca_common_ompio_io_array_t));
+    temp_disp_index = (int *)calloc (1, fh->f_procs_per_group * sizeof (int));
+    if (NULL == file_offsets_for_agg || NULL == sorted_file_offsets ||
+        NULL == memory_displacements || NULL == cycle->io_array ||
+        NULL == temp_disp_index) {
+        opal_output (1, "OUT OF MEMORY\n");
+        ret = OMPI_ERR_OUT_OF_RESOURCE;
+        goto exit;
+    }
+
+    /*Moving file offsets to an IO array!*/
+    temp_index = 0;
+    for (i=0;i<fh->f_procs_per_group; i++){
+        for(j=0;j<disp_index[i];j++){
+            if (blocklen_per_process[i][j] > 0){
+                file_offsets_for_agg[temp_index].length =
+                    blocklen_per_process[i][j];
+                file_offsets_for_agg[temp_index].process_id = i;
+                file_offsets_for_agg[temp_index].offset =
+                    displs_per_process[i][j];
+                temp_index++;
+            }
         }
     }
+
+    /* Sort the displacements for each aggregator */
+    read_heap_sort (file_offsets_for_agg,
+                    entries_per_aggregator,
+                    sorted_file_offsets);
+
+    memory_displacements[sorted_file_offsets[0]] = 0;
+    for (i=1; i<entries_per_aggregator; i++){
+        memory_displacements[sorted_file_offsets[i]] =
+            memory_displacements[sorted_file_offsets[i-1]] +
+            file_offsets_for_agg[sorted_file_offsets[i-1]].length;
+    }
+
+    /**********************************************************
+     *** 7e. Create the io array, and the datatypes used to
+     ***     scatter the data once it has been read
+     *********************************************************/
+    cycle->io_array[0].offset =
+        (IOVBASE_TYPE *)(intptr_t)file_offsets_for_agg[sorted_file_offsets[0]].offset;
+    cycle->io_array[0].length =
+        file_offsets_for_agg[sorted_file_offsets[0]].length;
+    cycle->io_array[0].memory_address =
+        cycle->global_buf+memory_displacements[sorted_file_offsets[0]];
+    cycle->num_io_entries++;
+    for (i=1;i<entries_per_aggregator;i++){
+        if (file_offsets_for_agg[sorted_file_offsets[i-1]].offset +
+            file_offsets_for_agg[sorted_file_offsets[i-1]].length ==
+            file_offsets_for_agg[sorted_file_offsets[i]].offset){
+            cycle->io_array[cycle->num_io_entries - 1].length +=
+                file_offsets_for_agg[sorted_file_offsets[i]].length;
+        }
+        else{
+            cycle->io_array[cycle->num_io_entries].offset =
+                (IOVBASE_TYPE *)(intptr_t)file_offsets_for_agg[sorted_file_offsets[i]].offset;
+            cycle->io_array[cycle->num_io_entries].length =
+                file_offsets_for_agg[sorted_file_offsets[i]].length;
+            cycle->io_array[cycle->num_io_entries].memory_address =
+                cycle->global_buf+memory_displacements[sorted_file_offsets[i]];
+            cycle->num_io_entries++;
+        }
+    }
+
+    for (i=0; i<entries_per_aggregator; i++){
+        temp_index =
+            file_offsets_for_agg[sorted_file_offsets[i]].process_id;
+        displs_per_process[temp_index][temp_disp_index[temp_index]] =
+            memory_displacements[sorted_file_offsets[i]];
+        if (temp_disp_index[temp_index] < disp_index[temp_index]){
+            temp_disp_index[temp_index] += 1;
+        }
+        else{
+            printf("temp_disp_index[%d]: %d is greater than disp_index[%d]: %d\n",
+                   temp_index, temp_disp_index[temp_index],
+                   temp_index, disp_index[temp_index]);
+        }
+    }
+
+    for (i=0;i<fh->f_procs_per_group;i++){
+        if ( 0 < disp_index[i] ) {
+            ompi_datatype_create_hindexed(disp_index[i],
+                                          blocklen_per_process[i],
+                                          displs_per_process[i],
+                                          MPI_BYTE,
+                                          &cycle->sendtype[i]);
+            ompi_datatype_commit(&cycle->sendtype[i]);
+        }
+    }
+
+exit:
+    free (temp_disp_index);
+    free (memory_displacements);
+    free (sorted_file_offsets);
+    free (file_offsets_for_agg);
+
+    return ret;
+}
+
+/* Start reading the io array of a cycle into its buffer. The read is
+   asynchronous if the fbtl supports it and read_synchType is 1. */
+static int read_init (ompio_file_t *fh, mca_io_ompio_read_cycle *cycle, int read_synchType)
+{
+    int ret = OMPI_SUCCESS;
+    ssize_t ret_temp = 0;
+    mca_ompio_request_t *ompio_req = NULL;
+
+    mca_common_ompio_request_alloc ( &ompio_req, MCA_OMPIO_REQUEST_READ );
+
+    if (cycle->num_io_entries) {
+        fh->f_io_array = cycle->io_array;
+        fh->f_num_of_io_entries = cycle->num_io_entries;
+
+        if (1 == read_synchType) {
+            ret = fh->f_fbtl->fbtl_ipreadv(fh, (ompi_request_t *) ompio_req);
+            if(0 > ret) {
+                opal_output (1, "vulcan_read_all: fbtl_ipreadv failed\n");
+                ompio_req->req_ompi.req_status.MPI_ERROR = ret;
+                ompio_req->req_ompi.req_status._ucount = 0;
+                ompi_request_complete (&ompio_req->req_ompi, false);
+            }
+            else {
+                ret = OMPI_SUCCESS;
+            }
+        }
+        else {
+            ret_temp = fh->f_fbtl->fbtl_preadv(fh);
+            if(0 > ret_temp) {
+                opal_output (1, "vulcan_read_all: fbtl_preadv failed\n");
+                ret = ret_temp;
+                ret_temp = 0;
+            }
+
+            ompio_req->req_ompi.req_status.MPI_ERROR = ret;
+            ompio_req->req_ompi.req_status._ucount = ret_temp;
+            ompi_request_complete (&ompio_req->req_ompi, false);
+        }
+    }
+    else {
+        ompio_req->req_ompi.req_status.MPI_ERROR = OMPI_SUCCESS;
+        ompio_req->req_ompi.req_status._ucount = 0;
+        ompi_request_complete (&ompio_req->req_ompi, false);
+    }
+
+    cycle->read_req = (ompi_request_t *) ompio_req;
+
+    fh->f_io_array=NULL;
+    fh->f_num_of_io_entries=0;
+
     return ret;
 }
 
@@ -55,6 +55,7 @@ OMPI_DECLSPEC int  mca_fs_base_get_fstype(char *fname);
 OMPI_DECLSPEC int mca_fs_base_get_mpi_err(int errno_val);
 OMPI_DECLSPEC int mca_fs_base_get_file_perm(ompio_file_t *fh);
 OMPI_DECLSPEC int mca_fs_base_get_file_amode(int rank, int access_mode);
+OMPI_DECLSPEC int mca_fs_base_file_open_direct(ompio_file_t *fh, const char *filename, int access_mode);
 
 OMPI_DECLSPEC int mca_fs_base_file_delete (char* file_name, struct opal_info_t *info);
 OMPI_DECLSPEC int mca_fs_base_file_sync (ompio_file_t *fh);
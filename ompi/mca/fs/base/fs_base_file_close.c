@@ -42,6 +42,10 @@ int mca_fs_base_file_close (ompio_file_t *fh)
                                      fh->f_comm->c_coll->coll_barrier_module);
     /*    close (*(int *)fh->fd);*/
     close (fh->fd);
+    if ( 0 <= fh->f_direct_fd ) {
+        close (fh->f_direct_fd);
+        fh->f_direct_fd = -1;
+    }
     /*    if (NULL != fh->fd)
     {
         free (fh->fd);
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2008-2018 University of Houston. All rights reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+
+#include "ompi_config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include "opal/util/output.h"
+
+#include "ompi/mca/mca.h"
+#include "ompi/mca/fs/fs.h"
+#include "ompi/mca/fs/base/base.h"
+#include "ompi/mca/common/ompio/common_ompio.h"
+
+/* Open the file a second time with O_DIRECT for the aligned parts of
+** the writes, if direct I/O was requested for this file handle. Has to
+** be called once the file exists. If the file system does not support
+** O_DIRECT, the flag is cleared and the file is accessed buffered.
+*/
+int mca_fs_base_file_open_direct(ompio_file_t *fh, const char *filename, int access_mode)
+{
+    fh->f_direct_fd = -1;
+    if ( !(fh->f_flags & OMPIO_DIRECT_IO) ) {
+        return OMPI_SUCCESS;
+    }
+
+#if defined(O_DIRECT)
+    if ( !(access_mode & MPI_MODE_RDONLY) ) {
+        int amode = mca_fs_base_get_file_amode(fh->f_rank, access_mode);
+
+        fh->f_direct_fd = open (filename, (amode & ~(O_CREAT | O_EXCL)) | O_DIRECT);
+        if ( 0 <= fh->f_direct_fd ) {
+            return OMPI_SUCCESS;
+        }
+        opal_output_verbose(10, ompi_fs_base_framework.framework_output,
+                            "mca_fs_base_file_open_direct: O_DIRECT not available for %s: %s",
+                            filename, strerror(errno));
+        fh->f_direct_fd = -1;
+    }
+#endif
+    fh->f_flags &= ~OMPIO_DIRECT_IO;
+
+    return OMPI_SUCCESS;
+}
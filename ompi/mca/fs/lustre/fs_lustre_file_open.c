@@ -144,6 +144,6 @@ mca_fs_lustre_file_open (struct ompi_communicator_t *comm,
     fh->f_stripe_size   = lump->lmm_stripe_size;
     fh->f_stripe_count  = lump->lmm_stripe_count;
     fh->f_fs_block_size = lump->lmm_stripe_size;
-    
-    return OMPI_SUCCESS;
+
+    return mca_fs_base_file_open_direct (fh, filename, access_mode);
 }
@@ -79,6 +79,11 @@ mca_fs_ufs_file_open (struct ompi_communicator_t *comm,
     fh->f_stripe_size=0;
     fh->f_stripe_count=1;
 
+    ret = mca_fs_base_file_open_direct (fh, filename, access_mode);
+    if ( OMPI_SUCCESS != ret ) {
+        return ret;
+    }
+
     /* Need to check for NFS here. If the file system is not NFS but a regular UFS file system,
        we do not need to enforce locking. A regular XFS or EXT4 file system can only be used 
        within a single node, local environment, and in this case the OS will already ensure correct
@@ -50,6 +50,7 @@ int mca_io_ompio_max_aggregators_ratio=8;
 int mca_io_ompio_aggregators_cutoff_threshold=3;
 int mca_io_ompio_overwrite_amode = 1;
 int mca_io_ompio_verbose_info_parsing = 0;
+int mca_io_ompio_direct_io = 0;
 
 int mca_io_ompio_grouping_option=5;
 
@@ -260,6 +261,19 @@ static int register_component(void)
                                            MCA_BASE_VAR_SCOPE_READONLY,
                                            &mca_io_ompio_verbose_info_parsing);
 
+    mca_io_ompio_direct_io = 0;
+    (void) mca_base_component_var_register(&mca_io_ompio_component.io_version,
+                                           "direct_io",
+                                           "Write the block aligned parts of a file access "
+                                           "with O_DIRECT, bypassing the page cache. Can be "
+                                           "overridden per file with the direct_write info key "
+                                           "0: buffered I/O (default) "
+                                           "1: direct I/O for writes ",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_io_ompio_direct_io);
+
     return OMPI_SUCCESS;
 }
 
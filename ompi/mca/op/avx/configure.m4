@@ -0,0 +1,88 @@
+# -*- shell-script -*-
+#
+# $COPYRIGHT$
+#
+# Additional copyrights may follow
+#
+# $HEADER$
+#
+
+# OMPI_OP_AVX_CHECK_FLAGS(name, flags, test-body)
+# -----------------------------------------------
+# Check whether the compiler can build test-body (which may use the
+# intrinsics from immintrin.h), first without and then with the given
+# flags.  On success op_avx_<name>_support is set to 1 and
+# MCA_BUILD_OP_<NAME>_FLAGS to the flags that were needed.
+AC_DEFUN([OMPI_OP_AVX_CHECK_FLAGS],[
+    OPAL_VAR_SCOPE_PUSH([op_avx_cflags_save op_avx_flags])
+    op_avx_$1_support=0
+    op_avx_cflags_save="$CFLAGS"
+    for op_avx_flags in "" $2 ; do
+        AC_MSG_CHECKING([for $1 support (flags: ${op_avx_flags:-none})])
+        CFLAGS="$op_avx_cflags_save $op_avx_flags"
+        AC_LINK_IFELSE([AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                                        [[$3]])],
+                       [AC_MSG_RESULT([yes])
+                        op_avx_$1_support=1
+                        MCA_BUILD_OP_[]m4_toupper($1)[]_FLAGS="$op_avx_flags"],
+                       [AC_MSG_RESULT([no])])
+        AS_IF([test $op_avx_$1_support -eq 1], [break])
+    done
+    CFLAGS="$op_avx_cflags_save"
+    OPAL_VAR_SCOPE_POP
+])dnl
+
+# MCA_ompi_op_avx_CONFIG([action-if-can-compile],
+#                        [action-if-cant-compile])
+# ------------------------------------------------
+AC_DEFUN([MCA_ompi_op_avx_CONFIG],[
+    AC_CONFIG_FILES([ompi/mca/op/avx/Makefile])
+
+    op_avx512_support=0
+    op_avx2_support=0
+    op_sse41_support=0
+    MCA_BUILD_OP_AVX512_FLAGS=
+    MCA_BUILD_OP_AVX2_FLAGS=
+    MCA_BUILD_OP_SSE41_FLAGS=
+
+    # The kernels (and the CPUID based detection in the component)
+    # are only meaningful on x86_64.
+    AS_CASE([$host],
+            [x86_64-*],
+            [OMPI_OP_AVX_CHECK_FLAGS([avx512], ["-mavx512f -mavx512bw" "-march=skylake-avx512"],
+                 [__m512i vA = _mm512_set1_epi8(1);
+                  __m512i vB = _mm512_max_epu8(vA, _mm512_add_epi8(vA, vA));
+                  __m512d vC = _mm512_mul_pd(_mm512_set1_pd(1.0), _mm512_set1_pd(2.0));
+                  (void)vB; (void)vC;])
+             op_avx512_support=$op_avx_avx512_support
+             OMPI_OP_AVX_CHECK_FLAGS([avx2], ["-mavx2" "-march=core-avx2"],
+                 [__m256i vA = _mm256_set1_epi32(1);
+                  __m256i vB = _mm256_mullo_epi32(vA, _mm256_max_epu32(vA, vA));
+                  (void)vB;])
+             op_avx2_support=$op_avx_avx2_support
+             OMPI_OP_AVX_CHECK_FLAGS([sse41], ["-msse4.1"],
+                 [__m128i vA = _mm_set1_epi32(1);
+                  __m128i vB = _mm_mullo_epi32(vA, _mm_max_epi8(vA, vA));
+                  (void)vB;])
+             op_sse41_support=$op_avx_sse41_support])
+
+    AC_DEFINE_UNQUOTED([OMPI_MCA_OP_HAVE_AVX512], [$op_avx512_support],
+                       [Whether the op/avx component has AVX-512 kernels])
+    AC_DEFINE_UNQUOTED([OMPI_MCA_OP_HAVE_AVX2], [$op_avx2_support],
+                       [Whether the op/avx component has AVX2 kernels])
+    AC_DEFINE_UNQUOTED([OMPI_MCA_OP_HAVE_SSE41], [$op_sse41_support],
+                       [Whether the op/avx component has SSE4.1 kernels])
+    AM_CONDITIONAL([MCA_BUILD_ompi_op_has_avx512_support],
+                   [test $op_avx512_support -eq 1])
+    AM_CONDITIONAL([MCA_BUILD_ompi_op_has_avx2_support],
+                   [test $op_avx2_support -eq 1])
+    AM_CONDITIONAL([MCA_BUILD_ompi_op_has_sse41_support],
+                   [test $op_sse41_support -eq 1])
+    AC_SUBST([MCA_BUILD_OP_AVX512_FLAGS])
+    AC_SUBST([MCA_BUILD_OP_AVX2_FLAGS])
+    AC_SUBST([MCA_BUILD_OP_SSE41_FLAGS])
+
+    AS_IF([test $op_avx512_support -eq 1 || test $op_avx2_support -eq 1 || test $op_sse41_support -eq 1],
+          [$1],
+          [$2])
+])dnl
@@ -0,0 +1,83 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef MCA_OP_AVX_EXPORT_H
+#define MCA_OP_AVX_EXPORT_H
+
+#include "ompi_config.h"
+
+#include "ompi/mca/mca.h"
+#include "opal/class/opal_object.h"
+
+#include "ompi/mca/op/op.h"
+
+BEGIN_C_DECLS
+
+/**
+ * Bits describing the x86 vector extensions the op/avx component
+ * knows how to use.  They are used both for the capabilities detected
+ * at runtime (via CPUID) and for the user-selectable subset exposed
+ * through the op_avx_support MCA parameter.
+ */
+#define OMPI_OP_AVX_HAS_SSE4_1_FLAG   0x00000001
+#define OMPI_OP_AVX_HAS_AVX_FLAG      0x00000002
+#define OMPI_OP_AVX_HAS_AVX2_FLAG     0x00000004
+#define OMPI_OP_AVX_HAS_AVX512F_FLAG  0x00000008
+#define OMPI_OP_AVX_HAS_AVX512BW_FLAG 0x00000010
+
+/**
+ * Derive a struct from the base op component struct, allowing us to
+ * cache some component-specific information on our well-known
+ * component struct.
+ */
+typedef struct {
+    /** The base op component struct */
+    ompi_op_base_component_1_0_0_t super;
+
+    /** Vector extensions supported by both the compiler (at build
+        time) and the processor (at run time) */
+    uint32_t flags;
+    /** Subset of flags the user allows us to use */
+    int32_t supported;
+} ompi_op_avx_component_t;
+
+/**
+ * Globally exported variable.
+ */
+OMPI_DECLSPEC extern ompi_op_avx_component_t
+    mca_op_avx_component;
+
+/*
+ * Function tables generated by op_avx_functions.c, one pair per
+ * instruction set it was compiled for.  Entries that cannot be
+ * vectorized with a given instruction set are left NULL so that the
+ * next best implementation (ultimately the base one) is used.
+ */
+#if OMPI_MCA_OP_HAVE_AVX512
+extern ompi_op_base_handler_fn_t
+    ompi_op_avx_functions_avx512[OMPI_OP_BASE_FORTRAN_OP_MAX][OMPI_OP_BASE_TYPE_MAX];
+extern ompi_op_base_3buff_handler_fn_t
+    ompi_op_avx_3buff_functions_avx512[OMPI_OP_BASE_FORTRAN_OP_MAX][OMPI_OP_BASE_TYPE_MAX];
+#endif  /* OMPI_MCA_OP_HAVE_AVX512 */
+#if OMPI_MCA_OP_HAVE_AVX2
+extern ompi_op_base_handler_fn_t
+    ompi_op_avx_functions_avx2[OMPI_OP_BASE_FORTRAN_OP_MAX][OMPI_OP_BASE_TYPE_MAX];
+extern ompi_op_base_3buff_handler_fn_t
+    ompi_op_avx_3buff_functions_avx2[OMPI_OP_BASE_FORTRAN_OP_MAX][OMPI_OP_BASE_TYPE_MAX];
+#endif  /* OMPI_MCA_OP_HAVE_AVX2 */
+#if OMPI_MCA_OP_HAVE_SSE41
+extern ompi_op_base_handler_fn_t
+    ompi_op_avx_functions_sse41[OMPI_OP_BASE_FORTRAN_OP_MAX][OMPI_OP_BASE_TYPE_MAX];
+extern ompi_op_base_3buff_handler_fn_t
+    ompi_op_avx_3buff_functions_sse41[OMPI_OP_BASE_FORTRAN_OP_MAX][OMPI_OP_BASE_TYPE_MAX];
+#endif  /* OMPI_MCA_OP_HAVE_SSE41 */
+
+END_C_DECLS
+
+#endif /* MCA_OP_AVX_EXPORT_H */
@@ -0,0 +1,278 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/** @file
+ *
+ * This is the "avx" component source code.  It provides vectorized
+ * (SSE4.1, AVX2 and AVX-512) implementations of the arithmetic and
+ * bitwise reductions on the C integer and floating point types.  The
+ * instruction set is selected once, at init time, based on what the
+ * compiler was able to generate and what the processor reports via
+ * CPUID.
+ */
+
+#include "ompi_config.h"
+
+#include "ompi/constants.h"
+#include "ompi/op/op.h"
+#include "ompi/mca/op/op.h"
+#include "ompi/mca/op/base/base.h"
+#include "ompi/mca/op/avx/op_avx.h"
+
+static int avx_component_open(void);
+static int avx_component_close(void);
+static int avx_component_init_query(bool enable_progress_threads,
+                                    bool enable_mpi_thread_multiple);
+static struct ompi_op_base_module_1_0_0_t *
+    avx_component_op_query(struct ompi_op_t *op, int *priority);
+static int avx_component_register(void);
+
+ompi_op_avx_component_t mca_op_avx_component = {
+    /* First, the mca_base_component_t struct containing meta
+       information about the component itself */
+    {
+        .opc_version = {
+            OMPI_OP_BASE_VERSION_1_0_0,
+
+            .mca_component_name = "avx",
+            MCA_BASE_MAKE_VERSION(component, OMPI_MAJOR_VERSION, OMPI_MINOR_VERSION,
+                                  OMPI_RELEASE_VERSION),
+            .mca_open_component = avx_component_open,
+            .mca_close_component = avx_component_close,
+            .mca_register_component_params = avx_component_register,
+        },
+        .opc_data = {
+            /* The component is checkpoint ready */
+            MCA_BASE_METADATA_PARAM_CHECKPOINT
+        },
+
+        .opc_init_query = avx_component_init_query,
+        .opc_op_query = avx_component_op_query,
+    },
+};
+
+/*
+ * Execute CPUID for the requested leaf/subleaf.
+ */
+static inline void avx_cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+{
+    __asm__ __volatile__ ("cpuid"
+                          : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+                          : "a" (leaf), "c" (subleaf));
+}
+
+/*
+ * Read the extended control register 0, which tells which register
+ * states the operating system saves/restores on context switches.
+ */
+static inline uint64_t avx_xgetbv(void)
+{
+    uint32_t eax, edx;
+    __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+    return ((uint64_t) edx << 32) | eax;
+}
+
+/*
+ * Find out which of the vector extensions we care about are supported
+ * by both the processor and the operating system.
+ */
+static uint32_t avx_detect_features(void)
+{
+    uint32_t regs[4], max_leaf, flags = 0;
+    uint64_t xcr0 = 0;
+
+    avx_cpuid(0, 0, regs);
+    max_leaf = regs[0];
+    if (max_leaf < 1) {
+        return 0;
+    }
+
+    avx_cpuid(1, 0, regs);
+    if (regs[2] & (1u << 19)) {
+        flags |= OMPI_OP_AVX_HAS_SSE4_1_FLAG;
+    }
+    /* The AVX state (YMM registers) is only usable if the OS enabled
+       it through XSAVE */
+    if (!(regs[2] & (1u << 27))) {
+        return flags;
+    }
+    xcr0 = avx_xgetbv();
+    if ((regs[2] & (1u << 28)) && (0x6 == (xcr0 & 0x6))) {
+        flags |= OMPI_OP_AVX_HAS_AVX_FLAG;
+    }
+    if (!(flags & OMPI_OP_AVX_HAS_AVX_FLAG) || max_leaf < 7) {
+        return flags;
+    }
+
+    avx_cpuid(7, 0, regs);
+    if (regs[1] & (1u << 5)) {
+        flags |= OMPI_OP_AVX_HAS_AVX2_FLAG;
+    }
+    /* AVX-512 additionally needs the opmask and ZMM states */
+    if (0xe6 == (xcr0 & 0xe6)) {
+        if (regs[1] & (1u << 16)) {
+            flags |= OMPI_OP_AVX_HAS_AVX512F_FLAG;
+        }
+        if (regs[1] & (1u << 30)) {
+            flags |= OMPI_OP_AVX_HAS_AVX512BW_FLAG;
+        }
+    }
+    return flags;
+}
+
+/*
+ * Component open
+ */
+static int avx_component_open(void)
+{
+    return OMPI_SUCCESS;
+}
+
+/*
+ * Component close
+ */
+static int avx_component_close(void)
+{
+    return OMPI_SUCCESS;
+}
+
+/*
+ * Register MCA params.
+ */
+static int avx_component_register(void)
+{
+    uint32_t compiled = 0;
+
+#if OMPI_MCA_OP_HAVE_SSE41
+    compiled |= OMPI_OP_AVX_HAS_SSE4_1_FLAG;
+#endif
+#if OMPI_MCA_OP_HAVE_AVX2
+    compiled |= OMPI_OP_AVX_HAS_AVX_FLAG | OMPI_OP_AVX_HAS_AVX2_FLAG;
+#endif
+#if OMPI_MCA_OP_HAVE_AVX512
+    compiled |= OMPI_OP_AVX_HAS_AVX512F_FLAG | OMPI_OP_AVX_HAS_AVX512BW_FLAG;
+#endif
+
+    mca_op_avx_component.flags = avx_detect_features() & compiled;
+    (void) mca_base_component_var_register(&mca_op_avx_component.super.opc_version,
+                                           "capabilities",
+                                           "Level of vectorization supported by both the compiler and the processor "
+                                           "(bitmask: 1 = SSE4.1, 2 = AVX, 4 = AVX2, 8 = AVX512F, 16 = AVX512BW)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0,
+                                           MCA_BASE_VAR_FLAG_DEFAULT_ONLY,
+                                           OPAL_INFO_LVL_4,
+                                           MCA_BASE_VAR_SCOPE_CONSTANT,
+                                           &mca_op_avx_component.flags);
+
+    mca_op_avx_component.supported = mca_op_avx_component.flags;
+    (void) mca_base_component_var_register(&mca_op_avx_component.super.opc_version,
+                                           "support",
+                                           "Level of vectorization the component is allowed to use; it is "
+                                           "intersected with op_avx_capabilities (same bitmask)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_4,
+                                           MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_op_avx_component.supported);
+
+    return OMPI_SUCCESS;
+}
+
+/*
+ * Query whether this component wants to be used in this process.
+ */
+static int avx_component_init_query(bool enable_progress_threads,
+                                    bool enable_mpi_thread_multiple)
+{
+    /* The functions are stateless, so we do not care about threads */
+    mca_op_avx_component.supported &= mca_op_avx_component.flags;
+    if (0 == mca_op_avx_component.supported) {
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+    return OMPI_SUCCESS;
+}
+
+/*
+ * Fill in the function pointers of a module using, for each datatype,
+ * the widest instruction set that is both allowed and that has an
+ * implementation for the given operation.
+ */
+static void avx_fill_module(ompi_op_base_module_t *module, int op_index)
+{
+    uint32_t supported = (uint32_t) mca_op_avx_component.supported;
+    int i;
+
+    for (i = 0; i < OMPI_OP_BASE_TYPE_MAX; ++i) {
+        module->opm_fns[i] = NULL;
+        module->opm_3buff_fns[i] = NULL;
+#if OMPI_MCA_OP_HAVE_AVX512
+        if ((OMPI_OP_AVX_HAS_AVX512F_FLAG | OMPI_OP_AVX_HAS_AVX512BW_FLAG) ==
+            (supported & (OMPI_OP_AVX_HAS_AVX512F_FLAG | OMPI_OP_AVX_HAS_AVX512BW_FLAG))) {
+            module->opm_fns[i] = ompi_op_avx_functions_avx512[op_index][i];
+            module->opm_3buff_fns[i] = ompi_op_avx_3buff_functions_avx512[op_index][i];
+        }
+#endif  /* OMPI_MCA_OP_HAVE_AVX512 */
+#if OMPI_MCA_OP_HAVE_AVX2
+        if (supported & OMPI_OP_AVX_HAS_AVX2_FLAG) {
+            if (NULL == module->opm_fns[i]) {
+                module->opm_fns[i] = ompi_op_avx_functions_avx2[op_index][i];
+            }
+            if (NULL == module->opm_3buff_fns[i]) {
+                module->opm_3buff_fns[i] = ompi_op_avx_3buff_functions_avx2[op_index][i];
+            }
+        }
+#endif  /* OMPI_MCA_OP_HAVE_AVX2 */
+#if OMPI_MCA_OP_HAVE_SSE41
+        if (supported & OMPI_OP_AVX_HAS_SSE4_1_FLAG) {
+            if (NULL == module->opm_fns[i]) {
+                module->opm_fns[i] = ompi_op_avx_functions_sse41[op_index][i];
+            }
+            if (NULL == module->opm_3buff_fns[i]) {
+                module->opm_3buff_fns[i] = ompi_op_avx_3buff_functions_sse41[op_index][i];
+            }
+        }
+#endif  /* OMPI_MCA_OP_HAVE_SSE41 */
+    }
+}
+
+/*
+ * Query whether this component can be used for a specific op
+ */
+static struct ompi_op_base_module_1_0_0_t *
+    avx_component_op_query(struct ompi_op_t *op, int *priority)
+{
+    ompi_op_base_module_t *module = NULL;
+
+    /* Sanity check -- although the framework should never invoke the
+       _component_op_query() on non-intrinsic MPI_Op's, we'll put a
+       check here just to be sure. */
+    if (0 == (OMPI_OP_FLAGS_INTRINSIC & op->o_flags)) {
+        return NULL;
+    }
+
+    switch (op->o_f_to_c_index) {
+    case OMPI_OP_BASE_FORTRAN_MAX:
+    case OMPI_OP_BASE_FORTRAN_MIN:
+    case OMPI_OP_BASE_FORTRAN_SUM:
+    case OMPI_OP_BASE_FORTRAN_PROD:
+    case OMPI_OP_BASE_FORTRAN_BAND:
+    case OMPI_OP_BASE_FORTRAN_BOR:
+    case OMPI_OP_BASE_FORTRAN_BXOR:
+        module = OBJ_NEW(ompi_op_base_module_t);
+        avx_fill_module(module, op->o_f_to_c_index);
+        break;
+    default:
+        /* Logical and location-based reductions are not vectorized */
+        break;
+    }
+
+    if (NULL != module) {
+        *priority = 50;
+    }
+    return (ompi_op_base_module_1_0_0_t *) module;
+}
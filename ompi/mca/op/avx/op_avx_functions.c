@@ -0,0 +1,433 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/** @file
+ *
+ * Vectorized reduction kernels.  This file is compiled once per
+ * supported instruction set (see Makefile.am), each time with the
+ * matching compiler flags and one of the GENERATE_*_CODE macros
+ * defined, and produces one pair of function tables laid out exactly
+ * like ompi_op_base_functions / ompi_op_base_3buff_functions.
+ */
+
+#include "ompi_config.h"
+
+#include <immintrin.h>
+
+#include "ompi/op/op.h"
+#include "ompi/mca/op/op.h"
+#include "ompi/mca/op/base/base.h"
+#include "ompi/mca/op/avx/op_avx.h"
+
+#if defined(GENERATE_AVX512_CODE)
+#  define OMPI_OP_AVX_SUFFIX  _avx512
+#  define OMPI_OP_AVX_PFX     _mm512
+#  define OMPI_OP_AVX_ISFX    si512
+#  define OMPI_OP_AVX_VLEN    64
+#  define OMPI_OP_AVX_IVEC    __m512i
+#  define OMPI_OP_AVX_FVEC    __m512
+#  define OMPI_OP_AVX_DVEC    __m512d
+#  define OMPI_OP_AVX_ILOAD(p)     _mm512_loadu_si512((const void*)(p))
+#  define OMPI_OP_AVX_ISTORE(p, v) _mm512_storeu_si512((void*)(p), (v))
+/* AVX-512F provides 64-bit integer min/max */
+#  define OMPI_OP_AVX_HAVE_MINMAX64 1
+#elif defined(GENERATE_AVX2_CODE)
+#  define OMPI_OP_AVX_SUFFIX  _avx2
+#  define OMPI_OP_AVX_PFX     _mm256
+#  define OMPI_OP_AVX_ISFX    si256
+#  define OMPI_OP_AVX_VLEN    32
+#  define OMPI_OP_AVX_IVEC    __m256i
+#  define OMPI_OP_AVX_FVEC    __m256
+#  define OMPI_OP_AVX_DVEC    __m256d
+#  define OMPI_OP_AVX_ILOAD(p)     _mm256_loadu_si256((const __m256i*)(p))
+#  define OMPI_OP_AVX_ISTORE(p, v) _mm256_storeu_si256((__m256i*)(p), (v))
+#  define OMPI_OP_AVX_HAVE_MINMAX64 0
+#elif defined(GENERATE_SSE41_CODE)
+#  define OMPI_OP_AVX_SUFFIX  _sse41
+#  define OMPI_OP_AVX_PFX     _mm
+#  define OMPI_OP_AVX_ISFX    si128
+#  define OMPI_OP_AVX_VLEN    16
+#  define OMPI_OP_AVX_IVEC    __m128i
+#  define OMPI_OP_AVX_FVEC    __m128
+#  define OMPI_OP_AVX_DVEC    __m128d
+#  define OMPI_OP_AVX_ILOAD(p)     _mm_loadu_si128((const __m128i*)(p))
+#  define OMPI_OP_AVX_ISTORE(p, v) _mm_storeu_si128((__m128i*)(p), (v))
+#  define OMPI_OP_AVX_HAVE_MINMAX64 0
+#else
+#  error "op/avx: one of GENERATE_{AVX512,AVX2,SSE41}_CODE must be defined"
+#endif
+
+/* The floating point load/store intrinsics follow the same naming
+   scheme on all the instruction sets. */
+#define OMPI_OP_AVX_INTRIN(op, sfx) _OMPI_OP_AVX_INTRIN(OMPI_OP_AVX_PFX, op, sfx)
+#define _OMPI_OP_AVX_INTRIN(pfx, op, sfx) __OMPI_OP_AVX_INTRIN(pfx, op, sfx)
+#define __OMPI_OP_AVX_INTRIN(pfx, op, sfx) pfx##_##op##_##sfx
+
+#define OMPI_OP_AVX_FLOAD(p)     OMPI_OP_AVX_INTRIN(loadu, ps)((const float*)(p))
+#define OMPI_OP_AVX_FSTORE(p, v) OMPI_OP_AVX_INTRIN(storeu, ps)((float*)(p), (v))
+#define OMPI_OP_AVX_DLOAD(p)     OMPI_OP_AVX_INTRIN(loadu, pd)((const double*)(p))
+#define OMPI_OP_AVX_DSTORE(p, v) OMPI_OP_AVX_INTRIN(storeu, pd)((double*)(p), (v))
+
+#define OMPI_OP_AVX_TABLE(name) _OMPI_OP_AVX_TABLE(name, OMPI_OP_AVX_SUFFIX)
+#define _OMPI_OP_AVX_TABLE(name, sfx) __OMPI_OP_AVX_TABLE(name, sfx)
+#define __OMPI_OP_AVX_TABLE(name, sfx) name##sfx
+
+/*
+ * Scalar versions of the operations, used for the elements left over
+ * after the last full vector.  They match the semantics of the base
+ * functions exactly (including the operand order for MIN/MAX, which
+ * matters for NaNs): the first argument is the output (2-buffer) or
+ * the first input (3-buffer).
+ */
+#define OMPI_OP_AVX_SCALAR_max(a, b)  ((a) > (b) ? (a) : (b))
+#define OMPI_OP_AVX_SCALAR_min(a, b)  ((a) < (b) ? (a) : (b))
+#define OMPI_OP_AVX_SCALAR_sum(a, b)  ((a) + (b))
+#define OMPI_OP_AVX_SCALAR_prod(a, b) ((a) * (b))
+#define OMPI_OP_AVX_SCALAR_band(a, b) ((a) & (b))
+#define OMPI_OP_AVX_SCALAR_bor(a, b)  ((a) | (b))
+#define OMPI_OP_AVX_SCALAR_bxor(a, b) ((a) ^ (b))
+
+/*
+ * Since all the functions in this file are essentially identical, we
+ * use a macro to substitute in names, types, and the vector intrinsic.
+ * The vector intrinsics of all the operations above return
+ * (a OP b) with the same operand convention as the scalar versions
+ * (in particular _mm*_max_ps(a, b) returns b when either is a NaN,
+ * just like (a > b ? a : b)).
+ *
+ * This macro is for (out = op(out, in))
+ */
+#define OP_AVX_FUNC(name, type_name, type, vtype, vload, vstore, intrin) \
+  static void ompi_op_avx_2buff_##name##_##type_name(void *_in, void *_out, int *count, \
+                                                     struct ompi_datatype_t **dtype, \
+                                                     struct ompi_op_base_module_1_0_0_t *module) \
+  {                                                                      \
+      const int types_per_step = OMPI_OP_AVX_VLEN / sizeof(type);        \
+      int left_over = *count;                                            \
+      type *in = (type *) _in;                                           \
+      type *out = (type *) _out;                                         \
+      for (; left_over >= types_per_step; left_over -= types_per_step) { \
+          vtype vecA = vload(in);                                        \
+          vtype vecB = vload(out);                                       \
+          in += types_per_step;                                          \
+          vstore(out, intrin(vecB, vecA));                               \
+          out += types_per_step;                                         \
+      }                                                                  \
+      for (; left_over > 0; --left_over, ++in, ++out) {                  \
+          *out = OMPI_OP_AVX_SCALAR_##name(*out, *in);                   \
+      }                                                                  \
+  }
+
+/*
+ * This macro is for (out = op(in1, in2))
+ */
+#define OP_AVX_FUNC_3BUF(name, type_name, type, vtype, vload, vstore, intrin) \
+  static void ompi_op_avx_3buff_##name##_##type_name(void *_in1, void *_in2, void *_out, int *count, \
+                                                     struct ompi_datatype_t **dtype, \
+                                                     struct ompi_op_base_module_1_0_0_t *module) \
+  {                                                                      \
+      const int types_per_step = OMPI_OP_AVX_VLEN / sizeof(type);        \
+      int left_over = *count;                                            \
+      type *in1 = (type *) _in1;                                         \
+      type *in2 = (type *) _in2;                                         \
+      type *out = (type *) _out;                                         \
+      for (; left_over >= types_per_step; left_over -= types_per_step) { \
+          vtype vecA = vload(in1);                                       \
+          vtype vecB = vload(in2);                                       \
+          in1 += types_per_step;                                         \
+          in2 += types_per_step;                                         \
+          vstore(out, intrin(vecA, vecB));                               \
+          out += types_per_step;                                         \
+      }                                                                  \
+      for (; left_over > 0; --left_over, ++in1, ++in2, ++out) {          \
+          *out = OMPI_OP_AVX_SCALAR_##name(*in1, *in2);                  \
+      }                                                                  \
+  }
+
+#define OP_AVX_INT(name, type_name, op, sfx)                            \
+    OP_AVX_FUNC(name, type_name, type_name, OMPI_OP_AVX_IVEC,            \
+                OMPI_OP_AVX_ILOAD, OMPI_OP_AVX_ISTORE,                   \
+                OMPI_OP_AVX_INTRIN(op, sfx))                             \
+    OP_AVX_FUNC_3BUF(name, type_name, type_name, OMPI_OP_AVX_IVEC,       \
+                     OMPI_OP_AVX_ILOAD, OMPI_OP_AVX_ISTORE,              \
+                     OMPI_OP_AVX_INTRIN(op, sfx))
+
+#define OP_AVX_BITWISE(name, type_name, op)                             \
+    OP_AVX_INT(name, type_name, op, OMPI_OP_AVX_ISFX)
+
+#define OP_AVX_FLOAT(name, op)                                          \
+    OP_AVX_FUNC(name, float, float, OMPI_OP_AVX_FVEC,                    \
+                OMPI_OP_AVX_FLOAD, OMPI_OP_AVX_FSTORE,                   \
+                OMPI_OP_AVX_INTRIN(op, ps))                              \
+    OP_AVX_FUNC_3BUF(name, float, float, OMPI_OP_AVX_FVEC,               \
+                     OMPI_OP_AVX_FLOAD, OMPI_OP_AVX_FSTORE,              \
+                     OMPI_OP_AVX_INTRIN(op, ps))
+
+#define OP_AVX_DOUBLE(name, op)                                         \
+    OP_AVX_FUNC(name, double, double, OMPI_OP_AVX_DVEC,                  \
+                OMPI_OP_AVX_DLOAD, OMPI_OP_AVX_DSTORE,                   \
+                OMPI_OP_AVX_INTRIN(op, pd))                              \
+    OP_AVX_FUNC_3BUF(name, double, double, OMPI_OP_AVX_DVEC,             \
+                     OMPI_OP_AVX_DLOAD, OMPI_OP_AVX_DSTORE,              \
+                     OMPI_OP_AVX_INTRIN(op, pd))
+
+/*************************************************************************
+ * Max
+ *************************************************************************/
+
+OP_AVX_INT(max, int8_t, max, epi8)
+OP_AVX_INT(max, uint8_t, max, epu8)
+OP_AVX_INT(max, int16_t, max, epi16)
+OP_AVX_INT(max, uint16_t, max, epu16)
+OP_AVX_INT(max, int32_t, max, epi32)
+OP_AVX_INT(max, uint32_t, max, epu32)
+#if OMPI_OP_AVX_HAVE_MINMAX64
+OP_AVX_INT(max, int64_t, max, epi64)
+OP_AVX_INT(max, uint64_t, max, epu64)
+#endif
+OP_AVX_FLOAT(max, max)
+OP_AVX_DOUBLE(max, max)
+
+/*************************************************************************
+ * Min
+ *************************************************************************/
+
+OP_AVX_INT(min, int8_t, min, epi8)
+OP_AVX_INT(min, uint8_t, min, epu8)
+OP_AVX_INT(min, int16_t, min, epi16)
+OP_AVX_INT(min, uint16_t, min, epu16)
+OP_AVX_INT(min, int32_t, min, epi32)
+OP_AVX_INT(min, uint32_t, min, epu32)
+#if OMPI_OP_AVX_HAVE_MINMAX64
+OP_AVX_INT(min, int64_t, min, epi64)
+OP_AVX_INT(min, uint64_t, min, epu64)
+#endif
+OP_AVX_FLOAT(min, min)
+OP_AVX_DOUBLE(min, min)
+
+/*************************************************************************
+ * Sum
+ *************************************************************************/
+
+OP_AVX_INT(sum, int8_t, add, epi8)
+OP_AVX_INT(sum, uint8_t, add, epi8)
+OP_AVX_INT(sum, int16_t, add, epi16)
+OP_AVX_INT(sum, uint16_t, add, epi16)
+OP_AVX_INT(sum, int32_t, add, epi32)
+OP_AVX_INT(sum, uint32_t, add, epi32)
+OP_AVX_INT(sum, int64_t, add, epi64)
+OP_AVX_INT(sum, uint64_t, add, epi64)
+OP_AVX_FLOAT(sum, add)
+OP_AVX_DOUBLE(sum, add)
+
+/*************************************************************************
+ * Product
+ *
+ * There is no 8-bit multiply on any of the instruction sets, and the
+ * 64-bit one requires AVX-512DQ; these are left to the base functions.
+ * The low half of a multiplication is the same for signed and
+ * unsigned operands.
+ *************************************************************************/
+
+OP_AVX_INT(prod, int16_t, mullo, epi16)
+OP_AVX_INT(prod, uint16_t, mullo, epi16)
+OP_AVX_INT(prod, int32_t, mullo, epi32)
+OP_AVX_INT(prod, uint32_t, mullo, epi32)
+OP_AVX_FLOAT(prod, mul)
+OP_AVX_DOUBLE(prod, mul)
+
+/*************************************************************************
+ * Bitwise AND, OR and XOR
+ *************************************************************************/
+
+OP_AVX_BITWISE(band, int8_t, and)
+OP_AVX_BITWISE(band, uint8_t, and)
+OP_AVX_BITWISE(band, int16_t, and)
+OP_AVX_BITWISE(band, uint16_t, and)
+OP_AVX_BITWISE(band, int32_t, and)
+OP_AVX_BITWISE(band, uint32_t, and)
+OP_AVX_BITWISE(band, int64_t, and)
+OP_AVX_BITWISE(band, uint64_t, and)
+
+OP_AVX_BITWISE(bor, int8_t, or)
+OP_AVX_BITWISE(bor, uint8_t, or)
+OP_AVX_BITWISE(bor, int16_t, or)
+OP_AVX_BITWISE(bor, uint16_t, or)
+OP_AVX_BITWISE(bor, int32_t, or)
+OP_AVX_BITWISE(bor, uint32_t, or)
+OP_AVX_BITWISE(bor, int64_t, or)
+OP_AVX_BITWISE(bor, uint64_t, or)
+
+OP_AVX_BITWISE(bxor, int8_t, xor)
+OP_AVX_BITWISE(bxor, uint8_t, xor)
+OP_AVX_BITWISE(bxor, int16_t, xor)
+OP_AVX_BITWISE(bxor, uint16_t, xor)
+OP_AVX_BITWISE(bxor, int32_t, xor)
+OP_AVX_BITWISE(bxor, uint32_t, xor)
+OP_AVX_BITWISE(bxor, int64_t, xor)
+OP_AVX_BITWISE(bxor, uint64_t, xor)
+
+/*
+ * Helpful defines, because there's soooo many names!
+ */
+
+#define C_INTEGER_8_16_32(name, ftype)                                   \
+  [OMPI_OP_BASE_TYPE_INT8_T] = ompi_op_avx_##ftype##_##name##_int8_t,     \
+  [OMPI_OP_BASE_TYPE_UINT8_T] = ompi_op_avx_##ftype##_##name##_uint8_t,   \
+  [OMPI_OP_BASE_TYPE_INT16_T] = ompi_op_avx_##ftype##_##name##_int16_t,   \
+  [OMPI_OP_BASE_TYPE_UINT16_T] = ompi_op_avx_##ftype##_##name##_uint16_t, \
+  [OMPI_OP_BASE_TYPE_INT32_T] = ompi_op_avx_##ftype##_##name##_int32_t,   \
+  [OMPI_OP_BASE_TYPE_UINT32_T] = ompi_op_avx_##ftype##_##name##_uint32_t
+
+#define C_INTEGER(name, ftype)                                            \
+  C_INTEGER_8_16_32(name, ftype),                                         \
+  [OMPI_OP_BASE_TYPE_INT64_T] = ompi_op_avx_##ftype##_##name##_int64_t,   \
+  [OMPI_OP_BASE_TYPE_UINT64_T] = ompi_op_avx_##ftype##_##name##_uint64_t
+
+#if OMPI_OP_AVX_HAVE_MINMAX64
+#define C_INTEGER_MINMAX(name, ftype) C_INTEGER(name, ftype)
+#else
+#define C_INTEGER_MINMAX(name, ftype) C_INTEGER_8_16_32(name, ftype)
+#endif
+
+#define C_INTEGER_PROD(ftype)                                             \
+  [OMPI_OP_BASE_TYPE_INT16_T] = ompi_op_avx_##ftype##_prod_int16_t,       \
+  [OMPI_OP_BASE_TYPE_UINT16_T] = ompi_op_avx_##ftype##_prod_uint16_t,     \
+  [OMPI_OP_BASE_TYPE_INT32_T] = ompi_op_avx_##ftype##_prod_int32_t,       \
+  [OMPI_OP_BASE_TYPE_UINT32_T] = ompi_op_avx_##ftype##_prod_uint32_t
+
+#define FLOATING_POINT(name, ftype)                                       \
+  [OMPI_OP_BASE_TYPE_FLOAT] = ompi_op_avx_##ftype##_##name##_float,       \
+  [OMPI_OP_BASE_TYPE_DOUBLE] = ompi_op_avx_##ftype##_##name##_double
+
+ompi_op_base_handler_fn_t
+OMPI_OP_AVX_TABLE(ompi_op_avx_functions)[OMPI_OP_BASE_FORTRAN_OP_MAX][OMPI_OP_BASE_TYPE_MAX] =
+    {
+        /* Corresponds to MPI_OP_NULL */
+        [OMPI_OP_BASE_FORTRAN_NULL] = {
+            /* Leaving this empty puts in NULL for all entries */
+            NULL,
+        },
+        /* Corresponds to MPI_MAX */
+        [OMPI_OP_BASE_FORTRAN_MAX] = {
+            C_INTEGER_MINMAX(max, 2buff),
+            FLOATING_POINT(max, 2buff),
+        },
+        /* Corresponds to MPI_MIN */
+        [OMPI_OP_BASE_FORTRAN_MIN] = {
+            C_INTEGER_MINMAX(min, 2buff),
+            FLOATING_POINT(min, 2buff),
+        },
+        /* Corresponds to MPI_SUM */
+        [OMPI_OP_BASE_FORTRAN_SUM] = {
+            C_INTEGER(sum, 2buff),
+            FLOATING_POINT(sum, 2buff),
+        },
+        /* Corresponds to MPI_PROD */
+        [OMPI_OP_BASE_FORTRAN_PROD] = {
+            C_INTEGER_PROD(2buff),
+            FLOATING_POINT(prod, 2buff),
+        },
+        /* Corresponds to MPI_LAND */
+        [OMPI_OP_BASE_FORTRAN_LAND] = {
+            NULL,
+        },
+        /* Corresponds to MPI_BAND */
+        [OMPI_OP_BASE_FORTRAN_BAND] = {
+            C_INTEGER(band, 2buff),
+        },
+        /* Corresponds to MPI_LOR */
+        [OMPI_OP_BASE_FORTRAN_LOR] = {
+            NULL,
+        },
+        /* Corresponds to MPI_BOR */
+        [OMPI_OP_BASE_FORTRAN_BOR] = {
+            C_INTEGER(bor, 2buff),
+        },
+        /* Corresponds to MPI_LXOR */
+        [OMPI_OP_BASE_FORTRAN_LXOR] = {
+            NULL,
+        },
+        /* Corresponds to MPI_BXOR */
+        [OMPI_OP_BASE_FORTRAN_BXOR] = {
+            C_INTEGER(bxor, 2buff),
+        },
+        /* Corresponds to MPI_REPLACE */
+        [OMPI_OP_BASE_FORTRAN_REPLACE] = {
+            /* MPI_ACCUMULATE is handled differently than the other
+               reductions, so just zero out its function
+               impementations here to ensure that users don't invoke
+               MPI_REPLACE with any reduction operations other than
+               ACCUMULATE */
+            NULL,
+        },
+    };
+
+ompi_op_base_3buff_handler_fn_t
+OMPI_OP_AVX_TABLE(ompi_op_avx_3buff_functions)[OMPI_OP_BASE_FORTRAN_OP_MAX][OMPI_OP_BASE_TYPE_MAX] =
+    {
+        /* Corresponds to MPI_OP_NULL */
+        [OMPI_OP_BASE_FORTRAN_NULL] = {
+            /* Leaving this empty puts in NULL for all entries */
+            NULL,
+        },
+        /* Corresponds to MPI_MAX */
+        [OMPI_OP_BASE_FORTRAN_MAX] = {
+            C_INTEGER_MINMAX(max, 3buff),
+            FLOATING_POINT(max, 3buff),
+        },
+        /* Corresponds to MPI_MIN */
+        [OMPI_OP_BASE_FORTRAN_MIN] = {
+            C_INTEGER_MINMAX(min, 3buff),
+            FLOATING_POINT(min, 3buff),
+        },
+        /* Corresponds to MPI_SUM */
+        [OMPI_OP_BASE_FORTRAN_SUM] = {
+            C_INTEGER(sum, 3buff),
+            FLOATING_POINT(sum, 3buff),
+        },
+        /* Corresponds to MPI_PROD */
+        [OMPI_OP_BASE_FORTRAN_PROD] = {
+            C_INTEGER_PROD(3buff),
+            FLOATING_POINT(prod, 3buff),
+        },
+        /* Corresponds to MPI_LAND */
+        [OMPI_OP_BASE_FORTRAN_LAND] = {
+            NULL,
+        },
+        /* Corresponds to MPI_BAND */
+        [OMPI_OP_BASE_FORTRAN_BAND] = {
+            C_INTEGER(band, 3buff),
+        },
+        /* Corresponds to MPI_LOR */
+        [OMPI_OP_BASE_FORTRAN_LOR] = {
+            NULL,
+        },
+        /* Corresponds to MPI_BOR */
+        [OMPI_OP_BASE_FORTRAN_BOR] = {
+            C_INTEGER(bor, 3buff),
+        },
+        /* Corresponds to MPI_LXOR */
+        [OMPI_OP_BASE_FORTRAN_LXOR] = {
+            NULL,
+        },
+        /* Corresponds to MPI_BXOR */
+        [OMPI_OP_BASE_FORTRAN_BXOR] = {
+            C_INTEGER(bxor, 3buff),
+        },
+        /* Corresponds to MPI_REPLACE */
+        [OMPI_OP_BASE_FORTRAN_REPLACE] = {
+            /* MPI_ACCUMULATE is handled differently than the other
+               reductions, so just zero out its function
+               impementations here to ensure that users don't invoke
+               MPI_REPLACE with any reduction operations other than
+               ACCUMULATE */
+            NULL,
+        },
+    };
@@ -432,6 +432,7 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
     if (OMPI_SUCCESS != ret) goto cleanup;
 
     if (!mca_osc_pt2pt_component.progress_enable) {
+	(void) opal_progress_set_name (component_progress, "osc_pt2pt");
 	opal_progress_register (component_progress);
 	mca_osc_pt2pt_component.progress_enable = true;
     }
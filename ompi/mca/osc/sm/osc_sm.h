@@ -65,6 +65,9 @@ struct ompi_osc_sm_component_t {
     ompi_osc_base_component_t super;
 
     char *backing_directory;
+
+    /** Default value of the acc_single_intrinsic info key for new windows */
+    bool acc_single_intrinsic;
 };
 typedef struct ompi_osc_sm_component_t ompi_osc_sm_component_t;
 OMPI_DECLSPEC extern ompi_osc_sm_component_t mca_osc_sm_component;
@@ -84,6 +87,10 @@ struct ompi_osc_sm_module_t {
     void *segment_base;
     bool noncontig;
 
+    /** accumulate operations are single elements of predefined datatypes and
+     * may use processor atomics instead of the accumulate lock */
+    bool acc_single_intrinsic;
+
     size_t *sizes;
     void **bases;
     int *disp_units;
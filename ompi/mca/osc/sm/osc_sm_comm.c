@@ -20,6 +20,115 @@
 
 #include "osc_sm.h"
 
+/* update a single naturally aligned 32 or 64-bit element of the window with
+ * processor atomics. integer sums and bitwise operations map directly to
+ * atomic instructions, every other predefined operation is applied in a
+ * compare-and-swap loop. the previous value is returned in result_addr if it
+ * is not NULL. */
+#define OSC_SM_DEFINE_ATOMIC_OP(bits)                                   \
+static void                                                             \
+ompi_osc_sm_atomic_op_ ## bits (const void *origin_addr, void *result_addr, \
+                                struct ompi_datatype_t *dt,             \
+                                opal_atomic_int ## bits ## _t *addr,    \
+                                struct ompi_op_t *op)                   \
+{                                                                       \
+    bool is_int = !!(OMPI_DATATYPE_FLAG_DATA_INT & dt->super.flags);    \
+    int ## bits ## _t origin = 0, old, new_value;                       \
+                                                                        \
+    if (NULL != origin_addr) {                                          \
+        memcpy (&origin, origin_addr, sizeof (origin));                 \
+    }                                                                   \
+                                                                        \
+    if (op == &ompi_mpi_op_no_op.op) {                                  \
+        old = *addr;                                                    \
+    } else if (op == &ompi_mpi_op_replace.op) {                         \
+        old = opal_atomic_swap_ ## bits (addr, origin);                 \
+    } else if (is_int && OMPI_OP_SUM == op->op_type) {                  \
+        old = opal_atomic_fetch_add_ ## bits (addr, origin);            \
+    } else if (is_int && OMPI_OP_BAND == op->op_type) {                 \
+        old = opal_atomic_fetch_and_ ## bits (addr, origin);            \
+    } else if (is_int && OMPI_OP_BOR == op->op_type) {                  \
+        old = opal_atomic_fetch_or_ ## bits (addr, origin);             \
+    } else if (is_int && OMPI_OP_BXOR == op->op_type) {                 \
+        old = opal_atomic_fetch_xor_ ## bits (addr, origin);            \
+    } else {                                                            \
+        old = *addr;                                                    \
+        do {                                                            \
+            new_value = old;                                            \
+            ompi_op_reduce (op, &origin, &new_value, 1, dt);            \
+        } while (!opal_atomic_compare_exchange_strong_ ## bits (addr, &old, new_value)); \
+    }                                                                   \
+                                                                        \
+    if (NULL != result_addr) {                                          \
+        memcpy (result_addr, &old, sizeof (old));                       \
+    }                                                                   \
+}
+
+OSC_SM_DEFINE_ATOMIC_OP(32)
+#if OPAL_HAVE_ATOMIC_MATH_64
+OSC_SM_DEFINE_ATOMIC_OP(64)
+#endif
+
+/* size of the elements of dt if a single one can be updated atomically at
+ * remote_address, 0 otherwise */
+static inline size_t
+ompi_osc_sm_atomic_size(struct ompi_datatype_t *dt, void *remote_address)
+{
+    size_t size;
+
+    if (!ompi_datatype_is_predefined(dt) || !ompi_datatype_is_contiguous_memory_layout(dt, 1)) {
+        return 0;
+    }
+
+    ompi_datatype_type_size(dt, &size);
+    if ((4 != size && (8 != size || !OPAL_HAVE_ATOMIC_MATH_64)) ||
+        0 != ((uintptr_t) remote_address & (size - 1))) {
+        return 0;
+    }
+
+    return size;
+}
+
+/* apply op to a single element in the window without the accumulate lock.
+ * returns OMPI_ERR_NOT_SUPPORTED if the element can't be updated atomically */
+static int
+ompi_osc_sm_atomic_op(const void *origin_addr, void *result_addr, struct ompi_datatype_t *dt,
+                      void *remote_address, struct ompi_op_t *op)
+{
+    size_t size = ompi_osc_sm_atomic_size(dt, remote_address);
+
+    if (!ompi_op_is_intrinsic(op)) {
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+
+    if (4 == size) {
+        ompi_osc_sm_atomic_op_32(origin_addr, result_addr, dt, (opal_atomic_int32_t *) remote_address, op);
+        return OMPI_SUCCESS;
+    }
+#if OPAL_HAVE_ATOMIC_MATH_64
+    if (8 == size) {
+        ompi_osc_sm_atomic_op_64(origin_addr, result_addr, dt, (opal_atomic_int64_t *) remote_address, op);
+        return OMPI_SUCCESS;
+    }
+#endif
+
+    return OMPI_ERR_NOT_SUPPORTED;
+}
+
+/* single element accumulate (with an optional fetch) that can go through
+ * ompi_osc_sm_atomic_op: all the datatypes must match and describe exactly
+ * one element. origin_count is 0 for MPI_NO_OP. */
+static inline bool
+ompi_osc_sm_acc_is_single(int origin_count, struct ompi_datatype_t *origin_dt,
+                          int result_count, struct ompi_datatype_t *result_dt,
+                          int target_count, struct ompi_datatype_t *target_dt,
+                          struct ompi_op_t *op)
+{
+    return 1 == target_count &&
+        ((1 == origin_count && origin_dt == target_dt) || op == &ompi_mpi_op_no_op.op) &&
+        (NULL == result_dt || (1 == result_count && result_dt == target_dt));
+}
+
 int
 ompi_osc_sm_rput(const void *origin_addr,
                  int origin_count,
@@ -127,6 +236,13 @@ ompi_osc_sm_raccumulate(const void *origin_addr,
 
     remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
 
+    if (module->acc_single_intrinsic &&
+        ompi_osc_sm_acc_is_single(origin_count, origin_dt, 0, NULL, target_count, target_dt, op) &&
+        OMPI_SUCCESS == ompi_osc_sm_atomic_op(origin_addr, NULL, target_dt, remote_address, op)) {
+        ret = OMPI_SUCCESS;
+        goto done;
+    }
+
     opal_atomic_lock(&module->node_states[target].accumulate_lock);
     if (op == &ompi_mpi_op_replace.op) {
         ret = ompi_datatype_sndrcv((void *)origin_addr, origin_count, origin_dt,
@@ -138,6 +254,7 @@ ompi_osc_sm_raccumulate(const void *origin_addr,
     }
     opal_atomic_unlock(&module->node_states[target].accumulate_lock);
 
+ done:
     /* the only valid field of RMA request status is the MPI_ERROR field.
      * ompi_request_empty has status MPI_SUCCESS and indicates the request is
      * complete. */
@@ -178,6 +295,14 @@ ompi_osc_sm_rget_accumulate(const void *origin_addr,
 
     remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
 
+    if (module->acc_single_intrinsic &&
+        ompi_osc_sm_acc_is_single(origin_count, origin_dt, result_count, result_dt,
+                                  target_count, target_dt, op) &&
+        OMPI_SUCCESS == ompi_osc_sm_atomic_op(origin_addr, result_addr, target_dt, remote_address, op)) {
+        ret = OMPI_SUCCESS;
+        goto atomic_done;
+    }
+
     opal_atomic_lock(&module->node_states[target].accumulate_lock);
 
     ret = ompi_datatype_sndrcv(remote_address, target_count, target_dt,
@@ -196,6 +321,7 @@ ompi_osc_sm_rget_accumulate(const void *origin_addr,
  done:
     opal_atomic_unlock(&module->node_states[target].accumulate_lock);
 
+ atomic_done:
     /* the only valid field of RMA request status is the MPI_ERROR field.
      * ompi_request_empty has status MPI_SUCCESS and indicates the request is
      * complete. */
@@ -293,6 +419,13 @@ ompi_osc_sm_accumulate(const void *origin_addr,
 
     remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
 
+    if (module->acc_single_intrinsic &&
+        ompi_osc_sm_acc_is_single(origin_count, origin_dt, 0, NULL, target_count, target_dt, op) &&
+        OMPI_SUCCESS == ompi_osc_sm_atomic_op(origin_addr, NULL, target_dt, remote_address, op)) {
+        ret = OMPI_SUCCESS;
+        goto done;
+    }
+
     opal_atomic_lock(&module->node_states[target].accumulate_lock);
     if (op == &ompi_mpi_op_replace.op) {
         ret = ompi_datatype_sndrcv((void *)origin_addr, origin_count, origin_dt,
@@ -304,6 +437,7 @@ ompi_osc_sm_accumulate(const void *origin_addr,
     }
     opal_atomic_unlock(&module->node_states[target].accumulate_lock);
 
+ done:
     return ret;
 }
 
@@ -337,6 +471,14 @@ ompi_osc_sm_get_accumulate(const void *origin_addr,
 
     remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
 
+    if (module->acc_single_intrinsic &&
+        ompi_osc_sm_acc_is_single(origin_count, origin_dt, result_count, result_dt,
+                                  target_count, target_dt, op) &&
+        OMPI_SUCCESS == ompi_osc_sm_atomic_op(origin_addr, result_addr, target_dt, remote_address, op)) {
+        ret = OMPI_SUCCESS;
+        goto atomic_done;
+    }
+
     opal_atomic_lock(&module->node_states[target].accumulate_lock);
 
     ret = ompi_datatype_sndrcv(remote_address, target_count, target_dt,
@@ -355,6 +497,7 @@ ompi_osc_sm_get_accumulate(const void *origin_addr,
  done:
     opal_atomic_unlock(&module->node_states[target].accumulate_lock);
 
+ atomic_done:
     return ret;
 }
 
@@ -381,6 +524,32 @@ ompi_osc_sm_compare_and_swap(const void *origin_addr,
 
     remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
 
+    /* compare-and-swap is atomic with respect to itself, so it can bypass the
+     * lock whenever no other operation may target the same element */
+    if (module->acc_single_intrinsic || win->w_acc_ops <= OMPI_WIN_ACCUMULATE_OPS_SAME_OP) {
+        size = ompi_osc_sm_atomic_size(dt, remote_address);
+        if (4 == size) {
+            int32_t old, new_value;
+
+            memcpy (&old, compare_addr, sizeof (old));
+            memcpy (&new_value, origin_addr, sizeof (new_value));
+            (void) opal_atomic_compare_exchange_strong_32 ((opal_atomic_int32_t *) remote_address, &old, new_value);
+            memcpy (result_addr, &old, sizeof (old));
+            return OMPI_SUCCESS;
+        }
+#if OPAL_HAVE_ATOMIC_MATH_64
+        if (8 == size) {
+            int64_t old, new_value;
+
+            memcpy (&old, compare_addr, sizeof (old));
+            memcpy (&new_value, origin_addr, sizeof (new_value));
+            (void) opal_atomic_compare_exchange_strong_64 ((opal_atomic_int64_t *) remote_address, &old, new_value);
+            memcpy (result_addr, &old, sizeof (old));
+            return OMPI_SUCCESS;
+        }
+#endif
+    }
+
     ompi_datatype_type_size(dt, &size);
 
     opal_atomic_lock(&module->node_states[target].accumulate_lock);
@@ -421,6 +590,11 @@ ompi_osc_sm_fetch_and_op(const void *origin_addr,
 
     remote_address = ((char*) (module->bases[target])) + module->disp_units[target] * target_disp;
 
+    if (module->acc_single_intrinsic &&
+        OMPI_SUCCESS == ompi_osc_sm_atomic_op(origin_addr, result_addr, dt, remote_address, op)) {
+        return OMPI_SUCCESS;
+    }
+
     opal_atomic_lock(&module->node_states[target].accumulate_lock);
 
     /* fetch */
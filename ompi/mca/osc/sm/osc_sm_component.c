@@ -124,6 +124,17 @@ static int component_register (void)
                                             MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0, OPAL_INFO_LVL_3,
                                             MCA_BASE_VAR_SCOPE_READONLY, &mca_osc_sm_component.backing_directory);
 
+    mca_osc_sm_component.acc_single_intrinsic = false;
+    (void) mca_base_component_var_register (&mca_osc_sm_component.super.osc_version, "acc_single_intrinsic",
+                                            "Update the window with processor atomics instead of taking the "
+                                            "accumulate lock for MPI_Accumulate, MPI_Get_accumulate, "
+                                            "MPI_Fetch_and_op and MPI_Compare_and_swap on a single element of a "
+                                            "predefined datatype. Only valid for codes that do not use any other "
+                                            "accumulate operation on the window. Info key of same name overrides "
+                                            "this value (default: false)",
+                                            MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                            MCA_BASE_VAR_SCOPE_GROUP, &mca_osc_sm_component.acc_single_intrinsic);
+
     return OPAL_SUCCESS;
 }
 
@@ -191,7 +202,7 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
     ompi_osc_sm_module_t *module = NULL;
     int comm_size = ompi_comm_size (comm);
     bool unlink_needed = false;
-    int ret = OMPI_ERROR;
+    int ret = OMPI_ERROR, flag;
 
     if (OMPI_SUCCESS != (ret = check_win_ok(comm, flavor))) {
         return ret;
@@ -220,6 +231,12 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
 
     module->flavor = flavor;
 
+    module->acc_single_intrinsic = mca_osc_sm_component.acc_single_intrinsic;
+    if (OMPI_SUCCESS != opal_info_get_bool(info, "acc_single_intrinsic",
+                                           &module->acc_single_intrinsic, &flag)) {
+        goto error;
+    }
+
     /* create the segment */
     if (1 == comm_size) {
         module->segment_base = NULL;
@@ -241,7 +258,7 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
         module->posts[0] = (osc_sm_post_atomic_type_t *) (module->posts + 1);
     } else {
         unsigned long total, *rbuf;
-        int i, flag;
+        int i;
         size_t pagesize;
         size_t state_size;
         size_t posts_size, post_size = (comm_size + OSC_SM_POST_MASK) / (OSC_SM_POST_MASK + 1);
@@ -384,7 +401,6 @@ component_select(struct ompi_win_t *win, void **base, size_t size, int disp_unit
         pthread_mutexattr_t mattr;
         pthread_condattr_t cattr;
         bool blocking_fence=false;
-        int flag;
 
         if (OMPI_SUCCESS != opal_info_get_bool(info, "blocking_fence",
                                                &blocking_fence, &flag)) {
@@ -587,6 +603,9 @@ ompi_osc_sm_get_info(struct ompi_win_t *win, struct opal_info_t **info_used)
     opal_info_t *info = OBJ_NEW(opal_info_t);
     if (NULL == info) return OMPI_ERR_TEMP_OUT_OF_RESOURCE;
 
+    opal_info_set(info, "acc_single_intrinsic",
+                  (module->acc_single_intrinsic) ? "true" : "false");
+
     if (module->flavor == MPI_WIN_FLAVOR_SHARED) {
         opal_info_set(info, "blocking_fence",
                       (1 == module->global_state->use_barrier_for_fence) ? "true" : "false");
@@ -283,6 +283,10 @@ int mca_pml_base_select(bool enable_progress_threads,
 
     /* register the winner's callback */
     if( NULL != mca_pml.pml_progress ) {
+        char name[MCA_BASE_MAX_COMPONENT_NAME_LEN + 5];
+
+        snprintf(name, sizeof(name), "pml_%s", best_component->pmlm_version.mca_component_name);
+        (void) opal_progress_set_name(mca_pml.pml_progress, name);
         opal_progress_register(mca_pml.pml_progress);
     }
 
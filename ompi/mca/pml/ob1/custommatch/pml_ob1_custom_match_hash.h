@@ -0,0 +1,709 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/**
+ * @file
+ *
+ * Hash-binned matching engine.
+ *
+ * Posted receives and unexpected fragments are kept in bins keyed by
+ * (source, tag), where OMPI_ANY_SOURCE and OMPI_ANY_TAG are themselves
+ * valid key components.  A lookup therefore only ever walks the head
+ * of a handful of bins instead of the whole queue.
+ *
+ * Posted receives live in exactly one bin, the one matching the
+ * (possibly wildcarded) envelope they were posted with.  Each receive
+ * carries a per-queue sequence number and an incoming fragment
+ * (src, tag) picks the oldest head among the bins (src, tag),
+ * (ANY_SOURCE, tag), (src, ANY_TAG) and (ANY_SOURCE, ANY_TAG).  The
+ * last two are skipped for negative (internal) tags, which ANY_TAG
+ * must never match.
+ *
+ * Unexpected fragments are threaded onto every bin a receive could
+ * look them up from: (src, tag) and (ANY_SOURCE, tag) always, plus
+ * (src, ANY_TAG) and (ANY_SOURCE, ANY_TAG) for non-negative tags.
+ * Since fragments are appended in arrival order, the head of the bin
+ * selected by the receive envelope is always the first matching
+ * fragment.
+ */
+
+#ifndef PML_OB1_CUSTOM_MATCH_HASH_H
+#define PML_OB1_CUSTOM_MATCH_HASH_H
+
+#include "../pml_ob1_recvreq.h"
+#include "../pml_ob1_recvfrag.h"
+
+#define CUSTOM_MATCH_HASH_INIT_BUCKETS 64
+
+/* bin kinds, also used as the index of the umq link for that bin */
+#define CUSTOM_MATCH_HASH_EXACT    0
+#define CUSTOM_MATCH_HASH_ANY_SRC  1
+#define CUSTOM_MATCH_HASH_ANY_TAG  2
+#define CUSTOM_MATCH_HASH_ANY      3
+#define CUSTOM_MATCH_HASH_KINDS    4
+
+typedef struct custom_match_hash_bin
+{
+    int tag;
+    int src;
+    struct custom_match_hash_bin* chain;
+    void* head;
+    void* tail;
+} custom_match_hash_bin;
+
+typedef struct custom_match_hash
+{
+    custom_match_hash_bin** buckets;
+    custom_match_hash_bin* pool;
+    uint32_t mask;
+    int bins;
+} custom_match_hash;
+
+static inline int custom_match_hash_kind(int tag, int src)
+{
+    return (OMPI_ANY_SOURCE == src ? CUSTOM_MATCH_HASH_ANY_SRC : 0) |
+        (OMPI_ANY_TAG == tag ? CUSTOM_MATCH_HASH_ANY_TAG : 0);
+}
+
+static inline uint32_t custom_match_hash_index(uint32_t mask, int tag, int src)
+{
+    uint32_t key = ((uint32_t) src * 0x9e3779b1u) ^ ((uint32_t) tag * 0x85ebca6bu);
+    key ^= key >> 15;
+    return key & mask;
+}
+
+static inline void custom_match_hash_init(custom_match_hash* table)
+{
+    table->buckets = calloc(CUSTOM_MATCH_HASH_INIT_BUCKETS, sizeof(custom_match_hash_bin*));
+    table->pool = 0;
+    table->mask = CUSTOM_MATCH_HASH_INIT_BUCKETS - 1;
+    table->bins = 0;
+}
+
+static inline void custom_match_hash_fini(custom_match_hash* table)
+{
+    custom_match_hash_bin* bin;
+    uint32_t i;
+
+    for(i = 0; i <= table->mask; i++)
+    {
+        while(table->buckets[i])
+        {
+            bin = table->buckets[i];
+            table->buckets[i] = bin->chain;
+            free(bin);
+        }
+    }
+    while(table->pool)
+    {
+        bin = table->pool;
+        table->pool = bin->chain;
+        free(bin);
+    }
+    free(table->buckets);
+}
+
+static inline custom_match_hash_bin* custom_match_hash_lookup(custom_match_hash* table, int tag, int src)
+{
+    custom_match_hash_bin* bin = table->buckets[custom_match_hash_index(table->mask, tag, src)];
+
+    while(bin && (bin->tag != tag || bin->src != src))
+    {
+        bin = bin->chain;
+    }
+    return bin;
+}
+
+static inline void custom_match_hash_grow(custom_match_hash* table)
+{
+    uint32_t mask = (table->mask << 1) | 1;
+    custom_match_hash_bin** buckets = calloc(mask + 1, sizeof(custom_match_hash_bin*));
+    custom_match_hash_bin* bin;
+    uint32_t i, index;
+
+    if(NULL == buckets)
+    {
+        /* keep going with longer chains */
+        return;
+    }
+    for(i = 0; i <= table->mask; i++)
+    {
+        while(table->buckets[i])
+        {
+            bin = table->buckets[i];
+            table->buckets[i] = bin->chain;
+            index = custom_match_hash_index(mask, bin->tag, bin->src);
+            bin->chain = buckets[index];
+            buckets[index] = bin;
+        }
+    }
+    free(table->buckets);
+    table->buckets = buckets;
+    table->mask = mask;
+}
+
+static inline custom_match_hash_bin* custom_match_hash_get(custom_match_hash* table, int tag, int src)
+{
+    custom_match_hash_bin* bin = custom_match_hash_lookup(table, tag, src);
+    uint32_t index;
+
+    if(bin)
+    {
+        return bin;
+    }
+    if((uint32_t) table->bins >= 2 * (table->mask + 1))
+    {
+        custom_match_hash_grow(table);
+    }
+    if(table->pool)
+    {
+        bin = table->pool;
+        table->pool = bin->chain;
+    }
+    else
+    {
+        bin = malloc(sizeof(custom_match_hash_bin));
+    }
+    index = custom_match_hash_index(table->mask, tag, src);
+    bin->tag = tag;
+    bin->src = src;
+    bin->head = 0;
+    bin->tail = 0;
+    bin->chain = table->buckets[index];
+    table->buckets[index] = bin;
+    table->bins++;
+    return bin;
+}
+
+/* return an empty bin to the pool so that the table only holds live keys */
+static inline void custom_match_hash_release(custom_match_hash* table, custom_match_hash_bin* bin)
+{
+    custom_match_hash_bin** prev = &table->buckets[custom_match_hash_index(table->mask, bin->tag, bin->src)];
+
+    while(*prev != bin)
+    {
+        prev = &(*prev)->chain;
+    }
+    *prev = bin->chain;
+    bin->chain = table->pool;
+    table->pool = bin;
+    table->bins--;
+}
+
+typedef struct custom_match_prq_node
+{
+    struct custom_match_prq_node* prev;
+    struct custom_match_prq_node* next;
+    custom_match_hash_bin* bin;
+    uint64_t seq;
+    void* value;
+} custom_match_prq_node;
+
+typedef struct custom_match_prq
+{
+    custom_match_hash table;
+    custom_match_prq_node* pool;
+    uint64_t seq;
+    int kinds[CUSTOM_MATCH_HASH_KINDS];
+    int size;
+} custom_match_prq;
+
+static inline void custom_match_prq_remove(custom_match_prq* list, custom_match_prq_node* elem)
+{
+    custom_match_hash_bin* bin = elem->bin;
+
+    if(elem->prev)
+    {
+        elem->prev->next = elem->next;
+    }
+    else
+    {
+        bin->head = elem->next;
+    }
+    if(elem->next)
+    {
+        elem->next->prev = elem->prev;
+    }
+    else
+    {
+        bin->tail = elem->prev;
+    }
+    if(!bin->head)
+    {
+        custom_match_hash_release(&list->table, bin);
+    }
+    list->kinds[custom_match_hash_kind(bin->tag, bin->src)]--;
+    list->size--;
+
+    elem->bin = 0;
+    elem->value = 0;
+    elem->next = list->pool;
+    list->pool = elem;
+}
+
+static inline int custom_match_prq_cancel(custom_match_prq* list, void* req)
+{
+#if CUSTOM_MATCH_DEBUG_VERBOSE
+    printf("custom_match_prq_cancel - list: %p req: %p\n", (void*) list, req);
+#endif
+    mca_pml_base_request_t *base = (mca_pml_base_request_t *)req;
+    custom_match_hash_bin* bin = custom_match_hash_lookup(&list->table, base->req_tag, base->req_peer);
+    custom_match_prq_node* elem;
+
+    if(!bin)
+    {
+        return 0;
+    }
+    for(elem = (custom_match_prq_node*) bin->head; elem; elem = elem->next)
+    {
+        if(elem->value == req)
+        {
+            custom_match_prq_remove(list, elem);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* oldest posted receive that can match an incoming (tag, peer) envelope */
+static inline custom_match_prq_node* custom_match_prq_find(custom_match_prq* list, int tag, int peer)
+{
+    custom_match_prq_node* best = 0;
+    custom_match_prq_node* elem;
+    custom_match_hash_bin* bin;
+
+    if(0 == list->size)
+    {
+        return 0;
+    }
+    if(list->kinds[CUSTOM_MATCH_HASH_EXACT] &&
+       (bin = custom_match_hash_lookup(&list->table, tag, peer)))
+    {
+        best = (custom_match_prq_node*) bin->head;
+    }
+    if(list->kinds[CUSTOM_MATCH_HASH_ANY_SRC] &&
+       (bin = custom_match_hash_lookup(&list->table, tag, OMPI_ANY_SOURCE)))
+    {
+        elem = (custom_match_prq_node*) bin->head;
+        if(!best || elem->seq < best->seq)
+        {
+            best = elem;
+        }
+    }
+    if(tag < 0)
+    {
+        /* ANY_TAG never matches internal (negative) tags */
+        return best;
+    }
+    if(list->kinds[CUSTOM_MATCH_HASH_ANY_TAG] &&
+       (bin = custom_match_hash_lookup(&list->table, OMPI_ANY_TAG, peer)))
+    {
+        elem = (custom_match_prq_node*) bin->head;
+        if(!best || elem->seq < best->seq)
+        {
+            best = elem;
+        }
+    }
+    if(list->kinds[CUSTOM_MATCH_HASH_ANY] &&
+       (bin = custom_match_hash_lookup(&list->table, OMPI_ANY_TAG, OMPI_ANY_SOURCE)))
+    {
+        elem = (custom_match_prq_node*) bin->head;
+        if(!best || elem->seq < best->seq)
+        {
+            best = elem;
+        }
+    }
+    return best;
+}
+
+static inline void* custom_match_prq_find_verify(custom_match_prq* list, int tag, int peer)
+{
+#if CUSTOM_MATCH_DEBUG_VERBOSE
+    printf("custom_match_prq_find_verify list: %p tag: %x peer: %x\n", (void*) list, tag, peer);
+#endif
+    custom_match_prq_node* elem = custom_match_prq_find(list, tag, peer);
+
+    return elem ? elem->value : 0;
+}
+
+static inline void* custom_match_prq_find_dequeue_verify(custom_match_prq* list, int tag, int peer)
+{
+#if CUSTOM_MATCH_DEBUG_VERBOSE
+    printf("custom_match_prq_find_dequeue_verify list: %p:%d tag: %x peer: %x\n", (void*) list, list->size, tag, peer);
+#endif
+    custom_match_prq_node* elem = custom_match_prq_find(list, tag, peer);
+    void* payload;
+
+    if(!elem)
+    {
+        return 0;
+    }
+    payload = elem->value;
+    custom_match_prq_remove(list, elem);
+    return payload;
+}
+
+static inline void custom_match_prq_append(custom_match_prq* list, void* payload, int tag, int source)
+{
+#if CUSTOM_MATCH_DEBUG_VERBOSE
+    printf("custom_match_prq_append list: %p tag: %x source: %x\n", (void*) list, tag, source);
+#endif
+    custom_match_hash_bin* bin = custom_match_hash_get(&list->table, tag, source);
+    custom_match_prq_node* elem;
+
+    if(list->pool)
+    {
+        elem = list->pool;
+        list->pool = elem->next;
+    }
+    else
+    {
+        elem = malloc(sizeof(custom_match_prq_node));
+    }
+    elem->bin = bin;
+    elem->seq = list->seq++;
+    elem->value = payload;
+    elem->next = 0;
+    elem->prev = (custom_match_prq_node*) bin->tail;
+    if(bin->tail)
+    {
+        ((custom_match_prq_node*) bin->tail)->next = elem;
+    }
+    else
+    {
+        bin->head = elem;
+    }
+    bin->tail = elem;
+    list->kinds[custom_match_hash_kind(tag, source)]++;
+    list->size++;
+}
+
+static inline int custom_match_prq_size(custom_match_prq* list)
+{
+    return list->size;
+}
+
+static inline custom_match_prq* custom_match_prq_init()
+{
+#if CUSTOM_MATCH_DEBUG_VERBOSE
+    printf("custom_match_prq_init\n");
+#endif
+    custom_match_prq* list = malloc(sizeof(custom_match_prq));
+    custom_match_hash_init(&list->table);
+    list->pool = 0;
+    list->seq = 0;
+    memset(list->kinds, 0, sizeof(list->kinds));
+    list->size = 0;
+    return list;
+}
+
+static inline void custom_match_prq_destroy(custom_match_prq* list)
+{
+#if CUSTOM_MATCH_DEBUG_VERBOSE
+    printf("custom_match_prq_destroy\n");
+#endif
+    custom_match_prq_node* elem;
+    custom_match_hash_bin* bin;
+    uint32_t i;
+
+    for(i = 0; i <= list->table.mask; i++)
+    {
+        for(bin = list->table.buckets[i]; bin; bin = bin->chain)
+        {
+            while(bin->head)
+            {
+                elem = (custom_match_prq_node*) bin->head;
+                bin->head = elem->next;
+                free(elem);
+            }
+        }
+    }
+    while(list->pool)
+    {
+        elem = list->pool;
+        list->pool = elem->next;
+        free(elem);
+    }
+    custom_match_hash_fini(&list->table);
+    free(list);
+}
+
+static inline void custom_match_print(custom_match_prq* list)
+{
+    custom_match_hash_bin* bin;
+    custom_match_prq_node* elem;
+    uint32_t i;
+
+    printf("Bins in the table (%d bins, %u buckets):\n", list->table.bins, list->table.mask + 1);
+    for(i = 0; i <= list->table.mask; i++)
+    {
+        for(bin = list->table.buckets[i]; bin; bin = bin->chain)
+        {
+            printf("bucket %u bin src %d tag %d:", i, bin->src, bin->tag);
+            for(elem = (custom_match_prq_node*) bin->head; elem; elem = elem->next)
+            {
+                printf(" %p[%" PRIu64 "]", elem->value, elem->seq);
+            }
+            printf("\n");
+        }
+    }
+}
+
+static inline void custom_match_prq_dump(custom_match_prq* list)
+{
+    char cpeer[64], ctag[64];
+    custom_match_hash_bin* bin;
+    custom_match_prq_node* elem;
+    uint32_t i;
+
+    printf("Elements in the table:\n");
+    for(i = 0; i <= list->table.mask; i++)
+    {
+        for(bin = list->table.buckets[i]; bin; bin = bin->chain)
+        {
+            for(elem = (custom_match_prq_node*) bin->head; elem; elem = elem->next)
+            {
+                mca_pml_base_request_t *req = (mca_pml_base_request_t *)elem->value;
+                if( OMPI_ANY_SOURCE == req->req_peer ) snprintf(cpeer, 64, "%s", "ANY_SOURCE");
+                else snprintf(cpeer, 64, "%d", req->req_peer);
+                if( OMPI_ANY_TAG == req->req_tag ) snprintf(ctag, 64, "%s", "ANY_TAG");
+                else snprintf(ctag, 64, "%d", req->req_tag);
+                opal_output(0, "req %p peer %s tag %s addr %p count %lu datatype %s [%p] [%s %s] req_seq %" PRIu64,
+                            (void*) req, cpeer, ctag,
+                            (void*) req->req_addr, req->req_count,
+                            (0 != req->req_count ? req->req_datatype->name : "N/A"),
+                            (void*) req->req_datatype,
+                            (req->req_pml_complete ? "pml_complete" : ""),
+                            (req->req_free_called ? "freed" : ""),
+                            req->req_sequence);
+            }
+        }
+    }
+}
+
+
+// UMQ below.
+
+typedef struct custom_match_umq_link
+{
+    struct custom_match_umq_node* prev;
+    struct custom_match_umq_node* next;
+    custom_match_hash_bin* bin;
+} custom_match_umq_link;
+
+typedef struct custom_match_umq_node
+{
+    int tag;
+    int src;
+    custom_match_umq_link link[CUSTOM_MATCH_HASH_KINDS];
+    void* value;
+} custom_match_umq_node;
+
+typedef struct custom_match_umq
+{
+    custom_match_hash table;
+    custom_match_umq_node* pool;
+    int size;
+} custom_match_umq;
+
+static inline void custom_match_umq_dump(custom_match_umq* list);
+
+static inline void* custom_match_umq_find_verify_hold(custom_match_umq* list, int tag, int peer, custom_match_umq_node** hold_prev, custom_match_umq_node** hold_elem, int* hold_index)
+{
+#if CUSTOM_MATCH_DEBUG_VERBOSE
+    printf("custom_match_umq_find_verify_hold list: %p:%d tag: %x peer: %x\n", (void*) list, list->size, tag, peer);
+    custom_match_umq_dump(list);
+#endif
+    custom_match_hash_bin* bin;
+    custom_match_umq_node* elem;
+
+    if(0 == list->size || !(bin = custom_match_hash_lookup(&list->table, tag, peer)))
+    {
+        return 0;
+    }
+    /* the bin head is the oldest fragment this envelope can match */
+    elem = (custom_match_umq_node*) bin->head;
+    *hold_prev = 0;
+    *hold_elem = elem;
+    *hold_index = custom_match_hash_kind(tag, peer);
+    return elem->value;
+}
+
+static inline void custom_match_umq_remove_hold(custom_match_umq* list, custom_match_umq_node* prev, custom_match_umq_node* elem, int i)
+{
+#if CUSTOM_MATCH_DEBUG_VERBOSE
+    printf("custom_match_umq_remove_hold %p %p %x\n", (void*) prev, (void*) elem, i);
+#endif
+    custom_match_umq_link* link;
+    int k;
+
+    for(k = 0; k < CUSTOM_MATCH_HASH_KINDS; k++)
+    {
+        link = &elem->link[k];
+        if(!link->bin)
+        {
+            continue;
+        }
+        if(link->prev)
+        {
+            link->prev->link[k].next = link->next;
+        }
+        else
+        {
+            link->bin->head = link->next;
+        }
+        if(link->next)
+        {
+            link->next->link[k].prev = link->prev;
+        }
+        else
+        {
+            link->bin->tail = link->prev;
+        }
+        if(!link->bin->head)
+        {
+            custom_match_hash_release(&list->table, link->bin);
+        }
+        link->bin = 0;
+    }
+    elem->value = 0;
+    elem->link[0].next = list->pool;
+    list->pool = elem;
+    list->size--;
+}
+
+static inline void custom_match_umq_append(custom_match_umq* list, int tag, int source, void* payload)
+{
+#if CUSTOM_MATCH_DEBUG_VERBOSE
+    printf("custom_match_umq_append list: %p payload: %p tag: %d src: %d\n", (void*) list, payload, tag, source);
+#endif
+    custom_match_umq_node* elem;
+    custom_match_hash_bin* bin;
+    int k, kinds;
+
+    if(list->pool)
+    {
+        elem = list->pool;
+        list->pool = elem->link[0].next;
+    }
+    else
+    {
+        elem = malloc(sizeof(custom_match_umq_node));
+    }
+    elem->tag = tag;
+    elem->src = source;
+    elem->value = payload;
+
+    /* negative tags are only reachable through the exact and ANY_SOURCE bins */
+    kinds = tag < 0 ? CUSTOM_MATCH_HASH_ANY_TAG : CUSTOM_MATCH_HASH_KINDS;
+    for(k = 0; k < CUSTOM_MATCH_HASH_KINDS; k++)
+    {
+        if(k >= kinds)
+        {
+            elem->link[k].bin = 0;
+            continue;
+        }
+        bin = custom_match_hash_get(&list->table,
+                                    (k & CUSTOM_MATCH_HASH_ANY_TAG) ? OMPI_ANY_TAG : tag,
+                                    (k & CUSTOM_MATCH_HASH_ANY_SRC) ? OMPI_ANY_SOURCE : source);
+        elem->link[k].bin = bin;
+        elem->link[k].next = 0;
+        elem->link[k].prev = (custom_match_umq_node*) bin->tail;
+        if(bin->tail)
+        {
+            ((custom_match_umq_node*) bin->tail)->link[k].next = elem;
+        }
+        else
+        {
+            bin->head = elem;
+        }
+        bin->tail = elem;
+    }
+    list->size++;
+}
+
+static inline custom_match_umq* custom_match_umq_init()
+{
+#if CUSTOM_MATCH_DEBUG_VERBOSE
+    printf("custom_match_umq_init\n");
+#endif
+    custom_match_umq* list = malloc(sizeof(custom_match_umq));
+    custom_match_hash_init(&list->table);
+    list->pool = 0;
+    list->size = 0;
+    return list;
+}
+
+static inline void custom_match_umq_destroy(custom_match_umq* list)
+{
+#if CUSTOM_MATCH_DEBUG_VERBOSE
+    printf("custom_match_umq_destroy\n");
+#endif
+    custom_match_umq_node* elem;
+    custom_match_hash_bin* bin;
+    uint32_t i;
+
+    /* every fragment is on exactly one exact bin */
+    for(i = 0; i <= list->table.mask; i++)
+    {
+        for(bin = list->table.buckets[i]; bin; bin = bin->chain)
+        {
+            if(CUSTOM_MATCH_HASH_EXACT != custom_match_hash_kind(bin->tag, bin->src))
+            {
+                continue;
+            }
+            while(bin->head)
+            {
+                elem = (custom_match_umq_node*) bin->head;
+                bin->head = elem->link[0].next;
+                free(elem);
+            }
+        }
+    }
+    while(list->pool)
+    {
+        elem = list->pool;
+        list->pool = elem->link[0].next;
+        free(elem);
+    }
+    custom_match_hash_fini(&list->table);
+    free(list);
+}
+
+static inline int custom_match_umq_size(custom_match_umq* list)
+{
+    return list->size;
+}
+
+static inline void custom_match_umq_dump(custom_match_umq* list)
+{
+    custom_match_hash_bin* bin;
+    custom_match_umq_node* elem;
+    uint32_t i;
+
+    printf("Elements in the table:\n");
+    for(i = 0; i <= list->table.mask; i++)
+    {
+        for(bin = list->table.buckets[i]; bin; bin = bin->chain)
+        {
+            if(CUSTOM_MATCH_HASH_EXACT != custom_match_hash_kind(bin->tag, bin->src))
+            {
+                continue;
+            }
+            for(elem = (custom_match_umq_node*) bin->head; elem; elem = elem->link[0].next)
+            {
+                mca_pml_ob1_recv_frag_t *frag = (mca_pml_ob1_recv_frag_t *)elem->value;
+                printf("%p tag %d src %d\n", (void*) frag, frag->hdr.hdr_match.hdr_tag,
+                       frag->hdr.hdr_match.hdr_src);
+            }
+        }
+    }
+}
+
+#endif
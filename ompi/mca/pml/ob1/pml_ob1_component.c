@@ -60,6 +60,24 @@ int mca_pml_ob1_output = 0;
 static int mca_pml_ob1_verbose = 0;
 bool mca_pml_ob1_matching_protection = false;
 
+#if MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_LINKEDLIST
+static char *mca_pml_ob1_matching_engine = "default";
+#elif MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_ARRAYS
+static char *mca_pml_ob1_matching_engine = "arrays";
+#elif MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_BYTE
+static char *mca_pml_ob1_matching_engine = "fuzzy-byte";
+#elif MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_SHORT
+static char *mca_pml_ob1_matching_engine = "fuzzy-short";
+#elif MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_WORD
+static char *mca_pml_ob1_matching_engine = "fuzzy-word";
+#elif MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_VECTOR
+static char *mca_pml_ob1_matching_engine = "vector";
+#elif MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_HASH
+static char *mca_pml_ob1_matching_engine = "hash";
+#else
+static char *mca_pml_ob1_matching_engine = "none";
+#endif
+
 mca_pml_base_component_2_0_0_t mca_pml_ob1_component = {
     /* First, the mca_base_component_t struct containing meta
        information about the component itself */
@@ -225,6 +243,14 @@ static int mca_pml_ob1_component_register(void)
                                            "Name of allocator component for unexpected messages",
                                            MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0, OPAL_INFO_LVL_9,
                                            MCA_BASE_VAR_SCOPE_READONLY, &mca_pml_ob1.allocator_name);
+
+    /* informational only, the engine is selected with --with-pml-ob1-matching */
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "matching_engine",
+                                           "Matching engine pml/ob1 was configured with",
+                                           MCA_BASE_VAR_TYPE_STRING, NULL, 0, MCA_BASE_VAR_FLAG_DEFAULT_ONLY,
+                                           OPAL_INFO_LVL_9, MCA_BASE_VAR_SCOPE_CONSTANT,
+                                           &mca_pml_ob1_matching_engine);
+
     (void)mca_base_component_pvar_register(&mca_pml_ob1_component.pmlm_version,
                                            "unexpected_msgq_length", "Number of unexpected messages "
                                            "received by each peer in a communicator", OPAL_INFO_LVL_4, MPI_T_PVAR_CLASS_SIZE,
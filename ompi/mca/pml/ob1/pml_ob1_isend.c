@@ -130,6 +130,7 @@ static inline int mca_pml_ob1_send_inline (const void *buf, size_t count,
 #if SPC_ENABLE == 1
     if(OPAL_LIKELY(rc == OPAL_SUCCESS)) {
         SPC_USER_OR_MPI(tag, (ompi_spc_value_t)size, OMPI_SPC_BYTES_SENT_USER, OMPI_SPC_BYTES_SENT_MPI);
+        SPC_RECORD_SENT(comm, size);
     }
 #endif
 
@@ -60,6 +60,7 @@ int mca_pml_ob1_enable_progress(int32_t count)
     if( 1 < progress_count )
         return 0;  /* progress was already on */
 
+    (void) opal_progress_set_name(mca_pml_ob1_progress, "pml_ob1");
     opal_progress_register(mca_pml_ob1_progress);
     return 1;
 }
@@ -35,6 +35,7 @@
 #include "ompi/mca/pml/ob1/pml_ob1_comm.h"
 #include "opal/mca/mpool/base/base.h"
 #include "ompi/mca/pml/base/pml_base_recvreq.h"
+#include "ompi/runtime/ompi_spc.h"
 
 BEGIN_C_DECLS
 
@@ -160,6 +161,12 @@ recv_request_pml_complete(mca_pml_ob1_recv_request_t *recvreq)
 
     if(false == recvreq->req_recv.req_base.req_pml_complete){
 
+        /* probes complete here as well when they match. the message is
+         * only counted by the receive (or mrecv) that consumes it */
+        if (MCA_PML_REQUEST_RECV == recvreq->req_recv.req_base.req_type) {
+            SPC_RECORD_RECEIVED(recvreq->req_recv.req_base.req_comm, recvreq->req_bytes_received);
+        }
+
         if(recvreq->req_recv.req_bytes_packed > 0) {
             PERUSE_TRACE_COMM_EVENT( PERUSE_COMM_REQ_XFER_END,
                     &recvreq->req_recv.req_base, PERUSE_RECV );
@@ -28,6 +28,7 @@
 #include "ompi/mca/mca.h"
 #include "ompi/mca/sharedfp/sharedfp.h"
 #include "ompi/mca/common/ompio/common_ompio.h"
+#include "opal/sys/atomic.h"
 #include <semaphore.h>
 
 BEGIN_C_DECLS
@@ -106,7 +107,9 @@ int mca_sharedfp_sm_iwrite (ompio_file_t *fh,
  *--------------------------------------------------------------*/
 struct mca_sharedfp_sm_offset{
     sem_t mutex;      /* the mutex: a POSIX memory-based unnamed semaphore */
-    long long offset;  /* and the shared file pointer offset */
+    opal_atomic_int64_t offset;  /* and the shared file pointer offset */
+    opal_atomic_int64_t turn;    /* ticket of the process next to request its
+                                    position in the ordered functions */
 };
 
 /*This structure will hang off of the mca_sharedfp_base_data_t's
@@ -122,6 +125,7 @@ struct mca_sharedfp_sm_data
        semaphore located in sm_offset_ptr->mutex. */
     sem_t *mutex;
     char *sem_name;    /* Name of the semaphore */
+    int64_t ordered_calls;  /* number of ordered functions called on the file */
 };
 
 typedef struct mca_sharedfp_sm_data sm_data;
@@ -130,6 +134,9 @@ typedef struct mca_sharedfp_sm_data sm_data;
 int mca_sharedfp_sm_request_position (ompio_file_t *fh,
                                       int bytes_requested,
                                       OMPI_MPI_OFFSET_TYPE * offset);
+int mca_sharedfp_sm_request_ordered_position (ompio_file_t *fh,
+                                              long bytes_requested,
+                                              OMPI_MPI_OFFSET_TYPE * offset);
 /*
  * ******************************************************************
  * ************ functions implemented in this module end ************
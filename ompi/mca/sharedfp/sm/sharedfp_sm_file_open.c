@@ -95,6 +95,7 @@ int mca_sharedfp_sm_file_open (struct ompi_communicator_t *comm,
         return OMPI_ERR_OUT_OF_RESOURCE;
     }
     sm_data->sm_filename=NULL;
+    sm_data->ordered_calls=0;
 
 
     /* the shared memory segment is identified opening a file
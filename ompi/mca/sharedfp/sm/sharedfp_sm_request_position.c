@@ -27,6 +27,8 @@
 #include "ompi/mca/sharedfp/sharedfp.h"
 #include "ompi/mca/sharedfp/base/base.h"
 
+#include "opal/runtime/opal_progress.h"
+
 /*use a semaphore to lock the shared memory*/
 #include <semaphore.h>
 
@@ -35,7 +37,6 @@ int mca_sharedfp_sm_request_position(ompio_file_t *fh,
                                      OMPI_MPI_OFFSET_TYPE *offset)
 {
     int ret = OMPI_SUCCESS;
-    OMPI_MPI_OFFSET_TYPE position = 0;
     OMPI_MPI_OFFSET_TYPE old_offset;
     struct mca_sharedfp_sm_data * sm_data = NULL;
     struct mca_sharedfp_sm_offset * sm_offset_ptr = NULL;
@@ -45,12 +46,26 @@ int mca_sharedfp_sm_request_position(ompio_file_t *fh,
     sm_data = sh->selected_module_data;
 
     *offset = 0;
+    sm_offset_ptr = sm_data->sm_offset_ptr;
+
+#if OPAL_HAVE_ATOMIC_MATH_64
+    /* The offset is the only state updated here, so a fetch-and-add on
+    ** the shared memory segment replaces the critical section. The
+    ** semaphore is only needed by seek, which stores a new offset.
+    */
+    old_offset = opal_atomic_fetch_add_64(&sm_offset_ptr->offset, bytes_requested);
     if ( mca_sharedfp_sm_verbose ) {
         opal_output(ompi_sharedfp_base_framework.framework_output,
-                    "Aquiring lock, rank=%d...",fh->f_rank);
+                    "old_offset=%lld, bytes_requested=%d, new offset=%lld, rank=%d\n",
+                    old_offset,bytes_requested,old_offset+bytes_requested,fh->f_rank);
     }
+#else
+    OMPI_MPI_OFFSET_TYPE position = 0;
 
-    sm_offset_ptr = sm_data->sm_offset_ptr;
+    if ( mca_sharedfp_sm_verbose ) {
+        opal_output(ompi_sharedfp_base_framework.framework_output,
+                    "Aquiring lock, rank=%d...",fh->f_rank);
+    }
 
     /* Aquire an exclusive lock */
 
@@ -85,8 +100,131 @@ int mca_sharedfp_sm_request_position(ompio_file_t *fh,
         opal_output(ompi_sharedfp_base_framework.framework_output,
                     "Released lock! released lock.for rank=%d\n",fh->f_rank);
     }
+#endif
 
     *offset = old_offset;
 
     return ret;
 }
+
+/* Request the position of the data of this process in one of the
+** ordered functions: the processes obtain contiguous regions in the
+** order of their ranks, the shared file pointer being advanced by the
+** sum of the requests. The offset returned is in bytes.
+*/
+int mca_sharedfp_sm_request_ordered_position(ompio_file_t *fh,
+                                             long bytes_requested,
+                                             OMPI_MPI_OFFSET_TYPE *offset)
+{
+    int ret = OMPI_SUCCESS;
+
+    *offset = 0;
+
+#if OPAL_HAVE_ATOMIC_MATH_64
+    struct mca_sharedfp_base_data_t *sh = fh->f_sharedfp_data;
+    struct mca_sharedfp_sm_data * sm_data = sh->selected_module_data;
+    struct mca_sharedfp_sm_offset * sm_offset_ptr = sm_data->sm_offset_ptr;
+    int64_t ticket;
+
+    /* Every process takes a ticket: the n-th ordered call on the file
+    ** hands out the tickets n*size .. n*size+size-1 in the order of the
+    ** ranks. A process waits for the turn counter to reach its ticket,
+    ** advances the shared file pointer and passes the turn on, so no
+    ** gather and scatter through rank 0 is needed.
+    */
+    ticket = sm_data->ordered_calls * fh->f_size + fh->f_rank;
+    sm_data->ordered_calls++;
+
+    while ( sm_offset_ptr->turn != ticket ) {
+        opal_progress();
+    }
+    opal_atomic_rmb();
+
+    *offset = opal_atomic_fetch_add_64(&sm_offset_ptr->offset, bytes_requested);
+
+    opal_atomic_wmb();
+    sm_offset_ptr->turn = ticket + 1;
+
+    if ( mca_sharedfp_sm_verbose ) {
+        opal_output(ompi_sharedfp_base_framework.framework_output,
+                    "mca_sharedfp_sm_request_ordered_position: ticket %lld, offset %lld, rank=%d\n",
+                    (long long) ticket, *offset, fh->f_rank);
+    }
+#else
+    long sendBuff = bytes_requested;
+    long *buff=NULL;
+    long offsetBuff;
+    OMPI_MPI_OFFSET_TYPE offsetReceived = 0;
+    long bytesRequested = 0;
+    int recvcnt = 1, sendcnt = 1;
+    int i;
+
+    if ( 0  == fh->f_rank ) {
+        buff = (long*)malloc(sizeof(long) * fh->f_size);
+        if (  NULL == buff )
+            return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    ret = fh->f_comm->c_coll->coll_gather ( &sendBuff, 
+                                            sendcnt, 
+                                            OMPI_OFFSET_DATATYPE,
+                                            buff, 
+                                            recvcnt, 
+                                            OMPI_OFFSET_DATATYPE, 
+                                            0,
+                                            fh->f_comm, 
+                                            fh->f_comm->c_coll->coll_gather_module );
+    if( OMPI_SUCCESS != ret){
+        goto exit;
+    }
+
+    /* All the counts are present now in the recvBuff.
+    ** The size of recvBuff is sizeof_newComm
+    */
+    if (  0 == fh->f_rank ) {
+        for (i = 0; i < fh->f_size ; i ++) {
+            bytesRequested += buff[i];
+        }
+
+        /* Request the offset for bytesRequested bytes
+        ** only the root process needs to do the request,
+        ** since the root process will then tell the other
+        ** processes at what offset they should access their
+        ** share of the data.
+        */
+        ret = mca_sharedfp_sm_request_position(fh,bytesRequested,&offsetReceived);
+        if( OMPI_SUCCESS != ret){
+            goto exit;
+        }
+
+        buff[0] += offsetReceived;
+        for (i = 1 ; i < fh->f_size; i++)  {
+            buff[i] += buff[i-1];
+        }
+    }
+
+    /* Scatter the results to the other processes*/
+    ret = fh->f_comm->c_coll->coll_scatter ( buff, 
+                                             sendcnt, 
+                                             OMPI_OFFSET_DATATYPE,
+                                             &offsetBuff, 
+                                             recvcnt, 
+                                             OMPI_OFFSET_DATATYPE, 
+                                             0,
+                                             fh->f_comm, 
+                                             fh->f_comm->c_coll->coll_scatter_module );
+    if( OMPI_SUCCESS != ret){
+        goto exit;
+    }
+
+    /*Each process now has its own individual offset in recvBUFF*/
+    *offset = offsetBuff - sendBuff;
+
+exit:
+    if ( NULL != buff ) {
+        free ( buff );
+    }
+#endif
+
+    return ret;
+}
@@ -0,0 +1,634 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Every entry of an array handled through a completion queue has a
+ * slot. An active request is armed by swapping the tagged slot address
+ * into its req_complete, where a plain wait would install its
+ * wait_sync. ompi_request_complete() then pushes the slot on the lock
+ * free ready list of the queue and wakes the owner if it is blocked.
+ *
+ * The user may change the array between calls, and other wait
+ * functions may take armed requests over (ompi_request_cq_steal). The
+ * queue therefore never trusts a pushed slot: the owner re-reads the
+ * array entry and the request state, and re-arms as needed. Entries
+ * that held no active request when last seen are kept on a hole list.
+ * They stay there until the entry changes or its inactive request is
+ * started again, and the list is only looked at when no completion is
+ * queued, at most once per call. The rare requests that could not be
+ * armed because another thread is waiting on them are kept on a polled
+ * list, which is re-read on every call and while blocking.
+ *
+ * The queue is reference counted by its owner and by each armed
+ * request, so that a completion racing with the eviction of the queue
+ * from the cache never touches freed memory. Whoever swaps the tagged
+ * slot out of a request also clears the slot's armed pointer, so the
+ * owner only ever disarms requests that are still alive.
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+
+#include "opal/mca/threads/mutex.h"
+#include "opal/runtime/opal_progress.h"
+#include "ompi/constants.h"
+#include "ompi/request/request.h"
+#include "ompi/request/request_cq.h"
+#include "ompi/request/grequest.h"
+#include "ompi/runtime/params.h"
+#include "ompi/mca/crcp/crcp.h"
+
+#define OMPI_REQUEST_CQ_CACHE_SIZE 4
+
+typedef struct ompi_request_cq_slot_t {
+    struct ompi_request_cq_t *cq;
+    struct ompi_request_cq_slot_t *next;     /**< ready list link */
+    opal_atomic_int32_t queued;              /**< on the ready list or the owner's queue */
+    ompi_request_t *volatile armed;          /**< request holding this slot in req_complete */
+    /* the fields below are only used by the owner of the queue */
+    ompi_request_t *request;                 /**< active request last seen in the entry */
+    ompi_request_t *seen;                    /**< entry when it was put on the hole list */
+    bool hole;                               /**< entry is on the hole or the polled list */
+} ompi_request_cq_slot_t;
+
+struct ompi_request_cq_t {
+    ompi_request_t **requests;
+    size_t count;
+    bool busy;
+    opal_atomic_int32_t refcount;            /**< owner plus one per armed request */
+    ompi_request_cq_slot_t *volatile ready;  /**< slots pushed by completions, newest first */
+    ompi_wait_sync_t *volatile sync;         /**< set while the owner is blocked */
+    ompi_request_cq_slot_t *head;            /**< slots taken off the ready list, oldest first */
+    ompi_request_cq_slot_t *tail;
+    size_t live;                             /**< entries holding an active request */
+    size_t nholes;
+    size_t *holes;                           /**< entries without an active request */
+    size_t npolled;
+    size_t *polled;                          /**< active requests that could not be armed */
+    ompi_request_cq_slot_t slots[];
+};
+
+static opal_mutex_t ompi_request_cq_lock;
+static ompi_request_cq_t *ompi_request_cq_cache[OMPI_REQUEST_CQ_CACHE_SIZE];
+static int ompi_request_cq_victim = 0;
+
+static inline void *ompi_request_cq_tag(ompi_request_cq_slot_t *slot)
+{
+    return (void *) ((intptr_t) slot | OMPI_REQUEST_CQ_TAG);
+}
+
+static inline ompi_request_cq_slot_t *ompi_request_cq_untag(void *tagged)
+{
+    return (ompi_request_cq_slot_t *) ((intptr_t) tagged & ~OMPI_REQUEST_CQ_TAG);
+}
+
+static inline void ompi_request_cq_unref(ompi_request_cq_t *cq)
+{
+    if (0 == OPAL_THREAD_ADD_FETCH32(&cq->refcount, -1)) {
+        free(cq);
+    }
+}
+
+static void ompi_request_cq_push(ompi_request_cq_t *cq, ompi_request_cq_slot_t *slot)
+{
+    ompi_request_cq_slot_t *next;
+    ompi_wait_sync_t *sync;
+
+    /* if the slot is already queued the owner will re-read the entry anyway */
+    if (0 == OPAL_THREAD_SWAP_32(&slot->queued, 1)) {
+        next = cq->ready;
+        do {
+            slot->next = next;
+        } while (!OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&cq->ready, &next, slot));
+    }
+
+    if (NULL != cq->sync) {
+        sync = (ompi_wait_sync_t *) OPAL_ATOMIC_SWAP_PTR(&cq->sync, NULL);
+        if (NULL != sync) {
+            wait_sync_update(sync, 1, OPAL_SUCCESS);
+        }
+    }
+}
+
+void ompi_request_cq_signal(ompi_request_t *request, void *tagged)
+{
+    ompi_request_cq_slot_t *slot = ompi_request_cq_untag(tagged);
+    ompi_request_cq_t *cq = slot->cq;
+    ompi_request_t *armed = request;
+
+    (void) OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&slot->armed, &armed, NULL);
+    ompi_request_cq_push(cq, slot);
+    ompi_request_cq_unref(cq);
+}
+
+void ompi_request_cq_steal(ompi_request_t *request, void *tagged)
+{
+    ompi_request_cq_slot_t *slot = ompi_request_cq_untag(tagged);
+    ompi_request_cq_t *cq = slot->cq;
+    ompi_request_t *armed = request;
+
+    if (OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&request->req_complete, &tagged, REQUEST_PENDING)) {
+        (void) OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&slot->armed, &armed, NULL);
+        ompi_request_cq_push(cq, slot);
+        ompi_request_cq_unref(cq);
+    }
+    /* otherwise the request completed meanwhile and the completion pushed the slot */
+}
+
+static inline void ompi_request_cq_set_request(ompi_request_cq_t *cq, ompi_request_cq_slot_t *slot,
+                                               ompi_request_t *request)
+{
+    if (NULL == slot->request && NULL != request) {
+        cq->live++;
+    } else if (NULL != slot->request && NULL == request) {
+        cq->live--;
+    }
+    slot->request = request;
+}
+
+static inline void ompi_request_cq_add_hole(ompi_request_cq_t *cq, ompi_request_cq_slot_t *slot,
+                                            ompi_request_t *request)
+{
+    slot->seen = request;
+    if (!slot->hole) {
+        slot->hole = true;
+        cq->holes[cq->nholes++] = (size_t) (slot - cq->slots);
+    }
+}
+
+static inline void ompi_request_cq_add_polled(ompi_request_cq_t *cq, ompi_request_cq_slot_t *slot)
+{
+    if (!slot->hole) {
+        slot->hole = true;
+        cq->polled[cq->npolled++] = (size_t) (slot - cq->slots);
+    }
+}
+
+static inline void ompi_request_cq_enqueue(ompi_request_cq_t *cq, ompi_request_cq_slot_t *slot)
+{
+    if (0 == OPAL_THREAD_SWAP_32(&slot->queued, 1)) {
+        slot->next = NULL;
+        if (NULL == cq->tail) {
+            cq->head = slot;
+        } else {
+            cq->tail->next = slot;
+        }
+        cq->tail = slot;
+    }
+}
+
+/* detach the request last armed in this slot, if it is still armed */
+static void ompi_request_cq_forget(ompi_request_cq_t *cq, ompi_request_cq_slot_t *slot)
+{
+    ompi_request_t *request = slot->armed;
+    void *tagged = ompi_request_cq_tag(slot);
+
+    /* once the armed pointer is ours a racing completion can only be
+     * in progress, so the request is still valid */
+    if (NULL == request ||
+        !OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&slot->armed, &request, NULL)) {
+        return;
+    }
+    if (OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&request->req_complete, &tagged, REQUEST_PENDING)) {
+        /* the owner holds a reference, this cannot be the last one */
+        (void) OPAL_THREAD_ADD_FETCH32(&cq->refcount, -1);
+    }
+}
+
+static void ompi_request_cq_arm(ompi_request_cq_t *cq, ompi_request_cq_slot_t *slot)
+{
+    ompi_request_t *request = cq->requests[slot - cq->slots];
+    void *tmp = REQUEST_PENDING;
+
+    if (OMPI_REQUEST_INACTIVE == request->req_state) {
+        ompi_request_cq_set_request(cq, slot, NULL);
+        ompi_request_cq_add_hole(cq, slot, request);
+        return;
+    }
+
+    ompi_request_cq_set_request(cq, slot, request);
+    OPAL_THREAD_ADD_FETCH32(&cq->refcount, 1);
+    /* publish before arming, a completion may clear it right away */
+    slot->armed = request;
+    opal_atomic_wmb();
+    if (OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&request->req_complete, &tmp, ompi_request_cq_tag(slot))) {
+        return;
+    }
+    (void) OPAL_THREAD_ADD_FETCH32(&cq->refcount, -1);
+    if (ompi_request_cq_tag(slot) == tmp) {
+        /* already armed here */
+        return;
+    }
+    slot->armed = NULL;
+
+    if (REQUEST_COMPLETED == tmp) {
+        ompi_request_cq_enqueue(cq, slot);
+    } else {
+        /* another thread is waiting on this request, poll it */
+        ompi_request_cq_add_polled(cq, slot);
+    }
+}
+
+/* arm the holes whose entry changed or whose request was started again */
+static void ompi_request_cq_scan_holes(ompi_request_cq_t *cq)
+{
+    size_t nholes = cq->nholes;
+    ompi_request_cq_slot_t *slot;
+    ompi_request_t *request;
+
+    /* the list is compacted in place, arming appends behind the cursor */
+    cq->nholes = 0;
+    for (size_t i = 0; i < nholes; i++) {
+        slot = cq->slots + cq->holes[i];
+        request = cq->requests[cq->holes[i]];
+        if (request == slot->seen && OMPI_REQUEST_INACTIVE == request->req_state) {
+            cq->holes[cq->nholes++] = cq->holes[i];
+            continue;
+        }
+        slot->hole = false;
+        ompi_request_cq_arm(cq, slot);
+    }
+}
+
+static void ompi_request_cq_scan_polled(ompi_request_cq_t *cq)
+{
+    size_t npolled = cq->npolled;
+    ompi_request_cq_slot_t *slot;
+
+    cq->npolled = 0;
+    for (size_t i = 0; i < npolled; i++) {
+        slot = cq->slots + cq->polled[i];
+        slot->hole = false;
+        ompi_request_cq_arm(cq, slot);
+    }
+}
+
+/* re-read the entry of a queued slot, returns true if it holds a completed request */
+static bool ompi_request_cq_check(ompi_request_cq_t *cq, ompi_request_cq_slot_t *slot)
+{
+    ompi_request_t *request = cq->requests[slot - cq->slots];
+    void *state;
+
+    if (request != slot->request) {
+        ompi_request_cq_forget(cq, slot);
+        ompi_request_cq_arm(cq, slot);
+        return false;
+    }
+    if (slot->hole) {
+        return false;
+    }
+    state = (void *) request->req_complete;
+    if (ompi_request_cq_tag(slot) == state) {
+        /* still armed, the slot was pushed on behalf of a previous request */
+        return false;
+    }
+    if (REQUEST_COMPLETED != state) {
+        /* taken over by another wait, or restarted */
+        ompi_request_cq_arm(cq, slot);
+        return false;
+    }
+    if (OMPI_REQUEST_INACTIVE == request->req_state) {
+        ompi_request_cq_set_request(cq, slot, NULL);
+        ompi_request_cq_add_hole(cq, slot, request);
+        return false;
+    }
+    return true;
+}
+
+static ompi_request_cq_slot_t *ompi_request_cq_next(ompi_request_cq_t *cq)
+{
+    ompi_request_cq_slot_t *slot, *list, *next;
+
+    for (;;) {
+        if (NULL == cq->head && NULL != cq->ready) {
+            /* the ready list is newest first, append it oldest first */
+            list = (ompi_request_cq_slot_t *) OPAL_ATOMIC_SWAP_PTR(&cq->ready, NULL);
+            for (slot = NULL; NULL != list; list = next) {
+                next = list->next;
+                list->next = slot;
+                slot = list;
+            }
+            cq->head = slot;
+            for (cq->tail = slot; NULL != cq->tail->next; cq->tail = cq->tail->next);
+        }
+        if (NULL == (slot = cq->head)) {
+            return NULL;
+        }
+        if (NULL == (cq->head = slot->next)) {
+            cq->tail = NULL;
+        }
+        /* from now on a completion pushes the slot again */
+        (void) OPAL_THREAD_SWAP_32(&slot->queued, 0);
+        if (ompi_request_cq_check(cq, slot)) {
+            return slot;
+        }
+    }
+}
+
+static void ompi_request_cq_block(ompi_request_cq_t *cq)
+{
+    ompi_wait_sync_t sync;
+
+    if (0 < cq->npolled) {
+        /* no completion will wake us up for these */
+        opal_progress();
+        ompi_request_cq_scan_polled(cq);
+        return;
+    }
+
+    WAIT_SYNC_INIT(&sync, 1);
+    (void) OPAL_ATOMIC_SWAP_PTR(&cq->sync, &sync);
+    if (NULL == cq->ready) {
+        SYNC_WAIT(&sync);
+    }
+    if (&sync == (ompi_wait_sync_t *) OPAL_ATOMIC_SWAP_PTR(&cq->sync, NULL)) {
+        /* nobody took the sync, so nobody will signal it */
+        WAIT_SYNC_SIGNALLED(&sync);
+    }
+    WAIT_SYNC_RELEASE(&sync);
+}
+
+/* the entry was returned to the user, it is empty or inactive now */
+static inline void ompi_request_cq_retire_entry(ompi_request_cq_t *cq, size_t index)
+{
+    ompi_request_cq_slot_t *slot = cq->slots + index;
+
+    ompi_request_cq_set_request(cq, slot, NULL);
+    ompi_request_cq_add_hole(cq, slot, cq->requests[index]);
+}
+
+int ompi_request_cq_wait_any(ompi_request_cq_t *cq, int *index,
+                             ompi_status_public_t *status)
+{
+    ompi_request_cq_slot_t *slot;
+    ompi_request_t *request;
+    bool scanned = false;
+    int rc;
+
+    ompi_request_cq_scan_polled(cq);
+    while (NULL == (slot = ompi_request_cq_next(cq))) {
+        if (!scanned) {
+            /* any completed request will do, only look at the holes if there is none */
+            ompi_request_cq_scan_holes(cq);
+            scanned = true;
+            continue;
+        }
+        if (0 == cq->live) {
+            *index = MPI_UNDEFINED;
+            if (MPI_STATUS_IGNORE != status) {
+                *status = ompi_status_empty;
+            }
+            return OMPI_SUCCESS;
+        }
+        ompi_request_cq_block(cq);
+    }
+
+    *index = (int) (slot - cq->slots);
+    request = cq->requests[*index];
+    assert( REQUEST_COMPLETE(request) );
+#if OPAL_ENABLE_FT_CR == 1
+    if( opal_cr_is_enabled ) {
+        OMPI_CRCP_REQUEST_COMPLETE(request);
+    }
+#endif
+    /* Per note in req_wait.c, we have to call gen request query_fn
+       even if STATUS_IGNORE was provided */
+    if (OMPI_REQUEST_GEN == request->req_type) {
+        rc = ompi_grequest_invoke_query(request, &request->req_status);
+    }
+    if (MPI_STATUS_IGNORE != status) {
+        /* Do *NOT* set status->MPI_ERROR here!  See MPI-1.1 doc,
+           sec 3.2.5, p.22 */
+        int old_error = status->MPI_ERROR;
+        *status = request->req_status;
+        status->MPI_ERROR = old_error;
+    }
+    rc = request->req_status.MPI_ERROR;
+    if( request->req_persistent ) {
+        request->req_state = OMPI_REQUEST_INACTIVE;
+    } else if (MPI_SUCCESS == rc) {
+        /* Only free the request if there is no error on it */
+        rc = ompi_request_free(&cq->requests[*index]);
+    }
+    ompi_request_cq_retire_entry(cq, *index);
+
+    return rc;
+}
+
+int ompi_request_cq_wait_some(ompi_request_cq_t *cq, bool blocking, int *outcount,
+                              int *indices, ompi_status_public_t *statuses)
+{
+    ompi_request_cq_slot_t *slot;
+    ompi_request_t *request;
+    size_t num_requests_done = 0;
+    bool scanned = false;
+    int rc = MPI_SUCCESS;
+
+    ompi_request_cq_scan_polled(cq);
+#if OPAL_ENABLE_PROGRESS_THREADS == 0
+    if (!blocking && NULL == cq->head && NULL == cq->ready) {
+        opal_progress();
+    }
+#endif
+    for (;;) {
+        while (NULL != (slot = ompi_request_cq_next(cq))) {
+            indices[num_requests_done++] = (int) (slot - cq->slots);
+        }
+        if (0 != num_requests_done) {
+            break;
+        }
+        if (!scanned) {
+            ompi_request_cq_scan_holes(cq);
+            scanned = true;
+            continue;
+        }
+        if (!blocking || 0 == cq->live) {
+            break;
+        }
+        ompi_request_cq_block(cq);
+    }
+
+    if (0 == num_requests_done && 0 == cq->live) {
+        *outcount = MPI_UNDEFINED;
+        return OMPI_SUCCESS;
+    }
+    *outcount = (int) num_requests_done;
+
+    for (size_t i = 0; i < num_requests_done; i++) {
+        request = cq->requests[indices[i]];
+        assert( REQUEST_COMPLETE(request) );
+
+#if OPAL_ENABLE_FT_CR == 1
+        if( opal_cr_is_enabled) {
+            OMPI_CRCP_REQUEST_COMPLETE(request);
+        }
+#endif
+
+        /* Per note in req_wait.c, we have to call gen request query_fn
+           even if STATUS_IGNORE was provided */
+        if (OMPI_REQUEST_GEN == request->req_type) {
+            ompi_grequest_invoke_query(request, &request->req_status);
+        }
+        if (MPI_STATUSES_IGNORE != statuses) {
+            statuses[i] = request->req_status;
+        }
+
+        if (MPI_SUCCESS != request->req_status.MPI_ERROR) {
+            rc = MPI_ERR_IN_STATUS;
+        }
+
+        if( request->req_persistent ) {
+            request->req_state = OMPI_REQUEST_INACTIVE;
+        } else if (MPI_SUCCESS == request->req_status.MPI_ERROR) {
+            /* Only free the request if there was no error */
+            int tmp = ompi_request_free(&cq->requests[indices[i]]);
+            if (OMPI_SUCCESS != tmp) {
+                rc = tmp;
+            }
+        }
+        ompi_request_cq_retire_entry(cq, indices[i]);
+    }
+
+    return rc;
+}
+
+static ompi_request_cq_t *ompi_request_cq_create(ompi_request_t **requests, size_t count)
+{
+    ompi_request_cq_t *cq;
+
+    cq = malloc(sizeof(*cq) + count * (sizeof(ompi_request_cq_slot_t) + 2 * sizeof(size_t)));
+    if (NULL == cq) {
+        return NULL;
+    }
+
+    cq->requests = requests;
+    cq->count = count;
+    cq->busy = true;
+    cq->refcount = 1;
+    cq->ready = NULL;
+    cq->sync = NULL;
+    cq->head = cq->tail = NULL;
+    cq->live = 0;
+    cq->holes = (size_t *) (cq->slots + count);
+    cq->polled = cq->holes + count;
+    cq->npolled = 0;
+
+    /* every entry starts as a hole and is armed by the first scan */
+    for (size_t i = 0; i < count; i++) {
+        cq->slots[i].cq = cq;
+        cq->slots[i].next = NULL;
+        cq->slots[i].queued = 0;
+        cq->slots[i].armed = NULL;
+        cq->slots[i].request = NULL;
+        cq->slots[i].seen = NULL;
+        cq->slots[i].hole = true;
+        cq->holes[i] = i;
+    }
+    cq->nholes = count;
+
+    return cq;
+}
+
+/* disarm all requests and drop the owner reference */
+static void ompi_request_cq_destroy(ompi_request_cq_t *cq)
+{
+    for (size_t i = 0; i < cq->count; i++) {
+        ompi_request_cq_forget(cq, cq->slots + i);
+    }
+    ompi_request_cq_unref(cq);
+}
+
+ompi_request_cq_t *ompi_request_cq_acquire(ompi_request_t **requests, size_t count)
+{
+    ompi_request_cq_t *cq = NULL, *victim = NULL;
+    int i, index = -1;
+
+    if (0 == ompi_mpi_request_cq_threshold || count < ompi_mpi_request_cq_threshold) {
+        return NULL;
+    }
+
+    OPAL_THREAD_LOCK(&ompi_request_cq_lock);
+    for (i = 0; i < OMPI_REQUEST_CQ_CACHE_SIZE; i++) {
+        cq = ompi_request_cq_cache[i];
+        if (NULL != cq && requests == cq->requests) {
+            if (cq->busy) {
+                /* another thread is waiting on the same array */
+                cq = NULL;
+            } else if (count != cq->count) {
+                /* a request is armed on one queue at most, replace the queue
+                 * rather than have two of them compete for the same array */
+                index = i;
+                break;
+            } else {
+                cq->busy = true;
+            }
+            OPAL_THREAD_UNLOCK(&ompi_request_cq_lock);
+            return cq;
+        }
+        if (NULL == cq && -1 == index) {
+            index = i;
+        }
+    }
+
+    /* evict an idle queue round-robin if there is no free entry */
+    for (i = 0; -1 == index && i < OMPI_REQUEST_CQ_CACHE_SIZE; i++) {
+        int j = (ompi_request_cq_victim + i) % OMPI_REQUEST_CQ_CACHE_SIZE;
+        if (!ompi_request_cq_cache[j]->busy) {
+            index = j;
+            ompi_request_cq_victim = j + 1;
+        }
+    }
+    if (-1 == index) {
+        OPAL_THREAD_UNLOCK(&ompi_request_cq_lock);
+        return NULL;
+    }
+
+    victim = ompi_request_cq_cache[index];
+    cq = ompi_request_cq_create(requests, count);
+    ompi_request_cq_cache[index] = cq;
+    OPAL_THREAD_UNLOCK(&ompi_request_cq_lock);
+
+    if (NULL != victim) {
+        ompi_request_cq_destroy(victim);
+    }
+
+    return cq;
+}
+
+void ompi_request_cq_release(ompi_request_cq_t *cq)
+{
+    OPAL_THREAD_LOCK(&ompi_request_cq_lock);
+    cq->busy = false;
+    OPAL_THREAD_UNLOCK(&ompi_request_cq_lock);
+}
+
+int ompi_request_cq_init(void)
+{
+    OBJ_CONSTRUCT(&ompi_request_cq_lock, opal_mutex_t);
+    for (int i = 0; i < OMPI_REQUEST_CQ_CACHE_SIZE; i++) {
+        ompi_request_cq_cache[i] = NULL;
+    }
+    ompi_request_cq_victim = 0;
+
+    return OMPI_SUCCESS;
+}
+
+int ompi_request_cq_finalize(void)
+{
+    for (int i = 0; i < OMPI_REQUEST_CQ_CACHE_SIZE; i++) {
+        if (NULL != ompi_request_cq_cache[i]) {
+            ompi_request_cq_destroy(ompi_request_cq_cache[i]);
+            ompi_request_cq_cache[i] = NULL;
+        }
+    }
+    OBJ_DESTRUCT(&ompi_request_cq_lock);
+
+    return OMPI_SUCCESS;
+}
@@ -24,6 +24,7 @@
 #include "ompi/constants.h"
 #include "ompi/request/request.h"
 #include "ompi/request/request_default.h"
+#include "ompi/request/request_cq.h"
 #include "ompi/request/grequest.h"
 
 #include "ompi/mca/crcp/crcp.h"
@@ -305,6 +306,13 @@ int ompi_request_default_test_some(
     int rc = OMPI_SUCCESS;
     ompi_request_t **rptr;
     ompi_request_t *request;
+    ompi_request_cq_t *cq;
+
+    if (NULL != (cq = ompi_request_cq_acquire(requests, count))) {
+        rc = ompi_request_cq_wait_some(cq, false, outcount, indices, statuses);
+        ompi_request_cq_release(cq);
+        return rc;
+    }
 
     opal_atomic_mb();
     rptr = requests;
@@ -29,6 +29,7 @@
 #include "ompi/constants.h"
 #include "ompi/request/request.h"
 #include "ompi/request/request_default.h"
+#include "ompi/request/request_cq.h"
 #include "ompi/request/grequest.h"
 
 #include "ompi/mca/crcp/crcp.h"
@@ -89,6 +90,7 @@ int ompi_request_default_wait_any(size_t count,
     size_t i, completed = count, num_requests_null_inactive = 0;
     int rc = OMPI_SUCCESS;
     ompi_request_t *request=NULL;
+    ompi_request_cq_t *cq;
     ompi_wait_sync_t sync;
 
     if (OPAL_UNLIKELY(0 == count)) {
@@ -96,6 +98,12 @@ int ompi_request_default_wait_any(size_t count,
         return OMPI_SUCCESS;
     }
 
+    if (NULL != (cq = ompi_request_cq_acquire(requests, count))) {
+        rc = ompi_request_cq_wait_any(cq, index, status);
+        ompi_request_cq_release(cq);
+        return rc;
+    }
+
     WAIT_SYNC_INIT(&sync, 1);
 
     num_requests_null_inactive = 0;
@@ -112,6 +120,7 @@ int ompi_request_default_wait_any(size_t count,
             continue;
         }
 
+        ompi_request_cq_disarm(request);
         if( !OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&request->req_complete, &_tmp_ptr, &sync) ) {
             assert(REQUEST_COMPLETE(request));
             completed = i;
@@ -224,6 +233,7 @@ int ompi_request_default_wait_all( size_t count,
             continue;
         }
 
+        ompi_request_cq_disarm(request);
         if (!OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&request->req_complete, &_tmp_ptr, &sync)) {
             if( OPAL_UNLIKELY( MPI_SUCCESS != request->req_status.MPI_ERROR ) ) {
                 failed++;
@@ -392,6 +402,7 @@ int ompi_request_default_wait_some(size_t count,
     int rc = MPI_SUCCESS;
     ompi_request_t **rptr = NULL;
     ompi_request_t *request = NULL;
+    ompi_request_cq_t *cq;
     ompi_wait_sync_t sync;
     size_t sync_sets = 0, sync_unsets = 0;
 
@@ -400,6 +411,12 @@ int ompi_request_default_wait_some(size_t count,
         return OMPI_SUCCESS;
     }
 
+    if (NULL != (cq = ompi_request_cq_acquire(requests, count))) {
+        rc = ompi_request_cq_wait_some(cq, true, outcount, indices, statuses);
+        ompi_request_cq_release(cq);
+        return rc;
+    }
+
     WAIT_SYNC_INIT(&sync, 1);
 
     *outcount = 0;
@@ -420,6 +437,7 @@ int ompi_request_default_wait_some(size_t count,
             num_requests_null_inactive++;
             continue;
         }
+        ompi_request_cq_disarm(request);
         indices[num_active_reqs] = OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&request->req_complete, &_tmp_ptr, &sync);
         if( !indices[num_active_reqs] ) {
             /* If the request is completed go ahead and mark it as such */
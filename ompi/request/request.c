@@ -31,6 +31,7 @@
 #include "opal/class/opal_object.h"
 #include "ompi/request/request.h"
 #include "ompi/request/request_default.h"
+#include "ompi/request/request_cq.h"
 #include "ompi/constants.h"
 
 opal_pointer_array_t             ompi_request_f_to_c_table = {{0}};
@@ -173,12 +174,13 @@ int ompi_request_init(void)
     ompi_status_empty._ucount = 0;
     ompi_status_empty._cancelled = 0;
 
-    return OMPI_SUCCESS;
+    return ompi_request_cq_init();
 }
 
 
 int ompi_request_finalize(void)
 {
+    ompi_request_cq_finalize();
     OMPI_REQUEST_FINI( &ompi_request_null.request );
     OBJ_DESTRUCT( &ompi_request_null.request );
     OMPI_REQUEST_FINI( &ompi_request_empty );
@@ -176,6 +176,15 @@ typedef struct ompi_predefined_request_t ompi_predefined_request_t;
 
 
 #define REQUEST_COMPLETE(req)        (REQUEST_COMPLETED == (req)->req_complete)
+
+/**
+ * Requests armed on a completion queue (see req_cq.c) hold a pointer
+ * to their queue slot tagged with OMPI_REQUEST_CQ_TAG in req_complete
+ * instead of a wait_sync. Completing such a request pushes the slot on
+ * the queue rather than signalling a sync.
+ */
+#define OMPI_REQUEST_CQ_TAG          ((intptr_t) 2)
+#define OMPI_REQUEST_CQ_ARMED(ptr)   (((intptr_t) (ptr)) & OMPI_REQUEST_CQ_TAG)
 /**
  * Finalize a request.  This is a macro to avoid function call
  * overhead, since this is typically invoked in the critical
@@ -370,6 +379,26 @@ static inline int ompi_request_cancel(ompi_request_t* request)
     return OMPI_SUCCESS;
 }
 
+/**
+ * Push a completion queue slot whose request completed.
+ */
+OMPI_DECLSPEC void ompi_request_cq_signal(ompi_request_t *request, void *slot);
+
+/**
+ * Detach a request from the completion queue it is armed on, leaving it
+ * REQUEST_PENDING, so that it can be waited on by other means.
+ */
+OMPI_DECLSPEC void ompi_request_cq_steal(ompi_request_t *request, void *slot);
+
+static inline void ompi_request_cq_disarm(ompi_request_t *request)
+{
+    void *slot = (void *) request->req_complete;
+
+    if (OPAL_UNLIKELY(OMPI_REQUEST_CQ_ARMED(slot))) {
+        ompi_request_cq_steal(request, slot);
+    }
+}
+
 /**
  * Free a request.
  *
@@ -377,6 +406,8 @@ static inline int ompi_request_cancel(ompi_request_t* request)
  */
 static inline int ompi_request_free(ompi_request_t** request)
 {
+    /* hand the slot back to its completion queue, the handle is going away */
+    ompi_request_cq_disarm(*request);
     return (*request)->req_free(request);
 }
 
@@ -401,6 +432,7 @@ static inline void ompi_request_wait_completion(ompi_request_t *req)
 
         WAIT_SYNC_INIT(&sync, 1);
 
+        ompi_request_cq_disarm(req);
         if (OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&req->req_complete, &_tmp_ptr, &sync)) {
             SYNC_WAIT(&sync);
         } else {
@@ -447,7 +479,9 @@ static inline int ompi_request_complete(ompi_request_t* request, bool with_signa
                 ompi_wait_sync_t *tmp_sync = (ompi_wait_sync_t *) OPAL_ATOMIC_SWAP_PTR(&request->req_complete,
                                                                                        REQUEST_COMPLETED);
                 /* In the case where another thread concurrently changed the request to REQUEST_PENDING */
-                if( REQUEST_PENDING != tmp_sync )
+                if( OMPI_REQUEST_CQ_ARMED(tmp_sync) )
+                    ompi_request_cq_signal(request, tmp_sync);
+                else if( REQUEST_PENDING != tmp_sync )
                     wait_sync_update(tmp_sync, 1, request->req_status.MPI_ERROR);
             }
         } else
@@ -0,0 +1,64 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/**
+ * @file
+ *
+ * Request completion queues.
+ *
+ * MPI_Waitany, MPI_Waitsome and MPI_Testsome on large arrays arm every
+ * request of the array on a completion queue and keep it armed across
+ * calls. Completing requests push their slot on the queue, so a call
+ * only looks at the requests that completed since the previous one and
+ * at the array entries that were empty, instead of installing and
+ * removing a wait_sync on the whole array every time.
+ */
+
+#ifndef OMPI_REQUEST_CQ_H
+#define OMPI_REQUEST_CQ_H
+
+#include "ompi_config.h"
+#include "ompi/request/request.h"
+
+BEGIN_C_DECLS
+
+struct ompi_request_cq_t;
+typedef struct ompi_request_cq_t ompi_request_cq_t;
+
+/**
+ * Get exclusive use of the completion queue for a request array,
+ * creating it if needed. Returns NULL if the array is below
+ * mpi_request_cq_threshold or its queue is in use by another thread,
+ * in which case the caller falls back to scanning the array.
+ */
+ompi_request_cq_t *ompi_request_cq_acquire(ompi_request_t **requests, size_t count);
+
+/**
+ * Give back a completion queue obtained from ompi_request_cq_acquire.
+ * The requests stay armed for the next call on the same array.
+ */
+void ompi_request_cq_release(ompi_request_cq_t *cq);
+
+int ompi_request_cq_wait_any(ompi_request_cq_t *cq, int *index,
+                             ompi_status_public_t *status);
+
+/**
+ * Return every request that completed, blocking for at least one if
+ * blocking is true (MPI_Waitsome) and progressing once otherwise
+ * (MPI_Testsome).
+ */
+int ompi_request_cq_wait_some(ompi_request_cq_t *cq, bool blocking, int *outcount,
+                              int *indices, ompi_status_public_t *statuses);
+
+int ompi_request_cq_init(void);
+int ompi_request_cq_finalize(void);
+
+END_C_DECLS
+
+#endif /* OMPI_REQUEST_CQ_H */
@@ -77,6 +77,11 @@ bool ompi_mpi_dynamics_enabled = true;
 
 char *ompi_mpi_spc_attach_string = NULL;
 bool ompi_mpi_spc_dump_enabled = false;
+int ompi_mpi_spc_shards = 0;
+
+uint32_t ompi_mpi_request_cq_threshold = 128;
+uint32_t ompi_mpi_comm_split_threshold = 4096;
+uint32_t ompi_mpi_comm_cid_block_size = 0;
 
 static bool show_default_mca_params = false;
 static bool show_file_mca_params = false;
@@ -340,6 +345,49 @@ int ompi_mpi_register_params(void)
                                  MCA_BASE_VAR_SCOPE_READONLY,
                                  &ompi_mpi_spc_dump_enabled);
 
+    ompi_mpi_spc_shards = 0;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "spc_shards",
+                                 "Number of shards the software-based performance counters (SPCs) are spread over. Each thread "
+                                 "records its events in one shard, so that threads do not contend on the counters, and the shards "
+                                 "are summed up when a counter is read. 0 uses one shard per online processor.",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_4,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_spc_shards);
+
+    ompi_mpi_request_cq_threshold = 128;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "request_cq_threshold",
+                                 "Minimum number of requests for MPI_Waitany, MPI_Waitsome and MPI_Testsome "
+                                 "to keep the request array armed on a completion queue between calls, so that "
+                                 "their cost follows the number of completed requests rather than the array "
+                                 "size (0 disables)",
+                                 MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_request_cq_threshold);
+
+    ompi_mpi_comm_split_threshold = 4096;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "comm_split_threshold",
+                                 "Minimum size of an intra-communicator for MPI_Comm_split to gather the members "
+                                 "of each new communicator only on its own members, instead of allgathering and "
+                                 "sorting the colors and keys of all processes on every process (0 disables)",
+                                 MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_ALL_EQ,
+                                 &ompi_mpi_comm_split_threshold);
+
+    ompi_mpi_comm_cid_block_size = 0;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "comm_cid_block_size",
+                                 "Number of communicator IDs reserved at once on an intra-communicator the first "
+                                 "time it is used to create a new communicator. Later MPI_Comm_dup, MPI_Comm_split "
+                                 "and MPI_Comm_create calls on it take the next reserved ID without any communication "
+                                 "until the block is used up. MPI_Comm_idup always agrees on a single ID "
+                                 "(0 or 1 disables)",
+                                 MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_ALL_EQ,
+                                 &ompi_mpi_comm_cid_block_size);
+
     return OMPI_SUCCESS;
 }
 
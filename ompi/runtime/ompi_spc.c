@@ -15,7 +15,10 @@
  * $HEADER$
  */
 
+#include <unistd.h>
+
 #include "ompi_spc.h"
+#include "opal/runtime/opal.h"
 
 opal_timer_t sys_clock_freq_mhz = 0;
 
@@ -142,15 +145,44 @@ static ompi_spc_event_t ompi_spc_events_names[OMPI_SPC_NUM_COUNTERS] = {
     SET_COUNTER_ARRAY(OMPI_SPC_MAX_UNEXPECTED_IN_QUEUE, "The maximum number of messages that the unexpected message queue(s) within an MPI process "
                                                     "contained at once since the last reset of this counter. Note: This counter is reset each time it is read."),
     SET_COUNTER_ARRAY(OMPI_SPC_MAX_OOS_IN_QUEUE, "The maximum number of messages that the out of sequence message queue(s) within an MPI process "
-                                             "contained at once since the last reset of this counter. Note: This counter is reset each time it is read.")
+                                             "contained at once since the last reset of this counter. Note: This counter is reset each time it is read."),
+    SET_COUNTER_ARRAY(OMPI_SPC_SENT_SIZE_HISTOGRAM, "Histogram of the sizes of the point-to-point messages sent. Bin 0 counts empty messages and "
+                                                "bin i messages of 2^(i-1) to 2^i - 1 bytes, the last bin also counts all larger messages."),
+    SET_COUNTER_ARRAY(OMPI_SPC_RECEIVED_SIZE_HISTOGRAM, "Histogram of the sizes of the point-to-point messages received. Bin 0 counts empty messages "
+                                                    "and bin i messages of 2^(i-1) to 2^i - 1 bytes, the last bin also counts all larger messages."),
+    SET_COUNTER_ARRAY(OMPI_SPC_COMM_MESSAGES_SENT, "The number of point-to-point messages sent on a communicator."),
+    SET_COUNTER_ARRAY(OMPI_SPC_COMM_BYTES_SENT, "The number of bytes sent in point-to-point messages on a communicator."),
+    SET_COUNTER_ARRAY(OMPI_SPC_COMM_MESSAGES_RECEIVED, "The number of point-to-point messages received on a communicator."),
+    SET_COUNTER_ARRAY(OMPI_SPC_COMM_BYTES_RECEIVED, "The number of bytes received in point-to-point messages on a communicator.")
 };
 
 /* An array of integer values to denote whether an event is activated (1) or not (0) */
 static uint32_t ompi_spc_attached_event[OMPI_SPC_NUM_COUNTERS / sizeof(uint32_t)] = { 0 };
 /* An array of integer values to denote whether an event is timer-based (1) or not (0) */
 static uint32_t ompi_spc_timer_event[OMPI_SPC_NUM_COUNTERS / sizeof(uint32_t)] = { 0 };
-/* An array of event structures to store the event data (name and value) */
-static ompi_spc_t *ompi_spc_events = NULL;
+/* An array of integer values to denote whether an event is kept in the first shard only (1) or not (0) */
+static uint32_t ompi_spc_shared_event[OMPI_SPC_NUM_COUNTERS / sizeof(uint32_t)] = { 0 };
+
+/* Upper bound on the number of shards when sizing them after the number of processors */
+#define OMPI_SPC_MAX_SHARDS 64
+
+/* The counter shards.  Each shard holds one value per counter followed by the
+ * bins of the two message size histograms, and is padded to whole cache lines.
+ * Threads pick a shard round-robin the first time they record an event.
+ */
+static ompi_spc_value_t *ompi_spc_shards = NULL;
+static int ompi_spc_num_shards = 0;
+static size_t ompi_spc_shard_size = 0;
+/* Size of one shard of a communicator's counters, in counter values */
+static size_t ompi_spc_comm_shard_size = 0;
+static opal_atomic_int32_t ompi_spc_next_shard = 0;
+#if OPAL_HAVE_THREAD_LOCAL
+static opal_thread_local int ompi_spc_local_shard = -1;
+#endif
+
+/* Offset of the first bin of a message size histogram in a shard */
+#define OMPI_SPC_HISTOGRAM(event_id) \
+    (OMPI_SPC_NUM_COUNTERS + ((event_id) - OMPI_SPC_SENT_SIZE_HISTOGRAM) * OMPI_SPC_NUM_SIZE_BINS)
 
 static inline void SET_SPC_BIT(uint32_t* array, int32_t pos)
 {
@@ -170,6 +202,79 @@ static inline void CLEAR_SPC_BIT(uint32_t* array, int32_t pos)
     array[pos / (8 * sizeof(uint32_t))] &= ~(1U << (pos % (8 * sizeof(uint32_t))));
 }
 
+static inline bool IS_SPC_HISTOGRAM(int32_t pos)
+{
+    return OMPI_SPC_SENT_SIZE_HISTOGRAM == pos || OMPI_SPC_RECEIVED_SIZE_HISTOGRAM == pos;
+}
+
+static inline bool IS_SPC_COMM_COUNTER(int32_t pos)
+{
+    return pos >= OMPI_SPC_FIRST_COMM_COUNTER;
+}
+
+/* Returns the shard of the calling thread.  Without thread local storage
+ * every thread shares the first shard.
+ */
+static inline int ompi_spc_shard(void)
+{
+#if OPAL_HAVE_THREAD_LOCAL
+    if( OPAL_UNLIKELY(ompi_spc_local_shard < 0) ) {
+        ompi_spc_local_shard = (OPAL_THREAD_ADD_FETCH32(&ompi_spc_next_shard, 1) - 1) % ompi_spc_num_shards;
+    }
+    return ompi_spc_local_shard;
+#else
+    return 0;
+#endif
+}
+
+/* Returns the histogram bin of a message of 'bytes' bytes */
+static inline int ompi_spc_size_bin(size_t bytes)
+{
+    int bin = 0;
+
+    while( 0 != bytes && bin < OMPI_SPC_NUM_SIZE_BINS - 1 ) {
+        bytes >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+/* Sums up the shards of the value at 'offset' of a block of 'size' values per shard */
+static inline size_t ompi_spc_sum(ompi_spc_value_t *values, size_t size, size_t offset)
+{
+    size_t sum = 0;
+    int i;
+
+    for(i = 0; i < ompi_spc_num_shards; i++) {
+        sum += values[i * size + offset];
+    }
+    return sum;
+}
+
+/* Returns the counters of a communicator, allocating them the first time
+ * they are needed.  Threads racing on the allocation keep the first block.
+ */
+static ompi_spc_value_t *ompi_spc_comm_values(ompi_communicator_t *comm)
+{
+    ompi_spc_value_t *values = comm->c_spc, *expected = NULL;
+    size_t size = ompi_spc_num_shards * ompi_spc_comm_shard_size * sizeof(ompi_spc_value_t);
+
+    if( OPAL_LIKELY(NULL != values) ) {
+        return values;
+    }
+
+    if( 0 != posix_memalign((void **) &values, opal_cache_line_size, size) ) {
+        return NULL;
+    }
+    memset((void *) values, 0, size);
+
+    if( !OPAL_ATOMIC_COMPARE_EXCHANGE_STRONG_PTR(&comm->c_spc, &expected, values) ) {
+        free((void *) values);
+        values = expected;
+    }
+    return values;
+}
+
 /* ##############################################################
  * ################# Begin MPI_T Functions ######################
  * ##############################################################
@@ -188,11 +293,11 @@ static int ompi_spc_notify(mca_base_pvar_t *pvar, mca_base_pvar_event_t event, v
     index = (int)(uintptr_t)pvar->ctx;  /* Convert from MPI_T pvar index to SPC index */
 
     /* For this event, we need to set count to the number of long long type
-     * values for this counter.  All SPC counters are one long long, so we
-     * always set count to 1.
+     * values for this counter.  All SPC counters are one long long, except
+     * for the histograms that have one per bin.
      */
     if(MCA_BASE_PVAR_HANDLE_BIND == event) {
-        *count = 1;
+        *count = IS_SPC_HISTOGRAM(index) ? OMPI_SPC_NUM_SIZE_BINS : 1;
     }
     /* For this event, we need to turn on the counter */
     else if(MCA_BASE_PVAR_HANDLE_START == event) {
@@ -214,7 +319,7 @@ static int ompi_spc_notify(mca_base_pvar_t *pvar, mca_base_pvar_event_t event, v
 /* This function returns the current count of an SPC counter that has been retistered
  * as an MPI_T pvar.  The MPI_T index is not necessarily the same as the SPC index,
  * so we need to convert from MPI_T index to SPC index and then set the 'value' argument
- * to the correct value for this pvar.
+ * to the correct value for this pvar.  The values of all shards are summed up.
  */
 static int ompi_spc_get_count(const struct mca_base_pvar_t *pvar, void *value, void *obj_handle)
     __opal_attribute_unused__;
@@ -222,6 +327,8 @@ static int ompi_spc_get_count(const struct mca_base_pvar_t *pvar, void *value, v
 static int ompi_spc_get_count(const struct mca_base_pvar_t *pvar, void *value, void *obj_handle)
 {
     long long *counter_value = (long long*)value;
+    ompi_communicator_t *comm = (ompi_communicator_t *) obj_handle;
+    int i;
 
     if(OPAL_LIKELY(!mpi_t_enabled)) {
         *counter_value = 0;
@@ -230,15 +337,33 @@ static int ompi_spc_get_count(const struct mca_base_pvar_t *pvar, void *value, v
 
     /* Convert from MPI_T pvar index to SPC index */
     int index = (int)(uintptr_t)pvar->ctx;
+
+    if( IS_SPC_HISTOGRAM(index) ) {
+        for(i = 0; i < OMPI_SPC_NUM_SIZE_BINS; i++) {
+            counter_value[i] = (long long)ompi_spc_sum(ompi_spc_shards, ompi_spc_shard_size,
+                                                       OMPI_SPC_HISTOGRAM(index) + i);
+        }
+        return MPI_SUCCESS;
+    }
+
+    if( IS_SPC_COMM_COUNTER(index) ) {
+        *counter_value = 0;
+        if( NULL != comm && NULL != comm->c_spc ) {
+            *counter_value = (long long)ompi_spc_sum(comm->c_spc, ompi_spc_comm_shard_size,
+                                                     index - OMPI_SPC_FIRST_COMM_COUNTER);
+        }
+        return MPI_SUCCESS;
+    }
+
     /* Set the counter value to the current SPC value */
-    *counter_value = (long long)ompi_spc_events[index].value;
+    *counter_value = (long long)ompi_spc_sum(ompi_spc_shards, ompi_spc_shard_size, index);
     /* If this is a timer-based counter, convert from cycles to microseconds */
     if( IS_SPC_BIT_SET(ompi_spc_timer_event, index) ) {
         *counter_value /= sys_clock_freq_mhz;
     }
     /* If this is a high watermark counter, reset it after it has been read */
     if(index == OMPI_SPC_MAX_UNEXPECTED_IN_QUEUE || index == OMPI_SPC_MAX_OOS_IN_QUEUE) {
-        ompi_spc_events[index].value = 0;
+        ompi_spc_shards[index] = 0;
     }
 
     return MPI_SUCCESS;
@@ -247,24 +372,38 @@ static int ompi_spc_get_count(const struct mca_base_pvar_t *pvar, void *value, v
 /* Initializes the events data structure and allocates memory for it if needed. */
 void ompi_spc_events_init(void)
 {
-    int i;
+    size_t line = opal_cache_line_size / sizeof(ompi_spc_value_t);
+    long nprocs;
+
+    /* If the shards haven't been allocated yet, size them and allocate memory for them */
+    if(NULL == ompi_spc_shards) {
+        if(0 == line) {
+            line = 1;
+        }
+        ompi_spc_shard_size = (OMPI_SPC_NUM_COUNTERS + 2 * OMPI_SPC_NUM_SIZE_BINS + line - 1) / line * line;
+        ompi_spc_comm_shard_size = (OMPI_SPC_NUM_COMM_COUNTERS + line - 1) / line * line;
 
-    /* If the events data structure hasn't been allocated yet, allocate memory for it */
-    if(NULL == ompi_spc_events) {
-        ompi_spc_events = (ompi_spc_t*)malloc(OMPI_SPC_NUM_COUNTERS * sizeof(ompi_spc_t));
-        if(ompi_spc_events == NULL) {
+        ompi_spc_num_shards = ompi_mpi_spc_shards;
+        if(ompi_spc_num_shards <= 0) {
+            nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+            ompi_spc_num_shards = (nprocs < 1) ? 1 : (nprocs > OMPI_SPC_MAX_SHARDS ? OMPI_SPC_MAX_SHARDS : (int)nprocs);
+        }
+#if !OPAL_HAVE_THREAD_LOCAL
+        ompi_spc_num_shards = 1;
+#endif
+
+        if(0 != posix_memalign((void **)&ompi_spc_shards, opal_cache_line_size,
+                               ompi_spc_num_shards * ompi_spc_shard_size * sizeof(ompi_spc_value_t))) {
+            ompi_spc_shards = NULL;
             opal_show_help("help-mpi-runtime.txt", "lib-call-fail", true,
-                           "malloc", __FILE__, __LINE__);
+                           "posix_memalign", __FILE__, __LINE__);
             return;
         }
     }
-    /* The data structure has been allocated, so we simply initialize all of the counters
-     * with their names and an initial count of 0.
+    /* The shards have been allocated, so we simply initialize all of the counters
+     * with an initial count of 0.
      */
-    for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
-        ompi_spc_events[i].name = (char*)ompi_spc_events_names[i].counter_name;
-        ompi_spc_events[i].value = 0;
-    }
+    memset((void *)ompi_spc_shards, 0, ompi_spc_num_shards * ompi_spc_shard_size * sizeof(ompi_spc_value_t));
 
     ompi_comm_dup(&ompi_mpi_comm_world.comm, &ompi_spc_comm);
 }
@@ -280,6 +419,9 @@ void ompi_spc_init(void)
     sys_clock_freq_mhz = opal_timer_base_get_freq() / 1000000;
 
     ompi_spc_events_init();
+    if(NULL == ompi_spc_shards) {
+        return;
+    }
 
     /* Get the MCA params string of counters to turn on */
     char **arg_strings = opal_argv_split(ompi_mpi_spc_attach_string, ',');
@@ -318,7 +460,8 @@ void ompi_spc_init(void)
         /* Registers the current counter as an MPI_T pvar regardless of whether it's been turned on or not */
         ret = mca_base_pvar_register("ompi", "runtime", "spc", ompi_spc_events_names[i].counter_name, ompi_spc_events_names[i].counter_description,
                                      OPAL_INFO_LVL_4, MPI_T_PVAR_CLASS_SIZE,
-                                     MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG, NULL, MPI_T_BIND_NO_OBJECT,
+                                     MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG, NULL,
+                                     IS_SPC_COMM_COUNTER(i) ? MPI_T_BIND_MPI_COMM : MPI_T_BIND_NO_OBJECT,
                                      MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
                                      ompi_spc_get_count, NULL, ompi_spc_notify, (void*)(uintptr_t)i);
         if( ret < 0 ) {
@@ -331,11 +474,18 @@ void ompi_spc_init(void)
     /* If this is a timer event, set the corresponding timer_event entry */
     SET_SPC_BIT(ompi_spc_timer_event, OMPI_SPC_MATCH_TIME);
 
+    /* Queue depths are compared with their high watermarks, keep both in the first shard */
+    SET_SPC_BIT(ompi_spc_shared_event, OMPI_SPC_UNEXPECTED_IN_QUEUE);
+    SET_SPC_BIT(ompi_spc_shared_event, OMPI_SPC_OOS_IN_QUEUE);
+    SET_SPC_BIT(ompi_spc_shared_event, OMPI_SPC_MAX_UNEXPECTED_IN_QUEUE);
+    SET_SPC_BIT(ompi_spc_shared_event, OMPI_SPC_MAX_OOS_IN_QUEUE);
+
     opal_argv_free(arg_strings);
 }
 
 /* Gathers all of the SPC data onto rank 0 of MPI_COMM_WORLD and prints out all
- * of the counter values to stdout.
+ * of the counter values to stdout.  The histograms and the communicator bound
+ * counters are not part of the dump.
  */
 static void ompi_spc_dump(void)
 {
@@ -345,13 +495,6 @@ static void ompi_spc_dump(void)
     int rank = ompi_comm_rank(ompi_spc_comm);
     world_size = ompi_comm_size(ompi_spc_comm);
 
-    /* Convert from cycles to usecs before sending */
-    for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
-        if( IS_SPC_BIT_SET(ompi_spc_timer_event, i) ) {
-            SPC_CYCLES_TO_USECS(&ompi_spc_events[i].value);
-        }
-    }
-
     /* Aggregate all of the information on rank 0 using MPI_Gather on MPI_COMM_WORLD */
     send_buffer = (long long*)malloc(OMPI_SPC_NUM_COUNTERS * sizeof(long long));
     if (NULL == send_buffer) {
@@ -360,7 +503,15 @@ static void ompi_spc_dump(void)
         return;
     }
     for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
-        send_buffer[i] = (long long)ompi_spc_events[i].value;
+        send_buffer[i] = 0;
+        if( IS_SPC_HISTOGRAM(i) || IS_SPC_COMM_COUNTER(i) ) {
+            continue;
+        }
+        send_buffer[i] = (long long)ompi_spc_sum(ompi_spc_shards, ompi_spc_shard_size, i);
+        /* Convert from cycles to usecs before sending */
+        if( IS_SPC_BIT_SET(ompi_spc_timer_event, i) ) {
+            send_buffer[i] /= sys_clock_freq_mhz;
+        }
     }
     if( 0 == rank ) {
         recv_buffer = (long long*)malloc(world_size * OMPI_SPC_NUM_COUNTERS * sizeof(long long));
@@ -382,11 +533,10 @@ static void ompi_spc_dump(void)
         for(j = 0; j < world_size; j++) {
             opal_output(0, "MPI_COMM_WORLD Rank %d:\n", j);
             for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
-                /* If this is a timer-based counter, we need to covert from cycles to usecs */
                 if( 0 == recv_buffer[offset+i] ) {
                     continue;
                 }
-                opal_output(0, "%s -> %lld\n", ompi_spc_events[i].name, recv_buffer[offset+i]);
+                opal_output(0, "%s -> %lld\n", ompi_spc_events_names[i].counter_name, recv_buffer[offset+i]);
             }
             opal_output(0, "\n");
             offset += OMPI_SPC_NUM_COUNTERS;
@@ -405,20 +555,30 @@ static void ompi_spc_dump(void)
 /* Frees any dynamically alocated OMPI SPC data structures */
 void ompi_spc_fini(void)
 {
+    int i;
+
     if (SPC_ENABLE == 1 && ompi_mpi_spc_dump_enabled) {
         ompi_spc_dump();
     }
 
-    free(ompi_spc_events); ompi_spc_events = NULL;
+    /* Nothing may be recorded into the shards once they are gone */
+    mpi_t_enabled = false;
+    for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
+        CLEAR_SPC_BIT(ompi_spc_attached_event, i);
+    }
+    free((void *)ompi_spc_shards); ompi_spc_shards = NULL;
     ompi_comm_free(&ompi_spc_comm);
 }
 
-/* Records an update to a counter using an atomic add operation. */
+/* Records an update to a counter in the shard of the calling thread.  The atomic
+ * add is only contended when there are more threads than shards.
+ */
 void ompi_spc_record(unsigned int event_id, ompi_spc_value_t value)
 {
     /* Denoted unlikely because counters will often be turned off. */
     if( OPAL_UNLIKELY(IS_SPC_BIT_SET(ompi_spc_attached_event, event_id)) ) {
-        OPAL_THREAD_ADD_FETCH_SIZE_T(&(ompi_spc_events[event_id].value), value);
+        int shard = IS_SPC_BIT_SET(ompi_spc_shared_event, event_id) ? 0 : ompi_spc_shard();
+        OPAL_THREAD_ADD_FETCH_SIZE_T(&ompi_spc_shards[shard * ompi_spc_shard_size + event_id], value);
     }
 }
 
@@ -445,7 +605,8 @@ void ompi_spc_timer_stop(unsigned int event_id, opal_timer_t *cycles)
     /* This is denoted unlikely because the counters will often be turned off. */
     if( OPAL_UNLIKELY(IS_SPC_BIT_SET(ompi_spc_attached_event, event_id)) ) {
         *cycles = opal_timer_base_get_cycles() - *cycles;
-        OPAL_THREAD_ADD_FETCH_SIZE_T(&ompi_spc_events[event_id].value, (size_t) *cycles);
+        OPAL_THREAD_ADD_FETCH_SIZE_T(&ompi_spc_shards[ompi_spc_shard() * ompi_spc_shard_size + event_id],
+                                     (size_t) *cycles);
     }
 }
 
@@ -459,7 +620,7 @@ void ompi_spc_user_or_mpi(int tag, ompi_spc_value_t value, unsigned int user_enu
 
 /* Checks whether the counter denoted by value_enum exceeds the current value of the
  * counter denoted by watermark_enum, and if so sets the watermark_enum counter to the
- * value of the value_enum counter.
+ * value of the value_enum counter.  Both counters live in the first shard.
  */
 void ompi_spc_update_watermark(unsigned int watermark_enum, unsigned int value_enum)
 {
@@ -469,12 +630,52 @@ void ompi_spc_update_watermark(unsigned int watermark_enum, unsigned int value_e
         /* WARNING: This assumes that this function was called while a lock has already been taken.
          *          This function is NOT thread safe otherwise!
          */
-        if(ompi_spc_events[value_enum].value > ompi_spc_events[watermark_enum].value) {
-            ompi_spc_events[watermark_enum].value = ompi_spc_events[value_enum].value;
+        if(ompi_spc_shards[value_enum] > ompi_spc_shards[watermark_enum]) {
+            ompi_spc_shards[watermark_enum] = ompi_spc_shards[value_enum];
         }
     }
 }
 
+/* Records a point-to-point message of 'bytes' bytes sent or received on 'comm'
+ * in the message size histogram and in the communicator's counters.
+ */
+void ompi_spc_record_message(ompi_communicator_t *comm, size_t bytes, bool sent)
+{
+    unsigned int histogram = sent ? OMPI_SPC_SENT_SIZE_HISTOGRAM : OMPI_SPC_RECEIVED_SIZE_HISTOGRAM;
+    unsigned int messages = sent ? OMPI_SPC_COMM_MESSAGES_SENT : OMPI_SPC_COMM_MESSAGES_RECEIVED;
+    ompi_spc_value_t *values;
+    int shard;
+
+    /* Denoted unlikely because counters will often be turned off. */
+    if( OPAL_UNLIKELY(IS_SPC_BIT_SET(ompi_spc_attached_event, histogram)) ) {
+        shard = ompi_spc_shard();
+        OPAL_THREAD_ADD_FETCH_SIZE_T(&ompi_spc_shards[shard * ompi_spc_shard_size + OMPI_SPC_HISTOGRAM(histogram) +
+                                                      ompi_spc_size_bin(bytes)], 1);
+    }
+
+    /* The bytes counter follows the messages counter */
+    if( OPAL_UNLIKELY(IS_SPC_BIT_SET(ompi_spc_attached_event, messages) ||
+                      IS_SPC_BIT_SET(ompi_spc_attached_event, messages + 1)) ) {
+        if( NULL == (values = ompi_spc_comm_values(comm)) ) {
+            return;
+        }
+        values += ompi_spc_shard() * ompi_spc_comm_shard_size + (messages - OMPI_SPC_FIRST_COMM_COUNTER);
+        if( IS_SPC_BIT_SET(ompi_spc_attached_event, messages) ) {
+            OPAL_THREAD_ADD_FETCH_SIZE_T(values, 1);
+        }
+        if( IS_SPC_BIT_SET(ompi_spc_attached_event, messages + 1) ) {
+            OPAL_THREAD_ADD_FETCH_SIZE_T(values + 1, bytes);
+        }
+    }
+}
+
+/* Frees the counters of a communicator that is being destroyed */
+void ompi_spc_comm_release(ompi_communicator_t *comm)
+{
+    free((void *)comm->c_spc);
+    comm->c_spc = NULL;
+}
+
 /* Converts a counter value that is in cycles to microseconds.
  */
 void ompi_spc_cycles_to_usecs(ompi_spc_value_t *cycles)
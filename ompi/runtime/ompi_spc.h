@@ -48,6 +48,11 @@
  *     SPC_TIMER_START and SPC_TIMER_STOP macros to record
  *     the time in cycles to then be converted to microseconds later
  *     in the ompi_spc_get_count function when requested by MPI_T
+ *
+ * Counters are kept in per-thread shards that are only summed up when
+ * read, so that recording an event never touches a cache line shared
+ * with another thread.  Queue depths and their high watermarks are
+ * compared with each other and are not sharded.
  */
 
 /* This enumeration serves as event ids for the various events */
@@ -160,6 +165,12 @@ typedef enum ompi_spc_counters {
     OMPI_SPC_OOS_IN_QUEUE,
     OMPI_SPC_MAX_UNEXPECTED_IN_QUEUE,
     OMPI_SPC_MAX_OOS_IN_QUEUE,
+    OMPI_SPC_SENT_SIZE_HISTOGRAM,
+    OMPI_SPC_RECEIVED_SIZE_HISTOGRAM,
+    OMPI_SPC_COMM_MESSAGES_SENT,
+    OMPI_SPC_COMM_BYTES_SENT,
+    OMPI_SPC_COMM_MESSAGES_RECEIVED,
+    OMPI_SPC_COMM_BYTES_RECEIVED,
     OMPI_SPC_NUM_COUNTERS /* This serves as the number of counters.  It must be last. */
 } ompi_spc_counters_t;
 
@@ -168,11 +179,18 @@ typedef enum ompi_spc_counters {
  */
 typedef opal_atomic_size_t ompi_spc_value_t;
 
-/* A structure for storing the event data */
-typedef struct ompi_spc_s{
-    char *name;
-    ompi_spc_value_t value;
-} ompi_spc_t;
+/* The message size histograms have one bin for empty messages, then bin
+ * i counts messages of 2^(i-1) to 2^i - 1 bytes.  The last bin also
+ * counts all larger messages.
+ */
+#define OMPI_SPC_NUM_SIZE_BINS 32
+
+/* The OMPI_SPC_COMM_* counters are bound to a communicator and are kept
+ * in a sharded block hanging off the communicator, allocated the first
+ * time a message is recorded on it.
+ */
+#define OMPI_SPC_FIRST_COMM_COUNTER OMPI_SPC_COMM_MESSAGES_SENT
+#define OMPI_SPC_NUM_COMM_COUNTERS  (OMPI_SPC_NUM_COUNTERS - OMPI_SPC_FIRST_COMM_COUNTER)
 
 /* Events data structure initialization function */
 void ompi_spc_events_init(void);
@@ -186,6 +204,8 @@ void ompi_spc_timer_stop(unsigned int event_id, opal_timer_t *cycles);
 void ompi_spc_user_or_mpi(int tag, ompi_spc_value_t value, unsigned int user_enum, unsigned int mpi_enum);
 void ompi_spc_cycles_to_usecs(ompi_spc_value_t *cycles);
 void ompi_spc_update_watermark(unsigned int watermark_enum, unsigned int value_enum);
+void ompi_spc_record_message(ompi_communicator_t *comm, size_t bytes, bool sent);
+void ompi_spc_comm_release(ompi_communicator_t *comm);
 
 /* Macros for using the SPC utility functions throughout the codebase.
  * If SPC_ENABLE is not 1, the macros become no-ops.
@@ -216,6 +236,15 @@ void ompi_spc_update_watermark(unsigned int watermark_enum, unsigned int value_e
 #define SPC_UPDATE_WATERMARK(watermark_enum, value_enum) \
     ompi_spc_update_watermark(watermark_enum, value_enum)
 
+#define SPC_RECORD_SENT(comm, bytes) \
+    ompi_spc_record_message(comm, bytes, true)
+
+#define SPC_RECORD_RECEIVED(comm, bytes) \
+    ompi_spc_record_message(comm, bytes, false)
+
+#define SPC_COMM_RELEASE(comm) \
+    ompi_spc_comm_release(comm)
+
 #else /* SPCs are not enabled */
 
 #define SPC_INIT()  \
@@ -242,6 +271,15 @@ void ompi_spc_update_watermark(unsigned int watermark_enum, unsigned int value_e
 #define SPC_UPDATE_WATERMARK(watermark_enum, value_enum) \
     ((void)0)
 
+#define SPC_RECORD_SENT(comm, bytes) \
+    ((void)0)
+
+#define SPC_RECORD_RECEIVED(comm, bytes) \
+    ((void)0)
+
+#define SPC_COMM_RELEASE(comm) \
+    ((void)0)
+
 #endif
 
 #endif
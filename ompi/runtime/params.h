@@ -154,6 +154,36 @@ OMPI_DECLSPEC extern char * ompi_mpi_spc_attach_string;
  */
 OMPI_DECLSPEC extern bool ompi_mpi_spc_dump_enabled;
 
+/**
+ * Number of shards the SPC counters are spread over, threads record their
+ * events in one shard each, picked round-robin.  Zero uses one shard per
+ * online processor.
+ */
+OMPI_DECLSPEC extern int ompi_mpi_spc_shards;
+
+/**
+ * Minimum size of an intra-communicator for MPI_Comm_split to use the
+ * distributed algorithm, which only gathers the members of each new
+ * communicator on its own members, instead of allgathering and sorting
+ * the colors and keys of all processes everywhere. Zero disables it.
+ */
+OMPI_DECLSPEC extern uint32_t ompi_mpi_comm_split_threshold;
+
+/**
+ * Number of communicator IDs an intra-communicator reserves when it is
+ * first used to create a communicator. The following creations on it
+ * take IDs from the reserved block without communicating. Zero or one
+ * disables it.
+ */
+OMPI_DECLSPEC extern uint32_t ompi_mpi_comm_cid_block_size;
+
+/**
+ * Minimum number of requests in an array for MPI_Waitany, MPI_Waitsome
+ * and MPI_Testsome to track completions through a completion queue
+ * kept armed across calls. Zero disables completion queues.
+ */
+OMPI_DECLSPEC extern uint32_t ompi_mpi_request_cq_threshold;
+
 
 /**
  * Register MCA parameters used by the MPI layer.
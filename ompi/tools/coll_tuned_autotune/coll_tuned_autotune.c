@@ -0,0 +1,636 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Offline autotuner for the coll/tuned component.
+ *
+ * For every collective that coll/tuned can select an algorithm for,
+ * time each algorithm (and each requested segment size and fan in/out)
+ * on a range of communicator and message sizes, and write the winners
+ * as a dynamic rules file in the format read by
+ * ompi/mca/coll/tuned/coll_tuned_dynamic_file.c, to be used with
+ *
+ *   mpirun --mca coll_tuned_use_dynamic_rules 1 \
+ *          --mca coll_tuned_dynamic_rules_filename <file> ...
+ *
+ * The algorithm choices are forced through the coll_tuned_*_algorithm
+ * MCA variables, which are written through MPI_T and picked up by
+ * coll/tuned every time a new communicator is created.  This only
+ * works if the tool itself runs with coll_tuned_use_dynamic_rules set
+ * and if coll/tuned is the component that provides the collectives
+ * (e.g., --mca coll basic,tuned,libnbc,self).
+ */
+
+#include "ompi_config.h"
+
+#include <float.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mpi.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+
+/*
+ * Buffers shared by all the benchmarks.  sbuf and rbuf are large
+ * enough for the largest block of every process of MPI_COMM_WORLD.
+ */
+static char *sbuf, *rbuf;
+static int *counts, *displs;
+
+typedef struct {
+    /** Name of the collective, as used in the coll_tuned MCA variables */
+    const char *name;
+    /** Collective ID in the rules file (see coll_base_functions.h) */
+    COLLTYPE_T id;
+    /** Whether the collective is a reduction (and uses MPI_INT/MPI_SUM) */
+    int reduction;
+    /** Whether the rules only depend on the communicator size */
+    int size_agnostic;
+    /** Run the collective once with a block of count elements */
+    int (*run)(int count, MPI_Datatype dtype, MPI_Comm comm);
+} autotune_coll_t;
+
+typedef struct {
+    int algorithm;
+    int segsize;
+    int fanout;
+} autotune_config_t;
+
+static int run_allgather(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    return MPI_Allgather(sbuf, count, dtype, rbuf, count, dtype, comm);
+}
+
+static int run_allgatherv(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    int i, size;
+
+    MPI_Comm_size(comm, &size);
+    for (i = 0; i < size; ++i) {
+        counts[i] = count;
+        displs[i] = i * count;
+    }
+    return MPI_Allgatherv(sbuf, count, dtype, rbuf, counts, displs, dtype, comm);
+}
+
+static int run_allreduce(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    return MPI_Allreduce(sbuf, rbuf, count, dtype, MPI_SUM, comm);
+}
+
+static int run_alltoall(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    return MPI_Alltoall(sbuf, count, dtype, rbuf, count, dtype, comm);
+}
+
+static int run_alltoallv(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    int i, size;
+
+    MPI_Comm_size(comm, &size);
+    for (i = 0; i < size; ++i) {
+        counts[i] = count;
+        displs[i] = i * count;
+    }
+    return MPI_Alltoallv(sbuf, counts, displs, dtype, rbuf, counts, displs, dtype, comm);
+}
+
+static int run_barrier(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    return MPI_Barrier(comm);
+}
+
+static int run_bcast(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    return MPI_Bcast(sbuf, count, dtype, 0, comm);
+}
+
+static int run_exscan(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    return MPI_Exscan(sbuf, rbuf, count, dtype, MPI_SUM, comm);
+}
+
+static int run_gather(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    return MPI_Gather(sbuf, count, dtype, rbuf, count, dtype, 0, comm);
+}
+
+static int run_reduce(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    return MPI_Reduce(sbuf, rbuf, count, dtype, MPI_SUM, 0, comm);
+}
+
+static int run_reduce_scatter(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    int i, size;
+
+    MPI_Comm_size(comm, &size);
+    for (i = 0; i < size; ++i) {
+        counts[i] = count;
+    }
+    return MPI_Reduce_scatter(sbuf, rbuf, counts, dtype, MPI_SUM, comm);
+}
+
+static int run_reduce_scatter_block(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    return MPI_Reduce_scatter_block(sbuf, rbuf, count, dtype, MPI_SUM, comm);
+}
+
+static int run_scan(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    return MPI_Scan(sbuf, rbuf, count, dtype, MPI_SUM, comm);
+}
+
+static int run_scatter(int count, MPI_Datatype dtype, MPI_Comm comm)
+{
+    return MPI_Scatter(sbuf, count, dtype, rbuf, count, dtype, 0, comm);
+}
+
+static const autotune_coll_t autotune_colls[] = {
+    { "allgather",            ALLGATHER,          0, 0, run_allgather },
+    { "allgatherv",           ALLGATHERV,         0, 0, run_allgatherv },
+    { "allreduce",            ALLREDUCE,          1, 0, run_allreduce },
+    { "alltoall",             ALLTOALL,           0, 0, run_alltoall },
+    { "alltoallv",            ALLTOALLV,          0, 1, run_alltoallv },
+    { "barrier",              BARRIER,            0, 1, run_barrier },
+    { "bcast",                BCAST,              0, 0, run_bcast },
+    { "exscan",               EXSCAN,             1, 0, run_exscan },
+    { "gather",               GATHER,             0, 0, run_gather },
+    { "reduce",               REDUCE,             1, 0, run_reduce },
+    { "reduce_scatter",       REDUCESCATTER,      1, 0, run_reduce_scatter },
+    { "reduce_scatter_block", REDUCESCATTERBLOCK, 1, 0, run_reduce_scatter_block },
+    { "scan",                 SCAN,               1, 0, run_scan },
+    { "scatter",              SCATTER,            0, 0, run_scatter },
+};
+#define AUTOTUNE_NCOLLS ((int) (sizeof(autotune_colls) / sizeof(autotune_colls[0])))
+
+/* Relative difference under which two timings are considered equal */
+#define AUTOTUNE_NOISE 1.05
+
+/*
+ * Message size used by coll/tuned to look up the rules (see
+ * coll_tuned_decision_dynamic.c) for a block of block_bytes bytes per
+ * process on comm_size processes.
+ */
+static size_t rule_msg_size(const autotune_coll_t *coll, int comm_size, size_t block_bytes)
+{
+    switch (coll->id) {
+    case ALLREDUCE:
+    case BCAST:
+    case REDUCE:
+        return block_bytes;
+    case ALLTOALLV:
+    case BARRIER:
+        return 0;
+    default:
+        return block_bytes * (size_t) comm_size;
+    }
+}
+
+/*
+ * Write an integer control variable.  Returns -1 if it does not exist
+ * or if the value was rejected.
+ */
+static int cvar_write_int(const char *name, int value)
+{
+    MPI_T_cvar_handle handle;
+    int index, count, rc;
+
+    if (MPI_SUCCESS != MPI_T_cvar_get_index(name, &index)) {
+        return -1;
+    }
+    MPI_T_cvar_handle_alloc(index, NULL, &handle, &count);
+    rc = MPI_T_cvar_write(handle, &value);
+    MPI_T_cvar_handle_free(&handle);
+    return (MPI_SUCCESS == rc) ? 0 : -1;
+}
+
+/*
+ * Read a control variable into value, which must be of the matching
+ * type.  Returns -1 if it does not exist.
+ */
+static int cvar_read(const char *name, void *value)
+{
+    MPI_T_cvar_handle handle;
+    int index, count;
+
+    if (MPI_SUCCESS != MPI_T_cvar_get_index(name, &index)) {
+        return -1;
+    }
+    MPI_T_cvar_handle_alloc(index, NULL, &handle, &count);
+    MPI_T_cvar_read(handle, value);
+    MPI_T_cvar_handle_free(&handle);
+    return 0;
+}
+
+static int set_coll_var(const autotune_coll_t *coll, const char *suffix, int value)
+{
+    char name[128];
+
+    snprintf(name, sizeof(name), "coll_tuned_%s_algorithm%s", coll->name, suffix);
+    return cvar_write_int(name, value);
+}
+
+static int has_coll_var(const autotune_coll_t *coll, const char *suffix)
+{
+    char name[128];
+    int index;
+
+    snprintf(name, sizeof(name), "coll_tuned_%s_algorithm%s", coll->name, suffix);
+    return MPI_SUCCESS == MPI_T_cvar_get_index(name, &index);
+}
+
+static int compare_int(const void *a, const void *b)
+{
+    return *(const int *) a - *(const int *) b;
+}
+
+/*
+ * Parse a comma separated list of integers
+ */
+static int parse_list(const char *str, int **list)
+{
+    const char *p;
+    int n = 1, i;
+
+    for (p = str; *p; ++p) {
+        if (',' == *p) {
+            ++n;
+        }
+    }
+    *list = (int *) malloc(n * sizeof(int));
+    for (i = 0, p = str; i < n; ++i) {
+        (*list)[i] = (int) strtol(p, (char **) &p, 0);
+        if (',' == *p) {
+            ++p;
+        }
+    }
+    return n;
+}
+
+/*
+ * Time all the configurations of one collective on the first
+ * comm_size processes of MPI_COMM_WORLD.  times[c * nmsgs + m] gets
+ * the time of configuration c for message m, or DBL_MAX if the
+ * configuration failed.
+ */
+static void time_collective(const autotune_coll_t *coll, MPI_Comm comm,
+                            const autotune_config_t *configs, int nconfigs,
+                            const size_t *msgs, int nmsgs,
+                            int repetitions, int warmups, double *times)
+{
+    MPI_Datatype dtype = coll->reduction ? MPI_INT : MPI_BYTE;
+    int elem = coll->reduction ? (int) sizeof(int) : 1;
+    int c, m, r, rc, failed;
+    double start, elapsed;
+    MPI_Comm tcomm;
+
+    for (c = 0; c < nconfigs; ++c) {
+        if (0 != set_coll_var(coll, "", configs[c].algorithm)) {
+            /* Not a valid choice for this build */
+            for (m = 0; m < nmsgs; ++m) {
+                times[c * nmsgs + m] = DBL_MAX;
+            }
+            continue;
+        }
+        (void) set_coll_var(coll, "_segmentsize", configs[c].segsize);
+        (void) set_coll_var(coll, "_tree_fanout", configs[c].fanout);
+        (void) set_coll_var(coll, "_chain_fanout", configs[c].fanout);
+
+        /* coll/tuned reads the forced values when a communicator is
+           created */
+        MPI_Comm_dup(comm, &tcomm);
+        MPI_Comm_set_errhandler(tcomm, MPI_ERRORS_RETURN);
+
+        for (m = 0; m < nmsgs; ++m) {
+            int count = (int) (msgs[m] / elem);
+
+            failed = 0;
+            for (r = 0; r < warmups; ++r) {
+                rc = coll->run(count, dtype, tcomm);
+                failed |= (MPI_SUCCESS != rc);
+            }
+            MPI_Barrier(tcomm);
+            start = MPI_Wtime();
+            for (r = 0; r < repetitions; ++r) {
+                rc = coll->run(count, dtype, tcomm);
+                failed |= (MPI_SUCCESS != rc);
+            }
+            elapsed = (MPI_Wtime() - start) / repetitions;
+            if (failed) {
+                elapsed = DBL_MAX;
+            }
+            /* The slowest process decides */
+            MPI_Allreduce(MPI_IN_PLACE, &elapsed, 1, MPI_DOUBLE, MPI_MAX, tcomm);
+            times[c * nmsgs + m] = elapsed;
+        }
+        MPI_Comm_free(&tcomm);
+    }
+
+    /* Back to the default decision */
+    (void) set_coll_var(coll, "", 0);
+}
+
+/*
+ * Pick the best configuration for each message size and write the
+ * rules, merging consecutive message sizes that share the same
+ * choice.  Collectives whose rules only depend on the communicator
+ * size get a single rule, for the configuration with the lowest total
+ * slowdown relative to the best one at each message size.
+ */
+static void write_comm_rules(FILE *out, const autotune_coll_t *coll, int comm_size,
+                             const autotune_config_t *configs, int nconfigs,
+                             const size_t *msgs, int nmsgs, const double *times)
+{
+    int *best = (int *) malloc(nmsgs * sizeof(int));
+    int c, m, nrules = 0, prev = -1;
+
+    for (m = 0; m < nmsgs; ++m) {
+        best[m] = 0;
+        for (c = 1; c < nconfigs; ++c) {
+            if (times[c * nmsgs + m] < times[best[m] * nmsgs + m]) {
+                best[m] = c;
+            }
+        }
+        /* Stick to the previous choice when it is within the noise, to
+           avoid a new rule for every message size */
+        if (m > 0 && best[m] != best[m - 1] &&
+            times[best[m - 1] * nmsgs + m] <= AUTOTUNE_NOISE * times[best[m] * nmsgs + m]) {
+            best[m] = best[m - 1];
+        }
+    }
+    if (coll->size_agnostic) {
+        double score, best_score = DBL_MAX;
+        int winner = 0;
+
+        for (c = 0; c < nconfigs; ++c) {
+            for (score = 0.0, m = 0; m < nmsgs; ++m) {
+                score += times[c * nmsgs + m] / times[best[m] * nmsgs + m];
+            }
+            if (score < best_score) {
+                best_score = score;
+                winner = c;
+            }
+        }
+        for (m = 0; m < nmsgs; ++m) {
+            best[m] = winner;
+        }
+    }
+
+    for (m = 0; m < nmsgs; ++m) {
+        if (best[m] != prev) {
+            ++nrules;
+            prev = best[m];
+        }
+    }
+
+    fprintf(out, "%d # comm size\n", comm_size);
+    fprintf(out, "%d # number of msg sizes\n", nrules);
+    for (prev = -1, m = 0; m < nmsgs; ++m) {
+        if (best[m] == prev) {
+            continue;
+        }
+        prev = best[m];
+        /* The first rule must cover everything from 0 bytes on.  If
+           nothing worked, algorithm 0 falls back to the fixed rules. */
+        if (DBL_MAX == times[prev * nmsgs + m]) {
+            fprintf(out, "%lu 0 0 0 # msg size, no valid algorithm\n",
+                    (0 == m) ? 0UL : (unsigned long) rule_msg_size(coll, comm_size, msgs[m]));
+            continue;
+        }
+        fprintf(out, "%lu %d %d %d # msg size, algorithm, fan in/out, segment size (%.2f us)\n",
+                (0 == m) ? 0UL : (unsigned long) rule_msg_size(coll, comm_size, msgs[m]),
+                configs[prev].algorithm, configs[prev].fanout, configs[prev].segsize,
+                times[prev * nmsgs + m] * 1e6);
+    }
+    free(best);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -o <file>     rules file to write (default: coll_tuned_rules.conf)\n"
+            "  -c <list>     comma separated list of collectives (default: all)\n"
+            "  -n <list>     communicator sizes (default: powers of two and the world size)\n"
+            "  -m <bytes>    smallest block size per process (default: 4)\n"
+            "  -M <bytes>    largest block size per process (default: 1048576)\n"
+            "  -x <factor>   block size multiplier between steps (default: 4)\n"
+            "  -s <list>     segment sizes to try (default: 0,8192,65536)\n"
+            "  -f <list>     tree/chain fan in/out values to try (default: 4)\n"
+            "  -r <reps>     timed repetitions per measurement (default: 20)\n"
+            "  -w <reps>     warmup repetitions per measurement (default: 2)\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *filename = "coll_tuned_rules.conf", *colls = NULL;
+    int *comm_sizes = NULL, *segsizes = NULL, *fanouts = NULL;
+    int ncomm_sizes = 0, nsegsizes, nfanouts;
+    size_t min_bytes = 4, max_bytes = 1 << 20, factor = 4;
+    int repetitions = 20, warmups = 2;
+    int rank, size, provided, ncolls_selected = 0;
+    bool use_dynamic = false;
+    int i, j, k, a, ch, nmsgs, nconfigs, algcount;
+    size_t *msgs, bytes;
+    autotune_config_t *configs;
+    double *times;
+    FILE *out = NULL;
+    char name[128];
+    int selected[AUTOTUNE_NCOLLS];
+
+    nsegsizes = parse_list("0,8192,65536", &segsizes);
+    nfanouts = parse_list("4", &fanouts);
+
+    MPI_Init(&argc, &argv);
+    MPI_T_init_thread(MPI_THREAD_SINGLE, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    while (-1 != (ch = getopt(argc, argv, "o:c:n:m:M:x:s:f:r:w:h"))) {
+        switch (ch) {
+        case 'o': filename = optarg; break;
+        case 'c': colls = optarg; break;
+        case 'n': free(comm_sizes); ncomm_sizes = parse_list(optarg, &comm_sizes); break;
+        case 'm': min_bytes = strtoul(optarg, NULL, 0); break;
+        case 'M': max_bytes = strtoul(optarg, NULL, 0); break;
+        case 'x': factor = strtoul(optarg, NULL, 0); break;
+        case 's': free(segsizes); nsegsizes = parse_list(optarg, &segsizes); break;
+        case 'f': free(fanouts); nfanouts = parse_list(optarg, &fanouts); break;
+        case 'r': repetitions = atoi(optarg); break;
+        case 'w': warmups = atoi(optarg); break;
+        default:
+            if (0 == rank) {
+                usage(argv[0]);
+            }
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    if (factor < 2) {
+        factor = 2;
+    }
+    if (min_bytes < 1) {
+        min_bytes = 1;
+    }
+
+    if (0 != cvar_read("coll_tuned_use_dynamic_rules", &use_dynamic) || !use_dynamic) {
+        if (0 == rank) {
+            fprintf(stderr, "coll_tuned_autotune: coll/tuned must be available and run with "
+                    "--mca coll_tuned_use_dynamic_rules 1\n");
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    if (0 == ncomm_sizes) {
+        comm_sizes = (int *) malloc((sizeof(int) * 8 + 1) * sizeof(int));
+        for (i = 2; i < size; i *= 2) {
+            comm_sizes[ncomm_sizes++] = i;
+        }
+        comm_sizes[ncomm_sizes++] = size;
+    }
+    /* coll/tuned expects the communicator sizes in increasing order */
+    qsort(comm_sizes, ncomm_sizes, sizeof(int), compare_int);
+    for (i = 0, j = 0; i < ncomm_sizes; ++i) {
+        if (0 == j || comm_sizes[i] != comm_sizes[j - 1]) {
+            comm_sizes[j++] = comm_sizes[i];
+        }
+    }
+    ncomm_sizes = j;
+    for (i = 0; i < ncomm_sizes; ++i) {
+        if (comm_sizes[i] < 1 || comm_sizes[i] > size) {
+            if (0 == rank) {
+                fprintf(stderr, "coll_tuned_autotune: invalid communicator size %d\n",
+                        comm_sizes[i]);
+            }
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    for (nmsgs = 0, bytes = min_bytes; bytes <= max_bytes; bytes *= factor) {
+        ++nmsgs;
+    }
+    msgs = (size_t *) malloc(nmsgs * sizeof(size_t));
+    for (i = 0, bytes = min_bytes; i < nmsgs; ++i, bytes *= factor) {
+        msgs[i] = bytes;
+    }
+
+    sbuf = (char *) calloc(max_bytes, size);
+    rbuf = (char *) calloc(max_bytes, size);
+    counts = (int *) malloc(size * sizeof(int));
+    displs = (int *) malloc(size * sizeof(int));
+
+    for (i = 0; i < AUTOTUNE_NCOLLS; ++i) {
+        snprintf(name, sizeof(name), "coll_tuned_%s_algorithm_count", autotune_colls[i].name);
+        selected[i] = (0 == cvar_read(name, &algcount)) && algcount > 1;
+        if (selected[i] && NULL != colls) {
+            const char *p = strstr(colls, autotune_colls[i].name);
+            size_t len = strlen(autotune_colls[i].name);
+            /* Match whole names only (e.g., "reduce" is not "allreduce") */
+            while (NULL != p && !((p == colls || ',' == p[-1]) &&
+                                  ('\0' == p[len] || ',' == p[len]))) {
+                p = strstr(p + 1, autotune_colls[i].name);
+            }
+            selected[i] = (NULL != p);
+        }
+        ncolls_selected += selected[i];
+    }
+
+    if (0 == rank) {
+        out = fopen(filename, "w");
+        if (NULL == out) {
+            fprintf(stderr, "coll_tuned_autotune: cannot open %s\n", filename);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        fprintf(out, "# coll/tuned dynamic rules generated by coll_tuned_autotune\n");
+        fprintf(out, "# (%d processes, block sizes %lu to %lu bytes)\n",
+                size, (unsigned long) min_bytes, (unsigned long) max_bytes);
+        fprintf(out, "%d # number of collectives\n", ncolls_selected);
+    }
+
+    for (i = 0; i < AUTOTUNE_NCOLLS; ++i) {
+        const autotune_coll_t *coll = &autotune_colls[i];
+        int coll_nmsgs = (BARRIER == coll->id) ? 1 : nmsgs;
+        /* Only sweep the parameters the algorithms of this collective
+           know about */
+        int coll_nsegsizes = has_coll_var(coll, "_segmentsize") ? nsegsizes : 1;
+        int coll_nfanouts = (has_coll_var(coll, "_tree_fanout") ||
+                             has_coll_var(coll, "_chain_fanout")) ? nfanouts : 1;
+
+        if (!selected[i]) {
+            continue;
+        }
+        snprintf(name, sizeof(name), "coll_tuned_%s_algorithm_count", coll->name);
+        cvar_read(name, &algcount);
+
+        /* Algorithm 0 means "let the fixed rules decide", so skip it */
+        nconfigs = (algcount - 1) * coll_nsegsizes * coll_nfanouts;
+        configs = (autotune_config_t *) malloc(nconfigs * sizeof(autotune_config_t));
+        for (nconfigs = 0, a = 1; a < algcount; ++a) {
+            for (j = 0; j < coll_nsegsizes; ++j) {
+                for (k = 0; k < coll_nfanouts; ++k) {
+                    configs[nconfigs].algorithm = a;
+                    configs[nconfigs].segsize = (coll_nsegsizes > 1) ? segsizes[j] : 0;
+                    configs[nconfigs].fanout = (coll_nfanouts > 1) ? fanouts[k] : fanouts[0];
+                    ++nconfigs;
+                }
+            }
+        }
+        times = (double *) malloc(nconfigs * coll_nmsgs * sizeof(double));
+
+        if (0 == rank) {
+            fprintf(out, "%d # collective ID (%s)\n", (int) coll->id, coll->name);
+            fprintf(out, "%d # number of comm sizes\n", ncomm_sizes);
+            printf("Tuning %s (%d configurations)\n", coll->name, nconfigs);
+            fflush(stdout);
+        }
+
+        for (j = 0; j < ncomm_sizes; ++j) {
+            MPI_Comm comm;
+
+            MPI_Comm_split(MPI_COMM_WORLD, (rank < comm_sizes[j]) ? 0 : MPI_UNDEFINED,
+                           rank, &comm);
+            if (MPI_COMM_NULL != comm) {
+                time_collective(coll, comm, configs, nconfigs, msgs, coll_nmsgs,
+                                repetitions, warmups, times);
+                MPI_Comm_free(&comm);
+            }
+            if (0 == rank) {
+                write_comm_rules(out, coll, comm_sizes[j], configs, nconfigs,
+                                 msgs, coll_nmsgs, times);
+            }
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
+        free(configs);
+        free(times);
+    }
+
+    if (0 == rank) {
+        fclose(out);
+        printf("Rules written to %s\n", filename);
+    }
+
+    free(msgs);
+    free(sbuf);
+    free(rbuf);
+    free(counts);
+    free(displs);
+    free(comm_sizes);
+    free(segsizes);
+    free(fanouts);
+
+    MPI_T_finalize();
+    MPI_Finalize();
+    return 0;
+}
@@ -37,6 +37,7 @@
 #include "opal/datatype/opal_convertor.h"
 #include "opal/datatype/opal_datatype_checksum.h"
 #include "opal/datatype/opal_datatype_prototypes.h"
+#include "opal/datatype/opal_datatype_plan.h"
 #include "opal/datatype/opal_convertor_internal.h"
 #if OPAL_CUDA_SUPPORT
 #include "opal/datatype/opal_datatype_cuda.h"
@@ -562,6 +563,23 @@ size_t opal_convertor_compute_remote_size( opal_convertor_t* pConvertor )
     }
 
 
+/**
+ * Non contiguous datatypes used often enough are packed and unpacked with
+ * their compiled plan (see opal_datatype_plan.h), unless the copies have to
+ * go through CUDA.
+ */
+static inline bool
+opal_convertor_use_plan( opal_convertor_t* convertor,
+                         const opal_datatype_t* datatype )
+{
+    if( convertor->flags & (CONVERTOR_CUDA | CONVERTOR_CUDA_UNIFIED) )
+        return false;
+    if( NULL == opal_datatype_plan_get( datatype ) )
+        return false;
+    convertor->flags |= CONVERTOR_PLAN;
+    return true;
+}
+
 int32_t opal_convertor_prepare_for_recv( opal_convertor_t* convertor,
                                          const struct opal_datatype_t* datatype,
                                          size_t count,
@@ -597,6 +615,8 @@ int32_t opal_convertor_prepare_for_recv( opal_convertor_t* convertor,
         } else {
             if( convertor->pDesc->flags & OPAL_DATATYPE_FLAG_CONTIGUOUS ) {
                 convertor->fAdvance = opal_unpack_homogeneous_contig;
+            } else if( opal_convertor_use_plan( convertor, datatype ) ) {
+                convertor->fAdvance = opal_unpack_plan;
             } else {
                 convertor->fAdvance = opal_generic_simple_unpack;
             }
@@ -645,6 +665,8 @@ int32_t opal_convertor_prepare_for_send( opal_convertor_t* convertor,
                     convertor->fAdvance = opal_pack_homogeneous_contig;
                 else
                     convertor->fAdvance = opal_pack_homogeneous_contig_with_gaps;
+            } else if( opal_convertor_use_plan( convertor, datatype ) ) {
+                convertor->fAdvance = opal_pack_plan;
             } else {
                 convertor->fAdvance = opal_generic_simple_pack;
             }
@@ -716,6 +738,7 @@ void opal_convertor_dump( opal_convertor_t* convertor )
     if( convertor->flags & CONVERTOR_HOMOGENEOUS ) opal_output( 0, "homogeneous " );
     else opal_output( 0, "heterogeneous ");
     if( convertor->flags & CONVERTOR_NO_OP ) opal_output( 0, "no_op ");
+    if( convertor->flags & CONVERTOR_PLAN ) opal_output( 0, "plan ");
     if( convertor->flags & CONVERTOR_WITH_CHECKSUM ) opal_output( 0, "checksum ");
     if( convertor->flags & CONVERTOR_CUDA ) opal_output( 0, "CUDA ");
     if( convertor->flags & CONVERTOR_CUDA_ASYNC ) opal_output( 0, "CUDA Async ");
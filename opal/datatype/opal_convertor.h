@@ -57,6 +57,7 @@ BEGIN_C_DECLS
 #define CONVERTOR_CUDA_UNIFIED     0x10000000
 #define CONVERTOR_HAS_REMOTE_SIZE  0x20000000
 #define CONVERTOR_SKIP_CUDA_INIT   0x40000000
+#define CONVERTOR_PLAN             0x80000000  /**< packs/unpacks with the plan of the datatype */
 
 union dt_elem_desc;
 typedef struct opal_convertor_t opal_convertor_t;
@@ -332,6 +333,12 @@ opal_convertor_set_position( opal_convertor_t* convertor,
     /* Remove the completed flag if it's already set */
     convertor->flags &= ~CONVERTOR_COMPLETED;
 
+    if( convertor->flags & CONVERTOR_PLAN ) {
+        /* plans only depend on the position */
+        convertor->bConverted = *position;
+        return OPAL_SUCCESS;
+    }
+
     if( (convertor->flags & OPAL_DATATYPE_FLAG_NO_GAPS) &&
 #if defined(CHECKSUM)
         !(convertor->flags & CONVERTOR_WITH_CHECKSUM) &&
@@ -133,9 +133,11 @@ struct opal_datatype_t {
                                       layer). This field should never be initialized in homogeneous
                                       environments */
     /* --- cacheline 5 boundary (320 bytes) was 32-36 bytes ago --- */
+    struct opal_datatype_plan_t* plan;  /**< compiled pack/unpack plan, see opal_datatype_plan.h */
+    opal_atomic_int32_t plan_uses;      /**< number of convertors prepared while the plan is missing */
 
-    /* size: 352, cachelines: 6, members: 15 */
-    /* last cacheline: 28-32 bytes */
+    /* size: 368, cachelines: 6, members: 17 */
+    /* last cacheline: 44-48 bytes */
 };
 
 typedef struct opal_datatype_t opal_datatype_t;
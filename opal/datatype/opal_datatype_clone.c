@@ -45,6 +45,9 @@ int32_t opal_datatype_clone( const opal_datatype_t * src_type, opal_datatype_t *
     dest_type->flags &= (~OPAL_DATATYPE_FLAG_PREDEFINED);
     dest_type->ptypes = NULL;
     dest_type->desc.desc = temp;
+    /* plans are compiled per datatype */
+    dest_type->plan = NULL;
+    dest_type->plan_uses = 0;
 
     /**
      * Allow duplication of MPI_UB and MPI_LB.
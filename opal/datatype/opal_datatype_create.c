@@ -27,6 +27,7 @@
 #include "opal/constants.h"
 #include "opal/datatype/opal_datatype.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_plan.h"
 #include "limits.h"
 #include "opal/prefetch.h"
 
@@ -55,10 +56,15 @@ static void opal_datatype_construct( opal_datatype_t* pData )
 
     pData->ptypes             = NULL;
     pData->loops              = 0;
+
+    pData->plan               = NULL;
+    pData->plan_uses          = 0;
 }
 
 static void opal_datatype_destruct( opal_datatype_t* datatype )
 {
+    opal_datatype_plan_release( datatype );
+
     /**
      * As the default description and the optimized description might point to the
      * same data description we should start by cleaning the optimized description.
@@ -14,7 +14,14 @@
 #ifndef OPAL_DATATYPE_MEMCPY_H_HAS_BEEN_INCLUDED
 #define OPAL_DATATYPE_MEMCPY_H_HAS_BEEN_INCLUDED
 
+#include "opal/mca/memcpy/base/base.h"
+
+/*
+ * All the contiguous copies done by the convertor go through the
+ * memcpy framework, which may use cache bypassing stores for the
+ * large ones.
+ */
 #define MEMCPY( DST, SRC, BLENGTH ) \
-    memcpy( (DST), (SRC), (BLENGTH) )
+    opal_memcpy( (DST), (SRC), (BLENGTH) )
 
 #endif  /* OPAL_DATATYPE_MEMCPY_H_HAS_BEEN_INCLUDED */
@@ -37,6 +37,7 @@
 #include "opal/datatype/opal_datatype_internal.h"
 #include "opal/datatype/opal_datatype.h"
 #include "opal/datatype/opal_convertor_internal.h"
+#include "opal/datatype/opal_datatype_plan.h"
 #include "opal/mca/base/mca_base_var.h"
 
 /* by default the debuging is turned off */
@@ -158,9 +159,18 @@ OPAL_DECLSPEC const opal_datatype_t* opal_datatype_basicDatatypes[OPAL_DATATYPE_
 
 int opal_datatype_register_params(void)
 {
-#if OPAL_ENABLE_DEBUG
     int ret;
 
+    ret = mca_base_var_register ("opal", "mpi", NULL, "ddt_plan_threshold",
+                                 "Number of times a non contiguous datatype has to be used for packing or "
+                                 "unpacking before a flat pack/unpack plan is compiled for it (0 = never compile plans)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_LOCAL, &opal_datatype_plan_threshold);
+    if (0 > ret) {
+        return ret;
+    }
+
+#if OPAL_ENABLE_DEBUG
     ret = mca_base_var_register ("opal", "mpi", NULL, "ddt_unpack_debug",
                                  "Whether to output debugging information in the ddt unpack functions (nonzero = enabled)",
                                  MCA_BASE_VAR_TYPE_BOOL, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_3,
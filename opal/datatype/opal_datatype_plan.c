@@ -0,0 +1,373 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "opal/constants.h"
+#include "opal/mca/threads/thread_usage.h"
+#include "opal/datatype/opal_convertor_internal.h"
+#include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_memcpy.h"
+#include "opal/datatype/opal_datatype_plan.h"
+#include "opal/datatype/opal_datatype_prototypes.h"
+
+#if OPAL_ENABLE_DEBUG
+#include "opal/util/output.h"
+
+#define DO_DEBUG(INST)  if( opal_ddt_pack_debug ) { INST }
+#else
+#define DO_DEBUG(INST)
+#endif  /* OPAL_ENABLE_DEBUG */
+
+int opal_datatype_plan_threshold = 4;
+
+/* marks datatypes whose layout does not lend itself to a plan */
+static opal_datatype_plan_t opal_datatype_plan_none = { .kind = 0 };
+
+/*
+ * Plan compilation. The optimized description of one instance of the
+ * datatype is walked once, the blocks it produces are merged when they are
+ * adjacent, and the layout is kept as a single stride when all blocks have
+ * the same length and are equally spaced.
+ */
+typedef struct {
+    opal_datatype_plan_t* plan;
+    size_t    capacity;    /* allocated entries in plan->blocks */
+    bool      strided;     /* all the blocks so far are equal and equally spaced */
+    ptrdiff_t last_disp;   /* last flushed block */
+    ptrdiff_t pending_disp;
+    size_t    pending_length;
+} opal_datatype_plan_builder_t;
+
+static int opal_datatype_plan_flush( opal_datatype_plan_builder_t* builder )
+{
+    opal_datatype_plan_t* plan = builder->plan;
+    ptrdiff_t disp = builder->pending_disp;
+    size_t length = builder->pending_length;
+
+    if( 0 == length ) return OPAL_SUCCESS;
+    builder->pending_length = 0;
+
+    if( 0 == plan->nblocks ) {
+        plan->disp     = disp;
+        plan->blocklen = length;
+        builder->strided = true;
+    } else if( 1 == plan->nblocks ) {
+        plan->stride = disp - plan->disp;
+        builder->strided = (length == plan->blocklen);
+    } else if( builder->strided ) {
+        builder->strided = (length == plan->blocklen) && (disp == builder->last_disp + plan->stride);
+    }
+
+    if( plan->nblocks < OPAL_DATATYPE_PLAN_MAX_BLOCKS ) {
+        if( plan->nblocks == builder->capacity ) {
+            opal_datatype_plan_block_t* blocks;
+
+            builder->capacity = (0 == builder->capacity) ? 16 : 2 * builder->capacity;
+            blocks = (opal_datatype_plan_block_t*)realloc( plan->blocks,
+                                                           builder->capacity * sizeof(opal_datatype_plan_block_t) );
+            if( NULL == blocks ) return OPAL_ERR_OUT_OF_RESOURCE;
+            plan->blocks = blocks;
+        }
+        plan->blocks[plan->nblocks].disp   = disp;
+        plan->blocks[plan->nblocks].length = length;
+        plan->blocks[plan->nblocks].offset = plan->size;
+    } else if( !builder->strided ) {
+        /* too many irregular blocks */
+        return OPAL_ERR_NOT_SUPPORTED;
+    }
+
+    builder->last_disp = disp;
+    plan->size += length;
+    plan->nblocks++;
+    return OPAL_SUCCESS;
+}
+
+static inline int opal_datatype_plan_add( opal_datatype_plan_builder_t* builder,
+                                          ptrdiff_t disp, size_t length )
+{
+    if( (0 != builder->pending_length) &&
+        (builder->pending_disp + (ptrdiff_t)builder->pending_length == disp) ) {
+        builder->pending_length += length;
+        return OPAL_SUCCESS;
+    }
+    if( OPAL_SUCCESS != opal_datatype_plan_flush( builder ) )
+        return OPAL_ERR_NOT_SUPPORTED;
+    builder->pending_disp   = disp;
+    builder->pending_length = length;
+    return OPAL_SUCCESS;
+}
+
+/* walks the first count entries of desc, a loop body or the whole description */
+static int opal_datatype_plan_walk( opal_datatype_plan_builder_t* builder,
+                                    const dt_elem_desc_t* desc, uint32_t count,
+                                    ptrdiff_t base )
+{
+    uint32_t pos_desc = 0, i;
+    int rc;
+
+    while( pos_desc < count ) {
+        const dt_elem_desc_t* pElem = desc + pos_desc;
+
+        if( OPAL_DATATYPE_LOOP == pElem->elem.common.type ) {
+            for( i = 0; i < pElem->loop.loops; i++ ) {
+                rc = opal_datatype_plan_walk( builder, pElem + 1, pElem->loop.items - 1,
+                                              base + (ptrdiff_t)i * pElem->loop.extent );
+                if( OPAL_SUCCESS != rc ) return rc;
+            }
+            pos_desc += pElem->loop.items + 1;
+            continue;
+        }
+        if( OPAL_DATATYPE_END_LOOP == pElem->elem.common.type ) {
+            break;
+        }
+
+        for( i = 0; i < pElem->elem.count; i++ ) {
+            rc = opal_datatype_plan_add( builder, base + pElem->elem.disp + (ptrdiff_t)i * pElem->elem.extent,
+                                         pElem->elem.blocklen * opal_datatype_basicDatatypes[pElem->elem.common.type]->size );
+            if( OPAL_SUCCESS != rc ) return rc;
+        }
+        pos_desc++;
+    }
+    return OPAL_SUCCESS;
+}
+
+static opal_datatype_plan_t* opal_datatype_plan_compile( const opal_datatype_t* datatype )
+{
+    opal_datatype_plan_builder_t builder = { .capacity = 0, .pending_length = 0 };
+    const dt_type_desc_t* desc = (0 != datatype->opt_desc.used) ? &datatype->opt_desc : &datatype->desc;
+    opal_datatype_plan_t* plan;
+
+    plan = (opal_datatype_plan_t*)calloc( 1, sizeof(opal_datatype_plan_t) );
+    if( NULL == plan ) return NULL;
+    plan->extent = datatype->ub - datatype->lb;
+    builder.plan = plan;
+
+    if( (OPAL_SUCCESS != opal_datatype_plan_walk( &builder, desc->desc, desc->used, 0 )) ||
+        (OPAL_SUCCESS != opal_datatype_plan_flush( &builder )) ||
+        (plan->size != datatype->size) ) {
+        free( plan->blocks );
+        free( plan );
+        return NULL;
+    }
+
+    if( builder.strided ) {
+        plan->kind = OPAL_DATATYPE_PLAN_STRIDED;
+        free( plan->blocks );
+        plan->blocks = NULL;
+    } else {
+        plan->kind = OPAL_DATATYPE_PLAN_BLOCKS;
+    }
+    DO_DEBUG( opal_output( 0, "plan for %s: kind %d, %" PRIsize_t " blocks, size %" PRIsize_t "\n",
+                           datatype->name, plan->kind, plan->nblocks, plan->size ); );
+    return plan;
+}
+
+const opal_datatype_plan_t* opal_datatype_plan_get( const opal_datatype_t* datatype )
+{
+    opal_datatype_t* pData = (opal_datatype_t*)datatype;  /* the plan is a cache */
+    opal_datatype_plan_t *plan = pData->plan, *expected = NULL;
+
+    if( OPAL_LIKELY(NULL != plan) ) {
+        return (plan == &opal_datatype_plan_none) ? NULL : plan;
+    }
+    if( (0 == opal_datatype_plan_threshold) ||
+        !(pData->flags & OPAL_DATATYPE_FLAG_COMMITTED) ||
+        (OPAL_THREAD_ADD_FETCH32( &pData->plan_uses, 1 ) < opal_datatype_plan_threshold) ) {
+        return NULL;
+    }
+
+    plan = opal_datatype_plan_compile( pData );
+    if( NULL == plan ) {
+        plan = &opal_datatype_plan_none;
+    }
+    if( !opal_atomic_compare_exchange_strong_ptr( (opal_atomic_intptr_t*)&pData->plan,
+                                                  (intptr_t*)&expected, (intptr_t)plan ) ) {
+        /* another thread was faster */
+        if( plan != &opal_datatype_plan_none ) {
+            free( plan->blocks );
+            free( plan );
+        }
+        plan = expected;
+    }
+    return (plan == &opal_datatype_plan_none) ? NULL : plan;
+}
+
+void opal_datatype_plan_release( opal_datatype_t* datatype )
+{
+    opal_datatype_plan_t* plan = datatype->plan;
+
+    if( (NULL != plan) && (&opal_datatype_plan_none != plan) ) {
+        free( plan->blocks );
+        free( plan );
+    }
+    datatype->plan = NULL;
+    datatype->plan_uses = 0;
+}
+
+/*
+ * Plan execution. Everything is derived from the position in the packed
+ * data: instance = position / size, and the offset in the instance gives
+ * the block. The stack of the convertor is not maintained.
+ */
+static inline void
+opal_datatype_plan_move( unsigned char* user, unsigned char* packed, size_t length, bool pack )
+{
+    if( pack ) {
+        MEMCPY( packed, user, length );
+    } else {
+        MEMCPY( user, packed, length );
+    }
+}
+
+/* nfull complete blocks of blocklen bytes. With a constant blocklen the
+ * compiler turns the copies into plain (vector) loads and stores. */
+static inline void
+opal_datatype_plan_strided_blocks( const opal_datatype_plan_t* plan, unsigned char* base,
+                                   size_t* instance, size_t* block, unsigned char** packed,
+                                   size_t nfull, const size_t blocklen, bool pack )
+{
+    unsigned char* user = base + (ptrdiff_t)*instance * plan->extent + plan->disp +
+                          (ptrdiff_t)*block * plan->stride;
+    size_t i = *instance, j = *block;
+
+    for( ; nfull > 0; nfull-- ) {
+        opal_datatype_plan_move( user, *packed, blocklen, pack );
+        *packed += blocklen;
+        if( ++j == plan->nblocks ) {
+            j = 0;
+            i++;
+            user = base + (ptrdiff_t)i * plan->extent + plan->disp;
+        } else {
+            user += plan->stride;
+        }
+    }
+    *instance = i;
+    *block = j;
+}
+
+static inline void
+opal_datatype_plan_strided( const opal_datatype_plan_t* plan, unsigned char* base,
+                            size_t position, unsigned char* packed, size_t length, bool pack )
+{
+    size_t instance = position / plan->size, offset = position % plan->size;
+    size_t block = offset / plan->blocklen, partial = offset % plan->blocklen;
+    size_t blocklen = plan->blocklen, nfull, count;
+
+    if( 0 != partial ) {  /* finish the block started by the previous call */
+        count = blocklen - partial;
+        if( count > length ) count = length;
+        opal_datatype_plan_move( base + (ptrdiff_t)instance * plan->extent + plan->disp +
+                                 (ptrdiff_t)block * plan->stride + partial, packed, count, pack );
+        packed += count;
+        length -= count;
+        if( 0 == length ) return;
+        if( ++block == plan->nblocks ) {
+            block = 0;
+            instance++;
+        }
+    }
+
+    nfull = length / blocklen;
+    switch( blocklen ) {
+    case 1:  opal_datatype_plan_strided_blocks( plan, base, &instance, &block, &packed, nfull, 1, pack ); break;
+    case 2:  opal_datatype_plan_strided_blocks( plan, base, &instance, &block, &packed, nfull, 2, pack ); break;
+    case 4:  opal_datatype_plan_strided_blocks( plan, base, &instance, &block, &packed, nfull, 4, pack ); break;
+    case 8:  opal_datatype_plan_strided_blocks( plan, base, &instance, &block, &packed, nfull, 8, pack ); break;
+    case 16: opal_datatype_plan_strided_blocks( plan, base, &instance, &block, &packed, nfull, 16, pack ); break;
+    case 32: opal_datatype_plan_strided_blocks( plan, base, &instance, &block, &packed, nfull, 32, pack ); break;
+    default: opal_datatype_plan_strided_blocks( plan, base, &instance, &block, &packed, nfull, blocklen, pack ); break;
+    }
+    length -= nfull * blocklen;
+
+    if( 0 != length ) {  /* the beginning of the next block */
+        opal_datatype_plan_move( base + (ptrdiff_t)instance * plan->extent + plan->disp +
+                                 (ptrdiff_t)block * plan->stride, packed, length, pack );
+    }
+}
+
+static inline void
+opal_datatype_plan_blocks( const opal_datatype_plan_t* plan, unsigned char* base,
+                           size_t position, unsigned char* packed, size_t length, bool pack )
+{
+    const opal_datatype_plan_block_t* blocks = plan->blocks;
+    size_t offset = position % plan->size, lo = 0, hi = plan->nblocks - 1, mid, count;
+    unsigned char* user = base + (ptrdiff_t)(position / plan->size) * plan->extent;
+
+    while( lo < hi ) {  /* last block starting at or before offset */
+        mid = (lo + hi + 1) / 2;
+        if( blocks[mid].offset <= offset ) lo = mid;
+        else hi = mid - 1;
+    }
+    offset -= blocks[lo].offset;
+
+    while( 0 != length ) {
+        count = blocks[lo].length - offset;
+        if( count > length ) count = length;
+        opal_datatype_plan_move( user + blocks[lo].disp + offset, packed, count, pack );
+        packed += count;
+        length -= count;
+        offset = 0;
+        if( ++lo == plan->nblocks ) {
+            lo = 0;
+            user += plan->extent;
+        }
+    }
+}
+
+static inline int32_t
+opal_datatype_plan_advance( opal_convertor_t* pConv, struct iovec* iov,
+                            uint32_t* out_size, size_t* max_data, bool pack )
+{
+    const opal_datatype_plan_t* plan = pConv->pDesc->plan;
+    size_t initial_bytes_converted = pConv->bConverted, length;
+    uint32_t idx;
+
+    for( idx = 0; idx < (*out_size); idx++ ) {
+        length = pConv->local_size - pConv->bConverted;
+        if( 0 == length ) break;
+        if( length > iov[idx].iov_len )
+            length = iov[idx].iov_len;
+        DO_DEBUG( opal_output( 0, "%s plan( position %" PRIsize_t ", buffer %p, length %" PRIsize_t " )\n",
+                               pack ? "pack" : "unpack", pConv->bConverted, iov[idx].iov_base, length ); );
+        if( OPAL_DATATYPE_PLAN_STRIDED == plan->kind ) {
+            opal_datatype_plan_strided( plan, pConv->pBaseBuf, pConv->bConverted,
+                                        (unsigned char*)iov[idx].iov_base, length, pack );
+        } else {
+            opal_datatype_plan_blocks( plan, pConv->pBaseBuf, pConv->bConverted,
+                                       (unsigned char*)iov[idx].iov_base, length, pack );
+        }
+        iov[idx].iov_len = length;
+        pConv->bConverted += length;
+    }
+
+    *out_size = idx;
+    *max_data = pConv->bConverted - initial_bytes_converted;
+    if( pConv->bConverted == pConv->local_size ) pConv->flags |= CONVERTOR_COMPLETED;
+    return !!(pConv->flags & CONVERTOR_COMPLETED);  /* done or not */
+}
+
+int32_t
+opal_pack_plan( opal_convertor_t* pConv,
+                struct iovec* iov, uint32_t* out_size,
+                size_t* max_data )
+{
+    return opal_datatype_plan_advance( pConv, iov, out_size, max_data, true );
+}
+
+int32_t
+opal_unpack_plan( opal_convertor_t* pConv,
+                  struct iovec* iov, uint32_t* out_size,
+                  size_t* max_data )
+{
+    return opal_datatype_plan_advance( pConv, iov, out_size, max_data, false );
+}
@@ -0,0 +1,70 @@
+/* -*- Mode: C; c-basic-offset:4 ; -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef OPAL_DATATYPE_PLAN_H_HAS_BEEN_INCLUDED
+#define OPAL_DATATYPE_PLAN_H_HAS_BEEN_INCLUDED
+
+#include "opal_config.h"
+
+#include "opal/datatype/opal_datatype.h"
+
+BEGIN_C_DECLS
+
+/**
+ * A pack/unpack plan is the flattened layout of one instance of a committed
+ * datatype: the list of contiguous blocks of bytes it is made of, in the
+ * order of the packed representation. Repeated instances are at the extent
+ * of the datatype. The plan does not depend on the position in the data, so
+ * a convertor using it keeps no state besides bConverted.
+ */
+#define OPAL_DATATYPE_PLAN_STRIDED  1  /**< nblocks blocks of blocklen bytes, stride bytes apart */
+#define OPAL_DATATYPE_PLAN_BLOCKS   2  /**< nblocks arbitrary blocks */
+
+/** Larger irregular layouts are left to the generic engine */
+#define OPAL_DATATYPE_PLAN_MAX_BLOCKS  1024
+
+struct opal_datatype_plan_block_t {
+    ptrdiff_t disp;     /**< displacement of the block in the user buffer */
+    size_t    length;   /**< length of the block in bytes */
+    size_t    offset;   /**< position of the block in the packed instance */
+};
+typedef struct opal_datatype_plan_block_t opal_datatype_plan_block_t;
+
+struct opal_datatype_plan_t {
+    int32_t    kind;       /**< OPAL_DATATYPE_PLAN_STRIDED or OPAL_DATATYPE_PLAN_BLOCKS */
+    size_t     size;       /**< packed size of one instance */
+    ptrdiff_t  extent;     /**< distance between two instances */
+    size_t     nblocks;    /**< number of blocks in one instance */
+    ptrdiff_t  disp;       /**< STRIDED: displacement of the first block */
+    size_t     blocklen;   /**< STRIDED: length of each block */
+    ptrdiff_t  stride;     /**< STRIDED: distance between two blocks */
+    opal_datatype_plan_block_t* blocks;  /**< BLOCKS: the blocks */
+};
+typedef struct opal_datatype_plan_t opal_datatype_plan_t;
+
+/**
+ * Number of convertors that have to be prepared with a datatype before
+ * a plan is compiled for it, 0 to never compile plans.
+ */
+OPAL_DECLSPEC extern int opal_datatype_plan_threshold;
+
+/**
+ * Return the plan of a committed datatype, compiling it once the datatype
+ * has been used often enough. NULL if the datatype has (yet) no plan.
+ */
+const opal_datatype_plan_t* opal_datatype_plan_get( const opal_datatype_t* datatype );
+
+/**
+ * Release the plan attached to the datatype, if any.
+ */
+void opal_datatype_plan_release( opal_datatype_t* datatype );
+
+END_C_DECLS
+
+#endif  /* OPAL_DATATYPE_PLAN_H_HAS_BEEN_INCLUDED */
@@ -352,6 +352,175 @@ static void fake_rdma_complete (mca_btl_base_module_t *btl, mca_btl_base_endpoin
                    rc);
 }
 
+/**
+ * Completion of a put striped over several connections.
+ */
+struct mca_btl_tcp_stripe_put_t {
+    opal_atomic_int32_t pending;                /**< pieces not sent yet */
+    int rc;                                     /**< error reported by a piece, if any */
+    mca_btl_base_module_t *btl;
+    struct mca_btl_base_endpoint_t *endpoint;   /**< primary connection */
+    void *local_address;
+    mca_btl_base_rdma_completion_fn_t cbfunc;
+    void *cbcontext;
+    void *cbdata;
+};
+typedef struct mca_btl_tcp_stripe_put_t mca_btl_tcp_stripe_put_t;
+
+static void mca_btl_tcp_stripe_put_complete (mca_btl_base_module_t *btl, mca_btl_base_endpoint_t *endpoint,
+                                             mca_btl_base_descriptor_t *desc, int rc)
+{
+    mca_btl_tcp_frag_t *frag = (mca_btl_tcp_frag_t *) desc;
+    mca_btl_tcp_stripe_put_t *put = (mca_btl_tcp_stripe_put_t *) frag->cb.context;
+
+    if (OPAL_SUCCESS != rc) {
+        put->rc = rc;
+    }
+    if (0 == OPAL_THREAD_ADD_FETCH32(&put->pending, -1)) {
+        put->cbfunc (put->btl, put->endpoint, put->local_address, NULL, put->cbcontext, put->cbdata,
+                     put->rc);
+        free (put);
+    }
+}
+
+/**
+ * Split a large put in pieces sent concurrently over the connection to
+ * the peer and the additional connections to it. Returns
+ * OPAL_ERR_NOT_AVAILABLE if there are no additional connections.
+ */
+
+static int mca_btl_tcp_put_striped (mca_btl_tcp_module_t *tcp_btl, struct mca_btl_base_endpoint_t *endpoint,
+                                    void *local_address, uint64_t remote_address, size_t size,
+                                    mca_btl_base_rdma_completion_fn_t cbfunc, void *cbcontext, void *cbdata)
+{
+    mca_btl_base_endpoint_t *streams[MCA_BTL_TCP_MAX_STRIPES];
+    mca_btl_tcp_frag_t *frags[MCA_BTL_TCP_MAX_STRIPES];
+    unsigned int stripes = mca_btl_tcp_component.tcp_stripes;
+    mca_btl_tcp_stripe_put_t *put;
+    mca_btl_tcp_frag_t *frag;
+    size_t count, i, offset, length, failed;
+    uint32_t seq;
+    int rc;
+
+    if (stripes > MCA_BTL_TCP_MAX_STRIPES) {
+        stripes = MCA_BTL_TCP_MAX_STRIPES;
+    }
+    streams[0] = endpoint;
+    count = 1 + mca_btl_tcp_proc_get_streams (endpoint->endpoint_proc, endpoint, streams + 1,
+                                              stripes - 1);
+    if (1 == count) {
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+
+    put = (mca_btl_tcp_stripe_put_t *) malloc (sizeof (*put));
+    if (OPAL_UNLIKELY(NULL == put)) {
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+    for (i = 0 ; i < count ; ++i) {
+        MCA_BTL_TCP_FRAG_ALLOC_USER(frags[i]);
+        if (OPAL_UNLIKELY(NULL == frags[i])) {
+            while (i--) {
+                MCA_BTL_TCP_FRAG_RETURN(frags[i]);
+            }
+            free (put);
+            return OPAL_ERR_OUT_OF_RESOURCE;
+        }
+    }
+
+    put->pending = (int32_t) count;
+    put->rc = OPAL_SUCCESS;
+    put->btl = &tcp_btl->super;
+    put->endpoint = endpoint;
+    put->local_address = local_address;
+    put->cbfunc = cbfunc;
+    put->cbcontext = cbcontext;
+    put->cbdata = cbdata;
+
+    seq = (uint32_t) OPAL_THREAD_ADD_FETCH32(&endpoint->endpoint_proc->proc_stripe_seq, 1);
+
+    for (i = 0, offset = 0 ; i < count ; ++i, offset += length) {
+        frag = frags[i];
+
+        length = (size * (i + 1)) / count - offset;
+
+        frag->endpoint = streams[i];
+        frag->btl = streams[i]->endpoint_btl;
+        frag->segments[0].seg_addr.pval = (char *) local_address + offset;
+        frag->segments[0].seg_len = length;
+        frag->base.des_segments = frag->segments;
+        frag->base.des_segment_count = 1;
+        frag->base.order = MCA_BTL_NO_ORDER;
+        frag->base.des_flags = MCA_BTL_DES_FLAGS_BTL_OWNERSHIP | MCA_BTL_DES_SEND_ALWAYS_CALLBACK;
+        frag->base.des_cbfunc = mca_btl_tcp_stripe_put_complete;
+        frag->cb.context = put;
+
+        frag->stripe.dst.seg_addr.lval = remote_address + offset;
+        frag->stripe.dst.seg_len = length;
+        frag->stripe.seq = seq;
+        /* only the piece sent on the primary connection knows about the others */
+        frag->stripe.count = (0 == i) ? (uint32_t) count : 0;
+
+        frag->rc = 0;
+        frag->iov_idx = 0;
+        frag->iov_cnt = 3;
+        frag->iov_ptr = frag->iov;
+        frag->iov[0].iov_base = (IOVBASE_TYPE*)&frag->hdr;
+        frag->iov[0].iov_len = sizeof(frag->hdr);
+        frag->iov[1].iov_base = (IOVBASE_TYPE*)&frag->stripe;
+        frag->iov[1].iov_len = sizeof(frag->stripe);
+        frag->iov[2].iov_base = (IOVBASE_TYPE*)frag->segments[0].seg_addr.pval;
+        frag->iov[2].iov_len = length;
+        frag->hdr.base.tag = MCA_BTL_TAG_BTL;
+        frag->hdr.type = MCA_BTL_TCP_HDR_TYPE_STRIPE;
+        frag->hdr.count = 0;
+        frag->hdr.size = (uint32_t) length;
+        if (streams[i]->endpoint_nbo) {
+            MCA_BTL_TCP_HDR_HTON(frag->hdr);
+            MCA_BTL_TCP_STRIPE_HDR_HTON(frag->stripe);
+        }
+    }
+
+    /* The piece on the primary connection tells the peer how many pieces to
+     * wait for, so it goes last. A piece that cannot be queued on its
+     * additional connection is sent on the primary connection instead,
+     * ahead of the primary piece. */
+    for (i = 1, failed = 0 ; i < count ; ++i) {
+        if (mca_btl_tcp_endpoint_send (streams[i], frags[i]) >= 0) {
+            continue;
+        }
+        frags[i]->endpoint = endpoint;
+        frags[i]->btl = endpoint->endpoint_btl;
+        frags[++failed] = frags[i];
+    }
+
+    /* what is left: frags[1 .. failed], then frags[0] */
+    for (i = 1 ; i <= failed + 1 ; ++i) {
+        frag = frags[i % (failed + 1)];
+        rc = mca_btl_tcp_endpoint_send (endpoint, frag);
+        if (OPAL_LIKELY(rc >= 0)) {
+            continue;
+        }
+        if (1 == i && failed + 1 == count) {
+            /* nothing has been sent */
+            for (i = 0 ; i < count ; ++i) {
+                MCA_BTL_TCP_FRAG_RETURN(frags[i]);
+            }
+            free (put);
+            return rc;
+        }
+        /* the peer is never told about the pieces that were not sent, and
+         * the put completes with the error once the others are done */
+        for ( ; i <= failed + 1 ; ++i) {
+            frag = frags[i % (failed + 1)];
+            mca_btl_tcp_stripe_put_complete (&frag->btl->super, endpoint, &frag->base, rc);
+            MCA_BTL_TCP_FRAG_RETURN(frag);
+        }
+        break;
+    }
+
+    return OPAL_SUCCESS;
+}
+
 /**
  * Initiate an asynchronous put.
  */
@@ -365,6 +534,15 @@ int mca_btl_tcp_put (mca_btl_base_module_t *btl, struct mca_btl_base_endpoint_t
     mca_btl_tcp_frag_t *frag = NULL;
     int i;
 
+    if (mca_btl_tcp_component.tcp_stripes > 1 &&
+        size >= mca_btl_tcp_component.tcp_stripe_threshold) {
+        i = mca_btl_tcp_put_striped (tcp_btl, endpoint, local_address, remote_address, size,
+                                     cbfunc, cbcontext, cbdata);
+        if (OPAL_ERR_NOT_AVAILABLE != i) {
+            return i;
+        }
+    }
+
     MCA_BTL_TCP_FRAG_ALLOC_USER(frag);
     if( OPAL_UNLIKELY(NULL == frag) ) {
         return OPAL_ERR_OUT_OF_RESOURCE;
@@ -99,6 +99,11 @@ extern int mca_btl_tcp_progress_thread_trigger;
         }                                                               \
     } while (0)
 
+/**
+ * Maximum number of connections a put is striped over.
+ */
+#define MCA_BTL_TCP_MAX_STRIPES 16
+
 /**
  * TCP BTL component.
  */
@@ -156,6 +161,15 @@ struct mca_btl_tcp_component_t {
      * that are not found?
      */
     bool report_all_unfound_interfaces;
+
+    unsigned int tcp_stripes;               /**< number of connections large puts are striped over */
+    unsigned int tcp_stripe_threshold;      /**< minimum size of a striped put */
+
+#if OPAL_BTL_TCP_HAVE_IO_URING
+    bool tcp_io_uring;                      /**< drive connected sockets through io_uring */
+    unsigned int tcp_io_uring_entries;      /**< size of the io_uring submission queue */
+    unsigned int tcp_io_uring_zcopy_threshold; /**< minimum size of zero-copy sends (0: never) */
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
 };
 typedef struct mca_btl_tcp_component_t mca_btl_tcp_component_t;
 
@@ -318,6 +318,39 @@ static int mca_btl_tcp_component_register(void)
                                            NULL, 0, 0, OPAL_INFO_LVL_2,
                                            MCA_BASE_VAR_SCOPE_READONLY, &mca_btl_tcp_component.report_all_unfound_interfaces);
 
+    mca_btl_tcp_param_register_uint("stripes",
+                                    "Number of connections to each peer a large put is split "
+                                    "across. The additional connections are opened the first time "
+                                    "a put of at least btl_tcp_stripe_threshold bytes is issued to "
+                                    "the peer (at most 16). 1 disables striping",
+                                    1, OPAL_INFO_LVL_4, &mca_btl_tcp_component.tcp_stripes);
+    mca_btl_tcp_param_register_uint("stripe_threshold",
+                                    "Minimum size in bytes of a put to split across btl_tcp_stripes "
+                                    "connections",
+                                    1024 * 1024, OPAL_INFO_LVL_5, &mca_btl_tcp_component.tcp_stripe_threshold);
+
+#if OPAL_BTL_TCP_HAVE_IO_URING
+    mca_btl_tcp_component.tcp_io_uring = false;
+    (void) mca_base_component_var_register(&mca_btl_tcp_component.super.btl_version,
+                                           "io_uring",
+                                           "Drive connected sockets through a single io_uring "
+                                           "submission/completion ring instead of libevent and a "
+                                           "writev/readv per fragment. The operations of all peers "
+                                           "are submitted with one system call per progress call. "
+                                           "Cannot be combined with btl_tcp_progress_thread",
+                                           MCA_BASE_VAR_TYPE_BOOL,
+                                           NULL, 0, 0, OPAL_INFO_LVL_4,
+                                           MCA_BASE_VAR_SCOPE_READONLY, &mca_btl_tcp_component.tcp_io_uring);
+    mca_btl_tcp_param_register_uint("io_uring_entries",
+                                    "Number of submission queue entries of the io_uring ring",
+                                    256, OPAL_INFO_LVL_5, &mca_btl_tcp_component.tcp_io_uring_entries);
+    mca_btl_tcp_param_register_uint("io_uring_zcopy_threshold",
+                                    "Send fragments of at least this many bytes with zero-copy "
+                                    "io_uring sends (requires Linux 6.1). Pinning the pages only "
+                                    "pays off for large fragments. 0 disables zero-copy sends",
+                                    0, OPAL_INFO_LVL_5, &mca_btl_tcp_component.tcp_io_uring_zcopy_threshold);
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
+
     mca_btl_tcp_module.super.btl_exclusivity =  MCA_BTL_EXCLUSIVITY_LOW + 100;
     mca_btl_tcp_module.super.btl_eager_limit = 64*1024;
     mca_btl_tcp_module.super.btl_rndv_eager_limit = 64*1024;
@@ -466,6 +499,11 @@ static int mca_btl_tcp_component_close(void)
     }
 #endif
 
+#if OPAL_BTL_TCP_HAVE_IO_URING
+    mca_btl_tcp_uring_fini();
+    mca_btl_tcp_component.super.btl_progress = NULL;
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
+
     /* remove all pending events. Do not lock the tcp_events list as
        the event themselves will unregister during the destructor. */
     OPAL_LIST_FOREACH_SAFE(event, next, &mca_btl_tcp_component.tcp_events, mca_btl_tcp_event_t) {
@@ -1328,6 +1366,21 @@ mca_btl_base_module_t** mca_btl_tcp_component_init(int *num_btl_modules,
         return NULL;
     }
 
+#if OPAL_BTL_TCP_HAVE_IO_URING
+    /* The io_uring engine is progressed by opal_progress and not by the
+     * TCP progress thread. If the ring cannot be set up libevent keeps
+     * driving the sockets. */
+    if (mca_btl_tcp_component.tcp_io_uring) {
+        if (0 < mca_btl_tcp_progress_thread_trigger) {
+            opal_output_verbose(1, opal_btl_base_framework.framework_output,
+                                "btl:tcp: io_uring progress engine disabled, it cannot be "
+                                "combined with the progress thread");
+        } else if (OPAL_SUCCESS == mca_btl_tcp_uring_init()) {
+            mca_btl_tcp_component.super.btl_progress = mca_btl_tcp_uring_progress;
+        }
+    }
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
+
     /* Register the btl to support the progress_thread */
     if (0 < mca_btl_tcp_progress_thread_trigger) {
         for( i = 0; i < mca_btl_tcp_component.tcp_num_btls; i++) {
@@ -1420,7 +1473,7 @@ static void mca_btl_tcp_component_recv_handler(int sd, short flags, void* user)
     struct sockaddr_storage addr;
     opal_socklen_t addr_len = sizeof(addr);
     mca_btl_tcp_proc_t* btl_proc;
-    bool sockopt = true;
+    bool sockopt = true, stream;
     size_t retval, len = strlen(mca_btl_tcp_magic_id_string);
     mca_btl_tcp_endpoint_hs_msg_t hs_msg;
     struct timeval save, tv;
@@ -1483,7 +1536,11 @@ static void mca_btl_tcp_component_recv_handler(int sd, short flags, void* user)
        connecting process is a fellow Open MPI process.  See if we got
        the correct magic string. */
     guid = hs_msg.guid;
-    if (0 != strncmp(hs_msg.magic_id, mca_btl_tcp_magic_id_string, len)) {
+    /* additional connections used to stripe large puts identify
+       themselves with their own magic string */
+    stream = (0 == strncmp(hs_msg.magic_id, mca_btl_tcp_stream_magic_id_string,
+                           strlen(mca_btl_tcp_stream_magic_id_string)));
+    if (!stream && 0 != strncmp(hs_msg.magic_id, mca_btl_tcp_magic_id_string, len)) {
          const char *peer = opal_fd_get_peer_name(sd);
          opal_output_verbose(20, opal_btl_base_framework.framework_output,
                              "Peer %s send us an incorrect Open MPI magic ID string (i.e., this was not a connection from the same version of Open MPI; expected \"%s\", received \"%s\")",
@@ -1555,7 +1612,11 @@ static void mca_btl_tcp_component_recv_handler(int sd, short flags, void* user)
     }
 
     /* are there any existing peer instances willing to accept this connection */
-    (void)mca_btl_tcp_proc_accept(btl_proc, (struct sockaddr*)&addr, sd);
+    if (stream) {
+        mca_btl_tcp_proc_accept_stream(btl_proc, (struct sockaddr*)&addr, sd);
+    } else {
+        (void)mca_btl_tcp_proc_accept(btl_proc, (struct sockaddr*)&addr, sd);
+    }
 
     const char *str = opal_fd_get_peer_name(sd);
     opal_output_verbose(10, opal_btl_base_framework.framework_output,
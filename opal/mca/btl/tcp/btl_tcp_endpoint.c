@@ -70,6 +70,7 @@
  */
 
 const char mca_btl_tcp_magic_id_string[MCA_BTL_TCP_MAGIC_STRING_LENGTH] = "OPAL-TCP-BTL";
+const char mca_btl_tcp_stream_magic_id_string[MCA_BTL_TCP_MAGIC_STRING_LENGTH] = "OPAL-TCP-STREAM";
 
 /*
  * Initialize state of the endpoint instance.
@@ -87,6 +88,17 @@ static void mca_btl_tcp_endpoint_construct(mca_btl_tcp_endpoint_t* endpoint)
     endpoint->endpoint_state = MCA_BTL_TCP_CLOSED;
     endpoint->endpoint_retries = 0;
     endpoint->endpoint_nbo = false;
+    endpoint->endpoint_stream = false;
+    endpoint->endpoint_stripe_wait = false;
+#if OPAL_BTL_TCP_HAVE_IO_URING
+    endpoint->endpoint_uring = false;
+    OBJ_CONSTRUCT(&endpoint->endpoint_uring_send, mca_btl_tcp_uring_op_t);
+    OBJ_CONSTRUCT(&endpoint->endpoint_uring_recv, mca_btl_tcp_uring_op_t);
+    endpoint->endpoint_uring_send.endpoint = endpoint;
+    endpoint->endpoint_uring_send.send = true;
+    endpoint->endpoint_uring_recv.endpoint = endpoint;
+    endpoint->endpoint_uring_recv.send = false;
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
 #if MCA_BTL_TCP_ENDPOINT_CACHE
     endpoint->endpoint_cache        = NULL;
     endpoint->endpoint_cache_pos    = NULL;
@@ -104,10 +116,17 @@ static void mca_btl_tcp_endpoint_construct(mca_btl_tcp_endpoint_t* endpoint)
 static void mca_btl_tcp_endpoint_destruct(mca_btl_tcp_endpoint_t* endpoint)
 {
     mca_btl_tcp_endpoint_close(endpoint);
-    mca_btl_tcp_proc_remove(endpoint->endpoint_proc, endpoint);
+    if( !endpoint->endpoint_stream ) {
+        /* the additional connections are owned by the proc */
+        mca_btl_tcp_proc_remove(endpoint->endpoint_proc, endpoint);
+    }
     OBJ_DESTRUCT(&endpoint->endpoint_frags);
     OBJ_DESTRUCT(&endpoint->endpoint_send_lock);
     OBJ_DESTRUCT(&endpoint->endpoint_recv_lock);
+#if OPAL_BTL_TCP_HAVE_IO_URING
+    OBJ_DESTRUCT(&endpoint->endpoint_uring_send);
+    OBJ_DESTRUCT(&endpoint->endpoint_uring_recv);
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
 }
 
 OBJ_CLASS_INSTANCE(
@@ -123,6 +142,7 @@ static int  mca_btl_tcp_endpoint_start_connect(mca_btl_base_endpoint_t*);
 static void mca_btl_tcp_endpoint_connected(mca_btl_base_endpoint_t*);
 static void mca_btl_tcp_endpoint_recv_handler(int sd, short flags, void* user);
 static void mca_btl_tcp_endpoint_send_handler(int sd, short flags, void* user);
+static void mca_btl_tcp_endpoint_recv_frags(mca_btl_base_endpoint_t*);
 
 /*
  * diagnostics
@@ -362,8 +382,18 @@ int mca_btl_tcp_endpoint_send(mca_btl_base_endpoint_t* btl_endpoint, mca_btl_tcp
                 return 1;
             } else {
                 btl_endpoint->endpoint_send_frag = frag;
-                MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, true, "event_add(send) [endpoint_send]");
                 frag->base.des_flags |= MCA_BTL_DES_SEND_ALWAYS_CALLBACK;
+#if OPAL_BTL_TCP_HAVE_IO_URING
+                if (btl_endpoint->endpoint_uring) {
+                    /* queue the fragment on the ring (done above for priority
+                     * fragments), the completion drives the send handler */
+                    if (!(frag->base.des_flags & MCA_BTL_DES_FLAGS_PRIORITY)) {
+                        (void) mca_btl_tcp_frag_send(frag, btl_endpoint->endpoint_sd);
+                    }
+                    break;
+                }
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
+                MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, true, "event_add(send) [endpoint_send]");
                 MCA_BTL_TCP_ACTIVATE_EVENT(&btl_endpoint->endpoint_send_event, 0);
             }
         } else {
@@ -405,7 +435,9 @@ mca_btl_tcp_endpoint_send_connect_ack(mca_btl_base_endpoint_t* btl_endpoint)
     OPAL_PROCESS_NAME_HTON(guid);
     
     mca_btl_tcp_endpoint_hs_msg_t hs_msg;
-    opal_string_copy(hs_msg.magic_id, mca_btl_tcp_magic_id_string,
+    opal_string_copy(hs_msg.magic_id,
+                     btl_endpoint->endpoint_stream ? mca_btl_tcp_stream_magic_id_string :
+                                                     mca_btl_tcp_magic_id_string,
                      sizeof(hs_msg.magic_id));
     hs_msg.guid = guid;
     
@@ -521,6 +553,13 @@ void mca_btl_tcp_endpoint_close(mca_btl_base_endpoint_t* btl_endpoint)
     btl_endpoint->endpoint_retries++;
     MCA_BTL_TCP_ENDPOINT_DUMP(1, btl_endpoint, false, "event_del(recv) [close]");
     opal_event_del(&btl_endpoint->endpoint_recv_event);
+#if OPAL_BTL_TCP_HAVE_IO_URING
+    if( btl_endpoint->endpoint_uring ) {
+        /* the awareness was already lowered when the ring took over the
+         * socket. Get the buffers back from the kernel before releasing them */
+        mca_btl_tcp_uring_endpoint_stop(btl_endpoint);
+    } else
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
     if( mca_btl_tcp_event_base == opal_sync_event_base ) {
         /* If no progress thread then lower the awarness of the default progress engine */
         opal_progress_event_users_decrement();
@@ -596,9 +635,28 @@ static void mca_btl_tcp_endpoint_connected(mca_btl_base_endpoint_t* btl_endpoint
         if(NULL == btl_endpoint->endpoint_send_frag)
             btl_endpoint->endpoint_send_frag = (mca_btl_tcp_frag_t*)
                 opal_list_remove_first(&btl_endpoint->endpoint_frags);
-        MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, true, "event_add(send) [endpoint_connected]");
-        opal_event_add(&btl_endpoint->endpoint_send_event, 0);
+#if OPAL_BTL_TCP_HAVE_IO_URING
+        if(!mca_btl_tcp_uring_active)
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
+        {
+            MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, true, "event_add(send) [endpoint_connected]");
+            opal_event_add(&btl_endpoint->endpoint_send_event, 0);
+        }
     }
+
+#if OPAL_BTL_TCP_HAVE_IO_URING
+    if(mca_btl_tcp_uring_active) {
+        /* From now on the socket is driven by the ring: stop watching it
+         * with libevent, and lower the awarness of the default progress
+         * engine raised when the recv event was added. */
+        MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, true, "event_del(recv) [endpoint_connected:io_uring]");
+        opal_event_del(&btl_endpoint->endpoint_recv_event);
+        if( mca_btl_tcp_event_base == opal_sync_event_base ) {
+            opal_progress_event_users_decrement();
+        }
+        mca_btl_tcp_uring_endpoint_start(btl_endpoint);
+    }
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
 }
 
 
@@ -613,7 +671,9 @@ static void mca_btl_tcp_endpoint_connected(mca_btl_base_endpoint_t* btl_endpoint
  */
 static int mca_btl_tcp_endpoint_recv_connect_ack(mca_btl_base_endpoint_t* btl_endpoint)
 {
-    size_t retval, len = strlen(mca_btl_tcp_magic_id_string);;
+    const char *magic_id = btl_endpoint->endpoint_stream ? mca_btl_tcp_stream_magic_id_string :
+                                                           mca_btl_tcp_magic_id_string;
+    size_t retval, len = strlen(magic_id);
     mca_btl_tcp_proc_t* btl_proc = btl_endpoint->endpoint_proc;
     opal_process_name_t guid;
 
@@ -634,7 +694,7 @@ static int mca_btl_tcp_endpoint_recv_connect_ack(mca_btl_base_endpoint_t* btl_en
                        getpid(), "did not receive entire connect ACK from peer");
         return OPAL_ERR_BAD_PARAM;
     }
-    if (0 != strncmp(hs_msg.magic_id, mca_btl_tcp_magic_id_string, len)) {
+    if (0 != strncmp(hs_msg.magic_id, magic_id, len)) {
         opal_show_help("help-mpi-btl-tcp.txt", "server did not receive magic string",
                        true, opal_process_info.nodename,
                        getpid(), "client", hs_msg.magic_id,
@@ -913,6 +973,120 @@ static int mca_btl_tcp_endpoint_complete_connect(mca_btl_base_endpoint_t* btl_en
 }
 
 
+/*
+ * Account for a piece of a striped put. A piece received on an additional
+ * connection may complete the put the primary connection is waiting on,
+ * in which case the primary connection is resumed. Returns false if this
+ * is the piece received on the primary connection and the others have
+ * not all landed yet: nothing else can be delivered from this connection
+ * until they have, as the peer considers the put complete once it was
+ * sent and may follow up with a message relying on its data.
+ */
+
+static bool mca_btl_tcp_endpoint_stripe_received(mca_btl_base_endpoint_t* btl_endpoint,
+                                                 mca_btl_tcp_frag_t* frag)
+{
+    mca_btl_base_endpoint_t* resume;
+
+    resume = mca_btl_tcp_proc_stripe_received(btl_endpoint->endpoint_proc, frag->stripe.seq,
+                                              frag->stripe.count, btl_endpoint);
+    if( 0 != frag->stripe.count ) {
+        if( resume == btl_endpoint ) {
+            return true;
+        }
+        btl_endpoint->endpoint_stripe_wait = true;
+#if OPAL_BTL_TCP_HAVE_IO_URING
+        if( !btl_endpoint->endpoint_uring )
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
+        {
+            MCA_BTL_TCP_ENDPOINT_DUMP(10, btl_endpoint, true, "event_del(recv) [stripe_received]");
+            opal_event_del(&btl_endpoint->endpoint_recv_event);
+        }
+        return false;
+    }
+
+    if( NULL != resume ) {
+        OPAL_THREAD_LOCK(&resume->endpoint_recv_lock);
+        resume->endpoint_stripe_wait = false;
+        if( MCA_BTL_TCP_CONNECTED == resume->endpoint_state ) {
+#if OPAL_BTL_TCP_HAVE_IO_URING
+            if( !resume->endpoint_uring )
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
+            {
+                MCA_BTL_TCP_ENDPOINT_DUMP(10, resume, true, "event_add(recv) [stripe_received]");
+                opal_event_add(&resume->endpoint_recv_event, 0);
+            }
+            mca_btl_tcp_endpoint_recv_frags(resume);
+        }
+        OPAL_THREAD_UNLOCK(&resume->endpoint_recv_lock);
+    }
+    return true;
+}
+
+/*
+ * Receive and deliver the fragments available on a connected endpoint.
+ * This function should be called with the recv lock locked.
+ */
+
+static void mca_btl_tcp_endpoint_recv_frags(mca_btl_base_endpoint_t* btl_endpoint)
+{
+    mca_btl_tcp_frag_t* frag;
+
+    frag = btl_endpoint->endpoint_recv_frag;
+    if(NULL == frag) {
+        if(mca_btl_tcp_module.super.btl_max_send_size >
+           mca_btl_tcp_module.super.btl_eager_limit) {
+            MCA_BTL_TCP_FRAG_ALLOC_MAX(frag);
+        } else {
+            MCA_BTL_TCP_FRAG_ALLOC_EAGER(frag);
+        }
+
+        if(NULL == frag) {
+            return;
+        }
+        MCA_BTL_TCP_FRAG_INIT_DST(frag, btl_endpoint);
+    } else if(btl_endpoint->endpoint_stripe_wait) {
+        /* still waiting for the other pieces of a striped put */
+        return;
+    } else if(MCA_BTL_TCP_HDR_TYPE_STRIPE == frag->hdr.type && 0 == frag->iov_cnt) {
+        /* all the pieces of the striped put have landed */
+        goto frag_complete;
+    }
+
+#if MCA_BTL_TCP_ENDPOINT_CACHE
+    assert( 0 == btl_endpoint->endpoint_cache_length );
+  data_still_pending_on_endpoint:
+#endif  /* MCA_BTL_TCP_ENDPOINT_CACHE */
+    /* check for completion of non-blocking recv on the current fragment */
+    if(mca_btl_tcp_frag_recv(frag, btl_endpoint->endpoint_sd) == false) {
+        btl_endpoint->endpoint_recv_frag = frag;
+        return;
+    }
+    if(MCA_BTL_TCP_HDR_TYPE_STRIPE == frag->hdr.type &&
+       !mca_btl_tcp_endpoint_stripe_received(btl_endpoint, frag)) {
+        btl_endpoint->endpoint_recv_frag = frag;
+        return;
+    }
+  frag_complete:
+    btl_endpoint->endpoint_recv_frag = NULL;
+    if( MCA_BTL_TCP_HDR_TYPE_SEND == frag->hdr.type ) {
+        mca_btl_active_message_callback_t* reg;
+        reg = mca_btl_base_active_message_trigger + frag->hdr.base.tag;
+        reg->cbfunc(&frag->btl->super, frag->hdr.base.tag, &frag->base, reg->cbdata);
+    }
+#if MCA_BTL_TCP_ENDPOINT_CACHE
+    if( 0 != btl_endpoint->endpoint_cache_length ) {
+        /* If the cache still contain some data we can reuse the same fragment
+         * until we flush it completly.
+         */
+        MCA_BTL_TCP_FRAG_INIT_DST(frag, btl_endpoint);
+        goto data_still_pending_on_endpoint;
+    }
+#endif  /* MCA_BTL_TCP_ENDPOINT_CACHE */
+    MCA_BTL_TCP_FRAG_RETURN(frag);
+}
+
+
 /*
  * A file descriptor is available/ready for recv. Check the state
  * of the socket and take the appropriate action.
@@ -985,56 +1159,9 @@ static void mca_btl_tcp_endpoint_recv_handler(int sd, short flags, void* user)
             return;
         }
     case MCA_BTL_TCP_CONNECTED:
-        {
-            mca_btl_tcp_frag_t* frag;
-
-            frag = btl_endpoint->endpoint_recv_frag;
-            if(NULL == frag) {
-                if(mca_btl_tcp_module.super.btl_max_send_size >
-                   mca_btl_tcp_module.super.btl_eager_limit) {
-                    MCA_BTL_TCP_FRAG_ALLOC_MAX(frag);
-                } else {
-                    MCA_BTL_TCP_FRAG_ALLOC_EAGER(frag);
-                }
-
-                if(NULL == frag) {
-                    OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_recv_lock);
-                    return;
-                }
-                MCA_BTL_TCP_FRAG_INIT_DST(frag, btl_endpoint);
-            }
-
-#if MCA_BTL_TCP_ENDPOINT_CACHE
-            assert( 0 == btl_endpoint->endpoint_cache_length );
-        data_still_pending_on_endpoint:
-#endif  /* MCA_BTL_TCP_ENDPOINT_CACHE */
-            /* check for completion of non-blocking recv on the current fragment */
-            if(mca_btl_tcp_frag_recv(frag, btl_endpoint->endpoint_sd) == false) {
-                btl_endpoint->endpoint_recv_frag = frag;
-            } else {
-                btl_endpoint->endpoint_recv_frag = NULL;
-                if( MCA_BTL_TCP_HDR_TYPE_SEND == frag->hdr.type ) {
-                    mca_btl_active_message_callback_t* reg;
-                    reg = mca_btl_base_active_message_trigger + frag->hdr.base.tag;
-                    reg->cbfunc(&frag->btl->super, frag->hdr.base.tag, &frag->base, reg->cbdata);
-                }
-#if MCA_BTL_TCP_ENDPOINT_CACHE
-                if( 0 != btl_endpoint->endpoint_cache_length ) {
-                    /* If the cache still contain some data we can reuse the same fragment
-                     * until we flush it completly.
-                     */
-                    MCA_BTL_TCP_FRAG_INIT_DST(frag, btl_endpoint);
-                    goto data_still_pending_on_endpoint;
-                }
-#endif  /* MCA_BTL_TCP_ENDPOINT_CACHE */
-                MCA_BTL_TCP_FRAG_RETURN(frag);
-            }
-#if MCA_BTL_TCP_ENDPOINT_CACHE
-            assert( 0 == btl_endpoint->endpoint_cache_length );
-#endif  /* MCA_BTL_TCP_ENDPOINT_CACHE */
-            OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_recv_lock);
-            break;
-        }
+        mca_btl_tcp_endpoint_recv_frags(btl_endpoint);
+        OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_recv_lock);
+        break;
     case MCA_BTL_TCP_CLOSED:
         /* This is a thread-safety issue. As multiple threads are allowed
          * to generate events (in the lib event) we endup with several
@@ -1117,3 +1244,23 @@ static void mca_btl_tcp_endpoint_send_handler(int sd, short flags, void* user)
     }
     OPAL_THREAD_UNLOCK(&btl_endpoint->endpoint_send_lock);
 }
+
+#if OPAL_BTL_TCP_HAVE_IO_URING
+/*
+ * An io_uring operation of this endpoint completed (or has to be
+ * retried). Run the same handler libevent would have run.
+ */
+
+void mca_btl_tcp_endpoint_uring_handler(mca_btl_base_endpoint_t* btl_endpoint, int sd, bool send)
+{
+    /* the socket may have been closed since the completion was reaped */
+    if( sd != btl_endpoint->endpoint_sd )
+        return;
+
+    if( send ) {
+        mca_btl_tcp_endpoint_send_handler(sd, OPAL_EV_WRITE, btl_endpoint);
+    } else {
+        mca_btl_tcp_endpoint_recv_handler(sd, OPAL_EV_READ, btl_endpoint);
+    }
+}
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
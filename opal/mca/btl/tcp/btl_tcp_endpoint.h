@@ -23,6 +23,7 @@
 #include "opal/mca/event/event.h"
 #include "btl_tcp_frag.h"
 #include "btl_tcp.h"
+#include "btl_tcp_uring.h"
 BEGIN_C_DECLS
 
 #define MCA_BTL_TCP_ENDPOINT_CACHE 1
@@ -69,6 +70,13 @@ struct mca_btl_base_endpoint_t {
     opal_event_t                    endpoint_send_event;   /**< event for async processing of send frags */
     opal_event_t                    endpoint_recv_event;   /**< event for async processing of recv frags */
     bool                            endpoint_nbo;          /**< convert headers to network byte order? */
+    bool                            endpoint_stream;       /**< additional connection used to stripe large puts */
+    bool                            endpoint_stripe_wait;  /**< waiting for the other pieces of a striped put */
+#if OPAL_BTL_TCP_HAVE_IO_URING
+    bool                            endpoint_uring;        /**< socket is driven by the io_uring engine */
+    mca_btl_tcp_uring_op_t          endpoint_uring_send;   /**< io_uring send operation */
+    mca_btl_tcp_uring_op_t          endpoint_uring_recv;   /**< io_uring recv operation */
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
 };
 
 typedef struct mca_btl_base_endpoint_t mca_btl_base_endpoint_t;
@@ -77,6 +85,8 @@ OBJ_CLASS_DECLARATION(mca_btl_tcp_endpoint_t);
 
 /* Magic socket handshake string */
 extern const char mca_btl_tcp_magic_id_string[MCA_BTL_TCP_MAGIC_STRING_LENGTH];
+/* Magic socket handshake string of the additional connections */
+extern const char mca_btl_tcp_stream_magic_id_string[MCA_BTL_TCP_MAGIC_STRING_LENGTH];
 
 typedef struct { 
     opal_process_name_t guid;
@@ -88,6 +98,9 @@ void mca_btl_tcp_endpoint_close(mca_btl_base_endpoint_t*);
 int  mca_btl_tcp_endpoint_send(mca_btl_base_endpoint_t*, struct mca_btl_tcp_frag_t*);
 void mca_btl_tcp_endpoint_accept(mca_btl_base_endpoint_t*, struct sockaddr*, int);
 void mca_btl_tcp_endpoint_shutdown(mca_btl_base_endpoint_t*);
+#if OPAL_BTL_TCP_HAVE_IO_URING
+void mca_btl_tcp_endpoint_uring_handler(mca_btl_base_endpoint_t*, int sd, bool send);
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
 
 /*
  * Diagnostics: change this to "1" to enable the function
@@ -117,7 +117,7 @@ bool mca_btl_tcp_frag_send(mca_btl_tcp_frag_t* frag, int sd)
 
     /* non-blocking write, but continue if interrupted */
     do {
-        cnt = writev(sd, frag->iov_ptr, frag->iov_cnt);
+        cnt = MCA_BTL_TCP_WRITEV(frag->endpoint, sd, frag->iov_ptr, frag->iov_cnt);
         if(cnt < 0) {
             switch(opal_socket_errno) {
             case EINTR:
@@ -209,7 +209,7 @@ bool mca_btl_tcp_frag_recv(mca_btl_tcp_frag_t* frag, int sd)
 
     /* non-blocking read, but continue if interrupted */
     do {
-        cnt = readv(sd, frag->iov_ptr, num_vecs);
+        cnt = MCA_BTL_TCP_READV(btl_endpoint, sd, frag->iov_ptr, num_vecs);
         if( 0 < cnt ) goto advance_iov_position;
         if( cnt == 0 ) {
             if(MCA_BTL_TCP_CONNECTED == btl_endpoint->endpoint_state)
@@ -303,6 +303,20 @@ bool mca_btl_tcp_frag_recv(mca_btl_tcp_frag_t* frag, int sd)
                 goto repeat;
             }
             break;
+        case MCA_BTL_TCP_HDR_TYPE_STRIPE:
+            if(frag->iov_idx == 1) {
+                frag->iov[1].iov_base = (IOVBASE_TYPE*)&frag->stripe;
+                frag->iov[1].iov_len = sizeof(frag->stripe);
+                frag->iov_cnt++;
+                goto repeat;
+            } else if (frag->iov_idx == 2) {
+                if (btl_endpoint->endpoint_nbo) MCA_BTL_TCP_STRIPE_HDR_NTOH(frag->stripe);
+                frag->iov[2].iov_base = (IOVBASE_TYPE*)frag->stripe.dst.seg_addr.pval;
+                frag->iov[2].iov_len = frag->stripe.dst.seg_len;
+                frag->iov_cnt++;
+                goto repeat;
+            }
+            break;
         case MCA_BTL_TCP_HDR_TYPE_GET:
         default:
             break;
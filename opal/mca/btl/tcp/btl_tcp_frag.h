@@ -51,6 +51,7 @@ struct mca_btl_tcp_frag_t {
     struct mca_btl_base_endpoint_t *endpoint;
     struct mca_btl_tcp_module_t* btl;
     mca_btl_tcp_hdr_t hdr;
+    mca_btl_tcp_stripe_hdr_t stripe;
     struct iovec iov[MCA_BTL_TCP_FRAG_IOVEC_NUMBER + 1];
     struct iovec *iov_ptr;
     uint32_t iov_cnt;
@@ -34,6 +34,7 @@ BEGIN_C_DECLS
 #define MCA_BTL_TCP_HDR_TYPE_PUT  2
 #define MCA_BTL_TCP_HDR_TYPE_GET  3
 #define MCA_BTL_TCP_HDR_TYPE_FIN  4
+#define MCA_BTL_TCP_HDR_TYPE_STRIPE 5
 /* The MCA_BTL_TCP_HDR_TYPE_FIN is a special kind of message sent during normal
  * connexion closing. Before the endpoint closes the socket, it performs a
  * 1-way handshake by sending a FIN message in the socket. This lets the other
@@ -66,5 +67,34 @@ typedef struct mca_btl_tcp_hdr_t mca_btl_tcp_hdr_t;
         hdr.size = ntohl(hdr.size);   \
     } while (0)
 
+/**
+ * Follows a header of type MCA_BTL_TCP_HDR_TYPE_STRIPE. A large put can
+ * be split in pieces sent concurrently over the primary connection and
+ * the additional connections to the peer (see btl_tcp_stripes). The
+ * piece sent over the primary connection carries the number of pieces,
+ * and the data following it on that connection is not delivered before
+ * all the pieces of the put have landed.
+ */
+struct mca_btl_tcp_stripe_hdr_t {
+    mca_btl_base_segment_t dst;  /**< where the data of the piece goes */
+    uint32_t seq;                /**< put the piece belongs to */
+    uint32_t count;              /**< number of pieces, 0 on the additional connections */
+};
+typedef struct mca_btl_tcp_stripe_hdr_t mca_btl_tcp_stripe_hdr_t;
+
+#define MCA_BTL_TCP_STRIPE_HDR_HTON(hdr)  \
+    do {                                  \
+        MCA_BTL_BASE_SEGMENT_HTON(hdr.dst); \
+        hdr.seq = htonl(hdr.seq);         \
+        hdr.count = htonl(hdr.count);     \
+    } while (0)
+
+#define MCA_BTL_TCP_STRIPE_HDR_NTOH(hdr)  \
+    do {                                  \
+        MCA_BTL_BASE_SEGMENT_NTOH(hdr.dst); \
+        hdr.seq = ntohl(hdr.seq);         \
+        hdr.count = ntohl(hdr.count);     \
+    } while (0)
+
 END_C_DECLS
 #endif
@@ -57,6 +57,16 @@
 static void mca_btl_tcp_proc_construct(mca_btl_tcp_proc_t* proc);
 static void mca_btl_tcp_proc_destruct(mca_btl_tcp_proc_t* proc);
 
+/**
+ * Progress of a striped put received from the proc.
+ */
+struct mca_btl_tcp_stripe_t {
+    uint32_t received;                  /**< number of pieces received so far */
+    uint32_t count;                     /**< number of pieces, 0 until the primary piece arrived */
+    mca_btl_base_endpoint_t *endpoint;  /**< primary connection waiting for the put */
+};
+typedef struct mca_btl_tcp_stripe_t mca_btl_tcp_stripe_t;
+
 OBJ_CLASS_INSTANCE( mca_btl_tcp_proc_t,
                     opal_list_item_t,
                     mca_btl_tcp_proc_construct,
@@ -69,6 +79,11 @@ void mca_btl_tcp_proc_construct(mca_btl_tcp_proc_t* tcp_proc)
     tcp_proc->proc_addr_count     = 0;
     tcp_proc->proc_endpoints      = NULL;
     tcp_proc->proc_endpoint_count = 0;
+    tcp_proc->proc_streams        = NULL;
+    tcp_proc->proc_stream_count   = 0;
+    tcp_proc->proc_stripe_seq     = 0;
+    OBJ_CONSTRUCT(&tcp_proc->proc_stripes, opal_hash_table_t);
+    opal_hash_table_init(&tcp_proc->proc_stripes, 32);
     OBJ_CONSTRUCT(&tcp_proc->proc_lock, opal_mutex_t);
     OBJ_CONSTRUCT(&tcp_proc->btl_index_to_endpoint, opal_hash_table_t);
     opal_hash_table_init(&tcp_proc->btl_index_to_endpoint, mca_btl_tcp_component.tcp_num_btls);
@@ -80,6 +95,19 @@ void mca_btl_tcp_proc_construct(mca_btl_tcp_proc_t* tcp_proc)
 
 void mca_btl_tcp_proc_destruct(mca_btl_tcp_proc_t* tcp_proc)
 {
+    mca_btl_tcp_stripe_t *stripe;
+    uint32_t seq;
+
+    /* close the additional connections */
+    for (size_t i = 0; i < tcp_proc->proc_stream_count; i++) {
+        OBJ_RELEASE(tcp_proc->proc_streams[i]);
+    }
+    free(tcp_proc->proc_streams);
+    OPAL_HASH_TABLE_FOREACH(seq, uint32, stripe, &tcp_proc->proc_stripes) {
+        free(stripe);
+    }
+    OBJ_DESTRUCT(&tcp_proc->proc_stripes);
+
     if( NULL != tcp_proc->proc_opal ) {
         /* remove from list of all proc instances */
         OPAL_THREAD_LOCK(&mca_btl_tcp_component.tcp_lock);
@@ -544,6 +572,161 @@ int mca_btl_tcp_proc_remove(mca_btl_tcp_proc_t* btl_proc, mca_btl_base_endpoint_
     return OPAL_SUCCESS;
 }
 
+/*
+ * Create an additional connection to the same address as btl_endpoint.
+ * Called with the proc lock held.
+ */
+static mca_btl_base_endpoint_t* mca_btl_tcp_proc_stream_create(mca_btl_tcp_proc_t* btl_proc,
+                                                               mca_btl_base_endpoint_t* btl_endpoint)
+{
+    mca_btl_base_endpoint_t *stream, **streams;
+
+    streams = (mca_btl_base_endpoint_t**)realloc(btl_proc->proc_streams,
+                                                 (btl_proc->proc_stream_count + 1) * sizeof(*streams));
+    if (NULL == streams) {
+        return NULL;
+    }
+    btl_proc->proc_streams = streams;
+
+    stream = OBJ_NEW(mca_btl_tcp_endpoint_t);
+    if (NULL == stream) {
+        return NULL;
+    }
+    stream->endpoint_btl = btl_endpoint->endpoint_btl;
+    stream->endpoint_proc = btl_proc;
+    stream->endpoint_addr = btl_endpoint->endpoint_addr;
+    stream->endpoint_nbo = btl_endpoint->endpoint_nbo;
+    stream->endpoint_stream = true;
+    btl_proc->proc_streams[btl_proc->proc_stream_count++] = stream;
+    return stream;
+}
+
+/*
+ * Return up to max additional connections to the proc, opening them on
+ * first use. The new connections are established by the first send.
+ */
+size_t mca_btl_tcp_proc_get_streams(mca_btl_tcp_proc_t* btl_proc, mca_btl_base_endpoint_t* btl_endpoint,
+                                    mca_btl_base_endpoint_t** streams, size_t max)
+{
+    size_t i, count = 0;
+
+    OPAL_THREAD_LOCK(&btl_proc->proc_lock);
+    if (0 == btl_proc->proc_stream_count) {
+        for (i = 0; i < max; i++) {
+            if (NULL == mca_btl_tcp_proc_stream_create(btl_proc, btl_endpoint)) {
+                break;
+            }
+        }
+    }
+    for (i = 0; i < btl_proc->proc_stream_count && count < max; i++) {
+        if (MCA_BTL_TCP_FAILED != btl_proc->proc_streams[i]->endpoint_state) {
+            streams[count++] = btl_proc->proc_streams[i];
+        }
+    }
+    OPAL_THREAD_UNLOCK(&btl_proc->proc_lock);
+    return count;
+}
+
+static bool mca_btl_tcp_proc_addr_match(mca_btl_base_endpoint_t* btl_endpoint, struct sockaddr* addr)
+{
+    if (btl_endpoint->endpoint_addr->addr_family != addr->sa_family) {
+        return false;
+    }
+    switch (addr->sa_family) {
+    case AF_INET:
+        return 0 == memcmp(&btl_endpoint->endpoint_addr->addr_union.addr_inet,
+                           &(((struct sockaddr_in*)addr)->sin_addr),
+                           sizeof(struct in_addr));
+#if OPAL_ENABLE_IPV6
+    case AF_INET6:
+        return 0 == memcmp(&btl_endpoint->endpoint_addr->addr_union.addr_inet,
+                           &(((struct sockaddr_in6*)addr)->sin6_addr),
+                           sizeof(struct in6_addr));
+#endif
+    default:
+        return false;
+    }
+}
+
+/*
+ * The peer opened an additional connection to stripe its large puts
+ * over. Unlike the primary connections these carry no identity: any
+ * closed one can be reused, otherwise a new one is created for the
+ * module the address belongs to.
+ */
+void mca_btl_tcp_proc_accept_stream(mca_btl_tcp_proc_t* btl_proc, struct sockaddr* addr, int sd)
+{
+    mca_btl_base_endpoint_t* stream = NULL;
+    size_t i;
+
+    OPAL_THREAD_LOCK(&btl_proc->proc_lock);
+    for (i = 0; i < btl_proc->proc_stream_count; i++) {
+        if (MCA_BTL_TCP_CLOSED == btl_proc->proc_streams[i]->endpoint_state &&
+            mca_btl_tcp_proc_addr_match(btl_proc->proc_streams[i], addr)) {
+            stream = btl_proc->proc_streams[i];
+            break;
+        }
+    }
+    for (i = 0; NULL == stream && i < btl_proc->proc_endpoint_count; i++) {
+        if (mca_btl_tcp_proc_addr_match(btl_proc->proc_endpoints[i], addr)) {
+            stream = mca_btl_tcp_proc_stream_create(btl_proc, btl_proc->proc_endpoints[i]);
+            if (NULL == stream) {
+                break;
+            }
+        }
+    }
+    if (NULL == stream) {
+        OPAL_THREAD_UNLOCK(&btl_proc->proc_lock);
+        opal_output_verbose(20, opal_btl_base_framework.framework_output,
+                            "btl: tcp: dropping additional connection from %s %s",
+                            OPAL_NAME_PRINT(btl_proc->proc_opal->proc_name),
+                            opal_net_get_hostname(addr));
+        CLOSE_THE_SOCKET(sd);
+        return;
+    }
+    stream->endpoint_state = MCA_BTL_TCP_CONNECTING;
+    (void)mca_btl_tcp_endpoint_accept(stream, addr, sd);
+    OPAL_THREAD_UNLOCK(&btl_proc->proc_lock);
+}
+
+/*
+ * Account for a piece of the striped put seq received from the proc.
+ * count is the number of pieces for the piece received on the primary
+ * connection btl_endpoint, and 0 for the pieces received on additional
+ * connections. Returns the primary connection once all the pieces have
+ * been received: btl_endpoint itself if the put completed with its
+ * piece, or the connection that was left waiting for the last piece.
+ */
+mca_btl_base_endpoint_t* mca_btl_tcp_proc_stripe_received(mca_btl_tcp_proc_t* btl_proc, uint32_t seq,
+                                                          uint32_t count, mca_btl_base_endpoint_t* btl_endpoint)
+{
+    mca_btl_base_endpoint_t* resume = NULL;
+    mca_btl_tcp_stripe_t* stripe;
+
+    OPAL_THREAD_LOCK(&btl_proc->proc_lock);
+    if (OPAL_SUCCESS != opal_hash_table_get_value_uint32(&btl_proc->proc_stripes, seq, (void**)&stripe)) {
+        stripe = (mca_btl_tcp_stripe_t*)calloc(1, sizeof(*stripe));
+        if (NULL == stripe) {
+            OPAL_THREAD_UNLOCK(&btl_proc->proc_lock);
+            BTL_ERROR(("unable to track striped put %u", seq));
+            return (0 != count) ? btl_endpoint : NULL;
+        }
+        opal_hash_table_set_value_uint32(&btl_proc->proc_stripes, seq, stripe);
+    }
+    stripe->received++;
+    if (0 != count) {
+        stripe->count = count;
+        stripe->endpoint = btl_endpoint;
+    }
+    if (stripe->received == stripe->count) {
+        resume = stripe->endpoint;
+        opal_hash_table_remove_value_uint32(&btl_proc->proc_stripes, seq);
+        free(stripe);
+    }
+    OPAL_THREAD_UNLOCK(&btl_proc->proc_lock);
+    return resume;
+}
+
 /*
  * Look for an existing TCP process instance based on the globally unique
  * process identifier.
@@ -58,6 +58,18 @@ struct mca_btl_tcp_proc_t {
     opal_hash_table_t btl_index_to_endpoint;
     /**< interface match table, matches btl_index to remote addresses of type mca_btl_tcp_addr_t */
 
+    struct mca_btl_base_endpoint_t **proc_streams;
+    /**< additional connections large puts are striped over */
+
+    size_t proc_stream_count;
+    /**< number of additional connections */
+
+    opal_atomic_int32_t proc_stripe_seq;
+    /**< sequence number of the next striped put to this proc */
+
+    opal_hash_table_t proc_stripes;
+    /**< pieces received so far of the striped puts from this proc, by sequence number */
+
     opal_mutex_t proc_lock;
     /**< lock to protect against concurrent access to proc state */
 };
@@ -69,6 +81,11 @@ mca_btl_tcp_proc_t* mca_btl_tcp_proc_lookup(const opal_process_name_t* name);
 int  mca_btl_tcp_proc_insert(mca_btl_tcp_proc_t*, mca_btl_base_endpoint_t*);
 int  mca_btl_tcp_proc_remove(mca_btl_tcp_proc_t*, mca_btl_base_endpoint_t*);
 void mca_btl_tcp_proc_accept(mca_btl_tcp_proc_t*, struct sockaddr*, int);
+void mca_btl_tcp_proc_accept_stream(mca_btl_tcp_proc_t*, struct sockaddr*, int);
+size_t mca_btl_tcp_proc_get_streams(mca_btl_tcp_proc_t*, mca_btl_base_endpoint_t*,
+                                    mca_btl_base_endpoint_t**, size_t);
+mca_btl_base_endpoint_t* mca_btl_tcp_proc_stripe_received(mca_btl_tcp_proc_t*, uint32_t seq,
+                                                          uint32_t count, mca_btl_base_endpoint_t*);
 bool mca_btl_tcp_proc_tosocks(mca_btl_tcp_addr_t*, struct sockaddr_storage*);
 
 END_C_DECLS
@@ -0,0 +1,407 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#if OPAL_BTL_TCP_HAVE_IO_URING
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <liburing.h>
+
+#include "opal/mca/threads/mutex.h"
+#include "opal/util/output.h"
+#include "opal/util/proc.h"
+#include "opal/util/show_help.h"
+#include "opal/mca/btl/base/btl_base_error.h"
+
+#include "btl_tcp.h"
+#include "btl_tcp_endpoint.h"
+#include "btl_tcp_uring.h"
+
+/* the user data of a poll linked in front of an operation is the
+ * address of the operation with the low bit set */
+#define MCA_BTL_TCP_URING_POLL_TAG ((uintptr_t) 1)
+
+OBJ_CLASS_INSTANCE(mca_btl_tcp_uring_op_t, opal_list_item_t, NULL, NULL);
+
+bool mca_btl_tcp_uring_active = false;
+
+static struct io_uring mca_btl_tcp_uring;
+static opal_mutex_t mca_btl_tcp_uring_lock;
+/* operations whose completion has been reaped, or that need their
+ * handler to run again */
+static opal_list_t mca_btl_tcp_uring_ready;
+
+int mca_btl_tcp_uring_init(void)
+{
+    int rc;
+
+    rc = io_uring_queue_init(mca_btl_tcp_component.tcp_io_uring_entries, &mca_btl_tcp_uring, 0);
+    if (rc < 0) {
+        opal_show_help("help-mpi-btl-tcp.txt", "io_uring init failed",
+                       true, opal_process_info.nodename, getpid(),
+                       strerror(-rc), -rc);
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+
+    OBJ_CONSTRUCT(&mca_btl_tcp_uring_lock, opal_mutex_t);
+    OBJ_CONSTRUCT(&mca_btl_tcp_uring_ready, opal_list_t);
+    mca_btl_tcp_uring_active = true;
+
+    opal_output_verbose(10, opal_btl_base_framework.framework_output,
+                        "btl:tcp: using io_uring progress engine (%u entries, "
+                        "zero-copy threshold %u)",
+                        mca_btl_tcp_component.tcp_io_uring_entries,
+                        mca_btl_tcp_component.tcp_io_uring_zcopy_threshold);
+
+    return OPAL_SUCCESS;
+}
+
+void mca_btl_tcp_uring_fini(void)
+{
+    if (!mca_btl_tcp_uring_active) {
+        return;
+    }
+
+    mca_btl_tcp_uring_active = false;
+    io_uring_queue_exit(&mca_btl_tcp_uring);
+    OBJ_DESTRUCT(&mca_btl_tcp_uring_ready);
+    OBJ_DESTRUCT(&mca_btl_tcp_uring_lock);
+}
+
+/* must be called with the engine lock held */
+static void mca_btl_tcp_uring_queue(mca_btl_tcp_uring_op_t *op)
+{
+    if (!op->queued) {
+        op->queued = true;
+        opal_list_append(&mca_btl_tcp_uring_ready, &op->super);
+    }
+}
+
+/* must be called with the engine lock held */
+static void mca_btl_tcp_uring_dequeue(mca_btl_tcp_uring_op_t *op)
+{
+    if (op->queued) {
+        op->queued = false;
+        opal_list_remove_item(&mca_btl_tcp_uring_ready, &op->super);
+    }
+}
+
+/* get count consecutive submission queue entries, flushing the queue
+ * to the kernel if it is full.  Must be called with the engine lock
+ * held. */
+static struct io_uring_sqe *mca_btl_tcp_uring_get_sqe(unsigned count)
+{
+    if (io_uring_sq_space_left(&mca_btl_tcp_uring) < count) {
+        (void) io_uring_submit(&mca_btl_tcp_uring);
+    }
+    return io_uring_get_sqe(&mca_btl_tcp_uring);
+}
+
+/* record a completion queue entry.  Must be called with the engine
+ * lock held. */
+static void mca_btl_tcp_uring_complete(struct io_uring_cqe *cqe)
+{
+    uintptr_t data = (uintptr_t) io_uring_cqe_get_data(cqe);
+    mca_btl_tcp_uring_op_t *op;
+
+    /* cancellations and linked polls carry no result of their own: a
+     * failed poll also fails the operation linked behind it */
+    if (0 == data || (data & MCA_BTL_TCP_URING_POLL_TAG)) {
+        return;
+    }
+
+    op = (mca_btl_tcp_uring_op_t *) data;
+#ifdef IORING_CQE_F_NOTIF
+    if (cqe->flags & IORING_CQE_F_NOTIF) {
+        /* the kernel released the pages of a zero-copy send */
+        op->zcopy = false;
+        op->inflight = false;
+        op->complete = true;
+        mca_btl_tcp_uring_queue(op);
+        return;
+    }
+#endif
+
+    op->res = cqe->res;
+#ifdef IORING_CQE_F_MORE
+    if (op->zcopy && (cqe->flags & IORING_CQE_F_MORE)) {
+        /* the buffers stay pinned until the notification arrives */
+        return;
+    }
+#endif
+    op->zcopy = false;
+    op->inflight = false;
+    op->complete = true;
+    mca_btl_tcp_uring_queue(op);
+}
+
+/* must be called with the engine lock held */
+static int mca_btl_tcp_uring_reap(void)
+{
+    struct io_uring_cqe *cqe;
+    unsigned head, count = 0;
+
+    io_uring_for_each_cqe(&mca_btl_tcp_uring, head, cqe) {
+        mca_btl_tcp_uring_complete(cqe);
+        count++;
+    }
+    io_uring_cq_advance(&mca_btl_tcp_uring, count);
+
+    return count;
+}
+
+#if HAVE_DECL_IO_URING_PREP_SENDMSG_ZC
+/* large enough to be worth pinning the pages instead of copying them */
+static bool mca_btl_tcp_uring_use_zcopy(const struct iovec *iov, int iovcnt)
+{
+    unsigned int threshold = mca_btl_tcp_component.tcp_io_uring_zcopy_threshold;
+    size_t length = 0;
+    int i;
+
+    if (0 == threshold) {
+        return false;
+    }
+    for (i = 0; i < iovcnt; i++) {
+        length += iov[i].iov_len;
+    }
+    return length >= threshold;
+}
+#endif  /* HAVE_DECL_IO_URING_PREP_SENDMSG_ZC */
+
+/* queue an operation on the ring.  If poll_first is set the operation
+ * is linked behind a poll on the socket, which is used when a previous
+ * attempt reported EAGAIN.  Must be called with the engine lock
+ * held. */
+static int mca_btl_tcp_uring_post(mca_btl_tcp_uring_op_t *op, int sd, struct iovec *iov,
+                                  int iovcnt, bool poll_first)
+{
+    struct io_uring_sqe *sqe;
+
+    sqe = mca_btl_tcp_uring_get_sqe(poll_first ? 2 : 1);
+    if (NULL == sqe) {
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+    if (poll_first) {
+        io_uring_prep_poll_add(sqe, sd, op->send ? POLLOUT : POLLIN);
+        io_uring_sqe_set_data(sqe, (void *) ((uintptr_t) op | MCA_BTL_TCP_URING_POLL_TAG));
+        sqe->flags |= IOSQE_IO_LINK;
+        sqe = io_uring_get_sqe(&mca_btl_tcp_uring);
+    }
+
+    memset(&op->msg, 0, sizeof(op->msg));
+    op->msg.msg_iov = iov;
+    op->msg.msg_iovlen = iovcnt;
+
+    if (!op->send) {
+        io_uring_prep_recvmsg(sqe, sd, &op->msg, 0);
+    }
+#if HAVE_DECL_IO_URING_PREP_SENDMSG_ZC
+    else if (mca_btl_tcp_uring_use_zcopy(iov, iovcnt)) {
+        io_uring_prep_sendmsg_zc(sqe, sd, &op->msg, 0);
+        op->zcopy = true;
+    }
+#endif  /* HAVE_DECL_IO_URING_PREP_SENDMSG_ZC */
+    else {
+        io_uring_prep_sendmsg(sqe, sd, &op->msg, 0);
+    }
+    io_uring_sqe_set_data(sqe, op);
+    op->inflight = true;
+
+    return OPAL_SUCCESS;
+}
+
+static ssize_t mca_btl_tcp_uring_io(mca_btl_tcp_uring_op_t *op, int sd,
+                                    struct iovec *iov, int iovcnt)
+{
+    bool poll_first = false;
+    ssize_t res;
+
+    OPAL_THREAD_LOCK(&mca_btl_tcp_uring_lock);
+    if (op->complete) {
+        op->complete = false;
+        res = op->res;
+        if (res >= 0) {
+            OPAL_THREAD_UNLOCK(&mca_btl_tcp_uring_lock);
+            return res;
+        }
+        switch (-res) {
+        case EAGAIN:
+            /* the socket was not ready: retry once it is */
+            poll_first = true;
+            break;
+        case EINTR:
+        case ECANCELED:
+            break;
+#if HAVE_DECL_IO_URING_PREP_SENDMSG_ZC
+        case EINVAL:
+        case EOPNOTSUPP:
+            if (op->send && 0 != mca_btl_tcp_component.tcp_io_uring_zcopy_threshold) {
+                /* the kernel cannot do zero-copy sends, stop trying */
+                opal_output_verbose(10, opal_btl_base_framework.framework_output,
+                                    "btl:tcp: io_uring zero-copy sends not supported, disabling");
+                mca_btl_tcp_component.tcp_io_uring_zcopy_threshold = 0;
+                break;
+            }
+#endif  /* HAVE_DECL_IO_URING_PREP_SENDMSG_ZC */
+            /* fall through */
+        default:
+            OPAL_THREAD_UNLOCK(&mca_btl_tcp_uring_lock);
+            errno = -res;
+            return -1;
+        }
+    }
+
+    if (!op->inflight && OPAL_SUCCESS != mca_btl_tcp_uring_post(op, sd, iov, iovcnt, poll_first)) {
+        /* the ring is full even after a flush: try again on the next
+         * progress call */
+        mca_btl_tcp_uring_queue(op);
+    }
+    OPAL_THREAD_UNLOCK(&mca_btl_tcp_uring_lock);
+
+    errno = EWOULDBLOCK;
+    return -1;
+}
+
+ssize_t mca_btl_tcp_uring_writev(struct mca_btl_base_endpoint_t *endpoint, int sd,
+                                 struct iovec *iov, int iovcnt)
+{
+    return mca_btl_tcp_uring_io(&endpoint->endpoint_uring_send, sd, iov, iovcnt);
+}
+
+ssize_t mca_btl_tcp_uring_readv(struct mca_btl_base_endpoint_t *endpoint, int sd,
+                                struct iovec *iov, int iovcnt)
+{
+    return mca_btl_tcp_uring_io(&endpoint->endpoint_uring_recv, sd, iov, iovcnt);
+}
+
+void mca_btl_tcp_uring_endpoint_start(struct mca_btl_base_endpoint_t *endpoint)
+{
+    OPAL_THREAD_LOCK(&mca_btl_tcp_uring_lock);
+    endpoint->endpoint_uring = true;
+    /* let the handlers post the first receive and the pending send */
+    mca_btl_tcp_uring_queue(&endpoint->endpoint_uring_recv);
+    if (NULL != endpoint->endpoint_send_frag) {
+        mca_btl_tcp_uring_queue(&endpoint->endpoint_uring_send);
+    }
+    OPAL_THREAD_UNLOCK(&mca_btl_tcp_uring_lock);
+}
+
+void mca_btl_tcp_uring_endpoint_stop(struct mca_btl_base_endpoint_t *endpoint)
+{
+    mca_btl_tcp_uring_op_t *ops[2] = {&endpoint->endpoint_uring_send,
+                                      &endpoint->endpoint_uring_recv};
+    struct io_uring_sqe *sqe;
+    int i, rc;
+
+    OPAL_THREAD_LOCK(&mca_btl_tcp_uring_lock);
+    endpoint->endpoint_uring = false;
+
+    for (i = 0; i < 2; i++) {
+        if (!ops[i]->inflight) {
+            continue;
+        }
+        /* cancel the operation and the poll it may be linked behind */
+        sqe = mca_btl_tcp_uring_get_sqe(2);
+        if (NULL != sqe) {
+            io_uring_prep_cancel(sqe, ops[i], 0);
+            io_uring_sqe_set_data(sqe, NULL);
+        }
+        sqe = io_uring_get_sqe(&mca_btl_tcp_uring);
+        if (NULL != sqe) {
+            io_uring_prep_cancel(sqe, (void *) ((uintptr_t) ops[i] | MCA_BTL_TCP_URING_POLL_TAG), 0);
+            io_uring_sqe_set_data(sqe, NULL);
+        }
+    }
+
+    /* the buffers belong to the kernel until the completions (and the
+     * notifications of zero-copy sends) have been reaped */
+    while (ops[0]->inflight || ops[1]->inflight) {
+        rc = io_uring_submit_and_wait(&mca_btl_tcp_uring, 1);
+        if (rc < 0 && -EINTR != rc) {
+            BTL_ERROR(("io_uring_submit_and_wait failed: %s (%d)", strerror(-rc), -rc));
+            break;
+        }
+        mca_btl_tcp_uring_reap();
+    }
+
+    for (i = 0; i < 2; i++) {
+        ops[i]->complete = false;
+        mca_btl_tcp_uring_dequeue(ops[i]);
+    }
+    OPAL_THREAD_UNLOCK(&mca_btl_tcp_uring_lock);
+}
+
+int mca_btl_tcp_uring_progress(void)
+{
+    mca_btl_tcp_uring_op_t *op;
+    mca_btl_base_endpoint_t *endpoint;
+    size_t count, i;
+    int sd;
+
+    if (OPAL_THREAD_TRYLOCK(&mca_btl_tcp_uring_lock)) {
+        return 0;
+    }
+
+    /* a single system call hands the operations queued since the last
+     * call, for all endpoints, over to the kernel */
+    if (io_uring_sq_ready(&mca_btl_tcp_uring)) {
+        (void) io_uring_submit(&mca_btl_tcp_uring);
+    }
+    mca_btl_tcp_uring_reap();
+
+    /* operations requeued by the handlers are run on the next call */
+    count = opal_list_get_size(&mca_btl_tcp_uring_ready);
+    for (i = 0; i < count; i++) {
+        op = (mca_btl_tcp_uring_op_t *) opal_list_remove_first(&mca_btl_tcp_uring_ready);
+        if (NULL == op) {
+            break;
+        }
+        op->queued = false;
+        endpoint = op->endpoint;
+        sd = endpoint->endpoint_sd;
+        if (!endpoint->endpoint_uring) {
+            continue;
+        }
+        OPAL_THREAD_UNLOCK(&mca_btl_tcp_uring_lock);
+
+        mca_btl_tcp_endpoint_uring_handler(endpoint, sd, op->send);
+        if (!op->send && !op->inflight && !op->complete) {
+            /* the handler completed a fragment without draining the
+             * socket: post the receive for the next one right away */
+            mca_btl_tcp_endpoint_uring_handler(endpoint, sd, false);
+        }
+
+        OPAL_THREAD_LOCK(&mca_btl_tcp_uring_lock);
+        if (!endpoint->endpoint_uring || op->inflight ||
+            MCA_BTL_TCP_CONNECTED != endpoint->endpoint_state) {
+            continue;
+        }
+        /* the handler could not take the endpoint lock, or could not
+         * post the next operation: try again on the next call */
+        if (op->complete || !op->send || NULL != endpoint->endpoint_send_frag) {
+            mca_btl_tcp_uring_queue(op);
+        }
+    }
+
+    /* hand the operations posted by the handlers to the kernel */
+    if (io_uring_sq_ready(&mca_btl_tcp_uring)) {
+        (void) io_uring_submit(&mca_btl_tcp_uring);
+    }
+    OPAL_THREAD_UNLOCK(&mca_btl_tcp_uring_lock);
+
+    return (int) count;
+}
+
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
@@ -0,0 +1,126 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/**
+ * @file
+ *
+ * Optional io_uring progress engine for the TCP BTL.
+ *
+ * Once a connection is established the socket stops being watched by
+ * libevent.  Instead every endpoint keeps at most one send and one
+ * receive operation queued on a single ring shared by all endpoints.
+ * The operations are handed to the kernel with one io_uring_submit()
+ * per call to the component progress function, and the completions are
+ * reaped from the completion queue without any system call.  The
+ * fragment state machines in btl_tcp_frag.c are unchanged: the
+ * writev()/readv() calls they issue are redirected to the ring and
+ * report EWOULDBLOCK until the matching completion has been reaped,
+ * at which point the regular send and receive handlers are invoked
+ * again and pick up the result.
+ */
+#ifndef MCA_BTL_TCP_URING_H
+#define MCA_BTL_TCP_URING_H
+
+#include "opal_config.h"
+
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+
+#include "opal/class/opal_list.h"
+
+BEGIN_C_DECLS
+
+#if OPAL_BTL_TCP_HAVE_IO_URING
+
+struct mca_btl_base_endpoint_t;
+
+/**
+ * One direction (send or receive) of an endpoint driven by the ring.
+ * All fields but the iovec state are protected by the engine lock.
+ */
+struct mca_btl_tcp_uring_op_t {
+    opal_list_item_t super;                     /**< link in the list of ready operations */
+    struct mca_btl_base_endpoint_t *endpoint;   /**< endpoint owning this operation */
+    struct msghdr msg;                          /**< message header handed to the kernel */
+    ssize_t res;                                /**< result of the last completed operation */
+    bool send;                                  /**< direction of the operation */
+    bool inflight;                              /**< the kernel still owns the buffers */
+    bool complete;                              /**< res holds a result not consumed yet */
+    bool queued;                                /**< on the list of ready operations */
+    bool zcopy;                                 /**< in-flight operation is a zero-copy send */
+};
+typedef struct mca_btl_tcp_uring_op_t mca_btl_tcp_uring_op_t;
+OBJ_CLASS_DECLARATION(mca_btl_tcp_uring_op_t);
+
+/** true once the ring has been set up by the component */
+extern bool mca_btl_tcp_uring_active;
+
+/**
+ * Set up the shared ring.  On failure the TCP BTL keeps using libevent.
+ */
+int mca_btl_tcp_uring_init(void);
+
+/**
+ * Tear down the shared ring.  All endpoints must have been stopped.
+ */
+void mca_btl_tcp_uring_fini(void);
+
+/**
+ * Component progress function: submit the queued operations, reap the
+ * completions and run the handlers of the endpoints they belong to.
+ */
+int mca_btl_tcp_uring_progress(void);
+
+/**
+ * Hand a connected endpoint over to the ring.  A receive is posted and
+ * the pending send, if any, is started on the next progress call.
+ * Called with the endpoint send lock held.
+ */
+void mca_btl_tcp_uring_endpoint_start(struct mca_btl_base_endpoint_t *endpoint);
+
+/**
+ * Cancel the operations of an endpoint and wait until the kernel has
+ * released their buffers.  Called before the socket is closed.
+ */
+void mca_btl_tcp_uring_endpoint_stop(struct mca_btl_base_endpoint_t *endpoint);
+
+/**
+ * Ring counterparts of writev() and readv(): return the result of the
+ * completed operation if there is one, otherwise queue the operation
+ * (unless one is already in flight) and fail with EWOULDBLOCK.  The
+ * caller has to pass the same iovecs again when the handler is
+ * invoked for the completion.
+ */
+ssize_t mca_btl_tcp_uring_writev(struct mca_btl_base_endpoint_t *endpoint, int sd,
+                                 struct iovec *iov, int iovcnt);
+ssize_t mca_btl_tcp_uring_readv(struct mca_btl_base_endpoint_t *endpoint, int sd,
+                                struct iovec *iov, int iovcnt);
+
+#define MCA_BTL_TCP_WRITEV(endpoint, sd, iov, iovcnt)                    \
+    ((endpoint)->endpoint_uring ?                                       \
+     mca_btl_tcp_uring_writev((endpoint), (sd), (iov), (iovcnt)) :      \
+     writev((sd), (iov), (iovcnt)))
+#define MCA_BTL_TCP_READV(endpoint, sd, iov, iovcnt)                     \
+    ((endpoint)->endpoint_uring ?                                       \
+     mca_btl_tcp_uring_readv((endpoint), (sd), (iov), (iovcnt)) :       \
+     readv((sd), (iov), (iovcnt)))
+
+#else
+
+#define MCA_BTL_TCP_WRITEV(endpoint, sd, iov, iovcnt) writev((sd), (iov), (iovcnt))
+#define MCA_BTL_TCP_READV(endpoint, sd, iov, iovcnt)  readv((sd), (iov), (iovcnt))
+
+#endif  /* OPAL_BTL_TCP_HAVE_IO_URING */
+
+END_C_DECLS
+
+#endif  /* MCA_BTL_TCP_URING_H */
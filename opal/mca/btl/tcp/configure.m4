@@ -37,4 +37,16 @@ AC_DEFUN([MCA_opal_btl_tcp_CONFIG],[
 #endif
 		   ])
     OPAL_SUMMARY_ADD([[Transports]],[[TCP]],[[btl_tcp]],[$opal_btl_tcp_happy])
+
+    # optional io_uring progress engine
+    OPAL_VAR_SCOPE_PUSH([btl_tcp_io_uring_happy])
+    OPAL_CHECK_LIBURING([btl_tcp], [btl_tcp_io_uring_happy=1], [btl_tcp_io_uring_happy=0])
+    AC_DEFINE_UNQUOTED([OPAL_BTL_TCP_HAVE_IO_URING], [$btl_tcp_io_uring_happy],
+        [If the io_uring progress engine can be enabled within the TCP BTL])
+    OPAL_VAR_SCOPE_POP
+
+    # substitute in the things needed to build with io_uring support
+    AC_SUBST([btl_tcp_CPPFLAGS])
+    AC_SUBST([btl_tcp_LDFLAGS])
+    AC_SUBST([btl_tcp_LIBS])
 ])dnl
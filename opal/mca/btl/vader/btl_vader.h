@@ -58,6 +58,7 @@
 #include "opal/mca/rcache/base/base.h"
 #include "opal/mca/btl/base/btl_base_error.h"
 #include "opal/mca/mpool/base/base.h"
+#include "opal/mca/memcpy/base/base.h"
 #include "opal/util/proc.h"
 #include "btl_vader_endpoint.h"
 
@@ -128,11 +129,20 @@ struct mca_btl_vader_component_t {
     opal_free_list_t vader_frags_eager;     /**< free list of vader send frags */
     opal_free_list_t vader_frags_max_send;  /**< free list of vader max send frags (large fragments) */
     opal_free_list_t vader_frags_user;      /**< free list of small inline frags */
-    opal_free_list_t vader_fboxes;          /**< free list of available fast-boxes */
+    char *fbox_pool;                        /**< memory of all send fast boxes (fbox_max units of fbox_size bytes) */
+    unsigned char *fbox_pool_free;          /**< per unit of fbox_pool: 1 + size class of the free block starting there, 0 otherwise */
+    unsigned int fbox_pool_units;           /**< size of fbox_pool in units of fbox_size (fbox_max at startup) */
 
     unsigned int fbox_threshold;            /**< number of sends required before we setup a send fast box for a peer */
-    unsigned int fbox_max;                  /**< maximum number of send fast boxes to allocate */
-    unsigned int fbox_size;                 /**< size of each peer fast box allocation */
+    unsigned int fbox_max;                  /**< maximum number of fbox_size units of send fast boxes in use */
+    unsigned int fbox_size;                 /**< size of a newly allocated peer fast box */
+    unsigned int fbox_max_size;             /**< largest size the fast box of a busy peer may grow to */
+    unsigned int fbox_num_classes;          /**< number of fast box sizes (fbox_size .. fbox_max_size) */
+    unsigned int fbox_window;               /**< number of fast box sends between growth decisions */
+    unsigned int fbox_idle;                 /**< progress calls without sends before a fast box is reclaimed */
+    unsigned int fbox_units;                /**< fbox_size units of send fast boxes currently in use */
+    uint64_t fbox_clock;                    /**< number of calls to the progress function */
+    bool fbox_adapt_pending;                /**< some endpoint asked for its fast box to be grown */
 
     int single_copy_mechanism;              /**< single copy mechanism to use */
 
@@ -187,7 +197,7 @@ OPAL_MODULE_DECLSPEC extern mca_btl_vader_t mca_btl_vader;
 static inline void vader_memmove (void *dst, void *src, size_t size)
 {
     if (size >= (size_t) mca_btl_vader_component.memcpy_limit) {
-        memcpy (dst, src, size);
+        opal_memcpy (dst, src, size);
     } else {
         memmove (dst, src, size);
     }
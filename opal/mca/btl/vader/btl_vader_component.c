@@ -59,6 +59,9 @@
 #endif
 
 static int mca_btl_vader_component_progress (void);
+static int mca_btl_vader_fbox_pvar_read (const struct mca_base_pvar_t *pvar, void *value, void *obj);
+static int mca_btl_vader_fbox_pvar_notify (struct mca_base_pvar_t *pvar, mca_base_pvar_event_t event,
+                                           void *obj, int *count);
 static int mca_btl_vader_component_open(void);
 static int mca_btl_vader_component_close(void);
 static int mca_btl_vader_component_register(void);
@@ -193,7 +196,9 @@ static int mca_btl_vader_component_register (void)
     mca_btl_vader_component.fbox_max = 32;
     (void) mca_base_component_var_register(&mca_btl_vader_component.super.btl_version,
                                            "fbox_max", "Maximum number of eager send buffers "
-                                           "to allocate (default: 32)", MCA_BASE_VAR_TYPE_UNSIGNED_INT,
+                                           "to allocate, counted in units of fbox_size (a fast box "
+                                           "grown to four times fbox_size counts four times) "
+                                           "(default: 32)", MCA_BASE_VAR_TYPE_UNSIGNED_INT,
                                            NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE, OPAL_INFO_LVL_5,
                                            MCA_BASE_VAR_SCOPE_LOCAL, &mca_btl_vader_component.fbox_max);
 
@@ -203,6 +208,55 @@ static int mca_btl_vader_component_register (void)
                                            MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
                                            OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL, &mca_btl_vader_component.fbox_size);
 
+    mca_btl_vader_component.fbox_max_size = 65536;
+    (void) mca_base_component_var_register(&mca_btl_vader_component.super.btl_version,
+                                           "fbox_max_size", "Size up to which the fast transfer buffer "
+                                           "of a peer is doubled when messages to it often do not fit. "
+                                           "Set to fbox_size to disable growing (default: 64k)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                           OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL, &mca_btl_vader_component.fbox_max_size);
+
+    mca_btl_vader_component.fbox_window = 256;
+    (void) mca_base_component_var_register(&mca_btl_vader_component.super.btl_version,
+                                           "fbox_window", "Number of sends to a peer over which the fast "
+                                           "transfer buffer usage is evaluated. The buffer is grown if more "
+                                           "than 1/8th of them did not fit (default: 256)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                           OPAL_INFO_LVL_6, MCA_BASE_VAR_SCOPE_LOCAL, &mca_btl_vader_component.fbox_window);
+
+    mca_btl_vader_component.fbox_idle = 1 << 20;
+    (void) mca_base_component_var_register(&mca_btl_vader_component.super.btl_version,
+                                           "fbox_idle", "Number of calls to the progress function without "
+                                           "sends to a peer after which its fast transfer buffer is released. "
+                                           "Grown buffers return to fbox_size after a quarter of this. "
+                                           "0 never releases buffers (default: 1M)",
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                           OPAL_INFO_LVL_6, MCA_BASE_VAR_SCOPE_LOCAL, &mca_btl_vader_component.fbox_idle);
+
+    /* fast box statistics. each is an array indexed by the local rank of the peer */
+    (void) mca_base_component_pvar_register (&mca_btl_vader_component.super.btl_version, "fbox_hits",
+                                             "Number of messages sent to each local peer through its fast "
+                                             "transfer buffer", OPAL_INFO_LVL_5, MCA_BASE_PVAR_CLASS_COUNTER,
+                                             MCA_BASE_VAR_TYPE_UNSIGNED_LONG, NULL, MCA_BASE_VAR_BIND_NO_OBJECT,
+                                             MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                             mca_btl_vader_fbox_pvar_read, NULL, mca_btl_vader_fbox_pvar_notify,
+                                             (void *) (intptr_t) 0);
+    (void) mca_base_component_pvar_register (&mca_btl_vader_component.super.btl_version, "fbox_fallbacks",
+                                             "Number of messages sent to each local peer through the shared "
+                                             "fifo because they did not fit in a fast transfer buffer",
+                                             OPAL_INFO_LVL_5, MCA_BASE_PVAR_CLASS_COUNTER,
+                                             MCA_BASE_VAR_TYPE_UNSIGNED_LONG, NULL, MCA_BASE_VAR_BIND_NO_OBJECT,
+                                             MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                             mca_btl_vader_fbox_pvar_read, NULL, mca_btl_vader_fbox_pvar_notify,
+                                             (void *) (intptr_t) 1);
+    (void) mca_base_component_pvar_register (&mca_btl_vader_component.super.btl_version, "fbox_size",
+                                             "Current size of the fast transfer buffer to each local peer "
+                                             "(0 if there is none)", OPAL_INFO_LVL_5, MCA_BASE_PVAR_CLASS_LEVEL,
+                                             MCA_BASE_VAR_TYPE_UNSIGNED_LONG, NULL, MCA_BASE_VAR_BIND_NO_OBJECT,
+                                             MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                             mca_btl_vader_fbox_pvar_read, NULL, mca_btl_vader_fbox_pvar_notify,
+                                             (void *) (intptr_t) 2);
+
     (void) mca_base_var_enum_create ("btl_vader_single_copy_mechanisms", single_copy_mechanisms, &new_enum);
 
     /* Default to the best available mechanism (see the enumerator for ordering) */
@@ -310,7 +364,9 @@ static int mca_btl_vader_component_open(void)
     OBJ_CONSTRUCT(&mca_btl_vader_component.vader_frags_eager, opal_free_list_t);
     OBJ_CONSTRUCT(&mca_btl_vader_component.vader_frags_user, opal_free_list_t);
     OBJ_CONSTRUCT(&mca_btl_vader_component.vader_frags_max_send, opal_free_list_t);
-    OBJ_CONSTRUCT(&mca_btl_vader_component.vader_fboxes, opal_free_list_t);
+    mca_btl_vader_component.fbox_pool = NULL;
+    mca_btl_vader_component.fbox_pool_free = NULL;
+    mca_btl_vader_component.fbox_pool_units = 0;
     OBJ_CONSTRUCT(&mca_btl_vader_component.lock, opal_mutex_t);
     OBJ_CONSTRUCT(&mca_btl_vader_component.pending_endpoints, opal_list_t);
     OBJ_CONSTRUCT(&mca_btl_vader_component.pending_fragments, opal_list_t);
@@ -331,7 +387,10 @@ static int mca_btl_vader_component_close(void)
     OBJ_DESTRUCT(&mca_btl_vader_component.vader_frags_eager);
     OBJ_DESTRUCT(&mca_btl_vader_component.vader_frags_user);
     OBJ_DESTRUCT(&mca_btl_vader_component.vader_frags_max_send);
-    OBJ_DESTRUCT(&mca_btl_vader_component.vader_fboxes);
+    free (mca_btl_vader_component.fbox_pool_free);
+    mca_btl_vader_component.fbox_pool_free = NULL;
+    mca_btl_vader_component.fbox_pool_units = 0;
+    mca_btl_vader_component.fbox_pool = NULL;
     OBJ_DESTRUCT(&mca_btl_vader_component.lock);
     OBJ_DESTRUCT(&mca_btl_vader_component.pending_endpoints);
     OBJ_DESTRUCT(&mca_btl_vader_component.pending_fragments);
@@ -553,6 +612,23 @@ static mca_btl_base_module_t **mca_btl_vader_component_init (int *num_btls,
 
     component->fbox_size = (component->fbox_size + MCA_BTL_VADER_FBOX_ALIGNMENT_MASK) & ~MCA_BTL_VADER_FBOX_ALIGNMENT_MASK;
 
+    /* fast boxes grow by doubling from fbox_size up to fbox_max_size */
+    component->fbox_num_classes = 1;
+    while (component->fbox_num_classes < MCA_BTL_VADER_FBOX_MAX_CLASSES &&
+           (component->fbox_size << component->fbox_num_classes) <= component->fbox_max_size) {
+        ++component->fbox_num_classes;
+    }
+    component->fbox_max_size = component->fbox_size << (component->fbox_num_classes - 1);
+    if (0 == component->fbox_window) {
+        component->fbox_window = 1;
+    }
+    if (0 == component->fbox_idle) {
+        component->fbox_idle = UINT_MAX;
+    }
+    component->fbox_units = 0;
+    component->fbox_clock = 0;
+    component->fbox_adapt_pending = false;
+
     if (component->segment_size > (1ul << MCA_BTL_VADER_OFFSET_BITS)) {
         component->segment_size = 2ul << MCA_BTL_VADER_OFFSET_BITS;
     }
@@ -630,6 +706,31 @@ failed:
     return NULL;
 }
 
+/* start, switch or stop polling the fast box the peer set up for us */
+static void mca_btl_vader_fbox_setup_recv (struct mca_btl_base_endpoint_t *endpoint, mca_btl_vader_hdr_t *hdr)
+{
+    mca_btl_vader_component_t *component = &mca_btl_vader_component;
+    const bool polled = NULL != endpoint->fbox_in.buffer;
+
+    if (0 == hdr->fbox_size) {
+        /* the peer released its fast box */
+        endpoint->fbox_in.buffer = NULL;
+        for (unsigned int i = 0 ; i < component->num_fbox_in_endpoints ; ++i) {
+            if (component->fbox_in_endpoints[i] == endpoint) {
+                component->fbox_in_endpoints[i] = component->fbox_in_endpoints[--component->num_fbox_in_endpoints];
+                break;
+            }
+        }
+
+        return;
+    }
+
+    mca_btl_vader_endpoint_setup_fbox_recv (endpoint, relative2virtual(hdr->fbox_base), hdr->fbox_size);
+    if (!polled) {
+        component->fbox_in_endpoints[component->num_fbox_in_endpoints++] = endpoint;
+    }
+}
+
 void mca_btl_vader_poll_handle_frag (mca_btl_vader_hdr_t *hdr, struct mca_btl_base_endpoint_t *endpoint)
 {
     mca_btl_base_segment_t segments[2];
@@ -641,6 +742,14 @@ void mca_btl_vader_poll_handle_frag (mca_btl_vader_hdr_t *hdr, struct mca_btl_ba
         return;
     }
 
+    if (OPAL_UNLIKELY(MCA_BTL_VADER_FLAG_FBOX_CONTROL & hdr->flags)) {
+        /* no payload. the peer switched to another fast box (or released it) */
+        mca_btl_vader_fbox_setup_recv (endpoint, hdr);
+        hdr->flags = MCA_BTL_VADER_FLAG_COMPLETE;
+        vader_fifo_write_back (hdr, endpoint);
+        return;
+    }
+
     reg = mca_btl_base_active_message_trigger + hdr->tag;
     segments[0].seg_addr.pval = (void *) (hdr + 1);
     segments[0].seg_len       = hdr->len;
@@ -664,8 +773,7 @@ void mca_btl_vader_poll_handle_frag (mca_btl_vader_hdr_t *hdr, struct mca_btl_ba
     }
 
     if (OPAL_UNLIKELY(MCA_BTL_VADER_FLAG_SETUP_FBOX & hdr->flags)) {
-        mca_btl_vader_endpoint_setup_fbox_recv (endpoint, relative2virtual(hdr->fbox_base));
-        mca_btl_vader_component.fbox_in_endpoints[mca_btl_vader_component.num_fbox_in_endpoints++] = endpoint;
+        mca_btl_vader_fbox_setup_recv (endpoint, hdr);
     }
 
     hdr->flags = MCA_BTL_VADER_FLAG_COMPLETE;
@@ -757,6 +865,12 @@ static int mca_btl_vader_component_progress (void)
         }
     }
 
+    /* grow, shrink or release send fast boxes */
+    if (OPAL_UNLIKELY(0 == (++mca_btl_vader_component.fbox_clock & MCA_BTL_VADER_FBOX_SWEEP_MASK) ||
+                      mca_btl_vader_component.fbox_adapt_pending)) {
+        mca_btl_vader_fbox_adapt ();
+    }
+
     /* check for messages in fast boxes */
     if (mca_btl_vader_component.num_fbox_in_endpoints) {
         count = mca_btl_vader_check_fboxes ();
@@ -775,3 +889,43 @@ static int mca_btl_vader_component_progress (void)
 
     return count;
 }
+
+static int mca_btl_vader_fbox_pvar_notify (struct mca_base_pvar_t *pvar, mca_base_pvar_event_t event,
+                                           void *obj, int *count)
+{
+    if (MCA_BASE_PVAR_HANDLE_BIND == event) {
+        /* one value per local process (including this one) */
+        *count = 1 + MCA_BTL_VADER_NUM_LOCAL_PEERS;
+    }
+
+    return OPAL_SUCCESS;
+}
+
+static int mca_btl_vader_fbox_pvar_read (const struct mca_base_pvar_t *pvar, void *value, void *obj)
+{
+    mca_btl_vader_component_t *component = &mca_btl_vader_component;
+    unsigned long *values = (unsigned long *) value;
+    const int count = 1 + MCA_BTL_VADER_NUM_LOCAL_PEERS;
+
+    for (int i = 0 ; i < count ; ++i) {
+        mca_btl_base_endpoint_t *ep = component->endpoints ? component->endpoints + i : NULL;
+
+        if (NULL == ep || NULL == ep->fifo) {
+            values[i] = 0;
+            continue;
+        }
+
+        switch ((intptr_t) pvar->ctx) {
+        case 0:
+            values[i] = (unsigned long) ep->fbox_out.hits;
+            break;
+        case 1:
+            values[i] = (unsigned long) ep->fbox_out.fallbacks;
+            break;
+        default:
+            values[i] = ep->fbox_out.buffer ? ep->fbox_out.size : 0;
+        }
+    }
+
+    return OPAL_SUCCESS;
+}
@@ -34,6 +34,9 @@
 #define MCA_BTL_VADER_FBOX_ALIGNMENT      32
 #define MCA_BTL_VADER_FBOX_ALIGNMENT_MASK (MCA_BTL_VADER_FBOX_ALIGNMENT - 1)
 
+/* fast boxes come in power of two multiples of fbox_size */
+#define MCA_BTL_VADER_FBOX_MAX_CLASSES    8
+
 struct vader_fifo_t;
 
 /**
@@ -52,6 +55,7 @@ typedef struct mca_btl_base_endpoint_t {
         unsigned char *buffer; /**< starting address of peer's fast box out */
         uint32_t *startp;
         unsigned int start;
+        unsigned int size;     /**< size of the peer's fast box */
         uint16_t seq;
     } fbox_in;
 
@@ -59,8 +63,18 @@ typedef struct mca_btl_base_endpoint_t {
         unsigned char *buffer; /**< starting address of peer's fast box in */
         uint32_t *startp;      /**< pointer to location storing start offset */
         unsigned int start, end;
+        unsigned int size;     /**< size of the fast box */
+        unsigned int size_class; /**< log2 (size / fbox_size) */
         uint16_t seq;
-        opal_free_list_item_t *fbox; /**< fast-box free list item */
+        void *fbox;            /**< fast box memory (from the fast box pool) */
+        void *retired;         /**< fast box being handed back by the peer (if any) */
+        unsigned int retired_class; /**< size class of the retired fast box */
+        uint64_t last_use;     /**< progress clock at the last fast box send */
+        unsigned int window_sends;  /**< fast box send attempts in the current window */
+        unsigned int window_misses; /**< attempts that did not fit in the current window */
+        bool grow;             /**< the fast box should be grown at the next opportunity */
+        size_t hits;           /**< messages delivered through the fast box */
+        opal_atomic_size_t fallbacks; /**< messages delivered through the fifo */
     } fbox_out;
 
     int32_t peer_smp_rank;  /**< my peer's SMP process rank.  Used for accessing
@@ -96,20 +110,27 @@ typedef mca_btl_base_endpoint_t mca_btl_vader_endpoint_t;
 
 OBJ_CLASS_DECLARATION(mca_btl_vader_endpoint_t);
 
-static inline void mca_btl_vader_endpoint_setup_fbox_recv (struct mca_btl_base_endpoint_t *endpoint, void *base)
+static inline void mca_btl_vader_endpoint_setup_fbox_recv (struct mca_btl_base_endpoint_t *endpoint, void *base,
+                                                           unsigned int size)
 {
     endpoint->fbox_in.startp = (uint32_t *) base;
     endpoint->fbox_in.start = MCA_BTL_VADER_FBOX_ALIGNMENT;
+    endpoint->fbox_in.size = size;
     endpoint->fbox_in.seq = 0;
     opal_atomic_wmb ();
     endpoint->fbox_in.buffer = base;
 }
 
-static inline void mca_btl_vader_endpoint_setup_fbox_send (struct mca_btl_base_endpoint_t *endpoint, opal_free_list_item_t *fbox)
+static inline void mca_btl_vader_endpoint_setup_fbox_send (struct mca_btl_base_endpoint_t *endpoint, void *fbox,
+                                                           unsigned int size_class, unsigned int size)
 {
-    void *base = fbox->ptr;
+    void *base = fbox;
 
     endpoint->fbox_out.start = MCA_BTL_VADER_FBOX_ALIGNMENT;
+    endpoint->fbox_out.size = size;
+    endpoint->fbox_out.size_class = size_class;
+    endpoint->fbox_out.window_sends = endpoint->fbox_out.window_misses = 0;
+    endpoint->fbox_out.grow = false;
     endpoint->fbox_out.end = MCA_BTL_VADER_FBOX_ALIGNMENT;
     endpoint->fbox_out.startp = (uint32_t *) base;
     endpoint->fbox_out.startp[0] = MCA_BTL_VADER_FBOX_ALIGNMENT;
@@ -0,0 +1,282 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <assert.h>
+
+#include "btl_vader.h"
+#include "btl_vader_frag.h"
+#include "btl_vader_fifo.h"
+#include "btl_vader_fbox.h"
+
+/*
+ * Fast boxes are handed out to peers after fbox_threshold sends and
+ * then adapted to the traffic: a peer whose messages regularly do not
+ * fit gets a bigger fast box (up to fbox_max_size), a peer that has
+ * not been sent to for a while goes back to the initial size and is
+ * eventually released. All fast boxes in use share a budget of
+ * fbox_max units of fbox_size bytes.
+ *
+ * The budget is a single region of fbox_max units taken from the segment
+ * at startup and managed as a buddy allocator: a fast box of size class
+ * c is a block of 2^c units starting at a multiple of 2^c units. Bigger
+ * blocks are split on demand and free buddies are merged again, so the
+ * memory released by idle peers can be reused for any size and the fast
+ * boxes never use more than fbox_max * fbox_size bytes of the segment.
+ *
+ * The sender owns the fast box memory. To switch to another fast box
+ * (or to none) it posts a control fragment through the current fast
+ * box so the receiver sees the switch in order with the messages
+ * before and after it. The old fast box is reused once the receiver
+ * returns the control fragment.
+ */
+
+int mca_btl_vader_fbox_pool_init (void)
+{
+    mca_btl_vader_component_t *component = &mca_btl_vader_component;
+    const unsigned int units = component->fbox_max;
+    unsigned int unit = 0, size_class;
+
+    component->fbox_units = 0;
+    component->fbox_pool_units = 0;
+    if (0 == units) {
+        return OPAL_SUCCESS;
+    }
+
+    component->fbox_pool_free = calloc (units, 1);
+    if (NULL == component->fbox_pool_free) {
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    component->fbox_pool = component->mpool->mpool_alloc (component->mpool, (size_t) units * component->fbox_size,
+                                                          opal_cache_line_size, 0);
+    if (NULL == component->fbox_pool) {
+        free (component->fbox_pool_free);
+        component->fbox_pool_free = NULL;
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    component->fbox_pool_units = units;
+
+    /* cover the region with the largest aligned blocks that fit */
+    while (unit < units) {
+        size_class = component->fbox_num_classes - 1;
+        while (size_class && ((unit & ((1u << size_class) - 1)) || unit + (1u << size_class) > units)) {
+            --size_class;
+        }
+        component->fbox_pool_free[unit] = (unsigned char) (size_class + 1);
+        unit += 1u << size_class;
+    }
+
+    return OPAL_SUCCESS;
+}
+
+void *mca_btl_vader_fbox_pool_get (unsigned int size_class)
+{
+    mca_btl_vader_component_t *component = &mca_btl_vader_component;
+    const unsigned int units = component->fbox_pool_units;
+    unsigned int unit, best = units, best_class = 0;
+
+    /* smallest free block that is large enough */
+    for (unit = 0 ; unit < units ; ++unit) {
+        unsigned int block_class;
+
+        if (0 == component->fbox_pool_free[unit]) {
+            continue;
+        }
+
+        block_class = component->fbox_pool_free[unit] - 1;
+        if (block_class >= size_class && (best == units || block_class < best_class)) {
+            best = unit;
+            best_class = block_class;
+            if (block_class == size_class) {
+                break;
+            }
+        }
+    }
+
+    if (best == units) {
+        return NULL;
+    }
+
+    /* split it, the upper halves stay free */
+    while (best_class > size_class) {
+        --best_class;
+        component->fbox_pool_free[best + (1u << best_class)] = (unsigned char) (best_class + 1);
+    }
+    component->fbox_pool_free[best] = 0;
+
+    component->fbox_units += 1u << size_class;
+    assert (component->fbox_units <= component->fbox_pool_units);
+
+    return component->fbox_pool + (size_t) best * component->fbox_size;
+}
+
+void mca_btl_vader_fbox_pool_put (void *fbox, unsigned int size_class)
+{
+    mca_btl_vader_component_t *component = &mca_btl_vader_component;
+    unsigned int unit = (unsigned int) (((char *) fbox - component->fbox_pool) / component->fbox_size);
+
+    assert (unit < component->fbox_pool_units && 0 == (unit & ((1u << size_class) - 1)));
+    assert (component->fbox_units >= (1u << size_class));
+    component->fbox_units -= 1u << size_class;
+
+    /* merge with the buddy for as long as it is free and of the same size */
+    while (size_class + 1 < component->fbox_num_classes) {
+        unsigned int buddy = unit ^ (1u << size_class);
+
+        if (buddy >= component->fbox_pool_units || component->fbox_pool_free[buddy] != size_class + 1) {
+            break;
+        }
+        component->fbox_pool_free[buddy] = 0;
+        unit &= ~(1u << size_class);
+        ++size_class;
+    }
+
+    component->fbox_pool_free[unit] = (unsigned char) (size_class + 1);
+}
+
+/* completion of the control fragment: the peer no longer reads the
+ * retired fast box */
+static void mca_btl_vader_fbox_retire (mca_btl_base_module_t *btl, mca_btl_base_endpoint_t *ep,
+                                       mca_btl_base_descriptor_t *des, int status)
+{
+    mca_btl_vader_component_t *component = &mca_btl_vader_component;
+    const unsigned int size_class = ep->fbox_out.retired_class;
+
+    OPAL_THREAD_LOCK(&component->lock);
+    mca_btl_vader_fbox_pool_put (ep->fbox_out.retired, size_class);
+
+    if (NULL == ep->fbox_out.buffer) {
+        /* the fast box was released. give the slot back to the peer and
+         * start counting towards a new fast box */
+        opal_atomic_add_fetch_32 (&ep->fifo->fbox_available, 1);
+        ep->send_count = 0;
+    }
+
+    opal_atomic_wmb ();
+    ep->fbox_out.retired = NULL;
+    OPAL_THREAD_UNLOCK(&component->lock);
+}
+
+void mca_btl_vader_fbox_return (void *fbox, unsigned int size_class)
+{
+    OPAL_THREAD_LOCK(&mca_btl_vader_component.lock);
+    mca_btl_vader_fbox_pool_put (fbox, size_class);
+    OPAL_THREAD_UNLOCK(&mca_btl_vader_component.lock);
+}
+
+/**
+ * Replace the send fast box of an endpoint
+ *
+ * @param ep (IN)          Vader BTL endpoint
+ * @param size_class (IN)  Size class of the new fast box (-1 to release the fast box)
+ */
+static int mca_btl_vader_fbox_resize (mca_btl_base_endpoint_t *ep, int size_class)
+{
+    mca_btl_vader_component_t *component = &mca_btl_vader_component;
+    void *fbox = NULL;
+    mca_btl_vader_frag_t *frag;
+    unsigned int size = 0;
+    fifo_value_t rhdr;
+
+    (void) MCA_BTL_VADER_FRAG_ALLOC_USER(frag, ep);
+    if (OPAL_UNLIKELY(NULL == frag)) {
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    if (size_class >= 0) {
+        size = component->fbox_size << size_class;
+
+        OPAL_THREAD_LOCK(&component->lock);
+        fbox = mca_btl_vader_fbox_pool_get (size_class);
+        OPAL_THREAD_UNLOCK(&component->lock);
+
+        if (NULL == fbox) {
+            MCA_BTL_VADER_FRAG_RETURN(frag);
+            return OPAL_ERR_OUT_OF_RESOURCE;
+        }
+
+        memset (fbox, 0, size);
+    }
+
+    frag->hdr->tag = MCA_BTL_TAG_VADER;
+    frag->hdr->len = 0;
+    frag->hdr->flags = MCA_BTL_VADER_FLAG_FBOX_CONTROL;
+    frag->hdr->fbox_base = fbox ? virtual2relative ((char *) fbox) : 0;
+    frag->hdr->fbox_size = size;
+    frag->base.des_cbfunc = mca_btl_vader_fbox_retire;
+    frag->base.des_flags = MCA_BTL_DES_FLAGS_BTL_OWNERSHIP | MCA_BTL_DES_SEND_ALWAYS_CALLBACK;
+    rhdr = virtual2relative ((char *) frag->hdr);
+
+    OPAL_THREAD_LOCK(&ep->lock);
+    opal_atomic_wmb ();
+    if (!mca_btl_vader_fbox_sendi_locked (ep, 0xfe, &rhdr, sizeof (rhdr), NULL, 0)) {
+        /* no room for the control fragment. try again later */
+        OPAL_THREAD_UNLOCK(&ep->lock);
+        if (fbox) {
+            mca_btl_vader_fbox_return (fbox, size_class);
+        }
+        MCA_BTL_VADER_FRAG_RETURN(frag);
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+
+    ep->fbox_out.retired_class = ep->fbox_out.size_class;
+    ep->fbox_out.retired = ep->fbox_out.fbox;
+    opal_atomic_wmb ();
+
+    if (fbox) {
+        mca_btl_vader_endpoint_setup_fbox_send (ep, fbox, size_class, size);
+        ep->fbox_out.last_use = component->fbox_clock;
+    } else {
+        ep->fbox_out.fbox = NULL;
+        ep->fbox_out.size_class = 0;
+        ep->fbox_out.buffer = NULL;
+    }
+    OPAL_THREAD_UNLOCK(&ep->lock);
+
+    BTL_VERBOSE(("%s fast box of peer %d (size %u)", fbox ? "resized" : "released",
+                 ep->peer_smp_rank, size));
+
+    return OPAL_SUCCESS;
+}
+
+void mca_btl_vader_fbox_adapt (void)
+{
+    mca_btl_vader_component_t *component = &mca_btl_vader_component;
+    const uint64_t clock = component->fbox_clock;
+
+    component->fbox_adapt_pending = false;
+
+    if (NULL == component->endpoints) {
+        return;
+    }
+
+    for (int i = 0 ; i < 1 + MCA_BTL_VADER_NUM_LOCAL_PEERS ; ++i) {
+        mca_btl_base_endpoint_t *ep = component->endpoints + i;
+        uint64_t idle;
+
+        if (NULL == ep->fifo || NULL == ep->fbox_out.buffer || NULL != ep->fbox_out.retired) {
+            continue;
+        }
+
+        idle = clock - ep->fbox_out.last_use;
+        if (ep->fbox_out.grow) {
+            ep->fbox_out.grow = false;
+            (void) mca_btl_vader_fbox_resize (ep, ep->fbox_out.size_class + 1);
+        } else if (idle >= component->fbox_idle) {
+            /* nothing was sent to this peer in a long time. give the memory back */
+            (void) mca_btl_vader_fbox_resize (ep, -1);
+        } else if (ep->fbox_out.size_class && idle >= (component->fbox_idle >> 2)) {
+            /* the peer is no longer busy. go back to the initial size */
+            (void) mca_btl_vader_fbox_resize (ep, 0);
+        }
+    }
+}
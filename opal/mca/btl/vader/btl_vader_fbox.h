@@ -18,6 +18,9 @@
 
 #define MCA_BTL_VADER_POLL_COUNT 31
 
+/* send fast boxes are checked for growing/releasing every this many + 1 calls to progress */
+#define MCA_BTL_VADER_FBOX_SWEEP_MASK 0xfff
+
 typedef union mca_btl_vader_fbox_hdr_t {
     struct {
         /* NTH: on 32-bit platforms loading/unloading the header may be completed
@@ -73,24 +76,54 @@ static inline mca_btl_vader_fbox_hdr_t mca_btl_vader_fbox_read_header (mca_btl_v
     return tmp;
 }
 
-/* attempt to reserve a contiguous segment from the remote ep */
-static inline bool mca_btl_vader_fbox_sendi (mca_btl_base_endpoint_t *ep, unsigned char tag,
-                                             void * restrict header, const size_t header_size,
-                                             void * restrict payload, const size_t payload_size)
+void mca_btl_vader_fbox_adapt (void);
+
+/* fast box memory. get/put must be called with the component lock held */
+int mca_btl_vader_fbox_pool_init (void);
+void *mca_btl_vader_fbox_pool_get (unsigned int size_class);
+void mca_btl_vader_fbox_pool_put (void *fbox, unsigned int size_class);
+void mca_btl_vader_fbox_return (void *fbox, unsigned int size_class);
+
+/* account for a fast box send attempt (miss: the message did not fit) and ask
+ * for a bigger fast box if misses are common. must be called with the endpoint
+ * lock held. */
+static inline void mca_btl_vader_fbox_note_send (mca_btl_base_endpoint_t *ep, bool miss)
+{
+    ep->fbox_out.window_misses += miss;
+    if (OPAL_UNLIKELY(++ep->fbox_out.window_sends >= mca_btl_vader_component.fbox_window)) {
+        /* grow if more than 1/8th of the window went through the fifo */
+        if ((ep->fbox_out.window_misses << 3) > ep->fbox_out.window_sends &&
+            ep->fbox_out.size_class + 1 < mca_btl_vader_component.fbox_num_classes) {
+            ep->fbox_out.grow = true;
+            mca_btl_vader_component.fbox_adapt_pending = true;
+        }
+        ep->fbox_out.window_sends = ep->fbox_out.window_misses = 0;
+    }
+}
+
+/* attempt to reserve a contiguous segment from the remote ep. must be called
+ * with the endpoint lock held. */
+static inline bool mca_btl_vader_fbox_sendi_locked (mca_btl_base_endpoint_t *ep, unsigned char tag,
+                                                    void * restrict header, const size_t header_size,
+                                                    void * restrict payload, const size_t payload_size)
 {
-    const unsigned int fbox_size = mca_btl_vader_component.fbox_size;
+    const unsigned int fbox_size = ep->fbox_out.size;
     size_t size = header_size + payload_size;
     unsigned int start, end, buffer_free;
     size_t data_size = size;
     unsigned char *dst, *data;
     bool hbs, hbm;
 
-    /* don't try to use the per-peer buffer for messages that will fill up more than 25% of the buffer */
-    if (OPAL_UNLIKELY(NULL == ep->fbox_out.buffer || size > (fbox_size >> 2))) {
+    if (OPAL_UNLIKELY(NULL == ep->fbox_out.buffer)) {
         return false;
     }
 
-    OPAL_THREAD_LOCK(&ep->lock);
+    /* don't try to use the per-peer buffer for messages that will fill up more than 25% of the buffer */
+    if (OPAL_UNLIKELY(size > (fbox_size >> 2))) {
+        /* only count it against the fast box if a bigger one would help */
+        mca_btl_vader_fbox_note_send (ep, size <= (mca_btl_vader_component.fbox_max_size >> 2));
+        return false;
+    }
 
     /* the high bit helps determine if the buffer is empty or full */
     hbs = MCA_BTL_VADER_FBOX_OFFSET_HBS(ep->fbox_out.end);
@@ -140,7 +173,7 @@ static inline bool mca_btl_vader_fbox_sendi (mca_btl_base_endpoint_t *ep, unsign
         if (OPAL_UNLIKELY(buffer_free < size)) {
             ep->fbox_out.end = (hbs << 31) | end;
             opal_atomic_wmb ();
-            OPAL_THREAD_UNLOCK(&ep->lock);
+            mca_btl_vader_fbox_note_send (ep, true);
             return false;
         }
     }
@@ -150,10 +183,10 @@ static inline bool mca_btl_vader_fbox_sendi (mca_btl_base_endpoint_t *ep, unsign
 
     data = dst + sizeof (mca_btl_vader_fbox_hdr_t);
 
-    memcpy (data, header, header_size);
+    opal_memcpy (data, header, header_size);
     if (payload) {
         /* inline sends are typically just pml headers (due to MCA_BTL_FLAGS_SEND_INPLACE) */
-        memcpy (data + header_size, payload, payload_size);
+        opal_memcpy (data + header_size, payload, payload_size);
     }
 
     end += size;
@@ -173,26 +206,51 @@ static inline bool mca_btl_vader_fbox_sendi (mca_btl_base_endpoint_t *ep, unsign
     /* align the buffer */
     ep->fbox_out.end = ((uint32_t) hbs << 31) | end;
     opal_atomic_wmb ();
-    OPAL_THREAD_UNLOCK(&ep->lock);
+
+    ep->fbox_out.last_use = mca_btl_vader_component.fbox_clock;
+    if (0xfe != tag) {
+        /* fragment headers are accounted for as fifo sends */
+        ++ep->fbox_out.hits;
+    }
+    mca_btl_vader_fbox_note_send (ep, false);
 
     return true;
 }
 
+static inline bool mca_btl_vader_fbox_sendi (mca_btl_base_endpoint_t *ep, unsigned char tag,
+                                             void * restrict header, const size_t header_size,
+                                             void * restrict payload, const size_t payload_size)
+{
+    bool ret;
+
+    if (NULL == ep->fbox_out.buffer) {
+        return false;
+    }
+
+    OPAL_THREAD_LOCK(&ep->lock);
+    ret = mca_btl_vader_fbox_sendi_locked (ep, tag, header, header_size, payload, payload_size);
+    OPAL_THREAD_UNLOCK(&ep->lock);
+
+    return ret;
+}
+
 static inline bool mca_btl_vader_check_fboxes (void)
 {
-    const unsigned int fbox_size = mca_btl_vader_component.fbox_size;
     bool processed = false;
 
     for (unsigned int i = 0 ; i < mca_btl_vader_component.num_fbox_in_endpoints ; ++i) {
         mca_btl_base_endpoint_t *ep = mca_btl_vader_component.fbox_in_endpoints[i];
+        unsigned char * const buffer = ep->fbox_in.buffer;
+        const unsigned int fbox_size = ep->fbox_in.size;
         unsigned int start = ep->fbox_in.start & MCA_BTL_VADER_FBOX_OFFSET_MASK;
+        bool replaced = false;
 
         /* save the current high bit state */
         bool hbs = MCA_BTL_VADER_FBOX_OFFSET_HBS(ep->fbox_in.start);
         int poll_count;
 
         for (poll_count = 0 ; poll_count <= MCA_BTL_VADER_POLL_COUNT ; ++poll_count) {
-            const mca_btl_vader_fbox_hdr_t hdr = mca_btl_vader_fbox_read_header (MCA_BTL_VADER_FBOX_HDR(ep->fbox_in.buffer + start));
+            const mca_btl_vader_fbox_hdr_t hdr = mca_btl_vader_fbox_read_header (MCA_BTL_VADER_FBOX_HDR(buffer + start));
 
             /* check for a valid tag a sequence number */
             if (0 == hdr.data.tag || hdr.data.seq != ep->fbox_in.seq) {
@@ -220,15 +278,23 @@ static inline bool mca_btl_vader_check_fboxes (void)
                  * limitation has not appeared to cause any performance
                  * degradation. */
                 segment.seg_len = hdr.data.size;
-                segment.seg_addr.pval = (void *) (ep->fbox_in.buffer + start + sizeof (hdr));
+                segment.seg_addr.pval = (void *) (buffer + start + sizeof (hdr));
 
                 /* call the registered callback function */
                 reg->cbfunc(&mca_btl_vader.super, hdr.data.tag, &desc, reg->cbdata);
             } else if (OPAL_LIKELY(0xfe == hdr.data.tag)) {
                 /* process fragment header */
-                fifo_value_t *value = (fifo_value_t *)(ep->fbox_in.buffer + start + sizeof (hdr));
+                fifo_value_t *value = (fifo_value_t *)(buffer + start + sizeof (hdr));
                 mca_btl_vader_hdr_t *hdr = relative2virtual(*value);
                 mca_btl_vader_poll_handle_frag (hdr, ep);
+
+                if (OPAL_UNLIKELY(ep->fbox_in.buffer != buffer)) {
+                    /* the sender replaced or released this fast box. nothing follows
+                     * this fragment in the old buffer and the sender may reuse it
+                     * as soon as the fragment has been returned. */
+                    replaced = true;
+                    break;
+                }
             }
 
             start = (start + hdr.data.size + sizeof (hdr) + MCA_BTL_VADER_FBOX_ALIGNMENT_MASK) & ~MCA_BTL_VADER_FBOX_ALIGNMENT_MASK;
@@ -240,7 +306,9 @@ static inline bool mca_btl_vader_check_fboxes (void)
             }
         }
 
-        if (poll_count) {
+        if (OPAL_UNLIKELY(replaced)) {
+            processed = true;
+        } else if (poll_count) {
             BTL_VERBOSE(("left off at offset %u (hbs: %d)", start, hbs));
 
             /* save where we left off */
@@ -261,24 +329,39 @@ static inline void mca_btl_vader_try_fbox_setup (mca_btl_base_endpoint_t *ep, mc
         /* protect access to mca_btl_vader_component.segment_offset */
         OPAL_THREAD_LOCK(&mca_btl_vader_component.lock);
 
-        /* verify the remote side will accept another fbox */
-        if (0 <= opal_atomic_add_fetch_32 (&ep->fifo->fbox_available, -1)) {
-            opal_free_list_item_t *fbox = opal_free_list_get (&mca_btl_vader_component.vader_fboxes);
+        /* stay within the fast box budget and verify the remote side will accept another fbox */
+        if (mca_btl_vader_component.fbox_units < mca_btl_vader_component.fbox_max) {
+            void *fbox = NULL;
+
+            if (0 <= opal_atomic_add_fetch_32 (&ep->fifo->fbox_available, -1)) {
+                fbox = mca_btl_vader_fbox_pool_get (0);
+            }
 
             if (NULL != fbox) {
+                const unsigned int fbox_size = mca_btl_vader_component.fbox_size;
+
                 /* zero out the fast box */
-                memset (fbox->ptr, 0, mca_btl_vader_component.fbox_size);
-                mca_btl_vader_endpoint_setup_fbox_send (ep, fbox);
+                memset (fbox, 0, fbox_size);
+                mca_btl_vader_endpoint_setup_fbox_send (ep, fbox, 0, fbox_size);
+                ep->fbox_out.last_use = mca_btl_vader_component.fbox_clock;
 
                 hdr->flags |= MCA_BTL_VADER_FLAG_SETUP_FBOX;
                 hdr->fbox_base = virtual2relative((char *) ep->fbox_out.buffer);
+                hdr->fbox_size = fbox_size;
             } else {
+                /* give back the slot (even an overdrawn one) so retries do not leave
+                 * fbox_available permanently below zero */
                 opal_atomic_add_fetch_32 (&ep->fifo->fbox_available, 1);
             }
 
             opal_atomic_wmb ();
         }
 
+        if (NULL == ep->fbox_out.buffer) {
+            /* try again later. idle fast boxes may have been reclaimed by then */
+            ep->send_count = 0;
+        }
+
         OPAL_THREAD_UNLOCK(&mca_btl_vader_component.lock);
     }
 }
@@ -203,6 +203,12 @@ static inline bool vader_fifo_write_ep (mca_btl_vader_hdr_t *hdr, struct mca_btl
         opal_atomic_wmb ();
         return mca_btl_vader_fbox_sendi (ep, 0xfe, &rhdr, sizeof (rhdr), NULL, 0);
     }
+    if (OPAL_UNLIKELY(NULL != ep->fbox_out.retired)) {
+        /* the fast box is being released. the peer might see fragments
+         * posted to the fifo before the ones still in the fast box so
+         * hold them back until the peer acknowledged the release. */
+        return false;
+    }
     mca_btl_vader_try_fbox_setup (ep, hdr);
     hdr->next = VADER_FIFO_FREE;
     vader_fifo_write (ep->fifo, rhdr);
@@ -32,6 +32,8 @@ enum {
     MCA_BTL_VADER_FLAG_SINGLE_COPY = 1,
     MCA_BTL_VADER_FLAG_COMPLETE    = 2,
     MCA_BTL_VADER_FLAG_SETUP_FBOX  = 4,
+    /** the fragment only carries a fast box change (no payload) */
+    MCA_BTL_VADER_FLAG_FBOX_CONTROL = 8,
 };
 
 struct mca_btl_vader_frag_t;
@@ -72,6 +74,8 @@ struct mca_btl_vader_hdr_t {
     struct iovec sc_iov;
     /** if the fragment indicates to setup a fast box the base is stored here */
     intptr_t fbox_base;
+    /** size of the new fast box (0 if the fast box is released) */
+    uint32_t fbox_size;
 };
 typedef struct mca_btl_vader_hdr_t mca_btl_vader_hdr_t;
 
@@ -168,7 +172,7 @@ static inline void mca_btl_vader_rdma_frag_advance (mca_btl_base_module_t *btl,
 
     if (frag->rdma.sent) {
         if (MCA_BTL_VADER_OP_GET == hdr->type) {
-            memcpy (frag->rdma.local_address, data, len);
+            opal_memcpy (frag->rdma.local_address, data, len);
         } else if ((MCA_BTL_VADER_OP_ATOMIC == hdr->type || MCA_BTL_VADER_OP_CSWAP == hdr->type) &&
                    frag->rdma.local_address) {
             if (8 == len) {
@@ -189,7 +193,7 @@ static inline void mca_btl_vader_rdma_frag_advance (mca_btl_base_module_t *btl,
 
         if (MCA_BTL_VADER_OP_PUT == hdr->type) {
             /* copy the next block into the fragment buffer */
-            memcpy ((void *) (hdr + 1), frag->rdma.local_address, packet_size);
+            opal_memcpy ((void *) (hdr + 1), frag->rdma.local_address, packet_size);
         }
 
         hdr->addr = frag->rdma.remote_address;
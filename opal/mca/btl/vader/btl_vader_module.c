@@ -128,10 +128,9 @@ static int vader_btl_first_time_init(mca_btl_vader_t *vader_btl, int n)
         return OPAL_ERR_OUT_OF_RESOURCE;
     }
 
-    rc = opal_free_list_init (&component->vader_fboxes, sizeof (opal_free_list_item_t), 8,
-                              OBJ_CLASS(opal_free_list_item_t), mca_btl_vader_component.fbox_size,
-                              opal_cache_line_size, 0, mca_btl_vader_component.fbox_max, 4,
-                              component->mpool, 0, NULL, NULL, NULL);
+    /* all send fast boxes, whatever their size, are carved out of a single
+     * region of fbox_max * fbox_size bytes (see btl_vader_fbox.c) */
+    rc = mca_btl_vader_fbox_pool_init ();
     if (OPAL_SUCCESS != rc) {
         return rc;
     }
@@ -588,7 +587,7 @@ static struct mca_btl_base_descriptor_t *vader_prepare_src (struct mca_btl_base_
         } else {
 #endif
             /* NTH: the covertor adds some latency so we bypass it here */
-            memcpy ((void *)((uintptr_t)frag->segments[0].seg_addr.pval + reserve), data_ptr, *size);
+            opal_memcpy ((void *)((uintptr_t)frag->segments[0].seg_addr.pval + reserve), data_ptr, *size);
             frag->segments[0].seg_len = total_size;
 #if OPAL_BTL_VADER_HAVE_XPMEM
         }
@@ -617,6 +616,11 @@ static void mca_btl_vader_endpoint_constructor (mca_btl_vader_endpoint_t *ep)
     OBJ_CONSTRUCT(&ep->pending_frags_lock, opal_mutex_t);
     ep->fifo = NULL;
     ep->fbox_out.fbox = NULL;
+    ep->fbox_out.retired = NULL;
+    ep->fbox_out.size_class = 0;
+    ep->fbox_out.grow = false;
+    ep->fbox_out.hits = 0;
+    ep->fbox_out.fallbacks = 0;
 }
 
 #if OPAL_BTL_VADER_HAVE_XPMEM
@@ -646,11 +650,15 @@ static void mca_btl_vader_endpoint_destructor (mca_btl_vader_endpoint_t *ep)
         opal_shmem_segment_detach (&seg_ds);
     }
     if (ep->fbox_out.fbox) {
-        opal_free_list_return (&mca_btl_vader_component.vader_fboxes, ep->fbox_out.fbox);
+        mca_btl_vader_fbox_return (ep->fbox_out.fbox, ep->fbox_out.size_class);
+    }
+    if (ep->fbox_out.retired) {
+        mca_btl_vader_fbox_return (ep->fbox_out.retired, ep->fbox_out.retired_class);
     }
 
     ep->fbox_in.buffer = ep->fbox_out.buffer = NULL;
     ep->fbox_out.fbox = NULL;
+    ep->fbox_out.retired = NULL;
     ep->segment_base = NULL;
     ep->fifo = NULL;
 }
@@ -98,10 +98,10 @@ static void mca_btl_vader_sc_emu_rdma (mca_btl_base_module_t *btl, mca_btl_base_
 
     switch (hdr->type) {
     case MCA_BTL_VADER_OP_PUT:
-        memcpy ((void *) hdr->addr, data, size);
+        opal_memcpy ((void *) hdr->addr, data, size);
         break;
     case MCA_BTL_VADER_OP_GET:
-        memcpy (data, (void *) hdr->addr, size);
+        opal_memcpy (data, (void *) hdr->addr, size);
         break;
 #if OPAL_HAVE_ATOMIC_MATH_64
     case MCA_BTL_VADER_OP_ATOMIC:
@@ -46,6 +46,8 @@ int mca_btl_vader_send (struct mca_btl_base_module_t *btl,
      * make the callback. once this is fixed in ob1 we can restore the code below. */
     frag->base.des_flags |= MCA_BTL_DES_SEND_ALWAYS_CALLBACK;
 
+    (void) OPAL_THREAD_ADD_FETCH_SIZE_T (&endpoint->fbox_out.fallbacks, 1);
+
     /* header (+ optional inline data) */
     frag->hdr->len = total_size;
     /* type of message, pt-2-pt, one-sided, etc */
@@ -85,7 +85,7 @@ int mca_btl_vader_sendi (struct mca_btl_base_module_t *btl,
     frag->hdr->tag = tag;
 
     /* write the match header (with MPI comm/tag/etc. info) */
-    memcpy (frag->segments[0].seg_addr.pval, header, header_size);
+    opal_memcpy (frag->segments[0].seg_addr.pval, header, header_size);
 
     /* write the message data if there is any */
     /* we can't use single-copy semantics here since as caller will consider the send
@@ -113,5 +113,7 @@ int mca_btl_vader_sendi (struct mca_btl_base_module_t *btl,
         return OPAL_ERR_OUT_OF_RESOURCE;
     }
 
+    (void) OPAL_THREAD_ADD_FETCH_SIZE_T (&endpoint->fbox_out.fallbacks, 1);
+
     return OPAL_SUCCESS;
 }
@@ -31,7 +31,37 @@ OPAL_DECLSPEC extern mca_base_framework_t opal_memcpy_base_framework;
 
 END_C_DECLS
 
-/* include implementation to call */
-#include MCA_timer_IMPLEMENTATION_HEADER
+/* include implementation to call.  Implementations only have to
+ * provide opal_memcpy, the iovec variants below are built on top of
+ * it unless the implementation defines its own. */
+#include MCA_memcpy_IMPLEMENTATION_HEADER
 
-#endif /* OPAL_BASE_MEMCPY_H */
+#if !defined(opal_memcpy_tov)
+#define opal_memcpy_tov( dst_iov, src, count )        \
+    do {                                              \
+        int _i;                                       \
+        char* _src = (char*)src;                      \
+                                                      \
+        for( _i = 0; _i < count; _i++ ) {             \
+            opal_memcpy( dst_iov[_i].iov_base, _src,  \
+                         dst_iov[_i].iov_len );       \
+            _src += dst_iov[_i].iov_len;              \
+        }                                             \
+    } while (0)
+#endif
+
+#if !defined(opal_memcpy_fromv)
+#define opal_memcpy_fromv( dst, src_iov, count )        \
+    do {                                                \
+        int _i;                                         \
+        char* _dst = (char*)dst;                        \
+                                                        \
+        for( _i = 0; _i < count; _i++ ) {               \
+            opal_memcpy( _dst, src_iov[_i].iov_base,    \
+                         src_iov[_i].iov_len );         \
+            _dst += src_iov[_i].iov_len;                \
+        }                                               \
+    } while (0)
+#endif
+
+#endif /* OPAL_MEMCPY_BASE_H */
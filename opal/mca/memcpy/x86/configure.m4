@@ -0,0 +1,66 @@
+# -*- shell-script -*-
+#
+# $COPYRIGHT$
+#
+# Additional copyrights may follow
+#
+# $HEADER$
+#
+AC_DEFUN([MCA_opal_memcpy_x86_PRIORITY], [30])
+
+AC_DEFUN([MCA_opal_memcpy_x86_COMPILE_MODE], [
+    AC_MSG_CHECKING([for MCA component $2:$3 compile mode])
+    $4="static"
+    AC_MSG_RESULT([$$4])
+])
+
+AC_DEFUN([MCA_opal_memcpy_x86_POST_CONFIG],[
+    AS_IF([test "$1" = "1"], [memcpy_base_include="x86/memcpy_x86.h"])
+])dnl
+
+# MCA_memcpy_x86_CONFIG(action-if-can-compile,
+#                       [action-if-cant-compile])
+# ------------------------------------------------
+AC_DEFUN([MCA_opal_memcpy_x86_CONFIG],[
+    AC_CONFIG_FILES([opal/mca/memcpy/x86/Makefile])
+
+    OPAL_VAR_SCOPE_PUSH([memcpy_x86_happy memcpy_x86_cflags_save memcpy_x86_flags])
+    memcpy_x86_happy=no
+    memcpy_x86_avx_support=0
+    MCA_BUILD_MEMCPY_X86_AVX_FLAGS=
+
+    # The streaming copies rely on SSE2, which is part of the x86_64
+    # baseline, so only the AVX variant needs special flags.
+    AS_CASE([$host],
+            [x86_64-*],
+            [AC_CHECK_HEADER([emmintrin.h], [memcpy_x86_happy=yes])])
+
+    AS_IF([test "$memcpy_x86_happy" = "yes"],
+          [memcpy_x86_cflags_save="$CFLAGS"
+           for memcpy_x86_flags in "" "-mavx" ; do
+               AC_MSG_CHECKING([for AVX streaming stores (flags: ${memcpy_x86_flags:-none})])
+               CFLAGS="$memcpy_x86_cflags_save $memcpy_x86_flags"
+               AC_LINK_IFELSE([AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                                               [[char buf[64] __attribute__((aligned(32)));
+                                                 __m256i vA = _mm256_loadu_si256((const __m256i*)buf);
+                                                 _mm256_stream_si256((__m256i*)buf, vA);
+                                                 _mm_sfence();]])],
+                              [AC_MSG_RESULT([yes])
+                               memcpy_x86_avx_support=1
+                               MCA_BUILD_MEMCPY_X86_AVX_FLAGS="$memcpy_x86_flags"],
+                              [AC_MSG_RESULT([no])])
+               AS_IF([test $memcpy_x86_avx_support -eq 1], [break])
+           done
+           CFLAGS="$memcpy_x86_cflags_save"])
+
+    AC_DEFINE_UNQUOTED([OPAL_MCA_MEMCPY_X86_HAVE_AVX], [$memcpy_x86_avx_support],
+                       [Whether the memcpy/x86 component has AVX streaming copies])
+    AM_CONDITIONAL([MCA_BUILD_opal_memcpy_x86_has_avx_support],
+                   [test $memcpy_x86_avx_support -eq 1])
+    AC_SUBST([MCA_BUILD_MEMCPY_X86_AVX_FLAGS])
+
+    AS_IF([test "$memcpy_x86_happy" = "yes"],
+          [$1],
+          [$2])
+    OPAL_VAR_SCOPE_POP
+])dnl
@@ -0,0 +1,79 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H
+#define OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H
+
+#include "opal_config.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "opal/prefetch.h"
+
+BEGIN_C_DECLS
+
+/**
+ * Copies of at least this many bytes use non-temporal stores, so that
+ * the destination does not evict the rest of the last level cache.
+ * Stays at SIZE_MAX (everything goes through memcpy) until the
+ * component is opened.
+ */
+OPAL_DECLSPEC extern size_t opal_memcpy_x86_nt_threshold;
+
+/**
+ * Streaming copy selected when the component is opened (SSE2 or AVX).
+ */
+OPAL_DECLSPEC extern void *(*opal_memcpy_x86_nt)(void *dst, const void *src, size_t length);
+
+OPAL_DECLSPEC void *opal_memcpy_x86_nt_sse2(void *dst, const void *src, size_t length);
+#if OPAL_MCA_MEMCPY_X86_HAVE_AVX
+OPAL_DECLSPEC void *opal_memcpy_x86_nt_avx(void *dst, const void *src, size_t length);
+#endif
+
+static inline void *opal_memcpy_x86(void *dst, const void *src, size_t length)
+{
+    unsigned char *d = (unsigned char *) dst;
+    const unsigned char *s = (const unsigned char *) src;
+
+    /* Small copies (headers, single elements of a datatype) are done
+     * inline with two possibly overlapping loads and stores instead of
+     * paying for a call into the C library. */
+    if (length <= 16) {
+        if (length >= 8) {
+            uint64_t head, tail;
+            memcpy(&head, s, 8);
+            memcpy(&tail, s + length - 8, 8);
+            memcpy(d, &head, 8);
+            memcpy(d + length - 8, &tail, 8);
+        } else if (length >= 4) {
+            uint32_t head, tail;
+            memcpy(&head, s, 4);
+            memcpy(&tail, s + length - 4, 4);
+            memcpy(d, &head, 4);
+            memcpy(d + length - 4, &tail, 4);
+        } else if (length > 0) {
+            d[0] = s[0];
+            d[length >> 1] = s[length >> 1];
+            d[length - 1] = s[length - 1];
+        }
+        return dst;
+    }
+
+    if (OPAL_UNLIKELY(length >= opal_memcpy_x86_nt_threshold)) {
+        return opal_memcpy_x86_nt(dst, src, length);
+    }
+    return memcpy(dst, src, length);
+}
+
+END_C_DECLS
+
+#define opal_memcpy( dst, src, length ) \
+    opal_memcpy_x86( (dst), (src), (length) )
+
+#endif /* OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H */
@@ -0,0 +1,53 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "opal/mca/memcpy/x86/memcpy_x86.h"
+
+/*
+ * AVX flavor of opal_memcpy_x86_nt_sse2: 128 bytes per iteration with
+ * 32 byte streaming stores.  This file is compiled with the AVX flags
+ * and must only be called after checking the processor supports it.
+ */
+void *opal_memcpy_x86_nt_avx(void *dst, const void *src, size_t length)
+{
+    unsigned char *d = (unsigned char *) dst;
+    const unsigned char *s = (const unsigned char *) src;
+    size_t head = (32 - ((uintptr_t) d & 31)) & 31;
+
+    if (head > length) {
+        head = length;
+    }
+    if (head) {
+        memcpy(d, s, head);
+        d += head; s += head; length -= head;
+    }
+
+    for (; length >= 128; length -= 128, d += 128, s += 128) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *) (s +  0));
+        __m256i v1 = _mm256_loadu_si256((const __m256i *) (s + 32));
+        __m256i v2 = _mm256_loadu_si256((const __m256i *) (s + 64));
+        __m256i v3 = _mm256_loadu_si256((const __m256i *) (s + 96));
+        _mm256_stream_si256((__m256i *) (d +  0), v0);
+        _mm256_stream_si256((__m256i *) (d + 32), v1);
+        _mm256_stream_si256((__m256i *) (d + 64), v2);
+        _mm256_stream_si256((__m256i *) (d + 96), v3);
+    }
+    _mm_sfence();
+
+    if (length) {
+        memcpy(d, s, length);
+    }
+    return dst;
+}
@@ -0,0 +1,145 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "opal/constants.h"
+#include "opal/mca/memcpy/memcpy.h"
+#include "opal/mca/memcpy/base/base.h"
+#include "opal/mca/memcpy/x86/memcpy_x86.h"
+
+/* Lower bound for the streaming threshold: below this the sfence and
+ * the cache misses on the next access of the destination cost more
+ * than the cache pollution they avoid. */
+#define OPAL_MEMCPY_X86_NT_MIN (64 * 1024)
+
+static void *opal_memcpy_x86_libc(void *dst, const void *src, size_t length);
+
+/**
+ * Sane defaults until the component is opened: everything goes to
+ * the C library.
+ */
+size_t opal_memcpy_x86_nt_threshold = SIZE_MAX;
+void *(*opal_memcpy_x86_nt)(void *dst, const void *src, size_t length) =
+    opal_memcpy_x86_libc;
+
+static size_t mca_memcpy_x86_nt_threshold = 0;
+static bool mca_memcpy_x86_use_avx = true;
+
+static int opal_memcpy_x86_register(void);
+static int opal_memcpy_x86_open(void);
+
+const opal_memcpy_base_component_2_0_0_t mca_memcpy_x86_component = {
+    /* First, the mca_component_t struct containing meta information
+       about the component itself */
+    .memcpyc_version = {
+        OPAL_MEMCPY_BASE_VERSION_2_0_0,
+
+        /* Component name and version */
+        .mca_component_name = "x86",
+        MCA_BASE_MAKE_VERSION(component, OPAL_MAJOR_VERSION, OPAL_MINOR_VERSION,
+                              OPAL_RELEASE_VERSION),
+
+        /* Component open and register functions */
+        .mca_open_component = opal_memcpy_x86_open,
+        .mca_register_component_params = opal_memcpy_x86_register,
+    },
+    .memcpyc_data = {
+        /* The component is checkpoint ready */
+        MCA_BASE_METADATA_PARAM_CHECKPOINT
+    },
+};
+
+static void *opal_memcpy_x86_libc(void *dst, const void *src, size_t length)
+{
+    return memcpy(dst, src, length);
+}
+
+#if OPAL_MCA_MEMCPY_X86_HAVE_AVX
+/*
+ * AVX is usable only if both the processor and the operating system
+ * (which has to save the YMM state, see XCR0) support it.
+ */
+static bool opal_memcpy_x86_have_avx(void)
+{
+    uint32_t eax, ebx, ecx, edx, xcr0_lo, xcr0_hi;
+
+    __asm__ __volatile__ ("cpuid"
+                          : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+                          : "a" (0), "c" (0));
+    if (eax < 1) {
+        return false;
+    }
+    __asm__ __volatile__ ("cpuid"
+                          : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+                          : "a" (1), "c" (0));
+    if (!(ecx & (1u << 27)) || !(ecx & (1u << 28))) {
+        return false;
+    }
+    __asm__ __volatile__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+    return 0x6 == (xcr0_lo & 0x6);
+}
+#endif  /* OPAL_MCA_MEMCPY_X86_HAVE_AVX */
+
+static int opal_memcpy_x86_register(void)
+{
+    (void) mca_base_component_var_register(&mca_memcpy_x86_component.memcpyc_version,
+                                           "nt_threshold",
+                                           "Size in bytes from which copies use non-temporal "
+                                           "(cache bypassing) stores.  0 selects half of the "
+                                           "last level cache (default: 0)",
+                                           MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                           OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_memcpy_x86_nt_threshold);
+    (void) mca_base_component_var_register(&mca_memcpy_x86_component.memcpyc_version,
+                                           "avx",
+                                           "Use the AVX streaming copy when the processor "
+                                           "supports it (default: true)",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                           OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_memcpy_x86_use_avx);
+    return OPAL_SUCCESS;
+}
+
+static int opal_memcpy_x86_open(void)
+{
+    size_t threshold = mca_memcpy_x86_nt_threshold;
+
+    opal_memcpy_x86_nt = opal_memcpy_x86_nt_sse2;
+#if OPAL_MCA_MEMCPY_X86_HAVE_AVX
+    if (mca_memcpy_x86_use_avx && opal_memcpy_x86_have_avx()) {
+        opal_memcpy_x86_nt = opal_memcpy_x86_nt_avx;
+    }
+#endif  /* OPAL_MCA_MEMCPY_X86_HAVE_AVX */
+
+    if (0 == threshold) {
+        /* A copy larger than about half the last level cache would
+         * evict most of the working set anyway. */
+        long llc = -1;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+        llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+        if (llc <= 0) {
+            llc = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        }
+#endif
+        threshold = (llc > 0) ? (size_t) llc / 2 : 1024 * 1024;
+    }
+    if (threshold < OPAL_MEMCPY_X86_NT_MIN) {
+        threshold = OPAL_MEMCPY_X86_NT_MIN;
+    }
+    opal_memcpy_x86_nt_threshold = threshold;
+
+    return OPAL_SUCCESS;
+}
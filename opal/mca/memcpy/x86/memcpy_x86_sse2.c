@@ -0,0 +1,57 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <emmintrin.h>
+
+#include "opal/mca/memcpy/x86/memcpy_x86.h"
+
+/*
+ * Copy with non-temporal stores, 64 bytes (a cache line) at a time.
+ * The destination is aligned first since the streaming stores require
+ * it; the source is read with unaligned loads.  Only used for copies
+ * larger than opal_memcpy_x86_nt_threshold, so the head and tail
+ * handling does not matter.
+ */
+void *opal_memcpy_x86_nt_sse2(void *dst, const void *src, size_t length)
+{
+    unsigned char *d = (unsigned char *) dst;
+    const unsigned char *s = (const unsigned char *) src;
+    size_t head = (16 - ((uintptr_t) d & 15)) & 15;
+
+    if (head > length) {
+        head = length;
+    }
+    if (head) {
+        memcpy(d, s, head);
+        d += head; s += head; length -= head;
+    }
+
+    for (; length >= 64; length -= 64, d += 64, s += 64) {
+        __m128i v0 = _mm_loadu_si128((const __m128i *) (s +  0));
+        __m128i v1 = _mm_loadu_si128((const __m128i *) (s + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i *) (s + 32));
+        __m128i v3 = _mm_loadu_si128((const __m128i *) (s + 48));
+        _mm_stream_si128((__m128i *) (d +  0), v0);
+        _mm_stream_si128((__m128i *) (d + 16), v1);
+        _mm_stream_si128((__m128i *) (d + 32), v2);
+        _mm_stream_si128((__m128i *) (d + 48), v3);
+    }
+    /* make the streaming stores visible before anybody (e.g. a flag
+     * write in shared memory) can observe the copy as complete */
+    _mm_sfence();
+
+    if (length) {
+        memcpy(d, s, length);
+    }
+    return dst;
+}
@@ -26,8 +26,19 @@
 #ifndef OPAL_MCA_THREADS_ARGOBOTS_THREADS_ARGOBOTS_H
 #define OPAL_MCA_THREADS_ARGOBOTS_THREADS_ARGOBOTS_H
 
+#include "opal_config.h"
+
 #include <abt.h>
 
+/* waiting threads park on their synchronization and a dedicated ULT
+ * drives opal_progress */
+OPAL_DECLSPEC extern bool opal_threads_argobots_progress_ult;
+/* run the progress ULT on its own execution stream */
+OPAL_DECLSPEC extern bool opal_threads_argobots_progress_xstream;
+
+/* stop the progress ULT, if it was started */
+void opal_threads_argobots_progress_fini(void);
+
 static inline void opal_threads_argobots_ensure_init(void)
 {
     if (ABT_initialized() != 0) {
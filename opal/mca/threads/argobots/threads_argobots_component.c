@@ -27,9 +27,15 @@
 #include "opal/mca/threads/thread.h"
 #include "opal/mca/threads/threads.h"
 #include "opal/constants.h"
+#include "opal/mca/base/mca_base_var.h"
 #include <abt.h>
 
+static int opal_threads_argobots_register(void);
 static int opal_threads_argobots_open(void);
+static int opal_threads_argobots_close(void);
+
+bool opal_threads_argobots_progress_ult = false;
+bool opal_threads_argobots_progress_xstream = false;
 
 const opal_threads_base_component_1_0_0_t mca_threads_argobots_component = {
     /* First, the mca_component_t struct containing meta information
@@ -43,6 +49,8 @@ const opal_threads_base_component_1_0_0_t mca_threads_argobots_component = {
                               OPAL_RELEASE_VERSION),
 
         .mca_open_component = opal_threads_argobots_open,
+        .mca_close_component = opal_threads_argobots_close,
+        .mca_register_component_params = opal_threads_argobots_register,
     },
     .threadsc_data = {
         /* The component is checkpoint ready */
@@ -50,8 +58,39 @@ const opal_threads_base_component_1_0_0_t mca_threads_argobots_component = {
     },
 };
 
+static int opal_threads_argobots_register(void)
+{
+    opal_threads_argobots_progress_ult = false;
+    (void) mca_base_component_var_register(&mca_threads_argobots_component.threadsc_version,
+                                           "progress_ult",
+                                           "Progress with a dedicated ULT. Threads waiting for "
+                                           "the completion of a request block on their condition "
+                                           "until they are signaled instead of calling "
+                                           "opal_progress in turn, so that blocked MPI calls do "
+                                           "not take execution stream time away from other ULTs",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &opal_threads_argobots_progress_ult);
+    opal_threads_argobots_progress_xstream = false;
+    (void) mca_base_component_var_register(&mca_threads_argobots_component.threadsc_version,
+                                           "progress_xstream",
+                                           "Run the progress ULT on an execution stream of its "
+                                           "own instead of the one of the first waiting thread "
+                                           "(requires threads_argobots_progress_ult)",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &opal_threads_argobots_progress_xstream);
+    return OPAL_SUCCESS;
+}
+
 int opal_threads_argobots_open(void)
 {
     opal_threads_argobots_ensure_init();
     return OPAL_SUCCESS;
 }
+
+static int opal_threads_argobots_close(void)
+{
+    opal_threads_argobots_progress_fini();
+    return OPAL_SUCCESS;
+}
@@ -23,6 +23,118 @@ static ompi_wait_sync_t *wait_sync_list = NULL;
 
 static opal_atomic_int32_t num_thread_in_progress = 0;
 
+/* state of the progress ULT (threads_argobots_progress_ult) */
+static bool progress_started = false;
+static volatile bool progress_stop = false;
+static opal_atomic_int32_t progress_waiters = 0;
+static ABT_mutex progress_lock;
+static ABT_cond progress_cond;
+static ABT_thread progress_thread = ABT_THREAD_NULL;
+static ABT_xstream progress_es = ABT_XSTREAM_NULL;
+
+/*
+ * Body of the progress ULT: drive opal_progress as long as somebody is
+ * waiting, park otherwise.
+ */
+static void progress_ult(void *arg)
+{
+    while (!progress_stop) {
+        if (0 == progress_waiters) {
+            ABT_mutex_lock(progress_lock);
+            while (0 == progress_waiters && !progress_stop) {
+                ABT_cond_wait(progress_cond, progress_lock);
+            }
+            ABT_mutex_unlock(progress_lock);
+            continue;
+        }
+        opal_progress();
+        ABT_thread_yield();
+    }
+}
+
+static int progress_start(void)
+{
+    ABT_xstream es;
+    int rc = ABT_SUCCESS;
+
+    OPAL_THREAD_LOCK(&wait_sync_lock);
+    if (progress_started) {
+        OPAL_THREAD_UNLOCK(&wait_sync_lock);
+        return OPAL_SUCCESS;
+    }
+    ABT_mutex_create(&progress_lock);
+    ABT_cond_create(&progress_cond);
+    if (opal_threads_argobots_progress_xstream) {
+        rc = ABT_xstream_create(ABT_SCHED_NULL, &progress_es);
+        es = progress_es;
+    } else {
+        ABT_xstream_self(&es);
+    }
+    if (ABT_SUCCESS == rc) {
+        rc = ABT_thread_create_on_xstream(es, progress_ult, NULL, ABT_THREAD_ATTR_NULL,
+                                          &progress_thread);
+    }
+    if (ABT_SUCCESS != rc) {
+        /* fall back to progressing from the waiting threads */
+        if (ABT_XSTREAM_NULL != progress_es) {
+            ABT_xstream_join(progress_es);
+            ABT_xstream_free(&progress_es);
+        }
+        ABT_cond_free(&progress_cond);
+        ABT_mutex_free(&progress_lock);
+        opal_threads_argobots_progress_ult = false;
+        OPAL_THREAD_UNLOCK(&wait_sync_lock);
+        return OPAL_ERROR;
+    }
+    progress_started = true;
+    OPAL_THREAD_UNLOCK(&wait_sync_lock);
+    return OPAL_SUCCESS;
+}
+
+void opal_threads_argobots_progress_fini(void)
+{
+    if (!progress_started) {
+        return;
+    }
+    ABT_mutex_lock(progress_lock);
+    progress_stop = true;
+    ABT_cond_signal(progress_cond);
+    ABT_mutex_unlock(progress_lock);
+    /* ABT_thread_free waits for the termination of the ULT */
+    ABT_thread_free(&progress_thread);
+    if (ABT_XSTREAM_NULL != progress_es) {
+        ABT_xstream_join(progress_es);
+        ABT_xstream_free(&progress_es);
+    }
+    ABT_cond_free(&progress_cond);
+    ABT_mutex_free(&progress_lock);
+    progress_started = false;
+    progress_stop = false;
+}
+
+/*
+ * Wait for the synchronization while the progress ULT drives the
+ * progress: the waiting thread is descheduled until it is signaled.
+ */
+static int sync_wait_parked(ompi_wait_sync_t *sync)
+{
+    ABT_mutex_lock(progress_lock);
+    if (1 == OPAL_THREAD_ADD_FETCH32(&progress_waiters, 1)) {
+        ABT_cond_signal(progress_cond);
+    }
+    ABT_mutex_unlock(progress_lock);
+
+    ABT_mutex_lock(sync->lock);
+    while (sync->count > 0) {
+        ABT_cond_wait(sync->condition, sync->lock);
+    }
+    ABT_mutex_unlock(sync->lock);
+
+    OPAL_THREAD_ADD_FETCH32(&progress_waiters, -1);
+
+    return (0 == sync->status) ? OPAL_SUCCESS : OPAL_ERROR;
+}
+
 #define WAIT_SYNC_PASS_OWNERSHIP(who)                  \
     do {                                               \
         opal_threads_argobots_ensure_init();           \
@@ -42,6 +154,11 @@ int ompi_sync_wait_mt(ompi_wait_sync_t *sync)
         return (0 == sync->status) ? OPAL_SUCCESS : OPAL_ERROR;
     }
 
+    if (opal_threads_argobots_progress_ult &&
+        (progress_started || OPAL_SUCCESS == progress_start())) {
+        return sync_wait_parked(sync);
+    }
+
     /* lock so nobody can signal us during the list updating */
     ABT_mutex_lock(sync->lock);
 
@@ -56,5 +56,7 @@ AS_IF([test x"$opal_thread_type_found" = x""],
 
 AC_MSG_RESULT([Found thread type $opal_thread_type_found])
 
+AM_CONDITIONAL([OPAL_HAVE_THREADS_ARGOBOTS], [test "$opal_thread_type_found" = "argobots"])
+
 OPAL_SUMMARY_ADD([[Miscellaneous]],[[Threading Package]],[], [$opal_thread_type_found])
 ])dnl
@@ -44,6 +44,7 @@
 #include "opal/mca/shmem/base/base.h"
 #include "opal/mca/base/mca_base_var.h"
 #include "opal/runtime/opal_params.h"
+#include "opal/runtime/opal_progress.h"
 #include "opal/dss/dss.h"
 #include "opal/util/opal_environ.h"
 #include "opal/util/show_help.h"
@@ -176,6 +177,37 @@ int opal_register_params(void)
                                  &opal_progress_yield_when_idle);
 #endif
 
+    ret = mca_base_var_register ("opal", "opal", "progress", "backoff_threshold",
+                                 "Number of consecutive polls without any event after which a progress "
+                                 "callback is polled half as often. The first poll that finds an event "
+                                 "restores polling on every call. 0 disables the backoff (default: 1024)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_6, MCA_BASE_VAR_SCOPE_LOCAL,
+                                 &opal_progress_backoff_threshold);
+    if (0 > ret) {
+        return ret;
+    }
+
+    ret = mca_base_var_register ("opal", "opal", "progress", "backoff_max",
+                                 "Largest number of calls to the progress engine between two polls of an "
+                                 "idle progress callback (default: 8)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_6, MCA_BASE_VAR_SCOPE_LOCAL,
+                                 &opal_progress_backoff_max);
+    if (0 > ret) {
+        return ret;
+    }
+
+    ret = mca_base_var_register ("opal", "opal", "progress", "timing",
+                                 "Measure the time spent in every progress callback and report it in the "
+                                 "opal_progress_<callback>_time performance variables (default: false)",
+                                 MCA_BASE_VAR_TYPE_BOOL, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_6, MCA_BASE_VAR_SCOPE_LOCAL,
+                                 &opal_progress_timing);
+    if (0 > ret) {
+        return ret;
+    }
+
 #if OPAL_ENABLE_DEBUG
     opal_progress_debug = false;
     ret = mca_base_var_register ("opal", "opal", "progress", "debug",
@@ -25,6 +25,7 @@
 
 #include "opal_config.h"
 
+#include <string.h>
 #ifdef HAVE_SCHED_H
 #include <sched.h>
 #endif
@@ -35,7 +36,9 @@
 #include "opal/constants.h"
 #include "opal/mca/timer/base/base.h"
 #include "opal/util/output.h"
+#include "opal/util/printf.h"
 #include "opal/runtime/opal_params.h"
+#include "opal/mca/base/mca_base_pvar.h"
 
 #define OPAL_PROGRESS_USE_TIMERS (OPAL_TIMER_CYCLE_SUPPORTED || OPAL_TIMER_USEC_SUPPORTED)
 #define OPAL_PROGRESS_ONLY_USEC_NATIVE (OPAL_TIMER_USEC_NATIVE && !OPAL_TIMER_CYCLE_NATIVE)
@@ -49,6 +52,43 @@ bool opal_progress_debug = false;
  */
 static int opal_progress_event_flag = OPAL_EVLOOP_ONCE | OPAL_EVLOOP_NONBLOCK;
 int opal_progress_spin_count = 10000;
+int opal_progress_backoff_threshold = 1024;
+int opal_progress_backoff_max = 8;
+bool opal_progress_timing = false;
+
+
+/**
+ * State of a progress callback.  An entry is created the first time a
+ * callback is registered or named and lives until the progress engine
+ * is finalized, so the performance variables pointing at it stay valid
+ * after the callback has been unregistered.
+ *
+ * Callbacks that keep returning 0 are polled less often: after
+ * opal_progress_backoff_threshold idle polls the polling interval is
+ * doubled, up to opal_progress_backoff_max calls to opal_progress().
+ * The first poll that reports events brings the interval back to 1.
+ *
+ * The fields are updated without atomics by whichever thread is in
+ * opal_progress(). The interval is only ever stored from a local copy,
+ * so it stays a power of two within opal_progress_backoff_max, and
+ * whether a callback is polled only depends on the interval and the
+ * number of calls to opal_progress(). A race can lose an update of the
+ * counters, which delays a backoff or skews the statistics, but it can
+ * never stop a callback from being polled.
+ */
+typedef struct opal_progress_entry_t {
+    struct opal_progress_entry_t *next;
+    opal_progress_callback_t cb;
+    char *name;
+    /** poll the callback once every interval calls (a power of two) */
+    uint32_t interval;
+    /** polls without events at the current interval */
+    uint32_t idle;
+    unsigned long long calls;
+    unsigned long long hits;
+    unsigned long long skipped;
+    opal_timer_t time;
+} opal_progress_entry_t;
 
 
 /*
@@ -57,14 +97,18 @@ int opal_progress_spin_count = 10000;
 static opal_atomic_lock_t progress_lock;
 
 /* callbacks to progress */
-static volatile opal_progress_callback_t *callbacks = NULL;
+static opal_progress_entry_t * volatile *callbacks = NULL;
 static size_t callbacks_len = 0;
 static size_t callbacks_size = 0;
 
-static volatile opal_progress_callback_t *callbacks_lp = NULL;
+static opal_progress_entry_t * volatile *callbacks_lp = NULL;
 static size_t callbacks_lp_len = 0;
 static size_t callbacks_lp_size = 0;
 
+/* every entry ever created */
+static opal_progress_entry_t *entries = NULL;
+static int entries_count = 0;
+
 /* do we want to call sched_yield() if nothing happened */
 bool opal_progress_yield_when_idle = false;
 
@@ -95,11 +139,15 @@ static int debug_output = -1;
  */
 static int fake_cb(void) { return 0; }
 
-static int _opal_progress_unregister (opal_progress_callback_t cb, volatile opal_progress_callback_t *callback_array,
+static opal_progress_entry_t fake_entry = {.cb = fake_cb, .interval = 1};
+
+static int _opal_progress_unregister (opal_progress_callback_t cb, opal_progress_entry_t * volatile *callback_array,
                                       size_t *callback_array_len);
 
 static void opal_progress_finalize (void)
 {
+    opal_progress_entry_t *entry;
+
     /* free memory associated with the callbacks */
     opal_atomic_lock(&progress_lock);
 
@@ -113,6 +161,15 @@ static void opal_progress_finalize (void)
     free ((void *) callbacks_lp);
     callbacks_lp = NULL;
 
+    /* the performance variables check for callbacks == NULL before
+     * touching an entry */
+    while (NULL != (entry = entries)) {
+        entries = entry->next;
+        free (entry->name);
+        free (entry);
+    }
+    entries_count = 0;
+
     opal_atomic_unlock(&progress_lock);
 }
 
@@ -147,11 +204,11 @@ opal_progress_init(void)
     }
 
     for (size_t i = 0 ; i < callbacks_size ; ++i) {
-        callbacks[i] = fake_cb;
+        callbacks[i] = &fake_entry;
     }
 
     for (size_t i = 0 ; i < callbacks_lp_size ; ++i) {
-        callbacks_lp[i] = fake_cb;
+        callbacks_lp[i] = &fake_entry;
     }
 
     OPAL_OUTPUT((debug_output, "progress: initialized event flag to: %x",
@@ -207,6 +264,54 @@ static int opal_progress_events(void)
     return events;
 }
 
+static inline opal_timer_t opal_progress_time (void)
+{
+#if OPAL_PROGRESS_ONLY_USEC_NATIVE
+    return opal_timer_base_get_usec();
+#else
+    return opal_timer_base_get_cycles();
+#endif
+}
+
+/*
+ * Poll one callback unless it is backing off. calls counts the rounds
+ * of polls of the callback's list.
+ */
+static inline int opal_progress_poll (opal_progress_entry_t *entry, uint32_t calls)
+{
+    uint32_t interval = entry->interval;
+    int events;
+
+    if (calls & (interval - 1)) {
+        ++entry->skipped;
+        return 0;
+    }
+
+    if (OPAL_UNLIKELY(opal_progress_timing)) {
+        opal_timer_t start = opal_progress_time ();
+        events = entry->cb ();
+        entry->time += opal_progress_time () - start;
+    } else {
+        events = entry->cb ();
+    }
+
+    ++entry->calls;
+    if (events > 0) {
+        ++entry->hits;
+        if (1 != interval) {
+            entry->interval = 1;
+        }
+        entry->idle = 0;
+    } else if ((int64_t) interval * 2 <= opal_progress_backoff_max &&
+               opal_progress_backoff_threshold > 0 &&
+               ++entry->idle >= (uint32_t) opal_progress_backoff_threshold) {
+        entry->interval = interval << 1;
+        entry->idle = 0;
+    }
+
+    return events;
+}
+
 /*
  * Progress the event library and any functions that have registered to
  * be called.  We don't propogate errors from the progress functions,
@@ -222,12 +327,13 @@ void
 opal_progress(void)
 {
     static uint32_t num_calls = 0;
+    uint32_t calls = num_calls++;
     size_t i;
     int events = 0;
 
     /* progress all registered callbacks */
     for (i = 0 ; i < callbacks_len ; ++i) {
-        events += (callbacks[i])();
+        events += opal_progress_poll (callbacks[i], calls);
     }
 
     /* Run low priority callbacks and events once every 8 calls to opal_progress().
@@ -236,9 +342,9 @@ opal_progress(void)
      * number of calls may be inaccurate, but since it will eventually be incremented,
      * it's not a problem.
      */
-    if (((num_calls++) & 0x7) == 0) {
+    if ((calls & 0x7) == 0) {
         for (i = 0 ; i < callbacks_lp_len ; ++i) {
-            events += (callbacks_lp[i])();
+            events += opal_progress_poll (callbacks_lp[i], calls >> 3);
         }
 
         opal_progress_events();
@@ -367,11 +473,11 @@ opal_progress_set_event_poll_rate(int polltime)
 #endif
 }
 
-static int opal_progress_find_cb (opal_progress_callback_t cb, volatile opal_progress_callback_t *cbs,
+static int opal_progress_find_cb (opal_progress_callback_t cb, opal_progress_entry_t * volatile *cbs,
                                      size_t cbs_len)
 {
     for (size_t i = 0 ; i < cbs_len ; ++i) {
-        if (cbs[i] == cb) {
+        if (cbs[i]->cb == cb) {
             return (int) i;
         }
     }
@@ -379,20 +485,177 @@ static int opal_progress_find_cb (opal_progress_callback_t cb, volatile opal_pro
     return OPAL_ERR_NOT_FOUND;
 }
 
-static int _opal_progress_register (opal_progress_callback_t cb, volatile opal_progress_callback_t **cbs,
+/*
+ * Performance variables.  All of them are bound to an entry through the
+ * variable context and read nothing once the engine has been finalized.
+ */
+static int opal_progress_pvar_calls (const struct mca_base_pvar_t *pvar, void *value, void *obj)
+{
+    opal_progress_entry_t *entry = (opal_progress_entry_t *) pvar->ctx;
+
+    if (NULL == callbacks) {
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+
+    *((unsigned long long *) value) = entry->calls;
+    return OPAL_SUCCESS;
+}
+
+static int opal_progress_pvar_skipped (const struct mca_base_pvar_t *pvar, void *value, void *obj)
+{
+    opal_progress_entry_t *entry = (opal_progress_entry_t *) pvar->ctx;
+
+    if (NULL == callbacks) {
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+
+    *((unsigned long long *) value) = entry->skipped;
+    return OPAL_SUCCESS;
+}
+
+static int opal_progress_pvar_hit_rate (const struct mca_base_pvar_t *pvar, void *value, void *obj)
+{
+    opal_progress_entry_t *entry = (opal_progress_entry_t *) pvar->ctx;
+    unsigned long long calls;
+
+    if (NULL == callbacks) {
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+
+    calls = entry->calls;
+    *((double *) value) = calls ? (double) entry->hits / (double) calls : 0.0;
+    return OPAL_SUCCESS;
+}
+
+static int opal_progress_pvar_time (const struct mca_base_pvar_t *pvar, void *value, void *obj)
+{
+    opal_progress_entry_t *entry = (opal_progress_entry_t *) pvar->ctx;
+    double freq;
+
+    if (NULL == callbacks) {
+        return OPAL_ERR_NOT_AVAILABLE;
+    }
+
+#if OPAL_PROGRESS_ONLY_USEC_NATIVE
+    freq = 1000000.0;
+#else
+    freq = (double) opal_timer_base_get_freq ();
+#endif
+    *((double *) value) = freq > 0.0 ? (double) entry->time / freq : 0.0;
+    return OPAL_SUCCESS;
+}
+
+static void opal_progress_register_pvars (opal_progress_entry_t *entry)
+{
+    const int flags = MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS;
+    char *name, *desc;
+
+    opal_asprintf (&name, "%s_calls", entry->name);
+    opal_asprintf (&desc, "Number of times the progress callback %s has been polled", entry->name);
+    (void) mca_base_pvar_register ("opal", "opal", "progress", name, desc, OPAL_INFO_LVL_5,
+                                   MCA_BASE_PVAR_CLASS_COUNTER, MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG,
+                                   NULL, MCA_BASE_VAR_BIND_NO_OBJECT, flags, opal_progress_pvar_calls,
+                                   NULL, NULL, entry);
+    free (name);
+    free (desc);
+
+    opal_asprintf (&name, "%s_skipped", entry->name);
+    opal_asprintf (&desc, "Number of polls of the progress callback %s skipped because it "
+                   "was idle", entry->name);
+    (void) mca_base_pvar_register ("opal", "opal", "progress", name, desc, OPAL_INFO_LVL_5,
+                                   MCA_BASE_PVAR_CLASS_COUNTER, MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG,
+                                   NULL, MCA_BASE_VAR_BIND_NO_OBJECT, flags, opal_progress_pvar_skipped,
+                                   NULL, NULL, entry);
+    free (name);
+    free (desc);
+
+    opal_asprintf (&name, "%s_hit_rate", entry->name);
+    opal_asprintf (&desc, "Fraction of the polls of the progress callback %s that progressed "
+                   "at least one event", entry->name);
+    (void) mca_base_pvar_register ("opal", "opal", "progress", name, desc, OPAL_INFO_LVL_5,
+                                   MCA_BASE_PVAR_CLASS_PERCENTAGE, MCA_BASE_VAR_TYPE_DOUBLE,
+                                   NULL, MCA_BASE_VAR_BIND_NO_OBJECT, flags, opal_progress_pvar_hit_rate,
+                                   NULL, NULL, entry);
+    free (name);
+    free (desc);
+
+    opal_asprintf (&name, "%s_time", entry->name);
+    opal_asprintf (&desc, "Time spent in the progress callback %s in seconds (only measured "
+                   "with opal_progress_timing set)", entry->name);
+    (void) mca_base_pvar_register ("opal", "opal", "progress", name, desc, OPAL_INFO_LVL_5,
+                                   MCA_BASE_PVAR_CLASS_TIMER, MCA_BASE_VAR_TYPE_DOUBLE,
+                                   NULL, MCA_BASE_VAR_BIND_NO_OBJECT, flags, opal_progress_pvar_time,
+                                   NULL, NULL, entry);
+    free (name);
+    free (desc);
+}
+
+/*
+ * Find the entry of a callback, creating it if needed.  Called with the
+ * progress lock held.
+ */
+static opal_progress_entry_t *opal_progress_get_entry (opal_progress_callback_t cb, const char *name)
+{
+    opal_progress_entry_t *entry;
+
+    for (entry = entries ; NULL != entry ; entry = entry->next) {
+        if (entry->cb == cb) {
+            if (NULL != name && 0 != strcmp (name, entry->name)) {
+                /* named after it was registered. the variables under the
+                 * old name keep working */
+                free (entry->name);
+                entry->name = strdup (name);
+                opal_progress_register_pvars (entry);
+            }
+            return entry;
+        }
+    }
+
+    entry = calloc (1, sizeof (*entry));
+    if (NULL == entry) {
+        return NULL;
+    }
+
+    entry->cb = cb;
+    entry->interval = 1;
+    if (NULL != name) {
+        entry->name = strdup (name);
+    } else {
+        opal_asprintf (&entry->name, "callback_%d", entries_count);
+    }
+    entry->next = entries;
+    entries = entry;
+    ++entries_count;
+
+    opal_progress_register_pvars (entry);
+
+    return entry;
+}
+
+static int _opal_progress_register (opal_progress_callback_t cb, opal_progress_entry_t * volatile **cbs,
                                     size_t *cbs_size, size_t *cbs_len)
 {
+    opal_progress_entry_t *entry;
     int ret = OPAL_SUCCESS;
 
     if (OPAL_ERR_NOT_FOUND != opal_progress_find_cb (cb, *cbs, *cbs_len)) {
         return OPAL_SUCCESS;
     }
 
+    entry = opal_progress_get_entry (cb, NULL);
+    if (NULL == entry) {
+        return OPAL_ERR_TEMP_OUT_OF_RESOURCE;
+    }
+
+    /* a callback registered again starts out busy */
+    entry->interval = 1;
+    entry->idle = 0;
+
     /* see if we need to allocate more space */
     if (*cbs_len + 1 > *cbs_size) {
-        opal_progress_callback_t *tmp, *old;
+        opal_progress_entry_t **tmp, **old;
 
-        tmp = (opal_progress_callback_t *) malloc (sizeof (tmp[0]) * 2 * *cbs_size);
+        tmp = (opal_progress_entry_t **) malloc (sizeof (tmp[0]) * 2 * *cbs_size);
         if (tmp == NULL) {
             return OPAL_ERR_TEMP_OUT_OF_RESOURCE;
         }
@@ -403,13 +666,13 @@ static int _opal_progress_register (opal_progress_callback_t cb, volatile opal_p
         }
 
         for (size_t i = *cbs_len ; i < 2 * *cbs_size ; ++i) {
-            tmp[i] = fake_cb;
+            tmp[i] = &fake_entry;
         }
 
         opal_atomic_wmb ();
 
         /* swap out callback array */
-        old = (opal_progress_callback_t *) opal_atomic_swap_ptr ((opal_atomic_intptr_t *) cbs, (intptr_t) tmp);
+        old = (opal_progress_entry_t **) opal_atomic_swap_ptr ((opal_atomic_intptr_t *) cbs, (intptr_t) tmp);
 
         opal_atomic_wmb ();
 
@@ -417,7 +680,7 @@ static int _opal_progress_register (opal_progress_callback_t cb, volatile opal_p
         *cbs_size *= 2;
     }
 
-    cbs[0][*cbs_len] = cb;
+    cbs[0][*cbs_len] = entry;
     ++*cbs_len;
 
     opal_atomic_wmb ();
@@ -455,7 +718,18 @@ int opal_progress_register_lp (opal_progress_callback_t cb)
     return ret;
 }
 
-static int _opal_progress_unregister (opal_progress_callback_t cb, volatile opal_progress_callback_t *callback_array,
+int opal_progress_set_name (opal_progress_callback_t cb, const char *name)
+{
+    opal_progress_entry_t *entry;
+
+    opal_atomic_lock(&progress_lock);
+    entry = opal_progress_get_entry (cb, name);
+    opal_atomic_unlock(&progress_lock);
+
+    return (NULL == entry) ? OPAL_ERR_OUT_OF_RESOURCE : OPAL_SUCCESS;
+}
+
+static int _opal_progress_unregister (opal_progress_callback_t cb, opal_progress_entry_t * volatile *callback_array,
                                       size_t *callback_array_len)
 {
     int ret = opal_progress_find_cb (cb, callback_array, *callback_array_len);
@@ -473,7 +747,7 @@ static int _opal_progress_unregister (opal_progress_callback_t cb, volatile opal
         (void) opal_atomic_swap_ptr ((opal_atomic_intptr_t *) (callback_array + i), (intptr_t) callback_array[i+1]);
     }
 
-    callback_array[*callback_array_len] = fake_cb;
+    callback_array[*callback_array_len] = &fake_entry;
     --*callback_array_len;
 
     return OPAL_SUCCESS;
@@ -167,8 +167,30 @@ OPAL_DECLSPEC int opal_progress_register_lp (opal_progress_callback_t cb);
 OPAL_DECLSPEC int opal_progress_unregister(opal_progress_callback_t cb);
 
 
+/**
+ * Name a progress callback
+ *
+ * Give a callback a name for its performance variables
+ * (opal_progress_<name>_calls, _skipped, _hit_rate and _time).  Callbacks
+ * that are never named are called callback_<n>.  Best called before the
+ * callback is registered.
+ */
+OPAL_DECLSPEC int opal_progress_set_name(opal_progress_callback_t cb, const char *name);
+
+
 OPAL_DECLSPEC extern int opal_progress_spin_count;
 
+/* number of idle polls after which a callback is polled half as often
+ * (0 disables the backoff) */
+OPAL_DECLSPEC extern int opal_progress_backoff_threshold;
+
+/* largest number of calls to opal_progress() between two polls of an
+ * idle callback */
+OPAL_DECLSPEC extern int opal_progress_backoff_max;
+
+/* measure the time spent in every callback */
+OPAL_DECLSPEC extern bool opal_progress_timing;
+
 /* do we want to call sched_yield() if nothing happened */
 OPAL_DECLSPEC extern bool opal_progress_yield_when_idle;
 
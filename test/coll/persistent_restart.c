@@ -0,0 +1,158 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures the cost of restarting a persistent collective
+ * (MPI_Start + MPI_Wait on an MPIX_<coll>_init request) against
+ * issuing the equivalent nonblocking collective every iteration.
+ *
+ * usage: mpirun -np <n> ./persistent_restart [iterations]
+ */
+
+#include "mpi.h"
+#include "mpi-ext.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_COUNT (1 << 16)
+
+#if defined(OMPI_HAVE_MPI_EXT_PCOLLREQ) && OMPI_HAVE_MPI_EXT_PCOLLREQ
+
+static double time_barrier(int iters, int persistent)
+{
+    MPI_Request req;
+    double start;
+    int i;
+
+    if (persistent) {
+        MPIX_Barrier_init(MPI_COMM_WORLD, MPI_INFO_NULL, &req);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = MPI_Wtime();
+    for (i = 0; i < iters; i++) {
+        if (persistent) {
+            MPI_Start(&req);
+        } else {
+            MPI_Ibarrier(MPI_COMM_WORLD, &req);
+        }
+        MPI_Wait(&req, MPI_STATUS_IGNORE);
+    }
+    start = MPI_Wtime() - start;
+
+    if (persistent) {
+        MPI_Request_free(&req);
+    }
+
+    return start;
+}
+
+static double time_allreduce(int iters, int count, int persistent,
+                             const int *sbuf, int *rbuf)
+{
+    MPI_Request req;
+    double start;
+    int i;
+
+    if (persistent) {
+        MPIX_Allreduce_init(sbuf, rbuf, count, MPI_INT, MPI_SUM,
+                            MPI_COMM_WORLD, MPI_INFO_NULL, &req);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = MPI_Wtime();
+    for (i = 0; i < iters; i++) {
+        if (persistent) {
+            MPI_Start(&req);
+        } else {
+            MPI_Iallreduce(sbuf, rbuf, count, MPI_INT, MPI_SUM,
+                           MPI_COMM_WORLD, &req);
+        }
+        MPI_Wait(&req, MPI_STATUS_IGNORE);
+    }
+    start = MPI_Wtime() - start;
+
+    if (persistent) {
+        MPI_Request_free(&req);
+    }
+
+    return start;
+}
+
+static void report(const char *name, int count, int iters,
+                   double t_nb, double t_p)
+{
+    double t[2] = {t_nb, t_p}, tmax[2];
+    int rank;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Reduce(t, tmax, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf("%-10s %8d %14.3f %14.3f %9.2f%%\n", name, count,
+               tmax[0] * 1e6 / iters, tmax[1] * 1e6 / iters,
+               100.0 * (tmax[0] - tmax[1]) / tmax[0]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int iters = 10000, rank, size, count, i;
+    int *sbuf, *rbuf;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc > 1) {
+        iters = atoi(argv[1]);
+    }
+
+    sbuf = (int *)malloc(MAX_COUNT * sizeof(int));
+    rbuf = (int *)malloc(MAX_COUNT * sizeof(int));
+    for (i = 0; i < MAX_COUNT; i++) {
+        sbuf[i] = rank + i;
+    }
+
+    if (0 == rank) {
+        printf("# %d processes, %d iterations, times in usec per iteration\n",
+               size, iters);
+        printf("%-10s %8s %14s %14s %10s\n", "coll", "count",
+               "nonblocking", "persistent", "saved");
+    }
+
+    /* warm up the connections */
+    time_barrier(100, 0);
+
+    report("barrier", 0, iters, time_barrier(iters, 0), time_barrier(iters, 1));
+    for (count = 1; count <= MAX_COUNT; count *= 16) {
+        double t_nb = time_allreduce(iters, count, 0, sbuf, rbuf);
+        double t_p = time_allreduce(iters, count, 1, sbuf, rbuf);
+
+        for (i = 0; i < count; i++) {
+            if (rbuf[i] != size * i + size * (size - 1) / 2) {
+                fprintf(stderr, "[%d] wrong result at %d: %d\n", rank, i, rbuf[i]);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+        }
+        report("allreduce", count, iters, t_nb, t_p);
+    }
+
+    free(sbuf);
+    free(rbuf);
+    MPI_Finalize();
+
+    return 0;
+}
+
+#else
+
+int main(int argc, char **argv)
+{
+    fprintf(stderr, "persistent collectives (pcollreq extension) not available\n");
+    return 77;
+}
+
+#endif
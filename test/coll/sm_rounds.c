@@ -0,0 +1,127 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Checks the results of allgather, alltoall, gather and scatter on
+ * messages that need several rounds through the shared memory segments
+ * of coll/sm, interleaved with each other on the same communicator so
+ * that every operation also runs as a later operation on a flag that
+ * was already used.  Meant to be run with coll/sm selected:
+ *
+ *   mpirun -np 4 --mca coll sm,basic,libnbc,self --mca coll_sm_priority 100 ./sm_rounds
+ *
+ * usage: mpirun -np <p> ./sm_rounds [iterations]
+ */
+
+#include "mpi.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* sizes in ints, the largest ones cover many 8k fragments per process */
+static const int counts[] = { 1, 1000, 4096, 50000, 300000 };
+#define NCOUNTS ((int) (sizeof(counts) / sizeof(counts[0])))
+
+static int value(int rank, int peer, int i, int iter)
+{
+    return (rank * 7919 + peer * 104729 + i * 31 + iter) & 0x7fffffff;
+}
+
+static int verify(const char *name, const int *buf, int count, int rank, int peer, int iter,
+                  int sender_is_peer)
+{
+    int i, expected;
+
+    for (i = 0; i < count; i++) {
+        expected = sender_is_peer ? value(peer, rank, i, iter) : value(rank, peer, i, iter);
+        if (buf[i] != expected) {
+            fprintf(stderr, "%d: %s count %d iteration %d block %d element %d is %d, expected %d\n",
+                    rank, name, count, iter, peer, i, buf[i], expected);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, nprocs, iter, iterations = 4, c, count, peer, i, root, errors = 0;
+    int *sbuf, *rbuf;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
+    if (argc > 1) {
+        iterations = atoi(argv[1]);
+    }
+
+    sbuf = malloc(sizeof(int) * counts[NCOUNTS - 1] * nprocs);
+    rbuf = malloc(sizeof(int) * counts[NCOUNTS - 1] * nprocs);
+    if (NULL == sbuf || NULL == rbuf) {
+        fprintf(stderr, "cannot allocate the buffers\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    for (iter = 0; iter < iterations; iter++) {
+        for (c = 0; c < NCOUNTS; c++) {
+            count = counts[c];
+            root = (iter + c) % nprocs;
+
+            /* allgather: block p of everybody holds the data of p */
+            for (i = 0; i < count; i++) {
+                sbuf[i] = value(rank, 0, i, iter);
+            }
+            MPI_Allgather(sbuf, count, MPI_INT, rbuf, count, MPI_INT, MPI_COMM_WORLD);
+            for (peer = 0; peer < nprocs; peer++) {
+                errors += verify("allgather", rbuf + peer * count, count, 0, peer, iter, 1);
+            }
+
+            /* alltoall: block p of rank r holds what p prepared for r */
+            for (peer = 0; peer < nprocs; peer++) {
+                for (i = 0; i < count; i++) {
+                    sbuf[peer * count + i] = value(rank, peer, i, iter);
+                }
+            }
+            MPI_Alltoall(sbuf, count, MPI_INT, rbuf, count, MPI_INT, MPI_COMM_WORLD);
+            for (peer = 0; peer < nprocs; peer++) {
+                errors += verify("alltoall", rbuf + peer * count, count, rank, peer, iter, 1);
+            }
+
+            /* gather to a rotating root */
+            for (i = 0; i < count; i++) {
+                sbuf[i] = value(rank, root, i, iter);
+            }
+            MPI_Gather(sbuf, count, MPI_INT, rbuf, count, MPI_INT, root, MPI_COMM_WORLD);
+            if (rank == root) {
+                for (peer = 0; peer < nprocs; peer++) {
+                    errors += verify("gather", rbuf + peer * count, count, root, peer, iter, 1);
+                }
+            }
+
+            /* scatter from the same root */
+            if (rank == root) {
+                for (peer = 0; peer < nprocs; peer++) {
+                    for (i = 0; i < count; i++) {
+                        sbuf[peer * count + i] = value(root, peer, i, iter);
+                    }
+                }
+            }
+            MPI_Scatter(sbuf, count, MPI_INT, rbuf, count, MPI_INT, root, MPI_COMM_WORLD);
+            errors += verify("scatter", rbuf, count, rank, root, iter, 1);
+        }
+    }
+
+    free(sbuf);
+    free(rbuf);
+
+    MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf("%d iterations, %d errors\n", iterations, errors);
+    }
+    MPI_Finalize();
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,124 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures the communicator creation rate on MPI_COMM_WORLD.  Batches
+ * of communicators are created with MPI_Comm_dup, MPI_Comm_split (two
+ * colors) and MPI_Comm_create (all processes), then freed, and the rate
+ * of the slowest process is reported for an increasing batch size.  A
+ * last pattern duplicates a communicator and immediately frees it, the
+ * way libraries duplicate the communicator they are handed on entry.
+ *
+ * Run once with --mca mpi_comm_cid_block_size 0 and once with a block
+ * size (e.g. 64) to compare agreeing on every communicator ID against
+ * taking them from a reserved block.
+ *
+ * usage: mpirun -np <p> ./comm_create [max communicators]
+ */
+
+#include "mpi.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+    PATTERN_DUP,
+    PATTERN_SPLIT,
+    PATTERN_CREATE,
+    PATTERN_DUP_FREE,
+    PATTERN_COUNT
+};
+
+static const char *pattern_names[PATTERN_COUNT] = {
+    "dup", "split", "create", "dup+free"
+};
+
+static double time_pattern(int pattern, int count, MPI_Comm *comms)
+{
+    MPI_Group group;
+    int rank, i;
+    double rate;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_group(MPI_COMM_WORLD, &group);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    rate = MPI_Wtime();
+    for (i = 0; i < count; i++) {
+        switch (pattern) {
+        case PATTERN_DUP:
+            MPI_Comm_dup(MPI_COMM_WORLD, comms + i);
+            break;
+        case PATTERN_SPLIT:
+            MPI_Comm_split(MPI_COMM_WORLD, rank & 1, rank, comms + i);
+            break;
+        case PATTERN_CREATE:
+            MPI_Comm_create(MPI_COMM_WORLD, group, comms + i);
+            break;
+        default:
+            MPI_Comm_dup(MPI_COMM_WORLD, comms + i);
+            MPI_Comm_free(comms + i);
+            break;
+        }
+    }
+    rate = count / (MPI_Wtime() - rate);
+    MPI_Allreduce(MPI_IN_PLACE, &rate, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+
+    if (PATTERN_DUP_FREE != pattern) {
+        for (i = 0; i < count; i++) {
+            MPI_Comm_free(comms + i);
+        }
+    }
+    MPI_Group_free(&group);
+
+    return rate;
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, size, max_count = 4096, count, pattern;
+    MPI_Comm *comms;
+    double rate;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc > 1) {
+        max_count = atoi(argv[1]);
+    }
+
+    comms = malloc(sizeof(MPI_Comm) * max_count);
+
+    if (0 == rank) {
+        printf("# %d processes, communicators created per second\n", size);
+        printf("# %8s", "count");
+        for (pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+            printf(" %12s", pattern_names[pattern]);
+        }
+        printf("\n");
+    }
+
+    for (count = 16; count <= max_count; count *= 4) {
+        if (0 == rank) {
+            printf("  %8d", count);
+        }
+        for (pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+            rate = time_pattern(pattern, count, comms);
+            if (0 == rank) {
+                printf(" %12.0f", rate);
+            }
+        }
+        if (0 == rank) {
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+
+    free(comms);
+    MPI_Finalize();
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Checks communicator creation with several agreements on the
+ * communicator ID outstanding on the same parent.  Every iteration
+ * duplicates a fresh parent with two MPI_Comm_idup, and a blocking
+ * MPI_Comm_dup and MPI_Comm_split issued while both are pending.  The
+ * parent is freed before its children, and all of them are checked to
+ * be distinct, working communicators.  Meant to be run with a block of
+ * reserved IDs, with the processes progressing the requests at
+ * different times:
+ *
+ *   mpirun -np 4 --mca mpi_comm_cid_block_size 8 ./comm_idup
+ *
+ * usage: mpirun -np <p> ./comm_idup [iterations]
+ */
+
+#include "mpi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define NCHILDREN 4
+
+static int check(MPI_Comm *comms, int count, int rank, int nprocs)
+{
+    int i, j, result, sum, errors = 0;
+
+    for (i = 0; i < count; i++) {
+        sum = 0;
+        MPI_Allreduce(&rank, &sum, 1, MPI_INT, MPI_SUM, comms[i]);
+        if (sum != nprocs * (nprocs - 1) / 2) {
+            fprintf(stderr, "%d: allreduce on child %d returned %d\n", rank, i, sum);
+            errors++;
+        }
+        for (j = 0; j < i; j++) {
+            MPI_Comm_compare(comms[i], comms[j], &result);
+            if (MPI_CONGRUENT != result) {
+                fprintf(stderr, "%d: children %d and %d compare as %d\n", rank, i, j, result);
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, nprocs, iter, i, iterations = 1000, errors = 0;
+    MPI_Comm parent, comms[NCHILDREN];
+    MPI_Request reqs[2];
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
+    if (argc > 1) {
+        iterations = atoi(argv[1]);
+    }
+
+    for (iter = 0; iter < iterations; iter++) {
+        MPI_Comm_dup(MPI_COMM_WORLD, &parent);
+
+        MPI_Comm_idup(parent, comms, reqs);
+        if (rank == iter % nprocs) {
+            /* let this process fall behind the others */
+            usleep(100);
+        }
+        MPI_Comm_idup(parent, comms + 1, reqs + 1);
+        MPI_Comm_dup(parent, comms + 2);
+        MPI_Comm_split(parent, 0, rank, comms + 3);
+        if (iter & 1) {
+            MPI_Wait(reqs + 1, MPI_STATUS_IGNORE);
+            MPI_Wait(reqs, MPI_STATUS_IGNORE);
+        } else {
+            MPI_Waitall(2, reqs, MPI_STATUSES_IGNORE);
+        }
+
+        /* the parent goes away first, its children must remain usable */
+        MPI_Comm_free(&parent);
+        errors += check(comms, NCHILDREN, rank, nprocs);
+
+        for (i = 0; i < NCHILDREN; i++) {
+            MPI_Comm_free(comms + i);
+        }
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf("%d iterations, %d errors\n", iterations, errors);
+    }
+    MPI_Finalize();
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures MPI_Comm_split on MPI_COMM_WORLD for a few common color
+ * patterns: rows and columns of a square process grid, two halves, and
+ * one color per process.  Each pattern is timed once with the allgather
+ * based split (mpi_comm_split_threshold set to 0) and once with the
+ * distributed split (threshold set to 1), and the communicators produced
+ * by both are checked to be congruent.  The slowest process' average
+ * time per split is reported.
+ *
+ * If mpi_comm_split_threshold cannot be written through MPI_T, both
+ * columns measure whichever path the MCA setting selects.
+ *
+ * usage: mpirun -np <p> ./comm_split [iterations]
+ */
+
+#include "mpi.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+    PATTERN_ROWS,
+    PATTERN_COLUMNS,
+    PATTERN_HALVES,
+    PATTERN_SINGLETONS,
+    PATTERN_COUNT
+};
+
+static const char *pattern_names[PATTERN_COUNT] = {
+    "rows", "columns", "halves", "singletons"
+};
+
+static void color_key(int pattern, int rank, int size, int *color, int *key)
+{
+    int q = (int) sqrt((double) size);
+
+    if (q < 1) {
+        q = 1;
+    }
+
+    switch (pattern) {
+    case PATTERN_ROWS:
+        *color = rank / q;
+        *key = rank;
+        break;
+    case PATTERN_COLUMNS:
+        *color = rank % q;
+        *key = size - rank;
+        break;
+    case PATTERN_HALVES:
+        *color = rank < size / 2;
+        *key = 0;
+        break;
+    default:
+        *color = rank;
+        *key = 0;
+        break;
+    }
+}
+
+/* returns 0 if the threshold could not be changed */
+static int set_threshold(unsigned int threshold)
+{
+    MPI_T_cvar_handle handle;
+    int index, count, rc;
+
+    if (MPI_SUCCESS != MPI_T_cvar_get_index("mpi_comm_split_threshold", &index) ||
+        MPI_SUCCESS != MPI_T_cvar_handle_alloc(index, NULL, &handle, &count)) {
+        return 0;
+    }
+    rc = MPI_T_cvar_write(handle, &threshold);
+    MPI_T_cvar_handle_free(&handle);
+
+    return MPI_SUCCESS == rc;
+}
+
+static double time_split(int pattern, int iters, MPI_Comm *newcomm)
+{
+    int rank, size, color, key, i;
+    double start, usec;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    color_key(pattern, rank, size, &color, &key);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = MPI_Wtime();
+    for (i = 0; i < iters; i++) {
+        MPI_Comm_split(MPI_COMM_WORLD, color, key, newcomm);
+        if (i < iters - 1) {
+            MPI_Comm_free(newcomm);
+        }
+    }
+    usec = (MPI_Wtime() - start) * 1e6 / iters;
+    MPI_Allreduce(MPI_IN_PLACE, &usec, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    return usec;
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, size, provided, iters = 100, pattern, result, settable, errors = 0;
+    double gathered, distributed;
+    MPI_Comm comm_gathered, comm_distributed;
+
+    MPI_Init(&argc, &argv);
+    MPI_T_init_thread(MPI_THREAD_SINGLE, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc > 1) {
+        iters = atoi(argv[1]);
+    }
+    if (iters < 1) {
+        iters = 1;
+    }
+
+    settable = set_threshold(0);
+    if (0 == rank) {
+        printf("# %d processes, %d splits per pattern, usec per split%s\n", size, iters,
+               settable ? "" : " (threshold not settable)");
+        printf("# %12s %14s %14s\n", "pattern", "allgather", "distributed");
+    }
+
+    for (pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+        set_threshold(0);
+        gathered = time_split(pattern, iters, &comm_gathered);
+        set_threshold(1);
+        distributed = time_split(pattern, iters, &comm_distributed);
+
+        MPI_Comm_compare(comm_gathered, comm_distributed, &result);
+        if (MPI_CONGRUENT != result) {
+            fprintf(stderr, "%d: %s split communicators differ\n", rank,
+                    pattern_names[pattern]);
+            errors++;
+        }
+        MPI_Comm_free(&comm_distributed);
+        MPI_Comm_free(&comm_gathered);
+
+        if (0 == rank) {
+            printf("  %12s %14.2f %14.2f\n", pattern_names[pattern], gathered, distributed);
+            fflush(stdout);
+        }
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+    MPI_T_finalize();
+    MPI_Finalize();
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,245 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures the memory footprint of derived groups and the cost of rank
+ * translation and group comparison.  Groups of MPI_COMM_WORLD are built
+ * with MPI_Group_incl following the patterns communicators split from
+ * MPI_COMM_WORLD typically have:
+ *
+ *  - half:    the first half of the ranks
+ *  - strided: every other rank
+ *  - blocks:  every other block of 64 ranks (a split by node)
+ *  - reverse: all ranks in reverse order (a split with reversed keys)
+ *  - shuffle: all ranks in a random order (a split with random keys)
+ *
+ * For every pattern, the memory per group is estimated from the growth
+ * of the resident set size over a batch of groups.  Then the time per
+ * rank is reported for MPI_Group_translate_ranks from MPI_COMM_WORLD to
+ * the group (one rank per call and all ranks at once), from the group to
+ * MPI_COMM_WORLD, and for MPI_Group_compare against the same group
+ * built by MPI_Group_range_incl.  The groups are local objects, so only
+ * rank 0 measures them.  The footprint of the dense representation
+ * grows with the size of MPI_COMM_WORLD, so run this at scale (e.g.
+ * 100k processes) to see the difference, with
+ * --mca mpi_use_sparse_group_storage 1 on a build configured with
+ * --enable-sparse-groups.
+ *
+ * usage: mpirun -np <p> ./group_ranks [groups per batch]
+ */
+
+#include "mpi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+enum {
+    PATTERN_HALF,
+    PATTERN_STRIDED,
+    PATTERN_BLOCKS,
+    PATTERN_REVERSE,
+    PATTERN_SHUFFLE,
+    PATTERN_COUNT
+};
+
+static const char *pattern_names[PATTERN_COUNT] = {
+    "half", "strided", "blocks", "reverse", "shuffle"
+};
+
+#define BLOCK 64
+
+/* fill ranks and the matching range triplets, return the group size */
+static int build_pattern(int pattern, int size, int *ranks, int (*ranges)[3], int *n_ranges)
+{
+    int i, n = 0;
+
+    *n_ranges = 0;
+    switch (pattern) {
+    case PATTERN_HALF:
+        for (i = 0; i < (size + 1) / 2; i++) {
+            ranks[n++] = i;
+        }
+        ranges[(*n_ranges)++][0] = 0;
+        ranges[0][1] = n - 1;
+        ranges[0][2] = 1;
+        break;
+    case PATTERN_STRIDED:
+        for (i = 0; i < size; i += 2) {
+            ranks[n++] = i;
+        }
+        ranges[(*n_ranges)++][0] = 0;
+        ranges[0][1] = ranks[n - 1];
+        ranges[0][2] = 2;
+        break;
+    case PATTERN_BLOCKS:
+        for (i = 0; i < size; i += 2 * BLOCK) {
+            int j, last = (i + BLOCK < size ? i + BLOCK : size) - 1;
+
+            ranges[*n_ranges][0] = i;
+            ranges[*n_ranges][1] = last;
+            ranges[(*n_ranges)++][2] = 1;
+            for (j = i; j <= last; j++) {
+                ranks[n++] = j;
+            }
+        }
+        break;
+    case PATTERN_REVERSE:
+        for (i = size - 1; i >= 0; i--) {
+            ranks[n++] = i;
+        }
+        ranges[(*n_ranges)++][0] = size - 1;
+        ranges[0][1] = 0;
+        ranges[0][2] = -1;
+        break;
+    case PATTERN_SHUFFLE:
+        for (i = 0; i < size; i++) {
+            ranks[n++] = i;
+        }
+        srand(size);
+        for (i = size - 1; i > 0; i--) {
+            int j = rand() % (i + 1), tmp = ranks[i];
+
+            ranks[i] = ranks[j];
+            ranks[j] = tmp;
+        }
+        for (i = 0; i < n; i++) {
+            ranges[*n_ranges][0] = ranges[*n_ranges][1] = ranks[i];
+            ranges[(*n_ranges)++][2] = 1;
+        }
+        break;
+    }
+
+    return n;
+}
+
+/* resident set size in bytes, 0 if unknown */
+static long resident(void)
+{
+    long pages = 0, rss = 0;
+    FILE *fh = fopen("/proc/self/statm", "r");
+
+    if (NULL != fh) {
+        if (2 != fscanf(fh, "%ld %ld", &pages, &rss)) {
+            rss = 0;
+        }
+        fclose(fh);
+    }
+
+    return rss * sysconf(_SC_PAGESIZE);
+}
+
+static void measure(MPI_Group world, int size, int pattern, int batch, int *ranks, int *out,
+                    int *all, int (*ranges)[3])
+{
+    MPI_Group group, other, *groups = malloc(batch * sizeof(MPI_Group));
+    int i, n, n_ranges, result;
+    double t_one, t_all, t_back, t_cmp;
+    long before;
+
+    n = build_pattern(pattern, size, ranks, ranges, &n_ranges);
+
+    before = resident();
+    for (i = 0; i < batch; i++) {
+        MPI_Group_incl(world, n, ranks, groups + i);
+    }
+    before = resident() - before;
+    group = groups[0];
+
+    /* world to group, one rank at a time */
+    t_one = MPI_Wtime();
+    for (i = 0; i < size; i++) {
+        MPI_Group_translate_ranks(world, 1, all + i, group, out + i);
+    }
+    t_one = MPI_Wtime() - t_one;
+
+    /* world to group, all ranks in one call */
+    t_all = MPI_Wtime();
+    MPI_Group_translate_ranks(world, size, all, group, out);
+    t_all = MPI_Wtime() - t_all;
+    for (i = 0; i < n; i++) {
+        if (out[ranks[i]] != i) {
+            fprintf(stderr, "%s: rank %d translated to %d, expected %d\n", pattern_names[pattern],
+                    ranks[i], out[ranks[i]], i);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    /* group to world */
+    t_back = MPI_Wtime();
+    for (i = 0; i < n; i++) {
+        MPI_Group_translate_ranks(group, 1, all + i, world, out + i);
+    }
+    t_back = MPI_Wtime() - t_back;
+    for (i = 0; i < n; i++) {
+        if (out[i] != ranks[i]) {
+            fprintf(stderr, "%s: rank %d translated back to %d, expected %d\n",
+                    pattern_names[pattern], i, out[i], ranks[i]);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    MPI_Group_range_incl(world, n_ranges, ranges, &other);
+    t_cmp = MPI_Wtime();
+    MPI_Group_compare(group, other, &result);
+    t_cmp = MPI_Wtime() - t_cmp;
+    if (MPI_IDENT != result) {
+        fprintf(stderr, "%s: groups compare as %d, expected MPI_IDENT\n", pattern_names[pattern],
+                result);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Group_free(&other);
+
+    printf("  %-8s %9d %12.0f %10.1f %10.1f %10.1f %10.1f\n", pattern_names[pattern], n,
+           (double) before / batch, t_one * 1e9 / size, t_all * 1e9 / size, t_back * 1e9 / n,
+           t_cmp * 1e9 / n);
+    fflush(stdout);
+
+    for (i = 0; i < batch; i++) {
+        MPI_Group_free(groups + i);
+    }
+    free(groups);
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, size, batch = 256, pattern, i, *ranks, *out, *all, (*ranges)[3];
+    MPI_Group world;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (argc > 1) {
+        batch = atoi(argv[1]);
+    }
+
+    if (0 == rank) {
+        MPI_Comm_group(MPI_COMM_WORLD, &world);
+        ranks = malloc(size * sizeof(int));
+        out = malloc(size * sizeof(int));
+        all = malloc(size * sizeof(int));
+        ranges = malloc(size * sizeof(*ranges));
+        for (i = 0; i < size; i++) {
+            all[i] = i;
+        }
+
+        printf("# %d processes, %d groups per batch, times in ns per rank\n", size, batch);
+        printf("# %-8s %9s %12s %10s %10s %10s %10s\n", "pattern", "size", "bytes/group",
+               "to (1)", "to (all)", "from (1)", "compare");
+        for (pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+            measure(world, size, pattern, batch, ranks, out, all, ranges);
+        }
+
+        free(ranges);
+        free(all);
+        free(out);
+        free(ranks);
+        MPI_Group_free(&world);
+    }
+
+    MPI_Finalize();
+
+    return 0;
+}
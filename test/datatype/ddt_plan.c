@@ -0,0 +1,253 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Benchmark (and sanity check) for the compiled pack/unpack plans: for a
+ * few derived datatypes, time MPI_Pack and MPI_Unpack of the same type with
+ * the generic datatype engine and with a plan, and check that both produce
+ * the same packed data and the same unpacked buffer. The plans are also
+ * checked against the generic engine when packing and unpacking in small
+ * chunks of odd sizes, and when starting from a position in the middle of
+ * the data.
+ *
+ *   ddt_plan [-c count] [-r repetitions]
+ */
+
+#include "ompi_config.h"
+#include "mpi.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "opal/datatype/opal_convertor.h"
+#include "opal/datatype/opal_datatype_plan.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct {
+    const char *name;
+    MPI_Datatype type;
+} plan_layout_t;
+
+static void build_layouts(plan_layout_t *layouts, int *nlayouts)
+{
+    int blocklens[5] = {1, 3, 2, 7, 1}, displs[5] = {0, 2, 9, 13, 30};
+    int sizes[2] = {64, 64}, subsizes[2] = {64, 1}, starts[2] = {0, 5};
+    int struct_blocklens[3] = {1, 1, 1};
+    MPI_Aint struct_displs[3] = {0, 8, 16};
+    MPI_Datatype struct_types[3] = {MPI_INT, MPI_DOUBLE, MPI_CHAR}, tmp;
+    int n = 0;
+
+    layouts[n].name = "vector 1 double / 2";
+    MPI_Type_vector(64, 1, 2, MPI_DOUBLE, &layouts[n++].type);
+    layouts[n].name = "vector 4 int / 8";
+    MPI_Type_vector(64, 4, 8, MPI_INT, &layouts[n++].type);
+    layouts[n].name = "vector 64 char / 100";
+    MPI_Type_vector(16, 64, 100, MPI_CHAR, &layouts[n++].type);
+    layouts[n].name = "column of 64x64 int";
+    MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_INT, &layouts[n++].type);
+    layouts[n].name = "indexed float";
+    MPI_Type_indexed(5, blocklens, displs, MPI_FLOAT, &layouts[n++].type);
+    layouts[n].name = "struct int,double,char";
+    MPI_Type_create_struct(3, struct_blocklens, struct_displs, struct_types, &tmp);
+    MPI_Type_create_resized(tmp, 0, 24, &layouts[n++].type);
+    MPI_Type_free(&tmp);
+
+    for (int i = 0; i < n; i++) {
+        MPI_Type_commit(&layouts[i].type);
+    }
+    *nlayouts = n;
+}
+
+/* pack and unpack reps times, return the time of one pack and one unpack */
+static void time_pack(MPI_Datatype type, int count, int reps, void *in, void *packed,
+                      int packed_size, void *out, double *tpack, double *tunpack)
+{
+    double start;
+    int pos;
+
+    start = MPI_Wtime();
+    for (int r = 0; r < reps; r++) {
+        pos = 0;
+        MPI_Pack(in, count, type, packed, packed_size, &pos, MPI_COMM_WORLD);
+    }
+    *tpack = (MPI_Wtime() - start) / reps;
+
+    start = MPI_Wtime();
+    for (int r = 0; r < reps; r++) {
+        pos = 0;
+        MPI_Unpack(packed, packed_size, &pos, out, count, type, MPI_COMM_WORLD);
+    }
+    *tunpack = (MPI_Wtime() - start) / reps;
+}
+
+/*
+ * pack from position pos to the end in chunks of at most chunk bytes, then
+ * unpack the reference packed data the same way. Return the position the
+ * convertor actually started from.
+ */
+static size_t chunked_pack(MPI_Datatype type, int count, size_t pos, size_t chunk,
+                           void *in, char *packed, char *ref, void *out)
+{
+    opal_convertor_t *conv;
+    struct iovec iov;
+    uint32_t iov_count;
+    size_t max_data, start, done;
+    int rc;
+
+    conv = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_send(conv, &((ompi_datatype_t *) type)->super, count, in);
+    /* a send convertor never starts in the middle of a predefined type */
+    opal_convertor_set_position(conv, &pos);
+    start = done = pos;
+    do {
+        iov.iov_base = packed + done;
+        iov.iov_len = chunk;
+        iov_count = 1;
+        max_data = chunk;
+        rc = opal_convertor_pack(conv, &iov, &iov_count, &max_data);
+        done += max_data;
+    } while (0 == rc && 0 != max_data);
+    OBJ_RELEASE(conv);
+
+    conv = opal_convertor_create(opal_local_arch, 0);
+    opal_convertor_prepare_for_recv(conv, &((ompi_datatype_t *) type)->super, count, out);
+    opal_convertor_set_position(conv, &pos);
+    done = pos;
+    do {
+        iov.iov_base = ref + done;
+        iov.iov_len = chunk;
+        iov_count = 1;
+        max_data = chunk;
+        rc = opal_convertor_unpack(conv, &iov, &iov_count, &max_data);
+        done += max_data;
+    } while (0 == rc && 0 != max_data);
+    OBJ_RELEASE(conv);
+
+    return start;
+}
+
+/* compare chunked and repositioned packing between the generic engine and the plan */
+static int check_chunks(const char *name, MPI_Datatype generic, MPI_Datatype planned, int count,
+                        void *in, char *ref, size_t packed_size, size_t buf_size)
+{
+    size_t chunks[] = {7, 13, 1001}, positions[3], start[2];
+    int threshold = opal_datatype_plan_threshold, errors = 0;
+    char *packed[2], *out[2];
+
+    positions[0] = 0;
+    positions[1] = 5;
+    positions[2] = packed_size / 3 + 1;
+    for (int k = 0; k < 2; k++) {
+        packed[k] = malloc(packed_size);
+        out[k] = malloc(buf_size);
+    }
+
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        for (size_t p = 0; p < sizeof(positions) / sizeof(positions[0]); p++) {
+            for (int k = 0; k < 2; k++) {
+                memset(packed[k], 0, packed_size);
+                memset(out[k], 0, buf_size);
+                opal_datatype_plan_threshold = k;
+                start[k] = chunked_pack(k ? planned : generic, count, positions[p], chunks[c],
+                                        in, packed[k], ref, out[k]);
+            }
+            if (start[0] != start[1] ||
+                0 != memcmp(packed[0], packed[1], packed_size) ||
+                0 != memcmp(out[0], out[1], buf_size)) {
+                printf("%-24s MISMATCH in chunks of %zu bytes from position %zu\n", name,
+                       chunks[c], positions[p]);
+                errors++;
+            }
+        }
+    }
+    opal_datatype_plan_threshold = threshold;
+
+    for (int k = 0; k < 2; k++) {
+        free(packed[k]);
+        free(out[k]);
+    }
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = 1000, reps = 100, nlayouts, threshold, errors = 0, c;
+    plan_layout_t layouts[8];
+
+    while (-1 != (c = getopt(argc, argv, "c:r:"))) {
+        switch (c) {
+        case 'c':
+            count = atoi(optarg);
+            break;
+        case 'r':
+            reps = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-c count] [-r repetitions]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    MPI_Init(&argc, &argv);
+    build_layouts(layouts, &nlayouts);
+    threshold = opal_datatype_plan_threshold;
+
+    printf("%-24s %10s %12s %12s %12s %12s\n", "datatype", "bytes",
+           "pack usec", "plan usec", "unpack usec", "plan usec");
+    for (int i = 0; i < nlayouts; i++) {
+        MPI_Datatype generic, planned;
+        MPI_Aint lb, extent;
+        int size;
+        double tp[2], tu[2];
+        char *in, *packed[2], *out[2];
+
+        MPI_Type_get_extent(layouts[i].type, &lb, &extent);
+        MPI_Type_size(layouts[i].type, &size);
+        in = malloc(extent * count);
+        for (MPI_Aint j = 0; j < extent * count; j++) {
+            in[j] = (char)(j * 7 + 3);
+        }
+
+        /* same layout, one type never gets a plan, the other one right away */
+        MPI_Type_dup(layouts[i].type, &generic);
+        MPI_Type_dup(layouts[i].type, &planned);
+        for (int k = 0; k < 2; k++) {
+            packed[k] = malloc((size_t)size * count);
+            out[k] = calloc(extent, count);
+            opal_datatype_plan_threshold = k;
+            time_pack(k ? planned : generic, count, reps, in, packed[k], size * count,
+                      out[k], &tp[k], &tu[k]);
+        }
+        opal_datatype_plan_threshold = threshold;
+
+        if (0 != memcmp(packed[0], packed[1], (size_t)size * count) ||
+            0 != memcmp(out[0], out[1], extent * count)) {
+            printf("%-24s MISMATCH between the generic engine and the plan\n", layouts[i].name);
+            errors++;
+        } else {
+            printf("%-24s %10d %12.3f %12.3f %12.3f %12.3f\n", layouts[i].name, size * count,
+                   tp[0] * 1e6, tp[1] * 1e6, tu[0] * 1e6, tu[1] * 1e6);
+        }
+        errors += check_chunks(layouts[i].name, generic, planned, count, in, packed[0],
+                               (size_t)size * count, extent * count);
+
+        for (int k = 0; k < 2; k++) {
+            free(packed[k]);
+            free(out[k]);
+        }
+        free(in);
+        MPI_Type_free(&generic);
+        MPI_Type_free(&planned);
+        MPI_Type_free(&layouts[i].type);
+    }
+
+    MPI_Finalize();
+    return errors ? 1 : 0;
+}
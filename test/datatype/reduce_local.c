@@ -0,0 +1,195 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Benchmark (and sanity check) for the MPI_Op backends: for every
+ * arithmetic and bitwise operation and every C integer / floating
+ * point type, compare the time of MPI_Reduce_local (which goes through
+ * whatever op component got selected, e.g. op/avx) with the time of
+ * the scalar loops from ompi/mca/op/base, and check that both produce
+ * the same result.
+ *
+ *   reduce_local [-c max_count] [-r repetitions] [-3]
+ *
+ * With -3 the 3-buffer variants are compared instead (through the
+ * internal ompi_3buff_op_reduce, as there is no MPI function for them).
+ */
+
+#include "ompi_config.h"
+#include "mpi.h"
+#include "ompi/op/op.h"
+#include "ompi/mca/op/op.h"
+#include "ompi/mca/op/base/functions.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct {
+    const char *name;
+    MPI_Datatype dtype;
+    int op_type;
+    size_t size;
+    int is_float;
+} reduce_type_t;
+
+typedef struct {
+    const char *name;
+    MPI_Op op;
+    int op_index;
+    int float_ok;
+} reduce_op_t;
+
+static void fill(void *buf, size_t count, const reduce_type_t *type, int seed)
+{
+    size_t i;
+
+    srand(seed);
+    for (i = 0; i < count; i++) {
+        /* Keep the values small so that MPI_PROD does not overflow
+           the floating point types to infinity too quickly */
+        int v = (rand() % 7) + 1;
+        switch (type->op_type) {
+        case OMPI_OP_BASE_TYPE_FLOAT:
+            ((float*)buf)[i] = (float)v / 3.0f;
+            break;
+        case OMPI_OP_BASE_TYPE_DOUBLE:
+            ((double*)buf)[i] = (double)v / 3.0;
+            break;
+        default:
+            memset((char*)buf + i * type->size, rand(), type->size);
+            break;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    reduce_type_t types[] = {
+        { "int8_t",   MPI_INT8_T,   OMPI_OP_BASE_TYPE_INT8_T,   1, 0 },
+        { "uint8_t",  MPI_UINT8_T,  OMPI_OP_BASE_TYPE_UINT8_T,  1, 0 },
+        { "int16_t",  MPI_INT16_T,  OMPI_OP_BASE_TYPE_INT16_T,  2, 0 },
+        { "uint16_t", MPI_UINT16_T, OMPI_OP_BASE_TYPE_UINT16_T, 2, 0 },
+        { "int32_t",  MPI_INT32_T,  OMPI_OP_BASE_TYPE_INT32_T,  4, 0 },
+        { "uint32_t", MPI_UINT32_T, OMPI_OP_BASE_TYPE_UINT32_T, 4, 0 },
+        { "int64_t",  MPI_INT64_T,  OMPI_OP_BASE_TYPE_INT64_T,  8, 0 },
+        { "uint64_t", MPI_UINT64_T, OMPI_OP_BASE_TYPE_UINT64_T, 8, 0 },
+        { "float",    MPI_FLOAT,    OMPI_OP_BASE_TYPE_FLOAT,    4, 1 },
+        { "double",   MPI_DOUBLE,   OMPI_OP_BASE_TYPE_DOUBLE,   8, 1 },
+    };
+    reduce_op_t ops[] = {
+        { "max",  MPI_MAX,  OMPI_OP_BASE_FORTRAN_MAX,  1 },
+        { "min",  MPI_MIN,  OMPI_OP_BASE_FORTRAN_MIN,  1 },
+        { "sum",  MPI_SUM,  OMPI_OP_BASE_FORTRAN_SUM,  1 },
+        { "prod", MPI_PROD, OMPI_OP_BASE_FORTRAN_PROD, 1 },
+        { "band", MPI_BAND, OMPI_OP_BASE_FORTRAN_BAND, 0 },
+        { "bor",  MPI_BOR,  OMPI_OP_BASE_FORTRAN_BOR,  0 },
+        { "bxor", MPI_BXOR, OMPI_OP_BASE_FORTRAN_BXOR, 0 },
+    };
+    int max_count = 1 << 20, repetitions = 50, three_buffers = 0, errors = 0;
+    int c, t, o, r, count;
+    void *in, *in2, *out, *check;
+
+    MPI_Init(&argc, &argv);
+
+    while (-1 != (c = getopt(argc, argv, "c:r:3h"))) {
+        switch (c) {
+        case 'c': max_count = atoi(optarg); break;
+        case 'r': repetitions = atoi(optarg); break;
+        case '3': three_buffers = 1; break;
+        default:
+            fprintf(stderr, "Usage: %s [-c max_count] [-r repetitions] [-3]\n", argv[0]);
+            MPI_Finalize();
+            return 1;
+        }
+    }
+
+    in = malloc(max_count * sizeof(double));
+    in2 = malloc(max_count * sizeof(double));
+    out = malloc(max_count * sizeof(double));
+    check = malloc(max_count * sizeof(double));
+
+    printf("%-5s %-9s %10s %14s %14s %8s\n",
+           "op", "type", "count", "base (us)", "selected (us)", "speedup");
+    for (o = 0; o < (int)(sizeof(ops) / sizeof(ops[0])); o++) {
+        for (t = 0; t < (int)(sizeof(types) / sizeof(types[0])); t++) {
+            ompi_op_base_handler_fn_t base_fn;
+            ompi_op_base_3buff_handler_fn_t base_3buff_fn;
+            ompi_datatype_t *dtype = (ompi_datatype_t*)types[t].dtype;
+
+            if (types[t].is_float && !ops[o].float_ok) {
+                continue;
+            }
+            base_fn = ompi_op_base_functions[ops[o].op_index][types[t].op_type];
+            base_3buff_fn = ompi_op_base_3buff_functions[ops[o].op_index][types[t].op_type];
+
+            for (count = 1; count <= max_count; count *= 16) {
+                double tbase = 0.0, tsel = 0.0, start;
+                size_t bytes = count * types[t].size;
+                int rcount = count;
+
+                /* Reference result using the base function */
+                fill(in, count, &types[t], 1);
+                fill(in2, count, &types[t], 2);
+                if (three_buffers) {
+                    base_3buff_fn(in, in2, check, &rcount, &dtype, NULL);
+                    ompi_3buff_op_reduce((ompi_op_t*)ops[o].op, in, in2, out, count, dtype);
+                } else {
+                    memcpy(check, in2, bytes);
+                    base_fn(in, check, &rcount, &dtype, NULL);
+                    memcpy(out, in2, bytes);
+                    MPI_Reduce_local(in, out, count, types[t].dtype, ops[o].op);
+                }
+                if (0 != memcmp(out, check, bytes)) {
+                    printf("ERROR: %s %s count %d: results differ from the base function\n",
+                           ops[o].name, types[t].name, count);
+                    errors++;
+                }
+
+                /* MPI_PROD and MPI_SUM quickly saturate; we only care
+                   about the time, not about the result, from here on */
+                for (r = 0; r < repetitions; r++) {
+                    start = MPI_Wtime();
+                    if (three_buffers) {
+                        base_3buff_fn(in, in2, check, &rcount, &dtype, NULL);
+                    } else {
+                        base_fn(in, check, &rcount, &dtype, NULL);
+                    }
+                    tbase += MPI_Wtime() - start;
+
+                    start = MPI_Wtime();
+                    if (three_buffers) {
+                        ompi_3buff_op_reduce((ompi_op_t*)ops[o].op, in, in2, out, count, dtype);
+                    } else {
+                        MPI_Reduce_local(in, out, count, types[t].dtype, ops[o].op);
+                    }
+                    tsel += MPI_Wtime() - start;
+                }
+                tbase = tbase * 1e6 / repetitions;
+                tsel = tsel * 1e6 / repetitions;
+                printf("%-5s %-9s %10d %14.3f %14.3f %8.2f\n",
+                       ops[o].name, types[t].name, count, tbase, tsel,
+                       (tsel > 0.0) ? tbase / tsel : 0.0);
+            }
+        }
+    }
+
+    free(in);
+    free(in2);
+    free(out);
+    free(check);
+
+    MPI_Finalize();
+    if (0 != errors) {
+        printf("%d errors\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures the aggregate file I/O bandwidth for blocks of increasing
+ * size.  Every process moves the same amount of data per phase:
+ *
+ *  - iwrite/iread: every process accesses its own contiguous part of
+ *    the file with a window of MPI_File_iwrite_at/MPI_File_iread_at
+ *  - write_all/read_all: the blocks of the processes are interleaved in
+ *    the file through a file view, and accessed with MPI_File_write_all
+ *    and MPI_File_read_all
+ *
+ * The data read back is checked.  Meant to compare the fbtl components
+ * on a local file system, with fcoll vulcan overlapping the collective
+ * phases with asynchronous I/O:
+ *
+ *   mpirun -np 4 --mca fbtl posix|uring --mca fcoll vulcan \
+ *          --mca fcoll_vulcan_async_io 1 ./io_bandwidth /tmp/io_bandwidth.dat
+ *
+ * usage: mpirun -np <p> ./io_bandwidth [file] [bytes per process]
+ */
+
+#include "mpi.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WINDOW 16
+
+enum {
+    PHASE_IWRITE,
+    PHASE_IREAD,
+    PHASE_WRITE_ALL,
+    PHASE_READ_ALL,
+    PHASE_COUNT
+};
+
+static const char *phase_names[PHASE_COUNT] = {
+    "iwrite", "iread", "write_all", "read_all"
+};
+
+static void fill(unsigned char *buffer, size_t size, MPI_Offset offset)
+{
+    size_t i;
+
+    for (i = 0; i < size; i += 4093) {
+        buffer[i] = (unsigned char) ((offset + i) / 4093);
+    }
+}
+
+static int check(const unsigned char *buffer, size_t size, MPI_Offset offset)
+{
+    size_t i;
+
+    for (i = 0; i < size; i += 4093) {
+        if (buffer[i] != (unsigned char) ((offset + i) / 4093)) {
+            fprintf(stderr, "offset %lld: byte is %d, expected %d\n", (long long) (offset + i),
+                    buffer[i], (unsigned char) ((offset + i) / 4093));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* individual non-blocking accesses to the part of the file of this process */
+static int individual(MPI_File fh, int phase, int rank, size_t size, size_t total,
+                      unsigned char *buffers)
+{
+    MPI_Offset base = (MPI_Offset) rank * total, offset;
+    MPI_Request reqs[WINDOW];
+    size_t done;
+    int w, n, errors = 0;
+
+    for (done = 0; done < total; done += n * size) {
+        for (n = 0; n < WINDOW && done + n * size < total; n++) {
+            offset = base + done + n * size;
+            if (PHASE_IWRITE == phase) {
+                fill(buffers + n * size, size, offset);
+                MPI_File_iwrite_at(fh, offset, buffers + n * size, (int) size, MPI_BYTE, reqs + n);
+            } else {
+                MPI_File_iread_at(fh, offset, buffers + n * size, (int) size, MPI_BYTE, reqs + n);
+            }
+        }
+        MPI_Waitall(n, reqs, MPI_STATUSES_IGNORE);
+        if (PHASE_IREAD == phase) {
+            for (w = 0; w < n; w++) {
+                errors += check(buffers + w * size, size, base + done + w * size);
+            }
+        }
+    }
+
+    return errors;
+}
+
+/* collective accesses, the blocks of the processes interleaved in the file */
+static int collective(MPI_File fh, int phase, int rank, int nprocs, size_t size, size_t total,
+                      unsigned char *buffers)
+{
+    MPI_Datatype block, filetype;
+    MPI_Offset offset;
+    size_t done, count, b;
+    int errors = 0;
+
+    MPI_Type_contiguous((int) size, MPI_BYTE, &block);
+    MPI_Type_create_resized(block, 0, (MPI_Aint) size * nprocs, &filetype);
+    MPI_Type_commit(&filetype);
+    MPI_File_set_view(fh, (MPI_Offset) rank * size, MPI_BYTE, filetype, "native", MPI_INFO_NULL);
+
+    for (done = 0; done < total; done += count * size) {
+        count = (total - done) / size < WINDOW ? (total - done) / size : WINDOW;
+        if (PHASE_WRITE_ALL == phase) {
+            for (b = 0; b < count; b++) {
+                offset = ((MPI_Offset) (done / size + b) * nprocs + rank) * size;
+                fill(buffers + b * size, size, offset);
+            }
+            MPI_File_write_all(fh, buffers, (int) (count * size), MPI_BYTE, MPI_STATUS_IGNORE);
+        } else {
+            MPI_File_read_all(fh, buffers, (int) (count * size), MPI_BYTE, MPI_STATUS_IGNORE);
+            for (b = 0; b < count; b++) {
+                offset = ((MPI_Offset) (done / size + b) * nprocs + rank) * size;
+                errors += check(buffers + b * size, size, offset);
+            }
+        }
+    }
+
+    MPI_File_set_view(fh, 0, MPI_BYTE, MPI_BYTE, "native", MPI_INFO_NULL);
+    MPI_Type_free(&filetype);
+    MPI_Type_free(&block);
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filename = "io_bandwidth.dat";
+    size_t total = 64 * 1024 * 1024, size;
+    int rank, nprocs, phase, errors = 0;
+    double time[PHASE_COUNT];
+    unsigned char *buffers;
+    MPI_File fh;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
+    if (argc > 1) {
+        filename = argv[1];
+    }
+    if (argc > 2) {
+        total = strtoul(argv[2], NULL, 0);
+    }
+
+    buffers = malloc(total < 4 * 1024 * 1024 * WINDOW ? total : 4 * 1024 * 1024 * WINDOW);
+    if (NULL == buffers) {
+        fprintf(stderr, "cannot allocate the buffers\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_File_open(MPI_COMM_WORLD, filename, MPI_MODE_CREATE | MPI_MODE_RDWR, MPI_INFO_NULL, &fh);
+
+    if (0 == rank) {
+        printf("# %d processes, %lu bytes per process and phase, MB/s\n", nprocs,
+               (unsigned long) total);
+        printf("# %10s %12s %12s %12s %12s\n", "size", phase_names[0], phase_names[1],
+               phase_names[2], phase_names[3]);
+    }
+
+    for (size = 4096; size <= 4 * 1024 * 1024 && size <= total; size *= 4) {
+        for (phase = 0; phase < PHASE_COUNT; phase++) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            time[phase] = MPI_Wtime();
+            if (PHASE_IWRITE == phase || PHASE_IREAD == phase) {
+                errors += individual(fh, phase, rank, size, total - total % size, buffers);
+            } else {
+                errors += collective(fh, phase, rank, nprocs, size, total - total % size,
+                                     buffers);
+            }
+            if (PHASE_IWRITE == phase || PHASE_WRITE_ALL == phase) {
+                MPI_File_sync(fh);
+            }
+            time[phase] = MPI_Wtime() - time[phase];
+        }
+        MPI_Allreduce(MPI_IN_PLACE, time, PHASE_COUNT, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+        if (0 == rank) {
+            printf("  %10lu", (unsigned long) size);
+            for (phase = 0; phase < PHASE_COUNT; phase++) {
+                printf(" %12.1f", (double) (total - total % size) * nprocs / time[phase] / 1e6);
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+
+    MPI_File_close(&fh);
+    if (0 == rank) {
+        MPI_File_delete(filename, MPI_INFO_NULL);
+    }
+
+    free(buffers);
+    MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Finalize();
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures the rate of accesses through the shared file pointer for an
+ * increasing number of processes.  The processes of MPI_COMM_WORLD are
+ * split into groups of 1, 2, 4, ... processes, and the first group of
+ * each size opens its own file and appends small records with
+ *
+ *  - write_shared:  MPI_File_write_shared, every process independently
+ *  - write_ordered: MPI_File_write_ordered, one record per process and call
+ *
+ * Every record carries the rank and the sequence number of its writer.
+ * The file is read back to check that no record was lost or overwritten,
+ * and that the records written by MPI_File_write_ordered are in rank
+ * order.  Meant to compare the sharedfp components on a single node:
+ *
+ *   mpirun -np 16 --mca sharedfp sm|lockedfile ./shared_fp /tmp/shared_fp.dat
+ *
+ * usage: mpirun -np <p> ./shared_fp [file] [records per process] [record size]
+ */
+
+#include "mpi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    PHASE_SHARED,
+    PHASE_ORDERED,
+    PHASE_COUNT
+};
+
+static const char *phase_names[PHASE_COUNT] = {
+    "write_shared", "write_ordered"
+};
+
+/* read the file back, return the number of records found out of place */
+static int check(MPI_File fh, int phase, int nprocs, int records, int size, char *buffer)
+{
+    int *seen = calloc(nprocs, sizeof(int)), i, header[2], errors = 0;
+
+    for (i = 0; i < nprocs * records; i++) {
+        MPI_File_read_at(fh, (MPI_Offset) i * size, buffer, size, MPI_BYTE, MPI_STATUS_IGNORE);
+        memcpy(header, buffer, sizeof(header));
+        if (header[0] < 0 || header[0] >= nprocs || header[1] != seen[header[0]]
+            || (PHASE_ORDERED == phase && header[0] != i % nprocs)) {
+            fprintf(stderr, "%s: record %d written by rank %d as %d, out of place\n",
+                    phase_names[phase], i, header[0], header[1]);
+            errors++;
+        } else {
+            seen[header[0]]++;
+        }
+    }
+
+    free(seen);
+    return errors;
+}
+
+static int measure(MPI_Comm comm, const char *filename, int records, int size, char *buffer,
+                   double *time)
+{
+    int rank, nprocs, phase, i, header[2], errors = 0;
+    MPI_File fh;
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &nprocs);
+
+    for (phase = 0; phase < PHASE_COUNT; phase++) {
+        if (0 == rank) {
+            MPI_File_delete(filename, MPI_INFO_NULL);
+        }
+        MPI_Barrier(comm);
+        MPI_File_open(comm, filename, MPI_MODE_CREATE | MPI_MODE_RDWR, MPI_INFO_NULL, &fh);
+
+        memset(buffer, 0, size);
+        header[0] = rank;
+        MPI_Barrier(comm);
+        time[phase] = MPI_Wtime();
+        for (i = 0; i < records; i++) {
+            header[1] = i;
+            memcpy(buffer, header, sizeof(header));
+            if (PHASE_SHARED == phase) {
+                MPI_File_write_shared(fh, buffer, size, MPI_BYTE, MPI_STATUS_IGNORE);
+            } else {
+                MPI_File_write_ordered(fh, buffer, size, MPI_BYTE, MPI_STATUS_IGNORE);
+            }
+        }
+        time[phase] = MPI_Wtime() - time[phase];
+        MPI_File_sync(fh);
+        MPI_Barrier(comm);
+
+        if (0 == rank) {
+            errors += check(fh, phase, nprocs, records, size, buffer);
+        }
+        MPI_File_close(&fh);
+    }
+
+    if (0 == rank) {
+        MPI_File_delete(filename, MPI_INFO_NULL);
+    }
+    MPI_Allreduce(MPI_IN_PLACE, time, PHASE_COUNT, MPI_DOUBLE, MPI_MAX, comm);
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filename = "shared_fp.dat";
+    int rank, nprocs, n, phase, records = 10000, size = 64, errors = 0;
+    double time[PHASE_COUNT];
+    MPI_Comm comm;
+    char *buffer;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
+    if (argc > 1) {
+        filename = argv[1];
+    }
+    if (argc > 2) {
+        records = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        size = atoi(argv[3]);
+    }
+    if (size < (int) (2 * sizeof(int))) {
+        size = 2 * sizeof(int);
+    }
+    buffer = malloc(size);
+
+    if (0 == rank) {
+        printf("# %d records of %d bytes per process, thousands of records/s\n", records, size);
+        printf("# %10s %14s %14s\n", "processes", phase_names[0], phase_names[1]);
+    }
+
+    for (n = 1; n <= nprocs; n *= 2) {
+        MPI_Comm_split(MPI_COMM_WORLD, rank < n ? 0 : MPI_UNDEFINED, rank, &comm);
+        if (MPI_COMM_NULL != comm) {
+            errors += measure(comm, filename, records, size, buffer, time);
+            MPI_Comm_free(&comm);
+        }
+        if (0 == rank) {
+            printf("  %10d", n);
+            for (phase = 0; phase < PHASE_COUNT; phase++) {
+                printf(" %14.1f", (double) records * n / time[phase] / 1e3);
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+
+    free(buffer);
+    MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Finalize();
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
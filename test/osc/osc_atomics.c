@@ -0,0 +1,156 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures single element atomics on a shared memory window.  Every
+ * process updates 64-bit integers in the segment of rank 0 with
+ * MPI_Fetch_and_op, MPI_Accumulate and MPI_Compare_and_swap, either all
+ * on the same element (contended) or each on its own element, inside a
+ * MPI_Win_lock_all epoch.  The aggregate number of operations per second
+ * is reported for a window created without and one created with the
+ * acc_single_intrinsic info key, which lets osc/sm use processor atomics
+ * instead of the per-target accumulate lock.  The counters are checked
+ * at the end of every test.
+ *
+ * usage: mpirun -np <p> ./osc_atomics [operations per process]
+ */
+
+#include "mpi.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+    TEST_FETCH_AND_OP,
+    TEST_ACCUMULATE,
+    TEST_COMPARE_AND_SWAP,
+    TEST_COUNT
+};
+
+static const char *test_names[TEST_COUNT] = {
+    "fetch_and_op", "accumulate", "cas"
+};
+
+static int run_test(MPI_Win win, int64_t *base, int test, int contended, int iters,
+                    double *rate)
+{
+    int rank, size, i, errors = 0;
+    int64_t one = 1, result, compare, expected;
+    MPI_Aint disp;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    disp = contended ? 0 : rank;
+
+    if (0 == rank) {
+        for (i = 0; i < size; i++) {
+            base[i] = 0;
+        }
+    }
+    MPI_Win_sync(win);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    *rate = MPI_Wtime();
+    for (i = 0; i < iters; i++) {
+        switch (test) {
+        case TEST_FETCH_AND_OP:
+            MPI_Fetch_and_op(&one, &result, MPI_INT64_T, 0, disp, MPI_SUM, win);
+            break;
+        case TEST_ACCUMULATE:
+            MPI_Accumulate(&one, 1, MPI_INT64_T, 0, disp, 1, MPI_INT64_T, MPI_SUM, win);
+            break;
+        default:
+            /* increment through a compare-and-swap loop */
+            MPI_Fetch_and_op(NULL, &compare, MPI_INT64_T, 0, disp, MPI_NO_OP, win);
+            do {
+                int64_t value = compare + 1;
+                MPI_Compare_and_swap(&value, &compare, &result, MPI_INT64_T, 0, disp, win);
+                if (result == compare) {
+                    break;
+                }
+                compare = result;
+            } while (1);
+            break;
+        }
+    }
+    MPI_Win_flush(0, win);
+    *rate = MPI_Wtime() - *rate;
+    MPI_Allreduce(MPI_IN_PLACE, rate, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    *rate = (double) size * iters / *rate;
+
+    MPI_Win_sync(win);
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (0 == rank) {
+        for (i = 0; i < (contended ? 1 : size); i++) {
+            expected = contended ? (int64_t) size * iters : iters;
+            if (base[i] != expected) {
+                fprintf(stderr, "%s: element %d is %lld, expected %lld\n", test_names[test], i,
+                        (long long) base[i], (long long) expected);
+                errors++;
+            }
+        }
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, size, iters = 100000, intrinsic, test, contended, errors = 0, disp_unit;
+    int64_t *base;
+    MPI_Aint seg_size;
+    MPI_Info info;
+    MPI_Win win;
+    double rate;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc > 1) {
+        iters = atoi(argv[1]);
+    }
+
+    if (0 == rank) {
+        printf("# %d processes, %d operations per process, operations per second\n", size, iters);
+        printf("# %12s %10s %14s %14s\n", "operation", "target", "locked", "intrinsic");
+    }
+
+    for (test = 0; test < TEST_COUNT; test++) {
+        for (contended = 1; contended >= 0; contended--) {
+            if (0 == rank) {
+                printf("  %12s %10s", test_names[test], contended ? "shared" : "private");
+            }
+            for (intrinsic = 0; intrinsic < 2; intrinsic++) {
+                MPI_Info_create(&info);
+                MPI_Info_set(info, "acc_single_intrinsic", intrinsic ? "true" : "false");
+                MPI_Win_allocate_shared(0 == rank ? size * sizeof(int64_t) : 0, sizeof(int64_t),
+                                        info, MPI_COMM_WORLD, &base, &win);
+                MPI_Info_free(&info);
+                MPI_Win_shared_query(win, 0, &seg_size, &disp_unit, &base);
+
+                MPI_Win_lock_all(0, win);
+                errors += run_test(win, base, test, contended, iters, &rate);
+                MPI_Win_unlock_all(win);
+                MPI_Win_free(&win);
+
+                if (0 == rank) {
+                    printf(" %14.0f", rate);
+                }
+            }
+            if (0 == rank) {
+                printf("\n");
+                fflush(stdout);
+            }
+        }
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Finalize();
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
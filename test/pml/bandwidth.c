@@ -0,0 +1,117 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures the point-to-point bandwidth between ranks 0 and 1.  Rank 0
+ * sends a window of messages of increasing size with MPI_Isend and rank
+ * 1 acknowledges the window once all of them have been received.  The
+ * data of the last message of every window is checked.
+ *
+ * Meant to compare the TCP BTL over the loopback interface with and
+ * without striping large messages over several connections:
+ *
+ *   mpirun -np 2 --mca pml ob1 --mca btl tcp,self --mca btl_tcp_if_include lo \
+ *          --mca btl_tcp_stripes <n> ./bandwidth
+ *
+ * usage: mpirun -np 2 ./bandwidth [max message size]
+ */
+
+#include "mpi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WINDOW 16
+
+static int check(const unsigned char *buffer, size_t size, int iter)
+{
+    size_t i;
+
+    for (i = 0; i < size; i += 4093) {
+        if (buffer[i] != (unsigned char) (i + iter)) {
+            fprintf(stderr, "size %lu: byte %lu is %d, expected %d\n", (unsigned long) size,
+                    (unsigned long) i, buffer[i], (unsigned char) (i + iter));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_size = 64 * 1024 * 1024, size, i;
+    int rank, nprocs, iters, iter, w, errors = 0;
+    MPI_Request reqs[WINDOW];
+    unsigned char *buffers;
+    double time;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
+    if (nprocs < 2) {
+        fprintf(stderr, "bandwidth needs at least 2 processes\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (argc > 1) {
+        max_size = strtoul(argv[1], NULL, 0);
+    }
+
+    buffers = malloc(max_size * WINDOW);
+    if (NULL == buffers) {
+        fprintf(stderr, "cannot allocate %lu bytes\n", (unsigned long) max_size * WINDOW);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    if (0 == rank) {
+        printf("# %12s %10s %12s\n", "size", "iterations", "MB/s");
+    }
+
+    for (size = 64 * 1024; size <= max_size; size *= 2) {
+        /* move about 1GB per size, at least a few windows */
+        iters = (int) ((1024UL * 1024 * 1024) / (size * WINDOW));
+        if (iters < 4) {
+            iters = 4;
+        }
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        time = MPI_Wtime();
+        for (iter = 0; iter < iters; iter++) {
+            if (0 == rank) {
+                for (i = 0; i < size; i += 4093) {
+                    buffers[(WINDOW - 1) * size + i] = (unsigned char) (i + iter);
+                }
+                for (w = 0; w < WINDOW; w++) {
+                    MPI_Isend(buffers + w * size, (int) size, MPI_BYTE, 1, w, MPI_COMM_WORLD,
+                              reqs + w);
+                }
+                MPI_Waitall(WINDOW, reqs, MPI_STATUSES_IGNORE);
+                MPI_Recv(NULL, 0, MPI_BYTE, 1, WINDOW, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            } else if (1 == rank) {
+                for (w = 0; w < WINDOW; w++) {
+                    MPI_Irecv(buffers + w * size, (int) size, MPI_BYTE, 0, w, MPI_COMM_WORLD,
+                              reqs + w);
+                }
+                MPI_Waitall(WINDOW, reqs, MPI_STATUSES_IGNORE);
+                errors += check(buffers + (WINDOW - 1) * size, size, iter);
+                MPI_Send(NULL, 0, MPI_BYTE, 0, WINDOW, MPI_COMM_WORLD);
+            }
+        }
+        time = MPI_Wtime() - time;
+
+        if (0 == rank) {
+            printf("  %12lu %10d %12.1f\n", (unsigned long) size, iters,
+                   (double) size * WINDOW * iters / time / 1e6);
+            fflush(stdout);
+        }
+    }
+
+    free(buffers);
+    MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Finalize();
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,264 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Checks that the btl/vader fast boxes grow, shrink and are reclaimed,
+ * following the size of the fast boxes through the btl_vader_fbox_size
+ * pvar. All ranks have to be on the same node.
+ *
+ *  - bursts from rank 0 that do not fit in the fast box to rank 1 make it
+ *    grow, then the fast box shrinks back to btl_vader_fbox_size and is
+ *    released once rank 0 stops sending to rank 1,
+ *  - ranks 1 to 4 send to rank 0, which accepts btl_vader_fbox_max fast
+ *    boxes: rank 4 only gets one after the fast box of rank 1 was released.
+ *
+ * The fast box parameters are set by the test unless they are given in the
+ * environment.
+ *
+ * usage: mpirun -np 5 --mca btl vader,self ./fbox_adapt
+ */
+
+#include "mpi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FBOX_SIZE 4096
+#define FBOX_MAX 3
+#define FBOX_THRESHOLD 4
+#define MSG_SIZE 2048
+#define BURST 64
+#define TIMEOUT 30.0
+
+#define CMD_TAG 1
+#define DATA_TAG 2
+#define REPLY_TAG 3
+
+enum {
+    OP_RECV,       /* receive count messages from peer, slowly if arg */
+    OP_SEND,       /* send count messages to peer */
+    OP_WAIT_SIZE,  /* progress until the fast box to peer has size arg, reply the size */
+    OP_DONE
+};
+
+static MPI_T_pvar_session session;
+static MPI_T_pvar_handle handle;
+static int npeers = 0;
+
+/* current size of the fast box to a local peer (local rank == world rank here) */
+static unsigned long fbox_size(int peer)
+{
+    unsigned long sizes[npeers];
+
+    MPI_T_pvar_read(session, handle, sizes);
+    return sizes[peer];
+}
+
+static void fill(char *buf, int seq)
+{
+    for (int i = 0; i < MSG_SIZE; i++) {
+        buf[i] = (char)(seq + i);
+    }
+}
+
+static void send_msgs(int peer, int count, int *seq)
+{
+    static char bufs[BURST][MSG_SIZE];
+    MPI_Request reqs[BURST];
+
+    for (int done = 0; done < count; done += BURST) {
+        int n = (count - done < BURST) ? count - done : BURST;
+
+        for (int i = 0; i < n; i++) {
+            fill(bufs[i], (*seq)++);
+            MPI_Isend(bufs[i], MSG_SIZE, MPI_CHAR, peer, DATA_TAG, MPI_COMM_WORLD, reqs + i);
+        }
+        MPI_Waitall(n, reqs, MPI_STATUSES_IGNORE);
+    }
+}
+
+static int recv_msgs(int peer, int count, int slow, int *seq)
+{
+    char buf[MSG_SIZE], expected[MSG_SIZE];
+    int errors = 0;
+
+    if (slow) {
+        /* let the messages pile up, most of them will not fit in the fast box */
+        usleep(20000);
+    }
+    for (int i = 0; i < count; i++) {
+        MPI_Recv(buf, MSG_SIZE, MPI_CHAR, peer, DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        fill(expected, (*seq)++);
+        errors += (0 != memcmp(buf, expected, MSG_SIZE));
+    }
+    return errors;
+}
+
+/* make progress without sending until the fast box to peer has the given size */
+static unsigned long wait_size(int peer, unsigned long size)
+{
+    double start = MPI_Wtime();
+    int flag;
+
+    while (fbox_size(peer) != size && MPI_Wtime() - start < TIMEOUT) {
+        MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, MPI_STATUS_IGNORE);
+    }
+    return fbox_size(peer);
+}
+
+static void command(int rank, int op, int peer, int count, int arg)
+{
+    int cmd[4] = {op, peer, count, arg};
+
+    MPI_Send(cmd, 4, MPI_INT, rank, CMD_TAG, MPI_COMM_WORLD);
+}
+
+/* size of the fast box from rank to rank 0, once it reached size (-1: right
+ * away) or timed out */
+static unsigned long remote_size(int rank, int size)
+{
+    unsigned long value;
+
+    command(rank, OP_WAIT_SIZE, 0, 0, size);
+    MPI_Recv(&value, 1, MPI_UNSIGNED_LONG, rank, REPLY_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    return value;
+}
+
+static int check(int ok, const char *what, int from, int to)
+{
+    printf("%-40s %d -> %d: %s\n", what, from, to, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+static int driver(void)
+{
+    int errors = 0, seq[5] = {0, 0, 0, 0, 0}, i;
+    double start;
+
+    /* grow, shrink and release the fast box from 0 to 1 */
+    command(1, OP_RECV, 0, 2 * FBOX_THRESHOLD, 0);
+    send_msgs(1, 2 * FBOX_THRESHOLD, seq + 1);
+    errors += check(FBOX_SIZE == fbox_size(1), "setup after fbox_threshold sends", 0, 1);
+
+    start = MPI_Wtime();
+    while (fbox_size(1) <= FBOX_SIZE && MPI_Wtime() - start < TIMEOUT) {
+        command(1, OP_RECV, 0, BURST, 1);
+        send_msgs(1, BURST, seq + 1);
+    }
+    errors += check(fbox_size(1) > FBOX_SIZE, "grown by bursts", 0, 1);
+    errors += check(FBOX_SIZE == wait_size(1, FBOX_SIZE), "shrunk once idle", 0, 1);
+    errors += check(0 == wait_size(1, 0), "released once idle", 0, 1);
+
+    /* rank 0 accepts FBOX_MAX fast boxes, from ranks 1 to 3 */
+    for (i = 1; i <= FBOX_MAX + 1; i++) {
+        command(i, OP_SEND, 0, 2 * FBOX_THRESHOLD, 0);
+        errors += recv_msgs(i, 2 * FBOX_THRESHOLD, 0, seq + i);
+    }
+    for (i = 1; i <= FBOX_MAX; i++) {
+        errors += check(FBOX_SIZE == remote_size(i, FBOX_SIZE), "setup", i, 0);
+    }
+
+    /* the next sender is refused, however often it tries */
+    for (int retry = 0; retry < 4; retry++) {
+        command(FBOX_MAX + 1, OP_SEND, 0, 2 * FBOX_THRESHOLD, 0);
+        errors += recv_msgs(FBOX_MAX + 1, 2 * FBOX_THRESHOLD, 0, seq + FBOX_MAX + 1);
+    }
+    errors += check(0 == remote_size(FBOX_MAX + 1, 0), "refused past fbox_max", FBOX_MAX + 1, 0);
+
+    /* until a fast box to rank 0 is released */
+    errors += check(0 == remote_size(1, 0), "released once idle", 1, 0);
+    start = MPI_Wtime();
+    do {
+        command(FBOX_MAX + 1, OP_SEND, 0, 2 * FBOX_THRESHOLD, 0);
+        errors += recv_msgs(FBOX_MAX + 1, 2 * FBOX_THRESHOLD, 0, seq + FBOX_MAX + 1);
+    } while (0 == remote_size(FBOX_MAX + 1, -1) && MPI_Wtime() - start < TIMEOUT);
+    errors += check(FBOX_SIZE == remote_size(FBOX_MAX + 1, -1), "setup from the released slot",
+                    FBOX_MAX + 1, 0);
+
+    return errors;
+}
+
+static int worker(int rank)
+{
+    int errors = 0, seq = 0, cmd[4];
+    unsigned long size;
+
+    for (;;) {
+        MPI_Recv(cmd, 4, MPI_INT, 0, CMD_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        switch (cmd[0]) {
+        case OP_RECV:
+            errors += recv_msgs(cmd[1], cmd[2], cmd[3], &seq);
+            break;
+        case OP_SEND:
+            send_msgs(cmd[1], cmd[2], &seq);
+            break;
+        case OP_WAIT_SIZE:
+            size = (cmd[3] < 0) ? fbox_size(cmd[1]) : wait_size(cmd[1], (unsigned long) cmd[3]);
+            MPI_Send(&size, 1, MPI_UNSIGNED_LONG, 0, REPLY_TAG, MPI_COMM_WORLD);
+            break;
+        default:
+            if (errors) {
+                printf("rank %d: %d corrupted messages\n", rank, errors);
+            }
+            return errors;
+        }
+    }
+}
+
+static void set_default(const char *name, int value)
+{
+    char str[16];
+
+    snprintf(str, sizeof(str), "%d", value);
+    setenv(name, str, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, size, provided, index, errors = 0, total = 0;
+
+    set_default("OMPI_MCA_btl_vader_fbox_size", FBOX_SIZE);
+    set_default("OMPI_MCA_btl_vader_fbox_max", FBOX_MAX);
+    set_default("OMPI_MCA_btl_vader_fbox_max_size", 2 * FBOX_SIZE);
+    set_default("OMPI_MCA_btl_vader_fbox_threshold", FBOX_THRESHOLD);
+    set_default("OMPI_MCA_btl_vader_fbox_window", 32);
+    set_default("OMPI_MCA_btl_vader_fbox_idle", 1 << 16);
+
+    MPI_Init(&argc, &argv);
+    MPI_T_init_thread(MPI_THREAD_SINGLE, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (MPI_SUCCESS == MPI_T_pvar_get_index("btl_vader_fbox_size", MPI_T_PVAR_CLASS_LEVEL, &index)) {
+        MPI_T_pvar_session_create(&session);
+        MPI_T_pvar_handle_alloc(session, index, NULL, &handle, &npeers);
+    }
+    if (size < FBOX_MAX + 2 || npeers < FBOX_MAX + 2) {
+        if (0 == rank) {
+            fprintf(stderr, "btl/vader is not in use or the %d ranks are not on the same node\n"
+                    "usage: mpirun -np %d --mca btl vader,self %s\n", FBOX_MAX + 2, FBOX_MAX + 2, argv[0]);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (0 == rank) {
+        errors = driver();
+        for (int i = 1; i < size; i++) {
+            command(i, OP_DONE, 0, 0, 0);
+        }
+    } else {
+        errors = worker(rank);
+    }
+
+    MPI_Reduce(&errors, &total, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_T_pvar_handle_free(session, &handle);
+    MPI_T_pvar_session_free(&session);
+    MPI_T_finalize();
+    MPI_Finalize();
+    return total ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures the cost of matching a message against posted receive and
+ * unexpected message queues of increasing depth.  Rank 1 fills one of
+ * its queues with entries that never match (distinct tags from rank 0)
+ * and the half round-trip latency of a zero-byte ping-pong on a
+ * separate tag is reported for each depth, with specific and
+ * MPI_ANY_SOURCE receives.
+ *
+ * The pml/ob1 matching engine is a configure time choice
+ * (--with-pml-ob1-matching); build and run once per engine to compare
+ * them.  The engine in use is reported through the read-only
+ * pml_ob1_matching_engine control variable.
+ *
+ * usage: mpirun -np 2 ./match_depth [iterations] [max depth]
+ */
+
+#include "mpi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PING_TAG   1
+#define FILLER_TAG 100
+
+enum {
+    MODE_POSTED,
+    MODE_POSTED_ANY_SOURCE,
+    MODE_UNEXPECTED,
+    MODE_UNEXPECTED_ANY_SOURCE,
+    MODE_COUNT
+};
+
+static const char *mode_names[MODE_COUNT] = {
+    "posted", "posted-any", "unexpected", "unexpected-any"
+};
+
+static void matching_engine(char *name, int len)
+{
+    int count, index, rc;
+    MPI_T_cvar_handle handle;
+
+    snprintf(name, len, "unknown");
+    if (MPI_SUCCESS != MPI_T_cvar_get_num(&count)) {
+        return;
+    }
+    for (index = 0; index < count; index++) {
+        char cvar_name[256], desc[256];
+        int name_len = sizeof(cvar_name), desc_len = sizeof(desc);
+        int verbosity, bind, scope;
+        MPI_Datatype datatype;
+        MPI_T_enum enumtype;
+
+        rc = MPI_T_cvar_get_info(index, cvar_name, &name_len, &verbosity, &datatype,
+                                 &enumtype, desc, &desc_len, &bind, &scope);
+        if (MPI_SUCCESS != rc || 0 != strcmp(cvar_name, "pml_ob1_matching_engine")) {
+            continue;
+        }
+        if (MPI_SUCCESS == MPI_T_cvar_handle_alloc(index, NULL, &handle, &count)) {
+            if (count <= len) {
+                MPI_T_cvar_read(handle, name);
+            }
+            MPI_T_cvar_handle_free(&handle);
+        }
+        return;
+    }
+}
+
+static double time_depth(int rank, int mode, int depth, int iters)
+{
+    MPI_Request *fillers = NULL;
+    MPI_Request req;
+    double start = 0.0;
+    int source = 0, i;
+
+    if (1 == rank) {
+        fillers = malloc(sizeof(MPI_Request) * (depth ? depth : 1));
+        if (MODE_POSTED_ANY_SOURCE == mode || MODE_UNEXPECTED_ANY_SOURCE == mode) {
+            source = MPI_ANY_SOURCE;
+        }
+    }
+
+    if (MODE_POSTED == mode || MODE_POSTED_ANY_SOURCE == mode) {
+        if (1 == rank) {
+            for (i = 0; i < depth; i++) {
+                MPI_Irecv(NULL, 0, MPI_BYTE, 0, FILLER_TAG + i, MPI_COMM_WORLD, fillers + i);
+            }
+        }
+    } else if (0 == rank) {
+        /* eager sends, they sit in rank 1's unexpected queue ahead of the pings */
+        for (i = 0; i < depth; i++) {
+            MPI_Send(NULL, 0, MPI_BYTE, 1, FILLER_TAG + i, MPI_COMM_WORLD);
+        }
+    }
+
+    /* one untimed round trip also guarantees the fillers are in place */
+    for (i = -1; i < iters; i++) {
+        if (0 == i) {
+            start = MPI_Wtime();
+        }
+        if (0 == rank) {
+            MPI_Send(NULL, 0, MPI_BYTE, 1, PING_TAG, MPI_COMM_WORLD);
+            MPI_Recv(NULL, 0, MPI_BYTE, 1, PING_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        } else if (1 == rank) {
+            MPI_Irecv(NULL, 0, MPI_BYTE, source, PING_TAG, MPI_COMM_WORLD, &req);
+            MPI_Wait(&req, MPI_STATUS_IGNORE);
+            MPI_Send(NULL, 0, MPI_BYTE, 0, PING_TAG, MPI_COMM_WORLD);
+        }
+    }
+    start = MPI_Wtime() - start;
+
+    if (1 == rank) {
+        for (i = 0; i < depth; i++) {
+            if (MODE_POSTED == mode || MODE_POSTED_ANY_SOURCE == mode) {
+                MPI_Cancel(fillers + i);
+                MPI_Wait(fillers + i, MPI_STATUS_IGNORE);
+            } else {
+                MPI_Recv(NULL, 0, MPI_BYTE, 0, FILLER_TAG + i, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            }
+        }
+        free(fillers);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    return start * 1e6 / (2.0 * iters);
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, size, provided, iters = 1000, max_depth = 4096, depth, mode;
+    char engine[64];
+    double usec;
+
+    MPI_Init(&argc, &argv);
+    MPI_T_init_thread(MPI_THREAD_SINGLE, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (size < 2) {
+        if (0 == rank) {
+            fprintf(stderr, "match_depth requires at least 2 processes\n");
+        }
+        MPI_T_finalize();
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (argc > 1) {
+        iters = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        max_depth = atoi(argv[2]);
+    }
+
+    matching_engine(engine, sizeof(engine));
+    if (0 == rank) {
+        printf("# matching engine: %s, %d iterations, usec per match\n", engine, iters);
+        printf("# %8s", "depth");
+        for (mode = 0; mode < MODE_COUNT; mode++) {
+            printf(" %14s", mode_names[mode]);
+        }
+        printf("\n");
+    }
+
+    for (depth = 0; depth <= max_depth; depth = depth ? depth * 2 : 1) {
+        if (0 == rank) {
+            printf("  %8d", depth);
+        }
+        for (mode = 0; mode < MODE_COUNT; mode++) {
+            usec = time_depth(rank, mode, depth, iters);
+            if (0 == rank) {
+                printf(" %14.3f", usec);
+            }
+        }
+        if (0 == rank) {
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+
+    MPI_T_finalize();
+    MPI_Finalize();
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures the cost of MPI_Waitany, MPI_Waitsome and MPI_Testsome on
+ * large request arrays.  Rank 1 posts one receive per array entry and
+ * rank 0 sends the matching messages one at a time, in a scrambled
+ * order, each send paced by the completion of the previous one, so
+ * every call finds few completed requests in a large array.  The array
+ * is drained without re-posting: as it empties, the calls have to skip
+ * more and more MPI_REQUEST_NULL entries.  The average time per
+ * completed request is reported for each array size.
+ *
+ * Arrays of at least mpi_request_cq_threshold requests go through the
+ * request completion queues; run once with
+ * --mca mpi_request_cq_threshold 0 to compare against the plain scans.
+ *
+ * usage: mpirun -np 2 ./wait_many [max requests]
+ */
+
+#include "mpi.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ACK_TAG 0
+
+enum {
+    MODE_WAITANY,
+    MODE_WAITSOME,
+    MODE_TESTSOME,
+    MODE_COUNT
+};
+
+static const char *mode_names[MODE_COUNT] = {
+    "waitany", "waitsome", "testsome"
+};
+
+static int completed(int mode, int count, MPI_Request *reqs, int *indices)
+{
+    int outcount = 0;
+
+    switch (mode) {
+    case MODE_WAITANY:
+        MPI_Waitany(count, reqs, indices, MPI_STATUS_IGNORE);
+        outcount = (MPI_UNDEFINED == indices[0]) ? MPI_UNDEFINED : 1;
+        break;
+    case MODE_WAITSOME:
+        MPI_Waitsome(count, reqs, &outcount, indices, MPI_STATUSES_IGNORE);
+        break;
+    case MODE_TESTSOME:
+        do {
+            MPI_Testsome(count, reqs, &outcount, indices, MPI_STATUSES_IGNORE);
+        } while (0 == outcount);
+        break;
+    }
+
+    return outcount;
+}
+
+static double time_count(int rank, int mode, int count)
+{
+    MPI_Request *reqs = NULL;
+    int *indices = NULL, *order, done = 0, outcount, i, j, tmp;
+    double start;
+
+    /* every rank builds the same send order, each entry once */
+    order = malloc(sizeof(int) * count);
+    for (i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    srand(count);
+    for (i = count - 1; i > 0; i--) {
+        j = rand() % (i + 1);
+        tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    if (1 == rank) {
+        reqs = malloc(sizeof(MPI_Request) * count);
+        indices = malloc(sizeof(int) * count);
+        for (i = 0; i < count; i++) {
+            MPI_Irecv(NULL, 0, MPI_BYTE, 0, i + 1, MPI_COMM_WORLD, reqs + i);
+        }
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    start = MPI_Wtime();
+    if (0 == rank) {
+        for (i = 0; i < count; i++) {
+            MPI_Send(NULL, 0, MPI_BYTE, 1, order[i] + 1, MPI_COMM_WORLD);
+            MPI_Recv(NULL, 0, MPI_BYTE, 1, ACK_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+    } else if (1 == rank) {
+        while (done < count) {
+            outcount = completed(mode, count, reqs, indices);
+            for (i = 0; i < outcount; i++) {
+                MPI_Send(NULL, 0, MPI_BYTE, 0, ACK_TAG, MPI_COMM_WORLD);
+            }
+            done += outcount;
+        }
+        /* the array is empty now */
+        if (MPI_UNDEFINED != completed(mode, count, reqs, indices)) {
+            fprintf(stderr, "%s: the drained array still has active requests\n", mode_names[mode]);
+        }
+    }
+    start = MPI_Wtime() - start;
+
+    if (1 == rank) {
+        free(indices);
+        free(reqs);
+    }
+    free(order);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    return start * 1e6 / count;
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, size, max_count = 65536, count, mode;
+    double usec;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (size < 2) {
+        if (0 == rank) {
+            fprintf(stderr, "wait_many requires at least 2 processes\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (argc > 1) {
+        max_count = atoi(argv[1]);
+    }
+
+    if (0 == rank) {
+        printf("# array drained once, usec per completed request\n");
+        printf("# %8s", "requests");
+        for (mode = 0; mode < MODE_COUNT; mode++) {
+            printf(" %14s", mode_names[mode]);
+        }
+        printf("\n");
+    }
+
+    for (count = 1; count <= max_count; count *= 4) {
+        if (0 == rank) {
+            printf("  %8d", count);
+        }
+        for (mode = 0; mode < MODE_COUNT; mode++) {
+            usec = time_count(rank, mode, count);
+            if (0 == rank) {
+                printf(" %14.3f", usec);
+            }
+        }
+        if (0 == rank) {
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+
+    MPI_Finalize();
+
+    return 0;
+}
@@ -0,0 +1,281 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures the overhead of SPCs under MPI_THREAD_MULTIPLE.  Each thread
+ * exchanges small messages with itself on its own communicator through
+ * MPI_Isend/MPI_Irecv and the aggregate message rate is reported for an
+ * increasing number of threads.  Run once with and once without
+ * --mca mpi_spc_attach all to compare.
+ *
+ * When the counters are attached, the OMPI_SPC_ISEND counter, the sent
+ * message size histogram and the per-communicator message counters are
+ * checked against the number of messages each thread sent.  Messages
+ * matched by MPI_Probe, MPI_Iprobe, MPI_Mprobe and MPI_Improbe before
+ * being received are checked to be counted as received exactly once.
+ *
+ * usage: mpirun -np 1 ./spc_overhead [iterations] [max threads]
+ */
+
+#include "mpi.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MESSAGE_SIZE 8
+#define WINDOW       16
+
+typedef struct {
+    MPI_Comm comm;
+    int iters;
+} thread_arg_t;
+
+static void *exchange(void *arg)
+{
+    thread_arg_t *targ = (thread_arg_t *) arg;
+    char sbuf[MESSAGE_SIZE * WINDOW], rbuf[MESSAGE_SIZE * WINDOW];
+    MPI_Request reqs[2 * WINDOW];
+    int i, j;
+
+    memset(sbuf, 0, sizeof(sbuf));
+    for (i = 0; i < targ->iters; i += WINDOW) {
+        for (j = 0; j < WINDOW; j++) {
+            MPI_Irecv(rbuf + j * MESSAGE_SIZE, MESSAGE_SIZE, MPI_BYTE, 0, j,
+                      targ->comm, reqs + j);
+            MPI_Isend(sbuf + j * MESSAGE_SIZE, MESSAGE_SIZE, MPI_BYTE, 0, j,
+                      targ->comm, reqs + WINDOW + j);
+        }
+        MPI_Waitall(2 * WINDOW, reqs, MPI_STATUSES_IGNORE);
+    }
+
+    return NULL;
+}
+
+static int find_pvar(const char *pvar_name)
+{
+    int num, i;
+
+    MPI_T_pvar_get_num(&num);
+    for (i = 0; i < num; i++) {
+        char name[256], desc[256];
+        int name_len = sizeof(name), desc_len = sizeof(desc);
+        int verbosity, var_class, bind, readonly, continuous, atomic;
+        MPI_Datatype datatype;
+        MPI_T_enum enumtype;
+
+        if (MPI_SUCCESS == MPI_T_pvar_get_info(i, name, &name_len, &verbosity, &var_class,
+                                               &datatype, &enumtype, desc, &desc_len, &bind,
+                                               &readonly, &continuous, &atomic) &&
+            0 == strcmp(name, pvar_name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* read one value of a pvar, bound to 'comm' if it is not MPI_COMM_NULL */
+static long long read_pvar(MPI_T_pvar_session session, const char *name, MPI_Comm comm, int bin)
+{
+    long long values[64] = { 0 };
+    MPI_T_pvar_handle handle;
+    int index = find_pvar(name), count;
+
+    if (index < 0 ||
+        MPI_SUCCESS != MPI_T_pvar_handle_alloc(session, index, MPI_COMM_NULL == comm ? NULL : &comm,
+                                               &handle, &count)) {
+        return -1;
+    }
+    if (count > 64 || MPI_SUCCESS != MPI_T_pvar_read(session, handle, values)) {
+        values[bin] = -1;
+    }
+    MPI_T_pvar_handle_free(session, &handle);
+
+    return values[bin];
+}
+
+static int attached(void)
+{
+    char value[256] = "";
+    int count, index;
+    MPI_T_cvar_handle handle;
+
+    if (MPI_SUCCESS != MPI_T_cvar_get_index("mpi_spc_attach", &index) ||
+        MPI_SUCCESS != MPI_T_cvar_handle_alloc(index, NULL, &handle, &count)) {
+        return 0;
+    }
+    if (count <= (int) sizeof(value)) {
+        MPI_T_cvar_read(handle, value);
+    }
+    MPI_T_cvar_handle_free(&handle);
+
+    return '\0' != value[0];
+}
+
+enum {
+    PROBE_PROBE,
+    PROBE_IPROBE,
+    PROBE_MPROBE,
+    PROBE_IMPROBE,
+    PROBE_COUNT
+};
+
+static const char *probe_names[PROBE_COUNT] = {
+    "MPI_Probe", "MPI_Iprobe", "MPI_Mprobe", "MPI_Improbe"
+};
+
+/* receive one message after matching it with a probe, and check that the
+ * received counters went up by exactly one message */
+static int check_probes(MPI_T_pvar_session session)
+{
+    char sbuf[MESSAGE_SIZE], rbuf[MESSAGE_SIZE];
+    long long messages, bytes, histogram;
+    int probe, flag, errors = 0;
+    MPI_Message message;
+    MPI_Request req;
+    MPI_Comm comm;
+
+    memset(sbuf, 0, sizeof(sbuf));
+    MPI_Comm_dup(MPI_COMM_SELF, &comm);
+
+    for (probe = 0; probe < PROBE_COUNT; probe++) {
+        messages = read_pvar(session, "runtime_spc_OMPI_SPC_COMM_MESSAGES_RECEIVED", comm, 0);
+        bytes = read_pvar(session, "runtime_spc_OMPI_SPC_COMM_BYTES_RECEIVED", comm, 0);
+        histogram = read_pvar(session, "runtime_spc_OMPI_SPC_RECEIVED_SIZE_HISTOGRAM", MPI_COMM_NULL, 4);
+
+        MPI_Isend(sbuf, MESSAGE_SIZE, MPI_BYTE, 0, probe, comm, &req);
+        switch (probe) {
+        case PROBE_PROBE:
+            MPI_Probe(0, probe, comm, MPI_STATUS_IGNORE);
+            MPI_Recv(rbuf, MESSAGE_SIZE, MPI_BYTE, 0, probe, comm, MPI_STATUS_IGNORE);
+            break;
+        case PROBE_IPROBE:
+            do {
+                MPI_Iprobe(0, probe, comm, &flag, MPI_STATUS_IGNORE);
+            } while (!flag);
+            MPI_Recv(rbuf, MESSAGE_SIZE, MPI_BYTE, 0, probe, comm, MPI_STATUS_IGNORE);
+            break;
+        case PROBE_MPROBE:
+            MPI_Mprobe(0, probe, comm, &message, MPI_STATUS_IGNORE);
+            MPI_Mrecv(rbuf, MESSAGE_SIZE, MPI_BYTE, &message, MPI_STATUS_IGNORE);
+            break;
+        case PROBE_IMPROBE:
+            do {
+                MPI_Improbe(0, probe, comm, &flag, &message, MPI_STATUS_IGNORE);
+            } while (!flag);
+            MPI_Mrecv(rbuf, MESSAGE_SIZE, MPI_BYTE, &message, MPI_STATUS_IGNORE);
+            break;
+        }
+        MPI_Wait(&req, MPI_STATUS_IGNORE);
+
+        messages = read_pvar(session, "runtime_spc_OMPI_SPC_COMM_MESSAGES_RECEIVED", comm, 0) - messages;
+        bytes = read_pvar(session, "runtime_spc_OMPI_SPC_COMM_BYTES_RECEIVED", comm, 0) - bytes;
+        histogram = read_pvar(session, "runtime_spc_OMPI_SPC_RECEIVED_SIZE_HISTOGRAM", MPI_COMM_NULL, 4) - histogram;
+        if (1 != messages || MESSAGE_SIZE != bytes || 1 != histogram) {
+            fprintf(stderr, "%s: counted %lld messages, %lld bytes and %lld histogram entries, "
+                    "expected 1, %d and 1\n", probe_names[probe], messages, bytes, histogram,
+                    MESSAGE_SIZE);
+            errors++;
+        }
+    }
+
+    MPI_Comm_free(&comm);
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int provided, iters = 100000, max_threads = 8, nthreads, i, errors = 0, on;
+    long long total = 0, before, after, value;
+    MPI_T_pvar_session session;
+    thread_arg_t *args;
+    pthread_t *threads;
+    double start, rate, base_rate = 0.0;
+
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    MPI_T_init_thread(MPI_THREAD_SINGLE, &provided);
+    MPI_T_pvar_session_create(&session);
+
+    if (argc > 1) {
+        iters = (atoi(argv[1]) + WINDOW - 1) / WINDOW * WINDOW;
+    }
+    if (argc > 2) {
+        max_threads = atoi(argv[2]);
+    }
+
+    args = malloc(sizeof(thread_arg_t) * max_threads);
+    threads = malloc(sizeof(pthread_t) * max_threads);
+    for (i = 0; i < max_threads; i++) {
+        MPI_Comm_dup(MPI_COMM_SELF, &args[i].comm);
+        args[i].iters = iters;
+    }
+
+    on = attached();
+    before = read_pvar(session, "runtime_spc_OMPI_SPC_ISEND", MPI_COMM_NULL, 0);
+
+    printf("# SPCs %s, %d messages per thread\n", on ? "attached" : "not attached", iters);
+    printf("# %8s %16s %10s\n", "threads", "messages/s", "scaling");
+    for (nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+        start = MPI_Wtime();
+        for (i = 0; i < nthreads; i++) {
+            pthread_create(threads + i, NULL, exchange, args + i);
+        }
+        for (i = 0; i < nthreads; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        rate = (double) nthreads * iters / (MPI_Wtime() - start);
+        if (1 == nthreads) {
+            base_rate = rate;
+        }
+        total += (long long) nthreads * iters;
+        printf("  %8d %16.0f %10.2f\n", nthreads, rate, rate / base_rate);
+        fflush(stdout);
+    }
+
+    if (on) {
+        after = read_pvar(session, "runtime_spc_OMPI_SPC_ISEND", MPI_COMM_NULL, 0);
+        if (after - before != total) {
+            fprintf(stderr, "OMPI_SPC_ISEND counted %lld messages, expected %lld\n",
+                    after - before, total);
+            errors++;
+        }
+        /* MESSAGE_SIZE bytes fall in bin 4 */
+        value = read_pvar(session, "runtime_spc_OMPI_SPC_SENT_SIZE_HISTOGRAM", MPI_COMM_NULL, 4);
+        if (value < total) {
+            fprintf(stderr, "the sent size histogram has %lld messages in bin 4, expected at least %lld\n",
+                    value, total);
+            errors++;
+        }
+        for (i = 0; i < max_threads; i++) {
+            /* thread i ran in every round with more than i threads */
+            long long expected = 0;
+            for (nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+                expected += (i < nthreads) ? iters : 0;
+            }
+            value = read_pvar(session, "runtime_spc_OMPI_SPC_COMM_MESSAGES_SENT", args[i].comm, 0);
+            if (value != expected) {
+                fprintf(stderr, "communicator %d counted %lld messages sent, expected %lld\n",
+                        i, value, expected);
+                errors++;
+            }
+        }
+        errors += check_probes(session);
+        printf("# counters %s\n", errors ? "inaccurate" : "accurate");
+    }
+
+    for (i = 0; i < max_threads; i++) {
+        MPI_Comm_free(&args[i].comm);
+    }
+    free(threads);
+    free(args);
+
+    MPI_T_pvar_session_free(&session);
+    MPI_T_finalize();
+    MPI_Finalize();
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * Measures the cost of user-level threads blocked in MPI calls with the
+ * argobots threads component.  Two phases are timed for an increasing
+ * number of ULTs spread over a fixed number of execution streams:
+ *
+ *  - compute: on rank 0 the ULTs block in MPI_Recv while one compute ULT
+ *    per execution stream counts loop iterations for a fixed time.  The
+ *    iteration rate shows how much execution stream time the blocked
+ *    ULTs take away.  Rank 1 releases the receives afterwards.
+ *  - pingpong: every ULT of rank 0 exchanges messages with its peer ULT
+ *    of rank 1, and the aggregate message rate is reported.
+ *
+ * Run once as is and once with --mca threads_argobots_progress_ult 1 to
+ * compare waiting ULTs driving opal_progress in turn against a dedicated
+ * progress ULT.
+ *
+ * usage: mpirun -np 2 ./ult_wait [execution streams] [max ULTs]
+ */
+
+#include "mpi.h"
+#include <abt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define COMPUTE_TIME 0.5
+#define PINGPONG_ITERS 1000
+
+struct ult_arg {
+    int id;
+    int peer;
+    int rank;
+    volatile uint64_t work;
+};
+
+static int num_es = 4;
+static ABT_xstream *xstreams;
+static ABT_pool *pools;
+
+static void wait_ult(void *arg)
+{
+    struct ult_arg *ult = (struct ult_arg *) arg;
+    int token;
+
+    MPI_Recv(&token, 1, MPI_INT, ult->peer, ult->id, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+}
+
+static void compute_ult(void *arg)
+{
+    struct ult_arg *ult = (struct ult_arg *) arg;
+    double start = MPI_Wtime();
+    uint64_t i;
+
+    do {
+        for (i = 0; i < 10000; i++) {
+            ult->work++;
+        }
+        ABT_thread_yield();
+    } while (MPI_Wtime() - start < COMPUTE_TIME);
+}
+
+static void pingpong_ult(void *arg)
+{
+    struct ult_arg *ult = (struct ult_arg *) arg;
+    int i, token = 0;
+
+    for (i = 0; i < PINGPONG_ITERS; i++) {
+        if (0 == ult->rank) {
+            MPI_Send(&token, 1, MPI_INT, ult->peer, ult->id, MPI_COMM_WORLD);
+            MPI_Recv(&token, 1, MPI_INT, ult->peer, ult->id, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        } else {
+            MPI_Recv(&token, 1, MPI_INT, ult->peer, ult->id, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Send(&token, 1, MPI_INT, ult->peer, ult->id, MPI_COMM_WORLD);
+        }
+    }
+}
+
+/* run count ULTs of body, spread round-robin over the execution streams */
+static void run_ults(void (*body)(void *), struct ult_arg *args, int count, ABT_thread *threads)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        ABT_thread_create(pools[i % num_es], body, args + i, ABT_THREAD_ATTR_NULL, threads + i);
+    }
+}
+
+static void join_ults(ABT_thread *threads, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        ABT_thread_free(threads + i);
+    }
+}
+
+static double compute_phase(int rank, int count, struct ult_arg *args, ABT_thread *threads)
+{
+    struct ult_arg *compute = calloc(num_es, sizeof(struct ult_arg));
+    ABT_thread *compute_threads = malloc(num_es * sizeof(ABT_thread));
+    double rate = 0.0;
+    int i, token = 0;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (0 == rank) {
+        run_ults(wait_ult, args, count, threads);
+        run_ults(compute_ult, compute, num_es, compute_threads);
+        join_ults(compute_threads, num_es);
+        for (i = 0; i < num_es; i++) {
+            rate += (double) compute[i].work;
+        }
+        rate /= COMPUTE_TIME * num_es;
+        /* release the blocked ULTs */
+        MPI_Send(&token, 1, MPI_INT, 1, count, MPI_COMM_WORLD);
+        join_ults(threads, count);
+    } else {
+        MPI_Recv(&token, 1, MPI_INT, 0, count, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        for (i = 0; i < count; i++) {
+            MPI_Send(&token, 1, MPI_INT, 0, i, MPI_COMM_WORLD);
+        }
+    }
+
+    free(compute_threads);
+    free(compute);
+    return rate;
+}
+
+static double pingpong_phase(int count, struct ult_arg *args, ABT_thread *threads)
+{
+    double time;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    time = MPI_Wtime();
+    run_ults(pingpong_ult, args, count, threads);
+    join_ults(threads, count);
+    time = MPI_Wtime() - time;
+    MPI_Allreduce(MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    return 2.0 * count * PINGPONG_ITERS / time;
+}
+
+int main(int argc, char *argv[])
+{
+    int provided, rank, size, max_ults = 4096, count, i;
+    struct ult_arg *args;
+    ABT_thread *threads;
+    double compute, pingpong;
+
+    if (argc > 1) {
+        num_es = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        max_ults = atoi(argv[2]);
+    }
+
+    ABT_init(argc, argv);
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (MPI_THREAD_MULTIPLE != provided || 2 != size) {
+        fprintf(stderr, "ult_wait needs 2 processes and MPI_THREAD_MULTIPLE\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    /* the primary execution stream is one of the num_es */
+    xstreams = malloc(num_es * sizeof(ABT_xstream));
+    pools = malloc(num_es * sizeof(ABT_pool));
+    ABT_xstream_self(xstreams);
+    for (i = 1; i < num_es; i++) {
+        ABT_xstream_create(ABT_SCHED_NULL, xstreams + i);
+    }
+    for (i = 0; i < num_es; i++) {
+        ABT_xstream_get_main_pools(xstreams[i], 1, pools + i);
+    }
+
+    args = calloc(max_ults, sizeof(struct ult_arg));
+    threads = malloc(max_ults * sizeof(ABT_thread));
+    for (i = 0; i < max_ults; i++) {
+        args[i].id = i;
+        args[i].rank = rank;
+        args[i].peer = 1 - rank;
+    }
+
+    if (0 == rank) {
+        printf("# %d execution streams\n", num_es);
+        printf("# %8s %16s %14s\n", "ULTs", "compute it/s/ES", "pingpong msg/s");
+    }
+
+    for (count = 1; count <= max_ults; count *= 4) {
+        compute = compute_phase(rank, count, args, threads);
+        pingpong = pingpong_phase(count, args, threads);
+        if (0 == rank) {
+            printf("  %8d %16.0f %14.0f\n", count, compute, pingpong);
+            fflush(stdout);
+        }
+    }
+
+    for (i = 1; i < num_es; i++) {
+        ABT_xstream_join(xstreams[i]);
+        ABT_xstream_free(xstreams + i);
+    }
+    free(threads);
+    free(args);
+    free(pools);
+    free(xstreams);
+
+    MPI_Finalize();
+    ABT_finalize();
+
+    return 0;
+}